@@ -46,7 +46,7 @@ function (swift_benchmark_compile_archopts)
       "-sdk" "${sdk}"
       "-target" "${target}"
       "-F" "${sdk}/../../../Developer/Library/Frameworks"
-      "-${BENCH_COMPILE_ARCHOPTS_OPT}"
+      "-${optflag}"
       "-D" "INTERNAL_CHECKS_ENABLED"
       "-no-link-objc-runtime"
       "-I" "${srcdir}/utils/ObjectiveCTests")
@@ -149,6 +149,46 @@ function (swift_benchmark_compile_archopts)
     endif()
   endforeach()
 
+  # The same library, but resilient, so that clients can't rely on the
+  # layout of its types.
+  foreach(module_name_path ${BENCH_RESILIENT_LIBRARY_MODULES})
+    get_filename_component(library_name "${module_name_path}" NAME)
+    set(module_name "${library_name}Resilient")
+
+    set(objfile "${objdir}/${module_name}.o")
+    set(swiftmodule "${objdir}/${module_name}.swiftmodule")
+    set(source "${srcdir}/${module_name_path}.swift")
+    list(APPEND bench_library_objects "${objfile}")
+    add_custom_command(
+        OUTPUT "${objfile}"
+        DEPENDS ${stdlib_dependencies} "${source}"
+        COMMAND "${SWIFT_EXEC}"
+        ${common_options}
+        "-Xfrontend" "-enable-resilience"
+        "-force-single-frontend-invocation"
+        "-parse-as-library"
+        "-module-name" "${module_name}"
+        "-emit-module" "-emit-module-path" "${swiftmodule}"
+        "-o" "${objfile}"
+        "${source}")
+    if (SWIFT_BENCHMARK_EMIT_SIB)
+      set(sibfile "${objdir}/${module_name}.sib")
+      list(APPEND bench_library_sibfiles "${sibfile}")
+      add_custom_command(
+          OUTPUT "${sibfile}"
+          DEPENDS ${stdlib_dependencies} "${source}"
+          COMMAND "${SWIFT_EXEC}"
+          ${common_options}
+          "-Xfrontend" "-enable-resilience"
+          "-force-single-frontend-invocation"
+          "-parse-as-library"
+          "-module-name" "${module_name}"
+          "-emit-sib"
+          "-o" "${sibfile}"
+          "${source}")
+    endif()
+  endforeach()
+
   set(SWIFT_BENCH_OBJFILES)
   set(SWIFT_BENCH_SIBFILES)
   foreach(module_name_path ${SWIFT_BENCH_MODULES})
@@ -258,6 +298,8 @@ function (swift_benchmark_compile_archopts)
           ${bench_flags}
           "-parse-as-library"
           "-module-name" "${module_name}"
+          "-emit-module" "-emit-module-path"
+          "${objdir}/${module_name}.swiftmodule"
           "-I" "${objdir}"
           "-output-file-map" "${objdir}/${module_name}/outputmap.json"
           ${sources})
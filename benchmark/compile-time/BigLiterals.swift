@@ -0,0 +1,30 @@
+// Large array and dictionary literals with mixed element types, which the
+// type checker has to find a common type for.
+
+let numbers = [
+  0, 1.5, 2, 3.25, 4, 5, 6.0, 7, 8, 9, 10, 11.5, 12, 13, 14, 15, 16, 17, 18,
+  19, 20.75, 21, 22, 23, 24, 25, 26, 27, 28.0, 29, 30, 31, 32, 33, 34, 35.5,
+  36, 37, 38, 39, 40, 41, 42, 43, 44, 45.25, 46, 47, 48, 49, 50, 51, 52, 53,
+  54, 55, 56.0, 57, 58, 59, 60, 61, 62, 63.5, 64, 65, 66, 67, 68, 69, 70, 71,
+]
+
+let table: [String: [String: Any]] = [
+  "alpha": ["id": 1, "name": "alpha", "weight": 0.5, "tags": ["a", "b"]],
+  "beta": ["id": 2, "name": "beta", "weight": 1.5, "tags": ["b", "c"]],
+  "gamma": ["id": 3, "name": "gamma", "weight": 2.5, "tags": ["c", "d"]],
+  "delta": ["id": 4, "name": "delta", "weight": 3.5, "tags": ["d", "e"]],
+  "epsilon": ["id": 5, "name": "epsilon", "weight": 4.5, "tags": ["e", "f"]],
+  "zeta": ["id": 6, "name": "zeta", "weight": 5.5, "tags": ["f", "g"]],
+  "eta": ["id": 7, "name": "eta", "weight": 6.5, "tags": ["g", "h"]],
+  "theta": ["id": 8, "name": "theta", "weight": 7.5, "tags": ["h", "i"]],
+  "iota": ["id": 9, "name": "iota", "weight": 8.5, "tags": ["i", "j"]],
+  "kappa": ["id": 10, "name": "kappa", "weight": 9.5, "tags": ["j", "k"]],
+  "lambda": ["id": 11, "name": "lambda", "weight": 10.5, "tags": ["k", "l"]],
+  "mu": ["id": 12, "name": "mu", "weight": 11.5, "tags": ["l", "m"]],
+]
+
+let points: [(x: Double, y: Double, label: String?)] = [
+  (0, 0, "origin"), (1, 0, nil), (0, 1, nil), (1, 1, "unit"),
+  (2, 0.5, nil), (0.5, 2, nil), (3, 3, "three"), (-1, 0, nil),
+  (0, -1, nil), (-1, -1, "negative"), (4, 0.25, nil), (0.25, 4, nil),
+]
@@ -0,0 +1,55 @@
+// Nested generic types and generic functions whose constraints the type
+// checker and the generic specializer have to propagate through many levels.
+
+protocol Container {
+  associatedtype Element
+  var elements: [Element] { get }
+}
+
+struct Wrapper<T> : Container {
+  var value: T
+  var elements: [T] { return [value] }
+}
+
+struct Pair<A : Container, B : Container> : Container
+    where A.Element == B.Element {
+  var first: A
+  var second: B
+  var elements: [A.Element] { return first.elements + second.elements }
+}
+
+func pair<A : Container, B : Container>(_ a: A, _ b: B) -> Pair<A, B>
+    where A.Element == B.Element {
+  return Pair(first: a, second: b)
+}
+
+func total<C : Container>(_ c: C) -> Int where C.Element == Int {
+  return c.elements.reduce(0, +)
+}
+
+func nested() -> Int {
+  let w = Wrapper(value: 1)
+  let p1 = pair(w, w)
+  let p2 = pair(p1, p1)
+  let p3 = pair(p2, p2)
+  let p4 = pair(p3, p3)
+  let p5 = pair(p4, p4)
+  let p6 = pair(p5, p5)
+  let p7 = pair(p6, p6)
+  let p8 = pair(p7, p7)
+  return total(p1) + total(p2) + total(p3) + total(p4) +
+         total(p5) + total(p6) + total(p7) + total(p8)
+}
+
+struct Matrix<T> {
+  var rows: [[T]]
+  func map<U>(_ f: (T) -> U) -> Matrix<U> {
+    return Matrix<U>(rows: rows.map { $0.map(f) })
+  }
+}
+
+func mapped() -> Matrix<[Int?]> {
+  let m = Matrix(rows: [[1, 2], [3, 4]])
+  return m.map { Optional($0) }.map { $0.map { String($0) } }
+          .map { $0.flatMap { Int($0) } }.map { [$0] }
+}
@@ -0,0 +1,615 @@
+// A large enum with payloads, and exhaustive switches over it, which
+// stress enum layout, pattern matching and switch lowering.
+
+enum Instruction {
+  case op0
+  case op1(Int)
+  case op2(String, Int)
+  case op3(Double, [Int])
+  case op4
+  case op5(Int)
+  case op6(String, Int)
+  case op7(Double, [Int])
+  case op8
+  case op9(Int)
+  case op10(String, Int)
+  case op11(Double, [Int])
+  case op12
+  case op13(Int)
+  case op14(String, Int)
+  case op15(Double, [Int])
+  case op16
+  case op17(Int)
+  case op18(String, Int)
+  case op19(Double, [Int])
+  case op20
+  case op21(Int)
+  case op22(String, Int)
+  case op23(Double, [Int])
+  case op24
+  case op25(Int)
+  case op26(String, Int)
+  case op27(Double, [Int])
+  case op28
+  case op29(Int)
+  case op30(String, Int)
+  case op31(Double, [Int])
+  case op32
+  case op33(Int)
+  case op34(String, Int)
+  case op35(Double, [Int])
+  case op36
+  case op37(Int)
+  case op38(String, Int)
+  case op39(Double, [Int])
+  case op40
+  case op41(Int)
+  case op42(String, Int)
+  case op43(Double, [Int])
+  case op44
+  case op45(Int)
+  case op46(String, Int)
+  case op47(Double, [Int])
+  case op48
+  case op49(Int)
+  case op50(String, Int)
+  case op51(Double, [Int])
+  case op52
+  case op53(Int)
+  case op54(String, Int)
+  case op55(Double, [Int])
+  case op56
+  case op57(Int)
+  case op58(String, Int)
+  case op59(Double, [Int])
+  case op60
+  case op61(Int)
+  case op62(String, Int)
+  case op63(Double, [Int])
+  case op64
+  case op65(Int)
+  case op66(String, Int)
+  case op67(Double, [Int])
+  case op68
+  case op69(Int)
+  case op70(String, Int)
+  case op71(Double, [Int])
+  case op72
+  case op73(Int)
+  case op74(String, Int)
+  case op75(Double, [Int])
+  case op76
+  case op77(Int)
+  case op78(String, Int)
+  case op79(Double, [Int])
+  case op80
+  case op81(Int)
+  case op82(String, Int)
+  case op83(Double, [Int])
+  case op84
+  case op85(Int)
+  case op86(String, Int)
+  case op87(Double, [Int])
+  case op88
+  case op89(Int)
+  case op90(String, Int)
+  case op91(Double, [Int])
+  case op92
+  case op93(Int)
+  case op94(String, Int)
+  case op95(Double, [Int])
+  case op96
+  case op97(Int)
+  case op98(String, Int)
+  case op99(Double, [Int])
+  case op100
+  case op101(Int)
+  case op102(String, Int)
+  case op103(Double, [Int])
+  case op104
+  case op105(Int)
+  case op106(String, Int)
+  case op107(Double, [Int])
+  case op108
+  case op109(Int)
+  case op110(String, Int)
+  case op111(Double, [Int])
+  case op112
+  case op113(Int)
+  case op114(String, Int)
+  case op115(Double, [Int])
+  case op116
+  case op117(Int)
+  case op118(String, Int)
+  case op119(Double, [Int])
+  case op120
+  case op121(Int)
+  case op122(String, Int)
+  case op123(Double, [Int])
+  case op124
+  case op125(Int)
+  case op126(String, Int)
+  case op127(Double, [Int])
+  case op128
+  case op129(Int)
+  case op130(String, Int)
+  case op131(Double, [Int])
+  case op132
+  case op133(Int)
+  case op134(String, Int)
+  case op135(Double, [Int])
+  case op136
+  case op137(Int)
+  case op138(String, Int)
+  case op139(Double, [Int])
+  case op140
+  case op141(Int)
+  case op142(String, Int)
+  case op143(Double, [Int])
+  case op144
+  case op145(Int)
+  case op146(String, Int)
+  case op147(Double, [Int])
+  case op148
+  case op149(Int)
+  case op150(String, Int)
+  case op151(Double, [Int])
+  case op152
+  case op153(Int)
+  case op154(String, Int)
+  case op155(Double, [Int])
+  case op156
+  case op157(Int)
+  case op158(String, Int)
+  case op159(Double, [Int])
+  case op160
+  case op161(Int)
+  case op162(String, Int)
+  case op163(Double, [Int])
+  case op164
+  case op165(Int)
+  case op166(String, Int)
+  case op167(Double, [Int])
+  case op168
+  case op169(Int)
+  case op170(String, Int)
+  case op171(Double, [Int])
+  case op172
+  case op173(Int)
+  case op174(String, Int)
+  case op175(Double, [Int])
+  case op176
+  case op177(Int)
+  case op178(String, Int)
+  case op179(Double, [Int])
+  case op180
+  case op181(Int)
+  case op182(String, Int)
+  case op183(Double, [Int])
+  case op184
+  case op185(Int)
+  case op186(String, Int)
+  case op187(Double, [Int])
+  case op188
+  case op189(Int)
+  case op190(String, Int)
+  case op191(Double, [Int])
+  case op192
+  case op193(Int)
+  case op194(String, Int)
+  case op195(Double, [Int])
+  case op196
+  case op197(Int)
+  case op198(String, Int)
+  case op199(Double, [Int])
+}
+
+func cost(_ instruction: Instruction) -> Int {
+  switch instruction {
+  case .op0: return 0
+  case .op1(let x): return x + 1
+  case .op2(let s, let x): return s.utf8.count * x
+  case .op3(let d, let xs): return Int(d) + xs.count
+  case .op4: return 4
+  case .op5(let x): return x + 5
+  case .op6(let s, let x): return s.utf8.count * x
+  case .op7(let d, let xs): return Int(d) + xs.count
+  case .op8: return 8
+  case .op9(let x): return x + 9
+  case .op10(let s, let x): return s.utf8.count * x
+  case .op11(let d, let xs): return Int(d) + xs.count
+  case .op12: return 12
+  case .op13(let x): return x + 13
+  case .op14(let s, let x): return s.utf8.count * x
+  case .op15(let d, let xs): return Int(d) + xs.count
+  case .op16: return 16
+  case .op17(let x): return x + 17
+  case .op18(let s, let x): return s.utf8.count * x
+  case .op19(let d, let xs): return Int(d) + xs.count
+  case .op20: return 20
+  case .op21(let x): return x + 21
+  case .op22(let s, let x): return s.utf8.count * x
+  case .op23(let d, let xs): return Int(d) + xs.count
+  case .op24: return 24
+  case .op25(let x): return x + 25
+  case .op26(let s, let x): return s.utf8.count * x
+  case .op27(let d, let xs): return Int(d) + xs.count
+  case .op28: return 28
+  case .op29(let x): return x + 29
+  case .op30(let s, let x): return s.utf8.count * x
+  case .op31(let d, let xs): return Int(d) + xs.count
+  case .op32: return 32
+  case .op33(let x): return x + 33
+  case .op34(let s, let x): return s.utf8.count * x
+  case .op35(let d, let xs): return Int(d) + xs.count
+  case .op36: return 36
+  case .op37(let x): return x + 37
+  case .op38(let s, let x): return s.utf8.count * x
+  case .op39(let d, let xs): return Int(d) + xs.count
+  case .op40: return 40
+  case .op41(let x): return x + 41
+  case .op42(let s, let x): return s.utf8.count * x
+  case .op43(let d, let xs): return Int(d) + xs.count
+  case .op44: return 44
+  case .op45(let x): return x + 45
+  case .op46(let s, let x): return s.utf8.count * x
+  case .op47(let d, let xs): return Int(d) + xs.count
+  case .op48: return 48
+  case .op49(let x): return x + 49
+  case .op50(let s, let x): return s.utf8.count * x
+  case .op51(let d, let xs): return Int(d) + xs.count
+  case .op52: return 52
+  case .op53(let x): return x + 53
+  case .op54(let s, let x): return s.utf8.count * x
+  case .op55(let d, let xs): return Int(d) + xs.count
+  case .op56: return 56
+  case .op57(let x): return x + 57
+  case .op58(let s, let x): return s.utf8.count * x
+  case .op59(let d, let xs): return Int(d) + xs.count
+  case .op60: return 60
+  case .op61(let x): return x + 61
+  case .op62(let s, let x): return s.utf8.count * x
+  case .op63(let d, let xs): return Int(d) + xs.count
+  case .op64: return 64
+  case .op65(let x): return x + 65
+  case .op66(let s, let x): return s.utf8.count * x
+  case .op67(let d, let xs): return Int(d) + xs.count
+  case .op68: return 68
+  case .op69(let x): return x + 69
+  case .op70(let s, let x): return s.utf8.count * x
+  case .op71(let d, let xs): return Int(d) + xs.count
+  case .op72: return 72
+  case .op73(let x): return x + 73
+  case .op74(let s, let x): return s.utf8.count * x
+  case .op75(let d, let xs): return Int(d) + xs.count
+  case .op76: return 76
+  case .op77(let x): return x + 77
+  case .op78(let s, let x): return s.utf8.count * x
+  case .op79(let d, let xs): return Int(d) + xs.count
+  case .op80: return 80
+  case .op81(let x): return x + 81
+  case .op82(let s, let x): return s.utf8.count * x
+  case .op83(let d, let xs): return Int(d) + xs.count
+  case .op84: return 84
+  case .op85(let x): return x + 85
+  case .op86(let s, let x): return s.utf8.count * x
+  case .op87(let d, let xs): return Int(d) + xs.count
+  case .op88: return 88
+  case .op89(let x): return x + 89
+  case .op90(let s, let x): return s.utf8.count * x
+  case .op91(let d, let xs): return Int(d) + xs.count
+  case .op92: return 92
+  case .op93(let x): return x + 93
+  case .op94(let s, let x): return s.utf8.count * x
+  case .op95(let d, let xs): return Int(d) + xs.count
+  case .op96: return 96
+  case .op97(let x): return x + 97
+  case .op98(let s, let x): return s.utf8.count * x
+  case .op99(let d, let xs): return Int(d) + xs.count
+  case .op100: return 100
+  case .op101(let x): return x + 101
+  case .op102(let s, let x): return s.utf8.count * x
+  case .op103(let d, let xs): return Int(d) + xs.count
+  case .op104: return 104
+  case .op105(let x): return x + 105
+  case .op106(let s, let x): return s.utf8.count * x
+  case .op107(let d, let xs): return Int(d) + xs.count
+  case .op108: return 108
+  case .op109(let x): return x + 109
+  case .op110(let s, let x): return s.utf8.count * x
+  case .op111(let d, let xs): return Int(d) + xs.count
+  case .op112: return 112
+  case .op113(let x): return x + 113
+  case .op114(let s, let x): return s.utf8.count * x
+  case .op115(let d, let xs): return Int(d) + xs.count
+  case .op116: return 116
+  case .op117(let x): return x + 117
+  case .op118(let s, let x): return s.utf8.count * x
+  case .op119(let d, let xs): return Int(d) + xs.count
+  case .op120: return 120
+  case .op121(let x): return x + 121
+  case .op122(let s, let x): return s.utf8.count * x
+  case .op123(let d, let xs): return Int(d) + xs.count
+  case .op124: return 124
+  case .op125(let x): return x + 125
+  case .op126(let s, let x): return s.utf8.count * x
+  case .op127(let d, let xs): return Int(d) + xs.count
+  case .op128: return 128
+  case .op129(let x): return x + 129
+  case .op130(let s, let x): return s.utf8.count * x
+  case .op131(let d, let xs): return Int(d) + xs.count
+  case .op132: return 132
+  case .op133(let x): return x + 133
+  case .op134(let s, let x): return s.utf8.count * x
+  case .op135(let d, let xs): return Int(d) + xs.count
+  case .op136: return 136
+  case .op137(let x): return x + 137
+  case .op138(let s, let x): return s.utf8.count * x
+  case .op139(let d, let xs): return Int(d) + xs.count
+  case .op140: return 140
+  case .op141(let x): return x + 141
+  case .op142(let s, let x): return s.utf8.count * x
+  case .op143(let d, let xs): return Int(d) + xs.count
+  case .op144: return 144
+  case .op145(let x): return x + 145
+  case .op146(let s, let x): return s.utf8.count * x
+  case .op147(let d, let xs): return Int(d) + xs.count
+  case .op148: return 148
+  case .op149(let x): return x + 149
+  case .op150(let s, let x): return s.utf8.count * x
+  case .op151(let d, let xs): return Int(d) + xs.count
+  case .op152: return 152
+  case .op153(let x): return x + 153
+  case .op154(let s, let x): return s.utf8.count * x
+  case .op155(let d, let xs): return Int(d) + xs.count
+  case .op156: return 156
+  case .op157(let x): return x + 157
+  case .op158(let s, let x): return s.utf8.count * x
+  case .op159(let d, let xs): return Int(d) + xs.count
+  case .op160: return 160
+  case .op161(let x): return x + 161
+  case .op162(let s, let x): return s.utf8.count * x
+  case .op163(let d, let xs): return Int(d) + xs.count
+  case .op164: return 164
+  case .op165(let x): return x + 165
+  case .op166(let s, let x): return s.utf8.count * x
+  case .op167(let d, let xs): return Int(d) + xs.count
+  case .op168: return 168
+  case .op169(let x): return x + 169
+  case .op170(let s, let x): return s.utf8.count * x
+  case .op171(let d, let xs): return Int(d) + xs.count
+  case .op172: return 172
+  case .op173(let x): return x + 173
+  case .op174(let s, let x): return s.utf8.count * x
+  case .op175(let d, let xs): return Int(d) + xs.count
+  case .op176: return 176
+  case .op177(let x): return x + 177
+  case .op178(let s, let x): return s.utf8.count * x
+  case .op179(let d, let xs): return Int(d) + xs.count
+  case .op180: return 180
+  case .op181(let x): return x + 181
+  case .op182(let s, let x): return s.utf8.count * x
+  case .op183(let d, let xs): return Int(d) + xs.count
+  case .op184: return 184
+  case .op185(let x): return x + 185
+  case .op186(let s, let x): return s.utf8.count * x
+  case .op187(let d, let xs): return Int(d) + xs.count
+  case .op188: return 188
+  case .op189(let x): return x + 189
+  case .op190(let s, let x): return s.utf8.count * x
+  case .op191(let d, let xs): return Int(d) + xs.count
+  case .op192: return 192
+  case .op193(let x): return x + 193
+  case .op194(let s, let x): return s.utf8.count * x
+  case .op195(let d, let xs): return Int(d) + xs.count
+  case .op196: return 196
+  case .op197(let x): return x + 197
+  case .op198(let s, let x): return s.utf8.count * x
+  case .op199(let d, let xs): return Int(d) + xs.count
+  }
+}
+
+func name(_ instruction: Instruction) -> String {
+  switch instruction {
+  case .op0: return "op0"
+  case .op1: return "op1"
+  case .op2: return "op2"
+  case .op3: return "op3"
+  case .op4: return "op4"
+  case .op5: return "op5"
+  case .op6: return "op6"
+  case .op7: return "op7"
+  case .op8: return "op8"
+  case .op9: return "op9"
+  case .op10: return "op10"
+  case .op11: return "op11"
+  case .op12: return "op12"
+  case .op13: return "op13"
+  case .op14: return "op14"
+  case .op15: return "op15"
+  case .op16: return "op16"
+  case .op17: return "op17"
+  case .op18: return "op18"
+  case .op19: return "op19"
+  case .op20: return "op20"
+  case .op21: return "op21"
+  case .op22: return "op22"
+  case .op23: return "op23"
+  case .op24: return "op24"
+  case .op25: return "op25"
+  case .op26: return "op26"
+  case .op27: return "op27"
+  case .op28: return "op28"
+  case .op29: return "op29"
+  case .op30: return "op30"
+  case .op31: return "op31"
+  case .op32: return "op32"
+  case .op33: return "op33"
+  case .op34: return "op34"
+  case .op35: return "op35"
+  case .op36: return "op36"
+  case .op37: return "op37"
+  case .op38: return "op38"
+  case .op39: return "op39"
+  case .op40: return "op40"
+  case .op41: return "op41"
+  case .op42: return "op42"
+  case .op43: return "op43"
+  case .op44: return "op44"
+  case .op45: return "op45"
+  case .op46: return "op46"
+  case .op47: return "op47"
+  case .op48: return "op48"
+  case .op49: return "op49"
+  case .op50: return "op50"
+  case .op51: return "op51"
+  case .op52: return "op52"
+  case .op53: return "op53"
+  case .op54: return "op54"
+  case .op55: return "op55"
+  case .op56: return "op56"
+  case .op57: return "op57"
+  case .op58: return "op58"
+  case .op59: return "op59"
+  case .op60: return "op60"
+  case .op61: return "op61"
+  case .op62: return "op62"
+  case .op63: return "op63"
+  case .op64: return "op64"
+  case .op65: return "op65"
+  case .op66: return "op66"
+  case .op67: return "op67"
+  case .op68: return "op68"
+  case .op69: return "op69"
+  case .op70: return "op70"
+  case .op71: return "op71"
+  case .op72: return "op72"
+  case .op73: return "op73"
+  case .op74: return "op74"
+  case .op75: return "op75"
+  case .op76: return "op76"
+  case .op77: return "op77"
+  case .op78: return "op78"
+  case .op79: return "op79"
+  case .op80: return "op80"
+  case .op81: return "op81"
+  case .op82: return "op82"
+  case .op83: return "op83"
+  case .op84: return "op84"
+  case .op85: return "op85"
+  case .op86: return "op86"
+  case .op87: return "op87"
+  case .op88: return "op88"
+  case .op89: return "op89"
+  case .op90: return "op90"
+  case .op91: return "op91"
+  case .op92: return "op92"
+  case .op93: return "op93"
+  case .op94: return "op94"
+  case .op95: return "op95"
+  case .op96: return "op96"
+  case .op97: return "op97"
+  case .op98: return "op98"
+  case .op99: return "op99"
+  case .op100: return "op100"
+  case .op101: return "op101"
+  case .op102: return "op102"
+  case .op103: return "op103"
+  case .op104: return "op104"
+  case .op105: return "op105"
+  case .op106: return "op106"
+  case .op107: return "op107"
+  case .op108: return "op108"
+  case .op109: return "op109"
+  case .op110: return "op110"
+  case .op111: return "op111"
+  case .op112: return "op112"
+  case .op113: return "op113"
+  case .op114: return "op114"
+  case .op115: return "op115"
+  case .op116: return "op116"
+  case .op117: return "op117"
+  case .op118: return "op118"
+  case .op119: return "op119"
+  case .op120: return "op120"
+  case .op121: return "op121"
+  case .op122: return "op122"
+  case .op123: return "op123"
+  case .op124: return "op124"
+  case .op125: return "op125"
+  case .op126: return "op126"
+  case .op127: return "op127"
+  case .op128: return "op128"
+  case .op129: return "op129"
+  case .op130: return "op130"
+  case .op131: return "op131"
+  case .op132: return "op132"
+  case .op133: return "op133"
+  case .op134: return "op134"
+  case .op135: return "op135"
+  case .op136: return "op136"
+  case .op137: return "op137"
+  case .op138: return "op138"
+  case .op139: return "op139"
+  case .op140: return "op140"
+  case .op141: return "op141"
+  case .op142: return "op142"
+  case .op143: return "op143"
+  case .op144: return "op144"
+  case .op145: return "op145"
+  case .op146: return "op146"
+  case .op147: return "op147"
+  case .op148: return "op148"
+  case .op149: return "op149"
+  case .op150: return "op150"
+  case .op151: return "op151"
+  case .op152: return "op152"
+  case .op153: return "op153"
+  case .op154: return "op154"
+  case .op155: return "op155"
+  case .op156: return "op156"
+  case .op157: return "op157"
+  case .op158: return "op158"
+  case .op159: return "op159"
+  case .op160: return "op160"
+  case .op161: return "op161"
+  case .op162: return "op162"
+  case .op163: return "op163"
+  case .op164: return "op164"
+  case .op165: return "op165"
+  case .op166: return "op166"
+  case .op167: return "op167"
+  case .op168: return "op168"
+  case .op169: return "op169"
+  case .op170: return "op170"
+  case .op171: return "op171"
+  case .op172: return "op172"
+  case .op173: return "op173"
+  case .op174: return "op174"
+  case .op175: return "op175"
+  case .op176: return "op176"
+  case .op177: return "op177"
+  case .op178: return "op178"
+  case .op179: return "op179"
+  case .op180: return "op180"
+  case .op181: return "op181"
+  case .op182: return "op182"
+  case .op183: return "op183"
+  case .op184: return "op184"
+  case .op185: return "op185"
+  case .op186: return "op186"
+  case .op187: return "op187"
+  case .op188: return "op188"
+  case .op189: return "op189"
+  case .op190: return "op190"
+  case .op191: return "op191"
+  case .op192: return "op192"
+  case .op193: return "op193"
+  case .op194: return "op194"
+  case .op195: return "op195"
+  case .op196: return "op196"
+  case .op197: return "op197"
+  case .op198: return "op198"
+  case .op199: return "op199"
+  }
+}
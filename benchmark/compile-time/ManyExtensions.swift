@@ -0,0 +1,339 @@
+// Many extensions and protocol conformances on a handful of types, which
+// exercise extension binding, member lookup and conformance checking.
+
+protocol Describable {
+  func describe() -> String
+}
+
+protocol Scalable {
+  func scaled(by factor: Int) -> Self
+}
+
+struct Widget {
+  var size: Int
+}
+
+extension Widget : Describable {
+  func describe() -> String { return "Widget(\(size))" }
+}
+
+extension Widget : Scalable {
+  func scaled(by factor: Int) -> Widget {
+    return Widget(size: size * factor)
+  }
+}
+
+extension Widget : Equatable {
+  static func ==(a: Widget, b: Widget) -> Bool { return a.size == b.size }
+}
+
+extension Widget {
+  var property0: Int { return size + 0 }
+  func method0(_ x: Int) -> Int { return property0 * x }
+}
+
+extension Widget {
+  var property1: Int { return size + 1 }
+  func method1(_ x: Int) -> Int { return property1 * x }
+}
+
+extension Widget {
+  var property2: Int { return size + 2 }
+  func method2(_ x: Int) -> Int { return property2 * x }
+}
+
+extension Widget {
+  var property3: Int { return size + 3 }
+  func method3(_ x: Int) -> Int { return property3 * x }
+}
+
+extension Widget {
+  var property4: Int { return size + 4 }
+  func method4(_ x: Int) -> Int { return property4 * x }
+}
+
+extension Widget {
+  var property5: Int { return size + 5 }
+  func method5(_ x: Int) -> Int { return property5 * x }
+}
+
+extension Widget {
+  var property6: Int { return size + 6 }
+  func method6(_ x: Int) -> Int { return property6 * x }
+}
+
+extension Widget {
+  var property7: Int { return size + 7 }
+  func method7(_ x: Int) -> Int { return property7 * x }
+}
+
+extension Widget {
+  var property8: Int { return size + 8 }
+  func method8(_ x: Int) -> Int { return property8 * x }
+}
+
+extension Widget {
+  var property9: Int { return size + 9 }
+  func method9(_ x: Int) -> Int { return property9 * x }
+}
+
+extension Widget {
+  var property10: Int { return size + 10 }
+  func method10(_ x: Int) -> Int { return property10 * x }
+}
+
+extension Widget {
+  var property11: Int { return size + 11 }
+  func method11(_ x: Int) -> Int { return property11 * x }
+}
+
+struct Gadget {
+  var size: Int
+}
+
+extension Gadget : Describable {
+  func describe() -> String { return "Gadget(\(size))" }
+}
+
+extension Gadget : Scalable {
+  func scaled(by factor: Int) -> Gadget {
+    return Gadget(size: size * factor)
+  }
+}
+
+extension Gadget : Equatable {
+  static func ==(a: Gadget, b: Gadget) -> Bool { return a.size == b.size }
+}
+
+extension Gadget {
+  var property0: Int { return size + 0 }
+  func method0(_ x: Int) -> Int { return property0 * x }
+}
+
+extension Gadget {
+  var property1: Int { return size + 1 }
+  func method1(_ x: Int) -> Int { return property1 * x }
+}
+
+extension Gadget {
+  var property2: Int { return size + 2 }
+  func method2(_ x: Int) -> Int { return property2 * x }
+}
+
+extension Gadget {
+  var property3: Int { return size + 3 }
+  func method3(_ x: Int) -> Int { return property3 * x }
+}
+
+extension Gadget {
+  var property4: Int { return size + 4 }
+  func method4(_ x: Int) -> Int { return property4 * x }
+}
+
+extension Gadget {
+  var property5: Int { return size + 5 }
+  func method5(_ x: Int) -> Int { return property5 * x }
+}
+
+extension Gadget {
+  var property6: Int { return size + 6 }
+  func method6(_ x: Int) -> Int { return property6 * x }
+}
+
+extension Gadget {
+  var property7: Int { return size + 7 }
+  func method7(_ x: Int) -> Int { return property7 * x }
+}
+
+extension Gadget {
+  var property8: Int { return size + 8 }
+  func method8(_ x: Int) -> Int { return property8 * x }
+}
+
+extension Gadget {
+  var property9: Int { return size + 9 }
+  func method9(_ x: Int) -> Int { return property9 * x }
+}
+
+extension Gadget {
+  var property10: Int { return size + 10 }
+  func method10(_ x: Int) -> Int { return property10 * x }
+}
+
+extension Gadget {
+  var property11: Int { return size + 11 }
+  func method11(_ x: Int) -> Int { return property11 * x }
+}
+
+struct Gizmo {
+  var size: Int
+}
+
+extension Gizmo : Describable {
+  func describe() -> String { return "Gizmo(\(size))" }
+}
+
+extension Gizmo : Scalable {
+  func scaled(by factor: Int) -> Gizmo {
+    return Gizmo(size: size * factor)
+  }
+}
+
+extension Gizmo : Equatable {
+  static func ==(a: Gizmo, b: Gizmo) -> Bool { return a.size == b.size }
+}
+
+extension Gizmo {
+  var property0: Int { return size + 0 }
+  func method0(_ x: Int) -> Int { return property0 * x }
+}
+
+extension Gizmo {
+  var property1: Int { return size + 1 }
+  func method1(_ x: Int) -> Int { return property1 * x }
+}
+
+extension Gizmo {
+  var property2: Int { return size + 2 }
+  func method2(_ x: Int) -> Int { return property2 * x }
+}
+
+extension Gizmo {
+  var property3: Int { return size + 3 }
+  func method3(_ x: Int) -> Int { return property3 * x }
+}
+
+extension Gizmo {
+  var property4: Int { return size + 4 }
+  func method4(_ x: Int) -> Int { return property4 * x }
+}
+
+extension Gizmo {
+  var property5: Int { return size + 5 }
+  func method5(_ x: Int) -> Int { return property5 * x }
+}
+
+extension Gizmo {
+  var property6: Int { return size + 6 }
+  func method6(_ x: Int) -> Int { return property6 * x }
+}
+
+extension Gizmo {
+  var property7: Int { return size + 7 }
+  func method7(_ x: Int) -> Int { return property7 * x }
+}
+
+extension Gizmo {
+  var property8: Int { return size + 8 }
+  func method8(_ x: Int) -> Int { return property8 * x }
+}
+
+extension Gizmo {
+  var property9: Int { return size + 9 }
+  func method9(_ x: Int) -> Int { return property9 * x }
+}
+
+extension Gizmo {
+  var property10: Int { return size + 10 }
+  func method10(_ x: Int) -> Int { return property10 * x }
+}
+
+extension Gizmo {
+  var property11: Int { return size + 11 }
+  func method11(_ x: Int) -> Int { return property11 * x }
+}
+
+struct Doohickey {
+  var size: Int
+}
+
+extension Doohickey : Describable {
+  func describe() -> String { return "Doohickey(\(size))" }
+}
+
+extension Doohickey : Scalable {
+  func scaled(by factor: Int) -> Doohickey {
+    return Doohickey(size: size * factor)
+  }
+}
+
+extension Doohickey : Equatable {
+  static func ==(a: Doohickey, b: Doohickey) -> Bool { return a.size == b.size }
+}
+
+extension Doohickey {
+  var property0: Int { return size + 0 }
+  func method0(_ x: Int) -> Int { return property0 * x }
+}
+
+extension Doohickey {
+  var property1: Int { return size + 1 }
+  func method1(_ x: Int) -> Int { return property1 * x }
+}
+
+extension Doohickey {
+  var property2: Int { return size + 2 }
+  func method2(_ x: Int) -> Int { return property2 * x }
+}
+
+extension Doohickey {
+  var property3: Int { return size + 3 }
+  func method3(_ x: Int) -> Int { return property3 * x }
+}
+
+extension Doohickey {
+  var property4: Int { return size + 4 }
+  func method4(_ x: Int) -> Int { return property4 * x }
+}
+
+extension Doohickey {
+  var property5: Int { return size + 5 }
+  func method5(_ x: Int) -> Int { return property5 * x }
+}
+
+extension Doohickey {
+  var property6: Int { return size + 6 }
+  func method6(_ x: Int) -> Int { return property6 * x }
+}
+
+extension Doohickey {
+  var property7: Int { return size + 7 }
+  func method7(_ x: Int) -> Int { return property7 * x }
+}
+
+extension Doohickey {
+  var property8: Int { return size + 8 }
+  func method8(_ x: Int) -> Int { return property8 * x }
+}
+
+extension Doohickey {
+  var property9: Int { return size + 9 }
+  func method9(_ x: Int) -> Int { return property9 * x }
+}
+
+extension Doohickey {
+  var property10: Int { return size + 10 }
+  func method10(_ x: Int) -> Int { return property10 * x }
+}
+
+extension Doohickey {
+  var property11: Int { return size + 11 }
+  func method11(_ x: Int) -> Int { return property11 * x }
+}
+
+extension Array where Element : Describable {
+  func describeAll() -> [String] { return map { $0.describe() } }
+}
+
+extension Array where Element : Scalable {
+  func scaledAll(by factor: Int) -> [Element] {
+    return map { $0.scaled(by: factor) }
+  }
+}
+
+func useExtensions() -> [String] {
+  let widgets = [Widget(size: 1), Widget(size: 2)].scaledAll(by: 3)
+  let gizmos = [Gizmo(size: 4)].scaledAll(by: 2)
+  return widgets.describeAll() + gizmos.describeAll() +
+         [String(widgets[0].method11(gizmos[0].property3))]
+}
@@ -0,0 +1,33 @@
+// Expressions mixing literals, overloaded operators and conversions, which
+// make the constraint solver explore many overload combinations.
+
+func polynomial(_ x: Double) -> Double {
+  return 1 + 2 * x + 3 * x * x + 4 * x * x * x + 5 * x * x * x * x -
+         6 / (x + 1) + 7 / (x * x + 1) - 8 / (x * x * x + 1)
+}
+
+func mixed(_ a: Int, _ b: Int, _ c: Double) -> Double {
+  return Double(a + b * 2 - 3) * c + Double(a * a - b * b) / (c + 1) -
+         Double(a % 7 + b % 5) * 0.5 + c * c * Double(a - b) + 1.0
+}
+
+func bits(_ x: UInt32) -> UInt32 {
+  return ((x & 0xff) << 24) | ((x & 0xff00) << 8) | ((x >> 8) & 0xff00) |
+         ((x >> 24) & 0xff) ^ (x &* 31 &+ 7) ^ ~(x | 0x0f0f0f0f)
+}
+
+func comparisons(_ a: Int, _ b: Int, _ c: Int) -> Bool {
+  return (a < b && b < c) || (a > b && b > c) ||
+         (a == b && b != c) || (a + b > c && a - b < c && a * b != c)
+}
+
+func strings(_ name: String, _ count: Int) -> String {
+  return "Hello, " + name + "! You have " + String(count) + " new " +
+         (count == 1 ? "message" : "messages") + " and " +
+         String(count * 2 + 1) + " notifications."
+}
+
+func closures() -> [Int] {
+  return (1...100).map { $0 * 2 + 1 }.filter { $0 % 3 == 0 || $0 % 5 == 0 }
+                  .map { $0 * $0 - $0 / 2 + 1 }.sorted { $0 % 10 < $1 % 10 }
+}
@@ -0,0 +1,105 @@
+//===--- GenericPipeline.swift --------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test runs orders through a pipeline of generic stages and sinks
+// across module-internal protocols, once composed statically and once
+// assembled at run time from type-erased stages.
+import TestsUtils
+
+let orderCount = 1_000
+let customerCount = 50
+
+func makeOrders() -> [Order] {
+  func random(_ upperBound: Int) -> Int {
+    return Int(Random() & 0xFFFF) % upperBound
+  }
+  let currencies: [Currency] = [.usd, .usd, .eur, .jpy]
+  SRand()
+  var orders = [Order]()
+  for i in 0..<orderCount {
+    var items = [LineItem]()
+    for _ in 0..<random(6) {
+      items.append(LineItem(sku: random(10_000), quantity: random(4),
+                            unitPrice: 99 + random(20_000)))
+    }
+    orders.append(Order(id: i, customer: random(customerCount),
+                        currency: currencies[random(currencies.count)],
+                        items: items))
+  }
+  return orders
+}
+
+let orders = makeOrders()
+
+func makeStaticPipeline() -> Chain<Chain<Chain<FilterStage<Order>,
+                                              MapStage<Order, Charge>>,
+                                        FilterStage<Charge>>,
+                                  MapStage<Charge, Charge>> {
+  return FilterStage<Order> { !$0.items.isEmpty }
+    .then(MapStage<Order, Charge> {
+      Charge(customer: $0.customer,
+             cents: $0.currency.toUSCents($0.items.totalCents()))
+    })
+    .then(FilterStage<Charge> { $0.cents >= 1_000 })
+    .then(MapStage<Charge, Charge> {
+      // Add sales tax.
+      Charge(customer: $0.customer, cents: $0.cents + $0.cents * 8 / 100)
+    })
+}
+
+func makeDynamicStages() -> [AnyStage<Charge, Charge>] {
+  var stages = [AnyStage<Charge, Charge>]()
+  stages.append(AnyStage(FilterStage<Charge> { $0.cents >= 1_000 }))
+  stages.append(AnyStage(MapStage<Charge, Charge> {
+    Charge(customer: $0.customer, cents: $0.cents + $0.cents * 8 / 100)
+  }))
+  return stages
+}
+
+@inline(never)
+public func run_GenericPipeline(_ N: Int) {
+  let pipeline = makeStaticPipeline()
+  let toCharge = MapStage<Order, Charge> {
+    Charge(customer: $0.customer,
+           cents: $0.currency.toUSCents($0.items.totalCents()))
+  }
+  let dynamicStages = makeDynamicStages()
+  for _ in 1...N {
+    var staticTotals = GroupedTotals<Charge, Int> { $0.customer }
+    drain(orders, through: pipeline, into: &staticTotals)
+
+    var dynamicTotals = GroupedTotals<Charge, Int> { $0.customer }
+    var dropped = CountingSink<Order>()
+    for order in orders {
+      guard !order.items.isEmpty, var charge = toCharge.process(order) else {
+        dropped.consume(order)
+        continue
+      }
+      var kept = true
+      for stage in dynamicStages {
+        guard let next = stage.process(charge) else {
+          kept = false
+          break
+        }
+        charge = next
+      }
+      if kept {
+        dynamicTotals.consume(charge)
+      }
+    }
+
+    CheckResults(staticTotals.totals == dynamicTotals.totals,
+                 "Pipelines disagree in GenericPipeline")
+    CheckResults(dropped.count < orderCount,
+                 "Incorrect number of dropped orders in GenericPipeline")
+  }
+}
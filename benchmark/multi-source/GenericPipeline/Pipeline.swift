@@ -0,0 +1,92 @@
+//===--- Pipeline.swift ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+protocol Priced {
+  var cents: Int { get }
+}
+
+extension Sequence where Iterator.Element : Priced {
+  func totalCents() -> Int {
+    return reduce(0) { $0 + $1.cents }
+  }
+}
+
+enum Currency {
+  case usd
+  case eur
+  case jpy
+
+  /// Converts an amount in this currency to US cents.
+  func toUSCents(_ amount: Int) -> Int {
+    switch self {
+    case .usd: return amount
+    case .eur: return amount * 112 / 100
+    case .jpy: return amount * 96 / 10_000
+    }
+  }
+}
+
+struct LineItem : Priced {
+  var sku: Int
+  var quantity: Int
+  var unitPrice: Int
+
+  var cents: Int {
+    return quantity * unitPrice
+  }
+}
+
+struct Order {
+  var id: Int
+  var customer: Int
+  var currency: Currency
+  var items: [LineItem]
+}
+
+struct Charge : Priced {
+  var customer: Int
+  var cents: Int
+}
+
+/// Sums what each key spent.
+struct GroupedTotals<Element : Priced, Key : Hashable> : Sink {
+  let key: (Element) -> Key
+  var totals = [Key: Int]()
+
+  init(key: @escaping (Element) -> Key) {
+    self.key = key
+  }
+
+  mutating func consume(_ element: Element) {
+    let k = key(element)
+    totals[k] = (totals[k] ?? 0) + element.cents
+  }
+}
+
+struct CountingSink<Element> : Sink {
+  var count = 0
+
+  mutating func consume(_ element: Element) {
+    count += 1
+  }
+}
+
+/// Feeds every element of input through the pipeline into the sink.
+func drain<Input : Sequence, P : Stage, Output : Sink>(
+  _ input: Input, through pipeline: P, into sink: inout Output
+) where Input.Iterator.Element == P.Input, P.Output == Output.Element {
+  for element in input {
+    if let output = pipeline.process(element) {
+      sink.consume(output)
+    }
+  }
+}
@@ -0,0 +1,74 @@
+//===--- Stages.swift -----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// One step of a data pipeline. A stage may drop its input by returning nil.
+protocol Stage {
+  associatedtype Input
+  associatedtype Output
+  func process(_ input: Input) -> Output?
+}
+
+struct MapStage<Input, Output> : Stage {
+  let transform: (Input) -> Output
+
+  func process(_ input: Input) -> Output? {
+    return transform(input)
+  }
+}
+
+struct FilterStage<Element> : Stage {
+  let isIncluded: (Element) -> Bool
+
+  func process(_ input: Element) -> Element? {
+    return isIncluded(input) ? input : nil
+  }
+}
+
+/// Runs First and then Second on what First produced.
+struct Chain<First : Stage, Second : Stage> : Stage
+  where First.Output == Second.Input {
+  let first: First
+  let second: Second
+
+  func process(_ input: First.Input) -> Second.Output? {
+    guard let intermediate = first.process(input) else {
+      return nil
+    }
+    return second.process(intermediate)
+  }
+}
+
+extension Stage {
+  func then<Next : Stage>(_ next: Next) -> Chain<Self, Next>
+    where Next.Input == Output {
+    return Chain(first: self, second: next)
+  }
+}
+
+/// A type-erased stage, for pipelines that are assembled at run time.
+struct AnyStage<Input, Output> : Stage {
+  let _process: (Input) -> Output?
+
+  init<S : Stage>(_ stage: S) where S.Input == Input, S.Output == Output {
+    _process = stage.process
+  }
+
+  func process(_ input: Input) -> Output? {
+    return _process(input)
+  }
+}
+
+/// Folds the outputs of a pipeline into a result.
+protocol Sink {
+  associatedtype Element
+  mutating func consume(_ element: Element)
+}
@@ -0,0 +1,190 @@
+//===--- HTTPParser.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+let cr = UInt8(ascii: "\r")
+let lf = UInt8(ascii: "\n")
+let space = UInt8(ascii: " ")
+let colon = UInt8(ascii: ":")
+
+func makeString<S : Sequence>(_ bytes: S) -> String
+  where S.Iterator.Element == UInt8 {
+  var result = ""
+  result.unicodeScalars.reserveCapacity(bytes.underestimatedCount)
+  for byte in bytes {
+    result.unicodeScalars.append(UnicodeScalar(byte))
+  }
+  return result
+}
+
+func makeLowercaseString(_ bytes: ArraySlice<UInt8>) -> String {
+  var result = ""
+  result.unicodeScalars.reserveCapacity(bytes.count)
+  for byte in bytes {
+    if byte >= UInt8(ascii: "A") && byte <= UInt8(ascii: "Z") {
+      result.unicodeScalars.append(UnicodeScalar(byte + 0x20))
+    } else {
+      result.unicodeScalars.append(UnicodeScalar(byte))
+    }
+  }
+  return result
+}
+
+func hexValue(_ byte: UInt8) -> UInt8? {
+  switch byte {
+  case UInt8(ascii: "0")...UInt8(ascii: "9"):
+    return byte - UInt8(ascii: "0")
+  case UInt8(ascii: "a")...UInt8(ascii: "f"):
+    return byte - UInt8(ascii: "a") + 10
+  case UInt8(ascii: "A")...UInt8(ascii: "F"):
+    return byte - UInt8(ascii: "A") + 10
+  default:
+    return nil
+  }
+}
+
+/// Decodes the %XX escapes and '+'s of a URL query component.
+func percentDecode(_ bytes: ArraySlice<UInt8>) -> String {
+  var decoded = [UInt8]()
+  decoded.reserveCapacity(bytes.count)
+  var i = bytes.startIndex
+  while i < bytes.endIndex {
+    let byte = bytes[i]
+    if byte == UInt8(ascii: "%") && i + 2 < bytes.endIndex,
+       let high = hexValue(bytes[i + 1]), let low = hexValue(bytes[i + 2]) {
+      decoded.append(high * 16 + low)
+      i += 3
+      continue
+    }
+    decoded.append(byte == UInt8(ascii: "+") ? space : byte)
+    i += 1
+  }
+  return makeString(decoded)
+}
+
+func parseQuery(_ bytes: ArraySlice<UInt8>) -> [String: String] {
+  var query = [String: String]()
+  for pair in bytes.split(separator: UInt8(ascii: "&")) {
+    if let equals = pair.index(of: UInt8(ascii: "=")) {
+      query[percentDecode(pair[pair.startIndex..<equals])] =
+        percentDecode(pair[(equals + 1)..<pair.endIndex])
+    } else {
+      query[percentDecode(pair)] = ""
+    }
+  }
+  return query
+}
+
+/// A parser for HTTP/1.x requests that arrive pipelined in one buffer.
+struct HTTPParser {
+  let buffer: [UInt8]
+  var position = 0
+
+  init(_ buffer: [UInt8]) {
+    self.buffer = buffer
+  }
+
+  var isAtEnd: Bool {
+    return position == buffer.count
+  }
+
+  /// Returns the bytes up to the next CRLF and moves past it.
+  mutating func readLine() throws -> ArraySlice<UInt8> {
+    var end = position
+    while end + 1 < buffer.count {
+      if buffer[end] == cr && buffer[end + 1] == lf {
+        let line = buffer[position..<end]
+        position = end + 2
+        return line
+      }
+      end += 1
+    }
+    throw HTTPParseError.incomplete
+  }
+
+  mutating func parseRequestLine()
+      throws -> (HTTPMethod, String, [String: String], Int) {
+    let line = try readLine()
+    let parts = line.split(separator: space, maxSplits: 2,
+                           omittingEmptySubsequences: false)
+    guard parts.count == 3 else {
+      throw HTTPParseError.malformedRequestLine
+    }
+    let method = HTTPMethod(makeString(parts[0]))
+
+    let target = parts[1]
+    var path = target
+    var query = [String: String]()
+    if let questionMark = target.index(of: UInt8(ascii: "?")) {
+      path = target[target.startIndex..<questionMark]
+      query = parseQuery(target[(questionMark + 1)..<target.endIndex])
+    }
+
+    let version = parts[2]
+    let prefix = Array("HTTP/1.".utf8)
+    guard version.count == prefix.count + 1,
+          version.starts(with: prefix),
+          let minor = hexValue(version[version.endIndex - 1]), minor <= 1
+    else {
+      throw HTTPParseError.malformedRequestLine
+    }
+    return (method, makeString(path), query, Int(minor))
+  }
+
+  mutating func parseHeaders() throws -> [String: String] {
+    var headers = [String: String]()
+    while true {
+      let line = try readLine()
+      if line.isEmpty {
+        return headers
+      }
+      guard let separator = line.index(of: colon) else {
+        throw HTTPParseError.malformedHeader
+      }
+      let name = makeLowercaseString(line[line.startIndex..<separator])
+      var valueStart = separator + 1
+      var valueEnd = line.endIndex
+      while valueStart < valueEnd && line[valueStart] == space {
+        valueStart += 1
+      }
+      while valueEnd > valueStart && line[valueEnd - 1] == space {
+        valueEnd -= 1
+      }
+      let value = makeString(line[valueStart..<valueEnd])
+      if let existing = headers[name] {
+        headers[name] = existing + ", " + value
+      } else {
+        headers[name] = value
+      }
+    }
+  }
+
+  /// Parses the next request of the buffer.
+  mutating func parseRequest() throws -> HTTPRequest {
+    let (method, path, query, minorVersion) = try parseRequestLine()
+    let headers = try parseHeaders()
+    var contentLength = 0
+    if let length = headers["content-length"] {
+      guard let value = Int(length), value >= 0 else {
+        throw HTTPParseError.badContentLength
+      }
+      contentLength = value
+    }
+    if position + contentLength > buffer.count {
+      throw HTTPParseError.incomplete
+    }
+    let body = buffer[position..<(position + contentLength)]
+    position += contentLength
+    return HTTPRequest(method: method, path: path, query: query,
+                       minorVersion: minorVersion, headers: headers,
+                       body: body)
+  }
+}
@@ -0,0 +1,83 @@
+//===--- HTTPParsing.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test parses a buffer of pipelined HTTP/1.1 requests, the way a
+// server does with the bytes it reads from a keep-alive connection.
+import TestsUtils
+
+// Every fourth request is a POST, so this has to be a multiple of four.
+let requestCount = 100
+
+func makeRequests() -> [UInt8] {
+  var text = ""
+  for i in 0..<requestCount {
+    if i % 4 == 3 {
+      let body = "{\"id\": \(i), \"name\": \"item \(i)\"}"
+      text += "POST /api/v1/items HTTP/1.1\r\n"
+      text += "Host: example.com\r\n"
+      text += "Content-Type: application/json\r\n"
+      text += "Content-Length: \(body.utf8.count)\r\n"
+      text += "\r\n"
+      text += body
+    } else {
+      text += "GET /api/v1/items/\(i)?fields=name%2Cprice&q=red+shoes "
+      text += "HTTP/1.1\r\n"
+      text += "Host: example.com\r\n"
+      text += "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_12)\r\n"
+      text += "Accept: text/html,application/xhtml+xml;q=0.9,*/*;q=0.8\r\n"
+      text += "Accept-Encoding: gzip, deflate\r\n"
+      text += "Accept-Language: en-US,en;q=0.5\r\n"
+      text += "Cookie: session=\(1000 + i); theme=dark\r\n"
+      // The last GET closes the connection.
+      let connection = i == requestCount - 2 ? "close" : "keep-alive"
+      text += "Connection: \(connection)\r\n"
+      text += "\r\n"
+    }
+  }
+  return Array(text.utf8)
+}
+
+let requests = makeRequests()
+
+@inline(never)
+public func run_HTTPParsing(_ N: Int) {
+  var posts = 0
+  var bodyBytes = 0
+  var keepAlive = 0
+  var queries = 0
+  for _ in 1...N {
+    var parser = HTTPParser(requests)
+    while !parser.isAtEnd {
+      guard let request = try? parser.parseRequest() else {
+        CheckResults(false, "Failed to parse a request in HTTPParsing")
+        return
+      }
+      if case .post = request.method {
+        posts += 1
+      }
+      bodyBytes += request.body.count
+      if request.keepAlive {
+        keepAlive += 1
+      }
+      if request.query["q"] == "red shoes" {
+        queries += 1
+      }
+    }
+  }
+  CheckResults(posts == N * requestCount / 4,
+               "Incorrect number of POSTs in HTTPParsing")
+  CheckResults(bodyBytes > 0, "Incorrect body sizes in HTTPParsing")
+  CheckResults(keepAlive == N * (requestCount - 1),
+               "Incorrect keep-alive count in HTTPParsing")
+  CheckResults(queries == N * requestCount * 3 / 4,
+               "Incorrect query count in HTTPParsing")
+}
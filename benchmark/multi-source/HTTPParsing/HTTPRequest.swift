@@ -0,0 +1,55 @@
+//===--- HTTPRequest.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+enum HTTPMethod {
+  case get
+  case head
+  case post
+  case put
+  case delete
+  case other(String)
+
+  init(_ name: String) {
+    switch name {
+    case "GET": self = .get
+    case "HEAD": self = .head
+    case "POST": self = .post
+    case "PUT": self = .put
+    case "DELETE": self = .delete
+    default: self = .other(name)
+    }
+  }
+}
+
+enum HTTPParseError : Error {
+  case incomplete
+  case malformedRequestLine
+  case malformedHeader
+  case badContentLength
+}
+
+struct HTTPRequest {
+  var method: HTTPMethod
+  var path: String
+  var query: [String: String]
+  var minorVersion: Int
+  /// The headers, with lowercased names.
+  var headers: [String: String]
+  var body: ArraySlice<UInt8>
+
+  var keepAlive: Bool {
+    if let connection = headers["connection"] {
+      return connection.lowercased() != "close"
+    }
+    return minorVersion >= 1
+  }
+}
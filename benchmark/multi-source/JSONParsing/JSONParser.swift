@@ -0,0 +1,107 @@
+//===--- JSONParser.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// Builds the Foundation-style representation of a JSON document: objects
+/// become [String: Any], arrays [Any], and scalars String, Double, Bool or
+/// NSNull's stand-in, JSONNull.
+struct JSONParser {
+  var tokenizer: JSONTokenizer
+
+  init(_ bytes: [UInt8]) {
+    tokenizer = JSONTokenizer(bytes)
+  }
+
+  mutating func parse() throws -> Any {
+    let value = try parseValue(try nextToken())
+    if let token = try tokenizer.next() {
+      throw JSONError.unexpectedToken(token)
+    }
+    return value
+  }
+
+  mutating func nextToken() throws -> JSONToken {
+    guard let token = try tokenizer.next() else {
+      throw JSONError.unexpectedEnd
+    }
+    return token
+  }
+
+  mutating func parseValue(_ token: JSONToken) throws -> Any {
+    switch token {
+    case .beginObject:
+      return try parseObject()
+    case .beginArray:
+      return try parseArray()
+    case .string(let value):
+      return value
+    case .number(let value):
+      return value
+    case .bool(let value):
+      return value
+    case .null:
+      return JSONNull()
+    default:
+      throw JSONError.unexpectedToken(token)
+    }
+  }
+
+  mutating func parseObject() throws -> [String: Any] {
+    var object = [String: Any]()
+    var token = try nextToken()
+    if case .endObject = token {
+      return object
+    }
+    while true {
+      guard case .string(let key) = token else {
+        throw JSONError.unexpectedToken(token)
+      }
+      let colon = try nextToken()
+      guard case .colon = colon else {
+        throw JSONError.unexpectedToken(colon)
+      }
+      object[key] = try parseValue(try nextToken())
+
+      token = try nextToken()
+      switch token {
+      case .comma:
+        token = try nextToken()
+      case .endObject:
+        return object
+      default:
+        throw JSONError.unexpectedToken(token)
+      }
+    }
+  }
+
+  mutating func parseArray() throws -> [Any] {
+    var array = [Any]()
+    var token = try nextToken()
+    if case .endArray = token {
+      return array
+    }
+    while true {
+      array.append(try parseValue(token))
+
+      token = try nextToken()
+      switch token {
+      case .comma:
+        token = try nextToken()
+      case .endArray:
+        return array
+      default:
+        throw JSONError.unexpectedToken(token)
+      }
+    }
+  }
+}
+
+struct JSONNull {}
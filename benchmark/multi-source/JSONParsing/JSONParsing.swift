@@ -0,0 +1,66 @@
+//===--- JSONParsing.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test parses a REST-style JSON response into dictionaries and arrays
+// of Any, and then reads fields out of them with dynamic casts, like a
+// typical client of JSONSerialization does.
+import TestsUtils
+
+let userCount = 200
+
+func makeDocument() -> [UInt8] {
+  let cities = ["Cupertino", "Zurich", "London", "Tokyo", "Sao Paulo"]
+  var json = "{\"count\": \(userCount), \"users\": ["
+  for i in 0..<userCount {
+    if i != 0 {
+      json += ", "
+    }
+    json += "{\"id\": \(i), \"name\": \"User \\\"\(i)\\\"\", "
+    json += "\"email\": \"user\(i)\\u0040example.com\", "
+    json += "\"active\": \(i % 3 != 0), \"score\": \(Double(i) / 4), "
+    json += "\"ratio\": -1.5e-2, \"manager\": null, "
+    json += "\"tags\": [\"t\(i % 7)\", \"t\(i % 11)\", \"t\(i % 13)\"], "
+    json += "\"address\": {\"city\": \"\(cities[i % cities.count])\", "
+    json += "\"zip\": \"\(10000 + i)\"}}"
+  }
+  json += "]}"
+  return Array(json.utf8)
+}
+
+let document = makeDocument()
+
+@inline(never)
+public func run_JSONParsing(_ N: Int) {
+  var activeScore = 0.0
+  var tagCount = 0
+  for _ in 1...N {
+    var parser = JSONParser(document)
+    guard let parsed = try? parser.parse(),
+          let root = parsed as? [String: Any],
+          let users = root["users"] as? [Any] else {
+      CheckResults(false, "Failed to parse the document in JSONParsing")
+      return
+    }
+    for case let user as [String: Any] in users {
+      if let active = user["active"] as? Bool, active,
+         let score = user["score"] as? Double {
+        activeScore += score
+      }
+      if let tags = user["tags"] as? [Any] {
+        tagCount += tags.count
+      }
+    }
+  }
+  CheckResults(tagCount == N * userCount * 3,
+               "Incorrect tag count in JSONParsing")
+  CheckResults(activeScore > 0, "Incorrect scores in JSONParsing")
+}
@@ -0,0 +1,226 @@
+//===--- JSONTokenizer.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+enum JSONError : Error {
+  case unexpectedEnd
+  case unexpectedByte(UInt8, at: Int)
+  case unexpectedToken(JSONToken)
+}
+
+enum JSONToken {
+  case beginObject
+  case endObject
+  case beginArray
+  case endArray
+  case colon
+  case comma
+  case string(String)
+  case number(Double)
+  case bool(Bool)
+  case null
+}
+
+/// Splits UTF-8 encoded JSON into tokens.
+struct JSONTokenizer {
+  let bytes: [UInt8]
+  var position = 0
+
+  init(_ bytes: [UInt8]) {
+    self.bytes = bytes
+  }
+
+  mutating func skipWhitespace() {
+    while position < bytes.count {
+      switch bytes[position] {
+      case 0x20, 0x09, 0x0A, 0x0D:
+        position += 1
+      default:
+        return
+      }
+    }
+  }
+
+  /// Returns the next token, or nil at the end of the input.
+  mutating func next() throws -> JSONToken? {
+    skipWhitespace()
+    if position == bytes.count {
+      return nil
+    }
+    let byte = bytes[position]
+    switch byte {
+    case UInt8(ascii: "{"):
+      position += 1
+      return .beginObject
+    case UInt8(ascii: "}"):
+      position += 1
+      return .endObject
+    case UInt8(ascii: "["):
+      position += 1
+      return .beginArray
+    case UInt8(ascii: "]"):
+      position += 1
+      return .endArray
+    case UInt8(ascii: ":"):
+      position += 1
+      return .colon
+    case UInt8(ascii: ","):
+      position += 1
+      return .comma
+    case UInt8(ascii: "\""):
+      return .string(try readString())
+    case UInt8(ascii: "-"), UInt8(ascii: "0")...UInt8(ascii: "9"):
+      return .number(try readNumber())
+    case UInt8(ascii: "t"):
+      try expect("true")
+      return .bool(true)
+    case UInt8(ascii: "f"):
+      try expect("false")
+      return .bool(false)
+    case UInt8(ascii: "n"):
+      try expect("null")
+      return .null
+    default:
+      throw JSONError.unexpectedByte(byte, at: position)
+    }
+  }
+
+  mutating func expect(_ word: StaticString) throws {
+    let start = word.utf8Start
+    for i in 0..<word.utf8CodeUnitCount {
+      if position == bytes.count {
+        throw JSONError.unexpectedEnd
+      }
+      if bytes[position] != start[i] {
+        throw JSONError.unexpectedByte(bytes[position], at: position)
+      }
+      position += 1
+    }
+  }
+
+  mutating func readString() throws -> String {
+    // Skip the opening quote.
+    position += 1
+    var result = ""
+    while position < bytes.count {
+      let byte = bytes[position]
+      position += 1
+      switch byte {
+      case UInt8(ascii: "\""):
+        return result
+      case UInt8(ascii: "\\"):
+        if position == bytes.count {
+          throw JSONError.unexpectedEnd
+        }
+        let escaped = bytes[position]
+        position += 1
+        switch escaped {
+        case UInt8(ascii: "n"):
+          result.unicodeScalars.append("\n")
+        case UInt8(ascii: "t"):
+          result.unicodeScalars.append("\t")
+        case UInt8(ascii: "r"):
+          result.unicodeScalars.append("\r")
+        case UInt8(ascii: "u"):
+          result.unicodeScalars.append(try readUnicodeEscape())
+        default:
+          result.unicodeScalars.append(UnicodeScalar(escaped))
+        }
+      default:
+        // The benchmark's documents only contain ASCII outside of escapes.
+        result.unicodeScalars.append(UnicodeScalar(byte))
+      }
+    }
+    throw JSONError.unexpectedEnd
+  }
+
+  mutating func readUnicodeEscape() throws -> UnicodeScalar {
+    if position + 4 > bytes.count {
+      throw JSONError.unexpectedEnd
+    }
+    var value: UInt32 = 0
+    for _ in 0..<4 {
+      let byte = bytes[position]
+      var digit: UInt8
+      switch byte {
+      case UInt8(ascii: "0")...UInt8(ascii: "9"):
+        digit = byte - UInt8(ascii: "0")
+      case UInt8(ascii: "a")...UInt8(ascii: "f"):
+        digit = byte - UInt8(ascii: "a") + 10
+      case UInt8(ascii: "A")...UInt8(ascii: "F"):
+        digit = byte - UInt8(ascii: "A") + 10
+      default:
+        throw JSONError.unexpectedByte(byte, at: position)
+      }
+      value = value * 16 + UInt32(digit)
+      position += 1
+    }
+    return UnicodeScalar(value) ?? "\u{FFFD}"
+  }
+
+  mutating func readNumber() throws -> Double {
+    var negative = false
+    if bytes[position] == UInt8(ascii: "-") {
+      negative = true
+      position += 1
+    }
+    var value = 0.0
+    var sawDigit = false
+    while position < bytes.count, let digit = decimalDigit(bytes[position]) {
+      value = value * 10 + Double(digit)
+      sawDigit = true
+      position += 1
+    }
+    if position < bytes.count && bytes[position] == UInt8(ascii: ".") {
+      position += 1
+      var scale = 0.1
+      while position < bytes.count, let digit = decimalDigit(bytes[position]) {
+        value += Double(digit) * scale
+        scale /= 10
+        sawDigit = true
+        position += 1
+      }
+    }
+    if !sawDigit {
+      if position == bytes.count {
+        throw JSONError.unexpectedEnd
+      }
+      throw JSONError.unexpectedByte(bytes[position], at: position)
+    }
+    if position < bytes.count &&
+       (bytes[position] == UInt8(ascii: "e") ||
+        bytes[position] == UInt8(ascii: "E")) {
+      position += 1
+      var negativeExponent = false
+      if position < bytes.count && (bytes[position] == UInt8(ascii: "-") ||
+                                    bytes[position] == UInt8(ascii: "+")) {
+        negativeExponent = bytes[position] == UInt8(ascii: "-")
+        position += 1
+      }
+      var exponent = 0
+      while position < bytes.count, let digit = decimalDigit(bytes[position]) {
+        exponent = exponent * 10 + digit
+        position += 1
+      }
+      for _ in 0..<exponent {
+        value = negativeExponent ? value / 10 : value * 10
+      }
+    }
+    return negative ? -value : value
+  }
+
+  func decimalDigit(_ byte: UInt8) -> Int? {
+    if byte >= UInt8(ascii: "0") && byte <= UInt8(ascii: "9") {
+      return Int(byte - UInt8(ascii: "0"))
+    }
+    return nil
+  }
+}
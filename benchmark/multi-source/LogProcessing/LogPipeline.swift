@@ -0,0 +1,75 @@
+//===--- LogPipeline.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+struct ServiceSummary {
+  var service: String
+  var requests: Int
+  var errors: Int
+  var medianLatency: Int
+  var p99Latency: Int
+  var slowestUsers: [String]
+}
+
+/// Groups records by service and summarizes each one, slowest services
+/// first.
+func summarize(_ records: [LogRecord]) -> [ServiceSummary] {
+  var byService = [String: [LogRecord]]()
+  for record in records {
+    if byService[record.service] == nil {
+      byService[record.service] = [record]
+    } else {
+      byService[record.service]!.append(record)
+    }
+  }
+
+  var summaries = [ServiceSummary]()
+  for (service, records) in byService {
+    let latencies = records.map { $0.latency }.sorted()
+    let errors = records.filter { $0.level == .error }.count
+
+    var latencyByUser = [String: Int]()
+    for record in records {
+      if let user = record.fields["user"] {
+        latencyByUser[user] = max(latencyByUser[user] ?? 0, record.latency)
+      }
+    }
+    let slowestUsers = latencyByUser.sorted {
+      $0.value != $1.value ? $0.value > $1.value : $0.key < $1.key
+    }.prefix(3).map { $0.key }
+
+    summaries.append(ServiceSummary(
+      service: service, requests: records.count, errors: errors,
+      medianLatency: latencies[latencies.count / 2],
+      p99Latency: latencies[latencies.count * 99 / 100],
+      slowestUsers: slowestUsers))
+  }
+  summaries.sort {
+    $0.p99Latency != $1.p99Latency ? $0.p99Latency > $1.p99Latency
+                                   : $0.service < $1.service
+  }
+  return summaries
+}
+
+/// Returns the most common words of the error messages with their counts.
+func topErrorWords(_ records: [LogRecord], count: Int) -> [(String, Int)] {
+  var counts = [String: Int]()
+  for record in records where record.level == .error {
+    for word in record.message.lowercased().characters.split(separator: " ") {
+      let key = String(word)
+      counts[key] = (counts[key] ?? 0) + 1
+    }
+  }
+  let sorted = counts.sorted {
+    $0.value != $1.value ? $0.value > $1.value : $0.key < $1.key
+  }
+  return sorted.prefix(count).map { ($0.key, $0.value) }
+}
@@ -0,0 +1,68 @@
+//===--- LogProcessing.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test parses service logs and reports the latencies per service and
+// the most common error messages, like a log analysis job does.
+import TestsUtils
+
+let lineCount = 2_000
+
+func makeLog() -> [String] {
+  let services = ["checkout", "search", "auth", "inventory", "payments",
+                  "recommendations"]
+  let levels = ["DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR"]
+  let errors = ["connection reset by peer", "upstream timed out",
+                "invalid session token", "database connection refused",
+                "upstream returned status 503"]
+  func random(_ upperBound: Int) -> Int {
+    return Int(Random() & 0xFFFF) % upperBound
+  }
+  SRand()
+  var lines = [String]()
+  for i in 0..<lineCount {
+    let level = levels[random(levels.count)]
+    let service = services[random(services.count)]
+    var line = "\(1476403200 + i) \(level) \(service)"
+    line += " latency=\(random(500)) user=\(random(97))"
+    if level == "ERROR" {
+      line += " " + errors[random(errors.count)]
+    } else {
+      line += " handled request \(i)"
+    }
+    lines.append(line)
+  }
+  // A malformed line, which has to be skipped.
+  lines.append("-- log rotated --")
+  return lines
+}
+
+let logLines = makeLog()
+
+@inline(never)
+public func run_LogProcessing(_ N: Int) {
+  var services = 0
+  var errorWords = 0
+  for _ in 1...N {
+    let records = logLines.flatMap { LogRecord($0) }
+    CheckResults(records.count == lineCount,
+                 "Incorrect number of records in LogProcessing")
+    let summaries = summarize(records)
+    services += summaries.count
+    for summary in summaries {
+      CheckResults(summary.p99Latency >= summary.medianLatency,
+                   "Incorrect latencies in LogProcessing")
+    }
+    errorWords += topErrorWords(records, count: 5).count
+  }
+  CheckResults(services == N * 6, "Incorrect services in LogProcessing")
+  CheckResults(errorWords == N * 5, "Incorrect error words in LogProcessing")
+}
@@ -0,0 +1,56 @@
+//===--- LogRecord.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+enum LogLevel : String {
+  case debug = "DEBUG"
+  case info = "INFO"
+  case warning = "WARN"
+  case error = "ERROR"
+}
+
+/// One line of a service log, such as
+///
+///     1476403200 INFO checkout latency=12 user=42 completed order
+struct LogRecord {
+  var timestamp: Int
+  var level: LogLevel
+  var service: String
+  var latency: Int
+  var fields: [String: String]
+  var message: String
+
+  /// Parses a log line, or returns nil if it is malformed.
+  init?(_ line: String) {
+    let words = line.characters.split(separator: " ").map(String.init)
+    guard words.count >= 3,
+          let timestamp = Int(words[0]),
+          let level = LogLevel(rawValue: words[1]) else {
+      return nil
+    }
+    self.timestamp = timestamp
+    self.level = level
+    self.service = words[2]
+
+    fields = [:]
+    var messageWords = [String]()
+    for word in words[3..<words.count] {
+      let parts = word.characters.split(separator: "=", maxSplits: 1)
+      if messageWords.isEmpty && parts.count == 2 {
+        fields[String(parts[0])] = String(parts[1])
+      } else {
+        messageWords.append(word)
+      }
+    }
+    latency = fields["latency"].flatMap { Int($0) } ?? 0
+    message = messageWords.joined(separator: " ")
+  }
+}
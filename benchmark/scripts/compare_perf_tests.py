@@ -15,6 +15,7 @@
 
 import argparse
 import csv
+import math
 import sys
 
 TESTNAME = 1
@@ -24,6 +25,12 @@ MAX = 4
 MEAN = 5
 SD = 6
 MEDIAN = 7
+# Only present in the output of Benchmark_O --memory.
+MEMORY_METRICS = [(8, "MAX_RSS(B)"), (9, "ALLOC_OBJECTS"), (10, "SLOW_ALLOCS"),
+                  (11, "RETAINS"), (12, "RELEASES")]
+# Only present in the output of Benchmark_Driver --counters, which names its
+# columns in a header row.
+COUNTER_METRICS = ["INSTRUCTIONS"]
 
 HTML = """
 <!DOCTYPE html>
@@ -73,6 +80,9 @@ PAIN_DETAIL = """
 
 RATIO_MIN = None
 RATIO_MAX = None
+# With fewer runs of a test than this in either file, changes can't be
+# significant at the usual levels, so only the delta threshold is used.
+MIN_SIGNIFICANCE_SAMPLES = 4
 
 
 def main():
@@ -81,6 +91,8 @@ def main():
 
     old_results = {}
     new_results = {}
+    old_samples = {}
+    new_samples = {}
     old_max_results = {}
     new_max_results = {}
     ratio_list = {}
@@ -93,11 +105,15 @@ def main():
 
     parser = argparse.ArgumentParser(description="Compare Performance tests.")
     parser.add_argument('--old-file',
-                        help='Baseline performance test suite (csv file)',
-                        required=True)
+                        help='Baseline performance test suite (csv file)')
     parser.add_argument('--new-file',
-                        help='New performance test suite (csv file)',
-                        required=True)
+                        help='New performance test suite (csv file)')
+    parser.add_argument('--opt-modes',
+                        help='Instead of comparing two files, write an HTML '
+                             'report of the output of Benchmark_OptModes')
+    parser.add_argument('--baseline-mode',
+                        help='The mode the others are compared to in the '
+                             '--opt-modes report', default="O")
     parser.add_argument('--format',
                         help='Supported format git, html and markdown',
                         default="markdown")
@@ -110,9 +126,26 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--significance',
+                        help='Only report changes whose Mann-Whitney U test '
+                             'p-value is below this, for tests that ran at '
+                             'least {0} times in both files'.format(
+                                 MIN_SIGNIFICANCE_SAMPLES),
+                        default="0.05")
 
     args = parser.parse_args()
 
+    if args.opt_modes:
+        if not args.output:
+            print("Error: missing --output flag.")
+            sys.exit(1)
+        rows = list(csv.reader(open(args.opt_modes)))
+        write_to_file(args.output,
+                      convert_opt_modes_to_html(rows, args.baseline_mode))
+        return
+    if not args.old_file or not args.new_file:
+        parser.error("--old-file and --new-file are required")
+
     old_file = args.old_file
     new_file = args.new_file
 
@@ -125,8 +158,12 @@ def main():
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
 
-    for row in old_data:
+    old_rows = list(old_data)
+    new_rows = list(new_data)
+
+    for row in old_rows:
         if (len(row) > 7 and row[MIN].isdigit()):
+            old_samples.setdefault(row[TESTNAME], []).append(int(row[MIN]))
             if row[TESTNAME] in old_results:
                 if old_results[row[TESTNAME]] > int(row[MIN]):
                     old_results[row[TESTNAME]] = int(row[MIN])
@@ -136,8 +173,9 @@ def main():
                 old_results[row[TESTNAME]] = int(row[MIN])
                 old_max_results[row[TESTNAME]] = int(row[MAX])
 
-    for row in new_data:
+    for row in new_rows:
         if (len(row) > 7 and row[MIN].isdigit()):
+            new_samples.setdefault(row[TESTNAME], []).append(int(row[MIN]))
             if row[TESTNAME] in new_results:
                 if int(new_results[row[TESTNAME]]) > int(row[MIN]):
                     new_results[row[TESTNAME]] = int(row[MIN])
@@ -147,6 +185,7 @@ def main():
                 new_results[row[TESTNAME]] = int(row[MIN])
                 new_max_results[row[TESTNAME]] = int(row[MAX])
 
+    insignificant = set()
     ratio_total = 0
     for key in new_results.keys():
             ratio = (old_results[key] + 0.001) / (new_results[key] + 0.001)
@@ -162,11 +201,18 @@ def main():
                     unknown_list[key] = "(?)"
             else:
                     unknown_list[key] = ""
+            if (len(old_samples[key]) >= MIN_SIGNIFICANCE_SAMPLES and
+                    len(new_samples[key]) >= MIN_SIGNIFICANCE_SAMPLES):
+                p_value = mann_whitney_u(old_samples[key], new_samples[key])
+                if p_value >= float(args.significance):
+                    insignificant.add(key)
+                    unknown_list[key] = "(?)"
 
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only,
+                                         insignificant)
 
     """
     Create markdown formatted table
@@ -235,6 +281,36 @@ def main():
                                                 len(normal_perf_list),
                                                 markdown_normal, "")
 
+    memory_regressions = find_memory_regressions(old_rows, new_rows)
+    markdown_memory = ""
+    for i, (key, metric, old, new) in enumerate(memory_regressions):
+        if i == 0:
+            markdown_memory = "\n" + MARKDOWN_ROW.format(
+                "TEST", "METRIC", old_branch.replace("MIN", "MEM"),
+                new_branch.replace("MIN", "MEM"), "")
+            markdown_memory += MARKDOWN_ROW.format(
+                HEADER_SPLIT, HEADER_SPLIT, HEADER_SPLIT, HEADER_SPLIT, "")
+        markdown_memory += MARKDOWN_ROW.format(key, metric, old, new, "")
+    if memory_regressions:
+        markdown_data += MARKDOWN_DETAIL.format("Memory Regression",
+                                                len(memory_regressions),
+                                                markdown_memory, "open")
+
+    counter_regressions = find_counter_regressions(old_rows, new_rows)
+    markdown_counters = ""
+    for i, (key, metric, old, new) in enumerate(counter_regressions):
+        if i == 0:
+            markdown_counters = "\n" + MARKDOWN_ROW.format(
+                "TEST", "METRIC", old_branch.replace("MIN", "COUNT"),
+                new_branch.replace("MIN", "COUNT"), "")
+            markdown_counters += MARKDOWN_ROW.format(
+                HEADER_SPLIT, HEADER_SPLIT, HEADER_SPLIT, HEADER_SPLIT, "")
+        markdown_counters += MARKDOWN_ROW.format(key, metric, old, new, "")
+    if counter_regressions:
+        markdown_data += MARKDOWN_DETAIL.format("Instruction Count Regression",
+                                                len(counter_regressions),
+                                                markdown_counters, "open")
+
     if args.format:
         if args.format.lower() != "markdown":
             pain_data = PAIN_DETAIL.format("Regression", markdown_regression)
@@ -242,6 +318,12 @@ def main():
                                             markdown_improvement)
             if not args.changes_only:
                 pain_data += PAIN_DETAIL.format("No Changes", markdown_normal)
+            if memory_regressions:
+                pain_data += PAIN_DETAIL.format("Memory Regression",
+                                                markdown_memory)
+            if counter_regressions:
+                pain_data += PAIN_DETAIL.format(
+                    "Instruction Count Regression", markdown_counters)
 
             print(pain_data.replace("|", " ").replace("-", " "))
         else:
@@ -254,7 +336,8 @@ def main():
             """
             html_data = convert_to_html(ratio_list, old_results, new_results,
                                         delta_list, unknown_list, old_branch,
-                                        new_branch, args.changes_only)
+                                        new_branch, args.changes_only,
+                                        insignificant)
 
             if args.output:
                 write_to_file(args.output, html_data)
@@ -269,16 +352,135 @@ def main():
             sys.exit(1)
 
 
+def mann_whitney_u(old, new):
+    """
+    Return the two-sided p-value of the Mann-Whitney U test of whether old
+    and new come from the same distribution. This uses the normal
+    approximation with a continuity and tie correction, which is close
+    enough from MIN_SIGNIFICANCE_SAMPLES samples on.
+    """
+    values = sorted([(v, 0) for v in old] + [(v, 1) for v in new])
+    n1 = len(old)
+    n2 = len(new)
+    n = n1 + n2
+
+    # Rank the values, giving tied values the mean of their ranks.
+    rank_sum = 0.0
+    tie_term = 0.0
+    i = 0
+    while i < n:
+        j = i
+        while j < n and values[j][0] == values[i][0]:
+            j += 1
+        rank = (i + 1 + j) / 2.0
+        rank_sum += rank * sum(1 for _, side in values[i:j] if side == 0)
+        tie_term += (j - i) ** 3 - (j - i)
+        i = j
+
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = max(abs(u - mean) - 0.5, 0) / math.sqrt(variance)
+    return math.erfc(z / math.sqrt(2))
+
+
+def metric_columns(rows, metrics):
+    """
+    Return (index, metric) for each of metrics that has a column in rows.
+    Columns are found by name in a header row, or at their Benchmark_O
+    --memory positions in output without one.
+    """
+    for row in rows:
+        if row and row[0] == "#":
+            return [(row.index(metric), metric) for metric in metrics
+                    if metric in row]
+    return [(index, metric) for index, metric in MEMORY_METRICS
+            if metric in metrics]
+
+
+def metric_results(rows, columns):
+    """
+    Return {test: [value]} with the smallest value of each of columns over
+    all rows of a test.
+    """
+    results = {}
+    if not columns:
+        return results
+    last = max(index for index, _ in columns)
+    for row in rows:
+        if len(row) > last and row[MIN].isdigit():
+            values = [int(float(row[index])) for index, _ in columns]
+            if row[TESTNAME] in results:
+                values = [min(a, b) for a, b in
+                          zip(results[row[TESTNAME]], values)]
+            results[row[TESTNAME]] = values
+    return results
+
+
+def find_metric_regressions(old_rows, new_rows, metrics, limit):
+    """
+    Return (test, metric, old, new) for each of metrics that grew above
+    limit(metric, old).
+    """
+    old_columns = metric_columns(old_rows, metrics)
+    new_columns = metric_columns(new_rows, metrics)
+    shared = [metric for _, metric in new_columns
+              if metric in [m for _, m in old_columns]]
+    old_columns = [c for c in old_columns if c[1] in shared]
+    new_columns = [c for c in new_columns if c[1] in shared]
+    old_results = metric_results(old_rows, old_columns)
+    new_results = metric_results(new_rows, new_columns)
+
+    regressions = []
+    for key in sorted(new_results.keys()):
+        if key not in old_results:
+            continue
+        old_values = dict(zip([m for _, m in old_columns], old_results[key]))
+        for (_, metric), new in zip(new_columns, new_results[key]):
+            old = old_values[metric]
+            if new > limit(metric, old):
+                regressions.append((key, metric, old, new))
+    return regressions
+
+
+def find_memory_regressions(old_rows, new_rows):
+    """
+    Return (test, metric, old, new) for each memory metric that got worse.
+    Peak RSS is noisy, so it has to grow by more than the delta threshold;
+    the runtime call counts are exact, so any increase is reported.
+    """
+    return find_metric_regressions(
+        old_rows, new_rows, [metric for _, metric in MEMORY_METRICS],
+        lambda metric, old: old * RATIO_MAX if metric == "MAX_RSS(B)"
+        else old)
+
+
+def find_counter_regressions(old_rows, new_rows):
+    """
+    Return (test, metric, old, new) for each hardware counter that grew by
+    more than the delta threshold. Instruction counts barely depend on the
+    load of the machine, so they make a much less noisy gate than time.
+    """
+    return find_metric_regressions(old_rows, new_rows, COUNTER_METRICS,
+                                   lambda metric, old: old * RATIO_MAX)
+
+
 def convert_to_html(ratio_list, old_results, new_results, delta_list,
-                    unknown_list, old_branch, new_branch, changes_only):
+                    unknown_list, old_branch, new_branch, changes_only,
+                    insignificant=()):
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, changes_only,
+                                         insignificant)
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if key in insignificant:
+            color = "black"
+        elif ratio_list[key] < RATIO_MIN:
             color = "red"
         elif ratio_list[key] > RATIO_MAX:
             color = "green"
@@ -310,6 +512,68 @@ def convert_to_html(ratio_list, old_results, new_results, delta_list,
     return html_data
 
 
+def convert_opt_modes_to_html(rows, baseline):
+    """
+    Return an HTML report of Benchmark_OptModes output: a summary of the
+    total runtime and text size of each mode, and the runtime and code size
+    of each test in each mode, relative to the baseline mode.
+    """
+    totals = {}
+    results = {}
+    for row in rows:
+        if len(row) < 6:
+            continue
+        if row[0] == "Totals":
+            totals[row[1]] = (int(row[3]), int(row[4]))
+        elif row[0].isdigit():
+            results.setdefault(row[2], {})[row[1]] = \
+                (int(row[3]), int(row[4]), int(row[5]))
+    modes = sorted(totals.keys())
+    if baseline not in totals and modes:
+        baseline = modes[0]
+
+    def relative(value, base):
+        if not base:
+            return ""
+        return " ({0:.2f}x)".format(float(value) / base)
+
+    def cell(text):
+        return "<td align='left'>{0}</td>".format(text)
+
+    def header(*titles):
+        return "<tr>" + "".join("<th align='left'>{0}</th>".format(t)
+                                for t in titles) + "</tr>"
+
+    summary = header("MODE", "TOTAL MIN(μs)", "TEXT SIZE(B)")
+    for mode in modes:
+        time, size = totals[mode]
+        base_time, base_size = totals[baseline]
+        summary += "<tr>" + cell(mode) + \
+            cell(str(time) + relative(time, base_time)) + \
+            cell(str(size) + relative(size, base_size)) + "</tr>"
+
+    details = header("TEST", *[title.format(mode) for mode in modes
+                               for title in ["{0} MIN(μs)",
+                                             "{0} FUNCTION(B)",
+                                             "{0} MODULE(B)"]])
+    for test in sorted(results.keys()):
+        details += "<tr>" + cell(test)
+        base = results[test].get(baseline)
+        for mode in modes:
+            if mode not in results[test]:
+                details += cell("") * 3
+                continue
+            for i, value in enumerate(results[test][mode]):
+                details += cell(str(value) +
+                                (relative(value, base[i]) if base else ""))
+        details += "</tr>"
+
+    return HTML.format("<h3>Optimization modes (relative to {0})</h3>"
+                       "<table>{1}</table><h3>Tests</h3>"
+                       "<table>{2}</table>".format(baseline, summary,
+                                                   details))
+
+
 def write_to_file(file_name, data):
     """
     Write data to given file
@@ -319,9 +583,10 @@ def write_to_file(file_name, data):
     file.close
 
 
-def sort_ratio_list(ratio_list, changes_only=False):
+def sort_ratio_list(ratio_list, changes_only=False, insignificant=()):
     """
-    Return 3 sorted list improvement, regression and normal.
+    Return 3 sorted list improvement, regression and normal. Tests in
+    insignificant count as normal whatever their ratio.
     """
     decreased_perf_list = []
     increased_perf_list = []
@@ -329,7 +594,9 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        if key in insignificant:
+            normal_perf_list[key] = v
+        elif ratio_list[key] < RATIO_MIN:
             decreased_perf_list.append(key)
         elif ratio_list[key] > RATIO_MAX:
             increased_perf_list.append(key)
@@ -45,12 +45,12 @@ if __name__ == '__main__':
 
         def __init__(self, path):
             self.name = os.path.basename(path)
-            self.files = [x for x in os.listdir(path)
-                          if x.endswith('.swift')]
+            self.files = sorted(x for x in os.listdir(path)
+                                if x.endswith('.swift'))
     if os.path.isdir(multi_source_dir):
         multisource_benches = [
             MultiSourceBench(os.path.join(multi_source_dir, x))
-            for x in os.listdir(multi_source_dir)
+            for x in sorted(os.listdir(multi_source_dir))
             if os.path.isdir(os.path.join(multi_source_dir, x))
         ]
     else:
@@ -73,12 +73,18 @@ if __name__ == '__main__':
                     run_funcs = get_run_funcs(os.path.join(root, name))
                     ret_run_funcs.extend(run_funcs)
         return ret_run_funcs
-    run_funcs = sorted(
+    all_run_funcs = sorted(
         [(x, x)
          for x in find_run_funcs([single_source_dir, multi_source_dir])],
         key=lambda x: x[0]
     )
 
+    # Tests that need many cores are too noisy to run before every commit.
+    def is_other_test(run_func):
+        return run_func[0].startswith('ThreadScaling')
+    run_funcs = [x for x in all_run_funcs if not is_other_test(x)]
+    other_run_funcs = [x for x in all_run_funcs if is_other_test(x)]
+
     # Replace originals with files generated from templates
     for template_file in template_map:
         template_path = os.path.join(script_dir, template_file)
@@ -88,5 +94,6 @@ if __name__ == '__main__':
             template.render(tests=tests,
                             multisource_benches=multisource_benches,
                             imports=imports,
-                            run_funcs=run_funcs)
+                            run_funcs=run_funcs,
+                            other_run_funcs=other_run_funcs)
         )
@@ -0,0 +1,150 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# ===--- perf_trends.py --------------------------------------------------===//
+#
+#  This source file is part of the Swift.org open source project
+#
+#  Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+#  Licensed under Apache License v2.0 with Runtime Library Exception
+#
+#  See http://swift.org/LICENSE.txt for license information
+#  See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ===---------------------------------------------------------------------===//
+
+# Find step changes in a history of benchmark runs, such as the results of
+# nightly builds, stored as JSON by utils/convertToJSON.py:
+#
+#   $ Benchmark_O | convertToJSON.py --commit=<rev> --output=runs/<rev>.json
+#   $ perf_trends.py runs/*.json
+#
+# A step is a point in the history where the median of the runs after it
+# differs from the median of the runs before it by more than the threshold
+# and by more than the noise of either side. Single outliers move neither
+# median, so they aren't reported.
+
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+MARKDOWN_ROW = "{0} | {1} | {2} | {3} | {4}\n"
+HEADER_SPLIT = "---"
+
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    if len(values) % 2:
+        return values[middle]
+    return (values[middle - 1] + values[middle]) / 2.0
+
+
+def median_absolute_deviation(values):
+    center = median(values)
+    return median([abs(v - center) for v in values])
+
+
+def load_runs(paths):
+    """Return the runs in paths ordered by their start time."""
+    runs = []
+    for path in paths:
+        with open(path) as f:
+            run = json.load(f)
+        run['Path'] = path
+        runs.append(run)
+    runs.sort(key=lambda run: (run.get('Run', {}).get('Start Time', ''),
+                               run['Path']))
+    return runs
+
+
+def run_label(run):
+    info = run.get('Run', {}).get('Info', {})
+    return info.get('commit') or run['Path']
+
+
+def series(runs):
+    """Return {test: [(run index, value)]} of the MIN values of each test."""
+    result = {}
+    for index, run in enumerate(runs):
+        for test in run.get('Tests', []):
+            name = test['Name'][0]
+            if name == 'Totals' or not test['Data']:
+                continue
+            result.setdefault(name, []).append((index, test['Data'][0]))
+    return result
+
+
+def find_steps(points, window, threshold, noise_factor):
+    """Return (index of the first run after the step, old, new) for each
+    step change in points, a list of (run index, value)."""
+    steps = []
+    i = window
+    while i <= len(points) - window:
+        before = [v for _, v in points[i - window:i]]
+        after = [v for _, v in points[i:i + window]]
+        old = median(before)
+        new = median(after)
+        noise = max(median_absolute_deviation(before),
+                    median_absolute_deviation(after))
+        change = abs(new - old)
+        if old > 0 and change > old * threshold and \
+                change > noise * noise_factor:
+            # Find where in the window the step is sharpest.
+            best = i
+            best_change = change
+            for j in range(i + 1, min(i + window, len(points) - window + 1)):
+                candidate = abs(median([v for _, v in points[j:j + window]]) -
+                                median([v for _, v in
+                                        points[j - window:j]]))
+                if candidate > best_change:
+                    best = j
+                    best_change = candidate
+            steps.append((points[best][0],
+                          median([v for _, v in points[best - window:best]]),
+                          median([v for _, v in
+                                  points[best:best + window]])))
+            # Don't report the same step again from the next positions.
+            i = best + window
+        else:
+            i += 1
+    return steps
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Find step changes in a history of benchmark runs.')
+    parser.add_argument('runs', nargs='+',
+                        help='JSON files written by convertToJSON.py')
+    parser.add_argument('--window', type=int, default=3,
+                        help='number of runs on each side of a step '
+                             '(default: 3)')
+    parser.add_argument('--threshold', type=float, default=0.05,
+                        help='smallest relative change to report '
+                             '(default: 0.05)')
+    parser.add_argument('--noise-factor', type=float, default=3.0,
+                        help='how many median absolute deviations a step '
+                             'must exceed (default: 3)')
+    args = parser.parse_args()
+
+    runs = load_runs(args.runs)
+    report = ""
+    for test, points in sorted(series(runs).items()):
+        for index, old, new in find_steps(points, args.window,
+                                          args.threshold, args.noise_factor):
+            delta = "{0:+.1f}%".format((float(new) / old - 1) * 100)
+            report += MARKDOWN_ROW.format(test, run_label(runs[index]),
+                                          old, new, delta)
+    if not report:
+        print("No step changes in {0} runs.".format(len(runs)))
+        return 0
+    print(MARKDOWN_ROW.format("TEST", "FIRST CHANGED RUN", "BEFORE", "AFTER",
+                              "DELTA") +
+          MARKDOWN_ROW.format(*[HEADER_SPLIT] * 5) + report, end="")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,71 @@
+#!/usr/bin/python
+# -*- coding: utf-8 -*-
+
+# ===--- thread_scaling.py -----------------------------------------------===//
+#
+#  This source file is part of the Swift.org open source project
+#
+#  Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+#  Licensed under Apache License v2.0 with Runtime Library Exception
+#
+#  See http://swift.org/LICENSE.txt for license information
+#  See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ===---------------------------------------------------------------------===//
+
+# Compute the scaling efficiency of the ThreadScaling benchmarks from the
+# output of a benchmark driver, e.g.
+#
+#   Benchmark_O --run-all ThreadScalingTypeName1 ThreadScalingTypeName8 \
+#     > results.csv
+#   thread_scaling.py results.csv
+#
+# Every thread of a ThreadScaling test does the same work, so the efficiency
+# on k threads is the time on one thread divided by the time on k threads:
+# 100% means no contention at all.
+
+import argparse
+import csv
+import re
+import sys
+
+TESTNAME = 1
+MIN = 3
+
+TEST_RE = re.compile(r"^ThreadScaling(\w+?)(\d+)$")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Report the scaling of the ThreadScaling benchmarks.")
+    parser.add_argument('file', help='Benchmark results (csv file)')
+    args = parser.parse_args()
+
+    # workload -> {threads: fastest time}
+    results = {}
+    for row in csv.reader(open(args.file)):
+        if len(row) <= MIN or not row[MIN].isdigit():
+            continue
+        m = TEST_RE.match(row[TESTNAME])
+        if not m:
+            continue
+        times = results.setdefault(m.group(1), {})
+        threads = int(m.group(2))
+        time = int(row[MIN])
+        times[threads] = min(time, times.get(threads, time))
+
+    print("{0:<20} {1:>8} {2:>12} {3:>11}".format(
+        "WORKLOAD", "THREADS", "MIN(us)", "EFFICIENCY"))
+    for workload in sorted(results.keys()):
+        times = results[workload]
+        for threads in sorted(times.keys()):
+            efficiency = "?"
+            if 1 in times and times[threads] > 0:
+                efficiency = "{0:.0f}%".format(
+                    100.0 * times[1] / times[threads])
+            print("{0:<20} {1:>8} {2:>12} {3:>11}".format(
+                workload, threads, times[threads], efficiency))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,86 @@
+//===--- CrossModuleGenerics.swift ----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests call generic and protocol code of another module, which can't
+// be specialized here. The *InModule tests run the same code from inside
+// the library, where it can be, and CrossModuleGenericsResilient runs it
+// against a resilient build of the library.
+import TestsUtils
+import CrossModuleLibrary
+
+let shapeCount = 1_000
+let squares = makeSquares(shapeCount)
+let shapes = makeShapes(shapeCount)
+let squaresArea = squares.reduce(0) { $0 + $1.side * $1.side }
+
+@inline(never)
+public func run_CrossModuleGeneric(_ N: Int) {
+  for _ in 1...100*N {
+    CheckResults(totalArea(squares) == squaresArea,
+                 "Incorrect results in CrossModuleGeneric")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleGenericInModule(_ N: Int) {
+  for _ in 1...100*N {
+    CheckResults(totalAreaInModule(squares) == squaresArea,
+                 "Incorrect results in CrossModuleGenericInModule")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleExistential(_ N: Int) {
+  let expected = totalAreaOfShapesInModule(shapes)
+  for _ in 1...100*N {
+    var total = 0
+    for shape in shapes {
+      total += shape.area
+    }
+    CheckResults(total == expected,
+                 "Incorrect results in CrossModuleExistential")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleExistentialInModule(_ N: Int) {
+  let expected = totalAreaOfShapesInModule(shapes)
+  for _ in 1...100*N {
+    CheckResults(totalAreaOfShapesInModule(shapes) == expected,
+                 "Incorrect results in CrossModuleExistentialInModule")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleStack(_ N: Int) {
+  let expected = shapeCount * (shapeCount - 1) / 2
+  for _ in 1...100*N {
+    var stack = Stack<Int>()
+    for i in 0..<shapeCount {
+      stack.push(i)
+    }
+    var total = 0
+    while let element = stack.pop() {
+      total += element
+    }
+    CheckResults(total == expected, "Incorrect results in CrossModuleStack")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleStackInModule(_ N: Int) {
+  let expected = shapeCount * (shapeCount - 1) / 2
+  for _ in 1...100*N {
+    CheckResults(stackRoundTripInModule(shapeCount) == expected,
+                 "Incorrect results in CrossModuleStackInModule")
+  }
+}
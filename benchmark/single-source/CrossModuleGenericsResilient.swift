@@ -0,0 +1,59 @@
+//===--- CrossModuleGenericsResilient.swift -------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// The tests of CrossModuleGenerics against a library built with
+// -enable-resilience, whose types have unknown layout outside of it.
+import TestsUtils
+import CrossModuleLibraryResilient
+
+let shapeCount = 1_000
+let squares = makeSquares(shapeCount)
+let shapes = makeShapes(shapeCount)
+let squaresArea = squares.reduce(0) { $0 + $1.side * $1.side }
+
+@inline(never)
+public func run_CrossModuleGenericResilient(_ N: Int) {
+  for _ in 1...100*N {
+    CheckResults(totalArea(squares) == squaresArea,
+                 "Incorrect results in CrossModuleGenericResilient")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleExistentialResilient(_ N: Int) {
+  let expected = totalAreaOfShapesInModule(shapes)
+  for _ in 1...100*N {
+    var total = 0
+    for shape in shapes {
+      total += shape.area
+    }
+    CheckResults(total == expected,
+                 "Incorrect results in CrossModuleExistentialResilient")
+  }
+}
+
+@inline(never)
+public func run_CrossModuleStackResilient(_ N: Int) {
+  let expected = shapeCount * (shapeCount - 1) / 2
+  for _ in 1...100*N {
+    var stack = Stack<Int>()
+    for i in 0..<shapeCount {
+      stack.push(i)
+    }
+    var total = 0
+    while let element = stack.pop() {
+      total += element
+    }
+    CheckResults(total == expected,
+                 "Incorrect results in CrossModuleStackResilient")
+  }
+}
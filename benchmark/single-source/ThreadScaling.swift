@@ -0,0 +1,205 @@
+//===--- ThreadScaling.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests check how runtime entry points that share state between
+// threads scale. Every thread does the same amount of work, so with no
+// contention a test takes as long on k threads as on one;
+// scripts/thread_scaling.py computes the scaling efficiency from the
+// results.
+import TestsUtils
+import Darwin
+
+final class ThreadBody {
+  let body: () -> ()
+  init(_ body: @escaping () -> ()) {
+    self.body = body
+  }
+}
+
+/// Run body on numThreads threads at once and wait for all of them.
+func runOnThreads(_ numThreads: Int, _ body: @escaping () -> ()) {
+  var threads = [pthread_t?]()
+  for _ in 0..<numThreads {
+    var thread: pthread_t? = nil
+    let context = Unmanaged.passRetained(ThreadBody(body)).toOpaque()
+    let result = pthread_create(&thread, nil, { context in
+      let body = Unmanaged<ThreadBody>.fromOpaque(context).takeRetainedValue()
+      body.body()
+      return nil
+    }, context)
+    CheckResults(result == 0, "pthread_create failed")
+    threads.append(thread)
+  }
+  for thread in threads {
+    pthread_join(thread!, nil)
+  }
+}
+
+// Atomic reference counting on one object shared by all threads.
+
+final class SharedObject {
+  var value = 0
+}
+
+var sharedObject = SharedObject()
+
+@inline(never)
+func useObject(_ object: SharedObject) -> Int {
+  return object.value
+}
+
+func runRetainRelease(_ N: Int, threads: Int) {
+  runOnThreads(threads) {
+    var sum = 0
+    for _ in 0..<(N * 10_000) {
+      let object = sharedObject
+      sum += useObject(object)
+    }
+    CheckResults(sum == 0, "Incorrect results in ThreadScalingRetainRelease")
+  }
+}
+
+// swift_getTypeName, which caches names behind a lock.
+
+struct Box<T> {
+  var value: T
+}
+
+@inline(never)
+func getTypeName(_ type: Any.Type) -> String {
+  return _typeName(type)
+}
+
+func runTypeName(_ N: Int, threads: Int) {
+  runOnThreads(threads) {
+    var length = 0
+    for _ in 0..<(N * 1_000) {
+      length += getTypeName(Box<Int>.self).utf8.count
+    }
+    CheckResults(length > 0, "Incorrect results in ThreadScalingTypeName")
+  }
+}
+
+// Dynamic casts to a protocol, which consult the conformance cache.
+
+protocol Shape {
+  func area() -> Int
+}
+
+struct Square : Shape {
+  var side: Int
+  func area() -> Int { return side * side }
+}
+
+@inline(never)
+func castToShape(_ value: Any) -> Shape? {
+  return value as? Shape
+}
+
+func runDynamicCast(_ N: Int, threads: Int) {
+  runOnThreads(threads) {
+    let value: Any = Square(side: 2)
+    var area = 0
+    for _ in 0..<(N * 1_000) {
+      area += castToShape(value)?.area() ?? 0
+    }
+    CheckResults(area == N * 4_000,
+                 "Incorrect results in ThreadScalingDynamicCast")
+  }
+}
+
+@inline(never)
+public func run_ThreadScalingRetainRelease1(_ N: Int) {
+  runRetainRelease(N, threads: 1)
+}
+@inline(never)
+public func run_ThreadScalingRetainRelease2(_ N: Int) {
+  runRetainRelease(N, threads: 2)
+}
+@inline(never)
+public func run_ThreadScalingRetainRelease4(_ N: Int) {
+  runRetainRelease(N, threads: 4)
+}
+@inline(never)
+public func run_ThreadScalingRetainRelease8(_ N: Int) {
+  runRetainRelease(N, threads: 8)
+}
+@inline(never)
+public func run_ThreadScalingRetainRelease16(_ N: Int) {
+  runRetainRelease(N, threads: 16)
+}
+@inline(never)
+public func run_ThreadScalingRetainRelease32(_ N: Int) {
+  runRetainRelease(N, threads: 32)
+}
+@inline(never)
+public func run_ThreadScalingRetainRelease64(_ N: Int) {
+  runRetainRelease(N, threads: 64)
+}
+
+@inline(never)
+public func run_ThreadScalingTypeName1(_ N: Int) {
+  runTypeName(N, threads: 1)
+}
+@inline(never)
+public func run_ThreadScalingTypeName2(_ N: Int) {
+  runTypeName(N, threads: 2)
+}
+@inline(never)
+public func run_ThreadScalingTypeName4(_ N: Int) {
+  runTypeName(N, threads: 4)
+}
+@inline(never)
+public func run_ThreadScalingTypeName8(_ N: Int) {
+  runTypeName(N, threads: 8)
+}
+@inline(never)
+public func run_ThreadScalingTypeName16(_ N: Int) {
+  runTypeName(N, threads: 16)
+}
+@inline(never)
+public func run_ThreadScalingTypeName32(_ N: Int) {
+  runTypeName(N, threads: 32)
+}
+@inline(never)
+public func run_ThreadScalingTypeName64(_ N: Int) {
+  runTypeName(N, threads: 64)
+}
+
+@inline(never)
+public func run_ThreadScalingDynamicCast1(_ N: Int) {
+  runDynamicCast(N, threads: 1)
+}
+@inline(never)
+public func run_ThreadScalingDynamicCast2(_ N: Int) {
+  runDynamicCast(N, threads: 2)
+}
+@inline(never)
+public func run_ThreadScalingDynamicCast4(_ N: Int) {
+  runDynamicCast(N, threads: 4)
+}
+@inline(never)
+public func run_ThreadScalingDynamicCast8(_ N: Int) {
+  runDynamicCast(N, threads: 8)
+}
+@inline(never)
+public func run_ThreadScalingDynamicCast16(_ N: Int) {
+  runDynamicCast(N, threads: 16)
+}
+@inline(never)
+public func run_ThreadScalingDynamicCast32(_ N: Int) {
+  runDynamicCast(N, threads: 32)
+}
+@inline(never)
+public func run_ThreadScalingDynamicCast64(_ N: Int) {
+  runDynamicCast(N, threads: 64)
+}
@@ -0,0 +1,113 @@
+//===--- CrossModuleLibrary.swift -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// A generic library for the CrossModuleGenerics benchmarks, which call it
+// from another module. It is built twice, as CrossModuleLibrary and with
+// -enable-resilience as CrossModuleLibraryResilient.
+//
+// The *InModule functions do the same work as the benchmarks from inside
+// this module, where the optimizer can specialize it.
+
+public protocol Shape {
+  var area: Int { get }
+}
+
+public struct Square : Shape {
+  public var side: Int
+
+  public init(side: Int) {
+    self.side = side
+  }
+
+  public var area: Int {
+    return side * side
+  }
+}
+
+public struct Rectangle : Shape {
+  public var width: Int
+  public var height: Int
+
+  public init(width: Int, height: Int) {
+    self.width = width
+    self.height = height
+  }
+
+  public var area: Int {
+    return width * height
+  }
+}
+
+/// Sums the areas of shapes of a single type.
+public func totalArea<S : Shape>(_ shapes: [S]) -> Int {
+  var total = 0
+  for shape in shapes {
+    total += shape.area
+  }
+  return total
+}
+
+public struct Stack<Element> {
+  var elements = [Element]()
+
+  public init() {}
+
+  public var isEmpty: Bool {
+    return elements.isEmpty
+  }
+
+  public mutating func push(_ element: Element) {
+    elements.append(element)
+  }
+
+  public mutating func pop() -> Element? {
+    return elements.isEmpty ? nil : elements.removeLast()
+  }
+}
+
+public func makeSquares(_ count: Int) -> [Square] {
+  return (0..<count).map { Square(side: $0 % 16) }
+}
+
+public func makeShapes(_ count: Int) -> [Shape] {
+  return (0..<count).map {
+    $0 % 2 == 0 ? Square(side: $0 % 16) as Shape
+                : Rectangle(width: $0 % 16, height: 3) as Shape
+  }
+}
+
+@inline(never)
+public func totalAreaInModule(_ squares: [Square]) -> Int {
+  return totalArea(squares)
+}
+
+@inline(never)
+public func totalAreaOfShapesInModule(_ shapes: [Shape]) -> Int {
+  var total = 0
+  for shape in shapes {
+    total += shape.area
+  }
+  return total
+}
+
+@inline(never)
+public func stackRoundTripInModule(_ count: Int) -> Int {
+  var stack = Stack<Int>()
+  for i in 0..<count {
+    stack.push(i)
+  }
+  var total = 0
+  while let element = stack.pop() {
+    total += element
+  }
+  return total
+}
@@ -12,6 +12,24 @@
 
 import Darwin
 
+/// Memory use and runtime calls of a test. The counts are per iteration, the
+/// smallest over all samples.
+struct MemoryResults {
+  var delim: String  = ","
+  /// The peak resident set size of the whole process so far, in bytes.
+  var maxRSS: UInt64 = 0
+  var allocObjects: UInt64 = 0
+  var slowAllocs: UInt64 = 0
+  var retains: UInt64 = 0
+  var releases: UInt64 = 0
+}
+
+extension MemoryResults : CustomStringConvertible {
+  var description: String {
+     return "\(maxRSS)\(delim)\(allocObjects)\(delim)\(slowAllocs)\(delim)\(retains)\(delim)\(releases)"
+  }
+}
+
 struct BenchResults {
   var delim: String  = ","
   var sampleCount: UInt64 = 0
@@ -20,6 +38,7 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  var memory: MemoryResults?
   init() {}
   init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
     self.delim = delim
@@ -41,7 +60,11 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     let timing = "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     if let memory = memory {
+       return timing + delim + memory.description
+     }
+     return timing
   }
 }
 
@@ -88,6 +111,22 @@ struct TestConfig {
   /// The number of samples we should take of each test.
   var numSamples: Int = 1
 
+  /// If non-zero, keep taking samples after the first numSamples until the
+  /// 95% confidence interval of the mean is within this many percent of the
+  /// mean, maxSamples have been taken or timeBudget has run out.
+  var targetCI: Double = 0
+
+  /// The most samples to take of a test when sampling to a targetCI.
+  var maxSamples: Int = 100
+
+  /// If non-zero, the number of seconds after which to stop sampling a test
+  /// to a targetCI.
+  var timeBudget: Double = 0
+
+  /// Should samples outside the Tukey fences of the samples be dropped before
+  /// computing the results?
+  var discardOutliers: Bool = false
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
@@ -98,13 +137,19 @@ struct TestConfig {
   /// like leaks that require a PID to run on the test harness.
   var afterRunSleep: Int?
 
+  /// Should we report peak memory use and the runtime calls made by each
+  /// test? Counting runtime calls needs a runtime built with
+  /// SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS.
+  var measureMemory: Bool = false
+
   /// The list of tests to run.
   var tests = [Test]()
 
   mutating func processArguments() -> TestAction {
     let validOptions = [
       "--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"
+      "--verbose", "--delim", "--run-all", "--list", "--sleep", "--memory",
+      "--target-ci", "--max-samples", "--time-budget", "--discard-outliers"
     ]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
@@ -131,6 +176,31 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--target-ci"] {
+      guard let v = Double(x), v > 0 else {
+        return .Fail("--target-ci requires a positive percentage")
+      }
+      targetCI = v
+    }
+
+    if let x = benchArgs.optionalArgsMap["--max-samples"] {
+      guard let v = Int(x), v > 0 else {
+        return .Fail("--max-samples requires a positive integer value")
+      }
+      maxSamples = v
+    }
+
+    if let x = benchArgs.optionalArgsMap["--time-budget"] {
+      guard let v = Double(x), v > 0 else {
+        return .Fail("--time-budget requires a positive number of seconds")
+      }
+      timeBudget = v
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--discard-outliers"] {
+      discardOutliers = true
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -156,6 +226,14 @@ struct TestConfig {
       afterRunSleep = v!
     }
 
+    if let _ = benchArgs.optionalArgsMap["--memory"] {
+#if SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS
+      measureMemory = true
+#else
+      return .Fail("--memory requires a runtime built with function counters")
+#endif
+    }
+
     filters = benchArgs.positionalArgs
 
     return .Run
@@ -217,6 +295,48 @@ func internalMedian(_ inputs: [UInt64]) -> UInt64 {
   return inputs.sorted()[inputs.count / 2]
 }
 
+/// Drop the samples outside the Tukey fences, 1.5 interquartile ranges below
+/// the first or above the third quartile. There are no meaningful quartiles
+/// of fewer than four samples, so those are returned as is.
+func internalDiscardOutliers(_ inputs: [UInt64]) -> [UInt64] {
+  if inputs.count < 4 {
+    return inputs
+  }
+  let sorted = inputs.sorted()
+  let q1 = Double(sorted[sorted.count / 4])
+  let q3 = Double(sorted[(sorted.count * 3) / 4])
+  let iqr = q3 - q1
+  return inputs.filter {
+    Double($0) >= q1 - 1.5 * iqr && Double($0) <= q3 + 1.5 * iqr
+  }
+}
+
+/// The two-sided 95% quantile of Student's t-distribution with the given
+/// degrees of freedom.
+func studentT95(_ degreesOfFreedom: Int) -> Double {
+  let table: [Double] = [
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  ]
+  if degreesOfFreedom <= table.count {
+    return table[degreesOfFreedom - 1]
+  }
+  return 1.96
+}
+
+/// The half-width of the 95% confidence interval of the mean of the samples,
+/// in percent of the mean.
+func internalRelativeCI(_ inputs: [UInt64]) -> Double {
+  let (mean, sd) = internalMeanSD(inputs)
+  if inputs.count < 2 || mean == 0 {
+    return 0
+  }
+  let halfWidth =
+    studentT95(inputs.count - 1) * Double(sd) / sqrt(Double(inputs.count))
+  return 100 * halfWidth / Double(mean)
+}
+
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
 
 @_silgen_name("swift_leaks_startTrackingObjects")
@@ -226,6 +346,41 @@ func stopTrackingObjects(_: UnsafeMutableRawPointer) -> Int
 
 #endif
 
+#if SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS
+
+@_silgen_name("swift_getRuntimeFunctionCallCount")
+func getRuntimeFunctionCallCount(_: UnsafePointer<CChar>) -> UInt64
+
+#endif
+
+/// The number of calls the whole process has made to the runtime functions
+/// we report, so far.
+struct RuntimeCallCounts {
+  var allocObjects: UInt64 = 0
+  var slowAllocs: UInt64 = 0
+  var retains: UInt64 = 0
+  var releases: UInt64 = 0
+
+  static func current() -> RuntimeCallCounts {
+    var counts = RuntimeCallCounts()
+#if SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS
+    counts.allocObjects = getRuntimeFunctionCallCount("swift_allocObject")
+    counts.slowAllocs = getRuntimeFunctionCallCount("swift_slowAlloc")
+    counts.retains = getRuntimeFunctionCallCount("swift_retain") +
+                     getRuntimeFunctionCallCount("swift_retain_n")
+    counts.releases = getRuntimeFunctionCallCount("swift_release") +
+                      getRuntimeFunctionCallCount("swift_release_n")
+#endif
+    return counts
+  }
+}
+
+func getMaxRSS() -> UInt64 {
+  var usage = rusage()
+  getrusage(RUSAGE_SELF, &usage)
+  return UInt64(usage.ru_maxrss)
+}
+
 class SampleRunner {
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
   init() {
@@ -254,14 +409,44 @@ class SampleRunner {
 /// Invoke the benchmark entry point and return the run time in milliseconds.
 func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResults {
 
-  var samples = [UInt64](repeating: 0, count: c.numSamples)
+  var samples = [UInt64]()
 
   if c.verbose {
-    print("Running \(name) for \(c.numSamples) samples.")
+    if c.targetCI > 0 {
+      print("Running \(name) for \(c.numSamples) to \(c.maxSamples) samples.")
+    } else {
+      print("Running \(name) for \(c.numSamples) samples.")
+    }
+  }
+
+  var memory: MemoryResults? = nil
+  if c.measureMemory {
+    memory = MemoryResults()
+    memory!.delim = c.delim
   }
 
   let sampler = SampleRunner()
-  for s in 0..<c.numSamples {
+  let startTicks = mach_absolute_time()
+
+  /// Should we take another sample to reach the target confidence interval?
+  func needsMoreSamples() -> Bool {
+    if c.targetCI == 0 || samples.count >= c.maxSamples {
+      return false
+    }
+    if c.timeBudget > 0 {
+      let elapsedTicks = mach_absolute_time() - startTicks
+      let elapsedNanoseconds =
+        elapsedTicks * UInt64(sampler.info.numer) / UInt64(sampler.info.denom)
+      if Double(elapsedNanoseconds) >= c.timeBudget * 1_000_000_000 {
+        return false
+      }
+    }
+    let kept = c.discardOutliers ? internalDiscardOutliers(samples) : samples
+    return internalRelativeCI(kept) > c.targetCI
+  }
+
+  var s = 0
+  while s < c.numSamples || needsMoreSamples() {
     let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
 
     var scale : UInt
@@ -275,6 +460,7 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
     }
 
     // Rerun the test with the computed scale factor.
+    let countsBefore = RuntimeCallCounts.current()
     if scale > 1 {
       if c.verbose {
         print("    Measuring with scale \(scale).")
@@ -282,26 +468,76 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
       elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
     } else {
       scale = 1
+      if memory != nil {
+        // The calls of the run that computed the scale weren't counted, so
+        // run it once more.
+        elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
+      }
+    }
+    if memory != nil {
+      let countsAfter = RuntimeCallCounts.current()
+      let iters = UInt64(scale)
+      let allocObjects =
+        (countsAfter.allocObjects - countsBefore.allocObjects) / iters
+      let slowAllocs = (countsAfter.slowAllocs - countsBefore.slowAllocs) / iters
+      let retains = (countsAfter.retains - countsBefore.retains) / iters
+      let releases = (countsAfter.releases - countsBefore.releases) / iters
+      if s == 0 {
+        memory!.allocObjects = allocObjects
+        memory!.slowAllocs = slowAllocs
+        memory!.retains = retains
+        memory!.releases = releases
+      } else {
+        memory!.allocObjects = Swift.min(memory!.allocObjects, allocObjects)
+        memory!.slowAllocs = Swift.min(memory!.slowAllocs, slowAllocs)
+        memory!.retains = Swift.min(memory!.retains, retains)
+        memory!.releases = Swift.min(memory!.releases, releases)
+      }
     }
     // save result in microseconds or k-ticks
-    samples[s] = elapsed_time / UInt64(scale) / 1000
+    samples.append(elapsed_time / UInt64(scale) / 1000)
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
+    s += 1
+  }
+
+  if c.discardOutliers {
+    let kept = internalDiscardOutliers(samples)
+    if c.verbose && kept.count != samples.count {
+      print("    Discarded \(samples.count - kept.count) outliers.")
+    }
+    samples = kept
+  }
+  if c.verbose && samples.count > 1 {
+    print("    95% CI of the mean: +-\(internalRelativeCI(samples))%")
   }
 
   let (mean, sd) = internalMeanSD(samples)
 
   // Return our benchmark results.
-  return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
-                      min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+  var results = BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
+                             min: samples.min()!, max: samples.max()!,
+                             mean: mean, sd: sd, median: internalMedian(samples))
+  if memory != nil {
+    memory!.maxRSS = getMaxRSS()
+  }
+  results.memory = memory
+  return results
 }
 
 func printRunInfo(_ c: TestConfig) {
   if c.verbose {
     print("--- CONFIG ---")
     print("NumSamples: \(c.numSamples)")
+    if c.targetCI > 0 {
+      print("TargetCI: \(c.targetCI)%")
+      print("MaxSamples: \(c.maxSamples)")
+      if c.timeBudget > 0 {
+        print("TimeBudget: \(c.timeBudget)s")
+      }
+    }
+    print("DiscardOutliers: \(c.discardOutliers)")
     print("Verbose: \(c.verbose)")
     print("IterScale: \(c.iterationScale)")
     if c.fixedNumIters != 0 {
@@ -322,7 +558,11 @@ func printRunInfo(_ c: TestConfig) {
 
 func runBenchmarks(_ c: TestConfig) {
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  var header = "#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))"
+  if c.measureMemory {
+    header += "\(c.delim)MAX_RSS(B)\(c.delim)ALLOC_OBJECTS\(c.delim)SLOW_ALLOCS\(c.delim)RETAINS\(c.delim)RELEASES"
+  }
+  print(header)
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
 
@@ -13,7 +13,8 @@
 # ===---------------------------------------------------------------------===//
 
 # This script converts results from pre-commit benchmark tests to JSON.
-# Usage: PrecommitBench_O | convertToJSON.py
+# Usage: PrecommitBench_O | convertToJSON.py [--commit=C] [--machine=M]
+#                                            [--flags=F] [--output=FILE]
 #
 # Input example:
 #   #,TEST,SAMPLES,MIN(ms),MAX(ms),MEAN(ms),SD(ms),MEDIAN(ms)
@@ -22,29 +23,40 @@
 #
 #   Totals,2,2123,2123,2123,0,0
 #
-# Output for this input:
+# Output for this input, with --commit=1a2b3c --machine=bot1 --flags=-O:
 # {
-#     "Machine": {},
-#     "Run": {},
+#     "Machine": {
+#         "Info": {
+#             "hardware": "x86_64",
+#             "os": "Darwin-16.0.0-x86_64-i386-64bit"
+#         },
+#         "Name": "bot1"
+#     },
+#     "Run": {
+#         "Info": {
+#             "commit": "1a2b3c",
+#             "flags": "-O",
+#             "schema_version": "1"
+#         },
+#         "Start Time": "2016-10-14 12:00:00"
+#     },
 #     "Tests": [
 #         {
 #             "Data": [
 #                 1318
 #             ],
-#             "Info": {},
+#             "Info": {
+#                 "MAX(ms)": 1318,
+#                 "MEAN(ms)": 1318,
+#                 "MEDIAN(ms)": 1318,
+#                 "SAMPLES": 1,
+#                 "SD(ms)": 0
+#             },
 #             "Name": [
 #                 "2Sum"
 #             ]
 #         },
-#         {
-#             "Data": [
-#                 805
-#             ],
-#             "Info": {},
-#             "Name": [
-#                 "Ackermann"
-#             ]
-#         },
+#         ...
 #         {
 #             "Data": [
 #                 2123
@@ -56,11 +68,21 @@
 #         }
 #     ]
 # }
+#
+# "Data" always holds the MIN column. "Info" has the other columns named by
+# the header, including the memory and counter columns of some drivers.
+# Consumers such as scripts/perf_trends.py rely on this layout; bump
+# SCHEMA_VERSION when changing it incompatibly.
 
+import argparse
+import datetime
 import json
+import platform
 import re
 import sys
 
+SCHEMA_VERSION = "1"
+
 # Parse lines like this
 # #,TEST,SAMPLES,MIN(ms),MAX(ms),MEAN(ms),SD(ms),MEDIAN(ms)
 SCORERE = re.compile(r"(\d+),[ \t]*(\w+),[ \t]*([\d.]+),[ \t]*([\d.]+)")
@@ -69,13 +91,38 @@ SCORERE = re.compile(r"(\d+),[ \t]*(\w+),[ \t]*([\d.]+),[ \t]*([\d.]+)")
 TOTALRE = re.compile(r"()(Totals),[ \t]*([\d.]+),[ \t]*([\d.]+)")
 KEYGROUP = 2
 VALGROUP = 4
+MINCOLUMN = 3
 
-if __name__ == "__main__":
+
+def number(value):
+    try:
+        return int(value)
+    except ValueError:
+        return float(value)
+
+
+def convert(lines, commit=None, machine=None, flags=None, start_time=None):
+    """Return the JSON object for the benchmark output in lines."""
     data = {}
     data['Tests'] = []
-    data['Machine'] = {}
-    data['Run'] = {}
-    for line in sys.stdin:
+    data['Machine'] = {
+        'Info': {'hardware': platform.machine(), 'os': platform.platform()},
+        'Name': machine or platform.node()}
+    run_info = {'schema_version': SCHEMA_VERSION}
+    if commit:
+        run_info['commit'] = commit
+    if flags:
+        run_info['flags'] = flags
+    data['Run'] = {
+        'Info': run_info,
+        'Start Time': start_time or
+        datetime.datetime.utcnow().strftime('%Y-%m-%d %H:%M:%S')}
+
+    header = None
+    for line in lines:
+        if line.startswith('#'):
+            header = [column.strip() for column in line.strip().split(',')]
+            continue
         m = SCORERE.match(line)
         if not m:
             m = TOTALRE.match(line)
@@ -85,5 +132,35 @@ if __name__ == "__main__":
         test['Data'] = [int(m.group(VALGROUP))]
         test['Info'] = {}
         test['Name'] = [m.group(KEYGROUP)]
+        if header and m.group(KEYGROUP) != 'Totals':
+            values = line.strip().split(',')
+            for i, column in enumerate(header):
+                # Skip the index, the name and MIN, which is the Data.
+                if i < 2 or i == MINCOLUMN or i >= len(values):
+                    continue
+                try:
+                    test['Info'][column] = number(values[i])
+                except ValueError:
+                    pass
         data['Tests'].append(test)
-    print(json.dumps(data, sort_keys=True, indent=4))
+    return data
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Convert benchmark results to JSON.')
+    parser.add_argument('--commit', help='The revision that was measured')
+    parser.add_argument('--machine',
+                        help='The name of the machine (default: host name)')
+    parser.add_argument('--flags', help='The flags the tests were built with')
+    parser.add_argument('--output', help='Write to this file, not stdout')
+    args = parser.parse_args()
+
+    data = convert(sys.stdin, commit=args.commit, machine=args.machine,
+                   flags=args.flags)
+    output = json.dumps(data, sort_keys=True, indent=4)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(output + '\n')
+    else:
+        print(output)
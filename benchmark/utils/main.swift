@@ -38,6 +38,8 @@ import Calculator
 import CaptureProp
 import Chars
 import ClassArrayGetter
+import CrossModuleGenerics
+import CrossModuleGenericsResilient
 import DeadArray
 import DictTest
 import DictTest2
@@ -48,14 +50,18 @@ import DictionaryRemove
 import DictionarySwap
 import ErrorHandling
 import Fibonacci
+import GenericPipeline
 import GlobalClass
+import HTTPParsing
 import Hanoi
 import Hash
 import Histogram
 import Integrate
 import IterateData
+import JSONParsing
 import Join
 import LinkedList
+import LogProcessing
 import MapReduce
 import Memset
 import MonteCarloE
@@ -94,6 +100,7 @@ import StringInterpolation
 import StringTests
 import StringWalk
 import SuperChars
+import ThreadScaling
 import TwoSum
 import TypeFlood
 import UTF8Decode
@@ -123,6 +130,15 @@ precommitTests = [
   "CaptureProp": run_CaptureProp,
   "Chars": run_Chars,
   "ClassArrayGetter": run_ClassArrayGetter,
+  "CrossModuleExistential": run_CrossModuleExistential,
+  "CrossModuleExistentialInModule": run_CrossModuleExistentialInModule,
+  "CrossModuleExistentialResilient": run_CrossModuleExistentialResilient,
+  "CrossModuleGeneric": run_CrossModuleGeneric,
+  "CrossModuleGenericInModule": run_CrossModuleGenericInModule,
+  "CrossModuleGenericResilient": run_CrossModuleGenericResilient,
+  "CrossModuleStack": run_CrossModuleStack,
+  "CrossModuleStackInModule": run_CrossModuleStackInModule,
+  "CrossModuleStackResilient": run_CrossModuleStackResilient,
   "DeadArray": run_DeadArray,
   "Dictionary": run_Dictionary,
   "Dictionary2": run_Dictionary2,
@@ -137,14 +153,18 @@ precommitTests = [
   "DictionarySwap": run_DictionarySwap,
   "DictionarySwapOfObjects": run_DictionarySwapOfObjects,
   "ErrorHandling": run_ErrorHandling,
+  "GenericPipeline": run_GenericPipeline,
   "GlobalClass": run_GlobalClass,
+  "HTTPParsing": run_HTTPParsing,
   "Hanoi": run_Hanoi,
   "HashTest": run_HashTest,
   "Histogram": run_Histogram,
   "Integrate": run_Integrate,
   "IterateData": run_IterateData,
+  "JSONParsing": run_JSONParsing,
   "Join": run_Join,
   "LinkedList": run_LinkedList,
+  "LogProcessing": run_LogProcessing,
   "MapReduce": run_MapReduce,
   "Memset": run_Memset,
   "MonteCarloE": run_MonteCarloE,
@@ -241,6 +261,27 @@ precommitTests = [
 otherTests = [
   "Ackermann": run_Ackermann,
   "Fibonacci": run_Fibonacci,
+  "ThreadScalingDynamicCast1": run_ThreadScalingDynamicCast1,
+  "ThreadScalingDynamicCast16": run_ThreadScalingDynamicCast16,
+  "ThreadScalingDynamicCast2": run_ThreadScalingDynamicCast2,
+  "ThreadScalingDynamicCast32": run_ThreadScalingDynamicCast32,
+  "ThreadScalingDynamicCast4": run_ThreadScalingDynamicCast4,
+  "ThreadScalingDynamicCast64": run_ThreadScalingDynamicCast64,
+  "ThreadScalingDynamicCast8": run_ThreadScalingDynamicCast8,
+  "ThreadScalingRetainRelease1": run_ThreadScalingRetainRelease1,
+  "ThreadScalingRetainRelease16": run_ThreadScalingRetainRelease16,
+  "ThreadScalingRetainRelease2": run_ThreadScalingRetainRelease2,
+  "ThreadScalingRetainRelease32": run_ThreadScalingRetainRelease32,
+  "ThreadScalingRetainRelease4": run_ThreadScalingRetainRelease4,
+  "ThreadScalingRetainRelease64": run_ThreadScalingRetainRelease64,
+  "ThreadScalingRetainRelease8": run_ThreadScalingRetainRelease8,
+  "ThreadScalingTypeName1": run_ThreadScalingTypeName1,
+  "ThreadScalingTypeName16": run_ThreadScalingTypeName16,
+  "ThreadScalingTypeName2": run_ThreadScalingTypeName2,
+  "ThreadScalingTypeName32": run_ThreadScalingTypeName32,
+  "ThreadScalingTypeName4": run_ThreadScalingTypeName4,
+  "ThreadScalingTypeName64": run_ThreadScalingTypeName64,
+  "ThreadScalingTypeName8": run_ThreadScalingTypeName8,
 ]
 
 
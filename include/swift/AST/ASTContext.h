@@ -29,6 +29,7 @@
 #include "swift/Basic/Malloc.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/PointerIntPair.h"
@@ -51,6 +52,7 @@ namespace swift {
   class ASTContext;
   enum class Associativity : unsigned char;
   class BoundGenericType;
+  class BraceStmt;
   class ClangNode;
   class Decl;
   class DeclContext;
@@ -104,6 +106,29 @@ enum class AllocationArena {
   ConstraintSolver
 };
 
+/// The kinds of AST node whose allocations -print-ast-memory-stats counts.
+enum class ASTAllocationKind : uint8_t {
+  Decl,
+  Expr,
+  Stmt,
+  Pattern,
+  Type,
+  Conformance,
+};
+enum { NumASTAllocationKinds = 6 };
+
+/// Where the AST nodes being allocated come from, for
+/// -print-ast-memory-stats.
+enum class ASTAllocationSource : uint8_t {
+  /// Parsed from source, or synthesized while compiling it.
+  Parsed,
+  /// Deserialized from a Swift module.
+  Deserialized,
+  /// Imported from Clang.
+  Imported,
+};
+enum { NumASTAllocationSources = 3 };
+
 /// Lists the set of "known" Foundation entities that are used in the
 /// compiler.
 ///
@@ -231,7 +256,34 @@ public:
   /// Cache of remapped types (useful for diagnostics).
   llvm::StringMap<Type> RemappedTypes;
 
+  /// Cache of the base names declared anywhere within function and closure
+  /// bodies, so unqualified lookup can skip bodies that cannot contain a
+  /// local declaration with the name being looked up.
+  llvm::DenseMap<const BraceStmt *, llvm::DenseSet<Identifier>>
+    LocalDeclNamesInBody;
+
+  /// Extensions in other source files that have not been bound yet, keyed
+  /// by the name of the type they extend. They are bound the first time the
+  /// extensions of a nominal type with that name are requested.
+  llvm::DenseMap<Identifier, TinyPtrVector<ExtensionDecl *>>
+    UnboundExtensions;
+
+  /// Symbol names that have already been mangled, keyed by the entity they
+  /// name and a discriminator chosen by the client that mangled them (for
+  /// example, the kind and flags of a SIL constant).
+  llvm::DenseMap<std::pair<const void *, unsigned>, std::string>
+    MangledNameCache;
+
 private:
+  /// Whether AST node allocations are being counted.
+  bool CountASTAllocations = false;
+
+  /// The source that AST node allocations are attributed to.
+  ASTAllocationSource CurrentAllocationSource = ASTAllocationSource::Parsed;
+
+  void recordASTAllocationImpl(ASTAllocationKind kind, size_t bytes,
+                               AllocationArena arena) const;
+
   /// \brief The current generation number, which reflects the number of
   /// times that external modules have been loaded.
   ///
@@ -548,6 +600,10 @@ public:
   /// one.
   void loadExtensions(NominalTypeDecl *nominal, unsigned previousGeneration);
 
+  /// Bind the extensions in \c UnboundExtensions that may extend the given
+  /// nominal type, if there is a lazy resolver to bind them with.
+  void bindUnboundExtensions(NominalTypeDecl *nominal);
+
   /// \brief Load the methods within the given class that produce
   /// Objective-C class or instance methods with the given selector.
   ///
@@ -707,6 +763,30 @@ public:
   /// Take the conformance loader and context data for the given declaration.
   std::pair<LazyMemberLoader *, uint64_t> takeConformanceLoader(Decl *decl);
 
+  /// Start counting AST node allocations for -print-ast-memory-stats.
+  void enableASTMemoryStats() { CountASTAllocations = true; }
+
+  /// Count an allocation of \p bytes for an AST node of kind \p kind, if
+  /// -print-ast-memory-stats is enabled.
+  void recordASTAllocation(ASTAllocationKind kind, size_t bytes,
+                           AllocationArena arena =
+                             AllocationArena::Permanent) const {
+    if (CountASTAllocations)
+      recordASTAllocationImpl(kind, bytes, arena);
+  }
+
+  /// Attribute subsequent AST node allocations to \p source, returning the
+  /// previous source.
+  ASTAllocationSource setASTAllocationSource(ASTAllocationSource source) {
+    auto old = CurrentAllocationSource;
+    CurrentAllocationSource = source;
+    return old;
+  }
+
+  /// Print the AST node allocations counted since enableASTMemoryStats, by
+  /// kind, source and arena.
+  void printASTMemoryStats(llvm::raw_ostream &OS) const;
+
   /// \brief Returns memory usage of this ASTContext.
   size_t getTotalMemory() const;
   
@@ -775,6 +855,13 @@ public:
   ArchetypeBuilder *getOrCreateArchetypeBuilder(CanGenericSignature sig,
                                                 ModuleDecl *mod);
 
+  /// Retrieve or create the generic environment for the archetypes of the
+  /// stored archetype builder for the given canonical generic signature and
+  /// module.
+  GenericEnvironment *getOrCreateCanonicalGenericEnvironment(
+                        CanGenericSignature sig,
+                        ModuleDecl *mod);
+
   /// Retrieve the inherited name set for the given class.
   const InheritedNameSet *getAllPropertyNames(ClassDecl *classDecl,
                                               bool forInstance);
@@ -848,6 +935,22 @@ bool fixDeclarationObjCName(InFlightDiagnostic &diag, ValueDecl *decl,
                             Optional<ObjCSelector> targetNameOpt,
                             bool ignoreImpliedName = false);
 
+/// Attributes the AST nodes allocated during its lifetime to a particular
+/// source, for -print-ast-memory-stats.
+class ASTAllocationSourceRAII {
+  ASTContext &Ctx;
+  ASTAllocationSource OldSource;
+
+public:
+  ASTAllocationSourceRAII(ASTContext &ctx, ASTAllocationSource source)
+    : Ctx(ctx), OldSource(ctx.setASTAllocationSource(source)) {}
+
+  ASTAllocationSourceRAII(const ASTAllocationSourceRAII &) = delete;
+  ASTAllocationSourceRAII &operator=(const ASTAllocationSourceRAII &) = delete;
+
+  ~ASTAllocationSourceRAII() { Ctx.setASTAllocationSource(OldSource); }
+};
+
 } // end namespace swift
 
 #endif
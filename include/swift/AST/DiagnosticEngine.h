@@ -428,6 +428,12 @@ namespace swift {
     /// state such as fatality into account.
     Behavior determineBehavior(DiagID id);
 
+    /// \brief Whether determineBehavior would ignore the given diagnostic in
+    /// the current state, without recording anything.
+    bool willIgnore(DiagID id) const {
+      return computeBehavior(id) == Behavior::Ignore;
+    }
+
     bool hadAnyError() const { return anyErrorOccurred; }
     bool hasFatalErrorOccurred() const { return fatalErrorOccurred; }
 
@@ -454,6 +460,8 @@ namespace swift {
     }
 
   private:
+    Behavior computeBehavior(DiagID id) const;
+
     // Make the state movable only
     DiagnosticState(const DiagnosticState &) = delete;
     const DiagnosticState &operator=(const DiagnosticState &) = delete;
@@ -526,6 +534,15 @@ namespace swift {
       state.setDiagnosticBehavior(id, DiagnosticState::Behavior::Ignore);
     }
 
+    /// \brief Whether a diagnostic with the given ID would be dropped if it
+    /// were emitted now, so that callers can skip the work of building it.
+    ///
+    /// While a transaction is open, diagnostics are only filtered when it
+    /// commits, so this conservatively returns false.
+    bool isIgnored(DiagID id) const {
+      return TransactionCount == 0 && state.willIgnore(id);
+    }
+
     void resetHadAnyError() {
       state.resetHadAnyError();
     }
@@ -561,7 +578,7 @@ namespace swift {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
       ActiveDiagnostic = Diagnostic(ID, Args);
       ActiveDiagnostic->setLoc(Loc);
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
 
     /// \brief Emit a diagnostic using a preformatted array of diagnostic
@@ -595,7 +612,7 @@ namespace swift {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
       ActiveDiagnostic = D;
       ActiveDiagnostic->setLoc(Loc);
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
     
     /// \brief Emit a diagnostic with the given set of diagnostic arguments.
@@ -614,7 +631,7 @@ namespace swift {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
       ActiveDiagnostic = Diagnostic(ID, std::move(Args)...);
       ActiveDiagnostic->setLoc(Loc);
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
 
     /// \brief Emit a diagnostic with the given set of diagnostic arguments.
@@ -633,7 +650,7 @@ namespace swift {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
       ActiveDiagnostic = Diagnostic(ID, std::move(Args)...);
       ActiveDiagnostic->setLoc(Loc.getBaseNameLoc());
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
 
     /// \brief Emit a diagnostic using a preformatted array of diagnostic
@@ -654,7 +671,7 @@ namespace swift {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
       ActiveDiagnostic = Diagnostic(id, args);
       ActiveDiagnostic->setDecl(decl);
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
 
     /// \brief Emit an already-constructed diagnostic referencing the given
@@ -671,7 +688,7 @@ namespace swift {
       assert(!ActiveDiagnostic && "Already have an active diagnostic");
       ActiveDiagnostic = diag;
       ActiveDiagnostic->setDecl(decl);
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
 
     /// \brief Emit a diagnostic with the given set of diagnostic arguments.
@@ -689,7 +706,7 @@ namespace swift {
              typename detail::PassArgument<ArgTypes>::type... args) {
       ActiveDiagnostic = Diagnostic(id, std::move(args)...);
       ActiveDiagnostic->setDecl(decl);
-      return InFlightDiagnostic(*this);
+      return startActiveDiagnostic();
     }
 
     /// \returns true if diagnostic is marked with PointsToFirstBadToken
@@ -697,6 +714,11 @@ namespace swift {
     bool isDiagnosticPointsToFirstBadToken(DiagID id) const;
 
   private:
+    /// \brief Return an in-flight diagnostic for the active diagnostic. A
+    /// diagnostic that is known to be ignored is dropped right away, so that
+    /// the ranges and fix-its the caller attaches to it aren't computed.
+    InFlightDiagnostic startActiveDiagnostic();
+
     /// \brief Flush the active diagnostic.
     void flushActiveDiagnostic();
     
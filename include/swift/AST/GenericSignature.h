@@ -26,6 +26,7 @@
 namespace swift {
 
 class ArchetypeBuilder;
+class GenericEnvironment;
 class ProtocolConformanceRef;
 class ProtocolType;
 class Substitution;
@@ -225,6 +226,14 @@ public:
   void Profile(llvm::FoldingSetNodeID &ID) {
     Profile(ID, getGenericParams(), getRequirements());
   }
+
+  /// Retrieve the generic environment for the canonical form of this
+  /// signature, which is shared by every signature with the same canonical
+  /// form.
+  ///
+  /// Its archetypes are named after the canonical generic parameters, so it
+  /// should only be used where they won't be shown to the user.
+  GenericEnvironment *getCanonicalGenericEnvironment(ModuleDecl &mod);
   
   /// Determine whether the given dependent type is required to be a class.
   bool requiresClass(Type type, ModuleDecl &mod);
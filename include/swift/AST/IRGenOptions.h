@@ -83,6 +83,10 @@ public:
   /// used to force-load this module.
   std::string ForceLoadSymbolName;
 
+  /// If non-empty, the directory in which the JIT keeps the object code of
+  /// the modules it ran.
+  std::string JITCachePath;
+
   /// The kind of compilation we should do.
   IRGenOutputKind OutputKind : 3;
 
@@ -121,6 +125,23 @@ public:
   /// objects.
   unsigned EmitStackPromotionChecks : 1;
 
+  /// Emit the metadata of non-generic classes with statically known layout as
+  /// constants, which don't need initialization on first access.
+  unsigned EmitStaticClassMetadata : 1;
+
+  /// In multi-threaded compilation, print the time spent in IRGen and the time
+  /// each thread spends compiling its LLVM modules.
+  unsigned DebugTimeParallelIRGen : 1;
+
+  /// Emit debug info for nominal types defined in other modules as
+  /// declarations identified by their mangled name, leaving the debugger to
+  /// look up their members.
+  unsigned DebugInfoExternalTypeDecls : 1;
+
+  /// Print the bytes of type metadata, value witness tables, field descriptors
+  /// and protocol witness tables emitted for each nominal type.
+  unsigned PrintMetadataSizeReport : 1;
+
   /// The maximum number of bytes used on a stack frame for stack promotion
   /// (includes alloc_stack allocations).
   unsigned StackPromotionSizeLimit = 1024;
@@ -173,7 +194,10 @@ public:
         DebugInfoKind(IRGenDebugInfoKind::None), UseJIT(false),
         DisableLLVMOptzns(false), DisableLLVMARCOpts(false),
         DisableLLVMSLPVectorizer(false), DisableFPElim(true), Playground(false),
-        EmitStackPromotionChecks(false), GenerateProfile(false),
+        EmitStackPromotionChecks(false), EmitStaticClassMetadata(false),
+        DebugTimeParallelIRGen(false), DebugInfoExternalTypeDecls(false),
+        PrintMetadataSizeReport(false),
+        GenerateProfile(false),
         PrintInlineTree(false), EmbedMode(IRGenEmbedMode::None),
         HasValueNamesSetting(false), ValueNames(false),
         EnableReflectionMetadata(true), EnableReflectionNames(true),
@@ -17,8 +17,10 @@
 #ifndef SWIFT_AST_LAZYRESOLVER_H
 #define SWIFT_AST_LAZYRESOLVER_H
 
+#include "swift/AST/Identifier.h"
 #include "swift/AST/TypeLoc.h"
 #include "llvm/ADT/PointerEmbeddedInt.h"
+#include "llvm/ADT/TinyPtrVector.h"
 
 namespace swift {
 
@@ -26,7 +28,7 @@ class AssociatedTypeDecl;
 class Decl;
 class DeclContext;
 class ExtensionDecl;
-class Identifier;
+class IterableDeclContext;
 class NominalTypeDecl;
 class NormalProtocolConformance;
 class ProtocolConformance;
@@ -204,6 +206,17 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Returns the members of \p IDC named \p N, without loading any of its
+  /// other members.
+  ///
+  /// The implementation should \em not add the members to \p IDC. Returns
+  /// None if the members can only be loaded all at once.
+  virtual Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier N,
+                   uint64_t contextData) {
+    return None;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -27,6 +27,7 @@
 #include "swift/Basic/SourceLoc.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallSet.h"
@@ -211,6 +212,9 @@ private:
   /// The magic __dso_handle variable.
   VarDecl *DSOHandle;
 
+  /// \see getModuleScopeLookupGeneration
+  unsigned ModuleScopeLookupGeneration = 0;
+
   ModuleDecl(Identifier name, ASTContext &ctx);
 
 public:
@@ -230,6 +234,18 @@ public:
   void addFile(FileUnit &newFile);
   void removeFile(FileUnit &existingFile);
 
+  /// Returns a counter that changes whenever the decls visible at module
+  /// scope from this module's files may have changed: when a file is added
+  /// or removed, or a source file's imports or lookup cache are reset.
+  unsigned getModuleScopeLookupGeneration() const {
+    return ModuleScopeLookupGeneration;
+  }
+
+  /// Notes that the decls visible at module scope may have changed.
+  void invalidateModuleScopeLookups() {
+    ++ModuleScopeLookupGeneration;
+  }
+
   /// Convenience accessor for clients that know what kind of file they're
   /// dealing with.
   SourceFile &getMainSourceFile(SourceFileKind expectedKind) const;
@@ -778,10 +794,30 @@ public:
   /// \see ImportFlags
   using ImportOptions = OptionSet<ImportFlags>;
 
+  /// The results of unqualified lookups from this file that reached module
+  /// scope, so that looking up the same name again doesn't repeat the search
+  /// through the module and its imports.
+  ///
+  /// The results are only valid while the module's lookup generation and
+  /// the number of loaded modules stay the same.
+  ///
+  /// \sa UnqualifiedLookup
+  struct ModuleScopeLookupCache {
+    unsigned ModuleGeneration = 0;
+    size_t NumLoadedModules = 0;
+
+    /// Keyed on the name, and on whether only types were looked up and
+    /// whether a type resolver was available.
+    llvm::DenseMap<std::pair<DeclName, unsigned>, TinyPtrVector<ValueDecl *>>
+      Results;
+  };
+
 private:
   std::unique_ptr<LookupCache> Cache;
   LookupCache &getCache() const;
 
+  std::unique_ptr<ModuleScopeLookupCache> ModuleScopeLookups;
+
   /// This is the list of modules that are imported by this module.
   ///
   /// This is filled in by the Name Binding phase.
@@ -884,6 +920,12 @@ public:
 
   void clearLookupCache();
 
+  ModuleScopeLookupCache &getModuleScopeLookupCache() {
+    if (!ModuleScopeLookups)
+      ModuleScopeLookups.reset(new ModuleScopeLookupCache());
+    return *ModuleScopeLookups;
+  }
+
   void cacheVisibleDecls(SmallVectorImpl<ValueDecl *> &&globals) const;
   const SmallVectorImpl<ValueDecl *> &getCachedVisibleDecls() const;
 
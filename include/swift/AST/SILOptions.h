@@ -20,6 +20,7 @@
 
 #include "llvm/ADT/StringRef.h"
 #include <string>
+#include <vector>
 #include <climits>
 
 namespace swift {
@@ -55,6 +56,21 @@ public:
   /// Controls how to perform SIL linking.
   LinkingMode LinkMode = LinkNormal;
 
+  /// Only deserialize a function body when an optimization asks for it,
+  /// instead of linking everything reachable before optimizing.
+  bool LinkOnDemand = false;
+
+  /// Move copies and destroys of large values into shared functions, to reduce
+  /// code size.
+  bool OutlineValueOperations = false;
+
+  /// Remove copies between temporaries in unoptimized builds.
+  bool OnoneCopyForwarding = false;
+
+  /// Replace specializations which are identical after erasing class types
+  /// with thunks, to reduce code size.
+  bool MergeSpecializations = false;
+
   /// Remove all runtime assertions during optimizations.
   bool RemoveRuntimeAsserts = false;
 
@@ -95,12 +111,20 @@ public:
   /// Should we print out instruction counts if -print-stats is passed in?
   bool PrintInstCounts = false;
 
+  /// Record the size of each instruction, and print the memory used by SIL
+  /// after optimization.
+  bool PrintMemoryStats = false;
+
   /// Instrument code to generate profiling information.
   bool GenerateProfile = false;
 
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The profile data, collected with -profile-generate, used to guide
+  /// optimization. Empty if there is none.
+  std::string UseProfile;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
@@ -116,6 +140,18 @@ public:
 
   /// If set to true, compile with the SIL Ownership Model enabled.
   bool EnableSILOwnership = false;
+
+  /// The file to write remarks about missed optimizations to. Empty if none
+  /// should be written.
+  std::string OptRecordFile;
+
+  /// The file to write the specializations of other modules' generic
+  /// functions which could not be made to. Empty if none should be written.
+  std::string SpecializationRequestsFile;
+
+  /// Files with specializations requested by clients, which should be made
+  /// and exported by this module.
+  std::vector<std::string> PrespecializeRequestsFiles;
 };
 
 } // end namespace swift
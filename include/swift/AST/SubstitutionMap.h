@@ -41,6 +41,10 @@ class SubstitutionMap {
   llvm::DenseMap<TypeBase *, ArrayRef<ProtocolConformanceRef>> conformanceMap;
   llvm::DenseMap<TypeBase *, SmallVector<ParentType, 1>> parentMap;
 
+  /// Results of Type::subst with this map, keyed on the original type and
+  /// the substitution options. Cleared whenever the map changes.
+  mutable llvm::DenseMap<std::pair<TypeBase *, unsigned>, Type> substCache;
+
   Optional<ProtocolConformanceRef>
   lookupConformance(ProtocolDecl *proto,
                     ArrayRef<ProtocolConformanceRef> conformances) const;
@@ -64,6 +68,19 @@ public:
                  AssociatedTypeDecl *assocType);
 
   void removeType(CanType type);
+
+  /// Returns the cached result of substituting into \p type with
+  /// \p options, or a null type if there is none.
+  Type getCachedSubst(TypeBase *type, unsigned options) const {
+    auto known = substCache.find({type, options});
+    if (known == substCache.end())
+      return Type();
+    return known->second;
+  }
+
+  void cacheSubst(TypeBase *type, unsigned options, Type result) const {
+    substCache[{type, options}] = result;
+  }
 };
 
 } // end namespace swift
@@ -0,0 +1,124 @@
+//===--- BinarySwiftDeps.h - Binary reference dependency files --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A compact alternative to the YAML form of Swift reference dependency files
+// (.swiftdeps files), designed to be read straight out of a memory-mapped
+// buffer.
+//
+// A file consists of a fixed-size header, a table of entries, a table of
+// strings, and the string data. All integers are little-endian, and every
+// table is 4-byte aligned. Names are interned: each distinct string is
+// stored once, and entries refer to it by index.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_BINARYSWIFTDEPS_H
+#define SWIFT_BASIC_BINARYSWIFTDEPS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+
+namespace swift {
+namespace binary_swiftdeps {
+
+/// The first four bytes of every binary reference dependency file.
+static const char Signature[4] = { 'S', 'W', 'D', 'B' };
+
+/// Incremented whenever the layout changes incompatibly.
+const uint16_t VersionMajor = 1;
+
+/// Incremented for backwards-compatible additions.
+const uint16_t VersionMinor = 1;
+
+/// The kinds of entry a file may contain, each corresponding to one of the
+/// top-level keys of the YAML form.
+enum class EntryKind : uint8_t {
+  ProvidesTopLevel,
+  ProvidesNominal,
+  ProvidesMember,
+  ProvidesDynamicLookup,
+  DependsTopLevel,
+  DependsNominal,
+  DependsMember,
+  DependsDynamicLookup,
+  DependsExternal,
+  InterfaceHash,
+  /// Attaches a fingerprint to the "provides" entry just before it. Readers
+  /// never see these entries directly.
+  Fingerprint,
+};
+
+/// A single dependency, as seen by a Reader.
+///
+/// The strings point into the buffer being read.
+struct Entry {
+  EntryKind Kind;
+  bool IsCascading;
+  StringRef Name;
+  /// The member name, for ProvidesMember and DependsMember entries.
+  StringRef Member;
+  /// A summary of the declarations behind a "provides" entry, or empty if
+  /// the entry doesn't have one.
+  StringRef Fingerprint;
+};
+
+/// \returns true if \p Data looks like a binary reference dependency file,
+/// rather than a YAML one.
+bool hasSignature(StringRef Data);
+
+/// Accumulates the entries of a binary reference dependency file.
+class Writer {
+  struct RawEntry {
+    EntryKind Kind;
+    bool IsCascading;
+    uint32_t Name;
+    uint32_t Member;
+  };
+
+  llvm::StringMap<uint32_t> StringIndices;
+  SmallVector<StringRef, 64> Strings;
+  SmallVector<RawEntry, 64> Entries;
+
+  uint32_t intern(StringRef S);
+
+public:
+  /// Adds an entry that isn't a member entry.
+  ///
+  /// \p Fingerprint may only be given for "provides" entries.
+  void addEntry(EntryKind Kind, StringRef Name, bool IsCascading = true,
+                StringRef Fingerprint = StringRef());
+
+  /// Adds a ProvidesMember or DependsMember entry.
+  void addMemberEntry(EntryKind Kind, StringRef BaseName, StringRef Member,
+                      bool IsCascading = true,
+                      StringRef Fingerprint = StringRef());
+
+  /// Writes the accumulated entries to \p OS.
+  void write(raw_ostream &OS) const;
+};
+
+/// Reads the entries of a binary reference dependency file.
+///
+/// \p Callback is invoked for each entry in the order they were added. If it
+/// returns true, reading stops.
+///
+/// \returns true if \p Data is malformed or the callback stopped reading.
+bool read(StringRef Data, llvm::function_ref<bool(const Entry &)> Callback);
+
+} // end namespace binary_swiftdeps
+} // end namespace swift
+
+#endif
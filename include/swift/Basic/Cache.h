@@ -129,6 +129,22 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Limits the total cost of the values in the cache.
+  ///
+  /// \param Limit The maximum total cost, or zero for no limit.
+  ///
+  /// When setting a value takes the total cost above the limit, the least
+  /// recently used other values are evicted until it is within the limit
+  /// again.  Where the platform cache evicts under memory pressure by
+  /// itself, this is passed to it as a hint instead.
+  void setCostLimit(size_t Limit);
+
+  /// Returns the number of values evicted because of the cost limit.
+  ///
+  /// Evictions made by the platform cache under memory pressure are not
+  /// counted.
+  size_t getEvictionCount();
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +208,14 @@ public:
     removeAll();
   }
 
+  void setCostLimit(size_t Limit) {
+    CacheImpl::setCostLimit(Limit);
+  }
+
+  size_t getEvictionCount() {
+    return CacheImpl::getEvictionCount();
+  }
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
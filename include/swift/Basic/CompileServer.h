@@ -0,0 +1,93 @@
+//===--- CompileServer.h - Persistent frontend processes --------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A compile server is a long-lived frontend process that runs jobs on behalf
+// of the driver, so that the cost of launching the compiler and initializing
+// LLVM is paid once rather than once per job.
+//
+// The server listens on a Unix domain socket. For each connection, it forks a
+// worker, which reads the job's working directory, executable path, arguments
+// and environment, along with a file descriptor to send its output to. The
+// server tells the client the worker's pid as soon as it has been forked, and
+// its wait status once it has been reaped, so from the client's point of view
+// a job looks just like a child process.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_COMPILESERVER_H
+#define SWIFT_BASIC_COMPILESERVER_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Program.h"
+
+#include <string>
+
+struct rusage;
+
+namespace swift {
+namespace sys {
+
+/// \brief Indicates whether compile servers are supported on the current
+/// system.
+bool supportsCompileServer();
+
+/// \brief Runs a compile job in a forked worker process.
+///
+/// The working directory, environment, stdout and stderr have already been
+/// set up for the job. Returns the job's exit code.
+typedef llvm::function_ref<int(const char *ExecPath,
+                               ArrayRef<const char *> Args)>
+  CompileServerJobCallback;
+
+/// \brief Serves compile jobs on the socket at \p SocketPath until no job has
+/// been received for \p IdleTimeout seconds.
+///
+/// \param IdleTimeout the number of seconds to wait for a job before
+/// exiting; if 0, waits forever.
+/// \param[out] ErrorMsg a description of the error, if any.
+///
+/// \returns true if the server could not be started, or stopped because of
+/// an error
+bool runCompileServer(StringRef SocketPath, unsigned IdleTimeout,
+                      CompileServerJobCallback PerformJob,
+                      std::string &ErrorMsg);
+
+/// \brief Asks the compile server at \p SocketPath to run a job, sending its
+/// output to \p OutputFd.
+///
+/// \param Env the job's environment; must be null-terminated. If empty, the
+/// current process's environment is used.
+/// \param[out] WorkerPid the pid of the process running the job.
+///
+/// \returns a connection on which to wait for the job with
+/// \ref waitForCompileServerJob, or -1 if the server could not be reached
+int sendCompileServerJob(StringRef SocketPath, const char *ExecPath,
+                         ArrayRef<const char *> Args,
+                         ArrayRef<const char *> Env, int OutputFd,
+                         llvm::sys::ProcessInfo::ProcessId &WorkerPid);
+
+/// \brief Waits for a job sent with \ref sendCompileServerJob to finish, and
+/// closes \p Connection.
+///
+/// \param[out] Status the job's wait status, as returned by waitpid().
+/// \param[out] Usage the resources used by the job, as returned by wait4().
+/// Only the CPU times and peak resident set size are filled in.
+///
+/// \returns true if the connection to the server was lost
+bool waitForCompileServerJob(int Connection, int &Status,
+                             struct rusage &Usage);
+
+} // end namespace sys
+} // end namespace swift
+
+#endif // SWIFT_BASIC_COMPILESERVER_H
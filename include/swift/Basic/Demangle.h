@@ -15,6 +15,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <cassert>
 #include <cstdint>
@@ -82,6 +83,8 @@ enum class FunctionSigSpecializationParamKind : unsigned {
   ClosureProp = 5,
   BoxToValue = 6,
   BoxToStack = 7,
+  ExistentialToGeneric = 8,
+  IndirectToDirect = 9,
 
   // Option Set Flags use bits 6-31. This gives us 26 bits to use for option
   // flags.
@@ -101,6 +104,7 @@ enum class SpecializationPass : uint8_t {
   CapturePropagation,
   FunctionSignatureOpts,
   GenericSpecializer,
+  ExistentialSpecializer,
 };
 
 static inline char encodeSpecializationPass(SpecializationPass Pass) {
@@ -157,19 +161,30 @@ private:
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
-  NodeVector Children;
+  /// Most nodes have at most this many children, which are stored in the
+  /// node itself; nodes with more move them to a separate array.
+  enum : uint32_t { NumInlineChildren = 2 };
 
+  NodePointer *Children;
+  uint32_t NumChildren = 0;
+  uint32_t ChildrenCapacity = NumInlineChildren;
+  NodePointer InlineChildren[NumInlineChildren];
+
+  void growChildren();
+
+protected:
   Node(Kind k)
-      : NodeKind(k), NodePayloadKind(PayloadKind::None) {
+      : NodeKind(k), NodePayloadKind(PayloadKind::None),
+        Children(InlineChildren) {
   }
   Node(Kind k, std::string &&t)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
+      : NodeKind(k), NodePayloadKind(PayloadKind::Text),
+        Children(InlineChildren) {
     new (&TextPayload) std::string(std::move(t));
   }
   Node(Kind k, IndexType index)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
+      : NodeKind(k), NodePayloadKind(PayloadKind::Index),
+        Children(InlineChildren) {
     IndexPayload = index;
   }
   Node(const Node &) = delete;
@@ -194,19 +209,25 @@ public:
     return IndexPayload;
   }
   
-  typedef NodeVector::iterator iterator;
-  typedef NodeVector::const_iterator const_iterator;
-  typedef NodeVector::size_type size_type;
-
-  bool hasChildren() const { return !Children.empty(); }
-  size_t getNumChildren() const { return Children.size(); }
-  iterator begin() { return Children.begin(); }
-  iterator end() { return Children.end(); }
-  const_iterator begin() const { return Children.begin(); }
-  const_iterator end() const { return Children.end(); }
-
-  NodePointer getFirstChild() const { return Children.front(); }
-  NodePointer getChild(size_t index) const { return Children[index]; }
+  typedef NodePointer *iterator;
+  typedef const NodePointer *const_iterator;
+  typedef size_t size_type;
+
+  bool hasChildren() const { return NumChildren != 0; }
+  size_t getNumChildren() const { return NumChildren; }
+  iterator begin() { return Children; }
+  iterator end() { return Children + NumChildren; }
+  const_iterator begin() const { return Children; }
+  const_iterator end() const { return Children + NumChildren; }
+
+  NodePointer getFirstChild() const {
+    assert(hasChildren());
+    return Children[0];
+  }
+  NodePointer getChild(size_t index) const {
+    assert(index < NumChildren);
+    return Children[index];
+  }
 
   /// Add a new node as a child of this one.
   ///
@@ -214,7 +235,9 @@ public:
   /// \returns child
   NodePointer addChild(NodePointer child) {
     assert(child && "adding null child!");
-    Children.push_back(child);
+    if (NumChildren == ChildrenCapacity)
+      growChildren();
+    Children[NumChildren++] = child;
     return child;
   }
 
@@ -351,21 +374,30 @@ std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
 struct NodeFactory {
+private:
+  /// Lets std::make_shared construct nodes, so that each node shares a
+  /// single allocation with its reference count.
+  struct SharedNode : Node {
+    template <typename... Args>
+    SharedNode(Args &&...args) : Node(std::forward<Args>(args)...) {}
+  };
+
+public:
   static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
+    return std::make_shared<SharedNode>(K);
   }
   static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
+    return std::make_shared<SharedNode>(K, Index);
   }
   static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
+    return std::make_shared<SharedNode>(K, Text.str());
   }
   static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
+    return std::make_shared<SharedNode>(K, std::move(Text));
   }
   template <size_t N>
   static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
+    return std::make_shared<SharedNode>(K, llvm::StringRef(Text).str());
   }
 };
 
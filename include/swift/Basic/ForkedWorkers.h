@@ -0,0 +1,64 @@
+//===--- ForkedWorkers.h - Splitting work across processes ------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs independent pieces of work in copies of the current process, so that
+// work that isn't thread-safe can still use several cores. Each worker starts
+// with everything the process had set up before forking, and its output is
+// captured so that it can be replayed in a deterministic order.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_FORKEDWORKERS_H
+#define SWIFT_BASIC_FORKEDWORKERS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+
+#include <string>
+
+namespace swift {
+namespace sys {
+
+/// \brief Indicates whether work can be run in forked workers on the current
+/// system.
+bool supportsForkedWorkers();
+
+/// \brief Does the work of a single worker, and returns its exit code.
+typedef llvm::function_ref<int(unsigned WorkerIndex)> ForkedWorkerCallback;
+
+/// \brief What a forked worker did.
+struct ForkedWorkerResult {
+  /// Everything the worker wrote to stdout and stderr.
+  std::string Output;
+
+  /// The worker's exit code, or -1 if it was terminated by a signal.
+  int ExitCode = -1;
+};
+
+/// \brief Forks \p NumWorkers copies of the current process, each of which
+/// runs \p Work with its own index and then exits, and waits for all of them.
+///
+/// Workers exit without running static destructors or atexit handlers.
+///
+/// \param[out] Results one result per worker, in index order.
+/// \param[out] ErrorMsg a description of the error, if any.
+///
+/// \returns true if the workers could not be started, in which case none of
+/// them ran to completion and the caller should do the work itself
+bool runForkedWorkers(unsigned NumWorkers, ForkedWorkerCallback Work,
+                      SmallVectorImpl<ForkedWorkerResult> &Results,
+                      std::string &ErrorMsg);
+
+} // end namespace sys
+} // end namespace swift
+
+#endif // SWIFT_BASIC_FORKEDWORKERS_H
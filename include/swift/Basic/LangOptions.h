@@ -110,6 +110,10 @@ namespace swift {
     /// solver should be debugged.
     unsigned DebugConstraintSolverAttempt = 0;
 
+    /// \brief If non-zero, the constraint solver dumps a profile of what it
+    /// did for each expression that starts on this line.
+    unsigned DebugConstraintSolverProfileLine = 0;
+
     /// \brief Enable the iterative type checker.
     bool IterativeTypeChecker = false;
 
@@ -153,6 +157,14 @@ namespace swift {
     /// Should we use \c ASTScope-based resolution for unqualified name lookup?
     bool EnableASTScopeLookup = false;
 
+    /// Should member lookups into serialized types only deserialize the
+    /// members with the name being looked up?
+    bool EnableNamedLazyMemberLoading = false;
+
+    /// Should extensions in other source files be bound to their nominal
+    /// types only when the extensions of those types are first needed?
+    bool EnableLazyExtensionBinding = false;
+
     /// Whether to use the import as member inference system
     ///
     /// When importing a global, try to infer whether we can import it as a
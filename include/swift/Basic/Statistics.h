@@ -0,0 +1,89 @@
+//===--- Statistics.h - Counters and timers of a compilation ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Collects the counters and timers of every part of the compiler in one
+// place, so that each frontend job can write them to a single JSON file, and
+// those files can be added up and compared across builds by
+// utils/process-stats-dir.py.
+//
+// The file is a flat JSON object. Counter names are grouped by the part of
+// the compiler that records them, as in "Sema.NumStatesExplored"; timers
+// start with "time." and are in seconds.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_STATISTICS_H
+#define SWIFT_BASIC_STATISTICS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace swift {
+namespace stats {
+
+/// Starts collecting statistics in this process.
+void enable();
+
+/// Returns true if statistics are being collected in this process.
+bool isEnabled();
+
+/// Adds \p Value to the counter \p Name of \p Group.
+void addCounter(StringRef Group, StringRef Name, uint64_t Value);
+
+/// Adds \p Nanoseconds to the timer \p Name of \p Group.
+void addTime(StringRef Group, StringRef Name, uint64_t Nanoseconds);
+
+/// Writes every statistic collected so far to \p Path, and discards them.
+///
+/// Along with the counters and timers, this writes the peak memory use and
+/// CPU time of the process, and the LLVM statistics if they are enabled.
+///
+/// \returns true on error, in which case \p ErrorMsg describes it.
+bool writeStats(StringRef Path, std::string &ErrorMsg);
+
+/// Adds the time from its construction to its destruction to a timer, if
+/// statistics are being collected when it is constructed.
+class Timer {
+  using Clock = std::chrono::steady_clock;
+
+  StringRef Group;
+  StringRef Name;
+  Clock::time_point Start;
+  bool Active;
+
+public:
+  Timer(StringRef Group, StringRef Name)
+      : Group(Group), Name(Name), Active(isEnabled()) {
+    if (Active)
+      Start = Clock::now();
+  }
+
+  Timer(const Timer &) = delete;
+  Timer &operator=(const Timer &) = delete;
+
+  ~Timer() {
+    if (!Active)
+      return;
+    using std::chrono::nanoseconds;
+    addTime(Group, Name,
+            std::chrono::duration_cast<nanoseconds>(Clock::now() - Start)
+              .count());
+  }
+};
+
+} // end namespace stats
+} // end namespace swift
+
+#endif // SWIFT_BASIC_STATISTICS_H
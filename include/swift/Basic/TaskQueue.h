@@ -15,12 +15,15 @@
 
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Program.h"
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <queue>
+#include <string>
 
 namespace swift {
 namespace sys {
@@ -29,6 +32,25 @@ class Task; // forward declared to allow for platform-specific implementations
 
 typedef llvm::sys::ProcessInfo::ProcessId ProcessId;
 
+/// \brief The resources used by a task, as reported by the system when it
+/// exited.
+struct TaskResourceUsage {
+  /// The time from starting the task to its exit, in microseconds.
+  uint64_t WallTimeMicros = 0;
+  /// The CPU time spent in user mode, in microseconds.
+  uint64_t UserTimeMicros = 0;
+  /// The CPU time spent in the kernel on the task's behalf, in microseconds.
+  uint64_t SystemTimeMicros = 0;
+  /// The task's peak resident set size, in bytes.
+  uint64_t MaxResidentBytes = 0;
+};
+
+/// \brief Marks a line of a task's output as a progress message.
+///
+/// Such lines are passed to the TaskProgressCallback, if there is one, rather
+/// than being included in the task's output.
+static const char TaskProgressPrefix[] = "<swift-task-progress> ";
+
 /// \brief Indicates how a TaskQueue should respond to the task finished event.
 enum class TaskFinishedResponse {
   /// Indicates that execution should continue.
@@ -46,6 +68,14 @@ class TaskQueue {
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
 
+  /// Whether the number of tasks executing in parallel should follow the
+  /// system's load and available memory, using NumberOfParallelTasks as an
+  /// upper bound.
+  bool AdaptToSystemLoad = false;
+
+  /// The socket of a compile server which should run frontend tasks, if any.
+  std::string CompileServerPath;
+
 public:
   /// \brief Create a new TaskQueue instance.
   ///
@@ -72,12 +102,16 @@ public:
   /// \param ReturnCode the return code of the task which finished execution.
   /// \param Output the output from the task which finished execution,
   /// if available. (This may not be available on all platforms.)
+  /// \param Usage the resources used by the task, if available. (This may
+  /// not be available on all platforms.)
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns true if further execution of tasks should stop,
   /// false if execution should continue
   typedef std::function<TaskFinishedResponse(ProcessId Pid, int ReturnCode,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             Optional<TaskResourceUsage> Usage,
+                                             void *Context)>
     TaskFinishedCallback;
 
   /// \brief A callback which will be executed if a task exited abnormally due
@@ -95,6 +129,15 @@ public:
   typedef std::function<TaskFinishedResponse(ProcessId Pid, StringRef ErrorMsg,
                                              StringRef Output, void *Context)>
     TaskSignalledCallback;
+
+  /// \brief A callback which will be executed when a task reports its
+  /// progress, by writing a line that starts with \ref TaskProgressPrefix.
+  ///
+  /// \param Pid the ProcessId of the task which reported progress.
+  /// \param Message the rest of the line, without the prefix or the newline.
+  /// \param Context the context which was passed when the task was added
+  typedef std::function<void(ProcessId Pid, StringRef Message, void *Context)>
+    TaskProgressCallback;
 #pragma clang diagnostic pop
 
   /// \brief Indicates whether TaskQueue supports buffering output on the
@@ -113,6 +156,31 @@ public:
   /// parallel
   unsigned getNumberOfParallelTasks() const;
 
+  /// \brief Lets the TaskQueue grow or shrink the number of tasks executing in
+  /// parallel as the system's load average and available memory change.
+  ///
+  /// The number of parallel tasks is never more than
+  /// \ref getNumberOfParallelTasks. This has no effect on systems which do not
+  /// support parallel execution.
+  void setAdaptsToSystemLoad(bool Value = true) { AdaptToSystemLoad = Value; }
+
+  /// \returns true if the number of parallel tasks follows the system's load
+  bool adaptsToSystemLoad() const { return AdaptToSystemLoad; }
+
+  /// \brief Sends frontend tasks (those whose first argument is "-frontend")
+  /// to the compile server listening on \p SocketPath, rather than spawning
+  /// a new process for each of them.
+  ///
+  /// Tasks are spawned as usual if the server can't be reached. This has no
+  /// effect on systems which do not support compile servers.
+  void setCompileServerPath(StringRef SocketPath) {
+    CompileServerPath = SocketPath;
+  }
+
+  /// \returns the socket of the compile server which runs frontend tasks, or
+  /// an empty string if there is none
+  StringRef getCompileServerPath() const { return CompileServerPath; }
+
   /// \brief Adds a task to the TaskQueue.
   ///
   /// \param ExecPath the path to the executable which the task should execute
@@ -130,12 +198,17 @@ public:
   /// \param Finished a callback which will be called when a task finishes
   /// \param Signalled a callback which will be called if a task exited
   /// abnormally due to a signal
+  /// \param Progress a callback which will be called when a task reports its
+  /// progress. Progress messages are only recognized if
+  /// \ref supportsBufferingOutput returns true, and only if this callback is
+  /// given.
   ///
   /// \returns true if all tasks did not execute successfully
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
-          TaskSignalledCallback Signalled = TaskSignalledCallback());
+          TaskSignalledCallback Signalled = TaskSignalledCallback(),
+          TaskProgressCallback Progress = TaskProgressCallback());
 
   /// Returns true if there are any tasks that have been queued but have not
   /// yet been executed.
@@ -173,7 +246,8 @@ public:
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
-          TaskSignalledCallback Signalled = TaskSignalledCallback());
+          TaskSignalledCallback Signalled = TaskSignalledCallback(),
+          TaskProgressCallback Progress = TaskProgressCallback());
 };
 
 } // end namespace sys
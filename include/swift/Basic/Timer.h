@@ -14,12 +14,18 @@
 #define SWIFT_BASIC_TIMER_H
 
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/Statistics.h"
+#include "swift/Basic/TraceEvents.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Timer.h"
 
 namespace swift {
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
+  ///
+  /// If trace events are being recorded, the timer is also recorded as a
+  /// span in the trace, and if statistics are being collected, its time is
+  /// added to the "Frontend" timer of the same name.
   class SharedTimer {
     enum class State {
       Initial,
@@ -29,9 +35,15 @@ namespace swift {
     static State CompilationTimersEnabled;
 
     Optional<llvm::NamedRegionTimer> Timer;
+    Optional<trace::Span> Span;
+    Optional<stats::Timer> StatsTimer;
 
   public:
     explicit SharedTimer(StringRef name) {
+      if (trace::isEnabled())
+        Span.emplace("frontend", name);
+      if (stats::isEnabled())
+        StatsTimer.emplace("Frontend", name);
       if (CompilationTimersEnabled == State::Enabled)
         Timer.emplace(name, StringRef("Swift compilation"));
       else
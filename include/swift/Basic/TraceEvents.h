@@ -0,0 +1,106 @@
+//===--- TraceEvents.h - Recording spans for a build timeline ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Records spans of time in the Chrome trace event format, so that the work
+// done by the driver and each frontend process can be viewed as a single
+// timeline (for example in chrome://tracing).
+//
+// The trace is a JSON array with one "complete" event per line. Timestamps
+// are microseconds since the epoch, so that traces written by different
+// processes on the same machine can be combined.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_TRACEEVENTS_H
+#define SWIFT_BASIC_TRACEEVENTS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+
+namespace swift {
+namespace trace {
+
+/// Returns the current time, in microseconds since the epoch.
+uint64_t now();
+
+/// Starts recording spans in this process.
+void enable();
+
+/// Returns true if spans are being recorded in this process.
+bool isEnabled();
+
+/// Records a span that started at \p Start and lasted \p Duration
+/// microseconds, on the current thread of this process.
+///
+/// \p Detail, if not empty, is shown as an argument of the span.
+void addSpan(StringRef Category, StringRef Name, StringRef Detail,
+             uint64_t Start, uint64_t Duration);
+
+/// Records a span on behalf of another process or thread.
+void addSpan(StringRef Category, StringRef Name, StringRef Detail,
+             uint64_t Start, uint64_t Duration, uint64_t Pid, uint64_t Tid);
+
+/// Adds the spans from a trace written by another process with
+/// writeEvents().
+///
+/// \returns true if the file could not be read.
+bool addEventsFromFile(StringRef Path);
+
+/// Writes every span recorded so far to \p Path, and discards them.
+///
+/// Discarding them means a process that performs several frontend
+/// invocations writes each invocation's spans to that invocation's trace.
+///
+/// \returns true on error, in which case \p ErrorMsg describes it.
+bool writeEvents(StringRef Path, std::string &ErrorMsg);
+
+/// Records a span from its construction to its destruction, if spans are
+/// being recorded when it is constructed.
+class Span {
+  StringRef Category;
+  StringRef Name;
+  std::string Detail;
+  uint64_t Start = 0;
+  uint64_t MinDuration;
+  bool Active;
+
+public:
+  /// \param MinDuration Spans shorter than this many microseconds are not
+  /// recorded, to keep traces of very frequent events to a manageable size.
+  Span(StringRef Category, StringRef Name, StringRef Detail = StringRef(),
+       uint64_t MinDuration = 0)
+      : Category(Category), Name(Name), MinDuration(MinDuration),
+        Active(isEnabled()) {
+    if (Active) {
+      this->Detail = Detail;
+      Start = now();
+    }
+  }
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+
+  ~Span() {
+    if (!Active)
+      return;
+    uint64_t Duration = now() - Start;
+    if (Duration >= MinDuration)
+      addSpan(Category, Name, Detail, Start, Duration);
+  }
+};
+
+} // end namespace trace
+} // end namespace swift
+
+#endif // SWIFT_BASIC_TRACEEVENTS_H
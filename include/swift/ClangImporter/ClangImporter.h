@@ -70,6 +70,16 @@ private:
   ClangImporter(ASTContext &ctx, const ClangImporterOptions &clangImporterOpts,
                 DependencyTracker *tracker);
 
+  /// Sets up the Clang preprocessor, Sema and parser, adds the search paths,
+  /// and parses the predefines.
+  ///
+  /// \returns true if there was an error.
+  bool finishInitialization();
+
+  /// Calls \c finishInitialization if \c create deferred it, because of
+  /// ClangImporterOptions::LazyInitialization.
+  void ensureInitialized() const;
+
 public:
   /// \brief Create a new Clang importer that can import a suitable Clang
   /// module into the given ASTContext.
@@ -47,6 +47,11 @@ public:
   /// Controls how Clang is initially set up.
   Modes Mode = Modes::Normal;
 
+  /// If true, only the Clang invocation and target are created up front.
+  /// The preprocessor, Sema and search paths are set up the first time they
+  /// are needed, usually when a Clang module is first imported.
+  bool LazyInitialization = false;
+
   /// When set, preserves more information during import.
   ///
   /// Also \em disables some information that is only needed for object file
@@ -138,6 +138,9 @@ public:
     };
     Status status = UpToDate;
     llvm::sys::TimeValue previousModTime;
+    /// How long the compile job for this input took in the previous build,
+    /// or zero if unknown.
+    llvm::sys::TimeValue previousDuration = llvm::sys::TimeValue::ZeroTime();
 
     InputInfo() = default;
     InputInfo(Status stat, llvm::sys::TimeValue time)
@@ -136,6 +136,24 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// Indicates whether compile jobs that are ready to run at the same time
+  /// should be combined into batches, one per parallel job slot, each of
+  /// which runs as a single frontend process.
+  bool EnableBatchMode = false;
+
+  /// Indicates whether the number of parallel jobs should follow the
+  /// system's load and available memory, with the longest jobs started first.
+  bool EnableAdaptiveScheduling = false;
+
+  /// The socket of a compile server to run frontend jobs on, if any.
+  std::string CompileServerPath;
+
+  /// The directory in which to cache the outputs of compile jobs, if any.
+  std::string OutputCachePath;
+
+  /// The path to write a trace of the jobs' timeline to, if any.
+  std::string TraceOutputPath;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -194,6 +212,41 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  bool getBatchModeEnabled() const {
+    return EnableBatchMode;
+  }
+  void setBatchModeEnabled(bool value = true) {
+    EnableBatchMode = value;
+  }
+
+  bool getAdaptiveSchedulingEnabled() const {
+    return EnableAdaptiveScheduling;
+  }
+  void setAdaptiveSchedulingEnabled(bool value = true) {
+    EnableAdaptiveScheduling = value;
+  }
+
+  StringRef getCompileServerPath() const {
+    return CompileServerPath;
+  }
+  void setCompileServerPath(StringRef path) {
+    CompileServerPath = path;
+  }
+
+  StringRef getOutputCachePath() const {
+    return OutputCachePath;
+  }
+  void setOutputCachePath(StringRef path) {
+    OutputCachePath = path;
+  }
+
+  StringRef getTraceOutputPath() const {
+    return TraceOutputPath;
+  }
+  void setTraceOutputPath(StringRef path) {
+    TraceOutputPath = path;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
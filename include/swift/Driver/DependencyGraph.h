@@ -90,6 +90,10 @@ private:
   struct ProvidesEntryTy {
     std::string name;
     DependencyMaskTy kindMask;
+    /// Summarizes the declarations behind this entry, so that a change to
+    /// the file can be narrowed down to the entries it affected. Empty if
+    /// unknown.
+    std::string fingerprint;
   };
   static_assert(std::is_move_constructible<ProvidesEntryTy>::value, "");
 
@@ -129,6 +133,13 @@ private:
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
+  /// For each node, the "provides" entries whose fingerprints changed when
+  /// the node was last loaded.
+  ///
+  /// markTransitive only follows these entries out of the node it starts
+  /// from. A node without an entry here has all of its entries followed.
+  llvm::DenseMap<const void *, llvm::StringSet<>> ChangedProvides;
+
   LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
@@ -277,6 +288,9 @@ public:
   /// Nodes that are only reachable through "non-cascading" edges are added to
   /// the \p visited set, but are \em not added to the graph's marked set.
   ///
+  /// If \p node's dependency file has fingerprints, only the dependents of
+  /// entries that changed when it was last loaded are traversed.
+  ///
   /// If you want to see how each node gets added to \p visited, pass a local
   /// MarkTracer instance to \p tracer.
   template <unsigned N>
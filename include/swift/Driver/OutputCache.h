@@ -0,0 +1,84 @@
+//===--- OutputCache.h - Reuse the outputs of earlier jobs ------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// An OutputCache keeps copies of the outputs of compile jobs in a directory,
+// so that a job whose inputs are the same as those of an earlier one (in this
+// build tree or another tree sharing the directory) can take its outputs from
+// the cache instead of running.
+//
+// A job's entry is keyed on its command line, with output paths left out, and
+// the contents of the files named on it. Since the modules a job imports are
+// found by searching rather than named, each entry also records the external
+// dependencies listed in the job's .swiftdeps file, along with the hash of
+// their contents at the time the entry was made; the entry is only used if
+// they still match.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_OUTPUTCACHE_H
+#define SWIFT_DRIVER_OUTPUTCACHE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace swift {
+namespace driver {
+  class Job;
+
+class OutputCache {
+  /// The absolute path of the directory holding the entries.
+  std::string Directory;
+
+  /// The hash of each file read so far, or an empty string if it couldn't
+  /// be read.
+  ///
+  /// Files are only hashed once per build; they're not expected to change
+  /// while it's running.
+  llvm::StringMap<std::string> FileHashes;
+
+  /// The key of each job looked up so far, or an empty string if the job
+  /// can't be cached.
+  llvm::DenseMap<const Job *, std::string> Keys;
+
+  StringRef getFileHash(StringRef Path);
+  StringRef getKey(const Job &Cmd);
+
+public:
+  explicit OutputCache(StringRef Directory);
+
+  /// Returns true if \p Cmd's outputs may be kept in a cache at all.
+  ///
+  /// Only compile jobs that produce a dependencies file are cacheable.
+  static bool isCacheable(const Job &Cmd);
+
+  /// Copies the cached outputs of \p Cmd into place, if the cache has an
+  /// up-to-date entry for it.
+  ///
+  /// \returns true if the outputs were restored, in which case \p Cmd doesn't
+  /// need to run
+  bool restore(const Job &Cmd);
+
+  /// Adds the outputs of \p Cmd, which has just run successfully, to the
+  /// cache.
+  ///
+  /// Failures are ignored; the job will just be run again next time.
+  void store(const Job &Cmd);
+};
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
@@ -29,13 +29,17 @@ class Job;
 namespace parseable_output {
 
 using swift::sys::ProcessId;
+using swift::sys::TaskResourceUsage;
 
 /// \brief Emits a "began" message to the given stream.
 void emitBeganMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid);
 
 /// \brief Emits a "finished" message to the given stream.
+///
+/// \param Usage the resources used by the command, if known.
 void emitFinishedMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
-                         int ExitStatus, StringRef Output);
+                         int ExitStatus, StringRef Output,
+                         Optional<TaskResourceUsage> Usage);
 
 /// \brief Emits a "signalled" message to the given stream.
 void emitSignalledMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
@@ -44,6 +48,14 @@ void emitSignalledMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
 /// \brief Emits a "skipped" message to the given stream.
 void emitSkippedMessage(raw_ostream &os, const Job &Cmd);
 
+/// \brief Emits a "summary" message to the given stream, describing the
+/// resources used by the \p JobCount commands that reported them.
+///
+/// \param Usage the total CPU time of the commands, the largest peak memory
+/// of any of them, and the time taken by the whole compilation.
+void emitSummaryMessage(raw_ostream &os, unsigned JobCount,
+                        const TaskResourceUsage &Usage);
+
 } // end namespace parseable_output
 } // end namespace driver
 } // end namespace swift
@@ -41,6 +41,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
 
+#include <chrono>
 #include <memory>
 
 namespace swift {
@@ -291,6 +292,39 @@ public:
   }
 };
 
+/// How long each step of setting up a CompilerInstance took, for
+/// -print-startup-profile.
+class StartupProfile {
+  using Clock = std::chrono::steady_clock;
+
+  /// Each step's name and duration in nanoseconds, in the order they ran.
+  SmallVector<std::pair<StringRef, uint64_t>, 8> Steps;
+
+public:
+  /// Records the time from its construction to its destruction as a step
+  /// of \p Profile called \p Name.
+  ///
+  /// Does nothing if \p Profile is null.
+  class Step {
+    StartupProfile *Profile;
+    StringRef Name;
+    Clock::time_point Start;
+
+  public:
+    Step(StartupProfile *Profile, StringRef Name)
+      : Profile(Profile), Name(Name) {
+      if (Profile)
+        Start = Clock::now();
+    }
+    ~Step();
+
+    Step(const Step &) = delete;
+    Step &operator=(const Step &) = delete;
+  };
+
+  void print(raw_ostream &OS) const;
+};
+
 /// A class which manages the state and execution of the compiler.
 /// This owns the primary compiler singletons, such as the ASTContext,
 /// as well as various build products such as the SILModule.
@@ -330,6 +364,12 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// Only created with -print-startup-profile.
+  std::unique_ptr<StartupProfile> Profile;
+
+  /// Set if any -type-check-workers process diagnosed an error.
+  bool HadErrorsInTypeCheckWorkers = false;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
@@ -389,6 +429,10 @@ public:
 
   SerializedModuleLoader *getSerializedModuleLoader() const { return SML; }
 
+  /// Returns the steps of setup and performSema timed so far, or null if
+  /// -print-startup-profile wasn't passed.
+  StartupProfile *getStartupProfile() const { return Profile.get(); }
+
   ArrayRef<unsigned> getInputBufferIDs() const { return BufferIDs; }
 
   ArrayRef<LinkLibrary> getLinkLibraries() const {
@@ -399,6 +443,13 @@ public:
     return Invocation.getFrontendOptions().EnableSourceImport;
   }
 
+  /// Returns true if the inputs were type-checked in forked workers, and any
+  /// of them diagnosed an error. Those errors have already been printed, but
+  /// aren't recorded in this process's ASTContext.
+  bool hadErrorsInTypeCheckWorkers() const {
+    return HadErrorsInTypeCheckWorkers;
+  }
+
   /// Gets the SourceFile which is the primary input for this CompilerInstance.
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
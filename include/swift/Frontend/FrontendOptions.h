@@ -96,6 +96,9 @@ public:
   /// The path to which we should emit a module documentation file.
   std::string ModuleDocOutputPath;
 
+  /// The path to which we should emit a summary of the module's interface.
+  std::string ModuleSummaryOutputPath;
+
   /// The name of the library to link against when using this module.
   std::string ModuleLinkName;
 
@@ -112,6 +115,19 @@ public:
   /// The path to which we should output a Swift reference dependencies file.
   std::string ReferenceDependenciesFilePath;
 
+  /// Indicates that the Swift reference dependencies file should use the
+  /// binary format rather than YAML.
+  bool EmitBinaryReferenceDependencies = false;
+
+  /// Indicates that the Swift reference dependencies file should list each
+  /// provided member separately, with a fingerprint for every provided
+  /// entry, so that the driver can tell which entries changed.
+  bool EmitReferenceDependencyFingerprints = false;
+
+  /// Indicates that a progress message should be written once the module has
+  /// been serialized, so that the driver can use it before this job exits.
+  bool ReportEmittedModule = false;
+
   /// The path to which we should output fixits as source edits.
   std::string FixitsOutputPath;
 
@@ -134,6 +150,12 @@ public:
   /// Intended for debugging purposes only.
   unsigned WarnLongFunctionBodies = 0;
 
+  /// If non-zero, warn when an expression takes longer than this many
+  /// milliseconds to type-check.
+  ///
+  /// Intended for debugging purposes only.
+  unsigned WarnLongExpressionTypeChecking = 0;
+
   enum ActionType {
     NoneAction, ///< No specific action
     Parse, ///< Parse and type-check only
@@ -178,20 +200,55 @@ public:
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If set, dumps wall time taken to type-check each expression to
+  /// llvm::errs().
+  bool DebugTimeExpressionTypeChecking = false;
+
+  /// If set, dumps the memory the constraint solver used for each expression
+  /// to llvm::errs().
+  bool DebugExpressionSolverMemory = false;
+
   /// If set, prints the time taken in each major compilation phase to 
   /// llvm::errs().
   ///
   /// \sa swift::SharedTimer
   bool DebugTimeCompilation = false;
 
+  /// If non-empty, the path to which a timeline of this compilation's
+  /// phases should be written, in the Chrome trace event format.
+  ///
+  /// \sa swift::trace
+  std::string TraceOutputPath;
+
+  /// If non-empty, the directory in which to write a JSON file with the
+  /// counters and timers of this compilation.
+  ///
+  /// \sa swift::stats
+  std::string StatsOutputDir;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether the function bodies of non-primary files should be
+  /// parsed, even though they are never type-checked.
+  bool ParseNonPrimaryFunctionBodies = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
 
+  /// Indicates whether the module files imported by the inputs should be
+  /// read on several threads before the inputs are parsed.
+  bool EnableParallelImports = false;
+
+  /// If greater than 1, the number of processes to fork to type-check the
+  /// inputs of a -parse invocation without a primary file.
+  ///
+  /// Each process type-checks a contiguous run of the inputs and exits, and
+  /// the diagnostics are printed in input order.
+  unsigned TypeCheckWorkers = 0;
+
   /// Indicates whether we are compiling for testing.
   ///
   /// \see ModuleDecl::isTestingEnabled
@@ -219,6 +276,14 @@ public:
   /// \see ResilienceStrategy::Fragile
   bool SILSerializeAll = false;
 
+  /// Indicates whether SIL function bodies should be compressed in the
+  /// emitted module.
+  bool CompressSerializedSIL = false;
+
+  /// Indicates whether merging partial modules should be skipped when the
+  /// existing outputs were merged from identical inputs.
+  bool SkipUnchangedModuleMerge = false;
+
   /// Indicates whether or not the frontend should print statistics upon
   /// termination.
   bool PrintStats = false;
@@ -227,6 +292,26 @@ public:
   /// termination.
   bool PrintClangStats = false;
 
+  /// Indicates whether or not the frontend should print the memory used by
+  /// AST nodes upon termination.
+  bool PrintASTMemoryStats = false;
+
+  /// Indicates whether or not the frontend should print how long each step
+  /// of setting up the CompilerInstance took.
+  ///
+  /// \sa swift::StartupProfile
+  bool PrintStartupProfile = false;
+
+  /// Indicates whether or not the frontend should print what was deserialized
+  /// from each imported module upon termination.
+  ///
+  /// \sa swift::serialization::DeserializationStats
+  bool PrintDeserializationStats = false;
+
+  /// The number of most expensive decls to list along with the
+  /// deserialization statistics.
+  unsigned NumExpensiveDeserializedDecls = 10;
+
   /// Indicates whether the playground transformation should be applied.
   bool PlaygroundTransform = false;
 
@@ -44,6 +44,25 @@ class AlwaysDelayedCallbacks : public DelayedParsingCallbacks {
   }
 };
 
+/// \brief Implementation of callbacks that skip the function bodies of
+/// non-primary files, which are never type-checked.
+///
+/// Bodies that may still be wanted later, such as those of transparent and
+/// always-inline functions, are delayed rather than skipped, and are parsed
+/// by \c performDelayedParsing.
+class NonPrimaryDelayedCallbacks : public DelayedParsingCallbacks {
+  bool shouldDelayFunctionBodyParsing(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      const DeclAttributes &Attrs,
+                                      SourceRange BodyRange) override {
+    if (Attrs.hasAttribute<TransparentAttr>())
+      return true;
+    if (auto *Inline = Attrs.getAttribute<InlineAttr>())
+      return Inline->getKind() == InlineKind::Always;
+    return false;
+  }
+};
+
 /// \brief Implementation of callbacks that guide the parser in delayed
 /// parsing for code completion.
 class CodeCompleteDelayedCallbacks : public DelayedParsingCallbacks {
@@ -25,6 +25,7 @@
 #include "swift/Reflection/TypeRef.h"
 #include "swift/Reflection/TypeRefBuilder.h"
 
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <vector>
@@ -170,6 +171,27 @@ public:
     }
   }
 
+  /// Read a class or closure context instance in one go and append the
+  /// values of its strong reference fields to References.
+  ///
+  /// Returns the layout of the instance, or nullptr if it is unknown, in
+  /// which case nothing is appended.
+  const TypeInfo *
+  readInstanceReferences(StoredPointer ObjectAddress,
+                         std::vector<StoredPointer> &References) {
+    auto *TI = getInstanceTypeInfo(ObjectAddress);
+    if (TI == nullptr)
+      return nullptr;
+
+    std::vector<uint8_t> Buffer(TI->getSize());
+    if (!getReader().readBytes(RemoteAddress(ObjectAddress),
+                               Buffer.data(), Buffer.size()))
+      return nullptr;
+
+    collectReferences(*TI, Buffer.data(), Buffer.size(), References);
+    return TI;
+  }
+
   bool
   projectExistential(RemoteAddress ExistentialAddress,
                      const TypeRef *ExistentialTR,
@@ -326,6 +348,47 @@ public:
   }
 
 private:
+  /// Append the values of the strong reference fields of a value with the
+  /// layout TI, whose contents are in Buffer, to References.
+  ///
+  /// Enum payloads and opaque existentials are not looked into, since which
+  /// of their words hold references depends on the value.
+  void collectReferences(const TypeInfo &TI, const uint8_t *Buffer,
+                         size_t Size, std::vector<StoredPointer> &References) {
+    if (auto *ReferenceTI = dyn_cast<ReferenceTypeInfo>(&TI)) {
+      if (ReferenceTI->getReferenceKind() != ReferenceKind::Strong ||
+          Size < sizeof(StoredPointer))
+        return;
+      StoredPointer Reference;
+      memcpy(&Reference, Buffer, sizeof(StoredPointer));
+      if (Reference != 0)
+        References.push_back(Reference);
+      return;
+    }
+
+    auto *RecordTI = dyn_cast<RecordTypeInfo>(&TI);
+    if (RecordTI == nullptr)
+      return;
+
+    switch (RecordTI->getRecordKind()) {
+    case RecordKind::Invalid:
+    case RecordKind::NoPayloadEnum:
+    case RecordKind::SinglePayloadEnum:
+    case RecordKind::MultiPayloadEnum:
+    case RecordKind::OpaqueExistential:
+      return;
+    default:
+      break;
+    }
+
+    for (auto &Field : RecordTI->getFields()) {
+      if (Field.Offset >= Size)
+        continue;
+      collectReferences(Field.TI, Buffer + Field.Offset, Size - Field.Offset,
+                        References);
+    }
+  }
+
   const TypeInfo *getClosureContextInfo(StoredPointer Context,
                                         const ClosureContextInfo &Info) {
     RecordTypeInfoBuilder Builder(getBuilder().getTypeConverter(),
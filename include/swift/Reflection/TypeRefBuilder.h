@@ -296,6 +296,31 @@ public:
 private:
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// The number of entries at the front of ReflectionInfos whose records
+  /// have been added to the indexes below.
+  size_t NumIndexedReflectionInfos = 0;
+
+  /// Field descriptors, keyed by mangled type name.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldDescriptors;
+
+  /// Builtin type descriptors, keyed by mangled type name.
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeDescriptors;
+
+  /// Associated type descriptors, keyed by mangled conforming type name, in
+  /// the order in which they appear in the images.
+  std::unordered_map<std::string,
+                     std::vector<const AssociatedTypeDescriptor *>>
+    AssociatedTypeDescriptors;
+
+  /// Capture descriptors, keyed by their address in the remote process.
+  std::unordered_map<uintptr_t, const CaptureDescriptor *>
+    CaptureDescriptors;
+
+  /// Add the records of any reflection infos added since the last lookup to
+  /// the indexes, so that lookups don't have to scan every section.
+  void indexReflectionInfos();
+
 public:
   TypeConverter &getTypeConverter() { return TC; }
 
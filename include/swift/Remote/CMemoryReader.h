@@ -21,6 +21,11 @@
 #include "swift/SwiftRemoteMirror/MemoryReaderInterface.h"
 #include "swift/Remote/MemoryReader.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
 namespace swift {
 namespace remote {
 
@@ -29,6 +34,57 @@ namespace remote {
 class CMemoryReader final : public MemoryReader {
   MemoryReaderImpl Impl;
 
+  /// The granularity at which remote memory is cached.
+  static constexpr uint64_t CachePageSize = 4096;
+
+  /// The most pages to keep before starting the cache over.
+  static constexpr size_t MaxCachedPages = 4096;
+
+  /// Whether reads are served from, and fill, the page cache.
+  bool CachingEnabled = false;
+
+  /// Pages of remote memory that have already been read, keyed by address.
+  std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> CachedPages;
+
+  /// Returns the contents of the page at the given page-aligned address,
+  /// reading it if it isn't cached yet, or null if it can't be read whole.
+  const uint8_t *getCachedPage(uint64_t pageAddress) {
+    auto found = CachedPages.find(pageAddress);
+    if (found != CachedPages.end())
+      return found->second.get();
+
+    std::unique_ptr<uint8_t[]> page(new uint8_t[CachePageSize]);
+    if (!Impl.readBytes(Impl.reader_context, pageAddress, page.get(),
+                        CachePageSize))
+      return nullptr;
+
+    if (CachedPages.size() >= MaxCachedPages)
+      CachedPages.clear();
+    auto result = page.get();
+    CachedPages.insert({pageAddress, std::move(page)});
+    return result;
+  }
+
+  /// Serves a read from the page cache. Returns false if any page it
+  /// touches can't be read whole.
+  bool readCachedBytes(uint64_t address, uint8_t *dest, uint64_t size) {
+    while (size != 0) {
+      uint64_t pageAddress = address & ~(CachePageSize - 1);
+      uint64_t offset = address - pageAddress;
+      uint64_t chunk = std::min(size, CachePageSize - offset);
+
+      auto page = getCachedPage(pageAddress);
+      if (!page)
+        return false;
+      memcpy(dest, page + offset, chunk);
+
+      address += chunk;
+      dest += chunk;
+      size -= chunk;
+    }
+    return true;
+  }
+
 public:
   CMemoryReader(MemoryReaderImpl Impl) : Impl(Impl) {
     assert(this->Impl.getPointerSize && "No getPointerSize implementation");
@@ -71,9 +127,36 @@ public:
   }
 
   bool readBytes(RemoteAddress address, uint8_t *dest, uint64_t size) override {
+    // Small reads touch at most two pages; larger ones gain nothing from
+    // the cache.
+    if (CachingEnabled && size <= CachePageSize &&
+        readCachedBytes(address.getAddressData(), dest, size))
+      return true;
+
     return Impl.readBytes(Impl.reader_context,
                           address.getAddressData(), dest, size) != 0;
   }
+
+  /// Enable or disable caching of remote memory a page at a time.
+  ///
+  /// Metadata walks make many small reads close to each other, and each one
+  /// is a round trip to the remote process. The cache turns them into one
+  /// read per page, but it is only valid while the remote process isn't
+  /// running; call clearCache() whenever it may have changed its memory.
+  void setCachingEnabled(bool enabled) {
+    CachingEnabled = enabled;
+    if (!enabled)
+      clearCache();
+  }
+
+  bool isCachingEnabled() const {
+    return CachingEnabled;
+  }
+
+  /// Forget all the remote memory that has been cached.
+  void clearCache() {
+    CachedPages.clear();
+  }
 };
 
 }
@@ -229,6 +229,11 @@ private:
 /// concurrent insertions but does not support removals or rebalancing of
 /// the tree.
 ///
+/// Because the tree is never rebalanced, keys that are inserted in sorted
+/// order (such as addresses of consecutively-registered metadata) turn it
+/// into a linked list.  Entry types should therefore order by a hash of the
+/// key first and only fall back to comparing the full key on a collision.
+///
 /// The entry type must provide the following operations:
 ///
 ///   /// For debugging purposes only. Summarize this key as an integer value.
@@ -117,6 +117,14 @@ SWIFT_RUNTIME_EXPORT
 extern "C"
 void swift_reportError(uint32_t flags, const char *message);
 
+/// Print the entry counts, sizes and hit rates of the runtime's metadata
+/// and conformance caches to stderr.  Statistics are only collected when
+/// the SWIFT_DEBUG_RUNTIME_STATS environment variable is set; in that case
+/// they are also printed at exit.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_dumpRuntimeStatistics();
+
 // namespace swift
 }
 
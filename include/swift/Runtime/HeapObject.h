@@ -336,6 +336,18 @@ SWIFT_RUNTIME_EXPORT
 extern "C" void (*SWIFT_CC(RegisterPreservingCC)
                      _swift_release_n)(HeapObject *object, uint32_t n);
 
+/// Atomically increments the retain count of each object in an array.
+/// Null entries are skipped.  IRGen uses this to copy aggregates that hold
+/// many native references with a single call.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_retainArray(HeapObject * const *objects, size_t count);
+
+/// Atomically decrements the retain count of each object in an array, in
+/// order, destroying any object whose count reaches zero.  Null entries
+/// are skipped.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_releaseArray(HeapObject * const *objects, size_t count);
+
 /// Sets the RC_DEALLOCATING_FLAG flag. This is done non-atomically.
 /// The strong reference count of \p object must be 1 and no other thread may
 /// retain the object during executing this function.
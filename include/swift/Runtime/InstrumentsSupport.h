@@ -66,6 +66,34 @@ extern "C" int _swift_sizeToIndex(size_t size);
 SWIFT_RUNTIME_EXPORT
 extern "C" void _swift_zone_init(void);
 
+/// The kinds of event reported to _swift_runtimeTraceHook.
+enum RuntimeTraceEventKind : uint32_t {
+  /// Generic type metadata was instantiated.
+  /// The subject is the pattern and the detail is the new metadata.
+  RuntimeTraceMetadataInstantiation = 1,
+
+  /// A generic witness table was instantiated.
+  /// The subject is the generic table and the detail is the conforming type.
+  RuntimeTraceWitnessTableInstantiation = 2,
+
+  /// A swift_once initializer ran.
+  /// The subject is the predicate and the detail is the initializer.
+  RuntimeTraceOnceExecution = 3,
+
+  /// swift_conformsToProtocol had to scan conformance records.
+  /// The subject is the type and the detail is the protocol.
+  RuntimeTraceConformanceScan = 4,
+};
+
+/// If set, called for each runtime event described by RuntimeTraceEventKind.
+/// When the SWIFT_DEBUG_RUNTIME_TRACE environment variable names a file,
+/// the runtime installs a recorder here that writes a binary trace to that
+/// file at exit; utils/swift-runtime-trace-dump converts it to text.
+SWIFT_RUNTIME_EXPORT
+extern "C" void (*_swift_runtimeTraceHook)(uint32_t kind,
+                                           const void *subject,
+                                           const void *detail);
+
 };
 
 #endif
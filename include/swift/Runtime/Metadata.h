@@ -898,6 +898,21 @@ extern "C" const ValueWitnessTable _TWVBi128_;    // Builtin.Int128
 SWIFT_RUNTIME_EXPORT
 extern "C" const ValueWitnessTable _TWVBi256_;    // Builtin.Int256
 
+// The tables for tuples of a few 32- or 64-bit integers are used for
+// arbitrary POD data of two to four words.
+SWIFT_RUNTIME_EXPORT
+extern "C" const ValueWitnessTable _TWVTBi32_Bi32__;
+SWIFT_RUNTIME_EXPORT
+extern "C" const ValueWitnessTable _TWVTBi32_Bi32_Bi32__;
+SWIFT_RUNTIME_EXPORT
+extern "C" const ValueWitnessTable _TWVTBi32_Bi32_Bi32_Bi32__;
+SWIFT_RUNTIME_EXPORT
+extern "C" const ValueWitnessTable _TWVTBi64_Bi64__;
+SWIFT_RUNTIME_EXPORT
+extern "C" const ValueWitnessTable _TWVTBi64_Bi64_Bi64__;
+SWIFT_RUNTIME_EXPORT
+extern "C" const ValueWitnessTable _TWVTBi64_Bi64_Bi64_Bi64__;
+
 // The object-pointer table can be used for arbitrary Swift refcounted
 // pointer types.
 SWIFT_RUNTIME_EXPORT
@@ -2287,9 +2302,12 @@ struct TargetProtocolDescriptor {
   /// Reserved. Really just here to zero-pad the structure on 64-bit.
   uint32_t Reserved;
 
-  /// Default requirements are tail-allocated here.
-  void **getDefaultWitnesses() const {
-    return (void **) (this + 1);
+  /// Default requirements are tail-allocated here, as relative references
+  /// to the default witness implementations.
+  const RelativeDirectPointer<void(), /*nullable*/ false> *
+  getDefaultWitnesses() const {
+    return reinterpret_cast<
+      const RelativeDirectPointer<void(), /*nullable*/ false> *>(this + 1);
   }
 
   constexpr TargetProtocolDescriptor<Runtime>(const char *Name,
@@ -2910,6 +2928,19 @@ swift_getGenericMetadata(GenericMetadata *pattern,
                          const void *arguments)
     SWIFT_CC(RegisterPreservingCC);
 
+/// \brief Fetch a uniqued metadata object for a generic nominal type with
+/// exactly one key argument.
+SWIFT_RUNTIME_EXPORT
+extern "C" const Metadata *
+swift_getGenericMetadata1(GenericMetadata *pattern, const void *arg0);
+
+/// \brief Fetch a uniqued metadata object for a generic nominal type with
+/// exactly two key arguments.
+SWIFT_RUNTIME_EXPORT
+extern "C" const Metadata *
+swift_getGenericMetadata2(GenericMetadata *pattern,
+                          const void *arg0, const void *arg1);
+
 // Callback to allocate a generic class metadata object.
 SWIFT_RUNTIME_EXPORT
 extern "C" ClassMetadata *
@@ -185,6 +185,8 @@ class FunctionSignatureSpecializationMangler
     ClosureProp=2,
     BoxToValue=3,
     BoxToStack=4,
+    ExistentialToGeneric=5,
+    IndirectToDirect=6,
     First_Option=0, Last_Option=31,
 
     // Option Set Space. 12 bits (i.e. 12 option).
@@ -213,6 +215,8 @@ public:
   void setArgumentSROA(unsigned ArgNo);
   void setArgumentBoxToValue(unsigned ArgNo);
   void setArgumentBoxToStack(unsigned ArgNo);
+  void setArgumentExistentialToGeneric(unsigned ArgNo);
+  void setArgumentIndirectToDirect(unsigned ArgNo);
   void setReturnValueOwnedToUnowned();
 
 private:
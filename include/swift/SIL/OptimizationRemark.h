@@ -0,0 +1,98 @@
+//===--- OptimizationRemark.h - Missed optimization remarks -----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Remarks about optimizations which could not be done, e.g. a call which
+// could not be devirtualized or inlined. They are written to the file given
+// with -save-optimization-record-path, as a stream of YAML documents in the
+// format of LLVM's optimization records:
+//
+//   --- !Missed
+//   Pass:            sil-inliner
+//   Name:            TooCostly
+//   DebugLoc:        { File: foo.swift, Line: 10, Column: 7 }
+//   Function:        _TF3foo3barFT_T_
+//   Args:
+//     - Callee:          _TF3foo3bazFT_T_
+//     - Cost:            '42'
+//   ...
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SIL_OPTIMIZATIONREMARK_H
+#define SWIFT_SIL_OPTIMIZATIONREMARK_H
+
+#include "swift/Basic/LLVM.h"
+#include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/SmallVector.h"
+#include <string>
+
+namespace swift {
+
+class SILFunction;
+class SILInstruction;
+class SILModule;
+
+namespace OptRemark {
+
+/// A key-value pair making up the details of a remark.
+struct Argument {
+  std::string Key;
+  std::string Val;
+
+  Argument(StringRef Key, StringRef Val) : Key(Key), Val(Val) {}
+  Argument(StringRef Key, int N);
+  Argument(StringRef Key, unsigned N);
+
+  /// Uses the name of \p F as the value.
+  Argument(StringRef Key, const SILFunction *F);
+};
+
+/// A remark that an optimization could not be done at an instruction.
+class RemarkMissed {
+  /// The DEBUG_TYPE of the pass emitting the remark.
+  StringRef PassName;
+
+  /// Identifies the kind of remark, e.g. "TooCostly".
+  StringRef Identifier;
+
+  SILFunction *Function;
+  SourceLoc Loc;
+  SmallVector<Argument, 4> Args;
+
+public:
+  RemarkMissed(StringRef PassName, StringRef Identifier, SILInstruction &I);
+
+  RemarkMissed &operator<<(Argument A) {
+    Args.push_back(std::move(A));
+    return *this;
+  }
+
+  StringRef getPassName() const { return PassName; }
+  StringRef getIdentifier() const { return Identifier; }
+  SILFunction *getFunction() const { return Function; }
+  SourceLoc getLocation() const { return Loc; }
+  ArrayRef<Argument> getArgs() const { return Args; }
+};
+
+/// Returns true if optimization remarks are recorded for \p M.
+///
+/// Passes should check this before building a remark, since building one may
+/// be expensive.
+bool isEnabled(SILModule &M);
+
+/// Writes \p R to the optimization record of \p M, if there is one.
+void emit(SILModule &M, const RemarkMissed &R);
+
+} // end namespace OptRemark
+} // end namespace swift
+
+#endif
@@ -45,6 +45,10 @@ private:
   /// The ordered set of instructions in the SILBasicBlock.
   InstListType InstList;
 
+  /// The number of times the block was executed, according to the profile
+  /// given with -profile-use.
+  Optional<uint64_t> ExecutionCount;
+
   friend struct llvm::ilist_sentinel_traits<SILBasicBlock>;
   friend struct llvm::ilist_traits<SILBasicBlock>;
   SILBasicBlock() : Parent(0) {}
@@ -62,6 +66,14 @@ public:
   ///          debug output.
   int getDebugID();
 
+  /// Returns the number of times the block was executed, if it is known from
+  /// a profile.
+  ///
+  /// Only blocks which start a profiled region of code have a count, and
+  /// blocks created by the optimizer don't.
+  Optional<uint64_t> getExecutionCount() const { return ExecutionCount; }
+  void setExecutionCount(uint64_t Count) { ExecutionCount = Count; }
+
   SILFunction *getParent() { return Parent; }
   const SILFunction *getParent() const { return Parent; }
 
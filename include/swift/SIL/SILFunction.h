@@ -176,6 +176,10 @@ private:
   ///    method itself. In this case we need to create a vtable stub for it.
   bool Zombie = false;
 
+  /// The number of times the function was called, according to the profile
+  /// given with -profile-use.
+  Optional<uint64_t> EntryCount;
+
   SILFunction(SILModule &module, SILLinkage linkage,
               StringRef mangledName, CanSILFunctionType loweredType,
               GenericEnvironment *genericEnv,
@@ -281,6 +285,11 @@ public:
   /// Returns true if this function is dead, but kept in the module's zombie list.
   bool isZombie() const { return Zombie; }
 
+  /// Returns the number of times the function was called, if it is known from
+  /// a profile.
+  Optional<uint64_t> getEntryCount() const { return EntryCount; }
+  void setEntryCount(uint64_t Count) { EntryCount = Count; }
+
   /// Returns the calling convention used by this entry point.
   SILFunctionTypeRepresentation getRepresentation() const {
     return getLoweredFunctionType()->getRepresentation();
@@ -32,17 +32,25 @@
 #include "swift/SIL/SILType.h"
 #include "swift/SIL/SILVTable.h"
 #include "swift/SIL/SILWitnessTable.h"
+#include "swift/SIL/SpecializationRequest.h"
 #include "swift/SIL/TypeLowering.h"
 #include "swift/SIL/SILPrintContext.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 
+namespace llvm {
+namespace yaml {
+class Output;
+} // end namespace yaml
+} // end namespace llvm
+
 namespace swift {
   class AnyFunctionType;
   class ASTContext;
@@ -102,6 +110,10 @@ private:
   /// Allocator that manages the memory of all the pieces of the SILModule.
   mutable llvm::BumpPtrAllocator BPA;
 
+  /// The size of each live instruction's allocation. Only recorded with
+  /// -sil-memory-stats.
+  mutable llvm::DenseMap<const void *, unsigned> InstAllocationSizes;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -156,6 +168,23 @@ private:
   /// The list of SILGlobalVariables in the module.
   GlobalListType silGlobals;
 
+  /// Encoded side-effect summaries of the module's public functions, keyed by
+  /// function name. These are serialized along with the module.
+  llvm::StringMap<std::string> EffectsSummaries;
+
+  /// The file that optimization remarks are written to, if any.
+  std::unique_ptr<llvm::raw_ostream> OptRecordRawStream;
+
+  /// The YAML writer for OptRecordRawStream.
+  std::unique_ptr<llvm::yaml::Output> OptRecordStream;
+
+  /// The specializations of functions from other modules which could not be
+  /// made, to be written to -emit-specialization-requests-path.
+  std::vector<SpecializationRequest> SpecializationRequests;
+
+  /// The mangled names of the specializations in SpecializationRequests.
+  llvm::StringSet<> RequestedSpecializationNames;
+
   // The list of SILCoverageMaps in the module.
   CoverageMapListType coverageMaps;
 
@@ -435,6 +464,51 @@ public:
   bool linkFunction(StringRef Name,
                     LinkingMode LinkAll = LinkingMode::LinkNormal);
 
+  /// Attempt to link the body of the external declaration \p Fun, if its
+  /// serialized body has at most \p MaxSize instructions. The size is read
+  /// without deserializing the body, and only the transparent and shared
+  /// functions the body references are linked along with it.
+  ///
+  /// \return false if the linking failed or the body is too large.
+  bool linkFunctionOnDemand(SILFunction *Fun, unsigned MaxSize = UINT_MAX);
+
+  /// Records \p Summary as the encoded side-effect summary of the function
+  /// named \p Name, to be serialized along with the module.
+  void setEffectsSummary(StringRef Name, StringRef Summary) {
+    EffectsSummaries[Name] = Summary;
+  }
+
+  /// Returns the side-effect summaries recorded with setEffectsSummary.
+  const llvm::StringMap<std::string> &getEffectsSummaries() const {
+    return EffectsSummaries;
+  }
+
+  /// Returns the encoded side-effect summary of the function named \p Name,
+  /// either recorded in this module or serialized in a loaded module, or None
+  /// if there is none. The function's body doesn't need to be deserialized.
+  Optional<StringRef> lookupEffectsSummary(StringRef Name);
+
+  /// Makes optimization remarks be written to \p RawStream, as a stream of
+  /// YAML documents.
+  void setOptRecordStream(std::unique_ptr<llvm::raw_ostream> RawStream);
+
+  /// Returns the stream optimization remarks are written to, or null if they
+  /// are not recorded.
+  llvm::yaml::Output *getOptRecordStream() { return OptRecordStream.get(); }
+
+  /// Records that the specialization named \p SpecializedName could not be
+  /// made because the body of the generic function is not available.
+  void addSpecializationRequest(StringRef SpecializedName,
+                                SpecializationRequest Request) {
+    if (RequestedSpecializationNames.insert(SpecializedName).second)
+      SpecializationRequests.push_back(std::move(Request));
+  }
+
+  /// Returns the requests recorded with addSpecializationRequest.
+  ArrayRef<SpecializationRequest> getSpecializationRequests() const {
+    return SpecializationRequests;
+  }
+
   /// Check if a given function exists in the module,
   /// i.e. it can be linked by linkFunction.
   ///
@@ -553,6 +627,12 @@ public:
   /// invariants.
   void verify() const;
 
+  /// Prints the number of instructions of each kind in the module and the
+  /// bytes they take up, along with the other memory owned by the module.
+  ///
+  /// Instruction sizes are only known with -sil-memory-stats.
+  void printMemoryStats(raw_ostream &OS) const;
+
   /// Pretty-print the module.
   void dump(bool Verbose = false) const;
   
@@ -0,0 +1,58 @@
+//===--- SpecializationRequest.h - Requested specializations ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Specializations of generic functions which a client of a module wanted, but
+// could not make because the functions' bodies are not available to it. They
+// are written to the file given with -emit-specialization-requests-path as a
+// YAML sequence:
+//
+//   - Function:        _TF4Coll3sumuRxS_8SummablerFGSax_x
+//     Substitutions:   [ Swift.Int ]
+//
+// When the defining module is compiled with -prespecialize-requests, it makes
+// and exports these specializations, and the client calls them on its next
+// build.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SIL_SPECIALIZATIONREQUEST_H
+#define SWIFT_SIL_SPECIALIZATIONREQUEST_H
+
+#include "swift/Basic/LLVM.h"
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace swift {
+
+/// A request to specialize a generic function for concrete types.
+struct SpecializationRequest {
+  /// The mangled name of the generic function.
+  std::string Function;
+
+  /// The replacement for each generic parameter of the function, as a
+  /// module-qualified name of a non-generic nominal type, e.g. "Swift.Int".
+  std::vector<std::string> Substitutions;
+};
+
+/// Writes \p Requests to \p OS as YAML.
+void writeSpecializationRequests(raw_ostream &OS,
+                                 ArrayRef<SpecializationRequest> Requests);
+
+/// Appends the requests in the file at \p Path to \p Requests.
+std::error_code
+readSpecializationRequests(StringRef Path,
+                           std::vector<SpecializationRequest> &Requests);
+
+} // end namespace swift
+
+#endif
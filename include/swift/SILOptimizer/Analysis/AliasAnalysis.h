@@ -127,6 +127,12 @@ private:
   /// because doing so could give rise to collisions in the other cache.
   ValueEnumerator<ValueBase*> MemoryBehaviorValueBaseToIndex;
 
+  /// How the queries to AliasCache were answered.
+  AnalysisCacheStats AliasCacheStats;
+
+  /// How the queries to MemoryBehaviorCache were answered.
+  AnalysisCacheStats MemoryBehaviorCacheStats;
+
   AliasResult aliasAddressProjection(SILValue V1, SILValue V2,
                                      SILValue O1, SILValue O2);
 
@@ -263,6 +269,14 @@ public:
   /// Encodes the memory behavior query as a MemBehaviorKeyTy.
   MemBehaviorKeyTy toMemoryBehaviorKey(SILValue V1, SILValue V2, RetainObserveKind K);
 
+  const AnalysisCacheStats &getAliasCacheStats() const {
+    return AliasCacheStats;
+  }
+
+  const AnalysisCacheStats &getMemoryBehaviorCacheStats() const {
+    return MemoryBehaviorCacheStats;
+  }
+
   virtual void invalidate(SILAnalysis::InvalidationKind K) override {
     AliasCache.clear();
     MemoryBehaviorCache.clear();
@@ -15,6 +15,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "swift/Basic/LLVM.h"
 #include "swift/SIL/Notifications.h"
 #include <vector>
 
@@ -26,6 +27,21 @@ namespace swift {
   class SILFunction;
   class SILPassManager;
 
+  /// Counts how the queries to a cache of analysis results were answered.
+  struct AnalysisCacheStats {
+    /// The number of queries answered from the cache.
+    unsigned Hits = 0;
+
+    /// The number of queries which had to be computed.
+    unsigned Misses = 0;
+
+    /// The number of times the cache was flushed because it grew too large.
+    unsigned Flushes = 0;
+
+    /// Prints the counts on a single line, starting with \p Name.
+    void print(raw_ostream &OS, StringRef Name) const;
+  };
+
   /// The base class for all SIL-level analysis.
   class SILAnalysis : public DeleteNotificationHandler {
   public:
@@ -14,6 +14,7 @@
 #define SWIFT_SILOPTIMIZER_ANALYSIS_COLDBLOCKS_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "swift/SIL/SILValue.h"
 
 namespace swift {
@@ -42,11 +43,19 @@ class ColdBlockInfo {
   };
 
   enum {
-    RecursionDepthLimit = 3
+    RecursionDepthLimit = 3,
+
+    /// A block with a profile count below 1/ColdCountRatio of its
+    /// dominator's count is considered cold.
+    ColdCountRatio = 100
   };
 
   BranchHint getBranchHint(SILValue Cond, int recursionDepth);
 
+  /// Returns None if there's no profile data for the edge.
+  Optional<bool> isSlowPathFromProfile(const SILBasicBlock *FromBB,
+                                       const SILBasicBlock *ToBB);
+
   bool isSlowPath(const SILBasicBlock *FromBB, const SILBasicBlock *ToBB,
                   int recursionDepth);
 
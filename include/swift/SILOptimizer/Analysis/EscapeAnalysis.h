@@ -237,12 +237,20 @@ public:
 
     /// If this node was merged with another node, the final merge target is
     /// returned.
+    /// Like the find of a union-find, this lets all nodes on the way to the
+    /// target point directly to it, so that long merge chains are only walked
+    /// once.
     CGNode *getMergeTarget() {
       CGNode *Target = this;
       while (Target->mergeTo) {
         Target = Target->mergeTo;
         assert(Target->Type == NodeType::Content);
       }
+      for (CGNode *Nd = this; Nd != Target;) {
+        CGNode *Next = Nd->mergeTo;
+        Nd->mergeTo = Target;
+        Nd = Next;
+      }
       return Target;
     }
 
@@ -375,6 +383,10 @@ public:
     /// NodeType::Return.
     CGNode *ReturnNode = nullptr;
 
+    /// The node which all values share once the graph has too many nodes
+    /// (see getNode()). It escapes globally.
+    CGNode *OverflowNode = nullptr;
+
     /// Mapping of use points to bit indices in CGNode::UsePoints.
     llvm::DenseMap<ValueBase *, int> UsePoints;
 
@@ -444,6 +456,8 @@ public:
     /// If V is a projection(-path) then the base of the projection(-path) is
     /// taken. This means the node is always created for the "outermost" value
     /// where V is contained.
+    /// If the graph already has too many nodes, values other than function
+    /// arguments get the OverflowNode instead of a node of their own.
     /// Returns null, if V is not a "pointer".
     CGNode *getNode(ValueBase *V, EscapeAnalysis *EA, bool createIfNeeded = true);
 
@@ -16,6 +16,7 @@
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -34,6 +35,7 @@ private:
   SILModule &M;
   llvm::SmallVector<SCC, 32> TheSCCs;
   llvm::SmallVector<SILFunction *, 32> TheFunctions;
+  llvm::SmallVector<unsigned, 32> TheSCCLevels;
 
   // The callee analysis we use to determine the callees at each call site.
   BasicCalleeAnalysis *BCA;
@@ -69,7 +71,20 @@ public:
     return TheFunctions;
   }
 
+  /// Get the level of each SCC, in the same order as getSCCs().
+  ///
+  /// SCCs that don't call into other SCCs are at level zero, and every other
+  /// SCC is one level above the highest SCC it calls. SCCs at the same level
+  /// never call each other, so once the lower levels are done they can be
+  /// processed in any order.
+  ArrayRef<unsigned> getSCCLevels();
+
 private:
+  /// Calls \p Visit with each function that \p F may call, including the
+  /// destructors its releases may run.
+  void forEachCallee(SILFunction *F,
+                     llvm::function_ref<void(SILFunction *)> Visit);
+
   void DFS(SILFunction *F);
   void FindSCCs(SILModule &M);
 };
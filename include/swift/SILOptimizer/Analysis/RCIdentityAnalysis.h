@@ -39,6 +39,9 @@ class RCIdentityFunctionInfo {
   llvm::DenseMap<SILValue, SILValue> RCCache;
   DominanceAnalysis *DA;
 
+  /// How the queries to RCCache were answered.
+  AnalysisCacheStats CacheStats;
+
   /// This number is arbitrary and conservative. At some point if compile time
   /// is not an issue, this value should be made more aggressive (i.e. greater).
   enum { MaxRecursionDepth = 16 };
@@ -49,6 +52,8 @@ public:
 
   SILValue getRCIdentityRoot(SILValue V);
 
+  const AnalysisCacheStats &getCacheStats() const { return CacheStats; }
+
   /// Return all recursive users of V, looking through users which propagate
   /// RCIdentity. *NOTE* This ignores obvious ARC escapes where the a potential
   /// user of the RC is not managed by ARC. For instance
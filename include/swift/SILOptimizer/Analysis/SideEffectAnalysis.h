@@ -326,6 +326,10 @@ private:
   /// Returns true if \a F has an @effects attribute which could be handled.
   static bool getDefinedEffects(FunctionEffects &Effects, SILFunction *F);
   
+  /// Get the side-effects of an external function from the summary its
+  /// module recorded. Returns true if \a F has a summary which could be used.
+  static bool getSerializedEffects(FunctionEffects &Effects, SILFunction *F);
+
   /// Get the side-effects of a semantic call.
   /// Return true if \p ASC could be handled.
   bool getSemanticEffects(FunctionEffects &Effects, ArraySemanticsCall ASC);
@@ -378,6 +382,15 @@ public:
 
   /// Get the side-effects of a call site.
   void getEffects(FunctionEffects &ApplyEffects, FullApplySite FAS);
+
+  /// Encodes \p Effects as a summary which can be serialized with the
+  /// module, and used by clients which only see a declaration of the function.
+  static std::string encodeEffects(const FunctionEffects &Effects);
+
+  /// Decodes a summary produced by encodeEffects into \p Effects.
+  /// Returns false if the summary is malformed, or if it doesn't have the
+  /// same number of parameters as \p Effects.
+  static bool decodeEffects(FunctionEffects &Effects, StringRef Summary);
   
   /// No invalidation is needed. See comment for SideEffectAnalysis.
   virtual void invalidate(InvalidationKind K) override;
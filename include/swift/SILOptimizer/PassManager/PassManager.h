@@ -17,6 +17,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <map>
+#include <string>
 #include <vector>
 
 #ifndef SWIFT_SILOPTIMIZER_PASSMANAGER_PASSMANAGER_H
@@ -24,6 +26,7 @@
 
 namespace swift {
 
+class SILBasicBlock;
 class SILFunction;
 class SILFunctionTransform;
 class SILModule;
@@ -82,9 +85,33 @@ class SILPassManager {
   /// worklist (e.g. caused by a bug in a specializing optimization).
   llvm::DenseMap<SILFunction *, int> DerivationLevels;
 
+  /// The CFG of each function when its branch-dependent analyses, such as
+  /// dominance and loop info, were last known to be valid. Each block is
+  /// followed by its successors and a null.
+  ///
+  /// This lets an invalidation of branches that didn't actually change the
+  /// CFG leave those analyses alone.
+  llvm::DenseMap<SILFunction *, std::vector<SILBasicBlock *>> CFGSnapshots;
+
   /// Set to true when a pass invalidates an analysis.
   bool CurrentPassHasInvalidated = false;
 
+  /// The number of times analyses have been invalidated.
+  unsigned NumInvalidations = 0;
+
+  /// What running a pass on a function cost, added up over every run, for
+  /// -sil-pass-profile.
+  struct PassProfile {
+    unsigned NumRuns = 0;
+    uint64_t Nanoseconds = 0;
+    unsigned NumInvalidations = 0;
+    int64_t InstructionDelta = 0;
+  };
+
+  /// The profile of each (pass, function) pair that has run. Module passes
+  /// are recorded as running on "<module>".
+  std::map<std::pair<std::string, std::string>, PassProfile> PassProfiles;
+
   /// True if we need to stop running passes and restart again on the
   /// same function.
   bool RestartPipeline = false;
@@ -96,6 +123,14 @@ public:
 
   const SILOptions &getOptions() const;
 
+  /// Starts or stops adding up the time spent in each pass over all the pass
+  /// managers of the process, for tools which run many pipelines.
+  static void setRecordPassTimeTotals(bool Record);
+
+  /// Returns the time in nanoseconds spent in each pass, by pass name, since
+  /// the last call, and starts over.
+  static std::map<std::string, uint64_t> takePassTimeTotals();
+
   /// \brief Searches for an analysis of type T in the list of registered
   /// analysis. If the analysis is not found, the program terminates.
   template<typename T>
@@ -131,7 +166,11 @@ public:
       if (!AP->isLocked())
         AP->invalidate(K);
 
+    if (K & SILAnalysis::InvalidationKind::Branches)
+      CFGSnapshots.clear();
+
     CurrentPassHasInvalidated = true;
+    ++NumInvalidations;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
@@ -155,12 +194,15 @@ public:
   /// \brief Broadcast the invalidation of the function to all analysis.
   void invalidateAnalysis(SILFunction *F,
                           SILAnalysis::InvalidationKind K) {
+    K = removeUnchangedBranches(F, K);
+
     // Invalidate the analysis (unless they are locked)
     for (auto AP : Analysis)
       if (!AP->isLocked())
         AP->invalidate(F, K);
     
     CurrentPassHasInvalidated = true;
+    ++NumInvalidations;
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
   }
@@ -175,7 +217,9 @@ public:
       if (!AP->isLocked())
         AP->invalidateForDeadFunction(F, K);
     
+    CFGSnapshots.erase(F);
     CurrentPassHasInvalidated = true;
+    ++NumInvalidations;
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
   }
@@ -240,6 +284,24 @@ private:
   /// Return true if all analyses are unlocked.
   bool analysesUnlocked();
 
+  /// If \p F has no CFG snapshot yet, records its current CFG, against which
+  /// its branch-dependent analyses are valid.
+  void recordCFGSnapshot(SILFunction *F);
+
+  /// Returns \p K without \c Branches if the CFG of \p F is the same as when
+  /// its branch-dependent analyses were last valid. Otherwise, records the
+  /// new CFG and returns \p K.
+  SILAnalysis::InvalidationKind
+  removeUnchangedBranches(SILFunction *F, SILAnalysis::InvalidationKind K);
+
+  /// Adds a run of \p T on \p F, or on the whole module if \p F is null, to
+  /// the pass profile.
+  void recordPassProfile(SILTransform *T, SILFunction *F, uint64_t Nanoseconds,
+                         unsigned NumInvalidations, int64_t InstructionDelta);
+
+  /// Prints the pass profile, most expensive first.
+  void printPassProfile(llvm::raw_ostream &OS) const;
+
   /// Displays the call graph in an external dot-viewer.
   /// This function is meant for use from the debugger.
   /// When asserts are disabled, this is a NoOp.
@@ -52,6 +52,9 @@ struct ArgumentDescriptor {
   /// This parameter is owned to guaranteed.
   bool OwnedToGuaranteed;
 
+  /// Should the argument be passed as a value instead of indirectly?
+  bool IndirectToDirect;
+
   /// Is this parameter an indirect result?
   bool IsIndirectResult;
 
@@ -79,7 +82,7 @@ struct ArgumentDescriptor {
   ArgumentDescriptor(SILArgument *A)
       : Arg(A), PInfo(Arg->getKnownParameterInfo()), Index(A->getIndex()),
         Decl(A->getDecl()), IsEntirelyDead(false), Explode(false),
-        OwnedToGuaranteed(false),
+        OwnedToGuaranteed(false), IndirectToDirect(false),
         IsIndirectResult(A->isIndirectResult()),
         CalleeRelease(), CalleeReleaseInThrowBlock(),
         ProjTree(A->getModule(), A->getType()) {}
@@ -126,6 +129,14 @@ struct ArgumentDescriptor {
     size_t explosionSize = ProjTree.liveLeafCount();
     return explosionSize >= 1 && explosionSize <= 3;
   }
+
+  /// Return true if it's both legal and a good idea to pass this @in or
+  /// @in_guaranteed argument as a value.
+  ///
+  /// Passing a small loadable value directly lets the caller keep it in
+  /// registers instead of storing it to the stack. Larger values would have
+  /// to be copied on every call.
+  bool shouldConvertIndirectToDirect() const;
 };
 
 /// A structure that maintains all of the information about a specific
@@ -60,12 +60,36 @@ class ReabstractionInfo {
   /// SubstitutedType.
   CanSILFunctionType SpecializedType;
 
+  /// For a partial specialization, i.e. if some substitutions still contain
+  /// archetypes of the caller, the generic signature and environment of the
+  /// specialized function. Its generic parameters are the generic parameters
+  /// of the original function which are not replaced by concrete types.
+  CanGenericSignature SpecializedGenericSig;
+  GenericEnvironment *SpecializedGenericEnv = nullptr;
+
+  /// For a partial specialization, the substitutions to clone the original
+  /// function with. The generic parameters which stay generic are replaced by
+  /// archetypes of SpecializedGenericEnv.
+  SmallVector<Substitution, 4> ClonerParamSubs;
+
+  /// For a partial specialization, the substitutions to call the specialized
+  /// function with.
+  SmallVector<Substitution, 4> CallerParamSubs;
+
+  bool initPartialSpecialization(SILFunction *OrigF,
+                                 ArrayRef<Substitution> ParamSubs,
+                                 SubstitutionMap &TypeSubs);
+
 public:
   /// Constructs the ReabstractionInfo for generic function \p Orig with
   /// substitutions \p ParamSubs.
+  /// If \p AllowPartial is true and -sil-partial-specialization is given,
+  /// substitutions which are not concrete are kept generic in the specialized
+  /// function.
   /// If specialization is not possible getSpecializedType() will return an
   /// invalid type.
-  ReabstractionInfo(SILFunction *Orig, ArrayRef<Substitution> ParamSubs);
+  ReabstractionInfo(SILFunction *Orig, ArrayRef<Substitution> ParamSubs,
+                    bool AllowPartial = false);
 
   /// Does the \p ArgIdx refer to an indirect out-parameter?
   bool isResultIndex(unsigned ArgIdx) const {
@@ -127,6 +151,27 @@ public:
   /// SubstFTy by applying the re-abstractions.
   CanSILFunctionType createSpecializedType(CanSILFunctionType SubstFTy,
                                            SILModule &M) const;
+
+  /// Returns true if the specialized function is still generic.
+  bool isPartialSpecialization() const { return SpecializedGenericEnv; }
+
+  /// Get the generic environment of the specialized function, which is null
+  /// unless this is a partial specialization.
+  GenericEnvironment *getSpecializedGenericEnvironment() const {
+    return SpecializedGenericEnv;
+  }
+
+  /// Get the substitutions to clone the original function with in a partial
+  /// specialization.
+  ArrayRef<Substitution> getClonerParamSubstitutions() const {
+    return ClonerParamSubs;
+  }
+
+  /// Get the substitutions to call the specialized function with. This is
+  /// empty unless this is a partial specialization.
+  ArrayRef<Substitution> getCallerParamSubstitutions() const {
+    return CallerParamSubs;
+  }
 };
 
 /// Helper class for specializing a generic function given a list of
@@ -185,6 +230,16 @@ ApplySite replaceWithSpecializedFunction(ApplySite AI, SILFunction *NewF,
 /// body is not required for further optimization or inlining (-Onone).
 SILFunction *lookupPrespecializedSymbol(SILModule &M, StringRef FunctionName);
 
+/// Returns the specialization of the generic function \p Callee, which is
+/// only declared in this module, for \p Subs if the module defining it
+/// exported one.
+///
+/// If it didn't and -emit-specialization-requests-path is given, a request
+/// for the specialization is recorded in the SILModule.
+SILFunction *lookupOrRequestExportedSpecialization(SILFunction *Callee,
+                                                   ArrayRef<Substitution> Subs,
+                                                   const ReabstractionInfo &ReInfo);
+
 } // end namespace swift
 
 #endif
@@ -51,6 +51,11 @@ class SILSSAUpdater {
   // If not null updated with inserted 'phi' nodes (SILArgument).
   SmallVectorImpl<SILArgument *> *InsertedPHIs;
 
+  // Whether all the values added with AddAvailableValue are identical, once
+  // computed. Building SSA doesn't change the answer: it only records copies
+  // of identical values, or phis where the values already differ.
+  Optional<bool> AvailableValuesAreIdentical;
+
   // Not copyable.
   void operator=(const SILSSAUpdater &) = delete;
   SILSSAUpdater(const SILSSAUpdater &) = delete;
@@ -90,6 +95,8 @@ public:
 private:
 
   SILValue GetValueAtEndOfBlockInternal(SILBasicBlock *BB);
+
+  bool areAvailableValuesIdentical();
 };
 
 /// \brief Utility to wrap 'Operand's to deal with invalidation of
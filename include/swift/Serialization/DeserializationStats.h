@@ -0,0 +1,110 @@
+//===--- DeserializationStats.h - What each module file loaded --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counts and times the decls, types, conformances and SIL functions
+// deserialized from each module file, so that the imported modules that make
+// a file slow to compile can be found.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SERIALIZATION_DESERIALIZATIONSTATS_H
+#define SWIFT_SERIALIZATION_DESERIALIZATIONSTATS_H
+
+#include "swift/Basic/LLVM.h"
+#include "swift/Basic/TopCollection.h"
+#include <chrono>
+#include <cstdint>
+
+namespace swift {
+class ASTContext;
+class Decl;
+
+namespace serialization {
+
+/// What was deserialized from a single module file, and how long it took.
+struct DeserializationStats {
+  unsigned NumDecls = 0;
+  unsigned NumTypes = 0;
+  unsigned NumConformances = 0;
+  unsigned NumSILFunctions = 0;
+
+  /// The time spent deserializing each kind of entity, in nanoseconds.
+  ///
+  /// These don't include time spent deserializing other entities along the
+  /// way, so that they can be added up across modules.
+  uint64_t DeclTime = 0;
+  uint64_t TypeTime = 0;
+  uint64_t ConformanceTime = 0;
+  uint64_t SILFunctionTime = 0;
+
+  /// The decls that took the longest to deserialize, including everything
+  /// deserialized along the way.
+  ///
+  /// TopCollection keeps the lowest scores, so decls are scored by their
+  /// negated time.
+  TopCollection<int64_t, const Decl *> ExpensiveDecls;
+
+  DeserializationStats();
+
+  /// Records that deserializing \p D took \p Elapsed nanoseconds, including
+  /// everything deserialized along the way.
+  void recordDecl(const Decl *D, uint64_t Elapsed);
+
+  uint64_t getTotalTime() const {
+    return DeclTime + TypeTime + ConformanceTime + SILFunctionTime;
+  }
+
+  /// Starts collecting statistics for module files loaded from now on,
+  /// keeping the \p NumExpensiveDecls most expensive decls of each.
+  static void enable(unsigned NumExpensiveDecls);
+
+  /// Returns true if statistics should be collected for new module files.
+  static bool isEnabled();
+};
+
+/// Measures the time from its construction to its destruction, and adds it
+/// to a total in a DeserializationStats, minus the time measured by timers
+/// created while it was alive.
+///
+/// Does nothing if \p Total is null.
+class DeserializationTimer {
+  using Clock = std::chrono::steady_clock;
+
+  uint64_t *Total;
+  DeserializationTimer *Parent = nullptr;
+  Clock::time_point Start;
+  uint64_t NestedTime = 0;
+
+public:
+  explicit DeserializationTimer(uint64_t *Total);
+  ~DeserializationTimer();
+
+  DeserializationTimer(const DeserializationTimer &) = delete;
+  DeserializationTimer &operator=(const DeserializationTimer &) = delete;
+
+  /// Returns the time since the timer was created, in nanoseconds, including
+  /// the time measured by nested timers.
+  uint64_t getElapsed() const;
+};
+
+/// Prints the statistics for each module file loaded into \p Ctx, and the
+/// most expensive decls among all of them.
+void printDeserializationStats(ASTContext &Ctx, raw_ostream &OS);
+
+/// Adds the statistics of all module files loaded into \p Ctx to the
+/// "Serialization" counters and timers of swift::stats.
+void addDeserializationStatistics(ASTContext &Ctx);
+
+} // end namespace serialization
+} // end namespace swift
+
+#endif
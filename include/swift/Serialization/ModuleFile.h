@@ -20,6 +20,7 @@
 #include "swift/AST/Module.h"
 #include "swift/AST/RawComment.h"
 #include "swift/AST/TypeLoc.h"
+#include "swift/Serialization/DeserializationStats.h"
 #include "swift/Serialization/ModuleFormat.h"
 #include "swift/Serialization/Validation.h"
 #include "swift/Basic/LLVM.h"
@@ -279,10 +280,14 @@ private:
   using SerializedLocalDeclTable =
       llvm::OnDiskIterableChainedHashTable<LocalDeclTableInfo>;
 
+  class ExtensionTableInfo;
+  using SerializedExtensionTable =
+      llvm::OnDiskIterableChainedHashTable<ExtensionTableInfo>;
+
   std::unique_ptr<SerializedDeclTable> TopLevelDecls;
   std::unique_ptr<SerializedDeclTable> OperatorDecls;
   std::unique_ptr<SerializedDeclTable> PrecedenceGroupDecls;
-  std::unique_ptr<SerializedDeclTable> ExtensionDecls;
+  std::unique_ptr<SerializedExtensionTable> ExtensionDecls;
   std::unique_ptr<SerializedDeclTable> ClassMembersByName;
   std::unique_ptr<SerializedDeclTable> OperatorMethodDecls;
   std::unique_ptr<SerializedLocalDeclTable> LocalTypeDecls;
@@ -293,6 +298,16 @@ private:
 
   std::unique_ptr<SerializedObjCMethodTable> ObjCMethods;
 
+  class DeclMemberNamesTableInfo;
+  using SerializedDeclMemberNamesTable =
+    llvm::OnDiskIterableChainedHashTable<DeclMemberNamesTableInfo>;
+
+  std::unique_ptr<SerializedDeclMemberNamesTable> DeclMemberNames;
+
+  /// What has been deserialized from this module file, if
+  /// -stats-deserialization is enabled.
+  std::unique_ptr<serialization::DeserializationStats> Stats;
+
   llvm::DenseMap<const ValueDecl *, Identifier> PrivateDiscriminatorsByValue;
 
   TinyPtrVector<Decl *> ImportDecls;
@@ -399,11 +414,21 @@ private:
   std::unique_ptr<SerializedLocalDeclTable>
   readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk extension hash table stored in
+  /// index_block::DeclListLayout format.
+  std::unique_ptr<SerializedExtensionTable>
+  readExtensionTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Read an on-disk Objective-C method table stored in
   /// index_block::ObjCMethodTableLayout format.
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
   readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk table of members by name stored in
+  /// index_block::DeclMemberNamesLayout format.
+  std::unique_ptr<ModuleFile::SerializedDeclMemberNamesTable>
+  readDeclMemberNamesTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Reads the index block, which contains global tables.
   ///
   /// Returns false if there was an error.
@@ -539,6 +564,12 @@ public:
     return static_cast<Status>(Bits.Status);
   }
 
+  /// Returns what has been deserialized from this module file, or null if
+  /// statistics aren't being collected.
+  const serialization::DeserializationStats *getStats() const {
+    return Stats.get();
+  }
+
   /// Returns the list of modules this module depends on.
   ArrayRef<Dependency> getDependencies() const {
     return Dependencies;
@@ -646,6 +677,10 @@ public:
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData) override;
 
+  virtual Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier N,
+                   uint64_t contextData) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
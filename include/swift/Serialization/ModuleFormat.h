@@ -54,7 +54,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 275; // Last change: remove some unused bits
+const uint16_t VERSION_MINOR = 281; // Last change: SIL side-effect summaries
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -446,7 +446,8 @@ namespace options_block {
     XCC,
     IS_SIB,
     IS_TESTABLE,
-    RESILIENCE_STRATEGY
+    RESILIENCE_STRATEGY,
+    MERGED_INPUTS_HASH
   };
 
   using SDKPathLayout = BCRecordLayout<
@@ -472,6 +473,11 @@ namespace options_block {
     RESILIENCE_STRATEGY,
     BCFixed<2>
   >;
+
+  using MergedInputsHashLayout = BCRecordLayout<
+    MERGED_INPUTS_HASH,
+    BCBlob // hash of the partial modules this module was merged from
+  >;
 }
 
 /// The record types within the input block.
@@ -1375,6 +1381,14 @@ namespace decls_block {
 
 }
 
+/// Returns the name stored with each extension of \p nominal in the
+/// EXTENSIONS table, which tells it apart from other nominal types with the
+/// same name.
+///
+/// This is the mangled name of the type, or an empty string for imported
+/// Clang types, whose extensions are always loaded.
+std::string getExtendedNominalMangledName(const NominalTypeDecl *nominal);
+
 /// Returns the encoding kind for the given decl.
 ///
 /// Note that this does not work for all encodable decls, only those designed
@@ -1452,6 +1466,11 @@ namespace index_block {
     NORMAL_CONFORMANCE_OFFSETS,
 
     PRECEDENCE_GROUPS,
+
+    /// A map from each member name and member list (identified by the bit
+    /// offset of its MEMBERS record) to the members with that name, used to
+    /// deserialize only the members a lookup asks for.
+    DECL_MEMBER_NAMES,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
@@ -1476,6 +1495,12 @@ namespace index_block {
     BCBlob         // map from Objective-C selectors to methods with that selector
   >;
 
+  using DeclMemberNamesLayout = BCRecordLayout<
+    DECL_MEMBER_NAMES,  // record ID
+    BCVBR<16>,          // table offset within the blob (see below)
+    BCBlob              // map from member names and member lists to decl IDs
+  >;
+
   using EntryPointLayout = BCRecordLayout<
     ENTRY_POINT,
     DeclIDField  // the ID of the main class; 0 if there was a main source file
@@ -29,14 +29,17 @@ namespace swift {
 
     const char *OutputPath = nullptr;
     const char *DocOutputPath = nullptr;
+    const char *SummaryOutputPath = nullptr;
 
     StringRef GroupInfoPath;
     StringRef ImportedHeader;
     StringRef ModuleLinkName;
+    StringRef MergedInputsHash;
     ArrayRef<std::string> ExtraClangOptions;
 
     bool AutolinkForceLoad = false;
     bool SerializeAllSIL = false;
+    bool CompressSIL = false;
     bool SerializeOptionsForDebugging = false;
     bool IsSIB = false;
   };
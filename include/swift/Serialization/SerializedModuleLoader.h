@@ -29,8 +29,33 @@ private:
   using LoadedModulePair = std::pair<std::unique_ptr<ModuleFile>, unsigned>;
   std::vector<LoadedModulePair> LoadedModuleFiles;
 
+  /// A module file that has been read and validated, but not attached to a
+  /// module yet.
+  struct ValidatedModuleFile;
+
+  /// Module files found by prefetchModules that have not been imported yet,
+  /// keyed by module name.
+  llvm::StringMap<std::unique_ptr<ValidatedModuleFile>> PrefetchedModules;
+
+  /// The number of search paths there were when modules were prefetched.
+  ///
+  /// Loading a module may add search paths, in which case a prefetched module
+  /// may not be the one a search would find now.
+  size_t PrefetchSearchPathCount = 0;
+
   explicit SerializedModuleLoader(ASTContext &ctx, DependencyTracker *tracker);
 
+  /// Read the module file in \p moduleInputBuffer into \p result, and check
+  /// whether it can be loaded, without touching the ASTContext.
+  static void
+  validateModuleFile(std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer,
+                     std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
+                     bool isFramework, ValidatedModuleFile &result);
+
+  /// Attach a validated module file to \p M, or diagnose why it can't be.
+  FileUnit *loadAST(Module &M, Optional<SourceLoc> diagLoc,
+                    ValidatedModuleFile &loaded);
+
 public:
   /// \brief Create a new importer that can load serialized Swift modules
   /// into the given ASTContext.
@@ -70,6 +95,14 @@ public:
                     std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
                     bool isFramework = false);
 
+  /// Find and validate the module files for the modules named \p names, and
+  /// for the modules they depend on, using up to \p numThreads threads.
+  ///
+  /// This only reads the files and the search paths, so that it can be done
+  /// for several modules at once. Each module is still attached to the
+  /// ASTContext, and any problem with it diagnosed, when it is imported.
+  void prefetchModules(ArrayRef<Identifier> names, unsigned numThreads);
+
   /// \brief Register a memory buffer that contains the serialized
   /// module for the given access path. This API is intended to be
   /// used by LLDB to add swiftmodules discovered in the __apple_ast
@@ -112,6 +145,9 @@ class SerializedASTFile final : public LoadedFile {
 public:
   bool isSIB() const { return IsSIB; }
 
+  /// Returns the module file this file unit was loaded from.
+  const ModuleFile &getFile() const { return File; }
+
   virtual bool isSystemModule() const override;
 
   virtual void lookupValue(Module::AccessPathTy accessPath,
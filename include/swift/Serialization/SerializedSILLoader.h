@@ -95,6 +95,13 @@ public:
   lookupSILFunction(StringRef Name, bool declarationOnly = false,
                     SILLinkage linkage = SILLinkage::Private);
   bool hasSILFunction(StringRef Name, SILLinkage linkage = SILLinkage::Private);
+  /// Returns the number of instructions in the serialized body of the
+  /// function named \p Name, without deserializing it, or None if no loaded
+  /// module has a body for it.
+  Optional<unsigned> getSILFunctionBodySize(StringRef Name);
+  /// Returns the encoded side-effect summary that a loaded module recorded
+  /// for the function named \p Name, or None if there is none.
+  Optional<StringRef> lookupEffectsSummary(StringRef Name);
   SILVTable *lookupVTable(Identifier Name);
   SILVTable *lookupVTable(const ClassDecl *C) {
     return lookupVTable(C->getName());
@@ -85,6 +85,7 @@ struct ValidationInfo {
 class ExtendedValidationInfo {
   SmallVector<StringRef, 4> ExtraClangImporterOpts;
   StringRef SDKPath;
+  StringRef MergedInputsHash;
   struct {
     unsigned IsSIB : 1;
     unsigned IsTestable : 1;
@@ -99,6 +100,14 @@ public:
     SDKPath = path;
   }
 
+  /// The hash of the partial modules and options a merged module was built
+  /// from, or empty if it wasn't merged from partial modules.
+  StringRef getMergedInputsHash() const { return MergedInputsHash; }
+  void setMergedInputsHash(StringRef hash) {
+    assert(MergedInputsHash.empty());
+    MergedInputsHash = hash;
+  }
+
   ArrayRef<StringRef> getExtraClangImporterOptions() const {
     return ExtraClangImporterOpts;
   }
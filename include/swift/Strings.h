@@ -18,6 +18,8 @@ namespace swift {
   static const char SERIALIZED_MODULE_EXTENSION[] = "swiftmodule";
   /// The extension for serialized documentation comments.
   static const char SERIALIZED_MODULE_DOC_EXTENSION[] = "swiftdoc";
+  /// The extension for summaries of a module's interface.
+  static const char SERIALIZED_MODULE_SUMMARY_EXTENSION[] = "swiftsummary";
   /// The extension for SIL files.
   static const char SIL_EXTENSION[] = "sil";
   /// The extension for SIB files.
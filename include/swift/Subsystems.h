@@ -34,6 +34,7 @@ namespace llvm {
 }
 
 namespace swift {
+  class AbstractFunctionDecl;
   class ArchetypeBuilder;
   class ASTContext;
   class CodeCompletionCallbacksFactory;
@@ -120,6 +121,22 @@ namespace swift {
                              PersistentParserState &PersistentState,
                              CodeCompletionCallbacksFactory *Factory);
 
+  /// \brief Parse a new body for \p AFD, replacing the one it has.
+  ///
+  /// This is used to bring an AST up to date after an edit that only touched
+  /// the function body, without parsing the rest of the file again.
+  ///
+  /// \param BufferID the buffer holding the new text of the function.
+  ///
+  /// \param Offset the offset of the body's '{' in \p BufferID.
+  ///
+  /// \param EndOffset the offset just past the body's '}' in \p BufferID.
+  ///
+  /// \returns true if the text at that range isn't a single brace statement,
+  /// in which case \p AFD is left unchanged.
+  bool reparseAbstractFunctionBody(AbstractFunctionDecl *AFD, unsigned BufferID,
+                                   unsigned Offset, unsigned EndOffset);
+
   /// \brief Lex and return a vector of tokens for the given buffer.
   std::vector<Token> tokenize(const LangOptions &LangOpts,
                               const SourceManager &SM, unsigned BufferID,
@@ -154,7 +171,15 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// If set, dumps wall time taken to type-check each expression to
+    /// llvm::errs().
+    DebugTimeExpressions = 1 << 3,
+
+    /// If set, dumps the memory the constraint solver used for each
+    /// expression to llvm::errs().
+    DebugSolverMemory = 1 << 4
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
@@ -165,10 +190,14 @@ namespace swift {
   ///
   /// \param WarnLongFunctionBodies If non-zero, warn when a function body takes
   /// longer than this many milliseconds to type-check
+  ///
+  /// \param WarnLongExpressions If non-zero, warn when an expression takes
+  /// longer than this many milliseconds to type-check
   void performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                            OptionSet<TypeCheckingFlags> Options,
                            unsigned StartElem = 0,
-                           unsigned WarnLongFunctionBodies = 0);
+                           unsigned WarnLongFunctionBodies = 0,
+                           unsigned WarnLongExpressions = 0);
 
   /// Once type checking is complete, this walks protocol requirements
   /// to resolve default witnesses.
@@ -186,6 +215,12 @@ namespace swift {
   /// Incrementally type-check only added external definitions.
   void typeCheckExternalDefinitions(SourceFile &SF);
 
+  /// Type-check the body of \p AFD, along with any local functions in it,
+  /// after it was given a new body by reparseAbstractFunctionBody().
+  ///
+  /// The rest of the file must already be type-checked.
+  void typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD);
+
   /// \brief Recursively validate the specified type.
   ///
   /// This is used when dealing with partial source files (e.g. SIL parsing,
@@ -54,6 +54,20 @@ swift_reflection_createReflectionContext(
 void
 swift_reflection_destroyReflectionContext(SwiftReflectionContextRef Context);
 
+/// Enable or disable caching of the remote process's memory.
+///
+/// When enabled, memory is read from the remote process a page at a time
+/// and kept, which makes inspecting many objects much faster. The cached
+/// contents are only valid as long as the remote process is stopped; call
+/// swift_reflection_clearMemoryCache whenever it may have run.
+void
+swift_reflection_setMemoryCachingEnabled(SwiftReflectionContextRef ContextRef,
+                                         int Enabled);
+
+/// Forget the remote memory cached since caching was enabled.
+void
+swift_reflection_clearMemoryCache(SwiftReflectionContextRef ContextRef);
+
 /// Add reflection sections for a loaded Swift image.
 void
 swift_reflection_addReflectionInfo(SwiftReflectionContextRef ContextRef,
@@ -130,6 +144,25 @@ swift_reflection_childOfInstance(SwiftReflectionContextRef ContextRef,
                                  uintptr_t Object,
                                  unsigned Index);
 
+/// Describes many class or closure context instances at once, for taking a
+/// snapshot of the heap.
+///
+/// For each of the NumObjects addresses in Objects, fills in the entry of
+/// OutSnapshots with the same index, and stores the strong references the
+/// object holds in OutReferences. The remote process's memory is cached for
+/// the duration of the call, so each object costs about one read.
+///
+/// Returns the total number of references found. If this is larger than
+/// MaxReferences, only the first MaxReferences were stored, and the call
+/// should be repeated with a larger references array.
+size_t
+swift_reflection_snapshotObjects(SwiftReflectionContextRef ContextRef,
+                                 const uintptr_t *Objects,
+                                 size_t NumObjects,
+                                 swift_object_snapshot_t *OutSnapshots,
+                                 uintptr_t *OutReferences,
+                                 size_t MaxReferences);
+
 /// Returns the number of generic arguments of a typeref.
 unsigned
 swift_reflection_genericArgumentCountOfTypeRef(swift_typeref_t OpaqueTypeRef);
@@ -117,6 +117,26 @@ typedef struct swift_childinfo {
   swift_typeref_t TR;
 } swift_childinfo_t;
 
+/// \brief Information about one object in a heap snapshot.
+typedef struct swift_object_snapshot {
+  /// The object's isa pointer with the isa mask applied, or 0 if it
+  /// couldn't be read.
+  uintptr_t Metadata;
+
+  /// A type reference for the object, or 0 if none could be constructed.
+  swift_typeref_t TypeRef;
+
+  /// The size of the instance in bytes, or 0 if its layout is unknown.
+  unsigned InstanceSize;
+
+  /// The index in the references array of the first value held by the
+  /// object's strong reference fields.
+  unsigned FirstReference;
+
+  /// The number of non-null strong references the object holds.
+  unsigned NumReferences;
+} swift_object_snapshot_t;
+
 /// \brief An opaque pointer to a context which maintains state and
 /// caching of reflection structure for heap instances.
 typedef struct SwiftReflectionContext *SwiftReflectionContextRef;
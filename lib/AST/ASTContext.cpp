@@ -39,7 +39,9 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Format.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include <algorithm>
@@ -47,6 +49,10 @@
 
 using namespace swift;
 
+#define DEBUG_TYPE "ArchetypeBuilder"
+STATISTIC(NumArchetypeBuilderCacheHits,
+          "# of requests for a stored archetype builder that already existed");
+
 LazyResolver::~LazyResolver() = default;
 DelegatingLazyResolver::~DelegatingLazyResolver() = default;
 void ModuleLoader::anchor() {}
@@ -219,6 +225,10 @@ struct ASTContext::Implementation {
   llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
                  std::unique_ptr<ArchetypeBuilder>> ArchetypeBuilders;
 
+  /// \brief The generic environments of the stored archetype builders.
+  llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
+                 GenericEnvironment *> CanonicalGenericEnvironments;
+
   /// The set of property names that show up in the defining module of a
   /// class.
   llvm::DenseMap<std::pair<const ClassDecl *, char>,
@@ -343,6 +353,14 @@ struct ASTContext::Implementation {
   /// \brief The current constraint solver arena, if any.
   std::unique_ptr<ConstraintSolverArena> CurrentConstraintSolverArena;
 
+  /// AST node allocations counted for -print-ast-memory-stats.
+  struct {
+    unsigned long long Bytes[NumASTAllocationKinds][NumASTAllocationSources] = {};
+    unsigned long long Counts[NumASTAllocationKinds] = {};
+    unsigned long long SolverArenaBytes = 0;
+    unsigned long long PeakSolverArenaBytes = 0;
+  } ASTMemoryStats;
+
   Arena &getArena(AllocationArena arena) {
     switch (arena) {
     case AllocationArena::Permanent:
@@ -375,6 +393,12 @@ ConstraintCheckerArenaRAII(ASTContext &self, llvm::BumpPtrAllocator &allocator,
 }
 
 ConstraintCheckerArenaRAII::~ConstraintCheckerArenaRAII() {
+  if (Self.CountASTAllocations) {
+    auto &Stats = Self.Impl.ASTMemoryStats;
+    Stats.PeakSolverArenaBytes = std::max<unsigned long long>(
+        Stats.PeakSolverArenaBytes,
+        Self.Impl.CurrentConstraintSolverArena->Allocator.getBytesAllocated());
+  }
   Self.Impl.CurrentConstraintSolverArena.reset(
     (ASTContext::Implementation::ConstraintSolverArena *)Data);
 }
@@ -1181,6 +1205,23 @@ void ASTContext::loadExtensions(NominalTypeDecl *nominal,
   }
 }
 
+void ASTContext::bindUnboundExtensions(NominalTypeDecl *nominal) {
+  auto resolver = getLazyResolver();
+  if (!resolver)
+    return;
+
+  auto known = UnboundExtensions.find(nominal->getName());
+  if (known == UnboundExtensions.end())
+    return;
+
+  // Binding an extension can look at the extensions of this type again, so
+  // take these out of the table first.
+  auto extensions = std::move(known->second);
+  UnboundExtensions.erase(known);
+  for (auto ext : extensions)
+    resolver->bindExtension(ext);
+}
+
 void ASTContext::loadObjCMethods(
        ClassDecl *classDecl,
        ObjCSelector selector,
@@ -1252,8 +1293,10 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   // Check whether we already have an archetype builder for this
   // signature and module.
   auto known = Impl.ArchetypeBuilders.find({sig, mod});
-  if (known != Impl.ArchetypeBuilders.end())
+  if (known != Impl.ArchetypeBuilders.end()) {
+    ++NumArchetypeBuilderCacheHits;
     return known->second.get();
+  }
 
   // Create a new archetype builder with the given signature.
   auto builder = new ArchetypeBuilder(*mod, Diags);
@@ -1266,6 +1309,15 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   return builder;
 }
 
+GenericEnvironment *ASTContext::getOrCreateCanonicalGenericEnvironment(
+                      CanGenericSignature sig,
+                      ModuleDecl *mod) {
+  auto &env = Impl.CanonicalGenericEnvironments[{sig, mod}];
+  if (!env)
+    env = getOrCreateArchetypeBuilder(sig, mod)->getGenericEnvironment();
+  return env;
+}
+
 Module *
 ASTContext::getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath) {
   assert(!ModulePath.empty());
@@ -1502,6 +1554,57 @@ size_t ASTContext::getTotalMemory() const {
     return Size;
 }
 
+void ASTContext::recordASTAllocationImpl(ASTAllocationKind kind, size_t bytes,
+                                         AllocationArena arena) const {
+  auto &Stats = Impl.ASTMemoryStats;
+  auto kindIndex = static_cast<unsigned>(kind);
+  Stats.Bytes[kindIndex][static_cast<unsigned>(CurrentAllocationSource)] +=
+    bytes;
+  ++Stats.Counts[kindIndex];
+  if (arena == AllocationArena::ConstraintSolver)
+    Stats.SolverArenaBytes += bytes;
+}
+
+void ASTContext::printASTMemoryStats(raw_ostream &OS) const {
+  static const char *const KindNames[NumASTAllocationKinds] = {
+    "Decl", "Expr", "Stmt", "Pattern", "Type", "Conformance",
+  };
+  auto &Stats = Impl.ASTMemoryStats;
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << std::string(29, ' ') << "AST memory statistics\n"
+     << "===" << std::string(73, '-') << "===\n";
+  OS << llvm::format("%-12s %14s %14s %14s %14s %10s\n", "kind", "parsed",
+                     "deserialized", "imported", "total bytes", "count");
+
+  unsigned long long TotalBySource[NumASTAllocationSources] = {};
+  unsigned long long TotalCount = 0;
+  for (unsigned kind = 0; kind != NumASTAllocationKinds; ++kind) {
+    auto &Bytes = Stats.Bytes[kind];
+    unsigned long long Total = 0;
+    for (unsigned source = 0; source != NumASTAllocationSources; ++source) {
+      Total += Bytes[source];
+      TotalBySource[source] += Bytes[source];
+    }
+    TotalCount += Stats.Counts[kind];
+    OS << llvm::format("%-12s %14llu %14llu %14llu %14llu %10llu\n",
+                       KindNames[kind], Bytes[0], Bytes[1], Bytes[2], Total,
+                       Stats.Counts[kind]);
+  }
+  OS << llvm::format("%-12s %14llu %14llu %14llu %14llu %10llu\n", "total",
+                     TotalBySource[0], TotalBySource[1], TotalBySource[2],
+                     TotalBySource[0] + TotalBySource[1] + TotalBySource[2],
+                     TotalCount);
+
+  OS << "\nPermanent arena: "
+     << Impl.Allocator.getBytesAllocated() << " bytes allocated, "
+     << Impl.Allocator.getTotalMemory() << " bytes reserved\n";
+  OS << "Constraint solver arenas: " << Stats.SolverArenaBytes
+     << " bytes of AST nodes, peak arena " << Stats.PeakSolverArenaBytes
+     << " bytes\n";
+  OS << "ASTContext total: " << getTotalMemory() << " bytes\n";
+}
+
 size_t ASTContext::getSolverMemory() const {
   size_t Size = 0;
   
@@ -29,6 +29,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -38,6 +39,11 @@ using llvm::DenseMap;
 
 using NestedType = ArchetypeType::NestedType;
 
+#define DEBUG_TYPE "ArchetypeBuilder"
+STATISTIC(NumArchetypeBuilders, "# of archetype builders created");
+STATISTIC(NumGenericEnvironments,
+          "# of generic environments created from archetype builders");
+
 void RequirementSource::dump(SourceManager *srcMgr) const {
   dump(llvm::errs(), srcMgr);
 }
@@ -815,6 +821,7 @@ ArchetypeBuilder::ArchetypeBuilder(Module &mod, DiagnosticEngine &diags)
   : Mod(mod), Context(mod.getASTContext()), Diags(diags),
     Impl(new Implementation)
 {
+  ++NumArchetypeBuilders;
 }
 
 ArchetypeBuilder::ArchetypeBuilder(ArchetypeBuilder &&) = default;
@@ -2112,6 +2119,8 @@ GenericSignature *ArchetypeBuilder::getGenericSignature() {
 }
 
 GenericEnvironment *ArchetypeBuilder::getGenericEnvironment() {
+  ++NumGenericEnvironments;
+
   SmallVector<GenericTypeParamType *, 4> genericParamTypes;
   TypeSubstitutionMap interfaceToArchetypeMap;
 
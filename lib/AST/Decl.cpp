@@ -74,6 +74,7 @@ const clang::Module *ClangNode::getClangModule() const {
 // Only allow allocation of Decls using the allocator in ASTContext.
 void *Decl::operator new(size_t Bytes, const ASTContext &C,
                          unsigned Alignment) {
+  C.recordASTAllocation(ASTAllocationKind::Decl, Bytes);
   return C.Allocate(Bytes, Alignment);
 }
 
@@ -567,6 +568,7 @@ ImportDecl *ImportDecl::create(ASTContext &Ctx, DeclContext *DC,
          isa<clang::ImportDecl>(ClangN.getAsDecl()));
   size_t Size = totalSizeToAlloc<AccessPathElement>(Path.size());
   void *ptr = allocateMemoryForDecl<ImportDecl>(Ctx, Size, !ClangN.isNull());
+  Ctx.recordASTAllocation(ASTAllocationKind::Decl, Size);
   auto D = new (ptr) ImportDecl(DC, ImportLoc, Kind, KindLoc, Path);
   if (ClangN)
     D->setClangNode(ClangN);
@@ -724,6 +726,7 @@ ExtensionDecl *ExtensionDecl::create(ASTContext &ctx, SourceLoc extensionLoc,
 
   void *declPtr = allocateMemoryForDecl<ExtensionDecl>(ctx, size,
                                                        !clangNode.isNull());
+  ctx.recordASTAllocation(ASTAllocationKind::Decl, size);
 
   // Construct the extension.
   auto result = ::new (declPtr) ExtensionDecl(extensionLoc, extendedType,
@@ -829,6 +832,7 @@ PatternBindingDecl::create(ASTContext &Ctx, SourceLoc StaticLoc,
   size_t Size = totalSizeToAlloc<PatternBindingEntry>(PatternList.size());
   void *D = allocateMemoryForDecl<PatternBindingDecl>(Ctx, Size,
                                                       /*ClangNode*/false);
+  Ctx.recordASTAllocation(ASTAllocationKind::Decl, Size);
   auto PBD = ::new (D) PatternBindingDecl(StaticLoc, StaticSpelling, VarLoc,
                                           PatternList.size(), Parent);
 
@@ -860,6 +864,7 @@ PatternBindingDecl *PatternBindingDecl::createDeserialized(
   size_t Size = totalSizeToAlloc<PatternBindingEntry>(NumPatternEntries);
   void *D = allocateMemoryForDecl<PatternBindingDecl>(Ctx, Size,
                                                       /*ClangNode*/false);
+  Ctx.recordASTAllocation(ASTAllocationKind::Decl, Size);
   auto PBD = ::new (D) PatternBindingDecl(StaticLoc, StaticSpelling, VarLoc,
                                           NumPatternEntries, Parent);
   for (auto &entry : PBD->getMutablePatternList()) {
@@ -2144,6 +2149,10 @@ Type NominalTypeDecl::computeInterfaceType() const {
 void NominalTypeDecl::prepareExtensions() {
   auto &context = Decl::getASTContext();
 
+  // Bind any extensions in other source files that were left for later.
+  if (!context.UnboundExtensions.empty())
+    context.bindUnboundExtensions(this);
+
   // If our list of extensions is out of date, update it now.
   if (context.getCurrentGeneration() > ExtensionGeneration) {
     unsigned previousGeneration = ExtensionGeneration;
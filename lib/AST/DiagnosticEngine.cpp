@@ -147,6 +147,8 @@ InFlightDiagnostic &InFlightDiagnostic::highlightChars(SourceLoc Start,
 ///
 InFlightDiagnostic &InFlightDiagnostic::fixItInsertAfter(SourceLoc L,
                                                          StringRef Str) {
+  if (!Engine)
+    return *this;
   L = Lexer::getLocForEndOfToken(Engine->SourceMgr, L);
   return fixItInsert(L, Str);
 }
@@ -216,6 +218,8 @@ InFlightDiagnostic &InFlightDiagnostic::fixItReplaceChars(SourceLoc Start,
 InFlightDiagnostic &InFlightDiagnostic::fixItExchange(SourceRange R1,
                                                       SourceRange R2) {
   assert(IsActive && "Cannot modify an inactive diagnostic");
+  if (!Engine)
+    return *this;
 
   auto &SM = Engine->SourceMgr;
   // Convert from a token range to a CharSourceRange
@@ -525,18 +529,20 @@ static DiagnosticKind toDiagnosticKind(DiagnosticState::Behavior behavior) {
 }
 
 DiagnosticState::Behavior DiagnosticState::determineBehavior(DiagID id) {
-  auto set = [this](DiagnosticState::Behavior lvl) {
-    if (lvl == Behavior::Fatal) {
-      fatalErrorOccurred = true;
-      anyErrorOccurred = true;
-    } else if (lvl == Behavior::Error) {
-      anyErrorOccurred = true;
-    }
+  auto lvl = computeBehavior(id);
+  if (lvl == Behavior::Fatal) {
+    fatalErrorOccurred = true;
+    anyErrorOccurred = true;
+  } else if (lvl == Behavior::Error) {
+    anyErrorOccurred = true;
+  }
 
-    previousBehavior = lvl;
-    return lvl;
-  };
+  previousBehavior = lvl;
+  return lvl;
+}
 
+DiagnosticState::Behavior
+DiagnosticState::computeBehavior(DiagID id) const {
   // We determine how to handle a diagnostic based on the following rules
   //   1) If current state dictates a certain behavior, follow that
   //   2) If the user provided a behavior for this specific diagnostic, follow
@@ -552,39 +558,49 @@ DiagnosticState::Behavior DiagnosticState::determineBehavior(DiagID id) {
 
   // Notes relating to ignored diagnostics should also be ignored
   if (previousBehavior == Behavior::Ignore && isNote)
-    return set(Behavior::Ignore);
+    return Behavior::Ignore;
 
   // Suppress diagnostics when in a fatal state, except for follow-on notes
   if (fatalErrorOccurred)
     if (!showDiagnosticsAfterFatalError && !isNote)
-      return set(Behavior::Ignore);
+      return Behavior::Ignore;
 
   //   2) If the user provided a behavior for this specific diagnostic, follow
   //      that
 
   if (perDiagnosticBehavior[(unsigned)id] != Behavior::Unspecified)
-    return set(perDiagnosticBehavior[(unsigned)id]);
+    return perDiagnosticBehavior[(unsigned)id];
 
   //   3) If the user provided a behavior for this diagnostic's kind, follow
   //      that
   if (diagInfo.kind == DiagnosticKind::Warning) {
     if (suppressWarnings)
-      return set(Behavior::Ignore);
+      return Behavior::Ignore;
     if (warningsAsErrors)
-      return set(Behavior::Error);
+      return Behavior::Error;
   }
 
   //   4) Otherwise remap the diagnostic kind
   switch (diagInfo.kind) {
   case DiagnosticKind::Note:
-    return set(Behavior::Note);
+    return Behavior::Note;
   case DiagnosticKind::Error:
-    return set(diagInfo.isFatal ? Behavior::Fatal : Behavior::Error);
+    return diagInfo.isFatal ? Behavior::Fatal : Behavior::Error;
   case DiagnosticKind::Warning:
-    return set(Behavior::Warning);
+    return Behavior::Warning;
   }
 }
 
+InFlightDiagnostic DiagnosticEngine::startActiveDiagnostic() {
+  if (!isIgnored(ActiveDiagnostic->getID()))
+    return InFlightDiagnostic(*this);
+
+  // Record the diagnostic as ignored, so that its notes are ignored too.
+  state.determineBehavior(ActiveDiagnostic->getID());
+  ActiveDiagnostic.reset();
+  return InFlightDiagnostic();
+}
+
 void DiagnosticEngine::flushActiveDiagnostic() {
   assert(ActiveDiagnostic && "No active diagnostic to flush");
   if (TransactionCount == 0) {
@@ -607,6 +623,11 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   if (behavior == DiagnosticState::Behavior::Ignore)
     return;
 
+  // Without a consumer, nothing asks for the text or for the location, which
+  // may require pretty-printing a declaration.
+  if (Consumers.empty())
+    return;
+
   // Figure out the source location.
   SourceLoc loc = diagnostic.getLoc();
   if (loc.isInvalid() && diagnostic.getDecl()) {
@@ -50,6 +50,7 @@ StringRef swift::getFunctionRefKindStr(FunctionRefKind refKind) {
 // Only allow allocation of Stmts using the allocator in ASTContext.
 void *Expr::operator new(size_t Bytes, ASTContext &C,
                          unsigned Alignment) {
+  C.recordASTAllocation(ASTAllocationKind::Expr, Bytes);
   return C.Allocate(Bytes, Alignment);
 }
 
@@ -78,6 +78,15 @@ ArchetypeBuilder *GenericSignature::getArchetypeBuilder(ModuleDecl &mod) {
                                                      &mod);
 }
 
+GenericEnvironment *
+GenericSignature::getCanonicalGenericEnvironment(ModuleDecl &mod) {
+  if (!isCanonical())
+    return getCanonicalSignature()->getCanonicalGenericEnvironment(mod);
+
+  return getASTContext().getOrCreateCanonicalGenericEnvironment(
+                           CanGenericSignature(this), &mod);
+}
+
 bool GenericSignature::isCanonical() const {
   if (CanonicalSignatureOrASTContext.is<ASTContext*>()) return true;
 
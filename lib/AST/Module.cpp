@@ -355,6 +355,7 @@ void Module::addFile(FileUnit &newFile) {
          cast<SourceFile>(newFile).Kind == SourceFileKind::Library ||
          cast<SourceFile>(newFile).Kind == SourceFileKind::SIL);
   Files.push_back(&newFile);
+  invalidateModuleScopeLookups();
 }
 
 void Module::removeFile(FileUnit &existingFile) {
@@ -367,6 +368,7 @@ void Module::removeFile(FileUnit &existingFile) {
   // Adjust for the std::reverse_iterator offset.
   ++I;
   Files.erase(I.base());
+  invalidateModuleScopeLookups();
 }
 
 #define FORWARD(name, args) \
@@ -1380,6 +1382,7 @@ void SourceFile::addImports(
   assert(iter == newBuf.end());
 
   Imports = newBuf;
+  getParentModule()->invalidateModuleScopeLookups();
 }
 
 bool SourceFile::hasTestableImport(const swift::Module *module) const {
@@ -1392,6 +1395,9 @@ bool SourceFile::hasTestableImport(const swift::Module *module) const {
 }
 
 void SourceFile::clearLookupCache() {
+  // Decls may have been added to this file, which other files can see.
+  getParentModule()->invalidateModuleScopeLookups();
+
   if (!Cache)
     return;
 
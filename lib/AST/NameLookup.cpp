@@ -18,6 +18,7 @@
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/AST.h"
 #include "swift/AST/ASTScope.h"
+#include "swift/AST/ASTWalker.h"
 #include "swift/AST/ASTVisitor.h"
 #include "swift/AST/DebuggerClient.h"
 #include "swift/AST/LazyResolver.h"
@@ -26,10 +27,17 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Name lookup"
+STATISTIC(NumModuleScopeLookupCacheHits,
+          "# of unqualified lookups at module scope answered from the cache");
+STATISTIC(NumModuleScopeLookupCacheMisses,
+          "# of unqualified lookups at module scope not in the cache");
+
 void DebuggerClient::anchor() {}
 
 void AccessFilteringDeclConsumer::foundDecl(ValueDecl *D,
@@ -384,6 +392,62 @@ static void filterForDiscriminator(SmallVectorImpl<Result> &results,
   results.push_back(lastMatch);
 }
 
+namespace {
+  /// Collects the base name of every declaration and named pattern within a
+  /// function or closure body.
+  ///
+  /// This is a superset of what namelookup::FindLocalVal can find in the
+  /// body from any location.
+  class LocalDeclNameCollector : public ASTWalker {
+    llvm::DenseSet<Identifier> &Names;
+
+  public:
+    explicit LocalDeclNameCollector(llvm::DenseSet<Identifier> &names)
+      : Names(names) {}
+
+    bool walkToDeclPre(Decl *D) override {
+      if (auto *VD = dyn_cast<ValueDecl>(D))
+        if (VD->hasName())
+          Names.insert(VD->getName());
+      return true;
+    }
+
+    // Expressions introduce no declarations that FindLocalVal looks at;
+    // closures are searched separately as contexts of their own.
+    std::pair<bool, Expr *> walkToExprPre(Expr *E) override {
+      return { false, E };
+    }
+
+    std::pair<bool, Pattern *> walkToPatternPre(Pattern *P) override {
+      if (auto *NP = dyn_cast<NamedPattern>(P))
+        Names.insert(NP->getBoundName());
+      return { true, P };
+    }
+  };
+}
+
+/// Returns true if \p body might contain a local declaration named \p name.
+///
+/// Searching a body for local declarations walks every statement in it, and
+/// unqualified lookup of a non-local name does this for every reference in
+/// the body.  Remember the names each body declares so that such lookups can
+/// skip the walk.
+static bool mayDeclareLocalName(ASTContext &ctx, BraceStmt *body,
+                                DeclName name) {
+  Identifier baseName = name.getBaseName();
+  if (baseName.empty())
+    return true;
+
+  auto known = ctx.LocalDeclNamesInBody.find(body);
+  if (known == ctx.LocalDeclNamesInBody.end()) {
+    llvm::DenseSet<Identifier> names;
+    LocalDeclNameCollector collector(names);
+    body->walk(collector);
+    known = ctx.LocalDeclNamesInBody.insert({body, std::move(names)}).first;
+  }
+  return known->second.count(baseName);
+}
+
 static void recordLookupOfTopLevelName(DeclContext *topLevelContext,
                                        DeclName name,
                                        bool isCascading) {
@@ -709,7 +773,8 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
             }
 
             namelookup::FindLocalVal localVal(SM, Loc, Consumer);
-            localVal.visit(AFD->getBody());
+            if (mayDeclareLocalName(Ctx, AFD->getBody(), Name))
+              localVal.visit(AFD->getBody());
             if (!Results.empty())
               return;
             for (auto *PL : AFD->getParameterLists())
@@ -755,7 +820,8 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
           if (Loc.isValid()) {
             if (auto *CE = dyn_cast<ClosureExpr>(ACE)) {
               namelookup::FindLocalVal localVal(SM, Loc, Consumer);
-              localVal.visit(CE->getBody());
+              if (mayDeclareLocalName(Ctx, CE->getBody(), Name))
+                localVal.visit(CE->getBody());
               if (!Results.empty())
                 return;
               localVal.checkParameterList(CE->getParameters());
@@ -910,17 +976,60 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
 
   recordLookupOfTopLevelName(DC, Name, isCascadingUse.getValue());
 
-  // Add private imports to the extra search list.
-  SmallVector<Module::ImportedModule, 8> extraImports;
-  if (auto FU = dyn_cast<FileUnit>(DC))
-    FU->getImportedModules(extraImports, Module::ImportFilter::Private);
-
   using namespace namelookup;
   SmallVector<ValueDecl *, 8> CurModuleResults;
   auto resolutionKind =
     IsTypeLookup ? ResolutionKind::TypesOnly : ResolutionKind::Overloadable;
-  lookupInModule(&M, {}, Name, CurModuleResults, NLKind::UnqualifiedLookup,
-                 resolutionKind, TypeResolver, DC, extraImports);
+
+  // What's visible at module scope only changes when a file or import is
+  // added, or another module is loaded, so the source file remembers what
+  // each name found.
+  SourceFile::ModuleScopeLookupCache *moduleScopeCache = nullptr;
+  auto moduleScopeKey = std::make_pair(
+      Name, unsigned(IsTypeLookup) | (TypeResolver ? 2 : 0));
+  auto *lookupSF = dyn_cast<SourceFile>(DC);
+  if (lookupSF && lookupSF->Kind != SourceFileKind::REPL && !DebugClient) {
+    moduleScopeCache = &lookupSF->getModuleScopeLookupCache();
+    if (moduleScopeCache->ModuleGeneration !=
+          M.getModuleScopeLookupGeneration() ||
+        moduleScopeCache->NumLoadedModules != Ctx.LoadedModules.size()) {
+      moduleScopeCache->Results.clear();
+      moduleScopeCache->ModuleGeneration = M.getModuleScopeLookupGeneration();
+      moduleScopeCache->NumLoadedModules = Ctx.LoadedModules.size();
+    }
+  }
+
+  bool foundInModuleScopeCache = false;
+  if (moduleScopeCache) {
+    auto known = moduleScopeCache->Results.find(moduleScopeKey);
+    if (known != moduleScopeCache->Results.end()) {
+      ++NumModuleScopeLookupCacheHits;
+      CurModuleResults.append(known->second.begin(), known->second.end());
+      foundInModuleScopeCache = true;
+    }
+  }
+
+  if (!foundInModuleScopeCache) {
+    // Add private imports to the extra search list.
+    SmallVector<Module::ImportedModule, 8> extraImports;
+    if (auto FU = dyn_cast<FileUnit>(DC))
+      FU->getImportedModules(extraImports, Module::ImportFilter::Private);
+
+    lookupInModule(&M, {}, Name, CurModuleResults, NLKind::UnqualifiedLookup,
+                   resolutionKind, TypeResolver, DC, extraImports);
+
+    // Don't keep the results if the lookup itself changed what's visible.
+    if (moduleScopeCache) {
+      ++NumModuleScopeLookupCacheMisses;
+      if (moduleScopeCache->ModuleGeneration ==
+            M.getModuleScopeLookupGeneration() &&
+          moduleScopeCache->NumLoadedModules == Ctx.LoadedModules.size()) {
+        auto &cached = moduleScopeCache->Results[moduleScopeKey];
+        for (auto VD : CurModuleResults)
+          cached.push_back(VD);
+      }
+    }
+  }
 
   for (auto VD : CurModuleResults)
     Results.push_back(UnqualifiedLookupResult(VD));
@@ -1000,7 +1109,16 @@ public:
   void destroy();
 
   /// Update a lookup table with members from newly-added extensions.
-  void updateLookupTable(NominalTypeDecl *nominal);
+  ///
+  /// If \p skipLazy is true, extensions whose members haven't been loaded
+  /// are marked as included without loading them; their members must then be
+  /// added by name as they are looked up.
+  void updateLookupTable(NominalTypeDecl *nominal, bool skipLazy = false);
+
+  /// Retrieve the last extension included in the lookup table.
+  ExtensionDecl *getLastExtensionIncluded() const {
+    return LastExtensionIncluded;
+  }
 
   /// \brief Add the given member to the lookup table.
   void addMember(Decl *members);
@@ -1127,7 +1245,8 @@ void MemberLookupTable::addExtensionMembers(NominalTypeDecl *nominal,
   addMembers(members);
 }
 
-void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
+void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal,
+                                          bool skipLazy) {
   // If the last extension we included is the same as the last known extension,
   // we're already up-to-date.
   if (LastExtensionIncluded == nominal->LastExtension)
@@ -1139,6 +1258,8 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
                      : nominal->FirstExtension;
        next;
        (LastExtensionIncluded = next,next = next->NextExtension.getPointer())) {
+    if (skipLazy && next->isLazy())
+      continue;
     addMembers(next->getMembers());
   }
 }
@@ -1172,15 +1293,18 @@ void ExtensionDecl::addedMember(Decl *member) {
 }
 
 void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
+  auto &ctx = getASTContext();
+  bool namedLazyMembers = ctx.LangOpts.EnableNamedLazyMemberLoading;
+
   // If we haven't allocated the lookup table yet, do so now.
   if (!LookupTable.getPointer()) {
-    auto &ctx = getASTContext();
     LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
   }
 
   // If we haven't walked the member list yet to update the lookup
-  // table, do so now.
-  if (!LookupTable.getInt()) {
+  // table, do so now. Members that haven't been loaded yet are added by name
+  // when loading members by name.
+  if (!LookupTable.getInt() && !(namedLazyMembers && isLazy())) {
     // Note that we'll have walked the members now.
     LookupTable.setInt(true);
 
@@ -1190,7 +1314,7 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
 
   if (!ignoreNewExtensions) {
     // Update the lookup table to introduce members from extensions.
-    LookupTable.getPointer()->updateLookupTable(this);
+    LookupTable.getPointer()->updateLookupTable(this, namedLazyMembers);
   }
 }
 
@@ -1203,19 +1327,62 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
   LookupTable.getPointer()->addMember(member);
 }
 
+/// Add the members of \p IDC named \p name to \p table, if they haven't been
+/// loaded yet.
+///
+/// Falls back to loading all of IDC's members if its loader can't load them
+/// by name, which adds them to the table as well.
+static void addNamedLazyMembers(MemberLookupTable &table,
+                                const IterableDeclContext *IDC,
+                                DeclName name) {
+  if (!IDC->isLazy())
+    return;
+
+  auto members = IDC->getLoader()->loadNamedMembers(
+      IDC, name.getBaseName(), IDC->getLoaderContextData());
+  if (!members) {
+    (void)IDC->getMembers();
+    return;
+  }
+
+  for (auto member : *members)
+    table.addMember(member);
+}
+
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
+  bool namedLazyMembers = getASTContext().LangOpts.EnableNamedLazyMemberLoading;
+
   // Make sure we have the complete list of members (in this nominal and in all
   // extensions).
   if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
+    auto extensions = getExtensions();
+    if (!namedLazyMembers) {
+      for (auto E : extensions)
+        (void)E->getMembers();
+    }
   }
 
-  (void)getMembers();
+  if (!namedLazyMembers)
+    (void)getMembers();
 
   prepareLookupTable(ignoreNewExtensions);
 
+  // If we're loading members by name, load the members with this name from
+  // this nominal and from each extension included in the table whose members
+  // haven't been loaded yet.
+  if (namedLazyMembers) {
+    auto &table = *LookupTable.getPointer();
+    addNamedLazyMembers(table, this, name);
+    if (auto last = table.getLastExtensionIncluded()) {
+      for (auto E = FirstExtension; E; E = E->NextExtension.getPointer()) {
+        addNamedLazyMembers(table, E, name);
+        if (E == last)
+          break;
+      }
+    }
+  }
+
   // Look for the declarations with this name.
   auto known = LookupTable.getPointer()->find(name);
   if (known == LookupTable.getPointer()->end())
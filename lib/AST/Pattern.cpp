@@ -290,6 +290,7 @@ case PatternKind::ID: foundRefutablePattern = true; break;
 
 /// Standard allocator for Patterns.
 void *Pattern::operator new(size_t numBytes, const ASTContext &C) {
+  C.recordASTAllocation(ASTAllocationKind::Pattern, numBytes);
   return C.Allocate(numBytes, alignof(Pattern));
 }
 
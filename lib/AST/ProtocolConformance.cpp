@@ -77,6 +77,7 @@ ProtocolConformanceRef::getInherited(ProtocolDecl *parent) const {
 void *ProtocolConformance::operator new(size_t bytes, ASTContext &context,
                                         AllocationArena arena,
                                         unsigned alignment) {
+  context.recordASTAllocation(ASTAllocationKind::Conformance, bytes, arena);
   return context.Allocate(bytes, alignment, arena);
 
 }
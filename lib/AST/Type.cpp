@@ -49,6 +49,7 @@ SourceRange TypeLoc::getSourceRange() const {
 // Only allow allocation of Types using the allocator in ASTContext.
 void *TypeBase::operator new(size_t bytes, const ASTContext &ctx,
                              AllocationArena arena, unsigned alignment) {
+  ctx.recordASTAllocation(ASTAllocationKind::Type, bytes, arena);
   return ctx.Allocate(bytes, alignment, arena);
 }
 
@@ -81,6 +82,8 @@ GenericTypeDecl *CanType::getAnyGeneric() const {
 
 /// isEqual - Return true if these two types are equal, ignoring sugar.
 bool TypeBase::isEqual(Type Other) {
+  if (this == Other.getPointer())
+    return true;
   return getCanonicalType() == Other.getPointer()->getCanonicalType();
 }
 
@@ -2934,15 +2937,38 @@ static Type substType(
   });
 }
 
+/// Whether substitution could change \p type: only archetypes and type
+/// parameters are ever replaced.
+static bool isSubstitutable(Type type) {
+  CanType canType = type->getCanonicalType();
+  return canType->hasArchetype() || canType->hasTypeParameter();
+}
+
 Type Type::subst(Module *module,
                  const TypeSubstitutionMap &substitutions,
                  SubstOptions options) const {
+  if (!isSubstitutable(*this))
+    return *this;
+
   return substType(*this, module, substitutions, options);
 }
 
 Type Type::subst(const SubstitutionMap &substitutions,
                  SubstOptions options) const {
-  return substType(*this, &substitutions, substitutions.getMap(), options);
+  if (!isSubstitutable(*this))
+    return *this;
+
+  if (auto cached = substitutions.getCachedSubst(getPointer(),
+                                                 options.toRaw()))
+    return cached;
+
+  Type result = substType(*this, &substitutions, substitutions.getMap(),
+                          options);
+
+  // Failures may depend on conformances that haven't been resolved yet.
+  if (result && !result->hasError())
+    substitutions.cacheSubst(getPointer(), options.toRaw(), result);
+  return result;
 }
 
 Type TypeBase::getSuperclassForDecl(const ClassDecl *baseClass,
@@ -0,0 +1,202 @@
+//===--- BinarySwiftDeps.cpp - Binary reference dependency files ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/BinarySwiftDeps.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using namespace swift::binary_swiftdeps;
+
+// Layout:
+//
+//   header:  char[4] signature, u16 major, u16 minor,
+//            u32 entry count, u32 string count, u32 string data size
+//   entries: { u8 kind, u8 flags, u16 reserved, u32 name, u32 member }...
+//   strings: { u32 offset, u32 length }...
+//   string data, padded to a multiple of 4 bytes
+static const size_t HeaderSize = 20;
+static const size_t EntrySize = 12;
+static const size_t StringSize = 8;
+
+/// Used in place of a string index for entries without a member name.
+static const uint32_t NoMember = ~0u;
+
+enum : uint8_t {
+  IsCascadingFlag = 1 << 0,
+};
+
+bool binary_swiftdeps::hasSignature(StringRef Data) {
+  return Data.startswith(StringRef(Signature, sizeof(Signature)));
+}
+
+uint32_t Writer::intern(StringRef S) {
+  auto Inserted =
+      StringIndices.insert({S, static_cast<uint32_t>(Strings.size())});
+  if (Inserted.second)
+    Strings.push_back(Inserted.first->getKey());
+  return Inserted.first->getValue();
+}
+
+static bool isProvidesKind(EntryKind Kind) {
+  switch (Kind) {
+  case EntryKind::ProvidesTopLevel:
+  case EntryKind::ProvidesNominal:
+  case EntryKind::ProvidesMember:
+  case EntryKind::ProvidesDynamicLookup:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void Writer::addEntry(EntryKind Kind, StringRef Name, bool IsCascading,
+                      StringRef Fingerprint) {
+  assert(Kind != EntryKind::ProvidesMember &&
+         Kind != EntryKind::DependsMember && "use addMemberEntry");
+  assert(Kind != EntryKind::Fingerprint && "not a standalone entry");
+  Entries.push_back({Kind, IsCascading, intern(Name), NoMember});
+  if (!Fingerprint.empty()) {
+    assert(isProvidesKind(Kind) && "only provided names have fingerprints");
+    Entries.push_back({EntryKind::Fingerprint, true, intern(Fingerprint),
+                       NoMember});
+  }
+}
+
+void Writer::addMemberEntry(EntryKind Kind, StringRef BaseName,
+                            StringRef Member, bool IsCascading,
+                            StringRef Fingerprint) {
+  assert((Kind == EntryKind::ProvidesMember ||
+          Kind == EntryKind::DependsMember) && "not a member entry");
+  uint32_t BaseIndex = intern(BaseName);
+  Entries.push_back({Kind, IsCascading, BaseIndex, intern(Member)});
+  if (!Fingerprint.empty()) {
+    assert(isProvidesKind(Kind) && "only provided names have fingerprints");
+    Entries.push_back({EntryKind::Fingerprint, true, intern(Fingerprint),
+                       NoMember});
+  }
+}
+
+void Writer::write(raw_ostream &OS) const {
+  using namespace llvm::support;
+  endian::Writer<little> W(OS);
+
+  uint32_t DataSize = 0;
+  for (StringRef S : Strings)
+    DataSize += S.size();
+
+  OS.write(Signature, sizeof(Signature));
+  W.write<uint16_t>(VersionMajor);
+  W.write<uint16_t>(VersionMinor);
+  W.write<uint32_t>(Entries.size());
+  W.write<uint32_t>(Strings.size());
+  W.write<uint32_t>(DataSize);
+
+  for (const RawEntry &E : Entries) {
+    W.write<uint8_t>(static_cast<uint8_t>(E.Kind));
+    W.write<uint8_t>(E.IsCascading ? IsCascadingFlag : 0);
+    W.write<uint16_t>(0);
+    W.write<uint32_t>(E.Name);
+    W.write<uint32_t>(E.Member);
+  }
+
+  uint32_t Offset = 0;
+  for (StringRef S : Strings) {
+    W.write<uint32_t>(Offset);
+    W.write<uint32_t>(S.size());
+    Offset += S.size();
+  }
+
+  for (StringRef S : Strings)
+    OS << S;
+  for (uint32_t Pad = DataSize; Pad % 4 != 0; ++Pad)
+    W.write<uint8_t>(0);
+}
+
+bool binary_swiftdeps::read(StringRef Data,
+                            llvm::function_ref<bool(const Entry &)> Callback) {
+  using namespace llvm::support;
+
+  if (Data.size() < HeaderSize || !hasSignature(Data))
+    return true;
+
+  const char *Cursor = Data.data() + sizeof(Signature);
+  if (endian::read16le(Cursor) != VersionMajor)
+    return true;
+  Cursor += 4; // Skip both version numbers.
+
+  uint64_t NumEntries = endian::read32le(Cursor);
+  uint64_t NumStrings = endian::read32le(Cursor + 4);
+  uint64_t DataSize = endian::read32le(Cursor + 8);
+  uint64_t PaddedDataSize = (DataSize + 3) & ~uint64_t(3);
+  if (HeaderSize + NumEntries * EntrySize + NumStrings * StringSize +
+      PaddedDataSize > Data.size())
+    return true;
+
+  const char *EntryTable = Data.data() + HeaderSize;
+  const char *StringTable = EntryTable + NumEntries * EntrySize;
+  StringRef StringData(StringTable + NumStrings * StringSize, DataSize);
+
+  auto getString = [&](uint32_t Index, StringRef &Result) -> bool {
+    if (Index >= NumStrings)
+      return true;
+    const char *Raw = StringTable + Index * StringSize;
+    uint64_t Offset = endian::read32le(Raw);
+    uint64_t Length = endian::read32le(Raw + 4);
+    if (Offset + Length > DataSize)
+      return true;
+    Result = StringData.substr(Offset, Length);
+    return false;
+  };
+
+  auto getKind = [&](uint64_t Index) -> uint8_t {
+    return static_cast<uint8_t>(EntryTable[Index * EntrySize]);
+  };
+
+  for (uint64_t i = 0; i != NumEntries; ++i) {
+    const char *Raw = EntryTable + i * EntrySize;
+    uint8_t Kind = getKind(i);
+    if (Kind > static_cast<uint8_t>(EntryKind::InterfaceHash))
+      return true;
+
+    Entry E;
+    E.Kind = static_cast<EntryKind>(Kind);
+    E.IsCascading = Raw[1] & IsCascadingFlag;
+    if (getString(endian::read32le(Raw + 4), E.Name))
+      return true;
+
+    bool IsMemberEntry = E.Kind == EntryKind::ProvidesMember ||
+                         E.Kind == EntryKind::DependsMember;
+    uint32_t MemberIndex = endian::read32le(Raw + 8);
+    if (IsMemberEntry != (MemberIndex != NoMember))
+      return true;
+    if (IsMemberEntry && getString(MemberIndex, E.Member))
+      return true;
+
+    // Fold in the fingerprint that follows a "provides" entry, if any.
+    if (i + 1 != NumEntries &&
+        getKind(i + 1) == static_cast<uint8_t>(EntryKind::Fingerprint)) {
+      if (!isProvidesKind(E.Kind))
+        return true;
+      ++i;
+      const char *RawFingerprint = EntryTable + i * EntrySize;
+      if (getString(endian::read32le(RawFingerprint + 4), E.Fingerprint))
+        return true;
+    }
+
+    if (Callback(E))
+      return true;
+  }
+
+  return false;
+}
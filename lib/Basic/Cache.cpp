@@ -14,11 +14,12 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation that only evicts
+//  its entries when a cost limit is set.
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Mutex.h"
 
 using namespace swift::sys;
@@ -33,12 +34,82 @@ struct DefaultCacheKey {
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
 
+struct DefaultCacheEntry {
+  void *Value;
+  size_t Cost;
+  /// The value of \c DefaultCache::UseClock when the entry was last set or
+  /// fetched.
+  uint64_t LastUse;
+};
+
 struct DefaultCache {
   llvm::sys::Mutex Mux;
   CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
+  llvm::DenseMap<DefaultCacheKey, DefaultCacheEntry> Entries;
+
+  /// The number of outstanding retains of each retained value.
+  llvm::DenseMap<void *, unsigned> Retains;
+  /// Values that were removed from the cache while retained; each is
+  /// destroyed once for every time it appears here, when it is released.
+  llvm::SmallVector<void *, 4> PendingDestroys;
+
+  uint64_t UseClock = 0;
+  size_t TotalCost = 0;
+  size_t CostLimit = 0;
+  size_t EvictionCount = 0;
 
   explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
+
+  void retain(void *Value) {
+    ++Retains[Value];
+  }
+
+  void release(void *Value) {
+    auto Found = Retains.find(Value);
+    assert(Found != Retains.end() && "releasing a value that isn't retained");
+    if (--Found->second != 0)
+      return;
+    Retains.erase(Found);
+    for (unsigned i = 0; i != PendingDestroys.size();) {
+      if (PendingDestroys[i] == Value) {
+        CBs.valueDestroyCB(Value, nullptr);
+        PendingDestroys.erase(PendingDestroys.begin() + i);
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  /// Removes \p Entry, deferring the destruction of its value if it is
+  /// retained.
+  void erase(llvm::DenseMap<DefaultCacheKey, DefaultCacheEntry>::iterator
+                 Entry) {
+    void *Value = Entry->second.Value;
+    TotalCost -= Entry->second.Cost;
+    CBs.keyDestroyCB(Entry->first.Key, nullptr);
+    Entries.erase(Entry);
+    if (Retains.count(Value))
+      PendingDestroys.push_back(Value);
+    else
+      CBs.valueDestroyCB(Value, nullptr);
+  }
+
+  /// Evicts the least recently used entries other than \p Keep until the
+  /// total cost is within the limit.
+  void evictOverLimit(const DefaultCacheKey &Keep) {
+    while (CostLimit && TotalCost > CostLimit && Entries.size() > 1) {
+      auto Oldest = Entries.end();
+      for (auto I = Entries.begin(), E = Entries.end(); I != E; ++I) {
+        if (I->first.Key == Keep.Key)
+          continue;
+        if (Oldest == Entries.end() ||
+            I->second.LastUse < Oldest->second.LastUse)
+          Oldest = I;
+      }
+      erase(Oldest);
+      ++EvictionCount;
+    }
+  }
 };
 } // end anonymous namespace
 
@@ -77,16 +148,15 @@ void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
 
   DefaultCacheKey CKey(Key, &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
+  if (Entry != DCache.Entries.end())
+    DCache.erase(Entry);
 
-  DCache.Entries[CKey] = Value;
+  DefaultCacheEntry NewEntry = { Value, Cost, ++DCache.UseClock };
+  DCache.Entries.insert({CKey, NewEntry});
+  DCache.TotalCost += Cost;
+  DCache.retain(Value);
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+  DCache.evictOverLimit(CKey);
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
@@ -96,16 +166,18 @@ bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
   if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
+    Entry->second.LastUse = ++DCache.UseClock;
+    *Value_out = Entry->second.Value;
+    DCache.retain(Entry->second.Value);
     return true;
   }
   return false;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+  DCache.release(Value);
 }
 
 bool CacheImpl::remove(const void *Key) {
@@ -115,9 +187,7 @@ bool CacheImpl::remove(const void *Key) {
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
   if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
+    DCache.erase(Entry);
     return true;
   }
   return false;
@@ -127,16 +197,28 @@ void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
   llvm::sys::ScopedLock L(DCache.Mux);
 
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
-  }
-  DCache.Entries.clear();
+  while (!DCache.Entries.empty())
+    DCache.erase(DCache.Entries.begin());
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+  DCache.CostLimit = Limit;
+}
+
+size_t CacheImpl::getEvictionCount() {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+  return DCache.EvictionCount;
 }
 
 void CacheImpl::destroy() {
   removeAll();
-  delete static_cast<DefaultCache*>(Impl);
+  DefaultCache *DCache = static_cast<DefaultCache*>(Impl);
+  for (void *Value : DCache->PendingDestroys)
+    DCache->CBs.valueDestroyCB(Value, nullptr);
+  delete DCache;
 }
 
 #endif // finish default implementation
@@ -0,0 +1,28 @@
+//===--- CompileServer.cpp - Persistent frontend processes ----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file includes the appropriate platform-specific compile server
+/// implementation, or a fallback that reports compile servers as unsupported.
+///
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/CompileServer.h"
+
+using namespace swift;
+using namespace swift::sys;
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+#include "Unix/CompileServer.inc"
+#else
+#include "Default/CompileServer.inc"
+#endif
@@ -65,6 +65,15 @@ void CacheImpl::removeAll() {
   cache_remove_all(static_cast<cache_t*>(Impl));
 }
 
+void CacheImpl::setCostLimit(size_t Limit) {
+  cache_set_cost_hint(static_cast<cache_t*>(Impl), Limit);
+}
+
+size_t CacheImpl::getEvictionCount() {
+  // libcache evicts on its own and doesn't report it.
+  return 0;
+}
+
 void CacheImpl::destroy() {
   cache_destroy(static_cast<cache_t*>(Impl));
 }
@@ -21,6 +21,7 @@
 #include "swift/Basic/Punycode.h"
 #include "swift/Basic/UUID.h"
 #include "llvm/ADT/StringRef.h"
+#include <algorithm>
 #include <functional>
 #include <vector>
 #include <cstdio>
@@ -88,6 +89,9 @@ static DemanglerPrinter &operator<<(DemanglerPrinter &printer,
 }
 
 Node::~Node() {
+  if (Children != InlineChildren)
+    delete[] Children;
+
   switch (NodePayloadKind) {
   case PayloadKind::None: return;
   case PayloadKind::Index: return;
@@ -96,6 +100,16 @@ Node::~Node() {
   unreachable("bad payload kind");
 }
 
+void Node::growChildren() {
+  uint32_t newCapacity = ChildrenCapacity * 2;
+  auto *newChildren = new NodePointer[newCapacity];
+  std::move(Children, Children + NumChildren, newChildren);
+  if (Children != InlineChildren)
+    delete[] Children;
+  Children = newChildren;
+  ChildrenCapacity = newCapacity;
+}
+
 namespace {
   struct FindPtr {
     FindPtr(Node *v) : Target(v) {}
@@ -795,6 +809,16 @@ private:
         if (!result)
           return nullptr;
         param->addChild(result);
+      } else if (Mangled.nextIf("e_")) {
+        auto result = FUNCSIGSPEC_CREATE_PARAM_KIND(ExistentialToGeneric);
+        if (!result)
+          return nullptr;
+        param->addChild(result);
+      } else if (Mangled.nextIf("a_")) {
+        auto result = FUNCSIGSPEC_CREATE_PARAM_KIND(IndirectToDirect);
+        if (!result)
+          return nullptr;
+        param->addChild(result);
       } else {
         // Otherwise handle option sets.
         unsigned Value = 0;
@@ -2702,6 +2726,8 @@ unsigned NodePrinter::printFunctionSigSpecializationParam(NodePointer pointer,
   switch (K) {
   case FunctionSigSpecializationParamKind::BoxToValue:
   case FunctionSigSpecializationParamKind::BoxToStack:
+  case FunctionSigSpecializationParamKind::ExistentialToGeneric:
+  case FunctionSigSpecializationParamKind::IndirectToDirect:
     print(pointer->getChild(Idx++));
     return Idx;
   case FunctionSigSpecializationParamKind::ConstantPropFunction:
@@ -3190,6 +3216,12 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
     case FunctionSigSpecializationParamKind::BoxToStack:
       Printer << "Stack Promoted from Box";
       break;
+    case FunctionSigSpecializationParamKind::ExistentialToGeneric:
+      Printer << "Existential To Generic";
+      break;
+    case FunctionSigSpecializationParamKind::IndirectToDirect:
+      Printer << "Indirect To Direct";
+      break;
     case FunctionSigSpecializationParamKind::ConstantPropFunction:
       Printer << "Constant Propagated Function";
       break;
@@ -3679,10 +3711,88 @@ std::string Demangle::nodeToString(NodePointer root,
   return NodePrinter(options).printRoot(root);
 }
 
+/// Demangles and prints a type of the form [CVO]+ module identifier+ (a
+/// class, struct or enum nested only in other nominal types) directly,
+/// without building a node tree.
+///
+/// Type names in runtime metadata are nearly always of this form. Returns
+/// false and leaves \p Out alone for anything else, which has to go through
+/// the full demangler.
+static bool demangleSimpleNominalType(StringRef Mangled,
+                                      const DemangleOptions &Options,
+                                      std::string &Out) {
+  size_t NumNominals = 0;
+  while (NumNominals < Mangled.size() &&
+         (Mangled[NumNominals] == 'C' || Mangled[NumNominals] == 'V' ||
+          Mangled[NumNominals] == 'O'))
+    ++NumNominals;
+  if (NumNominals == 0)
+    return false;
+  Mangled = Mangled.substr(NumNominals);
+
+  // Reads a plain identifier; punycode and operator names take the slow
+  // path.
+  auto readIdentifier = [&](StringRef &Ident) -> bool {
+    size_t Length = 0, NumDigits = 0;
+    while (NumDigits < Mangled.size() && Mangled[NumDigits] >= '0' &&
+           Mangled[NumDigits] <= '9') {
+      Length = Length * 10 + (Mangled[NumDigits] - '0');
+      if (Length > Mangled.size())
+        return false;
+      ++NumDigits;
+    }
+    if (Length == 0 || NumDigits + Length > Mangled.size())
+      return false;
+    Ident = Mangled.substr(NumDigits, Length);
+    Mangled = Mangled.substr(NumDigits + Length);
+    return true;
+  };
+
+  StringRef Module;
+  if (Mangled.startswith("s")) {
+    Module = STDLIB_NAME;
+    Mangled = Mangled.substr(1);
+  } else if (!readIdentifier(Module) ||
+             Module.startswith(LLDB_EXPRESSIONS_MODULE_NAME_PREFIX)) {
+    return false;
+  }
+
+  // Build the qualified name as we go; an unqualified name is just the
+  // innermost identifier.
+  std::string Qualified;
+  if (Options.QualifyEntities && Options.DisplayModuleNames) {
+    Qualified += Module;
+    Qualified += '.';
+  }
+  StringRef Name;
+  for (size_t I = 0; I != NumNominals; ++I) {
+    if (!readIdentifier(Name))
+      return false;
+    if (Options.QualifyEntities) {
+      if (I != 0)
+        Qualified += '.';
+      Qualified += Name;
+    }
+  }
+  if (!Mangled.empty())
+    return false;
+
+  if (Options.QualifyEntities)
+    Out += Qualified;
+  else
+    Out += Name;
+  return true;
+}
+
 std::string Demangle::demangleSymbolAsString(const char *MangledName,
                                              size_t MangledNameLength,
                                              const DemangleOptions &Options) {
   auto mangled = StringRef(MangledName, MangledNameLength);
+  std::string simple;
+  if (mangled.startswith("_Tt") &&
+      demangleSimpleNominalType(mangled.substr(3), Options, simple))
+    return simple;
+
   auto root = demangleSymbolAsNode(MangledName, MangledNameLength, Options);
   if (!root) return mangled.str();
 
@@ -3696,6 +3806,10 @@ std::string Demangle::demangleTypeAsString(const char *MangledName,
                                            size_t MangledNameLength,
                                            const DemangleOptions &Options) {
   auto mangled = StringRef(MangledName, MangledNameLength);
+  std::string simple;
+  if (demangleSimpleNominalType(mangled, Options, simple))
+    return simple;
+
   auto root = demangleTypeAsNode(MangledName, MangledNameLength, Options);
   if (!root) return mangled.str();
   
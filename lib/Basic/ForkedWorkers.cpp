@@ -0,0 +1,28 @@
+//===--- ForkedWorkers.cpp - Splitting work across processes --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file includes the appropriate platform-specific forked worker
+/// implementation, or a fallback that reports them as unsupported.
+///
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ForkedWorkers.h"
+
+using namespace swift;
+using namespace swift::sys;
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+#include "Unix/ForkedWorkers.inc"
+#else
+#include "Default/ForkedWorkers.inc"
+#endif
@@ -537,6 +537,12 @@ void Remangler::mangleFunctionSignatureSpecializationParam(Node *node) {
   case FunctionSigSpecializationParamKind::BoxToStack:
     Out << "k_";
     return;
+  case FunctionSigSpecializationParamKind::ExistentialToGeneric:
+    Out << "e_";
+    return;
+  case FunctionSigSpecializationParamKind::IndirectToDirect:
+    Out << "a_";
+    return;
   default:
     if (kindValue &
         unsigned(FunctionSigSpecializationParamKind::Dead))
@@ -0,0 +1,183 @@
+//===--- Statistics.cpp - Counters and timers of a compilation ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Statistics.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+using namespace swift;
+
+static std::atomic<bool> Enabled(false);
+
+namespace {
+struct CollectedStats {
+  std::map<std::string, uint64_t> Counters;
+  /// In nanoseconds.
+  std::map<std::string, uint64_t> Timers;
+};
+} // end anonymous namespace
+
+static CollectedStats &getStats() {
+  static CollectedStats Stats;
+  return Stats;
+}
+
+static std::mutex &getStatsMutex() {
+  static std::mutex Mutex;
+  return Mutex;
+}
+
+static std::string getKey(StringRef Group, StringRef Name) {
+  return (Group + "." + Name).str();
+}
+
+static void writeEscaped(llvm::raw_ostream &OS, StringRef Str) {
+  for (char C : Str) {
+    switch (C) {
+    case '"': OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if ((unsigned char)C < 0x20)
+        OS << "\\u00" << "0123456789abcdef"[(unsigned char)C >> 4]
+           << "0123456789abcdef"[C & 0xF];
+      else
+        OS << C;
+    }
+  }
+}
+
+/// Adds the LLVM statistics, which are only counted if they have been
+/// enabled with llvm::EnableStatistics() and LLVM was built with them.
+///
+/// LLVM can only print its statistics, as lines of the form
+/// "<value> <debug type> - <description>", so they are parsed back from that.
+static void addLLVMStatistics(std::map<std::string, uint64_t> &Counters) {
+  if (!llvm::AreStatisticsEnabled())
+    return;
+
+  std::string Printed;
+  {
+    llvm::raw_string_ostream OS(Printed);
+    llvm::PrintStatistics(OS);
+  }
+
+  StringRef Remaining = Printed;
+  while (!Remaining.empty()) {
+    StringRef Line;
+    std::tie(Line, Remaining) = Remaining.split('\n');
+    StringRef ValueStr, Rest;
+    std::tie(ValueStr, Rest) = Line.ltrim().split(' ');
+    uint64_t Value;
+    if (ValueStr.getAsInteger(10, Value))
+      continue;
+    StringRef DebugType, Description;
+    std::tie(DebugType, Description) = Rest.split(" - ");
+    if (Description.empty())
+      continue;
+    Counters[getKey("LLVM." + DebugType.trim().str(), Description.trim())] +=
+        Value;
+  }
+}
+
+/// Adds the peak memory use and the CPU time of the process.
+static void addResourceUsage(std::map<std::string, uint64_t> &Counters,
+                             std::map<std::string, uint64_t> &Timers) {
+#if !defined(_WIN32)
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage) != 0)
+    return;
+
+#if defined(__APPLE__)
+  uint64_t PeakBytes = Usage.ru_maxrss;
+#else
+  // Everywhere else, ru_maxrss is in kilobytes.
+  uint64_t PeakBytes = uint64_t(Usage.ru_maxrss) * 1024;
+#endif
+  Counters["Process.PeakMemoryBytes"] = PeakBytes;
+
+  auto toNanos = [](const struct timeval &TV) -> uint64_t {
+    return uint64_t(TV.tv_sec) * 1000000000 + uint64_t(TV.tv_usec) * 1000;
+  };
+  Timers["Process.UserTime"] = toNanos(Usage.ru_utime);
+  Timers["Process.SystemTime"] = toNanos(Usage.ru_stime);
+#endif
+}
+
+void stats::enable() {
+  Enabled = true;
+}
+
+bool stats::isEnabled() {
+  return Enabled;
+}
+
+void stats::addCounter(StringRef Group, StringRef Name, uint64_t Value) {
+  std::string Key = getKey(Group, Name);
+  std::lock_guard<std::mutex> Lock(getStatsMutex());
+  getStats().Counters[Key] += Value;
+}
+
+void stats::addTime(StringRef Group, StringRef Name, uint64_t Nanoseconds) {
+  std::string Key = getKey(Group, Name);
+  std::lock_guard<std::mutex> Lock(getStatsMutex());
+  getStats().Timers[Key] += Nanoseconds;
+}
+
+bool stats::writeStats(StringRef Path, std::string &ErrorMsg) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    ErrorMsg = EC.message();
+    return true;
+  }
+
+  CollectedStats Stats;
+  {
+    std::lock_guard<std::mutex> Lock(getStatsMutex());
+    std::swap(Stats, getStats());
+  }
+  addLLVMStatistics(Stats.Counters);
+  addResourceUsage(Stats.Counters, Stats.Timers);
+
+  // Counters and timers each come out sorted by name, which keeps the files
+  // of different builds easy to compare by eye.
+  OS << "{";
+  bool First = true;
+  auto writeKey = [&](StringRef Key) {
+    OS << (First ? "\n" : ",\n") << "  \"";
+    writeEscaped(OS, Key);
+    OS << "\": ";
+    First = false;
+  };
+  for (auto &Counter : Stats.Counters) {
+    writeKey(Counter.first);
+    OS << Counter.second;
+  }
+  for (auto &Timer : Stats.Timers) {
+    writeKey("time." + Timer.first);
+    OS << llvm::format("%.6f", Timer.second / 1e9);
+  }
+  OS << "\n}\n";
+  return false;
+}
@@ -0,0 +1,167 @@
+//===--- TraceEvents.cpp - Recording spans for a build timeline -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TraceEvents.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace swift;
+
+static std::atomic<bool> Enabled(false);
+
+/// The recorded events, each already serialized as a JSON object.
+static std::vector<std::string> &getEvents() {
+  static std::vector<std::string> Events;
+  return Events;
+}
+
+static std::mutex &getEventsMutex() {
+  static std::mutex Mutex;
+  return Mutex;
+}
+
+static uint64_t getCurrentPid() {
+#if defined(_WIN32)
+  return _getpid();
+#else
+  return getpid();
+#endif
+}
+
+/// Returns a small number identifying the current thread, assigned in the
+/// order threads first record a span.
+static uint64_t getCurrentTid() {
+  static std::atomic<unsigned> NextTid(1);
+  static LLVM_THREAD_LOCAL unsigned Tid = 0;
+  if (Tid == 0)
+    Tid = NextTid++;
+  return Tid;
+}
+
+static void writeEscaped(llvm::raw_ostream &OS, StringRef Str) {
+  for (char C : Str) {
+    switch (C) {
+    case '"': OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if ((unsigned char)C < 0x20)
+        OS << "\\u00" << "0123456789abcdef"[(unsigned char)C >> 4]
+           << "0123456789abcdef"[C & 0xF];
+      else
+        OS << C;
+    }
+  }
+}
+
+uint64_t trace::now() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(
+      system_clock::now().time_since_epoch()).count();
+}
+
+void trace::enable() {
+  Enabled = true;
+}
+
+bool trace::isEnabled() {
+  return Enabled;
+}
+
+void trace::addSpan(StringRef Category, StringRef Name, StringRef Detail,
+                    uint64_t Start, uint64_t Duration) {
+  addSpan(Category, Name, Detail, Start, Duration, getCurrentPid(),
+          getCurrentTid());
+}
+
+void trace::addSpan(StringRef Category, StringRef Name, StringRef Detail,
+                    uint64_t Start, uint64_t Duration, uint64_t Pid,
+                    uint64_t Tid) {
+  std::string Event;
+  llvm::raw_string_ostream OS(Event);
+  OS << "{\"name\": \"";
+  writeEscaped(OS, Name);
+  OS << "\", \"cat\": \"";
+  writeEscaped(OS, Category);
+  OS << "\", \"ph\": \"X\", \"ts\": " << Start << ", \"dur\": " << Duration
+     << ", \"pid\": " << Pid << ", \"tid\": " << Tid;
+  if (!Detail.empty()) {
+    OS << ", \"args\": {\"detail\": \"";
+    writeEscaped(OS, Detail);
+    OS << "\"}";
+  }
+  OS << "}";
+  OS.flush();
+
+  std::lock_guard<std::mutex> Lock(getEventsMutex());
+  getEvents().push_back(std::move(Event));
+}
+
+bool trace::addEventsFromFile(StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return true;
+
+  // writeEvents() puts each event on a line of its own.
+  std::lock_guard<std::mutex> Lock(getEventsMutex());
+  StringRef Remaining = Buffer.get()->getBuffer();
+  while (!Remaining.empty()) {
+    StringRef Line;
+    std::tie(Line, Remaining) = Remaining.split('\n');
+    Line = Line.trim();
+    if (!Line.startswith("{"))
+      continue;
+    if (Line.endswith(","))
+      Line = Line.drop_back();
+    getEvents().push_back(Line);
+  }
+  return false;
+}
+
+bool trace::writeEvents(StringRef Path, std::string &ErrorMsg) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    ErrorMsg = EC.message();
+    return true;
+  }
+
+  std::vector<std::string> Events;
+  {
+    std::lock_guard<std::mutex> Lock(getEventsMutex());
+    Events.swap(getEvents());
+  }
+
+  OS << "[\n";
+  for (size_t i = 0, e = Events.size(); i != e; ++i) {
+    OS << Events[i];
+    if (i + 1 != e)
+      OS << ",";
+    OS << "\n";
+  }
+  OS << "]\n";
+  return false;
+}
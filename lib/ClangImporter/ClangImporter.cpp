@@ -57,6 +57,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
 #include <memory>
@@ -704,96 +705,124 @@ ClangImporter::create(ASTContext &ctx,
   if (importerOpts.Mode == ClangImporterOptions::Modes::EmbedBitcode)
     return importer;
 
+  // Set up the imported header module.
+  auto *importedHeaderModule = Module::create(ctx.getIdentifier("__ObjC"), ctx);
+  importer->Impl.ImportedHeaderUnit =
+    new (ctx) ClangModuleUnit(*importedHeaderModule, *importer, nullptr);
+  importedHeaderModule->addFile(*importer->Impl.ImportedHeaderUnit);
+
+  if (importerOpts.LazyInitialization)
+    return importer;
+
+  if (importer->finishInitialization())
+    return nullptr;
+
+  return importer;
+}
+
+bool ClangImporter::finishInitialization() {
+  assert(!Impl.IsInitialized && "Clang importer already initialized");
+  Impl.IsInitialized = true;
+
+  auto &instance = *Impl.Instance;
+  auto *action = Impl.Action.get();
+
   bool canBegin = action->BeginSourceFile(instance,
                                           instance.getFrontendOpts().Inputs[0]);
   if (!canBegin)
-    return nullptr; // there was an error related to the compiler arguments.
+    return true; // there was an error related to the compiler arguments.
 
   clang::Preprocessor &clangPP = instance.getPreprocessor();
   clangPP.enableIncrementalProcessing();
 
   // Setup Preprocessor callbacks before initialing the parser to make sure
   // we catch implicit includes.
-  auto ppTracker = llvm::make_unique<BridgingPPTracker>(importer->Impl);
+  auto ppTracker = llvm::make_unique<BridgingPPTracker>(Impl);
   clangPP.addPPCallbacks(std::move(ppTracker));
 
   instance.createModuleManager();
   instance.getModuleManager()->addListener(
          std::unique_ptr<clang::ASTReaderListener>(
-                 new ASTReaderCallbacks(*importer)));
+                 new ASTReaderCallbacks(*this)));
 
   // Manually run the action, so that the TU stays open for additional parsing.
   instance.createSema(action->getTranslationUnitKind(), nullptr);
-  importer->Impl.Parser.reset(new clang::Parser(clangPP, instance.getSema(),
-                                                /*skipFunctionBodies=*/false));
+  Impl.Parser.reset(new clang::Parser(clangPP, instance.getSema(),
+                                      /*skipFunctionBodies=*/false));
 
   clangPP.EnterMainSourceFile();
-  importer->Impl.Parser->Initialize();
+  Impl.Parser->Initialize();
 
-  importer->Impl.nameImporter.reset(new NameImporter(
-      importer->Impl.SwiftContext, importer->Impl.platformAvailability,
-      importer->Impl.getClangSema(), importer->Impl.InferImportAsMember));
+  Impl.nameImporter.reset(new NameImporter(
+      Impl.SwiftContext, Impl.platformAvailability,
+      Impl.getClangSema(), Impl.InferImportAsMember));
 
   // Prefer frameworks over plain headers.
   // We add search paths here instead of when building the initial invocation
   // so that (a) we use the same code as search paths for imported modules,
   // and (b) search paths are always added after -Xcc options.
-  SearchPathOptions &searchPathOpts = ctx.SearchPathOpts;
+  SearchPathOptions &searchPathOpts = Impl.SwiftContext.SearchPathOpts;
   for (auto path : searchPathOpts.FrameworkSearchPaths)
-    importer->addSearchPath(path, /*isFramework*/true);
+    addSearchPath(path, /*isFramework*/true);
   for (auto path : searchPathOpts.ImportSearchPaths)
-    importer->addSearchPath(path, /*isFramework*/false);
+    addSearchPath(path, /*isFramework*/false);
 
   // FIXME: These decls are not being parsed correctly since (a) some of the
   // callbacks are still being added, and (b) the logic to parse them has
   // changed.
   clang::Parser::DeclGroupPtrTy parsed;
-  while (!importer->Impl.Parser->ParseTopLevelDecl(parsed)) {
+  while (!Impl.Parser->ParseTopLevelDecl(parsed)) {
     for (auto *D : parsed.get()) {
-      importer->Impl.addBridgeHeaderTopLevelDecls(D);
+      Impl.addBridgeHeaderTopLevelDecls(D);
 
       if (auto named = dyn_cast<clang::NamedDecl>(D)) {
-        addEntryToLookupTable(importer->Impl.BridgingHeaderLookupTable, named,
-                              *importer->Impl.nameImporter);
+        addEntryToLookupTable(Impl.BridgingHeaderLookupTable, named,
+                              *Impl.nameImporter);
       }
     }
   }
 
   // FIXME: This is missing implicit includes.
-  auto *CB = new HeaderImportCallbacks(*importer, importer->Impl);
+  auto *CB = new HeaderImportCallbacks(*this, Impl);
   clangPP.addPPCallbacks(std::unique_ptr<clang::PPCallbacks>(CB));
 
   // Create the selectors we'll be looking for.
-  auto &clangContext = importer->Impl.Instance->getASTContext();
-  importer->Impl.objectAtIndexedSubscript
+  auto &clangContext = Impl.Instance->getASTContext();
+  Impl.objectAtIndexedSubscript
     = clangContext.Selectors.getUnarySelector(
         &clangContext.Idents.get("objectAtIndexedSubscript"));
   clang::IdentifierInfo *setObjectAtIndexedSubscriptIdents[2] = {
     &clangContext.Idents.get("setObject"),
     &clangContext.Idents.get("atIndexedSubscript")
   };
-  importer->Impl.setObjectAtIndexedSubscript
+  Impl.setObjectAtIndexedSubscript
     = clangContext.Selectors.getSelector(2, setObjectAtIndexedSubscriptIdents);
-  importer->Impl.objectForKeyedSubscript
+  Impl.objectForKeyedSubscript
     = clangContext.Selectors.getUnarySelector(
         &clangContext.Idents.get("objectForKeyedSubscript"));
   clang::IdentifierInfo *setObjectForKeyedSubscriptIdents[2] = {
     &clangContext.Idents.get("setObject"),
     &clangContext.Idents.get("forKeyedSubscript")
   };
-  importer->Impl.setObjectForKeyedSubscript
+  Impl.setObjectForKeyedSubscript
     = clangContext.Selectors.getSelector(2, setObjectForKeyedSubscriptIdents);
 
-  // Set up the imported header module.
-  auto *importedHeaderModule = Module::create(ctx.getIdentifier("__ObjC"), ctx);
-  importer->Impl.ImportedHeaderUnit =
-    new (ctx) ClangModuleUnit(*importedHeaderModule, *importer, nullptr);
-  importedHeaderModule->addFile(*importer->Impl.ImportedHeaderUnit);
+  return false;
+}
 
-  return importer;
+void ClangImporter::ensureInitialized() const {
+  if (Impl.IsInitialized)
+    return;
+  if (const_cast<ClangImporter *>(this)->finishInitialization())
+    llvm::report_fatal_error("could not initialize the Clang importer");
 }
 
 bool ClangImporter::addSearchPath(StringRef newSearchPath, bool isFramework) {
+  // The new path is already in the ASTContext's search paths, which are all
+  // added when Clang is initialized.
+  if (!Impl.IsInitialized)
+    return false;
+
   clang::FileManager &fileMgr = Impl.Instance->getFileManager();
   const clang::DirectoryEntry *entry = fileMgr.getDirectory(newSearchPath);
   if (!entry)
@@ -1030,6 +1059,7 @@ bool ClangImporter::Implementation::importHeader(
 bool ClangImporter::importHeader(StringRef header, Module *adapter,
                                  off_t expectedSize, time_t expectedModTime,
                                  StringRef cachedContents, SourceLoc diagLoc) {
+  ensureInitialized();
   clang::FileManager &fileManager = Impl.Instance->getFileManager();
   const clang::FileEntry *headerFile = fileManager.getFile(header,
                                                            /*open=*/true);
@@ -1050,6 +1080,7 @@ bool ClangImporter::importHeader(StringRef header, Module *adapter,
 bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
                                          SourceLoc diagLoc,
                                          bool trackParsedSymbols) {
+  ensureInitialized();
   clang::FileManager &fileManager = Impl.Instance->getFileManager();
   const clang::FileEntry *headerFile = fileManager.getFile(header,
                                                            /*open=*/true);
@@ -1075,6 +1106,7 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
 std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
                                                      off_t &fileSize,
                                                      time_t &fileModTime) {
+  ensureInitialized();
   llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
     new clang::CompilerInvocation(*Impl.Invocation)
   };
@@ -1122,6 +1154,7 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
 void ClangImporter::collectSubModuleNames(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::string> &names) {
+  ensureInitialized();
   auto &clangHeaderSearch = Impl.getClangPreprocessor().getHeaderSearchInfo();
 
   // Look up the top-level module first.
@@ -1150,6 +1183,7 @@ bool ClangImporter::isModuleImported(const clang::Module *M) {
 Module *ClangImporter::loadModule(
     SourceLoc importLoc,
     ArrayRef<std::pair<Identifier, SourceLoc>> path) {
+  ensureInitialized();
   auto &clangContext = Impl.getClangASTContext();
   auto &clangHeaderSearch = Impl.getClangPreprocessor().getHeaderSearchInfo();
 
@@ -1841,6 +1875,10 @@ public:
 void ClangImporter::lookupBridgingHeaderDecls(
                               llvm::function_ref<bool(ClangNode)> filter,
                               llvm::function_ref<void(Decl*)> receiver) const {
+  // Nothing has been parsed if Clang hasn't been initialized yet.
+  if (!Impl.IsInitialized)
+    return;
+
   for (auto &Import : Impl.BridgeHeaderTopLevelImports) {
     auto ImportD = Import.get<ImportDecl*>();
     if (filter(ImportD->getClangDecl()))
@@ -1955,6 +1993,9 @@ bool ClangImporter::lookupDeclsFromHeader(StringRef Filename,
 }
 
 void ClangImporter::lookupValue(DeclName name, VisibleDeclConsumer &consumer){
+  if (!Impl.IsInitialized)
+    return;
+
   Impl.forEachLookupTable([&](SwiftLookupTable &table) -> bool {
       Impl.lookupValue(table, name, consumer);
       return false;
@@ -2153,6 +2194,10 @@ static bool isVisibleClangEntry(clang::ASTContext &ctx,
 
 void ClangImporter::loadExtensions(NominalTypeDecl *nominal,
                                    unsigned previousGeneration) {
+  // Until Clang is initialized, no Clang module can extend anything.
+  if (!Impl.IsInitialized)
+    return;
+
   // Determine the effective Clang context for this Swift nominal type.
   auto effectiveClangContext = Impl.getEffectiveClangContext(nominal);
   if (!effectiveClangContext) return;
@@ -2361,10 +2406,12 @@ clang::TargetInfo &ClangImporter::getTargetInfo() const {
 }
 
 clang::ASTContext &ClangImporter::getClangASTContext() const {
+  ensureInitialized();
   return Impl.getClangASTContext();
 }
 
 clang::Preprocessor &ClangImporter::getClangPreprocessor() const {
+  ensureInitialized();
   return Impl.getClangPreprocessor();
 }
 const clang::Module *ClangImporter::getClangOwningModule(ClangNode Node) const {
@@ -2376,6 +2423,7 @@ bool ClangImporter::hasTypedef(const clang::Decl *typeDecl) const {
 }
 
 clang::Sema &ClangImporter::getClangSema() const {
+  ensureInitialized();
   return Impl.getClangSema();
 }
 
@@ -2392,7 +2440,20 @@ Decl *ClangImporter::importDeclCached(const clang::NamedDecl *ClangDecl) {
 }
 
 void ClangImporter::printStatistics() const {
+  if (!Impl.IsInitialized)
+    return;
   Impl.Instance->getModuleManager()->PrintStats();
+
+  if (auto &nameImporter = Impl.nameImporter) {
+    unsigned hits = nameImporter->getNumCacheHits();
+    unsigned lookups = hits + nameImporter->getNumCacheMisses();
+    llvm::errs() << "*** Swift name import statistics:\n"
+                 << "  " << lookups << " name lookups, " << hits
+                 << " cache hits";
+    if (lookups)
+      llvm::errs() << " (" << (uint64_t(hits) * 100 / lookups) << "%)";
+    llvm::errs() << "\n";
+  }
 }
 
 void ClangImporter::verifyAllModules() {
@@ -7288,6 +7288,94 @@ ClangImporter::Implementation::loadAllMembers(Decl *D, uint64_t extra) {
 
 }
 
+Optional<TinyPtrVector<ValueDecl *>>
+ClangImporter::Implementation::loadNamedMembers(const IterableDeclContext *IDC,
+                                                Identifier N, uint64_t unused) {
+  const Decl *D;
+  DeclContext *DC;
+  if (auto nominal = dyn_cast<NominalTypeDecl>(IDC)) {
+    D = nominal;
+    DC = const_cast<NominalTypeDecl *>(nominal);
+  } else {
+    auto ext = cast<ExtensionDecl>(IDC);
+    D = ext;
+    DC = const_cast<ExtensionDecl *>(ext);
+  }
+
+  // Globals-as-members are only loaded all at once.
+  auto objcContainer =
+    dyn_cast_or_null<clang::ObjCContainerDecl>(D->getClangDecl());
+  if (!objcContainer)
+    return None;
+
+  // Mirrored protocol members can have any name, and inherited initializers
+  // are synthesized from the superclass; leave both to loadAllMembers.
+  auto knownProtos = ImportedProtocols.find(D);
+  if (knownProtos != ImportedProtocols.end() && !knownProtos->second.empty())
+    return None;
+  if (auto clangClass = dyn_cast<clang::ObjCInterfaceDecl>(objcContainer)) {
+    if (N == SwiftContext.Id_init)
+      return None;
+    objcContainer = clangClass->getDefinition();
+  } else if (auto clangProto
+               = dyn_cast<clang::ObjCProtocolDecl>(objcContainer)) {
+    objcContainer = clangProto->getDefinition();
+  }
+  if (!objcContainer)
+    return None;
+
+  auto submodule = getClangSubmoduleForDecl(objcContainer);
+  if (!submodule)
+    return None;
+  auto table = findLookupTable(*submodule);
+  if (!table)
+    return None;
+
+  clang::PrettyStackTraceDecl trace(objcContainer, clang::SourceLocation(),
+                                    Instance->getSourceManager(),
+                                    "loading named members for");
+
+  ImportingEntityRAII Importing(*this);
+
+  // The lookup table records each member under both its Swift 3 and Swift 2
+  // names, so this finds exactly what importObjCMembers would import under
+  // this base name.
+  TinyPtrVector<ValueDecl *> results;
+  llvm::SmallPtrSet<Decl *, 4> knownMembers;
+  auto addResult = [&](Decl *member) {
+    if (auto VD = dyn_cast<ValueDecl>(member))
+      if (knownMembers.insert(VD).second)
+        results.push_back(VD);
+  };
+
+  for (auto entry : table->lookup(N.str(), objcContainer)) {
+    auto nd = entry.dyn_cast<clang::NamedDecl *>();
+    if (!nd || nd != nd->getCanonicalDecl() ||
+        nd->getDeclContext() != objcContainer)
+      continue;
+
+    for (bool useSwift2Name : {false, true}) {
+      auto member = importDecl(nd, useSwift2Name);
+      if (!member)
+        continue;
+
+      if (auto objcMethod = dyn_cast<clang::ObjCMethodDecl>(nd)) {
+        if (auto alternate = getAlternateDecl(member))
+          if (alternate->getDeclContext() == member->getDeclContext())
+            addResult(alternate);
+
+        if (shouldSuppressDeclImport(objcMethod))
+          continue;
+      }
+
+      if (member->getDeclContext() == DC)
+        addResult(member);
+    }
+  }
+
+  return results;
+}
+
 void ClangImporter::Implementation::loadAllConformances(
        const Decl *D, uint64_t contextData,
        SmallVectorImpl<ProtocolConformance *> &Conformances) {
@@ -1603,6 +1603,12 @@ static bool shouldIgnoreMacro(StringRef name, const clang::MacroInfo *macro) {
   if (macro->isFunctionLike())
     return true;
 
+  // Longer expansions than any form the importer recognizes can never be
+  // imported. Skipping them here keeps them out of the lookup tables, so
+  // they are never deserialized or re-examined on lookup.
+  if (macro->getNumTokens() > MaxImportableMacroTokens)
+    return true;
+
   // Consult the blacklist of macros to suppress.
   auto suppressMacro = llvm::StringSwitch<bool>(name)
 #define SUPPRESS_MACRO(NAME) .Case(#NAME, true)
@@ -1636,12 +1642,15 @@ Identifier importer::importMacroName(
 ImportedName NameImporter::importName(const clang::NamedDecl *decl,
                                       ImportNameOptions options) {
   CacheKeyType key(decl, options.toRaw());
-  if (importNameCache.count(key)) {
+  auto known = importNameCache.find(key);
+  if (known != importNameCache.end()) {
     ++ImportNameNumCacheHits;
-    return importNameCache[key];
+    ++numCacheHits;
+    return known->second;
   }
   ++ImportNameNumCacheMisses;
+  ++numCacheMisses;
   auto res = importNameImpl(decl, options);
-  importNameCache[key] = res;
+  importNameCache.insert({key, res});
   return res;
 }
@@ -137,6 +137,11 @@ struct ImportedName {
 /// in "Notification", or it there would be nothing left.
 StringRef stripNotification(StringRef name);
 
+/// The most tokens a macro can have and still be imported: one layer of
+/// parentheses, a type cast, and a five-token expansion such as `(void*)0`.
+/// See importMacro.
+const unsigned MaxImportableMacroTokens = 2 + 3 + 5;
+
 /// Imports the name of the given Clang macro into Swift.
 Identifier importMacroName(const clang::IdentifierInfo *clangIdentifier,
                            const clang::MacroInfo *macro,
@@ -176,6 +181,10 @@ class NameImporter {
   /// Cache for repeated calls
   llvm::DenseMap<CacheKeyType, ImportedName> importNameCache;
 
+  /// Hits and misses in \c importNameCache, reported by -print-clang-stats.
+  unsigned numCacheHits = 0;
+  unsigned numCacheMisses = 0;
+
 public:
   NameImporter(ASTContext &ctx, const PlatformAvailability &avail,
                clang::Sema &cSema, bool inferIAM)
@@ -205,6 +214,9 @@ public:
     return enumInfos.getEnumKind(decl);
   }
 
+  unsigned getNumCacheHits() const { return numCacheHits; }
+  unsigned getNumCacheMisses() const { return numCacheMisses; }
+
   clang::Sema &getClangSema() { return clangSema; }
   clang::ASTContext &getClangContext() { return getClangSema().getASTContext(); }
 
@@ -310,6 +310,11 @@ private:
   /// \brief Clang parser, which is used to load textual headers.
   std::unique_ptr<clang::Parser> Parser;
 
+  /// \brief Whether the Clang preprocessor, Sema and parser have been set up.
+  ///
+  /// \sa ClangImporterOptions::LazyInitialization
+  bool IsInitialized = false;
+
   /// \brief Clang parser, which is used to load textual headers.
   std::unique_ptr<clang::MangleContext> Mangler;
 
@@ -521,8 +526,11 @@ private:
 
   struct ImportingEntityRAII {
     Implementation &Impl;
+    ASTAllocationSourceRAII AllocationSource;
 
-    ImportingEntityRAII(Implementation &Impl) : Impl(Impl) {
+    ImportingEntityRAII(Implementation &Impl)
+        : Impl(Impl),
+          AllocationSource(Impl.SwiftContext, ASTAllocationSource::Imported) {
       Impl.startedImportingEntity();
     }
     ~ImportingEntityRAII() {
@@ -1083,6 +1091,10 @@ public:
   virtual void
   loadAllMembers(Decl *D, uint64_t unused) override;
 
+  virtual Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier N,
+                   uint64_t unused) override;
+
   void
   loadAllConformances(
     const Decl *D, uint64_t contextData,
@@ -1094,6 +1106,7 @@ public:
     assert(ClangN);
     void *DeclPtr = allocateMemoryForDecl<DeclTy>(SwiftContext, sizeof(DeclTy),
                                                   true);
+    SwiftContext.recordASTAllocation(ASTAllocationKind::Decl, sizeof(DeclTy));
     auto D = ::new (DeclPtr) DeclTy(std::forward<Targs>(Args)...);
     D->setClangNode(ClangN);
     D->setEarlyAttrValidation(true);
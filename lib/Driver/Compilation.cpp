@@ -17,13 +17,16 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Program.h"
 #include "swift/Basic/TaskQueue.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/Basic/Version.h"
 #include "swift/Basic/type_traits.h"
 #include "swift/Driver/Action.h"
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
+#include "swift/Driver/OutputCache.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Strings.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -88,6 +91,47 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// Compile jobs that are ready to run but have not yet been packaged into
+    /// a batch. Only used in batch mode.
+    SmallVector<const Job *, 16> PendingBatchableCommands;
+
+    /// Compile jobs which are still running, but have already written their
+    /// partial module. Merge-module jobs don't need to wait for these.
+    CommandSet EmittedModuleCommands;
+
+    /// Jobs whose outputs were restored from the output cache, and which
+    /// should be treated as having finished successfully.
+    SmallVector<const Job *, 16> RestoredCommands;
+
+    /// Jobs synthesized to run several compile jobs in one frontend process.
+    ///
+    /// These are not part of the Compilation's job list; they only live as
+    /// long as the jobs are being performed.
+    SmallVector<std::unique_ptr<const Job>, 4> BatchJobs;
+
+    /// A map from each batch job to the compile jobs it performs.
+    llvm::SmallDenseMap<const Job *, SmallVector<const Job *, 8>, 4>
+        BatchConstituents;
+
+    /// The time at which each task started executing.
+    llvm::SmallDenseMap<const Job *, llvm::sys::TimeValue, 16> TaskStartTimes;
+
+    /// How long each job that finished successfully took to run. Jobs
+    /// performed as part of a batch share the batch's time evenly.
+    llvm::SmallDenseMap<const Job *, llvm::sys::TimeValue, 16>
+        CommandDurations;
+
+    /// The total CPU time of the tasks that reported their resource usage,
+    /// and the largest peak memory of any of them.
+    TaskResourceUsage TotalUsage;
+
+    /// The number of tasks that reported their resource usage.
+    unsigned NumTasksWithUsage = 0;
+
+    /// When writing a trace, the time at which each task started, in
+    /// microseconds since the epoch.
+    llvm::SmallDenseMap<const Job *, uint64_t, 16> TraceStartTimes;
   };
 }
 
@@ -100,9 +144,11 @@ Job *Compilation::addJob(std::unique_ptr<Job> J) {
 }
 
 static const Job *findUnfinishedJob(ArrayRef<const Job *> JL,
-                                    const CommandSet &FinishedCommands) {
+                                    const CommandSet &FinishedCommands,
+                                    const CommandSet *ReadyCommands = nullptr) {
   for (const Job *Cmd : JL) {
-    if (!FinishedCommands.count(Cmd))
+    if (!FinishedCommands.count(Cmd) &&
+        !(ReadyCommands && ReadyCommands->count(Cmd)))
       return Cmd;
   }
   return nullptr;
@@ -111,6 +157,18 @@ static const Job *findUnfinishedJob(ArrayRef<const Job *> JL,
 using InputInfoMap =
   llvm::SmallMapVector<const llvm::opt::Arg *, CompileJobAction::InputInfo, 16>;
 
+/// Returns how long \p Cmd took to run in this build, or, if it didn't run,
+/// how long it took in the previous one.
+static llvm::sys::TimeValue getLatestDuration(const Job *Cmd,
+                                              const PerformJobsState &State) {
+  auto iter = State.CommandDurations.find(Cmd);
+  if (iter != State.CommandDurations.end())
+    return iter->second;
+  if (auto *compileAction = dyn_cast<CompileJobAction>(&Cmd->getSource()))
+    return compileAction->getInputInfo().previousDuration;
+  return llvm::sys::TimeValue::ZeroTime();
+}
+
 static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
@@ -122,6 +180,7 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       info.status = entry.second ?
           CompileJobAction::InputInfo::NeedsCascadingBuild :
           CompileJobAction::InputInfo::NeedsNonCascadingBuild;
+      info.previousDuration = getLatestDuration(entry.first, endState);
       inputs[&inputFile->getInputArg()] = info;
     }
   }
@@ -137,6 +196,7 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
       info.status = CompileJobAction::InputInfo::UpToDate;
+      info.previousDuration = getLatestDuration(entry, endState);
       inputs[&inputFile->getInputArg()] = info;
     }
   }
@@ -219,6 +279,19 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  bool wroteDurationsKey = false;
+  for (auto &entry : inputs) {
+    if (entry.second.previousDuration == llvm::sys::TimeValue::ZeroTime())
+      continue;
+    if (!wroteDurationsKey) {
+      out << compilation_record::getName(TopLevelKey::Durations) << ":\n";
+      wroteDurationsKey = true;
+    }
+    out << "  \"" << llvm::yaml::escape(entry.first->getValue()) << "\": ";
+    writeTimeValue(out, entry.second.previousDuration);
+    out << "\n";
+  }
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -258,13 +331,164 @@ static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
   return true;
 }
 
+/// Returns true if \p Cmd can be run as part of a batch, i.e. it is a
+/// single-primary-file invocation of the frontend.
+static bool isBatchableJob(const Job *Cmd) {
+  if (!isa<CompileJobAction>(Cmd->getSource()))
+    return false;
+  if (!Cmd->getExtraEnvironment().empty())
+    return false;
+  const llvm::opt::ArgStringList &Args = Cmd->getArguments();
+  return !Args.empty() && StringRef(Args.front()) == "-frontend";
+}
+
+/// Writes the frontend arguments of \p Cmd to \p path, one per line, in the
+/// form expected by the frontend's -batch-invocation option.
+static bool writeBatchInvocationFile(StringRef path, const Job *Cmd,
+                                     DiagnosticEngine &diags) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    out.clear_error();
+    diags.diagnose(SourceLoc(), diag::error_unable_to_make_temporary_file,
+                   error.message());
+    return false;
+  }
+
+  // Skip the leading "-frontend"; the batch job supplies it once.
+  // FIXME: Arguments containing newlines can't be represented.
+  for (const char *Arg : llvm::makeArrayRef(Cmd->getArguments()).slice(1))
+    out << Arg << "\n";
+  return true;
+}
+
+/// Creates a job that performs all of \p Constituents in a single frontend
+/// process, or returns null if the invocation files could not be written.
+static std::unique_ptr<const Job>
+makeBatchJob(Compilation &C, DiagnosticEngine &diags,
+             ArrayRef<const Job *> Constituents) {
+  assert(Constituents.size() > 1 && "not worth batching");
+  const Job *First = Constituents.front();
+
+  llvm::opt::ArgStringList Arguments;
+  Arguments.push_back("-frontend");
+  std::unique_ptr<CommandOutput> Output(
+      new CommandOutput(First->getOutput().getPrimaryOutputType()));
+
+  for (const Job *Cmd : Constituents) {
+    assert(Cmd->getExecutable() == First->getExecutable() &&
+           "batched jobs must run the same frontend");
+    SmallString<128> Path;
+    std::error_code EC =
+        llvm::sys::fs::createTemporaryFile("batch-invocation", "", Path);
+    if (EC) {
+      diags.diagnose(SourceLoc(), diag::error_unable_to_make_temporary_file,
+                     EC.message());
+      return nullptr;
+    }
+    C.addTemporaryFile(Path);
+    if (!writeBatchInvocationFile(Path, Cmd, diags))
+      return nullptr;
+
+    Arguments.push_back("-batch-invocation");
+    Arguments.push_back(C.getArgs().MakeArgString(Path));
+
+    const CommandOutput &CmdOutput = Cmd->getOutput();
+    ArrayRef<std::string> Outputs = CmdOutput.getPrimaryOutputFilenames();
+    for (size_t i = 0, e = Outputs.size(); i != e; ++i)
+      Output->addPrimaryOutput(Outputs[i], CmdOutput.getBaseInput(i));
+  }
+
+  SmallVector<const Job *, 4> Inputs;
+  return std::unique_ptr<const Job>(
+      new Job(First->getSource(), std::move(Inputs),
+              std::move(Output), First->getExecutable(),
+              std::move(Arguments)));
+}
+
+/// Returns \p Jobs sorted so that the ones expected to take longest come
+/// first, which keeps a long job from starting last and holding up the
+/// whole build.
+///
+/// A compile job's cost is the time it took in the previous build, if known.
+/// Otherwise it's estimated from the size of its primary input, converted to
+/// time using the rate observed for the jobs whose durations are known. Jobs
+/// that aren't compile jobs keep their relative order at the end; they
+/// usually depend on the compile jobs anyway.
+static SmallVector<const Job *, 16>
+sortJobsLongestFirst(ArrayRef<const Job *> Jobs) {
+  struct JobCost {
+    const Job *Cmd;
+    uint64_t DurationMicros;
+    uint64_t InputSize;
+    double Cost;
+  };
+  SmallVector<JobCost, 16> Costs;
+
+  uint64_t TotalKnownMicros = 0;
+  uint64_t TotalKnownSize = 0;
+  for (const Job *Cmd : Jobs) {
+    JobCost Entry = { Cmd, 0, 0, 0.0 };
+    if (auto *Compile = dyn_cast<CompileJobAction>(&Cmd->getSource())) {
+      Entry.DurationMicros =
+          Compile->getInputInfo().previousDuration.toMicroSeconds();
+      for (const Action *A : Compile->getInputs()) {
+        uint64_t Size;
+        if (auto *IA = dyn_cast<InputAction>(A))
+          if (!llvm::sys::fs::file_size(IA->getInputArg().getValue(), Size))
+            Entry.InputSize += Size;
+      }
+      if (Entry.DurationMicros != 0 && Entry.InputSize != 0) {
+        TotalKnownMicros += Entry.DurationMicros;
+        TotalKnownSize += Entry.InputSize;
+      }
+    }
+    Costs.push_back(Entry);
+  }
+
+  double MicrosPerByte = 1.0;
+  if (TotalKnownSize != 0)
+    MicrosPerByte = double(TotalKnownMicros) / double(TotalKnownSize);
+
+  for (JobCost &Entry : Costs) {
+    if (Entry.DurationMicros != 0)
+      Entry.Cost = double(Entry.DurationMicros);
+    else
+      Entry.Cost = double(Entry.InputSize) * MicrosPerByte;
+  }
+
+  std::stable_sort(Costs.begin(), Costs.end(),
+                   [](const JobCost &LHS, const JobCost &RHS) {
+    return LHS.Cost > RHS.Cost;
+  });
+
+  SmallVector<const Job *, 16> Result;
+  for (const JobCost &Entry : Costs)
+    Result.push_back(Entry.Cmd);
+  return Result;
+}
+
 int Compilation::performJobsImpl() {
+  llvm::sys::TimeValue ExecutionStartTime = llvm::sys::TimeValue::now();
+
+  uint64_t TraceStartTime = 0;
+  if (!TraceOutputPath.empty()) {
+    trace::enable();
+    TraceStartTime = trace::now();
+  }
+
   // Create a TaskQueue for execution.
   std::unique_ptr<TaskQueue> TQ;
   if (SkipTaskExecution)
     TQ.reset(new DummyTaskQueue(NumberOfParallelCommands));
   else
     TQ.reset(new TaskQueue(NumberOfParallelCommands));
+  TQ->setAdaptsToSystemLoad(getAdaptiveSchedulingEnabled());
+  TQ->setCompileServerPath(getCompileServerPath());
+
+  std::unique_ptr<OutputCache> Cache;
+  if (!OutputCachePath.empty() && !SkipTaskExecution)
+    Cache.reset(new OutputCache(OutputCachePath));
 
   PerformJobsState State;
 
@@ -299,8 +523,15 @@ int Compilation::performJobsImpl() {
     if (State.ScheduledCommands.count(Cmd))
       return;
 
+    // A merge-module job only needs its inputs' partial modules, which
+    // compile jobs may report before they finish.
+    const CommandSet *ReadyCommands = nullptr;
+    if (isa<MergeModuleJobAction>(Cmd->getSource()))
+      ReadyCommands = &State.EmittedModuleCommands;
+
     if (auto Blocking = findUnfinishedJob(Cmd->getInputs(),
-                                          State.FinishedCommands)) {
+                                          State.FinishedCommands,
+                                          ReadyCommands)) {
       State.BlockingCommands[Blocking].push_back(Cmd);
       return;
     }
@@ -313,15 +544,117 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
+
+    // A job whose outputs can be taken from the cache doesn't need to run.
+    if (Cache && Cache->restore(*Cmd)) {
+      State.RestoredCommands.push_back(Cmd);
+      return;
+    }
+
+    // In batch mode, hold on to compile jobs until we know how many of them
+    // are ready to run together.
+    if (getBatchModeEnabled() && isBatchableJob(Cmd)) {
+      State.PendingBatchableCommands.push_back(Cmd);
+      return;
+    }
+
     TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
                 (void *)Cmd);
   };
 
+  // Partition the pending compile jobs into one batch per parallel job slot
+  // and hand the batches to the TaskQueue.
+  //
+  // Batches are contiguous runs of the pending jobs, which are in input
+  // order, so that each frontend tends to see related files together.
+  auto formBatchJobsAndAddPendingJobsToTaskQueue = [&] {
+    auto &Pending = State.PendingBatchableCommands;
+    if (Pending.empty())
+      return;
+
+    size_t NumBatches =
+        std::min<size_t>(std::max(NumberOfParallelCommands, 1U),
+                         Pending.size());
+    size_t Start = 0;
+    for (size_t i = 0; i != NumBatches; ++i) {
+      size_t Size = Pending.size() / NumBatches +
+                    (i < Pending.size() % NumBatches ? 1 : 0);
+      ArrayRef<const Job *> Batch =
+          llvm::makeArrayRef(Pending).slice(Start, Size);
+      Start += Size;
+
+      std::unique_ptr<const Job> BatchJob;
+      if (Batch.size() > 1)
+        BatchJob = makeBatchJob(*this, Diags, Batch);
+      if (!BatchJob) {
+        for (const Job *Cmd : Batch)
+          TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                      (void *)Cmd);
+        continue;
+      }
+
+      const Job *BJ = BatchJob.get();
+      State.BatchConstituents[BJ].append(Batch.begin(), Batch.end());
+      State.BatchJobs.push_back(std::move(BatchJob));
+      TQ->addTask(BJ->getExecutable(), BJ->getArguments(), llvm::None,
+                  (void *)BJ);
+    }
+    Pending.clear();
+  };
+
+  // Returns the jobs performed by the task for \p Cmd: either the
+  // constituents of a batch, or just \p Cmd itself.
+  auto getPerformedCommands =
+      [&](const Job * const &Cmd) -> ArrayRef<const Job *> {
+    auto BatchIter = State.BatchConstituents.find(Cmd);
+    if (BatchIter != State.BatchConstituents.end())
+      return BatchIter->second;
+    return Cmd;
+  };
+
+  // Records a span for the task for \p Cmd, which has just finished, and adds
+  // the traces that the frontend wrote for each job it performed.
+  auto traceFinishedTask = [&](ProcessId Pid, const Job *Cmd) {
+    auto StartIter = State.TraceStartTimes.find(Cmd);
+    if (StartIter == State.TraceStartTimes.end())
+      return;
+
+    std::string Inputs;
+    llvm::raw_string_ostream OS(Inputs);
+    for (const Job *PerformedCmd : getPerformedCommands(Cmd)) {
+      for (auto A : PerformedCmd->getSource().getInputs()) {
+        if (const InputAction *IA = dyn_cast<InputAction>(A)) {
+          if (!OS.str().empty())
+            OS << " ";
+          OS << IA->getInputArg().getValue();
+        }
+      }
+    }
+    OS.flush();
+
+    // The span goes on a thread of the task's own process, so that it's
+    // shown above the spans the frontend recorded.
+    trace::addSpan("driver", Cmd->getSource().getClassName(), Inputs,
+                   StartIter->second, trace::now() - StartIter->second, Pid,
+                   /*Tid=*/0);
+
+    for (const Job *PerformedCmd : getPerformedCommands(Cmd)) {
+      const llvm::opt::ArgStringList &Args = PerformedCmd->getArguments();
+      auto TraceArg = std::find_if(Args.begin(), Args.end(),
+                                   [](const char *Arg) {
+        return StringRef(Arg) == "-trace-output";
+      });
+      // A frontend that crashed may not have written its trace.
+      if (TraceArg != Args.end() && std::next(TraceArg) != Args.end())
+        (void)trace::addEventsFromFile(*std::next(TraceArg));
+    }
+  };
+
   // When a task finishes, we need to reevaluate the other commands that
   // might have been blocked.
-  auto markFinished = [&] (const Job *Cmd) {
-    State.FinishedCommands.insert(Cmd);
-
+  // Reevaluate the commands which were blocked on \p Cmd. Any which still
+  // can't run will block themselves again.
+  auto rescheduleCommandsBlockedOn = [&] (const Job *Cmd) {
     auto BlockedIter = State.BlockingCommands.find(Cmd);
     if (BlockedIter != State.BlockingCommands.end()) {
       auto AllBlocked = std::move(BlockedIter->second);
@@ -331,8 +664,18 @@ int Compilation::performJobsImpl() {
     }
   };
 
-  // Schedule all jobs we can.
-  for (const Job *Cmd : getJobs()) {
+  auto markFinished = [&] (const Job *Cmd) {
+    State.FinishedCommands.insert(Cmd);
+    rescheduleCommandsBlockedOn(Cmd);
+  };
+
+  // Schedule all jobs we can. The TaskQueue starts tasks in the order they're
+  // added, so in adaptive mode add the longest ones first.
+  SmallVector<const Job *, 16> InitialJobs(getJobs().begin(),
+                                           getJobs().end());
+  if (getAdaptiveSchedulingEnabled())
+    InitialJobs = sortJobsLongestFirst(InitialJobs);
+  for (const Job *Cmd : InitialJobs) {
     if (!getIncrementalBuildEnabled()) {
       scheduleCommandIfNecessaryAndPossible(Cmd);
       continue;
@@ -407,6 +750,20 @@ int Compilation::performJobsImpl() {
         if (depStatus.getLastModificationTime() < LastBuildTime)
           continue;
 
+      // A module built with -emit-module-summary only updates its summary
+      // when its interface changes, so a newer module with an older summary
+      // only has new function bodies, which don't affect its clients.
+      if (llvm::sys::path::extension(dependency) ==
+            "." + std::string(SERIALIZED_MODULE_EXTENSION)) {
+        llvm::SmallString<128> summaryPath(dependency);
+        llvm::sys::path::replace_extension(summaryPath,
+                                           SERIALIZED_MODULE_SUMMARY_EXTENSION);
+        llvm::sys::fs::file_status summaryStatus;
+        if (!llvm::sys::fs::status(summaryPath, summaryStatus) &&
+            summaryStatus.getLastModificationTime() < LastBuildTime)
+          continue;
+      }
+
       // If the dependency has been modified since the oldest built file,
       // or if we can't stat it for some reason (perhaps it's been deleted?),
       // trigger rebuilds through the dependency graph.
@@ -437,23 +794,28 @@ int Compilation::performJobsImpl() {
   auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    State.TaskStartTimes[BeganCmd] = llvm::sys::TimeValue::now();
+    if (trace::isEnabled())
+      State.TraceStartTimes[BeganCmd] = trace::now();
 
     if (ShowDriverTimeCompilation) {
       llvm::SmallString<128> TimerName;
       llvm::raw_svector_ostream OS(TimerName);
 
       OS << BeganCmd->getSource().getClassName();
-      for (auto A : BeganCmd->getSource().getInputs()) {
-        if (const InputAction *IA = dyn_cast<InputAction>(A)) {
-          OS << " " << IA->getInputArg().getValue();
-        }
-      }
-      for (auto J : BeganCmd->getInputs()) {
-        for (auto A : J->getSource().getInputs()) {
+      for (const Job *Cmd : getPerformedCommands(BeganCmd)) {
+        for (auto A : Cmd->getSource().getInputs()) {
           if (const InputAction *IA = dyn_cast<InputAction>(A)) {
             OS << " " << IA->getInputArg().getValue();
           }
         }
+        for (auto J : Cmd->getInputs()) {
+          for (auto A : J->getSource().getInputs()) {
+            if (const InputAction *IA = dyn_cast<InputAction>(A)) {
+              OS << " " << IA->getInputArg().getValue();
+            }
+          }
+        }
       }
 
       DriverTimers.insert({
@@ -465,10 +827,14 @@ int Compilation::performJobsImpl() {
     }
 
     // For verbose output, print out each command as it begins execution.
-    if (Level == OutputLevel::Verbose)
+    // Parseable output describes each job in a batch separately, since
+    // consumers care about the individual inputs and outputs.
+    if (Level == OutputLevel::Verbose) {
       BeganCmd->printCommandLine(llvm::errs());
-    else if (Level == OutputLevel::Parseable)
-      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
+    } else if (Level == OutputLevel::Parseable) {
+      for (const Job *Cmd : getPerformedCommands(BeganCmd))
+        parseable_output::emitBeganMessage(llvm::errs(), *Cmd, Pid);
+    }
   };
 
   // Set up a callback which will be called immediately after a task has
@@ -476,25 +842,8 @@ int Compilation::performJobsImpl() {
   // continue (if execution should stop, this callback should return true), and
   // it should also schedule any additional commands which we now know need
   // to run.
-  auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
-                           void *Context) -> TaskFinishedResponse {
-    const Job *FinishedCmd = (const Job *)Context;
-
-    if (ShowDriverTimeCompilation) {
-      DriverTimers[FinishedCmd]->stopTimer();
-    }
-
-    if (Level == OutputLevel::Parseable) {
-      // Parseable output was requested.
-      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
-                                            ReturnCode, Output);
-    } else {
-      // Otherwise, send the buffered output to stderr, though only if we
-      // support getting buffered output.
-      if (TaskQueue::supportsBufferingOutput())
-        llvm::errs() << Output;
-    }
-
+  auto commandFinished = [&] (const Job *FinishedCmd,
+                              int ReturnCode) -> TaskFinishedResponse {
     // In order to handle both old dependencies that have disappeared and new
     // dependencies that have arisen, we need to reload the dependency file.
     // Do this whether or not the build succeeded.
@@ -607,6 +956,102 @@ int Compilation::performJobsImpl() {
     return TaskFinishedResponse::ContinueExecution;
   };
 
+  auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
+                           Optional<TaskResourceUsage> Usage,
+                           void *Context) -> TaskFinishedResponse {
+    const Job *FinishedCmd = (const Job *)Context;
+
+    if (ShowDriverTimeCompilation) {
+      DriverTimers[FinishedCmd]->stopTimer();
+    }
+
+    ArrayRef<const Job *> PerformedCmds = getPerformedCommands(FinishedCmd);
+    auto StartIter = State.TaskStartTimes.find(FinishedCmd);
+    if (ReturnCode == EXIT_SUCCESS && StartIter != State.TaskStartTimes.end()) {
+      uint64_t Micros =
+          (llvm::sys::TimeValue::now() - StartIter->second).toMicroSeconds() /
+          PerformedCmds.size();
+      llvm::sys::TimeValue Share(Micros / 1000000, (Micros % 1000000) * 1000);
+      for (const Job *Cmd : PerformedCmds)
+        State.CommandDurations[Cmd] = Share;
+    }
+
+    if (trace::isEnabled())
+      traceFinishedTask(Pid, FinishedCmd);
+
+    // Like its duration, a batch's time is shared evenly between its jobs,
+    // but each of them is reported with the batch's peak memory.
+    Optional<TaskResourceUsage> CmdUsage;
+    if (Usage) {
+      ++State.NumTasksWithUsage;
+      State.TotalUsage.UserTimeMicros += Usage->UserTimeMicros;
+      State.TotalUsage.SystemTimeMicros += Usage->SystemTimeMicros;
+      State.TotalUsage.MaxResidentBytes =
+          std::max(State.TotalUsage.MaxResidentBytes, Usage->MaxResidentBytes);
+
+      CmdUsage = *Usage;
+      CmdUsage->WallTimeMicros /= PerformedCmds.size();
+      CmdUsage->UserTimeMicros /= PerformedCmds.size();
+      CmdUsage->SystemTimeMicros /= PerformedCmds.size();
+    }
+
+    // A batch reports a single exit status for all of its jobs, so each of
+    // them is treated as having finished with it. The task's output is only
+    // attributed to the first job, to avoid printing it more than once.
+    auto Response = TaskFinishedResponse::ContinueExecution;
+    for (const Job *Cmd : PerformedCmds) {
+      if (Level == OutputLevel::Parseable) {
+        // Parseable output was requested.
+        parseable_output::emitFinishedMessage(llvm::errs(), *Cmd, Pid,
+                                              ReturnCode, Output, CmdUsage);
+      } else {
+        // Otherwise, send the buffered output to stderr, though only if we
+        // support getting buffered output.
+        if (TaskQueue::supportsBufferingOutput())
+          llvm::errs() << Output;
+      }
+      Output = StringRef();
+
+      if (Cache && ReturnCode == EXIT_SUCCESS && OutputCache::isCacheable(*Cmd))
+        Cache->store(*Cmd);
+
+      if (commandFinished(Cmd, ReturnCode) ==
+          TaskFinishedResponse::StopExecution)
+        Response = TaskFinishedResponse::StopExecution;
+    }
+    return Response;
+  };
+
+  // Handle a progress message from a running task. The only one so far says
+  // that a compile job (or one of the jobs in a batch) has written its
+  // partial module, which lets a merge-module job start early.
+  auto taskProgress = [&] (ProcessId Pid, StringRef Message, void *Context) {
+    StringRef Kind, ModulePath;
+    std::tie(Kind, ModulePath) = Message.split(' ');
+    if (Kind != "emitted-module")
+      return;
+
+    for (const Job *Cmd : getPerformedCommands((const Job *)Context)) {
+      if (Cmd->getOutput().getAnyOutputForType(types::TY_SwiftModuleFile) !=
+          ModulePath)
+        continue;
+      State.EmittedModuleCommands.insert(Cmd);
+      rescheduleCommandsBlockedOn(Cmd);
+    }
+  };
+
+  // Finish the jobs whose outputs were restored from the cache, as if they
+  // had run. Parseable output reports them as skipped, since no process was
+  // started for them.
+  auto finishRestoredCommands = [&] {
+    while (Result == EXIT_SUCCESS && !State.RestoredCommands.empty()) {
+      const Job *Cmd = State.RestoredCommands.pop_back_val();
+      if (Level == OutputLevel::Parseable)
+        parseable_output::emitSkippedMessage(llvm::errs(), *Cmd);
+      commandFinished(Cmd, EXIT_SUCCESS);
+    }
+  };
+
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
@@ -617,8 +1062,11 @@ int Compilation::performJobsImpl() {
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
-      parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
-                                             ErrorMsg, Output);
+      for (const Job *Cmd : getPerformedCommands(SignalledCmd)) {
+        parseable_output::emitSignalledMessage(llvm::errs(), *Cmd, Pid,
+                                               ErrorMsg, Output);
+        Output = StringRef();
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -640,8 +1088,21 @@ int Compilation::performJobsImpl() {
   };
 
   do {
+    finishRestoredCommands();
+
+    // Package up any compile jobs that became ready since the last round.
+    // Jobs discovered while the queue is running wait for the next round, so
+    // that they can be batched together.
+    formBatchJobsAndAddPendingJobsToTaskQueue();
+
     // Ask the TaskQueue to execute.
-    TQ->execute(taskBegan, taskFinished, taskSignalled);
+    TQ->execute(taskBegan, taskFinished, taskSignalled, taskProgress);
+
+    // Compile jobs still waiting to be batched may discover more dependents,
+    // so don't give up on the deferred commands yet.
+    if (!State.PendingBatchableCommands.empty() ||
+        !State.RestoredCommands.empty())
+      continue;
 
     // Mark all remaining deferred commands as skipped.
     for (const Job *Cmd : DeferredCommands) {
@@ -656,7 +1117,9 @@ int Compilation::performJobsImpl() {
     }
 
     // ...which may allow us to go on and do later tasks.
-  } while (Result == 0 && TQ->hasRemainingTasks());
+  } while (Result == 0 && (TQ->hasRemainingTasks() ||
+                           !State.PendingBatchableCommands.empty() ||
+                           !State.RestoredCommands.empty()));
 
   if (Result == 0) {
     assert(State.BlockingCommands.empty() &&
@@ -683,6 +1146,22 @@ int Compilation::performJobsImpl() {
     }
   }
 
+  if (Level == OutputLevel::Parseable && State.NumTasksWithUsage != 0) {
+    State.TotalUsage.WallTimeMicros =
+        (llvm::sys::TimeValue::now() - ExecutionStartTime).toMicroSeconds();
+    parseable_output::emitSummaryMessage(llvm::errs(), State.NumTasksWithUsage,
+                                         State.TotalUsage);
+  }
+
+  if (!TraceOutputPath.empty()) {
+    trace::addSpan("driver", "compilation", StringRef(), TraceStartTime,
+                   trace::now() - TraceStartTime);
+    std::string ErrorMsg;
+    if (trace::writeEvents(TraceOutputPath, ErrorMsg))
+      Diags.diagnose(SourceLoc(), diag::error_opening_output, TraceOutputPath,
+                     ErrorMsg);
+  }
+
   if (!CompilationRecordPath.empty() && !SkipTaskExecution) {
     InputInfoMap InputInfo;
     populateInputInfoMap(InputInfo, State);
@@ -765,6 +1244,7 @@ int Compilation::performJobs() {
   // If we don't have to do any cleanup work, just exec the subprocess.
   if (Level < OutputLevel::Parseable &&
       !ShowDriverTimeCompilation &&
+      TraceOutputPath.empty() &&
       (SaveTemps || TempFilePaths.empty()) &&
       CompilationRecordPath.empty() &&
       Jobs.size() == 1) {
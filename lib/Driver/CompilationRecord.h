@@ -34,6 +34,9 @@ enum class TopLevelKey {
   /// The key for the list of inputs to the compilation that produced the
   /// compilation record.
   Inputs,
+  /// The key for the time each input's compile job took to run, used to
+  /// schedule long-running jobs first in the next build.
+  Durations,
 };
 
 /// \returns A string representation of the given key.
@@ -43,6 +46,7 @@ inline static StringRef getName(TopLevelKey Key) {
   case TopLevelKey::Options: return "options";
   case TopLevelKey::BuildTime: return "build_time";
   case TopLevelKey::Inputs: return "inputs";
+  case TopLevelKey::Durations: return "durations";
   }
 }
 
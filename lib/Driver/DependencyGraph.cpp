@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Driver/DependencyGraph.h"
+#include "swift/Basic/BinarySwiftDeps.h"
 #include "swift/Basic/DemangleWrappers.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
@@ -47,15 +48,105 @@ DependencyGraphImpl::MarkTracerImpl::~MarkTracerImpl() = default;
 using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
+using ProvidesCallbackTy = LoadResult(StringRef, DependencyKind, StringRef);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
 
+/// Reads a dependency file in the format described in BinarySwiftDeps.h.
+///
+/// Names are handed to the callbacks directly from \p buffer, with no
+/// copying except for member entries.
+static LoadResult
+parseBinaryDependencyFile(llvm::MemoryBuffer &buffer,
+                          llvm::function_ref<ProvidesCallbackTy> providesCallback,
+                          llvm::function_ref<DependencyCallbackTy> dependsCallback,
+                          llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+  using binary_swiftdeps::EntryKind;
+
+  LoadResult result = LoadResult::UpToDate;
+  SmallString<64> appended;
+
+  auto handleEntry = [&](const binary_swiftdeps::Entry &entry) -> bool {
+    LoadResult update;
+    switch (entry.Kind) {
+    case EntryKind::ProvidesTopLevel:
+      update = providesCallback(entry.Name, DependencyKind::TopLevelName,
+                                entry.Fingerprint);
+      break;
+    case EntryKind::ProvidesNominal:
+      update = providesCallback(entry.Name, DependencyKind::NominalType,
+                                entry.Fingerprint);
+      break;
+    case EntryKind::ProvidesDynamicLookup:
+      update = providesCallback(entry.Name, DependencyKind::DynamicLookupName,
+                                entry.Fingerprint);
+      break;
+    case EntryKind::DependsTopLevel:
+      update = dependsCallback(entry.Name, DependencyKind::TopLevelName,
+                               entry.IsCascading);
+      break;
+    case EntryKind::DependsNominal:
+      update = dependsCallback(entry.Name, DependencyKind::NominalType,
+                               entry.IsCascading);
+      break;
+    case EntryKind::DependsDynamicLookup:
+      update = dependsCallback(entry.Name, DependencyKind::DynamicLookupName,
+                               entry.IsCascading);
+      break;
+    case EntryKind::DependsExternal:
+      update = dependsCallback(entry.Name, DependencyKind::ExternalFile,
+                               entry.IsCascading);
+      break;
+    case EntryKind::ProvidesMember:
+    case EntryKind::DependsMember: {
+      // Smash the type and member names together, as for the YAML format.
+      appended = entry.Name;
+      appended.push_back('\0');
+      appended += entry.Member;
+      if (entry.Kind == EntryKind::ProvidesMember)
+        update = providesCallback(appended.str(),
+                                  DependencyKind::NominalTypeMember,
+                                  entry.Fingerprint);
+      else
+        update = dependsCallback(appended.str(),
+                                 DependencyKind::NominalTypeMember,
+                                 entry.IsCascading);
+      break;
+    }
+    case EntryKind::InterfaceHash:
+      update = interfaceHashCallback(entry.Name);
+      break;
+    case EntryKind::Fingerprint:
+      llvm_unreachable("folded into the preceding entry");
+    }
+
+    switch (update) {
+    case LoadResult::HadError:
+      return true;
+    case LoadResult::UpToDate:
+      break;
+    case LoadResult::AffectsDownstream:
+      result = LoadResult::AffectsDownstream;
+      break;
+    }
+    return false;
+  };
+
+  if (binary_swiftdeps::read(buffer.getBuffer(), handleEntry))
+    return LoadResult::HadError;
+  return result;
+}
+
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
-                    llvm::function_ref<DependencyCallbackTy> providesCallback,
+                    llvm::function_ref<ProvidesCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
                     llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
   namespace yaml = llvm::yaml;
 
+  if (binary_swiftdeps::hasSignature(buffer.getBuffer()))
+    return parseBinaryDependencyFile(buffer, providesCallback, dependsCallback,
+                                     interfaceHashCallback);
+
   // FIXME: Switch to a format other than YAML.
   llvm::SourceMgr SM;
   yaml::Stream stream(buffer.getMemBufferRef(), SM);
@@ -149,9 +240,13 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       if (!entries)
         return LoadResult::HadError;
 
+      bool isDepends = dirAndKind.second == DependencyDirection::Depends;
+      SmallString<32> fingerprintScratch;
+
       if (dirAndKind.first == DependencyKind::NominalTypeMember) {
         // Handle member dependencies specially. Rather than being a single
         // string, they come in the form ["{MangledBaseName}", "memberName"].
+        // Provided members may have a fingerprint as a third element.
         for (yaml::Node &rawEntry : *entries) {
           bool isCascading = rawEntry.getRawTag() != "!private";
 
@@ -170,13 +265,19 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
             return LoadResult::HadError;
           ++iter;
 
+          StringRef fingerprint;
+          if (!isDepends && iter != entry->end()) {
+            auto *rawFingerprint = dyn_cast<yaml::ScalarNode>(&*iter);
+            if (!rawFingerprint)
+              return LoadResult::HadError;
+            fingerprint = rawFingerprint->getValue(fingerprintScratch);
+            ++iter;
+          }
+
           // FIXME: LLVM's YAML support doesn't implement == correctly for end
           // iterators.
           assert(!(iter != entry->end()));
 
-          bool isDepends = dirAndKind.second == DependencyDirection::Depends;
-          auto &callback = isDepends ? dependsCallback : providesCallback;
-
           // Smash the type and member names together so we can continue using
           // StringMap.
           SmallString<64> appended;
@@ -184,20 +285,55 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
           appended.push_back('\0');
           appended += member->getValue(scratch);
 
-          UPDATE_RESULT(callback(appended.str(), dirAndKind.first,
-                                 isCascading));
+          if (isDepends) {
+            UPDATE_RESULT(dependsCallback(appended.str(), dirAndKind.first,
+                                          isCascading));
+          } else {
+            UPDATE_RESULT(providesCallback(appended.str(), dirAndKind.first,
+                                           fingerprint));
+          }
         }
-      } else {
+      } else if (isDepends) {
         for (const yaml::Node &rawEntry : *entries) {
           auto *entry = dyn_cast<yaml::ScalarNode>(&rawEntry);
           if (!entry)
             return LoadResult::HadError;
 
-          bool isDepends = dirAndKind.second == DependencyDirection::Depends;
-          auto &callback = isDepends ? dependsCallback : providesCallback;
+          UPDATE_RESULT(dependsCallback(entry->getValue(scratch),
+                                        dirAndKind.first,
+                                        entry->getRawTag() != "!private"));
+        }
+      } else {
+        // Provided names are either a single string or a pair of the name and
+        // its fingerprint.
+        for (yaml::Node &rawEntry : *entries) {
+          StringRef name, fingerprint;
+          if (auto *entry = dyn_cast<yaml::ScalarNode>(&rawEntry)) {
+            name = entry->getValue(scratch);
+          } else if (auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry)) {
+            auto iter = entry->begin();
+            auto *rawName = dyn_cast<yaml::ScalarNode>(&*iter);
+            if (!rawName)
+              return LoadResult::HadError;
+            ++iter;
+
+            auto *rawFingerprint = dyn_cast<yaml::ScalarNode>(&*iter);
+            if (!rawFingerprint)
+              return LoadResult::HadError;
+            ++iter;
+
+            // FIXME: LLVM's YAML support doesn't implement == correctly for
+            // end iterators.
+            assert(!(iter != entry->end()));
+
+            name = rawName->getValue(scratch);
+            fingerprint = rawFingerprint->getValue(fingerprintScratch);
+          } else {
+            return LoadResult::HadError;
+          }
 
-          UPDATE_RESULT(callback(entry->getValue(scratch), dirAndKind.first,
-                                 entry->getRawTag() != "!private"));
+          UPDATE_RESULT(providesCallback(name, dirAndKind.first,
+                                         fingerprint));
         }
       }
     }
@@ -207,7 +343,10 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
 }
 
 LoadResult DependencyGraphImpl::loadFromPath(const void *node, StringRef path) {
-  auto buffer = llvm::MemoryBuffer::getFile(path);
+  // Neither format needs a null terminator, which makes it more likely that
+  // the file is memory-mapped rather than read.
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!buffer)
     return LoadResult::HadError;
   return loadFromBuffer(node, *buffer.get());
@@ -223,8 +362,14 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
   auto &provides = Provides[node];
 
-  auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
-                                      bool isCascading) -> LoadResult {
+  // The fingerprints of everything provided by this version of the file. A
+  // name provided more than once gets the concatenation of its fingerprints,
+  // or an empty one if any of its entries lacks a fingerprint.
+  llvm::StringMap<std::string> newFingerprints;
+  bool dependsAffectDownstream = false;
+
+  auto dependsCallback = [this, node, &dependsAffectDownstream](
+      StringRef name, DependencyKind kind, bool isCascading) -> LoadResult {
     if (kind == DependencyKind::ExternalFile)
       ExternalDependencies.insert(name);
 
@@ -245,15 +390,25 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
       iter->flags |= flags;
     }
 
-    if (isCascading && (entries.second & kind))
+    if (isCascading && (entries.second & kind)) {
+      dependsAffectDownstream = true;
       return LoadResult::AffectsDownstream;
+    }
     return LoadResult::UpToDate;
   };
 
   auto providesCallback =
-      [this, node, &provides](StringRef name, DependencyKind kind,
-                              bool isCascading) -> LoadResult {
-    assert(isCascading);
+      [&provides, &newFingerprints](StringRef name, DependencyKind kind,
+                                    StringRef fingerprint) -> LoadResult {
+    auto inserted = newFingerprints.insert({name, fingerprint});
+    if (!inserted.second) {
+      std::string &combined = inserted.first->getValue();
+      if (combined.empty() || fingerprint.empty())
+        combined.clear();
+      else
+        combined += fingerprint;
+    }
+
     auto iter = std::find_if(provides.begin(), provides.end(),
                              [name](const ProvidesEntryTy &entry) -> bool {
       return name == entry.name;
@@ -285,8 +440,36 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback);
+  if (result == LoadResult::HadError)
+    return result;
+
+  // Work out which of the node's entries changed since it was last loaded.
+  // Entries that disappeared, are new, or lack a fingerprint on either side
+  // count as changed.
+  auto &changed = ChangedProvides[node];
+  changed.clear();
+  for (auto &entry : provides) {
+    auto newIter = newFingerprints.find(entry.name);
+    if (newIter == newFingerprints.end()) {
+      changed.insert(entry.name);
+      entry.fingerprint.clear();
+      continue;
+    }
+    const std::string &newFingerprint = newIter->getValue();
+    if (newFingerprint.empty() || entry.fingerprint != newFingerprint)
+      changed.insert(entry.name);
+    entry.fingerprint = newFingerprint;
+  }
+
+  // If the node now depends on something that has already changed, its own
+  // entries may be affected in ways the fingerprints don't show.
+  if (dependsAffectDownstream)
+    ChangedProvides.erase(node);
+
+  return result;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -321,6 +504,12 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallVector<WorklistEntry, 16> worklist;
   SmallPtrSet<const void *, 16> visitedSet;
 
+  // Only follow the starting node's entries that actually changed, if known.
+  const llvm::StringSet<> *changedProvides = nullptr;
+  auto changedIter = ChangedProvides.find(node);
+  if (changedIter != ChangedProvides.end())
+    changedProvides = &changedIter->second;
+
   auto addDependentsToWorklist = [&](const void *next,
                                      ArrayRef<MarkTracerImpl::Entry> reason) {
     auto allProvided = Provides.find(next);
@@ -328,6 +517,10 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       return;
 
     for (const auto &provided : allProvided->second) {
+      if (next == node && changedProvides &&
+          !changedProvides->count(provided.name))
+        continue;
+
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
@@ -55,6 +55,7 @@
 #include "CompilationRecord.h"
 
 #include <memory>
+#include <thread>
 
 using namespace swift;
 using namespace swift::driver;
@@ -218,6 +219,7 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
   SmallString<64> scratch;
 
   llvm::StringMap<InputInfo> previousInputs;
+  llvm::StringMap<llvm::sys::TimeValue> previousDurations;
   bool versionValid = false;
   bool optionsMatch = true;
 
@@ -322,6 +324,23 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr == compilation_record::getName(TopLevelKey::Durations)) {
+      auto *durationMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!durationMap)
+        return true;
+
+      for (auto i = durationMap->begin(), e = durationMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        if (!key)
+          return true;
+
+        llvm::sys::TimeValue duration;
+        if (readTimeValue(i->getValue(), duration))
+          return true;
+
+        previousDurations[key->getValue(scratch)] = duration;
+      }
     }
   }
 
@@ -336,7 +355,11 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
       continue;
     }
     ++numInputsFromPrevious;
-    map[inputPair.second] = iter->getValue();
+    InputInfo info = iter->getValue();
+    auto durationIter = previousDurations.find(inputPair.second->getValue());
+    if (durationIter != previousDurations.end())
+      info.previousDuration = durationIter->getValue();
+    map[inputPair.second] = info;
   }
 
   // If a file was removed, we've lost its dependency info. Rebuild everything.
@@ -489,6 +512,10 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
                      A->getAsString(*ArgList), A->getValue());
       return nullptr;
     }
+  } else if (ArgList->hasArg(options::OPT_enable_adaptive_job_scheduling)) {
+    // Without an explicit -j, let the scheduler use every core that's free.
+    NumberOfParallelCommands =
+        std::max(std::thread::hardware_concurrency(), 1U);
   }
 
   OutputLevel Level = OutputLevel::Normal;
@@ -526,6 +553,25 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
 
+  // Batching only applies to jobs that compile a single primary file.
+  if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      C->getArgs().hasFlag(options::OPT_enable_batch_mode,
+                           options::OPT_disable_batch_mode,
+                           /*default=*/false))
+    C->setBatchModeEnabled();
+
+  if (C->getArgs().hasArg(options::OPT_enable_adaptive_job_scheduling))
+    C->setAdaptiveSchedulingEnabled();
+
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_compile_server))
+    C->setCompileServerPath(A->getValue());
+
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_output_cache_path))
+    C->setOutputCachePath(A->getValue());
+
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_trace_output))
+    C->setTraceOutputPath(A->getValue());
+
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
   if (rebuildEverything)
@@ -1083,6 +1129,7 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
                         [&OI](sys::ProcessId PID,
                               int returnCode,
                               StringRef output,
+                              Optional<sys::TaskResourceUsage> usage,
                               void *unused) -> sys::TaskFinishedResponse {
             if (returnCode == 0) {
               output = output.rtrim();
@@ -1199,6 +1246,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_Image:
       case types::TY_dSYM:
       case types::TY_Dependencies:
+      case types::TY_SwiftModuleSummaryFile:
       case types::TY_Assembly:
       case types::TY_LLVM_IR:
       case types::TY_LLVM_BC:
@@ -1818,6 +1866,31 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
     }
   }
 
+  // Choose the swiftsummary output path. Only the final module needs one.
+  if (OI.ShouldGenerateModule &&
+      C.getArgs().hasArg(options::OPT_emit_module_summary) &&
+      (isa<MergeModuleJobAction>(JA) ||
+       (isa<CompileJobAction>(JA) &&
+        OI.CompilerMode == OutputInfo::Mode::SingleCompile))) {
+    StringRef OFMModuleSummaryOutputPath;
+    if (OutputMap) {
+      auto iter = OutputMap->find(types::TY_SwiftModuleSummaryFile);
+      if (iter != OutputMap->end())
+        OFMModuleSummaryOutputPath = iter->second;
+    }
+    if (!OFMModuleSummaryOutputPath.empty()) {
+      Output->setAdditionalOutputForType(types::TY_SwiftModuleSummaryFile,
+                                         OFMModuleSummaryOutputPath);
+    } else {
+      llvm::SmallString<128> Path(
+          Output->getAnyOutputForType(types::TY_SwiftModuleFile));
+      llvm::sys::path::replace_extension(Path,
+                                         SERIALIZED_MODULE_SUMMARY_EXTENSION);
+      Output->setAdditionalOutputForType(types::TY_SwiftModuleSummaryFile,
+                                         Path);
+    }
+  }
+
   if (OI.ShouldGenerateFixitEdits && isa<CompileJobAction>(JA)) {
     StringRef OFMFixitsOutputPath;
     if (OutputMap) {
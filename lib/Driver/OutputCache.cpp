@@ -0,0 +1,299 @@
+//===--- OutputCache.cpp - Reuse the outputs of earlier jobs --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/OutputCache.h"
+
+#include "swift/Basic/Version.h"
+#include "swift/Driver/Action.h"
+#include "swift/Driver/DependencyGraph.h"
+#include "swift/Driver/Job.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <tuple>
+
+using namespace swift;
+using namespace swift::driver;
+
+// Layout of an entry, in a directory named by the job's key:
+//
+//   deps:          one "<hash> <path>" line per external dependency
+//   <n>-<type>:    the job's n'th output, of the given type
+//
+// Entries are written under a temporary name and renamed into place, so that
+// several builds can share a cache directory.
+static const char CacheVersion[] = "swift-output-cache-1";
+static const char DepsFileName[] = "deps";
+
+typedef std::pair<types::ID, StringRef> OutputPair;
+
+static void getOutputs(const Job &Cmd, SmallVectorImpl<OutputPair> &Outputs) {
+  const CommandOutput &Output = Cmd.getOutput();
+  for (const std::string &Path : Output.getPrimaryOutputFilenames())
+    Outputs.push_back({Output.getPrimaryOutputType(), Path});
+  types::forAllTypes([&](types::ID Ty) {
+    StringRef Path = Output.getAdditionalOutputForType(Ty);
+    if (!Path.empty())
+      Outputs.push_back({Ty, Path});
+  });
+}
+
+static void getEntryFileName(const Twine &EntryDir, size_t Index,
+                             types::ID Ty, SmallVectorImpl<char> &Result) {
+  Result.clear();
+  llvm::sys::path::append(Result, EntryDir,
+                          Twine(Index) + "-" + types::getTypeName(Ty));
+}
+
+/// Copies \p From to \p To. Returns true on error.
+static bool copyFile(const Twine &From, const Twine &To) {
+  auto Buffer = llvm::MemoryBuffer::getFile(From, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return true;
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(To.str(), EC, llvm::sys::fs::F_None);
+  if (EC)
+    return true;
+  OS << Buffer.get()->getBuffer();
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    return true;
+  }
+  return false;
+}
+
+/// Removes the entry in \p EntryDir, which contains only plain files.
+static void removeEntry(StringRef EntryDir) {
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(EntryDir, EC), E; I != E && !EC;
+       I.increment(EC))
+    llvm::sys::fs::remove(I->path());
+  llvm::sys::fs::remove(EntryDir);
+}
+
+OutputCache::OutputCache(StringRef Dir) : Directory(Dir) {
+  SmallString<128> AbsoluteDir(Dir);
+  if (!llvm::sys::fs::make_absolute(AbsoluteDir))
+    Directory = AbsoluteDir.str();
+}
+
+bool OutputCache::isCacheable(const Job &Cmd) {
+  if (!isa<CompileJobAction>(Cmd.getSource()))
+    return false;
+  // The contents of a filelist aren't known until just before the job runs.
+  if (!Cmd.getFilelistInfo().path.empty())
+    return false;
+  return !Cmd.getOutput().getAdditionalOutputForType(types::TY_SwiftDeps)
+              .empty();
+}
+
+StringRef OutputCache::getFileHash(StringRef Path) {
+  auto Inserted = FileHashes.insert({Path, std::string()});
+  std::string &Result = Inserted.first->getValue();
+  if (!Inserted.second)
+    return Result;
+
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return Result;
+
+  llvm::MD5 Hash;
+  Hash.update(Buffer.get()->getBuffer());
+  llvm::MD5::MD5Result HashBuf;
+  Hash.final(HashBuf);
+  SmallString<32> HashString;
+  llvm::MD5::stringifyResult(HashBuf, HashString);
+  Result = HashString.str();
+  return Result;
+}
+
+StringRef OutputCache::getKey(const Job &Cmd) {
+  auto Inserted = Keys.insert({&Cmd, std::string()});
+  std::string &Result = Inserted.first->second;
+  if (!Inserted.second || !isCacheable(Cmd))
+    return Result;
+
+  SmallVector<OutputPair, 8> Outputs;
+  getOutputs(Cmd, Outputs);
+
+  llvm::MD5 Hash;
+  auto addString = [&Hash](StringRef S) {
+    Hash.update(S);
+    Hash.update(StringRef("\0", 1));
+  };
+
+  addString(CacheVersion);
+  addString(version::getSwiftFullVersion(
+      version::Version::getCurrentLanguageVersion()));
+
+  // A development compiler can change without its version changing, so
+  // identify the executable by its size and modification time as well.
+  addString(Cmd.getExecutable());
+  llvm::sys::fs::file_status ExecStatus;
+  if (llvm::sys::fs::status(Cmd.getExecutable(), ExecStatus))
+    return Result;
+  addString(llvm::utostr(ExecStatus.getSize()));
+  addString(llvm::utostr(ExecStatus.getLastModificationTime().toEpochTime()));
+
+  // Outputs are named by type rather than by path, so that the same job in
+  // another build tree has the same key. Any other argument that names a
+  // file contributes the file's contents.
+  for (StringRef Arg : Cmd.getArguments()) {
+    auto Found = std::find_if(Outputs.begin(), Outputs.end(),
+                              [Arg](const OutputPair &Output) {
+      return Output.second == Arg;
+    });
+    if (Found != Outputs.end()) {
+      addString("<output>");
+      addString(types::getTypeName(Found->first));
+      continue;
+    }
+
+    addString(Arg);
+    if (llvm::sys::fs::is_regular_file(Arg)) {
+      StringRef FileHash = getFileHash(Arg);
+      if (FileHash.empty())
+        return Result;
+      addString(FileHash);
+    }
+  }
+
+  llvm::MD5::MD5Result HashBuf;
+  Hash.final(HashBuf);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(HashBuf, Key);
+  Result = Key.str();
+  return Result;
+}
+
+bool OutputCache::restore(const Job &Cmd) {
+  StringRef Key = getKey(Cmd);
+  if (Key.empty())
+    return false;
+
+  SmallString<128> EntryDir(Directory);
+  llvm::sys::path::append(EntryDir, Key);
+
+  SmallString<128> DepsPath(EntryDir);
+  llvm::sys::path::append(DepsPath, DepsFileName);
+  auto DepsBuffer = llvm::MemoryBuffer::getFile(DepsPath);
+  if (!DepsBuffer)
+    return false;
+
+  SmallVector<StringRef, 16> Lines;
+  DepsBuffer.get()->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                      /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    StringRef ExpectedHash, Path;
+    std::tie(ExpectedHash, Path) = Line.split(' ');
+    if (Path.empty() || getFileHash(Path) != ExpectedHash)
+      return false;
+  }
+
+  SmallVector<OutputPair, 8> Outputs;
+  getOutputs(Cmd, Outputs);
+  SmallString<128> CachedPath;
+  for (size_t i = 0, e = Outputs.size(); i != e; ++i) {
+    getEntryFileName(EntryDir, i, Outputs[i].first, CachedPath);
+    if (copyFile(CachedPath, Outputs[i].second))
+      return false;
+  }
+  return true;
+}
+
+void OutputCache::store(const Job &Cmd) {
+  StringRef Key = getKey(Cmd);
+  if (Key.empty())
+    return;
+
+  SmallString<128> EntryDir(Directory);
+  llvm::sys::path::append(EntryDir, Key);
+
+  // Find out which modules the job depended on from its dependencies file.
+  const CommandOutput &Output = Cmd.getOutput();
+  DependencyGraph<const Job *> Graph;
+  if (Graph.loadFromPath(&Cmd,
+                         Output.getAdditionalOutputForType(types::TY_SwiftDeps))
+      == DependencyGraphImpl::LoadResult::HadError)
+    return;
+
+  std::string Deps;
+  llvm::raw_string_ostream DepsOS(Deps);
+  for (StringRef Dep : Graph.getExternalDependencies()) {
+    StringRef DepHash = getFileHash(Dep);
+    if (DepHash.empty())
+      return;
+    DepsOS << DepHash << " " << Dep << "\n";
+  }
+  DepsOS.flush();
+
+  if (llvm::sys::fs::create_directories(Directory))
+    return;
+  SmallString<128> TempDir;
+  if (llvm::sys::fs::createUniqueDirectory(EntryDir, TempDir))
+    return;
+
+  SmallVector<std::string, 8> WrittenFiles;
+  auto cleanUp = [&] {
+    for (const std::string &Path : WrittenFiles)
+      llvm::sys::fs::remove(Path);
+    llvm::sys::fs::remove(TempDir);
+  };
+
+  SmallVector<OutputPair, 8> Outputs;
+  getOutputs(Cmd, Outputs);
+  SmallString<128> CachedPath;
+  for (size_t i = 0, e = Outputs.size(); i != e; ++i) {
+    getEntryFileName(TempDir, i, Outputs[i].first, CachedPath);
+    WrittenFiles.push_back(CachedPath.str());
+    if (copyFile(Outputs[i].second, CachedPath)) {
+      cleanUp();
+      return;
+    }
+  }
+
+  SmallString<128> DepsPath(TempDir);
+  llvm::sys::path::append(DepsPath, DepsFileName);
+  WrittenFiles.push_back(DepsPath.str());
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(DepsPath, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      cleanUp();
+      return;
+    }
+    OS << Deps;
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      cleanUp();
+      return;
+    }
+  }
+
+  // An existing entry was made when some external dependency was different,
+  // or the job wouldn't have run, so replace it.
+  if (llvm::sys::fs::exists(EntryDir))
+    removeEntry(EntryDir);
+  if (llvm::sys::fs::rename(TempDir, EntryDir))
+    cleanUp();
+}
@@ -61,6 +61,16 @@ namespace json {
     }
   };
 
+  template<>
+  struct ObjectTraits<sys::TaskResourceUsage> {
+    static void mapping(Output &out, sys::TaskResourceUsage &value) {
+      out.mapRequired("wall-time-us", value.WallTimeMicros);
+      out.mapRequired("user-time-us", value.UserTimeMicros);
+      out.mapRequired("system-time-us", value.SystemTimeMicros);
+      out.mapRequired("max-rss-bytes", value.MaxResidentBytes);
+    }
+  };
+
   template<typename T, unsigned N>
   struct ArrayTraits<SmallVector<T, N>> {
     static size_t size(Output &out, SmallVector<T, N> &seq) {
@@ -187,15 +197,17 @@ public:
 
 class FinishedMessage : public TaskOutputMessage {
   int ExitStatus;
+  Optional<sys::TaskResourceUsage> Usage;
 public:
   FinishedMessage(const Job &Cmd, ProcessId Pid, StringRef Output,
-                  int ExitStatus) : TaskOutputMessage("finished", Cmd, Pid,
-                                                      Output),
-                                    ExitStatus(ExitStatus) {}
+                  int ExitStatus, Optional<sys::TaskResourceUsage> Usage)
+      : TaskOutputMessage("finished", Cmd, Pid, Output),
+        ExitStatus(ExitStatus), Usage(Usage) {}
 
   virtual void provideMapping(swift::json::Output &out) {
     TaskOutputMessage::provideMapping(out);
     out.mapRequired("exit-status", ExitStatus);
+    out.mapOptional("usage", Usage);
   }
 };
 
@@ -219,6 +231,20 @@ public:
       DetailedCommandBasedMessage("skipped", Cmd) {}
 };
 
+class SummaryMessage : public Message {
+  unsigned JobCount;
+  sys::TaskResourceUsage Usage;
+public:
+  SummaryMessage(unsigned JobCount, const sys::TaskResourceUsage &Usage) :
+      Message("summary", "compilation"), JobCount(JobCount), Usage(Usage) {}
+
+  virtual void provideMapping(swift::json::Output &out) {
+    Message::provideMapping(out);
+    out.mapRequired("job-count", JobCount);
+    out.mapRequired("usage", Usage);
+  }
+};
+
 }
 
 namespace swift {
@@ -252,8 +278,9 @@ void parseable_output::emitBeganMessage(raw_ostream &os,
 
 void parseable_output::emitFinishedMessage(raw_ostream &os,
                                            const Job &Cmd, ProcessId Pid,
-                                           int ExitStatus, StringRef Output) {
-  FinishedMessage msg(Cmd, Pid, Output, ExitStatus);
+                                           int ExitStatus, StringRef Output,
+                                           Optional<TaskResourceUsage> Usage) {
+  FinishedMessage msg(Cmd, Pid, Output, ExitStatus, Usage);
   emitMessage(os, msg);
 }
 
@@ -269,3 +296,9 @@ void parseable_output::emitSkippedMessage(raw_ostream &os, const Job &Cmd) {
   SkippedMessage msg(Cmd);
   emitMessage(os, msg);
 }
+
+void parseable_output::emitSummaryMessage(raw_ostream &os, unsigned JobCount,
+                                          const TaskResourceUsage &Usage) {
+  SummaryMessage msg(JobCount, Usage);
+  emitMessage(os, msg);
+}
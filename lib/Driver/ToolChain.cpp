@@ -21,6 +21,7 @@
 #include "swift/Driver/Compilation.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
+#include "swift/Option/Options.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
@@ -97,6 +98,16 @@ ToolChain::constructJob(const JobAction &JA,
   const char *executablePath = nullptr;
   if (StringRef(SWIFT_EXECUTABLE_NAME) == invocationInfo.ExecutableName) {
     executablePath = getDriver().getSwiftProgramPath().c_str();
+
+    // If the driver is writing a trace, have each frontend job write its own
+    // to a temporary file, for the Compilation to merge into the driver's.
+    // Interpreting and the REPL replace the driver, so they don't need one.
+    if (C.getArgs().hasArg(options::OPT_trace_output) &&
+        !isa<InterpretJobAction>(JA) && !isa<REPLJobAction>(JA)) {
+      invocationInfo.Arguments.push_back("-trace-output");
+      invocationInfo.Arguments.push_back(
+          context.getTemporaryFilePath("trace", "json"));
+    }
   } else {
     std::string relativePath =
         findProgramRelativeToSwift(invocationInfo.ExecutableName);
@@ -127,8 +127,10 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
   inputArgs.AddLastArg(arguments, options::OPT_resource_dir);
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
   inputArgs.AddLastArg(arguments, options::OPT_suppress_warnings);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use_EQ);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
   inputArgs.AddLastArg(arguments, options::OPT_warnings_as_errors);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_EQ);
@@ -152,6 +154,13 @@ static void addCommonFrontendArgs(const ToolChain &TC,
     arguments.push_back(moduleDocOutputPath.c_str());
   }
 
+  const std::string &moduleSummaryOutputPath =
+      output.getAdditionalOutputForType(types::TY_SwiftModuleSummaryFile);
+  if (!moduleSummaryOutputPath.empty()) {
+    arguments.push_back("-emit-module-summary-path");
+    arguments.push_back(moduleSummaryOutputPath.c_str());
+  }
+
   if (llvm::sys::Process::StandardErrHasColors())
     arguments.push_back("-color-diagnostics");
 }
@@ -215,6 +224,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_AutolinkFile:
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
+    case types::TY_SwiftModuleSummaryFile:
     case types::TY_ClangModuleFile:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
@@ -318,6 +328,13 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   if (!ModuleOutputPath.empty()) {
     Arguments.push_back("-emit-module-path");
     Arguments.push_back(ModuleOutputPath.c_str());
+
+    // Progress messages are mixed into the job's output, so only ask for
+    // them if the driver will be able to pick them out.
+    if (context.OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+        context.Args.hasArg(options::OPT_enable_pipelined_merge_modules) &&
+        sys::TaskQueue::supportsBufferingOutput())
+      Arguments.push_back("-report-emitted-module");
   }
 
   const std::string &ObjCHeaderOutputPath =
@@ -350,6 +367,10 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   if (!ReferenceDependenciesPath.empty()) {
     Arguments.push_back("-emit-reference-dependencies-path");
     Arguments.push_back(ReferenceDependenciesPath.c_str());
+    if (context.Args.hasArg(options::OPT_enable_binary_swiftdeps))
+      Arguments.push_back("-emit-binary-reference-dependencies");
+    if (context.Args.hasArg(options::OPT_enable_fine_grained_dependencies))
+      Arguments.push_back("-emit-reference-dependency-fingerprints");
   }
 
   const std::string &FixitsPath =
@@ -419,6 +440,7 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
 
   context.Args.AddAllArgs(Arguments, options::OPT_l, options::OPT_framework);
+  context.Args.AddLastArg(Arguments, options::OPT_jit_cache_path);
 
   // The immediate arguments must be last.
   context.Args.AddLastArg(Arguments, options::OPT__DASH_DASH);
@@ -472,6 +494,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_AutolinkFile:
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
+    case types::TY_SwiftModuleSummaryFile:
     case types::TY_ClangModuleFile:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
@@ -598,6 +621,11 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
   // serialized ASTs.
   Arguments.push_back("-parse-as-library");
 
+  // Most partial modules are unchanged in an incremental build; if all of
+  // them are, so is the merged module.
+  if (context.Args.hasArg(options::OPT_incremental))
+    Arguments.push_back("-skip-unchanged-module-merge");
+
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
 
@@ -775,6 +803,7 @@ static bool findXcodeClangPath(llvm::SmallVectorImpl<char> &path) {
                   [&path](sys::ProcessId PID,
                           int returnCode,
                           StringRef output,
+                          Optional<sys::TaskResourceUsage> usage,
                           void *unused) -> sys::TaskFinishedResponse {
       if (returnCode == 0) {
         output = output.rtrim();
@@ -82,6 +82,7 @@ bool types::isTextual(ID Id) {
   case types::TY_RawSIB:
   case types::TY_SwiftModuleFile:
   case types::TY_SwiftModuleDocFile:
+  case types::TY_SwiftModuleSummaryFile:
   case types::TY_LLVM_BC:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
@@ -113,6 +114,7 @@ bool types::isAfterLLVM(ID Id) {
   case types::TY_RawSIB:
   case types::TY_SwiftModuleFile:
   case types::TY_SwiftModuleDocFile:
+  case types::TY_SwiftModuleSummaryFile:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
   case types::TY_SwiftDeps:
@@ -143,6 +145,7 @@ bool types::isPartOfSwiftCompilation(ID Id) {
   case types::TY_dSYM:
   case types::TY_SwiftModuleFile:
   case types::TY_SwiftModuleDocFile:
+  case types::TY_SwiftModuleSummaryFile:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
   case types::TY_SwiftDeps:
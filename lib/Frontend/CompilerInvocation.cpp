@@ -167,13 +167,35 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  Opts.ParseNonPrimaryFunctionBodies |=
+    Args.hasArg(OPT_parse_non_primary_function_bodies);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
+  Opts.PrintASTMemoryStats |= Args.hasArg(OPT_print_ast_memory_stats);
+  Opts.PrintStartupProfile |= Args.hasArg(OPT_print_startup_profile);
+  Opts.PrintDeserializationStats |= Args.hasArg(OPT_stats_deserialization);
+  if (const Arg *A = Args.getLastArg(OPT_stats_deserialization_top_decls)) {
+    unsigned count;
+    if (StringRef(A->getValue()).getAsInteger(10, count)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+    } else {
+      Opts.NumExpensiveDeserializedDecls = count;
+    }
+  }
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
+  Opts.DebugTimeExpressionTypeChecking |=
+    Args.hasArg(OPT_debug_time_expression_type_checking);
+  Opts.DebugExpressionSolverMemory |=
+    Args.hasArg(OPT_debug_expression_solver_memory);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
+  if (const Arg *A = Args.getLastArg(OPT_trace_output))
+    Opts.TraceOutputPath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir))
+    Opts.StatsOutputDir = A->getValue();
 
   if (const Arg *A = Args.getLastArg(OPT_warn_long_function_bodies)) {
     unsigned attempt;
@@ -185,6 +207,26 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_warn_long_expression_type_checking)) {
+    unsigned attempt;
+    if (StringRef(A->getValue()).getAsInteger(10, attempt)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+    } else {
+      Opts.WarnLongExpressionTypeChecking = attempt;
+    }
+  }
+
+  if (const Arg *A = Args.getLastArg(OPT_type_check_workers)) {
+    unsigned workers;
+    if (StringRef(A->getValue()).getAsInteger(10, workers)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+    } else {
+      Opts.TypeCheckWorkers = workers;
+    }
+  }
+
   Opts.PlaygroundTransform |= Args.hasArg(OPT_playground);
   if (Args.hasArg(OPT_disable_playground_transform))
     Opts.PlaygroundTransform = false;
@@ -613,6 +655,11 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           OPT_emit_reference_dependencies,
                           OPT_emit_reference_dependencies_path,
                           "swiftdeps", false);
+  Opts.EmitBinaryReferenceDependencies |=
+      Args.hasArg(OPT_emit_binary_reference_dependencies);
+  Opts.EmitReferenceDependencyFingerprints |=
+      Args.hasArg(OPT_emit_reference_dependency_fingerprints);
+  Opts.ReportEmittedModule |= Args.hasArg(OPT_report_emitted_module);
   determineOutputFilename(Opts.SerializedDiagnosticsPath,
                           OPT_serialize_diagnostics,
                           OPT_serialize_diagnostics_path,
@@ -646,6 +693,9 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           SERIALIZED_MODULE_DOC_EXTENSION,
                           false);
 
+  if (const Arg *A = Args.getLastArg(OPT_emit_module_summary_path))
+    Opts.ModuleSummaryOutputPath = A->getValue();
+
   if (!Opts.DependenciesFilePath.empty()) {
     switch (Opts.RequestedAction) {
     case FrontendOptions::NoneAction:
@@ -701,7 +751,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   }
 
   if (!Opts.ModuleOutputPath.empty() ||
-      !Opts.ModuleDocOutputPath.empty()) {
+      !Opts.ModuleDocOutputPath.empty() ||
+      !Opts.ModuleSummaryOutputPath.empty()) {
     switch (Opts.RequestedAction) {
     case FrontendOptions::NoneAction:
     case FrontendOptions::Parse:
@@ -738,8 +789,12 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.AlwaysSerializeDebuggingOptions |=
       Args.hasArg(OPT_serialize_debugging_options);
   Opts.EnableSourceImport |= Args.hasArg(OPT_enable_source_import);
+  Opts.EnableParallelImports |= Args.hasArg(OPT_enable_parallel_imports);
   Opts.ImportUnderlyingModule |= Args.hasArg(OPT_import_underlying_module);
   Opts.SILSerializeAll |= Args.hasArg(OPT_sil_serialize_all);
+  Opts.CompressSerializedSIL |= Args.hasArg(OPT_compress_serialized_sil);
+  Opts.SkipUnchangedModuleMerge |=
+    Args.hasArg(OPT_skip_unchanged_module_merge);
 
   if (const Arg *A = Args.getLastArg(OPT_import_objc_header)) {
     Opts.ImplicitObjCHeaderPath = A->getValue();
@@ -757,6 +812,11 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     Opts.LLVMArgs.push_back(A->getValue());
   }
 
+  // Type units are only controlled by a command line option of the DWARF
+  // backend.
+  if (Args.hasArg(OPT_debug_info_type_units))
+    Opts.LLVMArgs.push_back("-generate-type-units");
+
   return false;
 }
 
@@ -811,6 +871,10 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.EnableASTScopeLookup |= Args.hasArg(OPT_enable_astscope_lookup);
+  Opts.EnableNamedLazyMemberLoading |=
+      Args.hasArg(OPT_enable_named_lazy_member_loading);
+  Opts.EnableLazyExtensionBinding |=
+      Args.hasArg(OPT_enable_lazy_extension_binding);
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
@@ -845,6 +909,17 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
 
     Opts.DebugConstraintSolverAttempt = attempt;
   }
+
+  if (const Arg *A = Args.getLastArg(OPT_debug_constraints_profile_line)) {
+    unsigned line;
+    if (StringRef(A->getValue()).getAsInteger(10, line)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.DebugConstraintSolverProfileLine = line;
+  }
   
   if (const Arg *A = Args.getLastArg(OPT_debug_forbid_typecheck_prefix)) {
     Opts.DebugForbidTypecheckPrefix = A->getValue();
@@ -932,6 +1007,7 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
 
   Opts.InferImportAsMember |= Args.hasArg(OPT_enable_infer_import_as_member);
   Opts.DumpClangDiagnostics |= Args.hasArg(OPT_dump_clang_diagnostics);
+  Opts.LazyInitialization |= Args.hasArg(OPT_lazy_clang_importer);
 
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.Mode = ClangImporterOptions::Modes::EmbedBitcode;
@@ -1063,6 +1139,10 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
     else
       llvm_unreachable("Unknown SIL linking option!");
   }
+  Opts.LinkOnDemand |= Args.hasArg(OPT_sil_link_on_demand);
+  Opts.OutlineValueOperations |= Args.hasArg(OPT_outline_value_operations);
+  Opts.OnoneCopyForwarding |= Args.hasArg(OPT_onone_copy_forwarding);
+  Opts.MergeSpecializations |= Args.hasArg(OPT_merge_specializations);
 
   // Parse the optimization level.
   if (const Arg *A = Args.getLastArg(OPT_O_Group)) {
@@ -1123,16 +1203,25 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
   Opts.DebugSerialization |= Args.hasArg(OPT_sil_debug_serialization);
   Opts.EmitVerboseSIL |= Args.hasArg(OPT_emit_verbose_sil);
   Opts.PrintInstCounts |= Args.hasArg(OPT_print_inst_counts);
+  Opts.PrintMemoryStats |= Args.hasArg(OPT_sil_memory_stats);
   if (const Arg *A = Args.getLastArg(OPT_external_pass_pipeline_filename))
     Opts.ExternalPassPipelineFilename = A->getValue();
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use_EQ))
+    Opts.UseProfile = A->getValue();
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
   Opts.DisableSILPartialApply |=
     Args.hasArg(OPT_disable_sil_partial_apply);
   Opts.EnableSILOwnership |= Args.hasArg(OPT_enable_sil_ownership);
+  if (const Arg *A = Args.getLastArg(OPT_save_optimization_record_path))
+    Opts.OptRecordFile = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_emit_specialization_requests_path))
+    Opts.SpecializationRequestsFile = A->getValue();
+  Opts.PrespecializeRequestsFiles =
+      Args.getAllArgValues(OPT_prespecialize_requests);
 
   if (Args.hasArg(OPT_debug_on_sil)) {
     // Derive the name of the SIL file for debugging from
@@ -1241,6 +1330,11 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
     Opts.Verify = false;
 
   Opts.EmitStackPromotionChecks |= Args.hasArg(OPT_stack_promotion_checks);
+  Opts.EmitStaticClassMetadata |= Args.hasArg(OPT_emit_static_class_metadata);
+  Opts.DebugTimeParallelIRGen |= Args.hasArg(OPT_debug_time_parallel_irgen);
+  Opts.DebugInfoExternalTypeDecls |=
+    Args.hasArg(OPT_debug_info_external_type_decls);
+  Opts.PrintMetadataSizeReport |= Args.hasArg(OPT_print_metadata_size_report);
   if (const Arg *A = Args.getLastArg(OPT_stack_promotion_limit)) {
     unsigned limit;
     if (StringRef(A->getValue()).getAsInteger(10, limit)) {
@@ -1269,6 +1363,9 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
 
   if (Args.hasArg(OPT_use_jit))
     Opts.UseJIT = true;
+
+  if (const Arg *A = Args.getLastArg(OPT_jit_cache_path))
+    Opts.JITCachePath = A->getValue();
   
   for (const Arg *A : make_range(Args.filtered_begin(OPT_verify_type_layout),
                                  Args.filtered_end())) {
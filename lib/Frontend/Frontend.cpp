@@ -22,6 +22,7 @@
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/Module.h"
+#include "swift/Basic/ForkedWorkers.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/DelayedParsingCallbacks.h"
 #include "swift/Parse/Lexer.h"
@@ -30,8 +31,11 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
+#include <thread>
 
 using namespace swift;
 
@@ -52,9 +56,36 @@ void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+StartupProfile::Step::~Step() {
+  if (!Profile)
+    return;
+  auto Elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   Clock::now() - Start).count();
+  Profile->Steps.push_back({ Name, Elapsed });
+}
+
+void StartupProfile::print(raw_ostream &OS) const {
+  uint64_t Total = 0;
+  for (auto &Step : Steps)
+    Total += Step.second;
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << std::string(30, ' ') << "Startup profile\n"
+     << "===" << std::string(73, '-') << "===\n";
+  for (auto &Step : Steps)
+    OS << llvm::format("%10.3f ms  %5.1f%%  ", Step.second / 1e6,
+                       Total ? Step.second * 100.0 / Total : 0.0)
+       << Step.first << "\n";
+  OS << llvm::format("%10.3f ms  %5.1f%%  ", Total / 1e6, 100.0)
+     << "Total\n";
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
 
+  if (Invocation.getFrontendOptions().PrintStartupProfile)
+    Profile.reset(new StartupProfile);
+
   // Honor -Xllvm.
   if (!Invok.getFrontendOptions().LLVMArgs.empty()) {
     llvm::SmallVector<const char *, 4> Args;
@@ -81,35 +112,47 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   if (!Invocation.getFrontendOptions().ModuleDocOutputPath.empty())
     Invocation.getLangOptions().AttachCommentsToDecls = true;
 
-  Context.reset(new ASTContext(Invocation.getLangOptions(),
-                               Invocation.getSearchPathOptions(),
-                               SourceMgr, Diagnostics));
-
-  if (Invocation.getFrontendOptions().EnableSourceImport) {
-    bool immediate = Invocation.getFrontendOptions().actionIsImmediate();
-    bool enableResilience = Invocation.getFrontendOptions().EnableResilience;
-    Context->addModuleLoader(SourceLoader::create(*Context,
-                                                  !immediate,
-                                                  enableResilience,
-                                                  DepTracker));
-  }
-  
-  auto SML = SerializedModuleLoader::create(*Context, DepTracker);
-  this->SML = SML.get();
-  Context->addModuleLoader(std::move(SML));
-
-  // Wire up the Clang importer. If the user has specified an SDK, use it.
-  // Otherwise, we just keep it around as our interface to Clang's ABI
-  // knowledge.
-  auto clangImporter =
-    ClangImporter::create(*Context, Invocation.getClangImporterOptions(),
-                          DepTracker);
-  if (!clangImporter) {
-    Diagnostics.diagnose(SourceLoc(), diag::error_clang_importer_create_fail);
-    return true;
+  {
+    StartupProfile::Step step(Profile.get(), "ASTContext");
+    Context.reset(new ASTContext(Invocation.getLangOptions(),
+                                 Invocation.getSearchPathOptions(),
+                                 SourceMgr, Diagnostics));
+  }
+
+  {
+    StartupProfile::Step step(Profile.get(), "Swift module loaders");
+    if (Invocation.getFrontendOptions().EnableSourceImport) {
+      bool immediate = Invocation.getFrontendOptions().actionIsImmediate();
+      bool enableResilience = Invocation.getFrontendOptions().EnableResilience;
+      Context->addModuleLoader(SourceLoader::create(*Context,
+                                                    !immediate,
+                                                    enableResilience,
+                                                    DepTracker));
+    }
+
+    auto SML = SerializedModuleLoader::create(*Context, DepTracker);
+    this->SML = SML.get();
+    Context->addModuleLoader(std::move(SML));
+  }
+
+  {
+    StartupProfile::Step step(Profile.get(), "Clang importer");
+
+    // Wire up the Clang importer. If the user has specified an SDK, use it.
+    // Otherwise, we just keep it around as our interface to Clang's ABI
+    // knowledge.
+    auto clangImporter =
+      ClangImporter::create(*Context, Invocation.getClangImporterOptions(),
+                            DepTracker);
+    if (!clangImporter) {
+      Diagnostics.diagnose(SourceLoc(), diag::error_clang_importer_create_fail);
+      return true;
+    }
+
+    Context->addModuleLoader(std::move(clangImporter), /*isClang*/true);
   }
 
-  Context->addModuleLoader(std::move(clangImporter), /*isClang*/true);
+  StartupProfile::Step inputFilesStep(Profile.get(), "Input files");
 
   assert(Lexer::isIdentifier(Invocation.getModuleName()));
 
@@ -238,6 +281,67 @@ Module *CompilerInstance::getMainModule() {
   return MainModule;
 }
 
+/// Returns true if SwiftOnoneSupport should be imported along with the
+/// standard library.
+static bool shouldImportSwiftOnoneSupport(const CompilerInvocation &Invocation) {
+  const FrontendOptions &options = Invocation.getFrontendOptions();
+  const auto &silOptions = Invocation.getSILOptions();
+  return (silOptions.Optimization <= SILOptions::SILOptMode::None &&
+          (options.RequestedAction == FrontendOptions::EmitObject ||
+           options.RequestedAction == FrontendOptions::Immediate ||
+           options.RequestedAction == FrontendOptions::EmitSIL)) ||
+         (silOptions.Optimization == SILOptions::SILOptMode::None &&
+          options.RequestedAction >= FrontendOptions::EmitSILGen);
+}
+
+/// Adds the names of the modules imported at the top of a source file to
+/// \p Names, without parsing it.
+///
+/// The scan stops at the first brace, so imports that follow a declaration
+/// with a body are missed; they are still loaded when they're imported.
+static void collectLeadingImports(ASTContext &Ctx, SourceManager &SM,
+                                  unsigned BufferID,
+                                  SmallVectorImpl<Identifier> &Names) {
+  Lexer L(Ctx.LangOpts, SM, BufferID, /*Diags=*/nullptr, /*InSILMode=*/false);
+  Token Tok;
+  while (true) {
+    L.lex(Tok);
+    if (Tok.isAny(tok::eof, tok::l_brace))
+      return;
+    if (Tok.isNot(tok::kw_import))
+      continue;
+
+    // Skip the kind of a scoped import, as in 'import struct Foo.Bar'.
+    L.lex(Tok);
+    if (Tok.isAny(tok::kw_typealias, tok::kw_struct, tok::kw_class,
+                  tok::kw_enum, tok::kw_protocol, tok::kw_var, tok::kw_let,
+                  tok::kw_func))
+      L.lex(Tok);
+
+    if (Tok.is(tok::identifier))
+      Names.push_back(Ctx.getIdentifier(Tok.getText()));
+  }
+}
+
+/// Returns true if this invocation can type-check its inputs in forked
+/// workers. Nothing may need the type-checked AST once the workers exit, and
+/// all diagnostics must be printed rather than recorded.
+static bool canTypeCheckInWorkers(const CompilerInvocation &Invocation) {
+  const FrontendOptions &opts = Invocation.getFrontendOptions();
+  return opts.TypeCheckWorkers > 1 &&
+         opts.RequestedAction == FrontendOptions::Parse &&
+         !opts.PrimaryInput.hasValue() &&
+         opts.ObjCHeaderOutputPath.empty() &&
+         opts.SerializedDiagnosticsPath.empty() &&
+         opts.FixitsOutputPath.empty() &&
+         opts.DependenciesFilePath.empty() &&
+         opts.ReferenceDependenciesFilePath.empty() &&
+         opts.DumpAPIPath.empty() &&
+         Invocation.getDiagnosticOptions().VerifyMode ==
+           DiagnosticOptions::NoVerify &&
+         sys::supportsForkedWorkers();
+}
+
 void CompilerInstance::performSema() {
   const FrontendOptions &options = Invocation.getFrontendOptions();
   const InputFileKind Kind = Invocation.getInputKind();
@@ -256,11 +360,33 @@ void CompilerInstance::performSema() {
     modImpKind = SourceFile::ImplicitModuleImportKind::Builtin;
   }
 
+  if (options.EnableParallelImports && Kind == InputFileKind::IFK_Swift) {
+    StartupProfile::Step step(Profile.get(), "Prefetching imports");
+    SmallVector<Identifier, 16> ImportedModuleNames;
+    if (modImpKind == SourceFile::ImplicitModuleImportKind::Stdlib) {
+      ImportedModuleNames.push_back(Context->StdlibModuleName);
+      if (shouldImportSwiftOnoneSupport(Invocation))
+        ImportedModuleNames.push_back(
+            Context->getIdentifier(SWIFT_ONONE_SUPPORT));
+    }
+    for (auto &ImplicitImportModuleName : options.ImplicitImportModuleNames)
+      if (Lexer::isIdentifier(ImplicitImportModuleName))
+        ImportedModuleNames.push_back(
+            Context->getIdentifier(ImplicitImportModuleName));
+    for (auto BufferID : BufferIDs)
+      collectLeadingImports(*Context, SourceMgr, BufferID,
+                            ImportedModuleNames);
+
+    SML->prefetchModules(ImportedModuleNames,
+                         std::thread::hardware_concurrency());
+  }
+
   switch (modImpKind) {
   case SourceFile::ImplicitModuleImportKind::None:
   case SourceFile::ImplicitModuleImportKind::Builtin:
     break;
   case SourceFile::ImplicitModuleImportKind::Stdlib: {
+    StartupProfile::Step step(Profile.get(), "Standard library");
     ModuleDecl *M = Context->getStdlibModule(true);
 
     if (!M) {
@@ -276,13 +402,7 @@ void CompilerInstance::performSema() {
       return;
     }
 
-    const auto &silOptions = Invocation.getSILOptions();
-    if ((silOptions.Optimization <= SILOptions::SILOptMode::None &&
-         (options.RequestedAction == FrontendOptions::EmitObject ||
-          options.RequestedAction == FrontendOptions::Immediate ||
-          options.RequestedAction == FrontendOptions::EmitSIL)) ||
-        (silOptions.Optimization == SILOptions::SILOptMode::None &&
-         options.RequestedAction >= FrontendOptions::EmitSILGen)) {
+    if (shouldImportSwiftOnoneSupport(Invocation)) {
       // Implicitly import the SwiftOnoneSupport module in non-optimized
       // builds. This allows for use of popular specialized functions
       // from the standard library, which makes the non-optimized builds
@@ -294,6 +414,9 @@ void CompilerInstance::performSema() {
   }
   }
 
+  Optional<StartupProfile::Step> implicitImportsStep;
+  implicitImportsStep.emplace(Profile.get(), "Implicit imports");
+
   auto clangImporter =
     static_cast<ClangImporter *>(Context->getClangModuleLoader());
 
@@ -343,6 +466,8 @@ void CompilerInstance::performSema() {
     }
   }
 
+  implicitImportsStep.reset();
+
   auto addAdditionalInitialImports = [&](SourceFile *SF) {
     if (!underlying && !importedHeaderModule && importModules.empty())
       return;
@@ -383,6 +508,13 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Outside of the IDE, only the primary file's function bodies are
+  // type-checked, so don't build ASTs for the bodies of the other files.
+  std::unique_ptr<DelayedParsingCallbacks> NonPrimaryCB;
+  if (!DelayedCB && PrimaryBufferID != NO_SUCH_BUFFER &&
+      !options.ParseNonPrimaryFunctionBodies)
+    NonPrimaryCB.reset(new NonPrimaryDelayedCallbacks);
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -441,7 +573,8 @@ void CompilerInstance::performSema() {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState,
+                          IsPrimary ? DelayedCB.get() : NonPrimaryCB.get());
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -468,6 +601,12 @@ void CompilerInstance::performSema() {
   if (options.DebugTimeFunctionBodies) {
     TypeCheckOptions |= TypeCheckingFlags::DebugTimeFunctionBodies;
   }
+  if (options.DebugTimeExpressionTypeChecking) {
+    TypeCheckOptions |= TypeCheckingFlags::DebugTimeExpressions;
+  }
+  if (options.DebugExpressionSolverMemory) {
+    TypeCheckOptions |= TypeCheckingFlags::DebugSolverMemory;
+  }
   if (options.actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
@@ -494,11 +633,13 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState,
+                          mainIsPrimary ? DelayedCB.get() : NonPrimaryCB.get());
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
-                            options.WarnLongFunctionBodies);
+                            options.WarnLongFunctionBodies,
+                            options.WarnLongExpressionTypeChecking);
       }
       CurTUElem = MainFile.Decls.size();
     } while (!Done);
@@ -512,13 +653,67 @@ void CompilerInstance::performSema() {
       performNameBinding(MainFile);
   }
 
-  // Type-check each top-level input besides the main source file.
+  // Parse the non-primary bodies that were delayed rather than skipped.
+  if (NonPrimaryCB)
+    performDelayedParsing(MainModule, PersistentState, nullptr);
+
+  SmallVector<SourceFile *, 16> FilesToCheck;
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
       if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+        FilesToCheck.push_back(SF);
+
+  if (MainBufferID == NO_SUCH_BUFFER && !DelayedCB &&
+      FilesToCheck.size() > 1 && canTypeCheckInWorkers(Invocation)) {
+    // Each worker type-checks a contiguous run of the inputs, as a
+    // whole-module build would, and exits.
+    unsigned NumWorkers = std::min<size_t>(options.TypeCheckWorkers,
+                                           FilesToCheck.size());
+    auto typeCheckSlice = [&](unsigned Worker) -> int {
+      size_t Begin = Worker * FilesToCheck.size() / NumWorkers;
+      size_t End = (Worker + 1) * FilesToCheck.size() / NumWorkers;
+      auto Slice = llvm::makeArrayRef(FilesToCheck).slice(Begin, End - Begin);
+      for (auto SF : Slice)
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, /*curElem*/0,
-                            options.WarnLongFunctionBodies);
+                            options.WarnLongFunctionBodies,
+                            options.WarnLongExpressionTypeChecking);
+      if (auto *stdlib = Context->getStdlibModule())
+        Context->recordKnownProtocols(stdlib);
+      for (auto SF : Slice)
+        performWholeModuleTypeChecking(*SF);
+      for (auto SF : Slice)
+        finishTypeChecking(*SF);
+      return Context->hadError() ? 1 : 0;
+    };
+
+    SmallVector<sys::ForkedWorkerResult, 8> Results;
+    std::string ErrorMsg;
+    if (!sys::runForkedWorkers(NumWorkers, typeCheckSlice, Results,
+                               ErrorMsg)) {
+      for (unsigned i = 0; i != NumWorkers; ++i) {
+        llvm::errs() << Results[i].Output;
+        if (Results[i].ExitCode < 0)
+          Diagnostics.diagnose(SourceLoc(),
+                               diag::error_type_check_worker_crashed,
+                               i + 1, NumWorkers);
+        else if (Results[i].ExitCode != 0)
+          HadErrorsInTypeCheckWorkers = true;
+      }
+      return;
+    }
+
+    Diagnostics.diagnose(SourceLoc(),
+                         diag::warning_type_check_workers_unavailable,
+                         ErrorMsg);
+  }
+
+  // Type-check each top-level input besides the main source file.
+  for (auto SF : FilesToCheck)
+    performTypeChecking(*SF, PersistentState.getTopLevelContext(),
+                        TypeCheckOptions, /*curElem*/0,
+                        options.WarnLongFunctionBodies,
+                        options.WarnLongExpressionTypeChecking);
 
   // Even if there were no source files, we should still record known
   // protocols.
@@ -537,10 +732,8 @@ void CompilerInstance::performSema() {
         performWholeModuleTypeChecking(*SF);
   }
 
-  for (auto File : MainModule->getFiles())
-    if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
-        finishTypeChecking(*SF);
+  for (auto SF : FilesToCheck)
+    finishTypeChecking(*SF);
 }
 
 void CompilerInstance::performParseOnly() {
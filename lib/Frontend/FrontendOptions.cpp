@@ -83,6 +83,7 @@ void FrontendOptions::forAllOutputPaths(
   const std::string *outputs[] = {
     &ModuleOutputPath,
     &ModuleDocOutputPath,
+    &ModuleSummaryOutputPath,
     &ObjCHeaderOutputPath
   };
   for (const std::string *next : outputs) {
@@ -29,22 +29,33 @@
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Mangle.h"
 #include "swift/AST/NameLookup.h"
+#include "swift/AST/Pattern.h"
 #include "swift/AST/ReferencedNameTracker.h"
 #include "swift/AST/TypeRefinementContext.h"
+#include "swift/Basic/BinarySwiftDeps.h"
+#include "swift/Basic/CompileServer.h"
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
 #include "swift/Basic/LLVMContext.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistics.h"
+#include "swift/Basic/TaskQueue.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/TraceEvents.h"
+#include "swift/Basic/Version.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Frontend/SerializedDiagnosticConsumer.h"
 #include "swift/Immediate/Immediate.h"
 #include "swift/Option/Options.h"
+#include "swift/Parse/Lexer.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
+#include "swift/Serialization/DeserializationStats.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/Serialization/Validation.h"
+#include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 
 // FIXME: We're just using CompilerInstance::createOutputFile.
@@ -58,12 +69,15 @@
 #include "llvm/Option/Option.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/YAMLParser.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 
@@ -199,6 +213,255 @@ static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   return mangler.finalize();
 }
 
+/// Returns the source text that makes up \p D's interface, leaving out
+/// function bodies and member lists.
+///
+/// Returns None for declarations whose interface can change without their
+/// text changing, such as implicit declarations and variables with inferred
+/// types.
+static Optional<StringRef> getInterfaceText(const SourceManager &SM,
+                                            const Decl *D) {
+  if (D->isImplicit())
+    return None;
+
+  SourceRange range = D->getSourceRange();
+  if (auto *VD = dyn_cast<VarDecl>(D)) {
+    auto *PBD = VD->getParentPatternBinding();
+    if (!PBD || !isa<TypedPattern>(VD->getParentPattern()))
+      return None;
+    range = PBD->getSourceRange();
+  }
+  if (range.isInvalid())
+    return None;
+
+  // Include any attributes and modifiers.
+  SourceLoc start = range.Start;
+  for (bool forModifiers : {false, true}) {
+    SourceLoc attrStart = D->getAttrs().getStartLoc(forModifiers);
+    if (attrStart.isValid() && SM.isBeforeInBuffer(attrStart, start))
+      start = attrStart;
+  }
+
+  SourceLoc end;
+  if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D))
+    end = AFD->getBodySourceRange().Start;
+  else if (auto *NTD = dyn_cast<NominalTypeDecl>(D))
+    end = NTD->getBraces().Start;
+  else if (auto *ED = dyn_cast<ExtensionDecl>(D))
+    end = ED->getBraces().Start;
+
+  if (end.isValid())
+    return SM.extractText(CharSourceRange(SM, start, end));
+  return SM.extractText(
+      Lexer::getCharSourceRangeFromSourceRange(SM, {start, range.End}));
+}
+
+namespace {
+/// Combines the interface text of declarations into a fingerprint for an
+/// entry in a Swift-style dependencies file.
+class FingerprintBuilder {
+  llvm::MD5 hash;
+  bool isKnown = true;
+
+public:
+  void add(const SourceManager &SM, const Decl *D) {
+    auto text = getInterfaceText(SM, D);
+    if (!text) {
+      isKnown = false;
+      return;
+    }
+    hash.update(*text);
+    hash.update(StringRef("\0", 1));
+  }
+
+  /// Returns the fingerprint, or an empty string if any of the declarations
+  /// couldn't be fingerprinted.
+  std::string finalize() {
+    if (!isKnown)
+      return std::string();
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    return str.str();
+  }
+};
+
+/// The fingerprints of the entries a file provides for a type, covering the
+/// parts of the type declared in that file.
+struct TypeFingerprints {
+  /// For the "provides-nominal" entry: the type's headers, including
+  /// inheritance clauses and generic requirements.
+  std::string nominal;
+  /// For the "provides-member" entry with an empty member name, which
+  /// covers the type's full set of members.
+  std::string allMembers;
+  /// For the other "provides-member" entries, by member name.
+  llvm::MapVector<Identifier, std::string> members;
+};
+} // end anonymous namespace
+
+static TypeFingerprints
+computeTypeFingerprints(const SourceManager &SM, const SourceFile *SF,
+                        const NominalTypeDecl *NTD,
+                        ArrayRef<const ExtensionDecl *> extensions) {
+  FingerprintBuilder header, allMembers;
+  llvm::MapVector<Identifier, FingerprintBuilder> members;
+
+  auto addContext = [&](const Decl *D, DeclRange contextMembers) {
+    header.add(SM, D);
+    allMembers.add(SM, D);
+    for (const Decl *member : contextMembers) {
+      auto *VD = dyn_cast<ValueDecl>(member);
+      if (!VD || !VD->hasName())
+        continue;
+      if (VD->hasAccessibility() &&
+          VD->getFormalAccess() <= Accessibility::FilePrivate)
+        continue;
+      members[VD->getName()].add(SM, VD);
+      // Implicit members are derived from the explicit ones.
+      if (!VD->isImplicit())
+        allMembers.add(SM, VD);
+    }
+  };
+
+  if (NTD->getModuleScopeContext() == SF)
+    addContext(NTD, NTD->getMembers());
+  for (auto *ED : extensions)
+    addContext(ED, ED->getMembers());
+
+  TypeFingerprints result;
+  result.nominal = header.finalize();
+  result.allMembers = allMembers.finalize();
+  for (auto &entry : members)
+    result.members[entry.first] = entry.second.finalize();
+  return result;
+}
+
+namespace {
+/// Receives the contents of a Swift-style dependencies file, one section at
+/// a time, and writes them out in a particular format.
+class ReferenceDependencyWriter {
+protected:
+  using EntryKind = binary_swiftdeps::EntryKind;
+
+public:
+  virtual ~ReferenceDependencyWriter() = default;
+
+  /// Starts a new list of entries, which may be empty.
+  virtual void beginSection(EntryKind kind) = 0;
+
+  /// Adds a name to the current section. Only "provides" entries may have a
+  /// \p fingerprint.
+  virtual void addName(StringRef name, bool isCascading,
+                       StringRef fingerprint) = 0;
+  virtual void addMember(StringRef mangledBaseName, StringRef member,
+                         bool isCascading, StringRef fingerprint) = 0;
+  virtual void addInterfaceHash(StringRef hash) = 0;
+
+  /// Called after all entries have been added.
+  virtual void finish() {}
+};
+
+/// Writes the YAML format read by the driver's DependencyGraph.
+class YAMLReferenceDependencyWriter : public ReferenceDependencyWriter {
+  raw_ostream &out;
+  EntryKind currentKind = EntryKind::ProvidesTopLevel;
+
+  static StringRef getKey(EntryKind kind) {
+    switch (kind) {
+    case EntryKind::ProvidesTopLevel: return "provides-top-level";
+    case EntryKind::ProvidesNominal: return "provides-nominal";
+    case EntryKind::ProvidesMember: return "provides-member";
+    case EntryKind::ProvidesDynamicLookup: return "provides-dynamic-lookup";
+    case EntryKind::DependsTopLevel: return "depends-top-level";
+    case EntryKind::DependsNominal: return "depends-nominal";
+    case EntryKind::DependsMember: return "depends-member";
+    case EntryKind::DependsDynamicLookup: return "depends-dynamic-lookup";
+    case EntryKind::DependsExternal: return "depends-external";
+    case EntryKind::InterfaceHash: return "interface-hash";
+    }
+  }
+
+public:
+  explicit YAMLReferenceDependencyWriter(raw_ostream &out) : out(out) {
+    out << "### Swift dependencies file v0 ###\n";
+  }
+
+  void beginSection(EntryKind kind) override {
+    currentKind = kind;
+    out << getKey(kind) << ":\n";
+  }
+
+  void addName(StringRef name, bool isCascading,
+               StringRef fingerprint) override {
+    out << "- ";
+    if (!isCascading)
+      out << "!private ";
+    if (!fingerprint.empty())
+      out << "[";
+    // Mangled names never need escaping.
+    if (currentKind == EntryKind::ProvidesNominal ||
+        currentKind == EntryKind::DependsNominal)
+      out << "\"" << name << "\"";
+    else
+      out << "\"" << llvm::yaml::escape(name) << "\"";
+    if (!fingerprint.empty())
+      out << ", \"" << fingerprint << "\"]";
+    out << "\n";
+  }
+
+  void addMember(StringRef mangledBaseName, StringRef member,
+                 bool isCascading, StringRef fingerprint) override {
+    out << "- ";
+    if (!isCascading)
+      out << "!private ";
+    out << "[\"" << mangledBaseName << "\", \""
+        << llvm::yaml::escape(member) << "\"";
+    if (!fingerprint.empty())
+      out << ", \"" << fingerprint << "\"";
+    out << "]\n";
+  }
+
+  void addInterfaceHash(StringRef hash) override {
+    out << getKey(EntryKind::InterfaceHash) << ": \"" << hash << "\"\n";
+  }
+};
+
+/// Writes the format described in BinarySwiftDeps.h.
+class BinaryReferenceDependencyWriter : public ReferenceDependencyWriter {
+  raw_ostream &out;
+  binary_swiftdeps::Writer writer;
+  EntryKind currentKind = EntryKind::ProvidesTopLevel;
+
+public:
+  explicit BinaryReferenceDependencyWriter(raw_ostream &out) : out(out) {}
+
+  void beginSection(EntryKind kind) override {
+    currentKind = kind;
+  }
+
+  void addName(StringRef name, bool isCascading,
+               StringRef fingerprint) override {
+    writer.addEntry(currentKind, name, isCascading, fingerprint);
+  }
+
+  void addMember(StringRef mangledBaseName, StringRef member,
+                 bool isCascading, StringRef fingerprint) override {
+    writer.addMemberEntry(currentKind, mangledBaseName, member, isCascading,
+                          fingerprint);
+  }
+
+  void addInterfaceHash(StringRef hash) override {
+    writer.addEntry(EntryKind::InterfaceHash, hash);
+  }
+
+  void finish() override {
+    writer.write(out);
+  }
+};
+} // end anonymous namespace
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -221,17 +484,30 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     return true;
   }
 
-  auto escape = [](Identifier name) -> std::string {
-    return llvm::yaml::escape(name.str());
+  std::unique_ptr<ReferenceDependencyWriter> writer;
+  if (opts.EmitBinaryReferenceDependencies)
+    writer.reset(new BinaryReferenceDependencyWriter(out));
+  else
+    writer.reset(new YAMLReferenceDependencyWriter(out));
+  using EntryKind = binary_swiftdeps::EntryKind;
+
+  const SourceManager &SM = SF->getASTContext().SourceMgr;
+  bool withFingerprints = opts.EmitReferenceDependencyFingerprints;
+  auto getFingerprint = [&](const Decl *D) -> std::string {
+    if (!withFingerprints)
+      return std::string();
+    FingerprintBuilder builder;
+    builder.add(SM, D);
+    return builder.finalize();
   };
 
-  out << "### Swift dependencies file v0 ###\n";
-
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
   llvm::SmallVector<const FuncDecl *, 8> memberOperatorDecls;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
+  llvm::DenseMap<const NominalTypeDecl *,
+                 SmallVector<const ExtensionDecl *, 2>> extensionsByNominal;
 
-  out << "provides-top-level:\n";
+  writer->beginSection(EntryKind::ProvidesTopLevel);
   for (const Decl *D : SF->Decls) {
     switch (D->getKind()) {
     case DeclKind::Module:
@@ -262,6 +538,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           extensionsWithJustMembers.push_back(ED);
         }
       }
+      extensionsByNominal[NTD].push_back(ED);
       extendedNominals[NTD] |= !justMembers;
       findNominalsAndOperators(extendedNominals, memberOperatorDecls,
                                ED->getMembers());
@@ -271,11 +548,13 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::InfixOperator:
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
-      out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      writer->addName(cast<OperatorDecl>(D)->getName().str(),
+                      /*isCascading=*/true, getFingerprint(D));
       break;
 
     case DeclKind::PrecedenceGroup:
-      out << "- \"" << escape(cast<PrecedenceGroupDecl>(D)->getName()) << "\"\n";
+      writer->addName(cast<PrecedenceGroupDecl>(D)->getName().str(),
+                      /*isCascading=*/true, getFingerprint(D));
       break;
 
     case DeclKind::Enum:
@@ -289,7 +568,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           NTD->getFormalAccess() <= Accessibility::FilePrivate) {
         break;
       }
-      out << "- \"" << escape(NTD->getName()) << "\"\n";
+      writer->addName(NTD->getName().str(), /*isCascading=*/true,
+                      getFingerprint(NTD));
       extendedNominals[NTD] |= true;
       findNominalsAndOperators(extendedNominals, memberOperatorDecls,
                                NTD->getMembers());
@@ -306,7 +586,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() <= Accessibility::FilePrivate) {
         break;
       }
-      out << "- \"" << escape(VD->getName()) << "\"\n";
+      writer->addName(VD->getName().str(), /*isCascading=*/true,
+                      getFingerprint(VD));
       break;
     }
 
@@ -330,25 +611,47 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
 
   // This is also part of "provides-top-level".
   for (auto *operatorFunction : memberOperatorDecls)
-    out << "- \"" << escape(operatorFunction->getName()) << "\"\n";
+    writer->addName(operatorFunction->getName().str(), /*isCascading=*/true,
+                    getFingerprint(operatorFunction));
+
+  // With fingerprints, every member of every type gets its own entry, so that
+  // the driver can tell which members changed.
+  llvm::MapVector<const NominalTypeDecl *, TypeFingerprints> typeFingerprints;
+  if (withFingerprints) {
+    for (auto entry : extendedNominals) {
+      auto extensions = extensionsByNominal.lookup(entry.first);
+      typeFingerprints[entry.first] =
+          computeTypeFingerprints(SM, SF, entry.first, extensions);
+    }
+  }
 
-  out << "provides-nominal:\n";
+  writer->beginSection(EntryKind::ProvidesNominal);
   for (auto entry : extendedNominals) {
     if (!entry.second)
       continue;
-    out << "- \"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\"\n";
+    writer->addName(mangleTypeAsContext(entry.first), /*isCascading=*/true,
+                    typeFingerprints.lookup(entry.first).nominal);
   }
 
-  out << "provides-member:\n";
+  writer->beginSection(EntryKind::ProvidesMember);
   for (auto entry : extendedNominals) {
-    out << "- [\"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\", \"\"]\n";
+    writer->addMember(mangleTypeAsContext(entry.first), "",
+                      /*isCascading=*/true,
+                      typeFingerprints.lookup(entry.first).allMembers);
   }
 
-  // This is also part of "provides-member".
+  // This is also part of "provides-member". With fingerprints, this covers
+  // the members of extensions as well.
+  for (auto &entry : typeFingerprints) {
+    auto mangledName = mangleTypeAsContext(entry.first);
+    for (auto &member : entry.second.members) {
+      writer->addMember(mangledName, member.first.str(), /*isCascading=*/true,
+                        member.second);
+    }
+  }
+  if (withFingerprints)
+    extensionsWithJustMembers.clear();
+
   for (auto *ED : extensionsWithJustMembers) {
     auto mangledName = mangleTypeAsContext(
                                         ED->getExtendedType()->getAnyNominal());
@@ -359,8 +662,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() <= Accessibility::FilePrivate) {
         continue;
       }
-      out << "- [\"" << mangledName << "\", \""
-          << escape(VD->getName()) << "\"]\n";
+      writer->addMember(mangledName, VD->getName().str(),
+                        /*isCascading=*/true, StringRef());
     }
   }
 
@@ -368,36 +671,32 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     // FIXME: This requires a traversal of the whole file to compute.
     // We should (a) see if there's a cheaper way to keep it up to date,
     // and/or (b) see if we can fast-path cases where there's no ObjC involved.
-    out << "provides-dynamic-lookup:\n";
+    writer->beginSection(EntryKind::ProvidesDynamicLookup);
     class ValueDeclPrinter : public VisibleDeclConsumer {
     private:
-      raw_ostream &out;
-      std::string (*escape)(Identifier);
+      ReferenceDependencyWriter &writer;
     public:
-      ValueDeclPrinter(raw_ostream &out, decltype(escape) escape)
-        : out(out), escape(escape) {}
+      explicit ValueDeclPrinter(ReferenceDependencyWriter &writer)
+        : writer(writer) {}
 
       void foundDecl(ValueDecl *VD, DeclVisibilityKind Reason) override {
-        out << "- \"" << escape(VD->getName()) << "\"\n";
+        writer.addName(VD->getName().str(), /*isCascading=*/true, StringRef());
       }
     };
-    ValueDeclPrinter printer(out, escape);
+    ValueDeclPrinter printer(*writer);
     SF->lookupClassMembers({}, printer);
   }
 
   ReferencedNameTracker *tracker = SF->getReferencedNameTracker();
 
   // FIXME: Sort these?
-  out << "depends-top-level:\n";
+  writer->beginSection(EntryKind::DependsTopLevel);
   for (auto &entry : tracker->getTopLevelNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    writer->addName(entry.first.str(), entry.second, StringRef());
   }
 
-  out << "depends-member:\n";
+  writer->beginSection(EntryKind::DependsMember);
   auto &memberLookupTable = tracker->getUsedMembers();
   using TableEntryTy = std::pair<ReferencedNameTracker::MemberPair, bool>;
   std::vector<TableEntryTy> sortedMembers{
@@ -424,18 +723,14 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         entry.first.first->getFormalAccess() <= Accessibility::FilePrivate)
       continue;
 
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "[\"";
-    out << mangleTypeAsContext(entry.first.first);
-    out << "\", \"";
+    StringRef memberName;
     if (!entry.first.second.empty())
-      out << escape(entry.first.second);
-    out << "\"]\n";
+      memberName = entry.first.second.str();
+    writer->addMember(mangleTypeAsContext(entry.first.first), memberName,
+                      entry.second, StringRef());
   }
 
-  out << "depends-nominal:\n";
+  writer->beginSection(EntryKind::DependsNominal);
   for (auto i = sortedMembers.begin(), e = sortedMembers.end(); i != e; ++i) {
     bool isCascading = i->second;
     while (i+1 != e && i[0].first.first == i[1].first.first) {
@@ -447,33 +742,27 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         i->first.first->getFormalAccess() <= Accessibility::FilePrivate)
       continue;
 
-    out << "- ";
-    if (!isCascading)
-      out << "!private ";
-    out << "\"";
-    out <<  mangleTypeAsContext(i->first.first);
-    out << "\"\n";
+    writer->addName(mangleTypeAsContext(i->first.first), isCascading,
+                    StringRef());
   }
 
   // FIXME: Sort these?
-  out << "depends-dynamic-lookup:\n";
+  writer->beginSection(EntryKind::DependsDynamicLookup);
   for (auto &entry : tracker->getDynamicLookupNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    writer->addName(entry.first.str(), entry.second, StringRef());
   }
 
-  out << "depends-external:\n";
+  writer->beginSection(EntryKind::DependsExternal);
   for (auto &entry : depTracker.getDependencies()) {
-    out << "- \"" << llvm::yaml::escape(entry) << "\"\n";
+    writer->addName(entry, /*isCascading=*/true, StringRef());
   }
 
   llvm::SmallString<32> interfaceHash;
   SF->getInterfaceHash(interfaceHash);
-  out << "interface-hash: \"" << interfaceHash << "\"\n";
+  writer->addInterfaceHash(interfaceHash);
 
+  writer->finish();
   return false;
 }
 
@@ -698,6 +987,70 @@ static void debugFailWithCrash() {
 
 /// Performs the compile requested by the user.
 /// \returns true on error
+/// Hashes everything the outputs of a merge-modules job depend on: the
+/// compiler version, the frontend arguments, and the name and contents of
+/// each partial module.
+///
+/// Returns an empty string if one of the inputs can't be read.
+static std::string
+computeMergedInputsHash(const CompilerInvocation &Invocation,
+                        ArrayRef<const char *> Args) {
+  llvm::MD5 hash;
+  auto add = [&](StringRef str) {
+    hash.update(str);
+    hash.update(StringRef("\0", 1));
+  };
+
+  add(version::getSwiftFullVersion(
+        Invocation.getLangOptions().EffectiveLanguageVersion));
+  for (size_t i = 0, e = Args.size(); i != e; ++i) {
+    // The driver names the file list after a new temporary file each time.
+    // The inputs it lists are hashed below.
+    if (StringRef(Args[i]) == "-filelist") {
+      ++i;
+      continue;
+    }
+    add(Args[i]);
+  }
+
+  for (auto &File : Invocation.getInputFilenames()) {
+    auto Buffer = llvm::MemoryBuffer::getFile(File);
+    if (!Buffer)
+      return std::string();
+    add(File);
+    add(Buffer.get()->getBuffer());
+  }
+
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  SmallString<32> str;
+  llvm::MD5::stringifyResult(result, str);
+  return str.str();
+}
+
+/// Returns true if every output of a merge-modules job exists, and the module
+/// was merged from inputs with the given hash.
+static bool isMergedModuleUpToDate(const FrontendOptions &opts,
+                                   StringRef mergedInputsHash) {
+  bool allOutputsExist = true;
+  opts.forAllOutputPaths([&](const std::string &path) {
+    if (!llvm::sys::fs::exists(path))
+      allOutputsExist = false;
+  });
+  if (!allOutputsExist)
+    return false;
+
+  auto Buffer = llvm::MemoryBuffer::getFile(opts.ModuleOutputPath);
+  if (!Buffer)
+    return false;
+
+  serialization::ExtendedValidationInfo extendedInfo;
+  auto info = serialization::validateSerializedAST(Buffer.get()->getBuffer(),
+                                                   &extendedInfo);
+  return info.status == serialization::Status::Valid &&
+         extendedInfo.getMergedInputsHash() == mergedInputsHash;
+}
+
 static bool performCompile(CompilerInstance &Instance,
                            CompilerInvocation &Invocation,
                            ArrayRef<const char *> Args,
@@ -746,6 +1099,19 @@ static bool performCompile(CompilerInstance &Instance,
     return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
   }
 
+  // A merge-modules job whose partial modules and options haven't changed
+  // would write the same outputs again.
+  std::string mergedInputsHash;
+  if (opts.SkipUnchangedModuleMerge &&
+      Action == FrontendOptions::EmitModuleOnly &&
+      Instance.getInputBufferIDs().empty() &&
+      !opts.ModuleOutputPath.empty()) {
+    mergedInputsHash = computeMergedInputsHash(Invocation, Args);
+    if (!mergedInputsHash.empty() &&
+        isMergedModuleUpToDate(opts, mergedInputsHash))
+      return false;
+  }
+
   ReferencedNameTracker nameTracker;
   bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
   if (shouldTrackReferences)
@@ -757,6 +1123,9 @@ static bool performCompile(CompilerInstance &Instance,
   else
     Instance.performSema();
 
+  if (auto *Profile = Instance.getStartupProfile())
+    Profile->print(llvm::errs());
+
   if (observer) {
     observer->performedSemanticAnalysis(Instance);
   }
@@ -858,7 +1227,7 @@ static bool performCompile(CompilerInstance &Instance,
     emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
                               *Instance.getDependencyTracker(), opts);
 
-  if (Context.hadError())
+  if (Context.hadError() || Instance.hadErrorsInTypeCheckWorkers())
     return true;
 
   // FIXME: This is still a lousy approximation of whether the module file will
@@ -946,6 +1315,21 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  // Open the optimization record before running the passes which write
+  // remarks to it.
+  const std::string &OptRecordFile = Invocation.getSILOptions().OptRecordFile;
+  if (!OptRecordFile.empty()) {
+    std::error_code EC;
+    std::unique_ptr<llvm::raw_fd_ostream> OS(
+        new llvm::raw_fd_ostream(OptRecordFile, EC, llvm::sys::fs::F_None));
+    if (EC) {
+      Context.Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                             OptRecordFile, EC.message());
+      return true;
+    }
+    SM->setOptRecordStream(std::move(OS));
+  }
+
   // Perform SIL optimization passes if optimizations haven't been disabled.
   // These may change across compiler versions.
   {
@@ -973,11 +1357,37 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (stats::isEnabled()) {
+    uint64_t NumInstructions = 0;
+    for (auto &F : *SM)
+      for (auto &BB : F)
+        NumInstructions += std::distance(BB.begin(), BB.end());
+    stats::addCounter("SILOptimizer", "NumFunctions",
+                      SM->getFunctionList().size());
+    stats::addCounter("SILOptimizer", "NumInstructions", NumInstructions);
+  }
+
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
     performSILInstCount(&*SM);
   }
 
+  if (SM->getOptions().PrintMemoryStats)
+    SM->printMemoryStats(llvm::errs());
+
+  const std::string &RequestsFile =
+      Invocation.getSILOptions().SpecializationRequestsFile;
+  if (!RequestsFile.empty()) {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(RequestsFile, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      Context.Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                             RequestsFile, EC.message());
+      return true;
+    }
+    writeSpecializationRequests(OS, SM->getSpecializationRequests());
+  }
+
   // Get the main source file's private discriminator and attach it to
   // the compile unit's flags.
   if (PrimarySourceFile) {
@@ -1012,11 +1422,15 @@ static bool performCompile(CompilerInstance &Instance,
       SerializationOptions serializationOpts;
       serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
       serializationOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
+      serializationOpts.SummaryOutputPath =
+        opts.ModuleSummaryOutputPath.c_str();
       serializationOpts.GroupInfoPath = opts.GroupInfoPath.c_str();
       serializationOpts.SerializeAllSIL = opts.SILSerializeAll;
+      serializationOpts.CompressSIL = opts.CompressSerializedSIL;
       if (opts.SerializeBridgingHeader)
         serializationOpts.ImportedHeader = opts.ImplicitObjCHeaderPath;
       serializationOpts.ModuleLinkName = opts.ModuleLinkName;
+      serializationOpts.MergedInputsHash = mergedInputsHash;
       serializationOpts.ExtraClangOptions =
           Invocation.getClangImporterOptions().ExtraArgs;
       if (!IRGenOpts.ForceLoadSymbolName.empty())
@@ -1029,6 +1443,14 @@ static bool performCompile(CompilerInstance &Instance,
           !moduleIsPublic || opts.AlwaysSerializeDebuggingOptions;
 
       serialize(DC, serializationOpts, SM.get());
+
+      // Let the driver start merging modules while we generate code.
+      if (opts.ReportEmittedModule && !Context.hadError()) {
+        llvm::outs().flush();
+        llvm::errs() << sys::TaskProgressPrefix << "emitted-module "
+                     << opts.ModuleOutputPath << "\n";
+        llvm::errs().flush();
+      }
     }
 
     if (Action == FrontendOptions::EmitModuleOnly)
@@ -1151,6 +1573,168 @@ static bool dumpAPI(Module *Mod, StringRef OutDir) {
   return false;
 }
 
+/// Writes the statistics collected during this compilation to a new file in
+/// the -stats-output-dir directory, named after the module and the primary
+/// file, if there is one.
+///
+/// Returns true if an error occurred.
+static bool writeStatsFile(CompilerInstance &Instance,
+                           const CompilerInvocation &Invocation) {
+  using namespace llvm::sys;
+
+  const FrontendOptions &opts = Invocation.getFrontendOptions();
+  ASTContext &Context = Instance.getASTContext();
+
+  // Add the statistics that are kept elsewhere.
+  for (auto &Entry : SILPassManager::takePassTimeTotals())
+    stats::addTime("SILOptimizer", Entry.first, Entry.second);
+  serialization::addDeserializationStatistics(Context);
+  stats::addCounter("AST", "MemoryBytes", Context.getTotalMemory());
+
+  std::string JobName = opts.ModuleName;
+  if (opts.PrimaryInput.hasValue() && opts.PrimaryInput->isFilename()) {
+    JobName += '-';
+    JobName += path::stem(opts.InputFilenames[opts.PrimaryInput->Index]);
+  }
+
+  std::error_code EC = fs::create_directories(opts.StatsOutputDir);
+  SmallString<128> Path;
+  if (!EC) {
+    SmallString<128> Model(opts.StatsOutputDir);
+    path::append(Model, "frontend-" + JobName + "-%%%%%%%%.json");
+    EC = fs::createUniqueFile(Model, Path);
+  }
+  if (EC) {
+    Instance.getDiags().diagnose(SourceLoc(), diag::error_opening_output,
+                                 opts.StatsOutputDir, EC.message());
+    return true;
+  }
+
+  std::string ErrorMsg;
+  if (stats::writeStats(Path, ErrorMsg)) {
+    Instance.getDiags().diagnose(SourceLoc(), diag::error_opening_output,
+                                 Path, ErrorMsg);
+    return true;
+  }
+  return false;
+}
+
+/// Performs each invocation named by a -batch-invocation argument in turn, as
+/// if each had been run as a separate frontend process.
+///
+/// Any other arguments are passed to every invocation, ahead of the ones read
+/// from its file. This lets the driver amortize process launch and LLVM
+/// initialization over several primary files; every invocation still gets
+/// its own CompilerInstance, so nothing else is shared between them.
+///
+/// \returns the first non-zero exit status, or 0 if every invocation
+/// succeeded
+static int performBatchInvocations(ArrayRef<const char *> Args,
+                                   const char *Argv0, void *MainAddr,
+                                   FrontendObserver *observer) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  PrintingDiagnosticConsumer PDC;
+  Diags.addConsumer(PDC);
+
+  SmallVector<const char *, 16> CommonArgs;
+  SmallVector<StringRef, 8> InvocationPaths;
+  for (size_t i = 0, e = Args.size(); i != e; ++i) {
+    StringRef Arg = Args[i];
+    if (Arg != "-batch-invocation") {
+      CommonArgs.push_back(Args[i]);
+      continue;
+    }
+    if (i + 1 == e) {
+      Diags.diagnose(SourceLoc(), diag::error_missing_arg_value, Arg, 1);
+      return 1;
+    }
+    InvocationPaths.push_back(Args[++i]);
+  }
+
+  int ReturnValue = 0;
+  for (StringRef Path : InvocationPaths) {
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer) {
+      Diags.diagnose(SourceLoc(), diag::cannot_open_file, Path,
+                     Buffer.getError().message());
+      return 1;
+    }
+
+    // The file lists one argument per line.
+    StringRef Contents = Buffer.get()->getBuffer();
+    if (Contents.endswith("\n"))
+      Contents = Contents.drop_back();
+    SmallVector<StringRef, 64> Lines;
+    if (!Contents.empty())
+      Contents.split(Lines, '\n');
+
+    std::vector<std::string> ArgStorage(Lines.begin(), Lines.end());
+    SmallVector<const char *, 64> InvocationArgs(CommonArgs.begin(),
+                                                 CommonArgs.end());
+    for (const std::string &Arg : ArgStorage)
+      InvocationArgs.push_back(Arg.c_str());
+
+    int Result = performFrontend(InvocationArgs, Argv0, MainAddr, observer);
+    if (ReturnValue == 0)
+      ReturnValue = Result;
+  }
+
+  return ReturnValue;
+}
+
+/// How long a compile server waits for a job before exiting, in seconds.
+static const unsigned CompileServerIdleTimeout = 10 * 60;
+
+/// Stays running to perform the frontend invocations sent to the socket named
+/// by the -run-compile-server argument.
+///
+/// Each job runs in a worker forked from this process, so it starts with LLVM
+/// already initialized but otherwise behaves exactly like a separate frontend
+/// process.
+///
+/// \returns 0 if the server exited because it was idle, or 1 on error
+static int performCompileServer(ArrayRef<const char *> Args,
+                                void *MainAddr,
+                                FrontendObserver *observer) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  PrintingDiagnosticConsumer PDC;
+  Diags.addConsumer(PDC);
+
+  StringRef SocketPath;
+  for (size_t i = 0, e = Args.size(); i != e; ++i) {
+    StringRef Arg = Args[i];
+    if (Arg != "-run-compile-server") {
+      Diags.diagnose(SourceLoc(), diag::error_argument_not_allowed_with, Arg,
+                     "-run-compile-server");
+      return 1;
+    }
+    if (i + 1 == e) {
+      Diags.diagnose(SourceLoc(), diag::error_missing_arg_value, Arg, 1);
+      return 1;
+    }
+    SocketPath = Args[++i];
+  }
+
+  auto performJob = [&](const char *ExecPath,
+                        ArrayRef<const char *> JobArgs) -> int {
+    // Jobs are sent exactly as they would be spawned: "swift -frontend ...".
+    if (!JobArgs.empty() && StringRef(JobArgs.front()) == "-frontend")
+      JobArgs = JobArgs.slice(1);
+    return performFrontend(JobArgs, ExecPath, MainAddr, observer);
+  };
+
+  std::string ErrorMsg;
+  if (sys::runCompileServer(SocketPath, CompileServerIdleTimeout, performJob,
+                            ErrorMsg)) {
+    Diags.diagnose(SourceLoc(), diag::error_compile_server, SocketPath,
+                   ErrorMsg);
+    return 1;
+  }
+  return 0;
+}
+
 int swift::performFrontend(ArrayRef<const char *> Args,
                            const char *Argv0, void *MainAddr,
                            FrontendObserver *observer) {
@@ -1159,6 +1743,18 @@ int swift::performFrontend(ArrayRef<const char *> Args,
   llvm::InitializeAllAsmPrinters();
   llvm::InitializeAllAsmParsers();
 
+  if (std::any_of(Args.begin(), Args.end(), [](const char *Arg) {
+        return StringRef(Arg) == "-batch-invocation";
+      })) {
+    return performBatchInvocations(Args, Argv0, MainAddr, observer);
+  }
+
+  if (std::any_of(Args.begin(), Args.end(), [](const char *Arg) {
+        return StringRef(Arg) == "-run-compile-server";
+      })) {
+    return performCompileServer(Args, MainAddr, observer);
+  }
+
   CompilerInstance Instance;
   PrintingDiagnosticConsumer PDC;
   Instance.addDiagnosticConsumer(&PDC);
@@ -1270,10 +1866,25 @@ int swift::performFrontend(ArrayRef<const char *> Args,
   if (Invocation.getFrontendOptions().DebugTimeCompilation)
     SharedTimer::enableCompilationTimers();
 
+  if (!Invocation.getFrontendOptions().TraceOutputPath.empty())
+    trace::enable();
+
+  if (!Invocation.getFrontendOptions().StatsOutputDir.empty()) {
+    stats::enable();
+    SILPassManager::setRecordPassTimeTotals(true);
+    if (!serialization::DeserializationStats::isEnabled())
+      serialization::DeserializationStats::enable(0);
+  }
+
   if (Invocation.getFrontendOptions().PrintStats) {
     llvm::EnableStatistics();
   }
 
+  if (Invocation.getFrontendOptions().PrintDeserializationStats) {
+    serialization::DeserializationStats::enable(
+        Invocation.getFrontendOptions().NumExpensiveDeserializedDecls);
+  }
+
   const DiagnosticOptions &diagOpts = Invocation.getDiagnosticOptions();
   if (diagOpts.VerifyMode != DiagnosticOptions::NoVerify) {
     enableDiagnosticVerifier(Instance.getSourceMgr());
@@ -1289,6 +1900,9 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     return 1;
   }
 
+  if (Invocation.getFrontendOptions().PrintASTMemoryStats)
+    Instance.getASTContext().enableASTMemoryStats();
+
   // The compiler instance has been configured; notify our observer.
   if (observer) {
     observer->configuredCompiler(Instance);
@@ -1299,6 +1913,13 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     performCompile(Instance, Invocation, Args, ReturnValue, observer) ||
     Instance.getASTContext().hadError();
 
+  if (Invocation.getFrontendOptions().PrintDeserializationStats)
+    serialization::printDeserializationStats(Instance.getASTContext(),
+                                             llvm::errs());
+
+  if (Invocation.getFrontendOptions().PrintASTMemoryStats)
+    Instance.getASTContext().printASTMemoryStats(llvm::errs());
+
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
     HadError = dumpAPI(Instance.getMainModule(),
                        Invocation.getFrontendOptions().DumpAPIPath);
@@ -1319,6 +1940,20 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     }
   }
 
+  if (!Invocation.getFrontendOptions().StatsOutputDir.empty())
+    HadError |= writeStatsFile(Instance, Invocation);
+
+  const std::string &TraceOutputPath =
+    Invocation.getFrontendOptions().TraceOutputPath;
+  if (!TraceOutputPath.empty()) {
+    std::string ErrorMsg;
+    if (trace::writeEvents(TraceOutputPath, ErrorMsg)) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::error_opening_output,
+                                   TraceOutputPath, ErrorMsg);
+      HadError = true;
+    }
+  }
+
   return (HadError ? 1 : ReturnValue);
 }
 
@@ -1,7 +1,9 @@
 #include "swift/IDE/CodeCompletionCache.h"
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -161,13 +163,21 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   (void)stringCount; // so it is not seen as "unused" in release builds.
   
   // STRINGS
+  // Many results share strings such as the module name and common type names,
+  // so copy each string out of the buffer only once.
+  llvm::DenseMap<uint32_t, StringRef> knownStrings;
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
       return "";
 
+    auto &known = knownStrings[index];
+    if (known.data())
+      return known;
+
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    known = copyString(*V.Sink.Allocator, StringRef(p, size));
+    return known;
   };
 
   // CHUNKS
@@ -272,6 +282,8 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///
 ///   STRINGS
 ///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * Chunk text, module names and brief comments are shared between all
+///       the places that refer to them.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
                               CodeCompletionCache::Value &V) {
@@ -321,6 +333,20 @@ static void writeCachedModule(llvm::raw_ostream &out,
     return static_cast<uint32_t>(size);
   };
 
+  // Strings that are referenced on their own (rather than as part of a run of
+  // consecutive strings) are written once and shared.
+  llvm::StringMap<uint32_t> sharedStrings;
+  auto addSharedString = [&](StringRef str) {
+    if (str.empty())
+      return ~0u;
+    auto known = sharedStrings.find(str);
+    if (known != sharedStrings.end())
+      return known->second;
+    auto index = addString(str);
+    sharedStrings[str] = index;
+    return index;
+  };
+
   auto addCompletionString = [&](const CodeCompletionString *str) {
     auto size = chunks.tell();
     chunksLE.write(static_cast<uint32_t>(str->getChunks().size()));
@@ -329,7 +355,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
       chunksLE.write(static_cast<uint8_t>(chunk.getNestingLevel()));
       chunksLE.write(static_cast<uint8_t>(chunk.isAnnotation()));
       if (chunk.hasText()) {
-        chunksLE.write(addString(chunk.getText()));
+        chunksLE.write(addSharedString(chunk.getText()));
       } else {
         chunksLE.write(static_cast<uint32_t>(~0u));
       }
@@ -356,8 +382,8 @@ static void writeCachedModule(llvm::raw_ostream &out,
       LE.write(static_cast<uint8_t>(R->getNumBytesToErase()));
       LE.write(
           static_cast<uint32_t>(addCompletionString(R->getCompletionString())));
-      LE.write(addString(R->getModuleName()));      // index into strings
-      LE.write(addString(R->getBriefDocComment())); // index into strings
+      LE.write(addSharedString(R->getModuleName()));      // index into strings
+      LE.write(addSharedString(R->getBriefDocComment())); // index into strings
       LE.write(static_cast<uint32_t>(R->getAssociatedUSRs().size()));
       if (R->getAssociatedUSRs().empty()) {
         LE.write(static_cast<uint32_t>(~0u));
@@ -211,6 +211,11 @@ private:
     if (declRef.getNextOverriddenVTableEntry())
       return;
 
+    // If every call to the method is resolved statically, it doesn't need an
+    // entry either.
+    if (canOmitVTableEntry(IGM, declRef))
+      return;
+
     // Both static and non-static functions go in the metadata.
     asImpl().addMethod(declRef);
   }
@@ -2476,6 +2476,8 @@ llvm::GlobalValue *IRGenModule::defineTypeMetadata(CanType concreteType,
   var->setConstant(isConstant);
   if (!section.empty())
     var->setSection(section);
+  noteMetadataSize(concreteType->getAnyNominal(),
+                   MetadataSizeKind::TypeMetadata, var);
   
   // Replace the placeholder if we were given one.
   if (replace) {
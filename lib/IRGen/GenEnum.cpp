@@ -94,7 +94,9 @@
 //
 //  For all lowerings except ResilientEnumImplStrategy, the primary enum
 //  operations are open-coded at usage sites. Resilient enums are accessed
-//  by invoking the value witnesses for these operations.
+//  by invoking the value witnesses for these operations. Multi-payload enums
+//  with many cases compute the case index in an outlined helper function,
+//  so that switches over them become a single dense switch on that index.
 //
 //===----------------------------------------------------------------------===//
 
@@ -2981,6 +2983,15 @@ namespace {
     ReferenceCounting Refcounting;
     bool AllowFixedLayoutOptimizations;
 
+    /// Enums with more cases than this compute their case index in an
+    /// outlined function instead of open-coding the tag and payload tests
+    /// at every switch and getEnumTag.
+    static const unsigned OutlinedCaseIndexThreshold = 16;
+
+    /// The lazily-created function computing the case index of a loadable
+    /// value of this enum; see getCaseIndexFunction.
+    mutable llvm::Function *CaseIndexFn = nullptr;
+
     static EnumPayloadSchema getPayloadSchema(ArrayRef<Element> payloads) {
       // TODO: We might be able to form a nicer schema if the payload elements
       // share a schema. For now just use a generic schema.
@@ -3275,36 +3286,72 @@ namespace {
       return loadDynamicTag(IGF, addr, T);
     }
 
-  public:
+    /// Whether switches and tag queries should call the outlined case index
+    /// function rather than open-coding the tests.
+    bool shouldOutlineCaseIndex() const {
+      return TIK >= Loadable && ElementsWithPayload.size()
+               + ElementsWithNoPayload.size() > OutlinedCaseIndexThreshold;
+    }
+
+    /// Returns a function taking the explosion of a value of this enum and
+    /// returning its tag index in the range [0..NumElements-1].
+    llvm::Function *getCaseIndexFunction(IRGenModule &IGM) const {
+      if (CaseIndexFn)
+        return CaseIndexFn;
+
+      ExplosionSchema schema;
+      getSchema(schema);
+      SmallVector<llvm::Type *, 4> argTys;
+      for (auto &elt : schema)
+        argTys.push_back(elt.getScalarType());
+
+      auto fnTy = llvm::FunctionType::get(IGM.Int32Ty, argTys, false);
+      llvm::SmallString<64> name;
+      name += "__swift_get_enum_case_index_";
+      name += getStorageType()->getName();
+      CaseIndexFn = llvm::Function::Create(fnTy,
+                                           llvm::GlobalValue::PrivateLinkage,
+                                           name.str(), &IGM.Module);
+      CaseIndexFn->setCallingConv(IGM.DefaultCC);
+      CaseIndexFn->setDoesNotThrow();
+      CaseIndexFn->setDoesNotAccessMemory();
+
+      IRGenFunction IGF(IGM, CaseIndexFn);
+      if (IGM.DebugInfo)
+        IGM.DebugInfo->emitArtificialFunction(IGF, CaseIndexFn);
+
+      Explosion params = IGF.collectParameters();
+      auto parts = destructureLoadableEnum(IGF, params);
+      llvm::Value *tag = emitFixedGetEnumTag(IGF, parts.payload,
+                                             parts.extraTagBits);
+      tag = IGF.Builder.CreateAdd(tag,
+                          llvm::ConstantInt::get(IGM.Int32Ty,
+                                                 ElementsWithPayload.size()));
+      IGF.Builder.CreateRet(tag);
+      return CaseIndexFn;
+    }
+
+    /// Call the outlined case index function on the given explosion.
+    llvm::Value *emitCaseIndexCall(IRGenFunction &IGF,
+                                   Explosion &value) const {
+      auto fn = getCaseIndexFunction(IGF.IGM);
+      auto args = value.claim(getExplosionSize());
+      auto call = IGF.Builder.CreateCall(fn, args);
+      call->setCallingConv(fn->getCallingConv());
+      call->setDoesNotThrow();
+      return call;
+    }
 
     /// Returns a tag index in the range
-    /// [-ElementsWithPayload..ElementsWithNoPayload+1].
-    llvm::Value *
-    emitGetEnumTag(IRGenFunction &IGF, SILType T, Address addr)
-    const override {
+    /// [-ElementsWithPayload..ElementsWithNoPayload+1] for a fixed-size
+    /// value of this enum.
+    llvm::Value *emitFixedGetEnumTag(IRGenFunction &IGF,
+                                     EnumPayload payload,
+                                     llvm::Value *extraTagBits) const {
       unsigned numPayloadCases = ElementsWithPayload.size();
       llvm::Constant *payloadCases =
           llvm::ConstantInt::get(IGF.IGM.Int32Ty, numPayloadCases);
 
-      if (TIK < Fixed) {
-        // Ask the runtime to extract the dynamically-placed tag.
-        llvm::Value *tagValue = loadDynamicTag(IGF, addr, T);
-
-        // Convert fragile tag index into resilient tag index.
-        return IGF.Builder.CreateSub(tagValue, payloadCases);
-      }
-
-      // For fixed-size enums, the currently inhabited case is a function of
-      // both the payload tag and the payload value.
-      //
-      // Low-numbered payload tags correspond to payload cases. No-payload
-      // cases are represented with the remaining payload tags.
-
-      // Load the fixed-size representation and derive the tags.
-      EnumPayload payload; llvm::Value *extraTagBits;
-      std::tie(payload, extraTagBits)
-        = emitPrimitiveLoadPayloadAndExtraTag(IGF, addr);
-
       // Load the payload tag.
       llvm::Value *tagValue = extractPayloadTag(IGF, payload, extraTagBits);
       tagValue = IGF.Builder.CreateZExtOrTrunc(tagValue, IGF.IGM.Int32Ty);
@@ -3367,6 +3414,45 @@ namespace {
       return IGF.Builder.CreateSelect(match, currentCase, tagValue);
     }
 
+  public:
+
+    /// Returns a tag index in the range
+    /// [-ElementsWithPayload..ElementsWithNoPayload+1].
+    llvm::Value *
+    emitGetEnumTag(IRGenFunction &IGF, SILType T, Address addr)
+    const override {
+      unsigned numPayloadCases = ElementsWithPayload.size();
+      llvm::Constant *payloadCases =
+          llvm::ConstantInt::get(IGF.IGM.Int32Ty, numPayloadCases);
+
+      if (TIK < Fixed) {
+        // Ask the runtime to extract the dynamically-placed tag.
+        llvm::Value *tagValue = loadDynamicTag(IGF, addr, T);
+
+        // Convert fragile tag index into resilient tag index.
+        return IGF.Builder.CreateSub(tagValue, payloadCases);
+      }
+
+      if (shouldOutlineCaseIndex()) {
+        Explosion value;
+        loadForSwitch(IGF, addr, value);
+        return IGF.Builder.CreateSub(emitCaseIndexCall(IGF, value),
+                                     payloadCases);
+      }
+
+      // For fixed-size enums, the currently inhabited case is a function of
+      // both the payload tag and the payload value.
+      //
+      // Low-numbered payload tags correspond to payload cases. No-payload
+      // cases are represented with the remaining payload tags.
+
+      // Load the fixed-size representation and derive the tags.
+      EnumPayload payload; llvm::Value *extraTagBits;
+      std::tie(payload, extraTagBits)
+        = emitPrimitiveLoadPayloadAndExtraTag(IGF, addr);
+      return emitFixedGetEnumTag(IGF, payload, extraTagBits);
+    }
+
     llvm::Value *
     emitIndirectCaseTest(IRGenFunction &IGF, SILType T,
                          Address enumAddr,
@@ -3466,6 +3552,27 @@ namespace {
       auto isUnreachable =
         defaultDest == unreachableBB ? IsUnreachable : IsNotUnreachable;
 
+      // For large enums, compute the case index out of line and switch on it
+      // densely.
+      if (shouldOutlineCaseIndex()) {
+        auto caseIndex = emitCaseIndexCall(IGF, value);
+        auto tagSwitch = SwitchBuilder::create(IGF, caseIndex,
+                                 SwitchDefaultDest(defaultDest, isUnreachable),
+                                 dests.size());
+        for (auto &dest : dests)
+          tagSwitch->addCase(llvm::ConstantInt::get(IGF.IGM.Int32Ty,
+                                                    getTagIndex(dest.first)),
+                             dest.second);
+
+        if (unreachableBB->use_empty()) {
+          delete unreachableBB;
+        } else {
+          IGF.Builder.emitBlock(unreachableBB);
+          IGF.Builder.CreateUnreachable();
+        }
+        return;
+      }
+
       auto parts = destructureAndTagLoadableEnum(IGF, value);
 
       // Figure out how many branches we have for the tag switch.
@@ -1131,6 +1131,68 @@ void IRGenFunction::emitNativeStrongRelease(llvm::Value *value,
                         value);
 }
 
+/// Spill some references to a stack buffer and pass it to a runtime
+/// function that retains or releases each of them.
+static void emitRefCountArrayCall(IRGenFunction &IGF, llvm::Constant *fn,
+                                  ArrayRef<llvm::Value *> values) {
+  auto &IGM = IGF.IGM;
+  Size bufferSize = IGM.getPointerSize() * values.size();
+  Address buffer = IGF.createAlloca(IGM.RefCountedPtrTy,
+                                    IGM.getSize(Size(values.size())),
+                                    IGM.getPointerAlignment(),
+                                    "refcounted.batch");
+  IGF.Builder.CreateLifetimeStart(buffer, bufferSize);
+  for (unsigned i = 0, e = values.size(); i != e; ++i) {
+    llvm::Value *value = values[i];
+    if (value->getType() != IGM.RefCountedPtrTy)
+      value = IGF.Builder.CreateBitCast(value, IGM.RefCountedPtrTy);
+    IGF.Builder.CreateStore(value,
+        IGF.Builder.CreateConstArrayGEP(buffer, i, IGM.getPointerSize()));
+  }
+
+  llvm::CallInst *call = IGF.Builder.CreateCall(fn,
+                             {buffer.getAddress(),
+                              IGM.getSize(Size(values.size()))});
+  call->setDoesNotThrow();
+  IGF.Builder.CreateLifetimeEnd(buffer, bufferSize);
+}
+
+/// Retain several native references.  A handful of references are
+/// retained individually, which keeps them visible to the LLVM ARC
+/// optimizer.
+void IRGenFunction::emitNativeStrongRetainArray(
+                                            ArrayRef<llvm::Value *> values) {
+  SmallVector<llvm::Value *, 16> refCounted;
+  for (auto value : values)
+    if (!doesNotRequireRefCounting(value))
+      refCounted.push_back(value);
+
+  if (refCounted.size() < 2) {
+    for (auto value : refCounted)
+      emitNativeStrongRetain(value);
+    return;
+  }
+  emitRefCountArrayCall(*this, IGM.getNativeStrongRetainArrayFn(),
+                        refCounted);
+}
+
+/// Release several native references.
+void IRGenFunction::emitNativeStrongReleaseArray(
+                                            ArrayRef<llvm::Value *> values) {
+  SmallVector<llvm::Value *, 16> refCounted;
+  for (auto value : values)
+    if (!doesNotRequireRefCounting(value))
+      refCounted.push_back(value);
+
+  if (refCounted.size() < 2) {
+    for (auto value : refCounted)
+      emitNativeStrongRelease(value);
+    return;
+  }
+  emitRefCountArrayCall(*this, IGM.getNativeStrongReleaseArrayFn(),
+                        refCounted);
+}
+
 void IRGenFunction::emitNativeSetDeallocating(llvm::Value *value) {
   if (doesNotRequireRefCounting(value)) return;
   emitUnaryRefCountCall(*this, IGM.getNativeSetDeallocatingFn(), value);
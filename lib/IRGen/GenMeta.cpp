@@ -449,11 +449,79 @@ bool irgen::hasKnownVTableEntry(IRGenModule &IGM,
   return theClass->hasKnownSwiftImplementation();
 }
 
+/// Can the vtable entry for the given method be left out of the class
+/// metadata, because every call can be resolved statically?
+///
+/// In whole-module optimized builds, this is the case for methods that no
+/// subclass overrides if the class isn't visible outside the module. Other
+/// modules then never compute the layout of the class's vtable, and calls
+/// through the vtable can use the method's implementation directly.
+bool irgen::canOmitVTableEntry(IRGenModule &IGM, SILDeclRef method) {
+  if (!IGM.IRGen.Opts.Optimize || !IGM.getSILModule().isWholeModule())
+    return false;
+
+  // Accessors and initializers can be overridden through their storage or
+  // required initializers; only handle plain methods.
+  if (method.kind != SILDeclRef::Kind::Func)
+    return false;
+  auto fn = dyn_cast<FuncDecl>(method.getDecl());
+  if (!fn || fn->isAccessor() || fn->isDynamic() || fn->isOverridden())
+    return false;
+
+  auto theClass = dyn_cast<ClassDecl>(fn->getDeclContext());
+  if (!theClass || theClass->getModuleContext() != IGM.getSwiftModule())
+    return false;
+
+  // This also covers @testable and @_versioned classes, whose layout other
+  // modules may compute.
+  if (theClass->getEffectiveAccess() > Accessibility::Internal)
+    return false;
+
+  // We need an implementation to call instead.
+  return IGM.getSILModule().lookUpFunctionInVTable(theClass, method) != nullptr;
+}
+
+/// Can the metadata of the given class be emitted completely at compile time,
+/// so that accessing it doesn't require any runtime initialization?
+///
+/// This is only done with -emit-static-class-metadata, and only without
+/// Objective-C interop, since otherwise the class has to be realized by the
+/// Objective-C runtime on first use.
+static bool isClassMetadataStaticallyComplete(IRGenModule &IGM,
+                                              ClassDecl *theClass) {
+  if (!IGM.IRGen.Opts.EmitStaticClassMetadata || IGM.ObjCInterop)
+    return false;
+
+  // We only know the layout of classes in this module.
+  if (theClass->isGenericContext() || theClass->hasClangNode() ||
+      theClass->getModuleContext() != IGM.getSwiftModule())
+    return false;
+
+  // This includes a non-constant parent type and resilient or non-fixed-size
+  // fields in the class hierarchy.
+  if (doesClassMetadataRequireDynamicInitialization(IGM, theClass))
+    return false;
+
+  // The superclass must be complete too, so that we can reference it as a
+  // constant.
+  if (theClass->hasSuperclass()) {
+    auto superclass = theClass->getSuperclass()->getClassOrBoundGenericClass();
+    return isClassMetadataStaticallyComplete(IGM, superclass);
+  }
+
+  return true;
+}
+
 /// Is it basically trivial to access the given metadata?  If so, we don't
 /// need a cache variable in its accessor.
 bool irgen::isTypeMetadataAccessTrivial(IRGenModule &IGM, CanType type) {
   assert(!type->hasArchetype());
 
+  // Class metadata which is complete at compile time can be referenced
+  // directly.
+  if (auto classType = dyn_cast<ClassType>(type))
+    return isClassMetadataStaticallyComplete(IGM, classType->getDecl());
+
   // Value type metadata only requires dynamic initialization on first
   // access if it contains a resilient type.
   if (isa<StructType>(type) || isa<EnumType>(type)) {
@@ -1170,6 +1238,24 @@ static llvm::Value *emitGenericMetadataAccessFunction(IRGenFunction &IGF,
   assert(genericArgs.Values.size() == genericArgs.Types.size());
   assert(genericArgs.Values.size() > 0 && "no generic args?!");
 
+  // With one or two arguments, pass them directly to a specialized entry
+  // point instead of going through a buffer.
+  if (genericArgs.Values.size() <= 2) {
+    SmallVector<llvm::Value *, 3> callArgs;
+    callArgs.push_back(metadata);
+    for (auto arg : genericArgs.Values)
+      callArgs.push_back(IGF.Builder.CreateBitCast(arg, IGF.IGM.Int8PtrTy));
+
+    auto fn = genericArgs.Values.size() == 1
+                ? IGF.IGM.getGetGenericMetadata1Fn()
+                : IGF.IGM.getGetGenericMetadata2Fn();
+    auto result = IGF.Builder.CreateCall(fn, callArgs);
+    result->setDoesNotThrow();
+    result->addAttribute(llvm::AttributeSet::FunctionIndex,
+                         llvm::Attribute::ReadOnly);
+    return result;
+  }
+
   // Slam that information directly into the generic arguments buffer.
   auto argsBufferTy =
     llvm::StructType::get(IGF.IGM.LLVMContext, genericArgs.Types);
@@ -3679,11 +3765,10 @@ namespace {
     }
 
     bool canBeConstant() {
-      // TODO: the metadata global can actually be constant in a very
-      // special case: it's not a pattern, ObjC interoperation isn't
-      // required, there are no class fields, and there is nothing that
-      // needs to be runtime-adjusted.
-      return false;
+      // The metadata global can be constant if nothing needs to be
+      // runtime-adjusted and ObjC interoperation isn't required.
+      return !HasUnfilledSuperclass && !HasUnfilledParent &&
+             isClassMetadataStaticallyComplete(IGM, Target);
     }
 
     void createMetadataAccessFunction() {
@@ -4671,6 +4756,16 @@ llvm::Value *irgen::emitVirtualMethodValue(IRGenFunction &IGF,
   auto fnTy = IGF.IGM.getFunctionType(methodType, attrs)->getPointerTo();
 
   auto declaringClass = cast<ClassDecl>(overridden.getDecl()->getDeclContext());
+
+  // If the method has no vtable entry, nothing overrides it, so we can call
+  // its implementation directly.
+  if (canOmitVTableEntry(IGF.IGM, overridden)) {
+    SILFunction *impl = IGF.IGM.getSILModule().lookUpFunctionInVTable(
+        declaringClass, overridden);
+    auto fn = IGF.IGM.getAddrOfSILFunction(impl, NotForDefinition);
+    return IGF.Builder.CreateBitCast(fn, fnTy);
+  }
+
   auto index = FindClassMethodIndex(IGF.IGM, declaringClass, overridden)
                  .getTargetIndex();
 
@@ -5683,8 +5778,11 @@ namespace {
         // Unused padding
         addConstantInt32(0);
 
+        // The default witnesses are relative references, so the dynamic
+        // linker doesn't have to rebase them.
         for (auto entry : DefaultWitnesses->getResilientDefaultEntries()) {
-          addWord(IGM.getAddrOfSILFunction(entry.getWitness(), NotForDefinition));
+          addRelativeAddress(IGM.getAddrOfSILFunction(entry.getWitness(),
+                                                      NotForDefinition));
         }
       } else {
         addConstantInt16(0);
@@ -5699,6 +5797,22 @@ namespace {
       return getInitWithSuggestedType(NumProtocolDescriptorFields,
                                       IGM.ProtocolDescriptorStructTy);
     }
+
+    void emit() {
+      // Set up a dummy global to stand in for the constant.
+      auto tempBase = createTemporaryRelativeAddressBase(IGM);
+      setRelativeAddressBase(tempBase.get());
+      layout();
+      auto init = getInit();
+
+      auto var = cast<llvm::GlobalVariable>(
+                   IGM.getAddrOfProtocolDescriptor(Protocol, ForDefinition,
+                                                   init->getType()));
+      var->setConstant(true);
+      var->setInitializer(init);
+
+      replaceTemporaryRelativeAddressBase(IGM, std::move(tempBase), var);
+    }
   };
 } // end anonymous namespace
 
@@ -5730,14 +5844,7 @@ void IRGenModule::emitProtocolDecl(ProtocolDecl *protocol) {
   if (!protocol->hasFixedLayout())
     defaultWitnesses = getSILModule().lookUpDefaultWitnessTable(protocol);
   ProtocolDescriptorBuilder builder(*this, protocol, defaultWitnesses);
-  builder.layout();
-
-  auto init = builder.getInit();
-  auto var = cast<llvm::GlobalVariable>(
-                       getAddrOfProtocolDescriptor(protocol, ForDefinition,
-                                                   init->getType()));
-  var->setConstant(true);
-  var->setInitializer(init);
+  builder.emit();
 }
 
 /// \brief Load a reference to the protocol descriptor for the given protocol.
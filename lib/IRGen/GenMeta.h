@@ -65,6 +65,10 @@ namespace irgen {
   /// Is the given method known to be callable by vtable dispatch?
   bool hasKnownVTableEntry(IRGenModule &IGM, AbstractFunctionDecl *theMethod);
 
+  /// Can the vtable entry for the given method be left out of the class
+  /// metadata, because every call can be resolved statically?
+  bool canOmitVTableEntry(IRGenModule &IGM, SILDeclRef method);
+
   /// Emit the body of a lazy cache access function.
   void emitLazyCacheAccessFunction(IRGenModule &IGM,
                                    llvm::Function *accessor,
@@ -1787,6 +1787,8 @@ void IRGenModule::emitSILWitnessTable(SILWitnessTable *wt) {
   global->setConstant(true);
   global->setInitializer(initializer);
   global->setAlignment(getWitnessTableAlignment().getValue());
+  noteMetadataSize(wt->getConformance()->getType()->getAnyNominal(),
+                   MetadataSizeKind::WitnessTable, global);
 
   // FIXME: resilience; this should use the conformance's publishing scope.
   wtableBuilder.buildAccessFunction(global);
@@ -453,12 +453,54 @@ private:
     }
   }
 
+  /// Is this field a single native Swift reference, which can be retained
+  /// and released together with the struct's other native references?
+  static bool isBatchableRefCountedField(const FieldImpl &field) {
+    return field.getTypeInfo()
+        .isSingleSwiftRetainablePointer(ResilienceExpansion::Maximal);
+  }
+
+  /// Records with this many native references retain and release them
+  /// with one runtime call instead of one call per field.
+  enum : unsigned { MinBatchedRefCountedFields = 8 };
+
+  bool shouldBatchRefCounting(Atomicity atomicity) const {
+    if (atomicity != Atomicity::Atomic)
+      return false;
+    unsigned numRefCounted = 0;
+    for (auto &field : getFields())
+      if (isBatchableRefCountedField(field))
+        ++numRefCounted;
+    return numRefCounted >= MinBatchedRefCountedFields;
+  }
+
 public:
   using super::getFields;
 
   void loadAsCopy(IRGenFunction &IGF, Address addr,
                   Explosion &out) const override {
-    forAllFields<&LoadableTypeInfo::loadAsCopy>(IGF, addr, out);
+    if (!shouldBatchRefCounting(Atomicity::Atomic)) {
+      forAllFields<&LoadableTypeInfo::loadAsCopy>(IGF, addr, out);
+      return;
+    }
+
+    // Load the native references without retaining them, then retain
+    // them all at once.
+    SmallVector<llvm::Value *, 16> batched;
+    auto offsets = asImpl().getNonFixedOffsets(IGF);
+    for (auto &field : getFields()) {
+      if (field.isEmpty()) continue;
+
+      Address fieldAddr = field.projectAddress(IGF, addr, offsets);
+      auto &fieldTI = cast<LoadableTypeInfo>(field.getTypeInfo());
+      if (isBatchableRefCountedField(field)) {
+        fieldTI.loadAsTake(IGF, fieldAddr, out);
+        batched.push_back(out.getAll().back());
+      } else {
+        fieldTI.loadAsCopy(IGF, fieldAddr, out);
+      }
+    }
+    IGF.emitNativeStrongRetainArray(batched);
   }
 
   void loadAsTake(IRGenFunction &IGF, Address addr,
@@ -487,16 +529,45 @@ public:
 
   void copy(IRGenFunction &IGF, Explosion &src,
             Explosion &dest, Atomicity atomicity) const override {
-    for (auto &field : getFields())
-      cast<LoadableTypeInfo>(field.getTypeInfo())
-          .copy(IGF, src, dest, Atomicity::Atomic);
+    if (!shouldBatchRefCounting(atomicity)) {
+      for (auto &field : getFields())
+        cast<LoadableTypeInfo>(field.getTypeInfo())
+            .copy(IGF, src, dest, Atomicity::Atomic);
+      return;
+    }
+
+    SmallVector<llvm::Value *, 16> batched;
+    for (auto &field : getFields()) {
+      if (isBatchableRefCountedField(field)) {
+        auto value = src.claimNext();
+        batched.push_back(value);
+        dest.add(value);
+      } else {
+        cast<LoadableTypeInfo>(field.getTypeInfo())
+            .copy(IGF, src, dest, Atomicity::Atomic);
+      }
+    }
+    IGF.emitNativeStrongRetainArray(batched);
   }
 
   void consume(IRGenFunction &IGF, Explosion &src,
                Atomicity atomicity) const override {
-    for (auto &field : getFields())
-      cast<LoadableTypeInfo>(field.getTypeInfo())
-          .consume(IGF, src, Atomicity::Atomic);
+    if (!shouldBatchRefCounting(atomicity)) {
+      for (auto &field : getFields())
+        cast<LoadableTypeInfo>(field.getTypeInfo())
+            .consume(IGF, src, Atomicity::Atomic);
+      return;
+    }
+
+    SmallVector<llvm::Value *, 16> batched;
+    for (auto &field : getFields()) {
+      if (isBatchableRefCountedField(field))
+        batched.push_back(src.claimNext());
+      else
+        cast<LoadableTypeInfo>(field.getTypeInfo())
+            .consume(IGF, src, Atomicity::Atomic);
+    }
+    IGF.emitNativeStrongReleaseArray(batched);
   }
 
   void fixLifetime(IRGenFunction &IGF, Explosion &src) const override {
@@ -504,7 +504,9 @@ public:
     auto entity = LinkEntity::forReflectionFieldDescriptor(
         NTD->getDeclaredType()->getCanonicalType());
     auto section = IGM.getFieldTypeMetadataSectionName();
-    return ReflectionMetadataBuilder::emit(entity, section);
+    auto var = ReflectionMetadataBuilder::emit(entity, section);
+    IGM.noteMetadataSize(NTD, MetadataSizeKind::FieldDescriptor, var);
+    return var;
   }
 };
 
@@ -1184,6 +1184,7 @@ TypeCacheEntry TypeConverter::getTypeEntry(CanType canonicalTy) {
   if (!convertedTI->NextConverted) {
     convertedTI->NextConverted = FirstType;
     FirstType = convertedTI;
+    IGM.IRGen.noteTypeConverted(exemplarTy);
   }
 
   return convertedTI;
@@ -1355,6 +1355,46 @@ static void addValueWitnessesForAbstractType(IRGenModule &IGM,
                     concreteLoweredType, concreteTI, witnesses);
 }
 
+/// Returns one of the value witness tables exported by the runtime for
+/// arbitrary POD data with the size and alignment of \p ti, or null if the
+/// runtime doesn't provide a table for this layout.
+static llvm::Constant *getAddrOfKnownValueWitnessTable(IRGenModule &IGM,
+                                                       const FixedTypeInfo &ti) {
+  if (!ti.isPOD(ResilienceExpansion::Maximal) ||
+      !ti.isBitwiseTakable(ResilienceExpansion::Maximal) ||
+      ti.getFixedExtraInhabitantCount(IGM) != 0)
+    return nullptr;
+
+  ASTContext &C = IGM.Context;
+  unsigned size = ti.getFixedSize().getValue();
+  unsigned align = ti.getFixedAlignment().getValue();
+  if (size == 0)
+    return IGM.getAddrOfValueWitnessTable(C.TheEmptyTupleType);
+
+  if (   (size ==  1 && align ==  1)
+      || (size ==  2 && align ==  2)
+      || (size ==  4 && align ==  4)
+      || (size ==  8 && align ==  8)
+      || (size == 16 && align == 16)
+      || (size == 32 && align == 32))
+    return IGM.getAddrOfValueWitnessTable(
+                BuiltinIntegerType::get(size * 8, C)->getCanonicalType());
+
+  // The runtime also exports tables for tuples of two to four 4- or 8-byte
+  // integers, which cover structs of a few word-sized fields.
+  if ((align == 4 || align == 8) && size % align == 0) {
+    unsigned count = size / align;
+    if (count >= 2 && count <= 4) {
+      Type eltTy = BuiltinIntegerType::get(align * 8, C);
+      SmallVector<TupleTypeElt, 4> elts(count, TupleTypeElt(eltTy));
+      return IGM.getAddrOfValueWitnessTable(
+                                 TupleType::get(elts, C)->getCanonicalType());
+    }
+  }
+
+  return nullptr;
+}
+
 /// Emit a value-witness table for the given type, which is assumed to
 /// be non-dependent.
 llvm::Constant *irgen::emitValueWitnessTable(IRGenModule &IGM,
@@ -1363,6 +1403,17 @@ llvm::Constant *irgen::emitValueWitnessTable(IRGenModule &IGM,
   assert(!isa<BoundGenericType>(abstractType) &&
          "emitting VWT for generic instance");
 
+  // In optimized builds, share one of the runtime's tables between all
+  // layout-equivalent POD structs instead of emitting a table per type.
+  if (IGM.IRGen.Opts.Optimize &&
+      abstractType->getStructOrBoundGenericStruct()) {
+    auto &ti =
+      IGM.getTypeInfoForUnlowered(getFormalTypeInContext(abstractType));
+    if (auto fixedTI = dyn_cast<FixedTypeInfo>(&ti))
+      if (auto known = getAddrOfKnownValueWitnessTable(IGM, *fixedTI))
+        return llvm::ConstantExpr::getBitCast(known, IGM.WitnessTablePtrTy);
+  }
+
   SmallVector<llvm::Constant*, MaxNumValueWitnesses> witnesses;
   bool canBeConstant = false;
   addValueWitnessesForAbstractType(IGM, abstractType, witnesses, canBeConstant);
@@ -1374,6 +1425,8 @@ llvm::Constant *irgen::emitValueWitnessTable(IRGenModule &IGM,
   auto global = cast<llvm::GlobalVariable>(addr);
   global->setConstant(canBeConstant);
   global->setInitializer(table);
+  IGM.noteMetadataSize(abstractType->getAnyNominal(),
+                       MetadataSizeKind::ValueWitnessTable, global);
 
   return llvm::ConstantExpr::getBitCast(global, IGM.WitnessTablePtrTy);
 }
@@ -1391,23 +1444,8 @@ llvm::Constant *IRGenModule::emitFixedTypeLayout(CanType t,
   unsigned numExtraInhabitants = ti.getFixedExtraInhabitantCount(*this);
 
   // Try to use common type layouts exported by the runtime.
-  llvm::Constant *commonValueWitnessTable = nullptr;
-  if (pod && bt && numExtraInhabitants == 0) {
-    if (size == 0)
-      commonValueWitnessTable =
-        getAddrOfValueWitnessTable(Context.TheEmptyTupleType);
-    if (   (size ==  1 && align ==  1)
-        || (size ==  2 && align ==  2)
-        || (size ==  4 && align ==  4)
-        || (size ==  8 && align ==  8)
-        || (size == 16 && align == 16)
-        || (size == 32 && align == 32))
-      commonValueWitnessTable =
-        getAddrOfValueWitnessTable(BuiltinIntegerType::get(size * 8, Context)
-                                     ->getCanonicalType());
-  }
-
-  if (commonValueWitnessTable) {
+  if (auto commonValueWitnessTable = getAddrOfKnownValueWitnessTable(*this,
+                                                                     ti)) {
     auto index = llvm::ConstantInt::get(Int32Ty,
                                (unsigned)ValueWitness::First_TypeLayoutWitness);
     return llvm::ConstantExpr::getGetElementPtr(Int8PtrTy,
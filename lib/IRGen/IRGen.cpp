@@ -44,6 +44,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Path.h"
@@ -60,6 +61,7 @@
 #include "llvm/Object/ObjectFile.h"
 #include "IRGenModule.h"
 
+#include <chrono>
 #include <thread>
 
 using namespace swift;
@@ -691,6 +693,9 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
     setModuleFlags(IGM);
   }
 
+  if (Opts.PrintMetadataSizeReport)
+    irgen.printMetadataSizeReport(llvm::errs());
+
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
@@ -704,8 +709,20 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   return std::unique_ptr<llvm::Module>(IGM.releaseModule());
 }
 
+namespace {
+/// The time one thread of a multi-threaded compilation spent in LLVM.
+struct LLVMThreadTimes {
+  using Clock = std::chrono::steady_clock;
+
+  /// The wall time spent on each module, in the order they were compiled.
+  SmallVector<std::pair<IRGenModule *, Clock::duration>, 4> Modules;
+  Clock::duration Total = Clock::duration::zero();
+};
+} // end anonymous namespace
+
 static void ThreadEntryPoint(IRGenerator *irgen,
-                             llvm::sys::Mutex *DiagMutex, int ThreadIdx) {
+                             llvm::sys::Mutex *DiagMutex, int ThreadIdx,
+                             LLVMThreadTimes *Times) {
   while (IRGenModule *IGM = irgen->fetchFromQueue()) {
     DEBUG(
       DiagMutex->lock();
@@ -713,11 +730,15 @@ static void ThreadEntryPoint(IRGenerator *irgen,
           "\n";
       DiagMutex->unlock();
     );
+    auto Start = LLVMThreadTimes::Clock::now();
     embedBitcode(IGM->getModule(), irgen->Opts);
     performLLVM(irgen->Opts, IGM->Context.Diags, DiagMutex, IGM->ModuleHash,
                 IGM->getModule(), IGM->TargetMachine.get(),
                 IGM->Context.LangOpts.EffectiveLanguageVersion,
                 IGM->OutputFilename);
+    auto Elapsed = LLVMThreadTimes::Clock::now() - Start;
+    Times->Modules.push_back({IGM, Elapsed});
+    Times->Total += Elapsed;
     if (IGM->Context.Diags.hadAnyError())
       return;
   }
@@ -728,6 +749,52 @@ static void ThreadEntryPoint(IRGenerator *irgen,
   );
 }
 
+static double getSeconds(LLVMThreadTimes::Clock::duration D) {
+  return std::chrono::duration<double>(D).count();
+}
+
+/// Returns the number of LLVM instructions in \p M.
+static unsigned getInstructionCount(llvm::Module &M) {
+  unsigned Count = 0;
+  for (llvm::Function &F : M)
+    for (llvm::BasicBlock &BB : F)
+      Count += BB.size();
+  return Count;
+}
+
+/// Prints the time spent in IRGen and in each LLVM thread. The compilation
+/// takes as long as IRGen plus the longest thread.
+static void printParallelIRGenTimes(
+    IRGenerator &irgen, LLVMThreadTimes::Clock::duration IRGenTime,
+    ArrayRef<LLVMThreadTimes> Threads,
+    const llvm::DenseMap<IRGenModule *, unsigned> &InstructionCounts) {
+  llvm::raw_ostream &OS = llvm::errs();
+  OS << "===-- Parallel IRGen times --===\n";
+  OS << "IRGen: " << llvm::format("%.3f", getSeconds(IRGenTime)) << "s\n";
+
+  // Each module converts the types it uses to TypeInfos on its own.
+  auto Redundant = irgen.getRedundantTypeConversions();
+  OS << "types converted in more than one module: " << Redundant.first
+     << ", " << Redundant.second << " redundant conversions\n";
+
+  unsigned Longest = 0;
+  for (unsigned Idx = 0, e = Threads.size(); Idx != e; ++Idx) {
+    const LLVMThreadTimes &Thread = Threads[Idx];
+    if (Thread.Total > Threads[Longest].Total)
+      Longest = Idx;
+    OS << "thread " << Idx << ": "
+       << llvm::format("%.3f", getSeconds(Thread.Total)) << "s LLVM, "
+       << Thread.Modules.size() << " modules\n";
+    for (auto &Entry : Thread.Modules) {
+      OS << "  " << Entry.first->OutputFilename << ": "
+         << llvm::format("%.3f", getSeconds(Entry.second)) << "s, "
+         << InstructionCounts.lookup(Entry.first) << " instructions\n";
+    }
+  }
+  OS << "longest thread: " << Longest << ", "
+     << llvm::format("%.3f", getSeconds(Threads[Longest].Total)) << "s\n";
+}
+
 /// Generates LLVM IR, runs the LLVM passes and produces the output files.
 /// All this is done in multiple threads.
 static void performParallelIRGeneration(IRGenOptions &Opts,
@@ -735,6 +802,7 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
                                         SILModule *SILMod,
                                         StringRef ModuleName, int numThreads) {
 
+  auto IRGenStart = LLVMThreadTimes::Clock::now();
   IRGenerator irgen(Opts, *SILMod);
 
   // Enter a cleanup to delete all the IGMs and their associated LLVMContexts
@@ -792,6 +860,10 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
     return;
   }
 
+  // Spread the functions that don't belong to a source file, such as
+  // specializations of other modules' generics, over the IGMs.
+  irgen.partitionFunctionsWithoutSourceFile();
+
   // Emit the module contents.
   irgen.emitGlobalTopLevel();
   
@@ -904,21 +976,45 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  if (Opts.PrintMetadataSizeReport)
+    irgen.printMetadataSizeReport(llvm::errs());
+
+  // Start with the largest modules, so that a big one isn't left running on
+  // its own at the end.
+  irgen.sortQueueBySize();
+
+  auto IRGenTime = LLVMThreadTimes::Clock::now() - IRGenStart;
+
+  // Count the instructions before the LLVM passes change them.
+  llvm::DenseMap<IRGenModule *, unsigned> InstructionCounts;
+  if (Opts.DebugTimeParallelIRGen) {
+    for (auto it = irgen.begin(); it != irgen.end(); ++it) {
+      IRGenModule *IGM = it->second;
+      InstructionCounts[IGM] = getInstructionCount(*IGM->getModule());
+    }
+  }
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
+  // Each thread only writes its own entry.
+  std::vector<LLVMThreadTimes> Times(numThreads);
+
   // Start all the threads and do the LLVM compilation.
   for (int ThreadIdx = 1; ThreadIdx < numThreads; ++ThreadIdx) {
     Threads.push_back(std::thread(ThreadEntryPoint, &irgen, &DiagMutex,
-                                  ThreadIdx));
+                                  ThreadIdx, &Times[ThreadIdx]));
   }
 
-  ThreadEntryPoint(&irgen, &DiagMutex, 0);
+  ThreadEntryPoint(&irgen, &DiagMutex, 0, &Times[0]);
 
   // Wait for all threads.
   for (std::thread &Thread : Threads) {
     Thread.join();
   }
+
+  if (Opts.DebugTimeParallelIRGen)
+    printParallelIRGenTimes(irgen, IRGenTime, Times, InstructionCounts);
 }
 
 
@@ -28,6 +28,7 @@
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Punycode.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Timer.h"
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/SIL/SILArgument.h"
@@ -48,6 +49,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Local.h"
 
@@ -1453,7 +1455,7 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *Decl = StructTy->getDecl();
     auto L = getDebugLoc(SM, Decl);
     auto *File = getOrCreateFile(L.Filename);
-    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes)
+    if (shouldEmitMembers(Decl))
       return createStructType(DbgTy, Decl, StructTy, Scope, File, L.Line,
                               SizeInBits, AlignInBits, Flags,
                               nullptr, // DerivedFrom
@@ -1644,7 +1646,7 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *Decl = EnumTy->getDecl();
     auto L = getDebugLoc(SM, Decl);
     auto *File = getOrCreateFile(L.Filename);
-    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes)
+    if (shouldEmitMembers(Decl))
       return createEnumType(DbgTy, Decl, MangledName, Scope, File, L.Line,
                             Flags);
     else
@@ -1657,7 +1659,7 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *Decl = EnumTy->getDecl();
     auto L = getDebugLoc(SM, Decl);
     auto *File = getOrCreateFile(L.Filename);
-    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes)
+    if (shouldEmitMembers(Decl))
       return createEnumType(DbgTy, Decl, MangledName, Scope, File, L.Line,
                             Flags);
     else
@@ -1791,6 +1793,16 @@ llvm::DIType *IRGenDebugInfo::getTypeOrNull(TypeBase *Ty) {
   return nullptr;
 }
 
+bool IRGenDebugInfo::shouldEmitMembers(NominalTypeDecl *Decl) const {
+  if (Opts.DebugInfoKind <= IRGenDebugInfoKind::ASTTypes)
+    return false;
+
+  // The debugger can find the members of types from other modules through
+  // their mangled name, which is often all that a large module needs.
+  return !Opts.DebugInfoExternalTypeDecls ||
+         Decl->getModuleContext() == IGM.getSwiftModule();
+}
+
 llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
   // Is this an empty type?
   if (DbgTy.isNull())
@@ -1801,6 +1813,13 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
   if (auto *DITy = getTypeOrNull(DbgTy.getType()))
     return DITy;
 
+  // Only time the outermost type, the nested ones are part of it.
+  Optional<SharedTimer> Timer;
+  if (TypeCreationDepth == 0)
+    Timer.emplace("IRGen debug info");
+  llvm::SaveAndRestore<unsigned> Depth(TypeCreationDepth,
+                                       TypeCreationDepth + 1);
+
   // Second line of defense: Look up the mangled name. TypeBase*'s are
   // not necessarily unique, but name mangling is too expensive to do
   // every time.
@@ -1841,6 +1860,10 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
              "Unique identifier is different from mangled name ");
       DIRefMap[UID] = llvm::TrackingMDNodeRef(DITy);
     }
+  } else if (UID) {
+    // Also remember types without a unique identifier under their mangled
+    // name, so that other TypeBase*s for the same type don't build it again.
+    DIRefMap[UID] = llvm::TrackingMDNodeRef(DITy);
   }
 
   // Store it in the cache.
@@ -1851,6 +1874,7 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
 
 void IRGenDebugInfo::finalize() {
   assert(LocationStack.empty() && "Mismatch of pushLoc() and popLoc().");
+  SharedTimer timer("IRGen debug info");
 
   // Finalize all replaceable forward declarations.
   for (auto &Ty : ReplaceMap) {
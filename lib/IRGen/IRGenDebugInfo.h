@@ -82,6 +82,7 @@ class IRGenDebugInfo {
       nullptr;                          /// Scope of SWIFT_ENTRY_POINT_FUNCTION.
   TypeAliasDecl *MetadataTypeDecl;      /// The type decl for swift.type.
   llvm::DIType *InternalType; /// Catch-all type for opaque internal types.
+  unsigned TypeCreationDepth = 0; /// Nesting level of getOrCreateType.
 
   SILLocation::DebugLoc LastDebugLoc; /// The last location that was emitted.
   const SILDebugScope *LastScope;     /// The scope of that last location.
@@ -233,6 +234,9 @@ private:
   /// assumption that no two types that share the same canonical type
   /// can have different storage size or alignment.
   llvm::DIType *getOrCreateType(DebugTypeInfo DbgTy);
+  /// Whether the members of a nominal type are described as DWARF types, as
+  /// opposed to only referring to the type by its mangled name.
+  bool shouldEmitMembers(NominalTypeDecl *Decl) const;
   /// Translate a SILDebugScope into an llvm::DIDescriptor.
   llvm::DIScope *getOrCreateScope(const SILDebugScope *DS);
   /// Build the context chain for a given DeclContext.
@@ -298,6 +298,8 @@ public:
                               Atomicity atomicity = Atomicity::Atomic);
   void emitNativeStrongRelease(llvm::Value *value,
                                Atomicity atomicity = Atomicity::Atomic);
+  void emitNativeStrongRetainArray(ArrayRef<llvm::Value *> values);
+  void emitNativeStrongReleaseArray(ArrayRef<llvm::Value *> values);
   void emitNativeSetDeallocating(llvm::Value *value);
   //   - unowned references
   void emitNativeUnownedRetain(llvm::Value *value);
@@ -19,9 +19,13 @@
 #include "swift/AST/DiagnosticsIRGen.h"
 #include "swift/AST/IRGenOptions.h"
 #include "swift/Basic/Dwarf.h"
+#include "swift/Basic/Range.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Runtime/RuntimeFnWrappersGen.h"
 #include "swift/Runtime/Config.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
+#include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/TargetInfo.h"
@@ -40,6 +44,7 @@
 #include "llvm/IR/Type.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MD5.h"
 
 #include "GenEnum.h"
@@ -48,7 +53,9 @@
 #include "IRGenDebugInfo.h"
 #include "Linking.h"
 
+#include <algorithm>
 #include <initializer_list>
+#include <numeric>
 
 using namespace swift;
 using namespace irgen;
@@ -1118,3 +1125,181 @@ IRGenModule *IRGenerator::getGenModule(SILFunction *f) {
 
   return getPrimaryIGM();
 }
+
+/// Returns a rough estimate of the amount of code generated for \p f.
+static unsigned getCodeSize(SILFunction &f) {
+  unsigned size = 0;
+  for (auto &bb : f)
+    size += std::distance(bb.begin(), bb.end());
+  return size;
+}
+
+void IRGenerator::partitionFunctionsWithoutSourceFile() {
+  if (!hasMultipleIGMs())
+    return;
+
+  // Number the IGMs in queue order, so that ties are broken the same way in
+  // every compilation.
+  llvm::DenseMap<IRGenModule *, unsigned> IGMIndex;
+  for (unsigned i = 0, e = Queue.size(); i != e; ++i)
+    IGMIndex[Queue[i]] = i;
+
+  auto getSourceFileIndex = [&](SILFunction &f) -> Optional<unsigned> {
+    if (DeclContext *ctxt = f.getDeclContext())
+      if (SourceFile *SF = ctxt->getParentSourceFile()) {
+        auto found = GenModules.find(SF);
+        if (found != GenModules.end())
+          return IGMIndex[found->second];
+      }
+    return None;
+  };
+
+  // Start with the code that each IGM gets from its own source file.
+  SmallVector<unsigned, 8> Sizes(Queue.size(), 0);
+  unsigned TotalSize = 0;
+  for (SILFunction &f : SIL) {
+    if (!f.isDefinition())
+      continue;
+    unsigned size = getCodeSize(f);
+    TotalSize += size;
+    if (auto index = getSourceFileIndex(f))
+      Sizes[*index] += size;
+  }
+  // The preferred IGM may grow up to a quarter past the average size, or up
+  // to the size of the largest IGM, whichever is more.
+  unsigned Average = TotalSize / Queue.size();
+  unsigned Limit = Average + Average / 4;
+
+  // For each function, the number of references to it from each IGM.
+  llvm::DenseMap<SILFunction *, SmallVector<unsigned, 8>> References;
+  auto addReferences = [&](SILFunction &f, unsigned index) {
+    for (auto &bb : f)
+      for (auto &I : bb)
+        if (auto *FRI = dyn_cast<FunctionRefInst>(&I)) {
+          auto &counts = References[FRI->getReferencedFunction()];
+          if (counts.empty())
+            counts.resize(Queue.size(), 0);
+          ++counts[index];
+        }
+  };
+
+  // Visit callers before callees, so that a function's references are known
+  // by the time it is placed.
+  BasicCalleeAnalysis BCA(&SIL);
+  BottomUpFunctionOrder Order(SIL, &BCA);
+  auto SCCs = Order.getSCCs();
+  for (auto &SCC : reversed(SCCs)) {
+    SmallVector<unsigned, 8> Counts(Queue.size(), 0);
+    unsigned SCCSize = 0;
+    bool Placed = false;
+    for (SILFunction *f : SCC) {
+      if (!f->isDefinition())
+        continue;
+      auto found = References.find(f);
+      if (found != References.end())
+        for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+          Counts[i] += found->second[i];
+      if (getSourceFileIndex(*f))
+        Placed = true;
+      else
+        SCCSize += getCodeSize(*f);
+    }
+
+    // Functions in the same SCC as a function with a source file stay with
+    // it; otherwise prefer the IGM that references the SCC most.
+    unsigned Best = 0;
+    if (Placed) {
+      for (SILFunction *f : SCC)
+        if (auto index = getSourceFileIndex(*f)) {
+          Best = *index;
+          break;
+        }
+    } else {
+      Best = std::max_element(Counts.begin(), Counts.end()) - Counts.begin();
+      unsigned Largest = *std::max_element(Sizes.begin(), Sizes.end());
+      if (Counts[Best] == 0 ||
+          Sizes[Best] + SCCSize > std::max(Limit, Largest))
+        Best = std::min_element(Sizes.begin(), Sizes.end()) - Sizes.begin();
+    }
+
+    for (SILFunction *f : SCC) {
+      if (!f->isDefinition())
+        continue;
+      auto index = getSourceFileIndex(*f);
+      if (!index) {
+        DefaultIGMForFunction[f] = Queue[Best];
+        index = Best;
+      }
+      addReferences(*f, *index);
+    }
+    Sizes[Best] += SCCSize;
+  }
+}
+
+void IRGenerator::sortQueueBySize() {
+  auto getSize = [](IRGenModule *IGM) {
+    unsigned size = 0;
+    for (llvm::Function &F : *IGM->getModule())
+      for (llvm::BasicBlock &BB : F)
+        size += BB.size();
+    return size;
+  };
+
+  SmallVector<std::pair<unsigned, IRGenModule *>, 8> BySize;
+  for (IRGenModule *IGM : Queue)
+    BySize.push_back({getSize(IGM), IGM});
+  std::stable_sort(BySize.begin(), BySize.end(),
+                   [](const std::pair<unsigned, IRGenModule *> &LHS,
+                      const std::pair<unsigned, IRGenModule *> &RHS) {
+    return LHS.first > RHS.first;
+  });
+  for (unsigned i = 0, e = Queue.size(); i != e; ++i)
+    Queue[i] = BySize[i].second;
+}
+
+void IRGenModule::noteMetadataSize(const NominalTypeDecl *type,
+                                   MetadataSizeKind kind,
+                                   llvm::GlobalVariable *var) {
+  if (!IRGen.Opts.PrintMetadataSizeReport || !type || !var)
+    return;
+  IRGen.noteMetadataSize(type, kind,
+                         DataLayout.getTypeAllocSize(var->getValueType()));
+}
+
+void IRGenerator::printMetadataSizeReport(llvm::raw_ostream &os) const {
+  using Sizes = std::array<uint64_t, NumMetadataSizeKinds>;
+  auto getTotal = [](const Sizes &sizes) {
+    return std::accumulate(sizes.begin(), sizes.end(), uint64_t(0));
+  };
+  auto printSizes = [&](const Sizes &sizes) {
+    os << llvm::format("%10llu", (unsigned long long)getTotal(sizes));
+    for (uint64_t size : sizes)
+      os << llvm::format(" %10llu", (unsigned long long)size);
+  };
+
+  SmallVector<std::pair<const NominalTypeDecl *, Sizes>, 32> types(
+      MetadataSizes.begin(), MetadataSizes.end());
+  std::stable_sort(types.begin(), types.end(),
+                   [&](const std::pair<const NominalTypeDecl *, Sizes> &LHS,
+                       const std::pair<const NominalTypeDecl *, Sizes> &RHS) {
+    return getTotal(LHS.second) > getTotal(RHS.second);
+  });
+
+  os << "===-- Metadata size report --===\n";
+  os << "     total   metadata        vwt     fields    wtables  type\n";
+  llvm::MapVector<Identifier, Sizes> modules;
+  for (auto &entry : types) {
+    printSizes(entry.second);
+    os << "  " << entry.first->getDeclaredType()->getString() << '\n';
+
+    auto &moduleSizes = modules[entry.first->getModuleContext()->getName()];
+    for (unsigned i = 0; i != NumMetadataSizeKinds; ++i)
+      moduleSizes[i] += entry.second[i];
+  }
+
+  os << "     total   metadata        vwt     fields    wtables  module\n";
+  for (auto &entry : modules) {
+    printSizes(entry.second);
+    os << "  " << entry.first << '\n';
+  }
+}
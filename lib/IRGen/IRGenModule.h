@@ -27,6 +27,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -40,6 +41,7 @@
 #include "SwiftTargetInfo.h"
 #include "ValueWitness.h"
 
+#include <array>
 #include <atomic>
 
 namespace llvm {
@@ -159,6 +161,15 @@ public:
   bool hasFlags() const { return Info.getInt() != 0; }
 };
 
+/// The kinds of global data counted by -print-metadata-size-report.
+enum class MetadataSizeKind : unsigned {
+  TypeMetadata,
+  ValueWitnessTable,
+  FieldDescriptor,
+  WitnessTable,
+};
+enum : unsigned { NumMetadataSizeKinds = 4 };
+
 /// The principal singleton which manages all of IR generation.
 ///
 /// The IRGenerator delegates the emission of different top-level entities
@@ -215,6 +226,15 @@ private:
   /// The queue of IRGenModules for multi-threaded compilation.
   SmallVector<IRGenModule *, 8> Queue;
 
+  /// With -debug-time-parallel-irgen, the number of IRGenModules which
+  /// converted each type to a TypeInfo.
+  llvm::DenseMap<CanType, unsigned> TypeConversionCounts;
+
+  /// With -print-metadata-size-report, the bytes of each kind of global data
+  /// emitted for each nominal type.
+  llvm::MapVector<const NominalTypeDecl *,
+                  std::array<uint64_t, NumMetadataSizeKinds>> MetadataSizes;
+
   std::atomic<int> QueueIndex;
   
   friend class CurrentIGMPtr;  
@@ -265,6 +285,18 @@ public:
     return GenModules.end();
   }
   
+  /// In multi-threaded compilation, decide which IRGenModule each function
+  /// without a source file is emitted into.
+  ///
+  /// Call-graph SCCs are placed top-down, each in the IRGenModule that
+  /// references it most, unless that would make the IRGenModule much larger
+  /// than the others, in which case it goes to the smallest one.
+  void partitionFunctionsWithoutSourceFile();
+
+  /// In multi-threaded compilation, order the queue so that the largest
+  /// IRGenModules are compiled first.
+  void sortQueueBySize();
+
   /// Emit functions, variables and tables which are needed anyway, e.g. because
   /// they are externally visible.
   void emitGlobalTopLevel();
@@ -289,7 +321,7 @@ public:
     // Add it to the queue if it hasn't already been put there.
     if (LazilyEmittedFunctions.insert(f).second) {
       LazyFunctionDefinitions.push_back(f);
-      DefaultIGMForFunction[f] = CurrentIGM;
+      DefaultIGMForFunction.insert(std::make_pair(f, CurrentIGM));
     }
   }
   
@@ -315,6 +347,38 @@ public:
     return it->second;
   }
   
+  /// Record that an IRGenModule converted \p type to a TypeInfo.
+  void noteTypeConverted(CanType type) {
+    if (Opts.DebugTimeParallelIRGen && hasMultipleIGMs())
+      ++TypeConversionCounts[type];
+  }
+
+  /// Returns the number of types converted by more than one IRGenModule and
+  /// the number of conversions which repeated a conversion done by another
+  /// IRGenModule.
+  std::pair<unsigned, unsigned> getRedundantTypeConversions() const {
+    unsigned types = 0, conversions = 0;
+    for (auto &entry : TypeConversionCounts) {
+      if (entry.second < 2)
+        continue;
+      ++types;
+      conversions += entry.second - 1;
+    }
+    return {types, conversions};
+  }
+
+  /// Add \p size bytes of global data of the given kind to the size of
+  /// \p type.
+  void noteMetadataSize(const NominalTypeDecl *type, MetadataSizeKind kind,
+                        uint64_t size) {
+    // New entries are value-initialized to zero.
+    MetadataSizes[type][unsigned(kind)] += size;
+  }
+
+  /// Print the sizes recorded with noteMetadataSize, sorted by total size,
+  /// and summarized per module.
+  void printMetadataSizeReport(llvm::raw_ostream &os) const;
+
   /// In multi-threaded compilation fetch the next IRGenModule from the queue.
   IRGenModule *fetchFromQueue() {
     int idx = QueueIndex++;
@@ -997,6 +1061,12 @@ private:
   void emitLazyPrivateDefinitions();
   void addRuntimeResolvableType(CanType type);
 
+public:
+  /// With -print-metadata-size-report, count the size of \p var towards the
+  /// global data of the given kind emitted for \p type.
+  void noteMetadataSize(const NominalTypeDecl *type, MetadataSizeKind kind,
+                        llvm::GlobalVariable *var);
+
 //--- Global context emission --------------------------------------------------
 public:
   void emitRuntimeRegistration();
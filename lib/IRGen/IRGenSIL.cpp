@@ -22,6 +22,7 @@
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -2926,6 +2927,22 @@ void IRGenSILFunction::visitBranchInst(swift::BranchInst *i) {
   Builder.CreateBr(lbb.bb);
 }
 
+/// Build branch weights from the profile counts of the destinations of \p i,
+/// or return null if they aren't both known.
+static llvm::MDNode *getBranchWeights(IRGenModule &IGM,
+                                      swift::CondBranchInst *i) {
+  Optional<uint64_t> TrueCount = i->getTrueBB()->getExecutionCount();
+  Optional<uint64_t> FalseCount = i->getFalseBB()->getExecutionCount();
+  if (!TrueCount || !FalseCount || (*TrueCount == 0 && *FalseCount == 0))
+    return nullptr;
+
+  // Branch weights are 32 bits, so scale large counts down to fit.
+  uint64_t Max = std::max(*TrueCount, *FalseCount);
+  uint64_t Scale = Max < UINT32_MAX ? 1 : Max / UINT32_MAX + 1;
+  return llvm::MDBuilder(IGM.getLLVMContext())
+      .createBranchWeights(*TrueCount / Scale + 1, *FalseCount / Scale + 1);
+}
+
 void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
   LoweredBB &trueBB = getLoweredBB(i->getTrueBB());
   LoweredBB &falseBB = getLoweredBB(i->getFalseBB());
@@ -2935,7 +2952,8 @@ void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
   addIncomingSILArgumentsToPHINodes(*this, trueBB, i->getTrueArgs());
   addIncomingSILArgumentsToPHINodes(*this, falseBB, i->getFalseArgs());
 
-  Builder.CreateCondBr(condValue, trueBB.bb, falseBB.bb);
+  Builder.CreateCondBr(condValue, trueBB.bb, falseBB.bb,
+                       getBranchWeights(IGM, i));
 }
 
 void IRGenSILFunction::visitRetainValueInst(swift::RetainValueInst *i) {
@@ -95,6 +95,10 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// Whether the inline check of a Builtin.once predicate must be an
+  /// acquire load to order it with the initializer's stores.
+  bool OnceDoneCheckNeedsAcquire = false;
 };
 
 }
@@ -18,6 +18,7 @@
 #define DEBUG_TYPE "swift-immediate"
 #include "swift/Immediate/Immediate.h"
 #include "ImmediateImpl.h"
+#include "LazyJIT.h"
 
 #include "swift/Subsystems.h"
 #include "swift/AST/ASTContext.h"
@@ -29,6 +30,7 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
 #include "llvm/IR/DiagnosticPrinter.h"
@@ -290,6 +292,60 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+/// Runs \p Module on \p JIT, which compiles each function when it is first
+/// called.
+///
+/// If there is a JIT cache, the object code of an earlier run of the same
+/// module is reused. Otherwise the whole module is compiled into the cache on
+/// a background thread while it runs.
+static int runLazily(LazyJIT &JIT, std::unique_ptr<llvm::Module> Module,
+                     ArrayRef<llvm::Function *> InitFns,
+                     const ProcessCmdLine &CmdLine, const char **Argv,
+                     IRGenOptions &IRGenOpts, ASTContext &Context) {
+  // Look up everything we need to run by name, because the JIT may never see
+  // the module.
+  std::vector<std::string> InitFnNames;
+  for (auto InitFn : InitFns)
+    InitFnNames.push_back(InitFn->getName());
+  std::vector<std::string> CtorNames = LazyJIT::getConstructorNames(*Module);
+
+  DEBUG(llvm::dbgs() << "Module to be executed:\n";
+        Module->dump());
+
+  bool LoadedFromCache = false;
+  if (!IRGenOpts.JITCachePath.empty()) {
+    JITObjectCache Cache(IRGenOpts.JITCachePath);
+    SmallString<0> Bitcode;
+    {
+      llvm::raw_svector_ostream OS(Bitcode);
+      llvm::WriteBitcodeToFile(Module.get(), OS);
+    }
+    std::string Key = JITObjectCache::getKey(Bitcode, IRGenOpts, JIT.getCPU(),
+                                             JIT.getFeatures(), Context);
+    if (auto Object = Cache.lookup(Key)) {
+      DEBUG(llvm::dbgs() << "Loading " << Key << " from the JIT cache\n");
+      LoadedFromCache = !JIT.addObject(std::move(Object));
+    }
+    if (!LoadedFromCache)
+      JIT.compileIntoCache(Cache, std::move(Key), std::move(Bitcode));
+  }
+  if (!LoadedFromCache)
+    JIT.addModule(std::move(Module));
+
+  // Run the generated program.
+  JIT.runFunctions(InitFnNames);
+
+  DEBUG(llvm::dbgs() << "Running static constructors\n");
+  JIT.runFunctions(CtorNames);
+
+  DEBUG(llvm::dbgs() << "Running main\n");
+  using MainFn = int (*)(int, const char **);
+  auto EntryFn = reinterpret_cast<MainFn>(JIT.getAddress("main"));
+  if (!EntryFn)
+    return -1;
+  return EntryFn(CmdLine.size(), Argv);
+}
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                           IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
   ASTContext &Context = CI.getASTContext();
@@ -338,6 +394,18 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                            IRGenOpts, SILOpts))
     return -1;
 
+  if (auto JIT = LazyJIT::create(IRGenOpts, Context)) {
+    int Result = runLazily(*JIT, std::move(ModuleOwner), InitFns, CmdLine,
+                           argBuf.data(), IRGenOpts, Context);
+    JIT->waitForBackgroundCompiles();
+    // Like the ExecutionEngine below, the JIT is never destroyed, because the
+    // runtime keeps pointers to the metadata it emitted.
+    JIT.release();
+    return Result;
+  }
+
+  // Lazy compilation isn't supported on this host, so compile everything up
+  // front.
   llvm::PassManagerBuilder PMBuilder;
   PMBuilder.OptLevel = 2;
   PMBuilder.Inliner = llvm::createFunctionInliningPass(200);
@@ -0,0 +1,337 @@
+//===--- LazyJIT.cpp - A JIT that compiles functions on demand ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "swift-immediate"
+#include "LazyJIT.h"
+
+#include "swift/Subsystems.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/IRGenOptions.h"
+#include "swift/Basic/Version.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <set>
+
+using namespace swift;
+using namespace swift::immediate;
+
+std::string JITObjectCache::getKey(StringRef Bitcode, IRGenOptions &Opts,
+                                   StringRef CPU,
+                                   ArrayRef<std::string> Features,
+                                   ASTContext &Ctx) {
+  llvm::MD5 Hash;
+  Hash.update(Bitcode);
+
+  // Recompile if the compiler, and thus the LLVM pipeline, changed.
+  Hash.update(version::getSwiftFullVersion(
+                  Ctx.LangOpts.EffectiveLanguageVersion));
+
+  // Add everything which influences code generation but isn't reflected in
+  // the bitcode itself.
+  auto addString = [&](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("", 1));
+  };
+  addString(std::to_string(Opts.getLLVMCodeGenOptionsHash()));
+  addString(CPU);
+  for (const std::string &Feature : Features)
+    addString(Feature);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+JITObjectCache::lookup(StringRef Key) const {
+  SmallString<128> Path(Directory);
+  llvm::sys::path::append(Path, Twine(Key) + ".o");
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return nullptr;
+  return std::move(Buffer.get());
+}
+
+bool JITObjectCache::store(StringRef Key, StringRef Object) const {
+  if (llvm::sys::fs::create_directories(Directory))
+    return true;
+
+  SmallString<128> Path(Directory);
+  llvm::sys::path::append(Path, Twine(Key) + ".o");
+
+  SmallString<128> TmpPath(Path.str() + "-%%%%%%");
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(TmpPath.str(), TmpFD, TmpPath))
+    return true;
+
+  llvm::raw_fd_ostream OS(TmpFD, /*shouldClose=*/true);
+  OS << Object;
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    llvm::sys::fs::remove(TmpPath);
+    return true;
+  }
+
+  if (llvm::sys::fs::rename(TmpPath.str(), Path)) {
+    llvm::sys::fs::remove(TmpPath);
+    return true;
+  }
+  return false;
+}
+
+llvm::orc::JITCompileCallbackManager::CompileCallbackInfo
+LazyJIT::SerializingCallbackManager::getCompileCallback() {
+  auto Info = Base.getCompileCallback();
+  Callbacks.emplace_back();
+  Callback &C = Callbacks.back();
+  Info.setCompileAction([this, &C]() -> llvm::orc::TargetAddress {
+    std::lock_guard<std::recursive_mutex> Guard(Lock);
+    if (!C.Address)
+      C.Address = C.Compile();
+    return C.Address;
+  });
+  return llvm::orc::JITCompileCallbackManager::CompileCallbackInfo(
+      Info.getAddress(), C.Compile);
+}
+
+static llvm::TargetMachine *
+selectTargetMachine(const llvm::TargetOptions &TargetOpts, StringRef CPU,
+                    ArrayRef<std::string> Features) {
+  std::string ErrorMsg;
+  llvm::EngineBuilder Builder;
+  Builder.setRelocationModel(llvm::Reloc::PIC_);
+  Builder.setTargetOptions(TargetOpts);
+  Builder.setMCPU(CPU);
+  Builder.setMAttrs(Features);
+  Builder.setErrorStr(&ErrorMsg);
+  llvm::TargetMachine *TM = Builder.selectTarget();
+  if (!TM)
+    DEBUG(llvm::dbgs() << "Error selecting JIT target: " << ErrorMsg << '\n');
+  return TM;
+}
+
+std::unique_ptr<LazyJIT> LazyJIT::create(IRGenOptions &Opts,
+                                         ASTContext &Ctx) {
+  llvm::TargetOptions TargetOpts;
+  std::string CPU;
+  std::vector<std::string> Features;
+  std::tie(TargetOpts, CPU, Features) = getIRTargetOptions(Opts, Ctx);
+
+  std::unique_ptr<llvm::TargetMachine> TM(
+      selectTargetMachine(TargetOpts, CPU, Features));
+  if (!TM)
+    return nullptr;
+
+  // Lazy compilation needs trampolines and stubs for the target.
+  const llvm::Triple &Triple = TM->getTargetTriple();
+  auto Callbacks = llvm::orc::createLocalCompileCallbackManager(
+      Triple, /*ErrorHandlerAddress=*/0);
+  if (!Callbacks || !llvm::orc::createLocalIndirectStubsManagerBuilder(Triple))
+    return nullptr;
+
+  // Make the symbols of the libraries loaded by immediate mode visible to
+  // the JIT.
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+  return std::unique_ptr<LazyJIT>(
+      new LazyJIT(std::move(TargetOpts), std::move(CPU), std::move(Features),
+                  std::move(TM), std::move(Callbacks)));
+}
+
+LazyJIT::LazyJIT(
+    llvm::TargetOptions TheTargetOpts, std::string TheCPU,
+    std::vector<std::string> TheFeatures,
+    std::unique_ptr<llvm::TargetMachine> TheTM,
+    std::unique_ptr<llvm::orc::JITCompileCallbackManager> Callbacks)
+  : TargetOpts(std::move(TheTargetOpts)), CPU(std::move(TheCPU)),
+    Features(std::move(TheFeatures)), TM(std::move(TheTM)),
+    DL(TM->createDataLayout()), BaseCallbackManager(std::move(Callbacks)),
+    CallbackManager(*BaseCallbackManager, Lock),
+    CompileLayer(ObjectLayer, llvm::orc::SimpleCompiler(*TM)),
+    LazyLayer(CompileLayer,
+              // Compile each function on its own.
+              [](llvm::Function &F) {
+                return std::set<llvm::Function *>({&F});
+              },
+              CallbackManager,
+              llvm::orc::createLocalIndirectStubsManagerBuilder(
+                  TM->getTargetTriple())) {}
+
+void LazyJIT::waitForBackgroundCompiles() {
+  if (CacheThread.joinable())
+    CacheThread.join();
+}
+
+std::unique_ptr<llvm::TargetMachine> LazyJIT::createTargetMachine() const {
+  return std::unique_ptr<llvm::TargetMachine>(
+      selectTargetMachine(TargetOpts, CPU, Features));
+}
+
+std::string LazyJIT::mangle(StringRef Name) const {
+  std::string MangledName;
+  {
+    llvm::raw_string_ostream Stream(MangledName);
+    llvm::Mangler::getNameWithPrefix(Stream, Name, DL);
+  }
+  return MangledName;
+}
+
+llvm::orc::JITSymbol LazyJIT::findMangledSymbol(const std::string &Name) {
+  // Prefer the stubs of functions which haven't been compiled yet.
+  if (auto Sym = LazyLayer.findSymbol(Name, /*ExportedSymbolsOnly=*/false))
+    return Sym;
+  return ObjectLayer.findSymbol(Name, /*ExportedSymbolsOnly=*/false);
+}
+
+/// Resolves the references of compiled code to symbols of the JIT first and
+/// then to symbols of the process.
+static std::unique_ptr<llvm::RuntimeDyld::SymbolResolver>
+createResolver(std::function<llvm::orc::JITSymbol(const std::string &)>
+                   FindInJIT) {
+  return llvm::orc::createLambdaResolver(
+      [FindInJIT](const std::string &Name) {
+        if (auto Sym = FindInJIT(Name))
+          return Sym.toRuntimeDyldSymbol();
+        return llvm::RuntimeDyld::SymbolInfo(nullptr);
+      },
+      [](const std::string &Name) {
+        if (auto Address =
+                llvm::RTDyldMemoryManager::getSymbolAddressInProcess(Name))
+          return llvm::RuntimeDyld::SymbolInfo(
+              Address, llvm::JITSymbolFlags::Exported);
+        return llvm::RuntimeDyld::SymbolInfo(nullptr);
+      });
+}
+
+LazyJIT::ModuleHandle LazyJIT::addModule(std::unique_ptr<llvm::Module> M) {
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+  std::vector<std::unique_ptr<llvm::Module>> Modules;
+  Modules.push_back(std::move(M));
+  return LazyLayer.addModuleSet(
+      std::move(Modules), llvm::make_unique<llvm::SectionMemoryManager>(),
+      createResolver([this](const std::string &Name) {
+        return findMangledSymbol(Name);
+      }));
+}
+
+bool LazyJIT::addObject(std::unique_ptr<llvm::MemoryBuffer> Object) {
+  auto ObjectFile =
+      llvm::object::ObjectFile::createObjectFile(Object->getMemBufferRef());
+  if (!ObjectFile) {
+    llvm::consumeError(ObjectFile.takeError());
+    return true;
+  }
+
+  using OwningObject = llvm::object::OwningBinary<llvm::object::ObjectFile>;
+  std::vector<std::unique_ptr<OwningObject>> Objects;
+  Objects.push_back(llvm::make_unique<OwningObject>(std::move(*ObjectFile),
+                                                    std::move(Object)));
+
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+  ObjectLayer.addObjectSet(
+      std::move(Objects), llvm::make_unique<llvm::SectionMemoryManager>(),
+      createResolver([this](const std::string &Name) {
+        return findMangledSymbol(Name);
+      }));
+  return false;
+}
+
+/// Compiles the module in \p Bitcode with \p TM, in a context of its own,
+/// and stores the object in \p Cache.
+static void compileAndStore(JITObjectCache Cache, std::string Key,
+                            SmallString<0> Bitcode,
+                            std::unique_ptr<llvm::TargetMachine> TM) {
+  llvm::LLVMContext Context;
+  llvm::SMDiagnostic Err;
+  std::unique_ptr<llvm::Module> M =
+      llvm::parseIR(llvm::MemoryBufferRef(Bitcode, Key), Err, Context);
+  if (!M)
+    return;
+
+  // The runs that load the object look the static constructors up by name.
+  for (auto Ctor : llvm::orc::getConstructors(*M)) {
+    if (Ctor.Func && Ctor.Func->hasLocalLinkage()) {
+      Ctor.Func->setLinkage(llvm::GlobalValue::ExternalLinkage);
+      Ctor.Func->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    }
+  }
+
+  auto Object = llvm::orc::SimpleCompiler(*TM)(*M);
+  if (!Object.getBinary())
+    return;
+  if (Cache.store(Key, Object.getBinary()->getData()))
+    DEBUG(llvm::dbgs() << "Failed to store " << Key << " in the JIT cache\n");
+}
+
+void LazyJIT::compileIntoCache(const JITObjectCache &Cache, std::string Key,
+                               SmallString<0> Bitcode) {
+  assert(!CacheThread.joinable() && "already compiling a module");
+  std::unique_ptr<llvm::TargetMachine> CacheTM = createTargetMachine();
+  if (!CacheTM)
+    return;
+  CacheThread = std::thread(compileAndStore, Cache, std::move(Key),
+                            std::move(Bitcode), std::move(CacheTM));
+}
+
+static void *toPointer(llvm::orc::JITSymbol Sym) {
+  if (!Sym)
+    return nullptr;
+  return reinterpret_cast<void *>(static_cast<uintptr_t>(Sym.getAddress()));
+}
+
+void *LazyJIT::getAddress(StringRef Name) {
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+  return toPointer(findMangledSymbol(mangle(Name)));
+}
+
+void *LazyJIT::getAddress(ModuleHandle H, StringRef Name) {
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+  return toPointer(LazyLayer.findSymbolIn(H, mangle(Name),
+                                          /*ExportedSymbolsOnly=*/false));
+}
+
+void LazyJIT::runFunctions(ArrayRef<std::string> Names) {
+  for (const std::string &Name : Names) {
+    DEBUG(llvm::dbgs() << "Running " << Name << '\n');
+    if (auto *Fn = reinterpret_cast<void (*)()>(getAddress(Name)))
+      Fn();
+  }
+}
+
+std::vector<std::string> LazyJIT::getConstructorNames(llvm::Module &M) {
+  std::vector<std::string> Names;
+  for (auto Ctor : llvm::orc::getConstructors(M))
+    if (Ctor.Func)
+      Names.push_back(Ctor.Func->getName());
+  return Names;
+}
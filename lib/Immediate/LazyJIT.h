@@ -0,0 +1,181 @@
+//===--- LazyJIT.h - A JIT that compiles functions on demand ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The JIT behind immediate mode and the REPL. It compiles each function of a
+// module the first time the function is called, so a script only pays for
+// the code it runs, and it can keep the object code of whole modules in a
+// persistent cache, so a script that hasn't changed isn't compiled again.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_IMMEDIATE_LAZYJIT_H
+#define SWIFT_IMMEDIATE_LAZYJIT_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llvm {
+  class MemoryBuffer;
+  class Module;
+}
+
+namespace swift {
+  class ASTContext;
+  class IRGenOptions;
+
+namespace immediate {
+
+/// Keeps the object code of JIT-compiled modules in a directory, named by a
+/// hash of their IR and of everything else that affects code generation.
+///
+/// Entries are written under a temporary name and renamed into place, so
+/// that several processes can share a cache directory.
+class JITObjectCache {
+  std::string Directory;
+
+public:
+  explicit JITObjectCache(StringRef Directory) : Directory(Directory) {}
+
+  /// Computes the key of the object code of a module whose bitcode is
+  /// \p Bitcode, when compiled for \p CPU and \p Features with \p Opts.
+  static std::string getKey(StringRef Bitcode, IRGenOptions &Opts,
+                            StringRef CPU, ArrayRef<std::string> Features,
+                            ASTContext &Ctx);
+
+  /// Returns the object stored under \p Key, or null if there is none.
+  std::unique_ptr<llvm::MemoryBuffer> lookup(StringRef Key) const;
+
+  /// Stores \p Object under \p Key. Returns true on error.
+  bool store(StringRef Key, StringRef Object) const;
+};
+
+class LazyJIT {
+  /// Compiles functions under the JIT's lock, and makes the threads that
+  /// called a function while it was being compiled wait for it rather than
+  /// compile it again.
+  class SerializingCallbackManager {
+    using CompileFtor = std::function<llvm::orc::TargetAddress()>;
+
+    struct Callback {
+      CompileFtor Compile;
+      llvm::orc::TargetAddress Address = 0;
+    };
+
+    llvm::orc::JITCompileCallbackManager &Base;
+    std::recursive_mutex &Lock;
+    std::list<Callback> Callbacks;
+
+  public:
+    SerializingCallbackManager(llvm::orc::JITCompileCallbackManager &Base,
+                               std::recursive_mutex &Lock)
+      : Base(Base), Lock(Lock) {}
+
+    llvm::orc::JITCompileCallbackManager::CompileCallbackInfo
+    getCompileCallback();
+  };
+
+  using ObjectLayerT = llvm::orc::ObjectLinkingLayer<>;
+  using CompileLayerT = llvm::orc::IRCompileLayer<ObjectLayerT>;
+  using LazyLayerT =
+      llvm::orc::CompileOnDemandLayer<CompileLayerT,
+                                      SerializingCallbackManager>;
+
+public:
+  using ModuleHandle = LazyLayerT::ModuleSetHandleT;
+
+private:
+  llvm::TargetOptions TargetOpts;
+  std::string CPU;
+  std::vector<std::string> Features;
+
+  /// Guards the layers, which aren't thread-safe, against threads of the
+  /// program that call functions which haven't been compiled yet.
+  std::recursive_mutex Lock;
+
+  std::unique_ptr<llvm::TargetMachine> TM;
+  const llvm::DataLayout DL;
+  std::unique_ptr<llvm::orc::JITCompileCallbackManager> BaseCallbackManager;
+  SerializingCallbackManager CallbackManager;
+  ObjectLayerT ObjectLayer;
+  CompileLayerT CompileLayer;
+  LazyLayerT LazyLayer;
+
+  /// Compiles modules for the object cache.
+  std::thread CacheThread;
+
+  LazyJIT(llvm::TargetOptions TargetOpts, std::string CPU,
+          std::vector<std::string> Features,
+          std::unique_ptr<llvm::TargetMachine> TM,
+          std::unique_ptr<llvm::orc::JITCompileCallbackManager> Callbacks);
+
+  std::unique_ptr<llvm::TargetMachine> createTargetMachine() const;
+
+  std::string mangle(StringRef Name) const;
+
+  llvm::orc::JITSymbol findMangledSymbol(const std::string &Name);
+
+public:
+  /// Creates a JIT for the host with the target options of \p Opts, or
+  /// returns null if compiling functions on demand isn't supported on the
+  /// host.
+  static std::unique_ptr<LazyJIT> create(IRGenOptions &Opts, ASTContext &Ctx);
+
+  ~LazyJIT() { waitForBackgroundCompiles(); }
+
+  /// Waits for the modules that are being compiled for the object cache.
+  void waitForBackgroundCompiles();
+
+  StringRef getCPU() const { return CPU; }
+  ArrayRef<std::string> getFeatures() const { return Features; }
+
+  /// Adds \p M, whose functions are compiled when they're first called.
+  ModuleHandle addModule(std::unique_ptr<llvm::Module> M);
+
+  /// Adds compiled code. Returns true if \p Object isn't an object file.
+  bool addObject(std::unique_ptr<llvm::MemoryBuffer> Object);
+
+  /// Compiles \p Bitcode on a background thread, and stores the result in
+  /// \p Cache under \p Key for the next run of the same module.
+  void compileIntoCache(const JITObjectCache &Cache, std::string Key,
+                        SmallString<0> Bitcode);
+
+  /// Returns the address of the function or global named \p Name in the IR,
+  /// or null if there is none.
+  void *getAddress(StringRef Name);
+
+  /// Returns the address of \p Name in the module \p H, or null.
+  void *getAddress(ModuleHandle H, StringRef Name);
+
+  /// Runs the functions called \p Names, which take no arguments, in order.
+  void runFunctions(ArrayRef<std::string> Names);
+
+  /// Returns the names of the static constructors of \p M, in the order in
+  /// which they have to be run.
+  static std::vector<std::string> getConstructorNames(llvm::Module &M);
+};
+
+} // end namespace immediate
+} // end namespace swift
+
+#endif
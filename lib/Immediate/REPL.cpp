@@ -12,6 +12,7 @@
 
 #include "swift/Immediate/Immediate.h"
 #include "ImmediateImpl.h"
+#include "LazyJIT.h"
 
 #include "swift/Subsystems.h"
 #include "swift/AST/ASTContext.h"
@@ -748,6 +749,8 @@ private:
   llvm::Module DumpModule;
   llvm::SmallString<128> DumpSource;
 
+  /// Runs the lines, or if the host doesn't support lazy compilation, EE.
+  std::unique_ptr<LazyJIT> JIT;
   llvm::ExecutionEngine *EE;
   IRGenOptions IRGenOpts;
   const SILOptions SILOpts;
@@ -817,6 +820,35 @@ private:
     }
   }
 
+  /// Runs the module of the current line(s) on the lazy JIT.
+  void runLazily(std::unique_ptr<llvm::Module> LineModule) {
+    std::vector<std::string> InitFnNames;
+    for (auto InitFn : InitFns)
+      InitFnNames.push_back(InitFn->getName());
+    InitFns.clear();
+
+    std::vector<std::string> CtorNames;
+    if (!RanGlobalInitializers) {
+      CtorNames = LazyJIT::getConstructorNames(*LineModule);
+      RanGlobalInitializers = true;
+    }
+
+    auto Handle = JIT->addModule(std::move(LineModule));
+    JIT->runFunctions(InitFnNames);
+    JIT->runFunctions(CtorNames);
+
+    // Every line has a main function, so look for the one of this line.
+    using MainFn = int (*)(int, const char **);
+    auto EntryFn = reinterpret_cast<MainFn>(JIT->getAddress(Handle, "main"));
+    if (!EntryFn)
+      return;
+    SmallVector<const char *, 32> Argv;
+    for (const std::string &Arg : CmdLine)
+      Argv.push_back(Arg.c_str());
+    Argv.push_back(nullptr);
+    EntryFn(CmdLine.size(), Argv.data());
+  }
+
   bool executeSwiftSource(llvm::StringRef Line, const ProcessCmdLine &CmdLine) {
     // Parse the current line(s).
     auto InputBuf = std::unique_ptr<llvm::MemoryBuffer>(
@@ -891,7 +923,12 @@ private:
     if (IRGenImportedModules(CI, *NewModule, ImportedModules, InitFns,
                              IRGenOpts, SILOpts))
       return false;
-    
+
+    if (JIT) {
+      runLazily(std::move(NewModule));
+      return true;
+    }
+
     llvm::Module *TempModule = NewModule.get();
     EE->addModule(std::move(NewModule));
 
@@ -943,21 +980,27 @@ public:
     }
     tryLoadLibraries(CI.getLinkLibraries(), Ctx.SearchPathOpts, CI.getDiags());
 
-    llvm::EngineBuilder builder{std::unique_ptr<llvm::Module>{Module}};
-    std::string ErrorMsg;
-    llvm::TargetOptions TargetOpt;
-    std::string CPU;
-    std::vector<std::string> Features;
-    std::tie(TargetOpt, CPU, Features)
-      = getIRTargetOptions(IRGenOpts, CI.getASTContext());
-    
-    builder.setRelocationModel(llvm::Reloc::PIC_);
-    builder.setTargetOptions(TargetOpt);
-    builder.setMCPU(CPU);
-    builder.setMAttrs(Features);
-    builder.setErrorStr(&ErrorMsg);
-    builder.setEngineKind(llvm::EngineKind::JIT);
-    EE = builder.create();
+    // The module the lines are linked into is never destroyed, as if the
+    // ExecutionEngine owned it.
+    JIT = LazyJIT::create(IRGenOpts, CI.getASTContext());
+    EE = nullptr;
+    if (!JIT) {
+      llvm::EngineBuilder builder{std::unique_ptr<llvm::Module>{Module}};
+      std::string ErrorMsg;
+      llvm::TargetOptions TargetOpt;
+      std::string CPU;
+      std::vector<std::string> Features;
+      std::tie(TargetOpt, CPU, Features)
+        = getIRTargetOptions(IRGenOpts, CI.getASTContext());
+
+      builder.setRelocationModel(llvm::Reloc::PIC_);
+      builder.setTargetOptions(TargetOpt);
+      builder.setMCPU(CPU);
+      builder.setMAttrs(Features);
+      builder.setErrorStr(&ErrorMsg);
+      builder.setEngineKind(llvm::EngineKind::JIT);
+      EE = builder.create();
+    }
 
     IRGenOpts.OutputFilenames.clear();
     IRGenOpts.Optimize = false;
@@ -18,6 +18,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/StringExtras.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 
 using namespace swift;
@@ -324,6 +325,16 @@ private:
 
   // This maps a module to all its imports, recursively.
   llvm::DenseMap<Module *, llvm::SmallVector<Module *, 4>> ImportsMap;
+
+  // Every dependency hash covers all of that module's recursive imports, so
+  // the same files would otherwise be stat'ed once per importing module.
+  struct FileReferenceInfo {
+    bool StatFailed;
+    uint64_t Size;
+    uint64_t ModTime;
+  };
+  llvm::StringMap<FileReferenceInfo> FileReferences;
+  llvm::DenseMap<Module *, llvm::hash_code> ModuleHashes;
 };
 } // anonymous namespace
 
@@ -929,20 +940,31 @@ IndexSwiftASTWalker::hashFileReference(llvm::hash_code code,
 
   // FIXME: FileManager for swift ?
 
-  llvm::sys::fs::file_status Status;
-  if (std::error_code Ret = llvm::sys::fs::status(Filename, Status)) {
-    // Failure to read the file, just use filename to recover.
-    warn([&](llvm::raw_ostream &OS) {
-      OS << "failed to stat file: " << Filename << " (" << Ret.message() << ')';
-    });
-    return hash_combine(code, Filename);
+  auto Inserted = FileReferences.insert({Filename, FileReferenceInfo()});
+  FileReferenceInfo &Info = Inserted.first->getValue();
+  if (Inserted.second) {
+    llvm::sys::fs::file_status Status;
+    if (std::error_code Ret = llvm::sys::fs::status(Filename, Status)) {
+      warn([&](llvm::raw_ostream &OS) {
+        OS << "failed to stat file: " << Filename << " (" << Ret.message()
+           << ')';
+      });
+      Info.StatFailed = true;
+    } else {
+      Info.StatFailed = false;
+      Info.Size = Status.getSize();
+      Info.ModTime = Status.getLastModificationTime().toEpochTime();
+    }
   }
 
+  // Failure to read the file, just use filename to recover.
+  if (Info.StatFailed)
+    return hash_combine(code, Filename);
+
   // Don't use inode because it can easily change when you update the repository
   // even though the file is supposed to be the same (same size/time).
   code = hash_combine(code, Filename);
-  return hash_combine(code, Status.getSize(),
-                      Status.getLastModificationTime().toEpochTime());
+  return hash_combine(code, Info.Size, Info.ModTime);
 }
 
 llvm::hash_code IndexSwiftASTWalker::hashModule(llvm::hash_code code,
@@ -1055,7 +1077,18 @@ void IndexSwiftASTWalker::collectRecursiveModuleImports(
 void IndexSwiftASTWalker::getModuleHash(SourceFileOrModule Mod,
                                         llvm::raw_ostream &OS) {
   // FIXME: Use a longer hash string to minimize possibility for conflicts.
-  llvm::hash_code code = hashModule(0, Mod);
+  llvm::hash_code code;
+  if (Module *M = Mod.getAsModule()) {
+    auto It = ModuleHashes.find(M);
+    if (It != ModuleHashes.end()) {
+      code = It->second;
+    } else {
+      code = hashModule(0, Mod);
+      ModuleHashes.insert({M, code});
+    }
+  } else {
+    code = hashModule(0, Mod);
+  }
   OS << llvm::APInt(64, code).toString(36, /*Signed=*/false);
 }
 
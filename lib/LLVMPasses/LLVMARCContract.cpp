@@ -15,9 +15,17 @@
 #include "ARCEntryPointBuilder.h"
 #include "LLVMARCOpts.h"
 #include "swift/Basic/Fallthrough.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/Utils/SSAUpdater.h"
 
 using namespace llvm;
@@ -35,6 +43,20 @@ STATISTIC(NumUnknownRetainReleasesEliminatedByMergingIntoRetainReleaseN,
 STATISTIC(NumBridgeRetainReleasesEliminatedByMergingIntoRetainReleaseN,
           "Number of bridge retain/release eliminated by merging into "
           "bridgeRetain_n/bridgeRelease_n");
+STATISTIC(NumRetainsEliminatedByHoisting,
+          "Number of retains eliminated by hoisting them into a dominating "
+          "block and merging them into a retain_n");
+STATISTIC(NumReleasesEliminatedBySinking,
+          "Number of releases eliminated by sinking them into a "
+          "post-dominating block and merging them into a release_n");
+
+static llvm::cl::opt<bool>
+DisableContractAcrossBlocks("disable-llvm-arc-contract-across-blocks",
+                            llvm::cl::init(false));
+
+/// The largest number of blocks between a block and its immediate dominator
+/// that we look through when moving retains and releases between them.
+static const unsigned MaxBlocksBetween = 32;
 
 /// Pimpl implementation of SwiftARCContractPass.
 namespace {
@@ -57,6 +79,9 @@ struct LocalState {
 ///
 ///   - Merging together retain and release calls into retain_n, release_n
 ///   - calls.
+///   - Hoisting retains into, and sinking releases out of, the blocks that
+///     execute exactly as often as the block they are in, so that they can be
+///     merged with the retains and releases there.
 ///
 /// Coming into this function, we assume that the code is in canonical form:
 /// none of these calls have any uses of their return values.
@@ -72,9 +97,24 @@ class SwiftARCContractImpl {
 
   /// The entry point builder that is used to construct ARC entry points.
   ARCEntryPointBuilder B;
+
+  DominatorTree *DT;
+  PostDominatorTree *PDT;
+  LoopInfo *LI;
+
+  /// The blocks that contain instructions which retains and releases may
+  /// not be moved across.
+  SmallPtrSet<BasicBlock *, 8> BlocksWithUnknownInsts;
+
+  /// The retains and releases that were moved into another block, and have
+  /// not been merged yet.
+  SmallPtrSet<CallInst *, 8> MovedCalls;
 public:
-  SwiftARCContractImpl(Function &InF, SwiftRCIdentity *InRC)
-    : Changed(false), RC(InRC), F(InF), B(F) {}
+  SwiftARCContractImpl(Function &InF, SwiftRCIdentity *InRC,
+                       DominatorTree *InDT, PostDominatorTree *InPDT,
+                       LoopInfo *InLI)
+    : Changed(false), RC(InRC), F(InF), B(F), DT(InDT), PDT(InPDT),
+      LI(InLI) {}
 
   // The top level run routine of the pass.
   bool run();
@@ -85,6 +125,35 @@ private:
   /// call.
   void
   performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap);
+
+  /// Move retains and releases between the blocks of the function so that
+  /// the intra-BB merging sees the ones of the same object together.
+  void performCrossBlockMotion();
+
+  /// Returns the immediate dominator of \p BB if the two blocks execute
+  /// equally often and retains and releases can be moved between them, or
+  /// null otherwise.
+  BasicBlock *getEquivalentDominator(BasicBlock &BB);
+
+  /// Identifies retains or releases of the same kind of the same object.
+  using RCKey = std::pair<Value *, unsigned>;
+  RCKey getKey(CallInst *CI, RT_Kind Kind);
+
+  /// Hoist the retains at the start of \p BB into its equivalent dominator,
+  /// next to a retain of the same kind of the same object.
+  void hoistRetains(BasicBlock &BB);
+
+  /// Sink the releases at the end of the equivalent dominator of \p BB into
+  /// \p BB, next to a release of the same kind of the same object.
+  void sinkReleases(BasicBlock &BB);
+
+  /// Returns true if none of the blocks on the paths from \p Dom to \p BB,
+  /// excluding both, contains an unknown instruction.
+  bool isFreeOfUnknownInstsBetween(BasicBlock *Dom, BasicBlock *BB);
+
+  /// Returns how many of \p Calls, which are being merged into a single
+  /// call, were moved there from another block, and forgets about them.
+  unsigned takeNumMovedCalls(ArrayRef<CallInst *> Calls);
 };
 
 } // end anonymous namespace
@@ -109,6 +178,8 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       }
       B.createRetainN(RC->getSwiftRCIdentityRoot(O), RetainList.size(), RI);
 
+      NumRetainsEliminatedByHoisting += takeNumMovedCalls(RetainList);
+
       // Replace all uses of the retain instructions with our new retainN and
       // then delete them.
       for (auto *Inst : RetainList) {
@@ -135,6 +206,8 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       }
       B.createReleaseN(RC->getSwiftRCIdentityRoot(O), ReleaseList.size(), RI);
 
+      NumReleasesEliminatedBySinking += takeNumMovedCalls(ReleaseList);
+
       // Remove all old release instructions.
       for (auto *Inst : ReleaseList) {
         Inst->eraseFromParent();
@@ -160,6 +233,8 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       B.createUnknownRetainN(RC->getSwiftRCIdentityRoot(O),
                              UnknownRetainList.size(), RI);
 
+      NumRetainsEliminatedByHoisting += takeNumMovedCalls(UnknownRetainList);
+
       // Replace all uses of the retain instructions with our new retainN and
       // then delete them.
       for (auto *Inst : UnknownRetainList) {
@@ -187,6 +262,8 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       B.createUnknownReleaseN(RC->getSwiftRCIdentityRoot(O),
                               UnknownReleaseList.size(), RI);
 
+      NumReleasesEliminatedBySinking += takeNumMovedCalls(UnknownReleaseList);
+
       // Remove all old release instructions.
       for (auto *Inst : UnknownReleaseList) {
         Inst->eraseFromParent();
@@ -214,6 +291,8 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       auto *I = B.createBridgeRetainN(RC->getSwiftRCIdentityRoot(O),
                                       BridgeRetainList.size(), RI);
 
+      NumRetainsEliminatedByHoisting += takeNumMovedCalls(BridgeRetainList);
+
       // Remove all old retain instructions.
       for (auto *Inst : BridgeRetainList) {
         Inst->replaceAllUsesWith(I);
@@ -241,6 +320,8 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       B.createBridgeReleaseN(RC->getSwiftRCIdentityRoot(O),
                               BridgeReleaseList.size(), RI);
 
+      NumReleasesEliminatedBySinking += takeNumMovedCalls(BridgeReleaseList);
+
       // Remove all old release instructions.
       for (auto *Inst : BridgeReleaseList) {
         Inst->eraseFromParent();
@@ -254,7 +335,184 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
 }
 
 
+static bool isMergeableRetain(RT_Kind Kind) {
+  return Kind == RT_Retain || Kind == RT_UnknownRetain ||
+         Kind == RT_BridgeRetain;
+}
+
+static bool isMergeableRelease(RT_Kind Kind) {
+  return Kind == RT_Release || Kind == RT_UnknownRelease ||
+         Kind == RT_BridgeRelease;
+}
+
+unsigned SwiftARCContractImpl::takeNumMovedCalls(ArrayRef<CallInst *> Calls) {
+  unsigned NumMoved = 0;
+  for (auto *CI : Calls)
+    NumMoved += MovedCalls.erase(CI);
+  // If all of the calls were moved here along a chain of blocks, the merged
+  // call takes the place of one of them.
+  return NumMoved == Calls.size() ? NumMoved - 1 : NumMoved;
+}
+
+bool SwiftARCContractImpl::isFreeOfUnknownInstsBetween(BasicBlock *Dom,
+                                                       BasicBlock *BB) {
+  SmallPtrSet<BasicBlock *, 8> Visited;
+  SmallVector<BasicBlock *, 8> Worklist(succ_begin(Dom), succ_end(Dom));
+  while (!Worklist.empty()) {
+    BasicBlock *Block = Worklist.pop_back_val();
+    if (Block == BB || !Visited.insert(Block).second)
+      continue;
+    if (Block == Dom || BlocksWithUnknownInsts.count(Block) ||
+        Visited.size() > MaxBlocksBetween)
+      return false;
+    Worklist.append(succ_begin(Block), succ_end(Block));
+  }
+  return true;
+}
+
+BasicBlock *SwiftARCContractImpl::getEquivalentDominator(BasicBlock &BB) {
+  DomTreeNode *Node = DT->getNode(&BB);
+  if (!Node || !Node->getIDom())
+    return nullptr;
+  BasicBlock *Dom = Node->getIDom()->getBlock();
+
+  // Every path through Dom continues to BB, and since they are in the same
+  // loop, every path to BB comes through Dom without passing through BB
+  // again. So the two blocks execute exactly as often as each other, and a
+  // retain or release can be moved from one to the other without changing
+  // how often it is executed.
+  if (!PDT->dominates(&BB, Dom) || LI->getLoopFor(&BB) != LI->getLoopFor(Dom))
+    return nullptr;
+
+  // For the same reason that we do not merge across unknown instructions in
+  // a block, we can only move the retains and releases after the last unknown
+  // instruction in Dom and the ones before the first unknown instruction in
+  // BB, and only if there are no unknown instructions in between.
+  if (!isFreeOfUnknownInstsBetween(Dom, &BB))
+    return nullptr;
+  return Dom;
+}
+
+SwiftARCContractImpl::RCKey
+SwiftARCContractImpl::getKey(CallInst *CI, RT_Kind Kind) {
+  return { RC->getSwiftRCIdentityRoot(CI->getArgOperand(0)), unsigned(Kind) };
+}
+
+void SwiftARCContractImpl::hoistRetains(BasicBlock &BB) {
+  BasicBlock *Dom = getEquivalentDominator(BB);
+  if (!Dom)
+    return;
+
+  // The last retain of each object after the last unknown instruction in
+  // Dom.
+  DenseMap<RCKey, CallInst *> DomRetains;
+  for (auto II = Dom->rbegin(), IE = Dom->rend(); II != IE; ++II) {
+    auto Kind = classifyInstruction(*II);
+    if (Kind == RT_Unknown)
+      break;
+    if (isMergeableRetain(Kind)) {
+      auto *CI = cast<CallInst>(&*II);
+      DomRetains.insert({ getKey(CI, Kind), CI });
+    }
+  }
+  if (DomRetains.empty())
+    return;
+
+  // Hoist the retains before the first unknown instruction in BB up next to
+  // a retain in Dom. Retaining an object earlier is fine as long as it is
+  // alive there, which the retain in Dom shows.
+  for (auto II = BB.begin(), IE = BB.end(); II != IE; ) {
+    // Preincrement iterator to avoid iteration issues in the loop.
+    Instruction &Inst = *II++;
+
+    auto Kind = classifyInstruction(Inst);
+    if (Kind == RT_Unknown)
+      break;
+    if (!isMergeableRetain(Kind))
+      continue;
+    auto *CI = cast<CallInst>(&Inst);
+    auto It = DomRetains.find(getKey(CI, Kind));
+    if (It == DomRetains.end())
+      continue;
+    CallInst *InsertPt = It->second;
+    // The RC identity root is the same, but the argument itself might be
+    // computed in BB.
+    auto *Arg = dyn_cast<Instruction>(CI->getArgOperand(0));
+    if (Arg && Arg != InsertPt && !DT->dominates(Arg, InsertPt))
+      continue;
+    CI->moveBefore(InsertPt->getNextNode());
+    MovedCalls.insert(CI);
+    Changed = true;
+  }
+}
+
+void SwiftARCContractImpl::sinkReleases(BasicBlock &BB) {
+  BasicBlock *Dom = getEquivalentDominator(BB);
+  if (!Dom)
+    return;
+
+  // The first release of each object before the first unknown instruction in
+  // BB.
+  DenseMap<RCKey, CallInst *> BBReleases;
+  for (Instruction &Inst : BB) {
+    auto Kind = classifyInstruction(Inst);
+    if (Kind == RT_Unknown)
+      break;
+    if (isMergeableRelease(Kind)) {
+      auto *CI = cast<CallInst>(&Inst);
+      BBReleases.insert({ getKey(CI, Kind), CI });
+    }
+  }
+  if (BBReleases.empty())
+    return;
+
+  // Sink the releases after the last unknown instruction in Dom down next to
+  // a release in BB. This only makes the object live longer, and as Dom
+  // dominates BB, the argument of the release is available there.
+  SmallVector<std::pair<CallInst *, CallInst *>, 4> Sinks;
+  for (auto II = Dom->rbegin(), IE = Dom->rend(); II != IE; ++II) {
+    auto Kind = classifyInstruction(*II);
+    if (Kind == RT_Unknown)
+      break;
+    if (!isMergeableRelease(Kind))
+      continue;
+    auto *CI = cast<CallInst>(&*II);
+    auto It = BBReleases.find(getKey(CI, Kind));
+    if (It != BBReleases.end())
+      Sinks.push_back({ CI, It->second });
+  }
+
+  for (auto &Sink : Sinks) {
+    Sink.first->moveBefore(Sink.second);
+    MovedCalls.insert(Sink.first);
+    Changed = true;
+  }
+}
+
+void SwiftARCContractImpl::performCrossBlockMotion() {
+  for (BasicBlock &BB : F) {
+    for (Instruction &Inst : BB) {
+      if (classifyInstruction(Inst) == RT_Unknown) {
+        BlocksWithUnknownInsts.insert(&BB);
+        break;
+      }
+    }
+  }
+
+  // Hoist retains bottom-up and sink releases top-down, so that the calls
+  // along a chain of equivalent blocks all end up together.
+  for (DomTreeNode *Node : post_order(DT))
+    hoistRetains(*Node->getBlock());
+  for (DomTreeNode *Node : depth_first(DT))
+    sinkReleases(*Node->getBlock());
+}
+
 bool SwiftARCContractImpl::run() {
+  // Bring together retains and releases of the same object that are in
+  // different blocks, so that they are merged below.
+  if (!DisableContractAcrossBlocks)
+    performCrossBlockMotion();
+
   // intra-BB retain/release merging.
   DenseMap<Value *, LocalState> PtrToLocalStateMap;
   for (BasicBlock &BB : F) {
@@ -374,7 +632,10 @@ bool SwiftARCContractImpl::run() {
 
 bool SwiftARCContract::runOnFunction(Function &F) {
   RC = &getAnalysis<SwiftRCIdentity>();
-  return SwiftARCContractImpl(F, RC).run();
+  auto *DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  auto *PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+  auto *LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  return SwiftARCContractImpl(F, RC, DT, PDT, LI).run();
 }
 
 char SwiftARCContract::ID = 0;
@@ -382,6 +643,9 @@ INITIALIZE_PASS_BEGIN(SwiftARCContract,
                       "swift-arc-contract", "Swift ARC contraction",
                       false, false)
 INITIALIZE_PASS_DEPENDENCY(SwiftRCIdentity)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 INITIALIZE_PASS_END(SwiftARCContract,
                     "swift-arc-contract", "Swift ARC contraction",
                     false, false)
@@ -393,5 +657,8 @@ llvm::FunctionPass *swift::createSwiftARCContractPass() {
 
 void SwiftARCContract::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
   AU.addRequired<SwiftRCIdentity>();
+  AU.addRequired<DominatorTreeWrapperPass>();
+  AU.addRequired<PostDominatorTreeWrapperPass>();
+  AU.addRequired<LoopInfoWrapperPass>();
   AU.setPreservesCFG();
 }
@@ -14,7 +14,8 @@
 // constants in certain instructions.
 // Currently this is very Swift specific in the sense that it's intended to
 // merge specialized functions which only differ by loading different metadata
-// pointers.
+// pointers. Constants in loads, stores and calls are parameterized, and so are
+// references to type metadata and witness tables in any instruction.
 // TODO: It could make sense to generalize this pass and move it to LLVM.
 //
 // This pass should run after LLVM's MergeFunctions pass, because it works best
@@ -1111,6 +1112,38 @@ static bool isEligibleForConstantSharing(const Instruction *I) {
   }
 }
 
+/// Returns true if \p C refers to Swift type metadata or to a witness table.
+///
+/// Specializations of a generic function for layout-compatible types, e.g.
+/// different classes, usually only differ in those references. And they can
+/// appear in any instruction: compared against a loaded isa pointer, stored
+/// into an existential container, selected by a phi, etc.
+static bool isTypeMetadataOrWitnessTableRef(const Constant *C) {
+  // Look through casts and the offsets into full metadata.
+  while (auto *CE = dyn_cast<ConstantExpr>(C)) {
+    if (!CE->isCast() && CE->getOpcode() != Instruction::GetElementPtr)
+      return false;
+    C = CE->getOperand(0);
+  }
+  // Metadata accessors are functions; calls to them are shared anyway.
+  auto *GV = dyn_cast<GlobalValue>(C);
+  if (!GV || isa<Function>(GV))
+    return false;
+  StringRef Name = GV->getName();
+  return Name.startswith("_TM") || Name.startswith("_TW");
+}
+
+/// Returns true if the differing constants \p OpL and \p OpR of the
+/// instruction \p I can be replaced by a parameter.
+static bool isEligibleForConstantSharing(const Instruction *I,
+                                         const Constant *OpL,
+                                         const Constant *OpR) {
+  if (isEligibleForConstantSharing(I))
+    return true;
+  return isTypeMetadataOrWitnessTableRef(OpL) &&
+         isTypeMetadataOrWitnessTableRef(OpR);
+}
+
 int FunctionComparator::cmpOperands(const Instruction *L, const Instruction *R,
                                     unsigned opIdx) {
   Value *OpL = L->getOperand(opIdx);
@@ -1123,7 +1156,8 @@ int FunctionComparator::cmpOperands(const Instruction *L, const Instruction *R,
   if (!isa<Constant>(OpL) || !isa<Constant>(OpR))
     return Res;
 
-  if (!isEligibleForConstantSharing(L))
+  if (!isEligibleForConstantSharing(L, cast<Constant>(OpL),
+                                    cast<Constant>(OpR)))
     return Res;
 
   if (const CallInst *CL = dyn_cast<CallInst>(L)) {
@@ -1524,6 +1558,9 @@ private:
 
   bool constsDiffer(const FunctionInfos &FInfos, unsigned OpIdx);
 
+  bool areTypeMetadataOrWitnessTableRefs(const FunctionInfos &FInfos,
+                                         unsigned OpIdx);
+
   bool tryMapToParameter(FunctionInfos &FInfos, unsigned OpIdx,
                          ParamInfos &Params);
 
@@ -1875,17 +1912,20 @@ bool SwiftMergeFunctions::deriveParams(ParamInfos &Params,
 
   // Iterate over all instructions synchronously in all functions.
   do {
-    if (isEligibleForConstantSharing(FirstFI.CurrentInst)) {
-      for (unsigned OpIdx = 0, NumOps = FirstFI.CurrentInst->getNumOperands();
-           OpIdx != NumOps; ++OpIdx) {
-
-        if (constsDiffer(FInfos, OpIdx)) {
-          // This instruction has operands which differ in at least some
-          // functions. So we need to parameterize it.
-          if (!tryMapToParameter(FInfos, OpIdx, Params)) {
-            // We ran out of parameters.
-            return false;
-          }
+    bool Eligible = isEligibleForConstantSharing(FirstFI.CurrentInst);
+    for (unsigned OpIdx = 0, NumOps = FirstFI.CurrentInst->getNumOperands();
+         OpIdx != NumOps; ++OpIdx) {
+      // In other instructions only type metadata and witness table references
+      // are parameterized.
+      if (!Eligible && !areTypeMetadataOrWitnessTableRefs(FInfos, OpIdx))
+        continue;
+
+      if (constsDiffer(FInfos, OpIdx)) {
+        // This instruction has operands which differ in at least some
+        // functions. So we need to parameterize it.
+        if (!tryMapToParameter(FInfos, OpIdx, Params)) {
+          // We ran out of parameters.
+          return false;
         }
       }
     }
@@ -1916,6 +1956,20 @@ bool SwiftMergeFunctions::constsDiffer(const FunctionInfos &FInfos,
   return false;
 }
 
+/// Returns true if the \p OpIdx's operand in the current instruction is a
+/// reference to type metadata or a witness table in all the functions in
+/// \p FInfos.
+bool SwiftMergeFunctions::
+areTypeMetadataOrWitnessTableRefs(const FunctionInfos &FInfos,
+                                  unsigned OpIdx) {
+  for (const FunctionInfo &FI : FInfos) {
+    auto *C = dyn_cast<Constant>(FI.CurrentInst->getOperand(OpIdx));
+    if (!C || !isTypeMetadataOrWitnessTableRef(C))
+      return false;
+  }
+  return true;
+}
+
 /// Create a new parameter for differing operands or try to reuse an existing
 /// parameter.
 /// Returns true if a parameter could be created or found without exceeding the
@@ -27,6 +27,7 @@
 #include "llvm/ADT/Twine.h"
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
+#include <cstring>
 
 using namespace swift;
 
@@ -306,8 +307,30 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+/// Advance over whole eight-byte words that contain no newline, nul or
+/// non-ASCII byte, leaving the interesting bytes to the caller.
+static const char *skipPlainASCIIWords(const char *Ptr, const char *End) {
+  const uint64_t Ones = 0x0101010101010101ULL;
+  const uint64_t Highs = 0x8080808080808080ULL;
+  auto hasZeroByte = [&](uint64_t V) { return (V - Ones) & ~V & Highs; };
+
+  while (End - Ptr >= 8) {
+    uint64_t Word;
+    memcpy(&Word, Ptr, sizeof(Word));
+    if ((Word & Highs) || hasZeroByte(Word) ||
+        hasZeroByte(Word ^ (Ones * '\n')) ||
+        hasZeroByte(Word ^ (Ones * '\r')))
+      break;
+    Ptr += 8;
+  }
+  return Ptr;
+}
+
 void Lexer::skipToEndOfLine() {
   while (1) {
+    // Skip whole words of ordinary characters before looking at bytes.
+    CurPtr = skipPlainASCIIWords(CurPtr, BufferEnd);
+
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -568,8 +591,13 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start");
   (void) didStart;
 
-  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*, taking runs of ASCII characters
+  // without decoding them as UTF-8.
+  do {
+    while (CurPtr != BufferEnd && clang::isIdentifierBody(*CurPtr,
+                                                          /*dollar*/true))
+      ++CurPtr;
+  } while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1253,6 +1281,12 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Munch printable ASCII characters that can't end the literal or start
+    // an escape without going through lexCharacter.
+    while (CurPtr != BufferEnd && isPrintable(*CurPtr) && *CurPtr != '"' &&
+           *CurPtr != '\'' && *CurPtr != '\\')
+      ++CurPtr;
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -1670,6 +1704,9 @@ Restart:
   case '\t':
   case '\f':
   case '\v':
+    // Skip the rest of a run of indentation at once.
+    while (CurPtr != BufferEnd && (*CurPtr == ' ' || *CurPtr == '\t'))
+      ++CurPtr;
     goto Restart;  // Skip whitespace.
 
   case -1:
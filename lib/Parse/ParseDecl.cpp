@@ -4644,6 +4644,47 @@ bool Parser::parseAbstractFunctionBodyDelayed(AbstractFunctionDecl *AFD) {
   return false;
 }
 
+/// \brief Parse a new body for a function whose body was already parsed, from
+/// a lexer that covers exactly the new body.
+///
+/// Only the function's own generic parameters and parameters are put back in
+/// scope. Names from enclosing contexts are left to name lookup in Sema, the
+/// same way they are when the parser doesn't resolve names at all.
+bool Parser::reparseAbstractFunctionBody(AbstractFunctionDecl *AFD) {
+  assert(!isa<FuncDecl>(AFD) || !cast<FuncDecl>(AFD)->isAccessor());
+
+  // Prime the lexer.
+  if (Tok.is(tok::NUM_TOKENS))
+    consumeToken();
+  if (Tok.isNot(tok::l_brace))
+    return true;
+
+  Scope TopLevel(this, ScopeKind::TopLevel);
+  Scope GenericsScope(this, ScopeKind::Generics);
+  if (auto *GenericParams = AFD->getGenericParams())
+    for (auto *Param : *GenericParams)
+      addToScope(Param);
+
+  ScopeKind BodyKind = ScopeKind::FunctionBody;
+  if (isa<ConstructorDecl>(AFD))
+    BodyKind = ScopeKind::ConstructorBody;
+  else if (isa<DestructorDecl>(AFD))
+    BodyKind = ScopeKind::DestructorBody;
+  Scope S(this, BodyKind);
+  if (!isa<DestructorDecl>(AFD))
+    for (auto *PL : AFD->getParameterLists())
+      addParametersToScope(PL);
+
+  ParseFunctionBody CC(*this, AFD);
+  ParserResult<BraceStmt> Body =
+      parseBraceItemList(diag::func_decl_without_brace);
+  if (Body.isNull() || Tok.isNot(tok::eof))
+    return true;
+
+  AFD->setBody(Body.get());
+  return false;
+}
+
 /// \brief Parse a 'enum' declaration, returning true (and doing no token
 /// skipping) on error.
 ///
@@ -164,6 +164,23 @@ void swift::performDelayedParsing(
     parseDelayedDecl(PersistentState, CodeCompletionFactory);
 }
 
+bool swift::reparseAbstractFunctionBody(AbstractFunctionDecl *AFD,
+                                        unsigned BufferID, unsigned Offset,
+                                        unsigned EndOffset) {
+  SharedTimer timer("Parsing");
+  SourceFile &SF = *AFD->getDeclContext()->getParentSourceFile();
+  ASTContext &Ctx = SF.getASTContext();
+  std::unique_ptr<Lexer> Lex(new Lexer(Ctx.LangOpts, Ctx.SourceMgr, BufferID,
+                                       &Ctx.Diags, /*InSILMode=*/false,
+                                       Ctx.LangOpts.AttachCommentsToDecls
+                                       ? CommentRetentionMode::AttachToNextToken
+                                       : CommentRetentionMode::None,
+                                       Offset, EndOffset));
+  Parser TheParser(std::move(Lex), SF);
+  PrettyStackTraceParser StackTrace(TheParser);
+  return TheParser.reparseAbstractFunctionBody(AFD);
+}
+
 /// \brief Tokenizes a string literal, taking into account string interpolation.
 static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
                                 const SourceManager &SM,
@@ -35,6 +35,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <set>
 
 using namespace swift;
 
@@ -1683,6 +1684,30 @@ struct PointerLikeComparator {
   }
 };
 
+/// Orders \p lhs and \p rhs by the name of the file they're in and then by
+/// their position in it, and not by the order of files in the module, which
+/// is the order in which they were passed to the compiler. Returns 0 for decls
+/// without locations.
+static int compareSourceOrder(const Decl *lhs, const Decl *rhs) {
+  SourceLoc lhsLoc = lhs->getLoc();
+  SourceLoc rhsLoc = rhs->getLoc();
+  if (lhsLoc.isInvalid() || rhsLoc.isInvalid())
+    return 0;
+
+  const SourceManager &SM = lhs->getASTContext().SourceMgr;
+  unsigned lhsBuffer = SM.findBufferContainingLoc(lhsLoc);
+  unsigned rhsBuffer = SM.findBufferContainingLoc(rhsLoc);
+  if (lhsBuffer != rhsBuffer) {
+    StringRef lhsFile = SM.getIdentifierForBuffer(lhsBuffer);
+    return lhsFile.compare(SM.getIdentifierForBuffer(rhsBuffer));
+  }
+  unsigned lhsOffset = SM.getLocOffsetInBuffer(lhsLoc, lhsBuffer);
+  unsigned rhsOffset = SM.getLocOffsetInBuffer(rhsLoc, rhsBuffer);
+  if (lhsOffset != rhsOffset)
+    return lhsOffset < rhsOffset ? -1 : 1;
+  return 0;
+}
+
 class ModuleWriter {
   enum class EmissionState {
     NotYetDefined = 0,
@@ -2196,33 +2221,38 @@ public:
   void writeImports(raw_ostream &out) {
     out << "#if defined(__has_feature) && __has_feature(modules)\n";
 
-    // Track printed names to handle overlay modules.
-    llvm::SmallPtrSet<Identifier, 8> seenImports;
+    // Print the imports sorted by name, rather than in the order in which
+    // the decls that need them were printed, so that a change to one decl
+    // doesn't reorder the imports of the whole header. Overlay modules have
+    // the same name as their underlying Clang module, so the set also
+    // removes duplicates.
+    std::set<std::string> importNames;
     bool includeUnderlying = false;
     for (auto import : imports) {
       if (auto *swiftModule = import.dyn_cast<Module *>()) {
-        auto Name = swiftModule->getName();
         if (isUnderlyingModule(swiftModule)) {
           includeUnderlying = true;
           continue;
         }
-        if (seenImports.insert(Name).second)
-          out << "@import " << Name.str() << ";\n";
+        importNames.insert(swiftModule->getName().str());
       } else {
         const auto *clangModule = import.get<const clang::Module *>();
-        out << "@import ";
         // FIXME: This should be an API on clang::Module.
         SmallVector<StringRef, 4> submoduleNames;
         do {
           submoduleNames.push_back(clangModule->Name);
           clangModule = clangModule->Parent;
         } while (clangModule);
+        std::string name;
+        llvm::raw_string_ostream nameOS(name);
         interleave(submoduleNames.rbegin(), submoduleNames.rend(),
-                   [&out](StringRef next) { out << next; },
-                   [&out] { out << "."; });
-        out << ";\n";
+                   [&nameOS](StringRef next) { nameOS << next; },
+                   [&nameOS] { nameOS << "."; });
+        importNames.insert(nameOS.str());
       }
     }
+    for (auto &name : importNames)
+      out << "@import " << name << ";\n";
 
     out << "#endif\n\n";
 
@@ -2314,7 +2344,7 @@ public:
         return nextLHSProto->getName() != nextRHSProto->getName();
       });
       if (mismatch.first == lhsProtos.end())
-        return Equivalent;
+        return compareSourceOrder(*rhs, *lhs);
       StringRef lhsProtoName = (*mismatch.first)->getName().str();
       return lhsProtoName.compare((*mismatch.second)->getName().str());
     });
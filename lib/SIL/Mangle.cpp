@@ -143,6 +143,20 @@ setArgumentBoxToStack(unsigned ArgNo) {
   Args[ArgNo].first = ArgumentModifierIntBase(ArgumentModifier::BoxToStack);
 }
 
+void
+FunctionSignatureSpecializationMangler::
+setArgumentExistentialToGeneric(unsigned ArgNo) {
+  Args[ArgNo].first =
+      ArgumentModifierIntBase(ArgumentModifier::ExistentialToGeneric);
+}
+
+void
+FunctionSignatureSpecializationMangler::
+setArgumentIndirectToDirect(unsigned ArgNo) {
+  Args[ArgNo].first =
+      ArgumentModifierIntBase(ArgumentModifier::IndirectToDirect);
+}
+
 void
 FunctionSignatureSpecializationMangler::
 setReturnValueOwnedToUnowned() {
@@ -269,6 +283,17 @@ void FunctionSignatureSpecializationMangler::mangleArgument(
     return;
   }
 
+  if (ArgMod ==
+      ArgumentModifierIntBase(ArgumentModifier::ExistentialToGeneric)) {
+    M.append("e");
+    return;
+  }
+
+  if (ArgMod == ArgumentModifierIntBase(ArgumentModifier::IndirectToDirect)) {
+    M.append("a");
+    return;
+  }
+
   bool hasSomeMod = false;
   if (ArgMod & ArgumentModifierIntBase(ArgumentModifier::Dead)) {
     M.append("d");
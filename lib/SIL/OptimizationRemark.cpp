@@ -0,0 +1,117 @@
+//===--- OptimizationRemark.cpp - Remarks about missed optimizations ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SIL/OptimizationRemark.h"
+#include "swift/Basic/SourceManager.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/YAMLTraits.h"
+#include <vector>
+
+using namespace swift;
+using namespace OptRemark;
+
+Argument::Argument(StringRef Key, int N) : Key(Key), Val(llvm::itostr(N)) {}
+
+Argument::Argument(StringRef Key, unsigned N)
+  : Key(Key), Val(llvm::utostr(N)) {}
+
+Argument::Argument(StringRef Key, const SILFunction *F)
+  : Key(Key), Val(F->getName()) {}
+
+RemarkMissed::RemarkMissed(StringRef PassName, StringRef Identifier,
+                           SILInstruction &I)
+  : PassName(PassName), Identifier(Identifier), Function(I.getFunction()),
+    Loc(I.getLoc().getSourceLoc()) {}
+
+bool OptRemark::isEnabled(SILModule &M) {
+  return M.getOptRecordStream() != nullptr;
+}
+
+namespace {
+/// The YAML form of a remark's location.
+struct DebugLocRecord {
+  StringRef File;
+  unsigned Line = 0;
+  unsigned Column = 0;
+};
+
+/// The YAML form of a remark.
+struct RemarkRecord {
+  StringRef Pass;
+  StringRef Name;
+  StringRef Function;
+  bool HasLoc = false;
+  DebugLocRecord Loc;
+  std::vector<Argument> Args;
+};
+} // end anonymous namespace
+
+LLVM_YAML_IS_SEQUENCE_VECTOR(Argument)
+
+namespace llvm {
+namespace yaml {
+
+template <> struct MappingTraits<DebugLocRecord> {
+  static void mapping(IO &io, DebugLocRecord &L) {
+    io.mapRequired("File", L.File);
+    io.mapRequired("Line", L.Line);
+    io.mapRequired("Column", L.Column);
+  }
+
+  static const bool flow = true;
+};
+
+template <> struct MappingTraits<Argument> {
+  static void mapping(IO &io, Argument &A) {
+    io.mapRequired(A.Key.c_str(), A.Val);
+  }
+};
+
+template <> struct MappingTraits<RemarkRecord> {
+  static void mapping(IO &io, RemarkRecord &R) {
+    io.mapTag("!Missed", true);
+    io.mapRequired("Pass", R.Pass);
+    io.mapRequired("Name", R.Name);
+    if (R.HasLoc)
+      io.mapRequired("DebugLoc", R.Loc);
+    io.mapRequired("Function", R.Function);
+    io.mapRequired("Args", R.Args);
+  }
+};
+
+} // end namespace yaml
+} // end namespace llvm
+
+void OptRemark::emit(SILModule &M, const RemarkMissed &R) {
+  llvm::yaml::Output *Out = M.getOptRecordStream();
+  if (!Out)
+    return;
+
+  RemarkRecord Record;
+  Record.Pass = R.getPassName();
+  Record.Name = R.getIdentifier();
+  Record.Function = R.getFunction()->getName();
+  Record.Args.assign(R.getArgs().begin(), R.getArgs().end());
+
+  SourceLoc Loc = R.getLocation();
+  if (Loc.isValid()) {
+    SourceManager &SM = M.getASTContext().SourceMgr;
+    Record.HasLoc = true;
+    Record.Loc.File = SM.getBufferIdentifierForLoc(Loc);
+    std::tie(Record.Loc.Line, Record.Loc.Column) = SM.getLineAndColumn(Loc);
+  }
+
+  *Out << Record;
+}
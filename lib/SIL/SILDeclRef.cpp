@@ -16,6 +16,7 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Mangle.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Timer.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/SIL/SILLinkage.h"
@@ -605,8 +606,29 @@ static std::string mangleConstant(SILDeclRef c, StringRef prefix) {
 }
 
 std::string SILDeclRef::mangle(StringRef prefix) const {
-  return mangleConstant(*this, prefix);
- }
+  // Custom prefixes are only used for a handful of thunks; just cache the
+  // common case.
+  if (!prefix.empty()) {
+    SharedTimer timer("Mangling");
+    return mangleConstant(*this, prefix);
+  }
+
+  ASTContext &ctx = hasDecl() ? getDecl()->getASTContext()
+                              : getAbstractClosureExpr()->getASTContext();
+  unsigned discriminator = unsigned(kind)
+                         | (uncurryLevel << 4)
+                         | (Expansion << 12)
+                         | (isCurried << 13)
+                         | (isForeign << 14)
+                         | (isDirectReference << 15)
+                         | (defaultArgIndex << 16);
+  auto &name = ctx.MangledNameCache[{loc.getOpaqueValue(), discriminator}];
+  if (name.empty()) {
+    SharedTimer timer("Mangling");
+    name = mangleConstant(*this, prefix);
+  }
+  return name;
+}
 
 SILDeclRef SILDeclRef::getNextOverriddenVTableEntry() const {
   if (auto overridden = getOverridden()) {
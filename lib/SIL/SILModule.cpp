@@ -25,6 +25,9 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/YAMLTraits.h"
+#include <algorithm>
 #include <functional>
 using namespace swift;
 using namespace Lowering;
@@ -107,13 +110,102 @@ void *SILModule::allocate(unsigned Size, unsigned Align) const {
 }
 
 void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
-  return AlignedAlloc(Size, Align);
+  void *Mem = AlignedAlloc(Size, Align);
+  if (getOptions().PrintMemoryStats)
+    InstAllocationSizes[Mem] = Size;
+  return Mem;
 }
 
 void SILModule::deallocateInst(SILInstruction *I) {
+  if (getOptions().PrintMemoryStats)
+    InstAllocationSizes.erase(I);
   AlignedFree(I);
 }
 
+static StringRef getInstructionKindName(ValueKind Kind) {
+  switch (Kind) {
+#define INST(Id, Parent, MemBehavior, MayRelease) \
+  case ValueKind::Id:                             \
+    return #Id;
+#include "swift/SIL/SILNodes.def"
+  default:
+    llvm_unreachable("not an instruction");
+  }
+}
+
+void SILModule::printMemoryStats(raw_ostream &OS) const {
+  struct KindStats {
+    ValueKind Kind = ValueKind::First_SILInstruction;
+    unsigned Count = 0;
+    unsigned NumOperands = 0;
+    uint64_t Bytes = 0;
+  };
+  SmallVector<KindStats, 128> Stats(
+      unsigned(ValueKind::Last_SILInstruction) + 1);
+
+  unsigned NumFunctions = 0;
+  unsigned NumBlocks = 0;
+  unsigned NumBBArgs = 0;
+  llvm::SmallPtrSet<const SILDebugScope *, 64> Scopes;
+  for (const SILFunction &F : *this) {
+    ++NumFunctions;
+    for (const SILBasicBlock &BB : F) {
+      ++NumBlocks;
+      NumBBArgs += BB.getNumBBArg();
+      for (const SILInstruction &I : BB) {
+        KindStats &S = Stats[unsigned(I.getKind())];
+        S.Kind = I.getKind();
+        ++S.Count;
+        S.NumOperands += I.getNumOperands();
+        auto It = InstAllocationSizes.find(&I);
+        if (It != InstAllocationSizes.end())
+          S.Bytes += It->second;
+        Scopes.insert(I.getDebugScope());
+      }
+    }
+  }
+
+  Stats.erase(std::remove_if(Stats.begin(), Stats.end(),
+                             [](const KindStats &S) { return S.Count == 0; }),
+              Stats.end());
+  std::stable_sort(Stats.begin(), Stats.end(),
+                   [](const KindStats &LHS, const KindStats &RHS) {
+    return LHS.Bytes > RHS.Bytes;
+  });
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << std::string(28, ' ') << "SIL memory statistics\n"
+     << "===" << std::string(73, '-') << "===\n";
+  OS << llvm::format("%10s %10s %14s  %s\n",
+                     "count", "operands", "bytes", "instruction");
+
+  KindStats Total;
+  for (const KindStats &S : Stats) {
+    OS << llvm::format("%10u %10u %14llu  %s\n", S.Count, S.NumOperands,
+                       (unsigned long long)S.Bytes,
+                       getInstructionKindName(S.Kind).data());
+    Total.Count += S.Count;
+    Total.NumOperands += S.NumOperands;
+    Total.Bytes += S.Bytes;
+  }
+  OS << llvm::format("%10u %10u %14llu  %s\n", Total.Count, Total.NumOperands,
+                     (unsigned long long)Total.Bytes, "total");
+
+  OS << "\n"
+     << llvm::format("%10u  functions\n", NumFunctions)
+     << llvm::format("%10u  basic blocks\n", NumBlocks)
+     << llvm::format("%10u  basic block arguments\n", NumBBArgs)
+     << llvm::format("%10u  distinct debug scopes\n", Scopes.size())
+     << llvm::format("%10llu  instruction bytes in operands (%u each)\n",
+                     (unsigned long long)Total.NumOperands * sizeof(Operand),
+                     unsigned(sizeof(Operand)))
+     << llvm::format("%10llu  instruction bytes in locations (%u each)\n",
+                     (unsigned long long)Total.Count * sizeof(SILDebugLocation),
+                     unsigned(sizeof(SILDebugLocation)))
+     << llvm::format("%10llu  bytes allocated for everything else\n",
+                     (unsigned long long)BPA.getTotalMemory());
+}
+
 SILWitnessTable *
 SILModule::createWitnessTableDeclaration(ProtocolConformance *C,
                                          SILLinkage linkage) {
@@ -494,6 +586,33 @@ bool SILModule::linkFunction(StringRef Name, SILModule::LinkingMode Mode) {
   return SILLinkerVisitor(*this, getSILLoader(), Mode).processFunction(Name);
 }
 
+bool SILModule::linkFunctionOnDemand(SILFunction *Fun, unsigned MaxSize) {
+  if (!Fun->isExternalDeclaration())
+    return false;
+
+  auto Size = getSILLoader()->getSILFunctionBodySize(Fun->getName());
+  if (!Size || *Size > MaxSize)
+    return false;
+
+  return linkFunction(Fun, LinkingMode::LinkNormal);
+}
+
+Optional<StringRef> SILModule::lookupEffectsSummary(StringRef Name) {
+  auto It = EffectsSummaries.find(Name);
+  if (It != EffectsSummaries.end())
+    return StringRef(It->second);
+
+  return getSILLoader()->lookupEffectsSummary(Name);
+}
+
+void SILModule::setOptRecordStream(
+    std::unique_ptr<llvm::raw_ostream> RawStream) {
+  OptRecordStream.reset();
+  OptRecordRawStream = std::move(RawStream);
+  if (OptRecordRawStream)
+    OptRecordStream.reset(new llvm::yaml::Output(*OptRecordRawStream));
+}
+
 SILFunction *SILModule::hasFunction(StringRef Name, SILLinkage Linkage) {
   assert((Linkage == SILLinkage::Public ||
           Linkage == SILLinkage::PublicExternal) &&
@@ -536,6 +536,11 @@ public:
       for (auto Id : PredIDs)
         *this << ' ' << Id;
     }
+
+    if (auto Count = BB->getExecutionCount()) {
+      PrintState.OS.PadToColumn(50);
+      *this << "// count: " << *Count;
+    }
     *this << '\n';
 
     for (const SILInstruction &I : *BB) {
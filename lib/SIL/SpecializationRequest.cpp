@@ -0,0 +1,57 @@
+//===--- SpecializationRequest.cpp - Requested specializations ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SIL/SpecializationRequest.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/YAMLTraits.h"
+
+using namespace swift;
+
+LLVM_YAML_IS_FLOW_SEQUENCE_VECTOR(std::string)
+LLVM_YAML_IS_SEQUENCE_VECTOR(SpecializationRequest)
+
+namespace llvm {
+namespace yaml {
+
+template <> struct MappingTraits<SpecializationRequest> {
+  static void mapping(IO &io, SpecializationRequest &R) {
+    io.mapRequired("Function", R.Function);
+    io.mapRequired("Substitutions", R.Substitutions);
+  }
+};
+
+} // end namespace yaml
+} // end namespace llvm
+
+void swift::writeSpecializationRequests(
+    raw_ostream &OS, ArrayRef<SpecializationRequest> Requests) {
+  std::vector<SpecializationRequest> Sequence(Requests.begin(),
+                                              Requests.end());
+  llvm::yaml::Output Out(OS);
+  Out << Sequence;
+}
+
+std::error_code swift::readSpecializationRequests(
+    StringRef Path, std::vector<SpecializationRequest> &Requests) {
+  auto BufferOrErr = llvm::MemoryBuffer::getFile(Path);
+  if (!BufferOrErr)
+    return BufferOrErr.getError();
+
+  std::vector<SpecializationRequest> Sequence;
+  llvm::yaml::Input In(BufferOrErr.get()->getBuffer());
+  In >> Sequence;
+  if (In.error())
+    return In.error();
+
+  Requests.insert(Requests.end(), Sequence.begin(), Sequence.end());
+  return std::error_code();
+}
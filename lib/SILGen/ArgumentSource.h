@@ -213,6 +213,7 @@ public:
 
   bool isRValue() const & { return StoredKind == Kind::RValue; }
   bool isLValue() const & { return StoredKind == Kind::LValue; }
+  bool isExpr() const & { return StoredKind == Kind::Expr; }
 
   /// Given that this source is storing an RValue, extract and clear
   /// that value.
@@ -27,6 +27,7 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
 #include "RValue.h"
 using namespace swift;
@@ -39,6 +40,15 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const std::string &ProfilePath = M.getOptions().UseProfile;
+  if (!ProfilePath.empty()) {
+    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfilePath);
+    if (auto E = ReaderOrErr.takeError())
+      diagnose(SourceLoc(), diag::profile_read_error, ProfilePath,
+               llvm::toString(std::move(E)));
+    else
+      ProfileReader = std::move(ReaderOrErr.get());
+  }
 }
 
 SILGenModule::~SILGenModule() {
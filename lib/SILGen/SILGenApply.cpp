@@ -3040,6 +3040,14 @@ namespace {
 
       // If no abstraction is required, try to honor the emission contexts.
       if (loweredSubstArgType.getSwiftRValueType() == param.getType()) {
+        // An owned address-only argument expression can be emitted directly
+        // into the buffer that is passed to the callee. Otherwise, an
+        // aggregate like a tuple literal is built in a temporary of its own
+        // and then copied.
+        if (param.isConsumed() && arg.isExpr() &&
+            SGF.getTypeLowering(loweredSubstArgType).isAddressOnly())
+          return std::move(arg).materialize(SGF);
+
         auto loc = arg.getLocation();
         ManagedValue result =
           std::move(arg).getAsSingleValue(SGF, contexts.ForEmission);
@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -83,10 +84,11 @@ ProfilerRAII::ProfilerRAII(SILGenModule &SGM, Decl *D)
   assert(isa<AbstractFunctionDecl>(D) ||
          isa<TopLevelCodeDecl>(D) && "Cannot create profiler for this decl");
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile || isUnmappedDecl(D))
+  if ((!Opts.GenerateProfile && !SGM.ProfileReader) || isUnmappedDecl(D))
     return;
-  SGM.Profiler =
-      llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
+  SGM.Profiler = llvm::make_unique<SILGenProfiling>(
+      SGM, Opts.GenerateProfile && Opts.EmitProfileCoverageMapping,
+      Opts.GenerateProfile);
   SGM.Profiler->assignRegionCounters(D);
 }
 
@@ -728,6 +730,20 @@ void SILGenProfiling::assignRegionCounters(Decl *Root) {
                                    getEquivalentPGOLinkage(CurrentFuncLinkage)),
                                FunctionHash, RegionCounterMap, CurrentFileName);
   }
+
+  if (SGM.ProfileReader) {
+    std::string PGOFuncName = llvm::getPGOFuncName(
+        CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
+        CurrentFileName);
+    // A missing or stale record just means there are no counts to use.
+    if (auto E = SGM.ProfileReader->getFunctionCounts(PGOFuncName, FunctionHash,
+                                                      RegionCounts)) {
+      llvm::consumeError(std::move(E));
+      RegionCounts.clear();
+    } else if (RegionCounts.size() != NumRegionCounters) {
+      RegionCounts.clear();
+    }
+  }
 }
 
 static SILLocation getLocation(ASTNode Node) {
@@ -748,6 +764,16 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   assert(CounterIt != RegionCounterMap.end() &&
          "cannot increment non-existent counter");
 
+  if (!RegionCounts.empty() && Builder.hasValidInsertionPoint()) {
+    uint64_t Count = RegionCounts[CounterIt->second];
+    Builder.getInsertionBB()->setExecutionCount(Count);
+    if (CounterIt->second == 0)
+      Builder.getFunction().setEntryCount(Count);
+  }
+
+  if (!EmitIncrements)
+    return;
+
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
 
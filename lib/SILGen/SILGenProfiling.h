@@ -35,6 +35,9 @@ private:
   SILGenModule &SGM;
   bool EmitCoverageMapping;
 
+  /// Whether to emit the builtins that increment the counters at runtime.
+  bool EmitIncrements;
+
   // The current function's name and counter data.
   std::string CurrentFuncName;
   StringRef CurrentFileName;
@@ -43,16 +46,24 @@ private:
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The counts recorded for the current function in the -profile-use data,
+  /// indexed by counter, or empty if there are none.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
-  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping)
+  SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping,
+                  bool EmitIncrements)
       : SGM(SGM), EmitCoverageMapping(EmitCoverageMapping),
-        NumRegionCounters(0), FunctionHash(0) {}
+        EmitIncrements(EmitIncrements), NumRegionCounters(0), FunctionHash(0) {}
 
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
   /// Emit SIL to increment the counter for \c Node.
+  ///
+  /// If there is profile data for the function, this also records the count
+  /// of \c Node on the current block.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 
 private:
@@ -14,6 +14,7 @@
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "ARCSequenceOpts.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SILOptimizer/Utils/Local.h"
@@ -78,6 +79,8 @@ bool ARCPairingContext::performMatching(
   DEBUG(llvm::dbgs() << "**** Computing ARC Matching Sets for " << F.getName()
                      << " ****\n");
 
+  bool RemarksEnabled = OptRemark::isEnabled(F.getModule());
+
   /// For each increment that we matched to a decrement, try to match it to a
   /// decrement -> increment pair.
   for (auto Pair : IncToDecStateMap) {
@@ -91,24 +94,42 @@ bool ARCPairingContext::performMatching(
     DEBUG(llvm::dbgs() << "Constructing Matching Set For: " << *Increment);
     ARCMatchingSetBuilder Builder(DecToIncStateMap, IncToDecStateMap, RCIA);
     Builder.init(Increment);
-    if (Builder.matchUpIncDecSetsForPtr()) {
-      MatchedPair |= Builder.matchedPair();
-      auto &Set = Builder.getResult();
-      for (auto *I : Set.Increments)
-        IncToDecStateMap.blot(I);
-      for (auto *I : Set.Decrements)
-        DecToIncStateMap.blot(I);
-
-      // Add the Set to the callback. *NOTE* No instruction destruction can
-      // happen here since we may remove instructions that are insertion points
-      // for other instructions.
-      optimizeMatchingSet(Set, NewInsts, DeadInsts);
+    if (!Builder.matchUpIncDecSetsForPtr()) {
+      if (RemarksEnabled)
+        UnmatchedIncrements.insert(Increment);
+      continue;
     }
+
+    MatchedPair |= Builder.matchedPair();
+    auto &Set = Builder.getResult();
+    for (auto *I : Set.Increments) {
+      IncToDecStateMap.blot(I);
+      UnmatchedIncrements.remove(I);
+    }
+    for (auto *I : Set.Decrements)
+      DecToIncStateMap.blot(I);
+
+    // Add the Set to the callback. *NOTE* No instruction destruction can
+    // happen here since we may remove instructions that are insertion points
+    // for other instructions.
+    optimizeMatchingSet(Set, NewInsts, DeadInsts);
   }
 
   return MatchedPair;
 }
 
+void ARCPairingContext::emitUnmatchedRemarks() {
+  for (SILInstruction *Increment : UnmatchedIncrements) {
+    OptRemark::emit(F.getModule(),
+                    OptRemark::RemarkMissed(DEBUG_TYPE, "UnmatchedRetain",
+                                            *Increment)
+                      << OptRemark::Argument(
+                           "Reason", "no matching release it can be paired "
+                                     "with safely"));
+  }
+  UnmatchedIncrements.clear();
+}
+
 //===----------------------------------------------------------------------===//
 //                                  Loop ARC
 //===----------------------------------------------------------------------===//
@@ -230,6 +251,12 @@ processFunctionWithoutLoopSupport(SILFunction &F, bool FreezePostDomReleases,
 
   DEBUG(llvm::dbgs() << "\n");
 
+  // The function is only processed again if something changed, so this is the
+  // final result unless we are about to reprocess it with frozen post
+  // dominating releases.
+  if (!Changed || FreezePostDomReleases)
+    Context.Context.emitUnmatchedRemarks();
+
   // Return true if we moved or deleted any instructions.
   return Changed;
 }
@@ -252,7 +279,9 @@ static bool processFunctionWithLoopSupport(
   DEBUG(llvm::dbgs() << "***** Processing " << F.getName() << " *****\n");
 
   LoopARCPairingContext Context(F, AA, LRFI, LI, RCFI, EAFI, PTFI);
-  return Context.process();
+  bool Changed = Context.process();
+  Context.Context.emitUnmatchedRemarks();
+  return Changed;
 }
 
 //===----------------------------------------------------------------------===//
@@ -37,11 +37,18 @@ struct ARCPairingContext {
   RCIdentityFunctionInfo *RCIA;
   bool MadeChange = false;
 
+  /// The increments which could not be matched up so far. Only collected if
+  /// optimization remarks are recorded.
+  llvm::SmallSetVector<SILInstruction *, 4> UnmatchedIncrements;
+
   ARCPairingContext(SILFunction &F, RCIdentityFunctionInfo *RCIA)
       : F(F), DecToIncStateMap(), IncToDecStateMap(), RCIA(RCIA) {}
   bool performMatching(llvm::SmallVectorImpl<SILInstruction *> &NewInsts,
                        llvm::SmallVectorImpl<SILInstruction *> &DeadInsts);
 
+  /// Emits a remark for each increment which is still unmatched.
+  void emitUnmatchedRemarks();
+
   void optimizeMatchingSet(ARCMatchingSet &MatchSet,
                            llvm::SmallVectorImpl<SILInstruction *> &NewInsts,
                            llvm::SmallVectorImpl<SILInstruction *> &DeadInsts);
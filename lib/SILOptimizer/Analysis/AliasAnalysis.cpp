@@ -542,11 +542,14 @@ AliasResult AliasAnalysis::alias(SILValue V1, SILValue V2,
   // Check if we've already computed this result.
   auto It = AliasCache.find(Key);
   if (It != AliasCache.end()) {
+    ++AliasCacheStats.Hits;
     return It->second;
   }
+  ++AliasCacheStats.Misses;
 
   // Flush the cache if the size of the cache is too large.
   if (AliasCache.size() > AliasAnalysisMaxCacheSize) {
+    ++AliasCacheStats.Flushes;
     AliasCache.clear();
     AliasValueBaseToIndex.clear();
 
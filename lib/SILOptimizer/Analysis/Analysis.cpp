@@ -27,6 +27,14 @@
 
 using namespace swift;
 
+void AnalysisCacheStats::print(raw_ostream &OS, StringRef Name) const {
+  unsigned Queries = Hits + Misses;
+  OS << Name << " cache: " << Queries << " queries, " << Hits << " hits";
+  if (Queries)
+    OS << " (" << (uint64_t(Hits) * 100 / Queries) << "%)";
+  OS << ", " << Flushes << " flushes\n";
+}
+
 void SILAnalysis::verifyFunction(SILFunction *F) {
   // Only functions with bodies can be analyzed by the analysis.
   assert(F->isDefinition() && "Can't analyze external functions");
@@ -13,6 +13,7 @@
 #include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILFunction.h"
 
 using namespace swift;
 
@@ -106,11 +107,33 @@ ColdBlockInfo::BranchHint ColdBlockInfo::getBranchHint(SILValue Cond,
   return BranchHint::None;
 }
 
+/// Compare the profile count of ToBB with the count of FromBB, or the entry
+/// count of the function if FromBB doesn't have one.
+Optional<bool>
+ColdBlockInfo::isSlowPathFromProfile(const SILBasicBlock *FromBB,
+                                     const SILBasicBlock *ToBB) {
+  Optional<uint64_t> ToCount = ToBB->getExecutionCount();
+  if (!ToCount)
+    return None;
+
+  Optional<uint64_t> FromCount = FromBB->getExecutionCount();
+  if (!FromCount)
+    FromCount = FromBB->getParent()->getEntryCount();
+  if (!FromCount || *FromCount == 0)
+    return None;
+
+  return *ToCount * ColdCountRatio < *FromCount;
+}
+
 /// \return true if the CFG edge FromBB->ToBB is directly gated by a _slowPath
-/// branch hint.
+/// branch hint, or if the profile shows that ToBB is rarely executed compared
+/// to FromBB.
 bool ColdBlockInfo::isSlowPath(const SILBasicBlock *FromBB,
                                const SILBasicBlock *ToBB,
                                int recursionDepth) {
+  if (Optional<bool> IsSlow = isSlowPathFromProfile(FromBB, ToBB))
+    return *IsSlow;
+
   auto *CBI = dyn_cast<CondBranchInst>(FromBB->getTerminator());
   if (!CBI)
     return false;
@@ -19,11 +19,24 @@
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/DebugUtils.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+STATISTIC(NumOverflowedGraphs,
+          "Number of connection graphs which exceeded the size limit");
+
+/// Huge functions would make the graph too expensive to build and merge.
+/// Beyond this limit, all new values share a single node, which escapes
+/// globally.
+static llvm::cl::opt<unsigned> MaxGraphSize(
+    "escape-analysis-max-graph-size", llvm::cl::init(5000),
+    llvm::cl::desc("The number of nodes in a connection graph after which "
+                   "escape analysis treats further values as escaping"));
+
 static bool isProjection(ValueBase *V) {
   switch (V->getKind()) {
     case ValueKind::IndexAddrInst:
@@ -86,6 +99,7 @@ void EscapeAnalysis::ConnectionGraph::clear() {
   Values2Nodes.clear();
   Nodes.clear();
   ReturnNode = nullptr;
+  OverflowNode = nullptr;
   UsePoints.clear();
   NodeAllocator.DestroyAll();
   assert(ToMerge.empty());
@@ -114,9 +128,16 @@ getNode(ValueBase *V, EscapeAnalysis *EA, bool createIfNeeded) {
         Node = allocNode(V, NodeType::Argument);
         if (!isSummaryGraph)
           Node->mergeEscapeState(EscapeState::Arguments);
-      } else {
-        Node = allocNode(V, NodeType::Value);
+        return Node->getMergeTarget();
       }
+    }
+    if (Nodes.size() >= MaxGraphSize) {
+      if (!OverflowNode) {
+        OverflowNode = allocNode(nullptr, NodeType::Value);
+        setEscapesGlobal(OverflowNode);
+        ++NumOverflowedGraphs;
+      }
+      Node = OverflowNode;
     } else {
       Node = allocNode(V, NodeType::Value);
     }
@@ -666,6 +687,11 @@ std::string CGForDotView::getNodeLabel(const Node *Node) const {
       O << "return";
       break;
     default: {
+      // The overflow node doesn't represent a single value.
+      if (!Node->OrigNode->V) {
+        O << "overflow";
+        break;
+      }
       std::string Inst;
       llvm::raw_string_ostream OI(Inst);
       SILValue(Node->OrigNode->V)->print(OI);
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
+#include "swift/Basic/Range.h"
 #include "swift/SIL/SILBasicBlock.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
@@ -20,6 +21,22 @@
 
 using namespace swift;
 
+void BottomUpFunctionOrder::forEachCallee(
+    SILFunction *F, llvm::function_ref<void(SILFunction *)> Visit) {
+  // Visit all the instructions, looking for apply sites.
+  for (auto &B : *F) {
+    for (auto &I : B) {
+      auto FAS = FullApplySite::isa(&I);
+      if (!FAS && !isa<StrongReleaseInst>(&I) && !isa<ReleaseValueInst>(&I))
+        continue;
+
+      auto Callees = FAS ? BCA->getCalleeList(FAS) : BCA->getCalleeList(&I);
+      for (auto *CalleeFn : Callees)
+        Visit(CalleeFn);
+    }
+  }
+}
+
 /// Use Tarjan's strongly connected components (SCC) algorithm to find
 /// the SCCs in the call graph.
 void BottomUpFunctionOrder::DFS(SILFunction *Start) {
@@ -36,27 +53,17 @@ void BottomUpFunctionOrder::DFS(SILFunction *Start) {
 
   DFSStack.insert(Start);
 
-  // Visit all the instructions, looking for apply sites.
-  for (auto &B : *Start) {
-    for (auto &I : B) {
-      auto FAS = FullApplySite::isa(&I);
-      if (!FAS && !isa<StrongReleaseInst>(&I) && !isa<ReleaseValueInst>(&I))
-        continue;
-
-      auto Callees = FAS ? BCA->getCalleeList(FAS) : BCA->getCalleeList(&I);
-      for (auto *CalleeFn : Callees) {
-        // If not yet visited, visit the callee.
-        if (DFSNum.find(CalleeFn) == DFSNum.end()) {
-          DFS(CalleeFn);
-          MinDFSNum[Start] = std::min(MinDFSNum[Start], MinDFSNum[CalleeFn]);
-        } else if (DFSStack.count(CalleeFn)) {
-          // If the callee is on the stack, it update our minimum DFS
-          // number based on it's DFS number.
-          MinDFSNum[Start] = std::min(MinDFSNum[Start], DFSNum[CalleeFn]);
-        }
-      }
+  forEachCallee(Start, [&](SILFunction *CalleeFn) {
+    // If not yet visited, visit the callee.
+    if (DFSNum.find(CalleeFn) == DFSNum.end()) {
+      DFS(CalleeFn);
+      MinDFSNum[Start] = std::min(MinDFSNum[Start], MinDFSNum[CalleeFn]);
+    } else if (DFSStack.count(CalleeFn)) {
+      // If the callee is on the stack, it update our minimum DFS
+      // number based on it's DFS number.
+      MinDFSNum[Start] = std::min(MinDFSNum[Start], DFSNum[CalleeFn]);
     }
-  }
+  });
 
   // If our DFS number is the minimum found, we've found a
   // (potentially singleton) SCC, so pop the nodes off the stack and
@@ -78,3 +85,29 @@ void BottomUpFunctionOrder::FindSCCs(SILModule &M) {
   for (auto &F : M)
     DFS(&F);
 }
+
+ArrayRef<unsigned> BottomUpFunctionOrder::getSCCLevels() {
+  if (!TheSCCLevels.empty())
+    return TheSCCLevels;
+
+  auto SCCs = getSCCs();
+  llvm::DenseMap<SILFunction *, unsigned> SCCIndex;
+  for (unsigned Idx : indices(SCCs))
+    for (auto *F : SCCs[Idx])
+      SCCIndex[F] = Idx;
+
+  // Callees are in earlier SCCs, so their levels are already known.
+  TheSCCLevels.resize(SCCs.size());
+  for (unsigned Idx : indices(SCCs)) {
+    unsigned Level = 0;
+    for (auto *F : SCCs[Idx]) {
+      forEachCallee(F, [&](SILFunction *CalleeFn) {
+        auto It = SCCIndex.find(CalleeFn);
+        if (It != SCCIndex.end() && It->second != Idx)
+          Level = std::max(Level, TheSCCLevels[It->second] + 1);
+      });
+    }
+    TheSCCLevels[Idx] = Level;
+  }
+  return TheSCCLevels;
+}
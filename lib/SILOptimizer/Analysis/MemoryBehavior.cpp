@@ -313,11 +313,14 @@ AliasAnalysis::computeMemoryBehavior(SILInstruction *Inst, SILValue V,
   // Check if we've already computed this result.
   auto It = MemoryBehaviorCache.find(Key);
   if (It != MemoryBehaviorCache.end()) {
+    ++MemoryBehaviorCacheStats.Hits;
     return It->second;
   }
+  ++MemoryBehaviorCacheStats.Misses;
 
   // Flush the cache if the size of the cache is too large.
   if (MemoryBehaviorCache.size() > MemoryBehaviorAnalysisMaxCacheSize) {
+    ++MemoryBehaviorCacheStats.Flushes;
     MemoryBehaviorCache.clear();
     MemoryBehaviorValueBaseToIndex.clear();
 
@@ -455,8 +455,11 @@ SILValue RCIdentityFunctionInfo::getRCIdentityRootInner(SILValue V,
 SILValue RCIdentityFunctionInfo::getRCIdentityRoot(SILValue V) {
   // Do we have it in the RCCache ?
   auto Iter = RCCache.find(V);
-  if (Iter != RCCache.end())
+  if (Iter != RCCache.end()) {
+    ++CacheStats.Hits;
     return Iter->second;
+  }
+  ++CacheStats.Misses;
 
   SILValue Root = getRCIdentityRootInner(V, 0);
   VisitedArgs.clear();
@@ -466,8 +469,10 @@ SILValue RCIdentityFunctionInfo::getRCIdentityRoot(SILValue V) {
     return V;
 
   // Make sure the cache does not grow too big.
-  if (RCCache.size() > MaxRCIdentityCacheSize)
+  if (RCCache.size() > MaxRCIdentityCacheSize) {
+    ++CacheStats.Flushes;
     RCCache.clear();
+  }
 
   // Return and cache it.
   return RCCache[V] = Root;
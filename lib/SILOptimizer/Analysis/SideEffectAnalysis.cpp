@@ -178,6 +178,86 @@ bool SideEffectAnalysis::getDefinedEffects(FunctionEffects &Effects,
   return false;
 }
 
+bool SideEffectAnalysis::getSerializedEffects(FunctionEffects &Effects,
+                                              SILFunction *F) {
+  Optional<StringRef> Summary = F->getModule().lookupEffectsSummary(
+                                  F->getName());
+  if (!Summary)
+    return false;
+
+  // The summary has an entry for each argument of the function's entry block.
+  FunctionEffects Decoded(
+    F->getLoweredFunctionType()->getNumSILArguments());
+  if (!decodeEffects(Decoded, *Summary))
+    return false;
+  Effects = Decoded;
+  return true;
+}
+
+// A summary is a byte with the flags and the global effects, followed by a
+// byte with the effects of each parameter.
+enum : uint8_t {
+  SummaryReads = 1 << 0,
+  SummaryWrites = 1 << 1,
+  SummaryRetains = 1 << 2,
+  SummaryReleases = 1 << 3,
+  SummaryEffectsMask = 0x0f,
+  SummaryAllocsObjects = 1 << 4,
+  SummaryTraps = 1 << 5,
+  SummaryReadsRC = 1 << 6,
+};
+
+static uint8_t getSummaryBits(const Effects &E) {
+  return (E.mayRead() ? SummaryReads : 0) |
+         (E.mayWrite() ? SummaryWrites : 0) |
+         (E.mayRetain() ? SummaryRetains : 0) |
+         (E.mayRelease() ? SummaryReleases : 0);
+}
+
+std::string SideEffectAnalysis::encodeEffects(const FunctionEffects &FE) {
+  uint8_t Flags = getSummaryBits(FE.GlobalEffects);
+  if (FE.AllocsObjects)
+    Flags |= SummaryAllocsObjects;
+  if (FE.Traps)
+    Flags |= SummaryTraps;
+  if (FE.ReadsRC)
+    Flags |= SummaryReadsRC;
+
+  std::string Summary(1, Flags);
+  for (const Effects &E : FE.ParamEffects)
+    Summary += getSummaryBits(E);
+  return Summary;
+}
+
+bool SideEffectAnalysis::decodeEffects(FunctionEffects &FE,
+                                       StringRef Summary) {
+  if (Summary.size() != FE.ParamEffects.size() + 1)
+    return false;
+
+  auto setEffects = [](Effects &E, uint8_t Bits) {
+    E.Reads = Bits & SummaryReads;
+    E.Writes = Bits & SummaryWrites;
+    E.Retains = Bits & SummaryRetains;
+    E.Releases = Bits & SummaryReleases;
+  };
+
+  uint8_t Flags = Summary[0];
+  if (Flags & 0x80)
+    return false;
+  setEffects(FE.GlobalEffects, Flags);
+  FE.AllocsObjects = Flags & SummaryAllocsObjects;
+  FE.Traps = Flags & SummaryTraps;
+  FE.ReadsRC = Flags & SummaryReadsRC;
+
+  for (unsigned Idx = 0, E = FE.ParamEffects.size(); Idx != E; ++Idx) {
+    uint8_t Bits = Summary[Idx + 1];
+    if (Bits & ~SummaryEffectsMask)
+      return false;
+    setEffects(FE.ParamEffects[Idx], Bits);
+  }
+  return true;
+}
+
 bool SideEffectAnalysis::getSemanticEffects(FunctionEffects &FE,
                                             ArraySemanticsCall ASC) {
   assert(ASC.hasSelf());
@@ -263,7 +343,13 @@ void SideEffectAnalysis::analyzeFunction(FunctionInfo *FInfo,
   }
   
   if (!FInfo->F->isDefinition()) {
-    // We can't assume anything about external functions.
+    // Use the summary the function's module recorded, if there is one.
+    if (getSerializedEffects(FInfo->FE, FInfo->F)) {
+      DEBUG(llvm::dbgs() << "  -- has serialized effects " <<
+            FInfo->F->getName() << '\n');
+      return;
+    }
+    // Otherwise we can't assume anything about external functions.
     DEBUG(llvm::dbgs() << "  -- is external " << FInfo->F->getName() << '\n');
     FInfo->FE.setWorstEffects();
     return;
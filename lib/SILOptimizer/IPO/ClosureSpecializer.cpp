@@ -52,6 +52,15 @@
 /// 3. Handling addresses. We currently do not handle address types. We can in
 ///    the future by introducing alloc_stacks.
 ///
+/// 4. If the closure does not escape the specialized function, i.e. it is only
+///    called, we can pass the captured arguments as @guaranteed instead (see
+///    -closure-specialize-guaranteed-captures). The original closure is live
+///    across the call site and keeps the captured values alive, so the call
+///    site does not need any retains. The specialized function retains the
+///    captured arguments for the "copy" partial apply, which puts the retain
+///    and the release of the closure into the same function where they can be
+///    paired once the closure is applied directly.
+///
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "closure-specialization"
@@ -86,6 +95,11 @@ llvm::cl::opt<bool> EliminateDeadClosures(
     llvm::cl::desc("Do not eliminate dead closures after closure "
                    "specialization. This is meant ot be used when testing."));
 
+llvm::cl::opt<bool> GuaranteedClosureCaptures(
+    "closure-specialize-guaranteed-captures", llvm::cl::init(false),
+    llvm::cl::desc("Pass the captured arguments of closures which do not "
+                   "escape the specialized function as @guaranteed."));
+
 //===----------------------------------------------------------------------===//
 //                                  Utility
 //===----------------------------------------------------------------------===//
@@ -94,6 +108,33 @@ static bool isSupportedClosureKind(const SILInstruction *I) {
   return isa<ThinToThickFunctionInst>(I) || isa<PartialApplyInst>(I);
 }
 
+/// Returns true if the closure argument \p Arg is only called, retained and
+/// released, i.e. it does not escape the function.
+static bool isNonEscapingClosureArg(SILArgument *Arg) {
+  for (Operand *Op : Arg->getUses()) {
+    SILInstruction *User = Op->getUser();
+    if (isa<StrongRetainInst>(User) || isa<StrongReleaseInst>(User) ||
+        isa<RetainValueInst>(User) || isa<ReleaseValueInst>(User) ||
+        isa<DebugValueInst>(User))
+      continue;
+
+    // The closure must be the callee and not one of the arguments.
+    if (FullApplySite::isa(User) && Op->getOperandNumber() == 0)
+      continue;
+
+    return false;
+  }
+  return true;
+}
+
+/// Returns the parameters of \p F which correspond to the \p NumCaptured
+/// captured arguments appended by closure specialization.
+static ArrayRef<SILParameterInfo>
+getCapturedParameters(SILFunction *F, unsigned NumCaptured) {
+  auto Params = F->getLoweredFunctionType()->getParameters();
+  return Params.slice(Params.size() - NumCaptured);
+}
+
 //===----------------------------------------------------------------------===//
 //                       Closure Spec Cloner Interface
 //===----------------------------------------------------------------------===//
@@ -235,6 +276,15 @@ public:
     return getClosureParameterInfo().isConsumed();
   }
 
+  /// Returns true if the captured arguments of the closure can be passed as
+  /// @guaranteed to the specialized function.
+  bool canPassCapturesGuaranteed() const {
+    if (!GuaranteedClosureCaptures || !closureHasRefSemanticContext())
+      return false;
+    return isNonEscapingClosureArg(
+        getApplyCallee()->getArgument(getClosureIndex()));
+  }
+
   SILLocation getLoc() const { return getClosure()->getLoc(); }
 
   SILModule &getModule() const { return AI.getModule(); }
@@ -287,13 +337,24 @@ static void rewriteApplyInst(const CallSiteDescriptor &CSDesc,
   // implicit release of all captured arguments that occurs when the partial
   // apply is destroyed.
   SILModule &M = NewF->getModule();
+  auto CapturedParams =
+      getCapturedParameters(NewF, CSDesc.getNumArguments());
+  unsigned CaptureIndex = 0;
   for (auto Arg : CSDesc.getArguments()) {
     NewArgs.push_back(Arg);
 
     SILType ArgTy = Arg->getType();
 
     // If our argument is of trivial type, continue...
-    if (ArgTy.isTrivial(M))
+    if (ArgTy.isTrivial(M)) {
+      ++CaptureIndex;
+      continue;
+    }
+
+    // A guaranteed captured argument is kept alive by the original closure,
+    // which is live across the call. The specialized function retains it
+    // itself.
+    if (CapturedParams[CaptureIndex++].isGuaranteed())
       continue;
 
     // TODO: When we support address types, this code path will need to be
@@ -507,12 +568,14 @@ ClosureSpecCloner::initCloned(const CallSiteDescriptor &CallSiteDesc,
 
   // Captured parameters are always appended to the function signature. If the
   // type of the captured argument is trivial, pass the argument as
-  // Direct_Unowned. Otherwise pass it as Direct_Owned.
+  // Direct_Unowned. Otherwise pass it as Direct_Owned, or as
+  // Direct_Guaranteed if the closure does not escape.
   //
   // We use the type of the closure here since we allow for the closure to be an
   // external declaration.
   unsigned NumTotalParams = ClosedOverFunTy->getParameters().size();
   unsigned NumNotCaptured = NumTotalParams - CallSiteDesc.getNumArguments();
+  bool PassGuaranteed = CallSiteDesc.canPassCapturesGuaranteed();
   for (auto &PInfo : ClosedOverFunTy->getParameters().slice(NumNotCaptured)) {
     if (PInfo.getSILType().isTrivial(M)) {
       SILParameterInfo NewPInfo(PInfo.getType(),
@@ -522,7 +585,9 @@ ClosureSpecCloner::initCloned(const CallSiteDescriptor &CallSiteDesc,
     }
 
     SILParameterInfo NewPInfo(PInfo.getType(),
-                              ParameterConvention::Direct_Owned);
+                              PassGuaranteed
+                                  ? ParameterConvention::Direct_Guaranteed
+                                  : ParameterConvention::Direct_Owned);
     NewParameterInfoList.push_back(NewPInfo);
   }
 
@@ -608,6 +673,16 @@ void ClosureSpecCloner::populateCloned() {
   SILBuilder &Builder = getBuilder();
   Builder.setInsertionPoint(ClonedEntryBB);
 
+  // The cloned partial apply consumes its arguments, so retain the arguments
+  // which are passed to us at +0.
+  auto CapturedParams =
+      getCapturedParameters(Cloned, CallSiteDesc.getNumArguments());
+  for (unsigned i = 0, e = NewPAIArgs.size(); i != e; ++i) {
+    if (CapturedParams[i].isGuaranteed())
+      Builder.createRetainValue(CallSiteDesc.getLoc(), NewPAIArgs[i],
+                                Atomicity::Atomic);
+  }
+
   // Clone FRI and PAI, and replace usage of the removed closure argument
   // with result of cloned PAI.
   SILValue FnVal =
@@ -0,0 +1,64 @@
+//===--- EffectsSummaryRecorder.cpp - Record side-effect summaries --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Records a summary of the side-effects of each public function in the
+// module, which is serialized with the module. Clients of the module only see
+// declarations of most of its functions, so without a summary the side-effect
+// analysis has to assume the worst about calls to them.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "effects-summary"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumEffectsSummaries, "Number of side-effect summaries recorded");
+
+namespace {
+
+class EffectsSummaryRecorder : public SILModuleTransform {
+  void run() override {
+    SILModule *M = getModule();
+
+    // A resilient module's functions can change without their clients being
+    // recompiled, so the clients must not rely on what they do.
+    if (M->getSwiftModule()->getResilienceStrategy() !=
+          ResilienceStrategy::Default)
+      return;
+
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+    for (auto &F : *M) {
+      if (!F.isDefinition() || F.getLinkage() != SILLinkage::Public)
+        continue;
+
+      const auto &Effects = SEA->getEffects(&F);
+      DEBUG(llvm::dbgs() << "  " << F.getName() << ": " << Effects << '\n');
+      M->setEffectsSummary(F.getName(),
+                           SideEffectAnalysis::encodeEffects(Effects));
+      ++NumEffectsSummaries;
+    }
+  }
+
+  StringRef getName() override { return "Effects Summary Recorder"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createEffectsSummaryRecorder() {
+  return new EffectsSummaryRecorder();
+}
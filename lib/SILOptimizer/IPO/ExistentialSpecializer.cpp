@@ -0,0 +1,494 @@
+//===--- ExistentialSpecializer.cpp - Specialize existential arguments ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A function which takes a protocol existential, like
+//
+//   func f(_ x: P)
+//
+// opens the existential and dispatches through the witness table on every
+// call, even if all its callers pass the same concrete type. If the concrete
+// type of an existential argument is known at a call site, this pass creates a
+// generic version of the callee, in which the existential parameter is
+// replaced by a generic parameter, and calls it with the concrete type:
+//
+//   func f'<T : P>(_ t: T) {
+//     let x: P = t
+//     ... original body of f ...
+//   }
+//
+// The generic specializer then specializes the call to f'. In the
+// specialization the existential is initialized with a value of a concrete
+// type, so that opening it and the witness method calls can be folded.
+//
+// Only opaque existentials passed @in_guaranteed and class existentials are
+// handled.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-existential-specializer"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/AST/GenericEnvironment.h"
+#include "swift/SIL/Mangle.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumExistentialArgsSpecialized,
+          "Number of existential arguments passed as generic arguments");
+STATISTIC(NumGenericFunctionsCreated,
+          "Number of generic functions created for existential parameters");
+
+namespace {
+
+/// An existential argument of a call, whose concrete type is known.
+struct ConcreteExistentialArg {
+  /// The index of the argument in the apply and in the callee's entry block.
+  unsigned ArgIdx;
+
+  /// The protocol of the existential.
+  ProtocolDecl *Proto;
+
+  /// The formal concrete type stored in the existential.
+  CanType ConcreteType;
+
+  /// The conformance of the concrete type to the protocol.
+  ProtocolConformanceRef Conformance;
+
+  /// The value which is passed to the generic function instead of the
+  /// existential: the address of the value in an opaque existential, or the
+  /// reference stored in a class existential.
+  SILValue ConcreteValue;
+};
+
+/// Clones a function into a generic function in which the existential
+/// parameters are replaced by generic parameters.
+class ExistentialSpecializerCloner
+    : public SILClonerWithScopes<ExistentialSpecializerCloner> {
+  friend class SILVisitor<ExistentialSpecializerCloner>;
+  friend class SILCloner<ExistentialSpecializerCloner>;
+
+  SILFunction *Orig;
+  ArrayRef<ConcreteExistentialArg> Args;
+
+public:
+  ExistentialSpecializerCloner(SILFunction *Orig, SILFunction *NewF,
+                               ArrayRef<ConcreteExistentialArg> Args)
+      : SILClonerWithScopes<ExistentialSpecializerCloner>(*NewF), Orig(Orig),
+        Args(Args) {}
+
+  void populateCloned();
+};
+
+} // end anonymous namespace
+
+/// Clone the body of the original function. The entry block re-creates the
+/// existentials from the generic arguments, so the cloned body can use them as
+/// before.
+void ExistentialSpecializerCloner::populateCloned() {
+  SILFunction *NewF = &getBuilder().getFunction();
+  SILModule &M = NewF->getModule();
+  ASTContext &Ctx = M.getASTContext();
+  GenericEnvironment *Env = NewF->getGenericEnvironment();
+  SILLocation Loc = Orig->getLocation();
+
+  SILBasicBlock *OrigEntryBB = &*Orig->begin();
+  SILBasicBlock *NewEntryBB = NewF->createBasicBlock();
+  SILBuilder &B = getBuilder();
+  B.setInsertionPoint(NewEntryBB);
+
+  // The opaque existentials which hold a copy of the generic argument.
+  SmallVector<AllocStackInst *, 4> Containers;
+
+  const ConcreteExistentialArg *NextArg = Args.begin();
+  unsigned GenericParamIdx = 0;
+  for (unsigned Idx = 0, E = OrigEntryBB->bbarg_size(); Idx != E; ++Idx) {
+    SILArgument *OrigArg = OrigEntryBB->getBBArg(Idx);
+    if (NextArg == Args.end() || NextArg->ArgIdx != Idx) {
+      SILValue NewArg =
+          new (M) SILArgument(NewEntryBB, OrigArg->getType(), OrigArg->getDecl());
+      ValueMap.insert(std::make_pair(OrigArg, NewArg));
+      continue;
+    }
+
+    auto *GP = GenericTypeParamType::get(0, GenericParamIdx++, Ctx);
+    CanType ArchetypeTy = Env->mapTypeIntoContext(GP)->getCanonicalType();
+    auto Conformances =
+        Ctx.AllocateCopy(llvm::makeArrayRef(ProtocolConformanceRef(
+            NextArg->Proto)));
+    SILType ExistentialTy = OrigArg->getType();
+    ++NextArg;
+
+    if (ExistentialTy.isAddress()) {
+      // Copy the @in_guaranteed generic argument into a new existential.
+      SILValue NewArg = new (M) SILArgument(
+          NewEntryBB, SILType::getPrimitiveAddressType(ArchetypeTy),
+          OrigArg->getDecl());
+      auto *Container = B.createAllocStack(Loc, ExistentialTy.getObjectType());
+      SILValue Payload = B.createInitExistentialAddr(
+          Loc, Container, ArchetypeTy,
+          M.Types.getLoweredType(AbstractionPattern::getOpaque(), ArchetypeTy),
+          Conformances);
+      B.createCopyAddr(Loc, NewArg, Payload, IsNotTake, IsInitialization);
+      Containers.push_back(Container);
+      ValueMap.insert(std::make_pair(OrigArg, SILValue(Container)));
+      continue;
+    }
+
+    // A class existential just wraps the reference.
+    SILValue NewArg = new (M) SILArgument(
+        NewEntryBB, SILType::getPrimitiveObjectType(ArchetypeTy),
+        OrigArg->getDecl());
+    SILValue Existential = B.createInitExistentialRef(
+        Loc, ExistentialTy, ArchetypeTy, NewArg, Conformances);
+    ValueMap.insert(std::make_pair(OrigArg, Existential));
+  }
+
+  BBMap.insert(std::make_pair(OrigEntryBB, NewEntryBB));
+  // Recursively visit original BBs in depth-first preorder, starting with the
+  // entry block, cloning all instructions other than terminators.
+  visitSILBasicBlock(OrigEntryBB);
+
+  // Now iterate over the BBs and fix up the terminators.
+  for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+    B.setInsertionPoint(BI->second);
+    visit(BI->first->getTerminator());
+  }
+
+  // Destroy the copies of the opaque arguments on all function exits.
+  if (Containers.empty())
+    return;
+  auto CleanupLoc = CleanupLocation::get(Loc);
+  for (auto &BB : *NewF) {
+    TermInst *TI = BB.getTerminator();
+    if (!isa<ReturnInst>(TI) && !isa<ThrowInst>(TI))
+      continue;
+    B.setInsertionPoint(TI);
+    for (auto *Container : reversed(Containers)) {
+      B.createDestroyAddr(CleanupLoc, Container);
+      B.createDeallocStack(CleanupLoc, Container);
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+//                           Existential Specializer
+//===----------------------------------------------------------------------===//
+
+/// Returns true if we can create a generic version of \p Callee.
+static bool canSpecializeCallee(SILFunction *Callee) {
+  if (!Callee || !Callee->isDefinition() || !Callee->shouldOptimize())
+    return false;
+
+  CanSILFunctionType FTy = Callee->getLoweredFunctionType();
+  if (FTy->isPolymorphic())
+    return false;
+
+  // Witness methods need their Self parameter and foreign functions must keep
+  // their signature.
+  switch (FTy->getRepresentation()) {
+  case SILFunctionTypeRepresentation::Thin:
+  case SILFunctionTypeRepresentation::Method:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Returns the protocol of the callee's parameter \p ArgIdx if it is a
+/// non-@objc protocol existential, which we can turn into a generic parameter.
+static ProtocolDecl *getSpecializableProtocol(SILFunction *Callee,
+                                              unsigned ArgIdx) {
+  CanSILFunctionType FTy = Callee->getLoweredFunctionType();
+  unsigned NumIndirectResults = FTy->getNumIndirectResults();
+  if (ArgIdx < NumIndirectResults)
+    return nullptr;
+
+  SILParameterInfo PI = FTy->getParameters()[ArgIdx - NumIndirectResults];
+  SILType Ty = PI.getSILType();
+  SmallVector<ProtocolDecl *, 2> Protocols;
+  if (!Ty.getSwiftRValueType()->isExistentialType(Protocols) ||
+      Protocols.size() != 1 || Protocols[0]->isObjC())
+    return nullptr;
+
+  switch (Ty.getPreferredExistentialRepresentation(Callee->getModule())) {
+  case ExistentialRepresentation::Opaque:
+    // An @in existential would be consumed by the callee, but not its
+    // container.
+    if (PI.getConvention() != ParameterConvention::Indirect_In_Guaranteed)
+      return nullptr;
+    break;
+  case ExistentialRepresentation::Class:
+    if (PI.getConvention() != ParameterConvention::Direct_Guaranteed &&
+        PI.getConvention() != ParameterConvention::Direct_Owned)
+      return nullptr;
+    break;
+  default:
+    return nullptr;
+  }
+
+  // It's only worth it if the callee actually opens the existential.
+  SILArgument *Arg = Callee->begin()->getBBArg(ArgIdx);
+  for (Operand *Use : Arg->getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (isa<OpenExistentialAddrInst>(User) || isa<OpenExistentialRefInst>(User))
+      return Protocols[0];
+  }
+  return nullptr;
+}
+
+/// Returns the init_existential_addr which initializes the opaque existential
+/// in \p ASI, if \p ASI is only used to pass it to \p AI.
+static InitExistentialAddrInst *getOnlyInit(AllocStackInst *ASI,
+                                            ApplyInst *AI) {
+  InitExistentialAddrInst *Init = nullptr;
+  for (Operand *Use : ASI->getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (User == AI || isa<DestroyAddrInst>(User) ||
+        isa<DeallocStackInst>(User) || isa<DebugValueAddrInst>(User))
+      continue;
+    auto *IEA = dyn_cast<InitExistentialAddrInst>(User);
+    if (!IEA || Init)
+      return nullptr;
+    Init = IEA;
+  }
+  if (!Init || Init->getParent() != AI->getParent())
+    return nullptr;
+
+  // The payload must be available at the call.
+  for (auto Iter = AI->getIterator(), Begin = AI->getParent()->begin();
+       Iter != Begin;) {
+    if (&*--Iter == Init)
+      return Init;
+  }
+  return nullptr;
+}
+
+/// Checks if the concrete type of the existential argument \p ArgIdx of \p AI
+/// is known and fills in \p CArg.
+static bool getConcreteExistentialArg(ApplyInst *AI, unsigned ArgIdx,
+                                      ProtocolDecl *Proto,
+                                      ConcreteExistentialArg &CArg) {
+  SILValue Arg = AI->getArgument(ArgIdx);
+  ArrayRef<ProtocolConformanceRef> Conformances;
+  if (auto *ASI = dyn_cast<AllocStackInst>(Arg)) {
+    auto *IEA = getOnlyInit(ASI, AI);
+    if (!IEA)
+      return false;
+    CArg.ConcreteType = IEA->getFormalConcreteType();
+    CArg.ConcreteValue = IEA;
+    Conformances = IEA->getConformances();
+  } else if (auto *IER = dyn_cast<InitExistentialRefInst>(Arg)) {
+    CArg.ConcreteType = IER->getFormalConcreteType();
+    CArg.ConcreteValue = IER->getOperand();
+    Conformances = IER->getConformances();
+  } else {
+    return false;
+  }
+
+  // Archetypes of the caller, including opened existentials, would need
+  // type-dependent operands.
+  if (CArg.ConcreteType->hasArchetype())
+    return false;
+
+  if (Conformances.size() != 1 || Conformances[0].getRequirement() != Proto)
+    return false;
+
+  CArg.ArgIdx = ArgIdx;
+  CArg.Proto = Proto;
+  CArg.Conformance = Conformances[0];
+  return true;
+}
+
+/// Creates the type of the generic version of \p Callee, in which the
+/// parameters of \p Args are replaced by generic parameters.
+static CanSILFunctionType
+createGenericType(SILFunction *Callee, ArrayRef<ConcreteExistentialArg> Args) {
+  ASTContext &Ctx = Callee->getModule().getASTContext();
+  CanSILFunctionType FTy = Callee->getLoweredFunctionType();
+  unsigned NumIndirectResults = FTy->getNumIndirectResults();
+
+  SmallVector<GenericTypeParamType *, 4> GenericParams;
+  SmallVector<Requirement, 4> Requirements;
+  SmallVector<SILParameterInfo, 8> Params(FTy->getParameters().begin(),
+                                          FTy->getParameters().end());
+  for (const ConcreteExistentialArg &Arg : Args) {
+    auto *GP = GenericTypeParamType::get(0, GenericParams.size(), Ctx);
+    GenericParams.push_back(GP);
+    Requirements.push_back(
+        Requirement(RequirementKind::WitnessMarker, GP, Type()));
+    Requirements.push_back(Requirement(RequirementKind::Conformance, GP,
+                                       Arg.Proto->getDeclaredType()));
+    SILParameterInfo &PI = Params[Arg.ArgIdx - NumIndirectResults];
+    PI = SILParameterInfo(GP->getCanonicalType(), PI.getConvention());
+  }
+
+  // The parameters have changed, so it's not a method anymore.
+  auto ExtInfo = FTy->getExtInfo().withRepresentation(
+      SILFunctionTypeRepresentation::Thin);
+  return SILFunctionType::get(
+      GenericSignature::getCanonical(GenericParams, Requirements), ExtInfo,
+      FTy->getCalleeConvention(), Params, FTy->getAllResults(),
+      FTy->getOptionalErrorResult(), Ctx);
+}
+
+/// Creates the generic version of \p Callee with the type \p GenericTy.
+static SILFunction *createGenericFunction(SILFunction *Callee,
+                                          ArrayRef<ConcreteExistentialArg> Args,
+                                          CanSILFunctionType GenericTy,
+                                          StringRef Name,
+                                          IsFragile_t Fragile) {
+  SILModule &M = Callee->getModule();
+  GenericEnvironment *Env =
+      GenericTy->getGenericSignature()->getCanonicalGenericEnvironment(
+          *M.getSwiftModule());
+
+  // We make this function bare so we don't have to worry about decls in the
+  // SILArgument.
+  auto *NewF = M.createFunction(
+      getSpecializedLinkage(Callee, Callee->getLinkage()), Name, GenericTy,
+      Env, Callee->getLocation(), IsBare, Callee->isTransparent(), Fragile,
+      Callee->isThunk(), Callee->getClassVisibility(),
+      Callee->getInlineStrategy(), Callee->getEffectsKind(), Callee,
+      Callee->getDebugScope());
+  NewF->setDeclCtx(Callee->getDeclContext());
+  for (auto &Attr : Callee->getSemanticsAttrs())
+    NewF->addSemanticsAttr(Attr);
+
+  ExistentialSpecializerCloner Cloner(Callee, NewF, Args);
+  Cloner.populateCloned();
+  ++NumGenericFunctionsCreated;
+  return NewF;
+}
+
+/// Replaces the existential arguments of \p AI by their concrete values, if
+/// their types are known, and calls the generic version of the callee.
+static bool specializeApply(ApplyInst *AI, SILFunctionTransform *SFT) {
+  SILFunction *Caller = AI->getFunction();
+  SILFunction *Callee = AI->getReferencedFunction();
+  if (!canSpecializeCallee(Callee) || Callee == Caller)
+    return false;
+
+  // A fragile caller can't reference a function which isn't fragile.
+  if (Caller->isFragile() && !Callee->isFragile())
+    return false;
+
+  SmallVector<ConcreteExistentialArg, 4> Args;
+  for (unsigned Idx = 0, E = AI->getNumArguments(); Idx != E; ++Idx) {
+    ProtocolDecl *Proto = getSpecializableProtocol(Callee, Idx);
+    if (!Proto)
+      continue;
+    ConcreteExistentialArg CArg;
+    if (getConcreteExistentialArg(AI, Idx, Proto, CArg))
+      Args.push_back(CArg);
+  }
+  if (Args.empty())
+    return false;
+
+  SILModule &M = Caller->getModule();
+  ASTContext &Ctx = M.getASTContext();
+  CanSILFunctionType GenericTy = createGenericType(Callee, Args);
+
+  SmallVector<Substitution, 4> Subs;
+  for (const ConcreteExistentialArg &Arg : Args)
+    Subs.push_back(Substitution(Arg.ConcreteType,
+                                Ctx.AllocateCopy(llvm::makeArrayRef(
+                                    Arg.Conformance))));
+  SILType SubstTy =
+      SILType::getPrimitiveObjectType(GenericTy).substGenericArgs(M, Subs);
+
+  // The concrete values must match the lowered parameter types of the
+  // substituted function type, e.g. function types have a different
+  // abstraction as generic arguments.
+  auto SubstFTy = SubstTy.castTo<SILFunctionType>();
+  unsigned NumIndirectResults = SubstFTy->getNumIndirectResults();
+  for (const ConcreteExistentialArg &Arg : Args) {
+    SILParameterInfo PI =
+        SubstFTy->getParameters()[Arg.ArgIdx - NumIndirectResults];
+    if (PI.getSILType() != Arg.ConcreteValue->getType())
+      return false;
+  }
+
+  IsFragile_t Fragile = Caller->isFragile() ? IsFragile : IsNotFragile;
+  Mangle::Mangler Mangler;
+  FunctionSignatureSpecializationMangler FSSM(
+      SpecializationPass::ExistentialSpecializer, Mangler, Fragile, Callee);
+  for (const ConcreteExistentialArg &Arg : Args)
+    FSSM.setArgumentExistentialToGeneric(Arg.ArgIdx);
+  FSSM.mangle();
+  std::string Name = Mangler.finalize();
+
+  SILFunction *NewF = M.lookUpFunction(Name);
+  if (!NewF) {
+    DEBUG(llvm::dbgs() << "  create generic function " << Name << "\n");
+    NewF = createGenericFunction(Callee, Args, GenericTy, Name, Fragile);
+    SFT->notifyPassManagerOfFunction(NewF, Callee);
+  }
+
+  DEBUG(llvm::dbgs() << "  specialize existential arguments of " << *AI);
+  SmallVector<SILValue, 8> NewArgs(AI->getArguments().begin(),
+                                   AI->getArguments().end());
+  for (const ConcreteExistentialArg &Arg : Args)
+    NewArgs[Arg.ArgIdx] = Arg.ConcreteValue;
+
+  SILBuilderWithScope Builder(AI);
+  auto *FRI = Builder.createFunctionRef(AI->getLoc(), NewF);
+  auto *NewAI = Builder.createApply(AI->getLoc(), FRI, SubstTy, AI->getType(),
+                                    Subs, NewArgs, AI->isNonThrowing());
+  AI->replaceAllUsesWith(NewAI);
+  recursivelyDeleteTriviallyDeadInstructions(AI, true);
+  NumExistentialArgsSpecialized += Args.size();
+  return true;
+}
+
+namespace {
+
+class ExistentialSpecializer : public SILFunctionTransform {
+
+  void run() override {
+    SILFunction *F = getFunction();
+
+    // Don't optimize functions that are marked with the opt.never attribute.
+    if (!F->shouldOptimize())
+      return;
+
+    DEBUG(llvm::dbgs() << "*** Existential specializer on " << F->getName()
+                       << " ***\n");
+
+    SmallVector<ApplyInst *, 8> Applies;
+    for (auto &BB : *F)
+      for (auto &I : BB)
+        if (auto *AI = dyn_cast<ApplyInst>(&I))
+          Applies.push_back(AI);
+
+    bool Changed = false;
+    for (ApplyInst *AI : Applies)
+      Changed |= specializeApply(AI, this);
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
+  }
+
+  StringRef getName() override { return "Existential Specializer"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createExistentialSpecializer() {
+  return new ExistentialSpecializer();
+}
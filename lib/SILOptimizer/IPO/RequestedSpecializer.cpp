@@ -0,0 +1,153 @@
+//===--- RequestedSpecializer.cpp - Make requested specializations --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Specializes generic functions of the module for the concrete types its
+// clients asked for in the files given with -prespecialize-requests. Clients
+// only see declarations of most of the module's functions, so they can't
+// specialize them themselves. The specializations are kept public, and their
+// declarations are serialized, so that the clients can call them instead of
+// the generic functions.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "prespecialize-requested"
+#include "swift/AST/DiagnosticsSIL.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SIL/SpecializationRequest.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Generics.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumRequestedSpecializations,
+          "Number of specializations made as requested by clients");
+
+/// Looks up the nominal type with the module-qualified name \p Name.
+static Type lookupRequestedType(ASTContext &Ctx, StringRef Name) {
+  StringRef ModuleName, TypeName;
+  std::tie(ModuleName, TypeName) = Name.split('.');
+  if (TypeName.empty())
+    return Type();
+
+  ModuleDecl *Mod = Ctx.getLoadedModule(Ctx.getIdentifier(ModuleName));
+  if (!Mod)
+    return Type();
+
+  SmallVector<ValueDecl *, 1> Results;
+  Mod->lookupValue({}, Ctx.getIdentifier(TypeName), NLKind::QualifiedLookup,
+                   Results);
+  if (Results.size() != 1)
+    return Type();
+
+  auto *NTD = dyn_cast<NominalTypeDecl>(Results[0]);
+  if (!NTD || NTD->isGenericContext())
+    return Type();
+  return NTD->getDeclaredType();
+}
+
+/// Builds the substitutions for \p Request of the generic function \p F, or
+/// returns false if some type or conformance can't be found.
+static bool getRequestedSubstitutions(SILFunction *F,
+                                      const SpecializationRequest &Request,
+                                      SmallVectorImpl<Substitution> &Subs) {
+  auto *Sig = F->getLoweredFunctionType()->getGenericSignature();
+  auto Params = Sig->getGenericParams();
+  if (Params.size() != Request.Substitutions.size())
+    return false;
+
+  ASTContext &Ctx = F->getASTContext();
+  TypeSubstitutionMap SubMap;
+  for (unsigned i = 0, e = Params.size(); i != e; ++i) {
+    Type Replacement = lookupRequestedType(Ctx, Request.Substitutions[i]);
+    if (!Replacement)
+      return false;
+    SubMap[Params[i]->getCanonicalType().getPointer()] = Replacement;
+  }
+
+  ModuleDecl *SwiftModule = F->getModule().getSwiftModule();
+  bool MissingConformance = false;
+  auto LookupConformance =
+      [&](CanType Original, Type Replacement,
+          ProtocolType *ProtoType) -> ProtocolConformanceRef {
+    auto *Proto = ProtoType->getDecl();
+    if (auto Conformance =
+            SwiftModule->lookupConformance(Replacement, Proto, nullptr))
+      return *Conformance;
+    MissingConformance = true;
+    return ProtocolConformanceRef(Proto);
+  };
+
+  Sig->getSubstitutions(*SwiftModule, SubMap, LookupConformance, Subs);
+  return !MissingConformance;
+}
+
+namespace {
+
+class RequestedSpecializer : public SILModuleTransform {
+  void run() override {
+    SILModule &M = *getModule();
+    const auto &Files = M.getOptions().PrespecializeRequestsFiles;
+    if (Files.empty())
+      return;
+
+    std::vector<SpecializationRequest> Requests;
+    for (const std::string &File : Files) {
+      if (std::error_code EC = readSpecializationRequests(File, Requests))
+        M.getASTContext().Diags.diagnose(
+            SourceLoc(), diag::specialization_requests_read_error, File,
+            EC.message());
+    }
+
+    bool Changed = false;
+    for (const SpecializationRequest &Request : Requests) {
+      // The requests may be for the functions of several modules.
+      SILFunction *F = M.lookUpFunction(Request.Function);
+      if (!F || !F->isDefinition() || F->isAvailableExternally() ||
+          !F->getLoweredFunctionType()->isPolymorphic())
+        continue;
+
+      SmallVector<Substitution, 4> Subs;
+      if (!getRequestedSubstitutions(F, Request, Subs)) {
+        DEBUG(llvm::dbgs() << "  Cannot find the types requested for "
+                           << F->getName() << '\n');
+        continue;
+      }
+
+      ReabstractionInfo ReInfo(F, Subs);
+      GenericFuncSpecializer Specializer(F, Subs, F->isFragile(), ReInfo);
+      SILFunction *NewF = Specializer.trySpecialization();
+      if (!NewF)
+        continue;
+
+      DEBUG(llvm::dbgs() << "  Specialized " << F->getName() << " as "
+                         << NewF->getName() << '\n');
+      // Dead function elimination makes the specialization public.
+      NewF->setKeepAsPublic(true);
+      ++NumRequestedSpecializations;
+      Changed = true;
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
+  }
+
+  StringRef getName() override { return "Requested Specializer"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createRequestedSpecializer() {
+  return new RequestedSpecializer();
+}
@@ -0,0 +1,534 @@
+//===--- SpecializationMerger.cpp - Merge equivalent specializations ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Reduces code size by merging specializations of a generic function which
+// only differ in types that have the same representation.
+//
+// Specializing a generic function for two classes produces two functions
+// whose bodies are the same up to the class types: both only retain, release,
+// load and store native object references. This pass compares the bodies of
+// specializations after erasing such types and replaces each specialization
+// that is equivalent to an earlier one with a thunk, which casts its arguments
+// and calls the earlier one:
+//
+//   sil shared [thunk] @_TTSg5C4main1B___foo
+//   bb0(%0 : $B):
+//     %1 = unchecked_ref_cast %0 : $B to $A
+//     %2 = function_ref @_TTSg5C4main1A___foo
+//     %3 = apply %2(%1)
+//     %4 = unchecked_ref_cast %3 : $A to $B
+//     return %4 : $B
+//
+// A thunk is much smaller than the body it replaces, and the inliner can
+// remove it entirely if the pass runs before the last inlining.
+//
+// Only instructions whose semantics don't depend on the erased types are
+// compared. Anything that looks at a type's metadata, such as alloc_ref,
+// metatype or a dynamic cast, makes a specialization unmergeable.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "specialization-merger"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SIL/SILUndef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumSpecializationsMerged, "Number of merged specializations");
+
+//===----------------------------------------------------------------------===//
+//                               Type Erasure
+//===----------------------------------------------------------------------===//
+
+static bool areErasedEqual(CanType T1, CanType T2);
+
+static bool areErasedEqual(SILType T1, SILType T2) {
+  if (!T1 || !T2)
+    return !T1 && !T2;
+  if (T1.getCategory() != T2.getCategory())
+    return false;
+  return areErasedEqual(T1.getSwiftRValueType(), T2.getSwiftRValueType());
+}
+
+static bool areErasedEqual(CanSILFunctionType F1, CanSILFunctionType F2) {
+  if (F1->getRepresentation() != F2->getRepresentation() ||
+      F1->isPolymorphic() || F2->isPolymorphic() ||
+      F1->hasErrorResult() || F2->hasErrorResult())
+    return false;
+
+  auto Params1 = F1->getParameters(), Params2 = F2->getParameters();
+  if (Params1.size() != Params2.size())
+    return false;
+  for (unsigned Idx = 0, E = Params1.size(); Idx != E; ++Idx) {
+    if (Params1[Idx].getConvention() != Params2[Idx].getConvention() ||
+        !areErasedEqual(Params1[Idx].getType(), Params2[Idx].getType()))
+      return false;
+  }
+
+  auto Results1 = F1->getAllResults(), Results2 = F2->getAllResults();
+  if (Results1.size() != Results2.size())
+    return false;
+  for (unsigned Idx = 0, E = Results1.size(); Idx != E; ++Idx) {
+    if (Results1[Idx].getConvention() != Results2[Idx].getConvention() ||
+        !areErasedEqual(Results1[Idx].getType(), Results2[Idx].getType()))
+      return false;
+  }
+  return true;
+}
+
+/// Returns true if values of \p T1 and \p T2 have the same representation and
+/// are copied and destroyed the same way.
+///
+/// References to native Swift classes are interchangeable, and so are generic
+/// types and tuples which only differ in such references.
+static bool areErasedEqual(CanType T1, CanType T2) {
+  if (T1 == T2)
+    return true;
+
+  if (T1->getClassOrBoundGenericClass() &&
+      T2->getClassOrBoundGenericClass())
+    return T1->usesNativeReferenceCounting(ResilienceExpansion::Maximal) &&
+           T2->usesNativeReferenceCounting(ResilienceExpansion::Maximal);
+
+  if (auto BGT1 = dyn_cast<BoundGenericType>(T1)) {
+    auto BGT2 = dyn_cast<BoundGenericType>(T2);
+    if (!BGT2 || BGT1->getDecl() != BGT2->getDecl() ||
+        BGT1->getParent().getPointer() != BGT2->getParent().getPointer())
+      return false;
+    auto Args1 = BGT1.getGenericArgs(), Args2 = BGT2.getGenericArgs();
+    if (Args1.size() != Args2.size())
+      return false;
+    for (unsigned Idx = 0, E = Args1.size(); Idx != E; ++Idx) {
+      if (!areErasedEqual(Args1[Idx], Args2[Idx]))
+        return false;
+    }
+    return true;
+  }
+
+  if (auto TT1 = dyn_cast<TupleType>(T1)) {
+    auto TT2 = dyn_cast<TupleType>(T2);
+    if (!TT2 || TT1->getNumElements() != TT2->getNumElements())
+      return false;
+    for (unsigned Idx = 0, E = TT1->getNumElements(); Idx != E; ++Idx) {
+      if (TT1->getElement(Idx).getName() != TT2->getElement(Idx).getName() ||
+          !areErasedEqual(TT1.getElementType(Idx), TT2.getElementType(Idx)))
+        return false;
+    }
+    return true;
+  }
+
+  if (auto FT1 = dyn_cast<SILFunctionType>(T1)) {
+    auto FT2 = dyn_cast<SILFunctionType>(T2);
+    return FT2 && areErasedEqual(FT1, FT2);
+  }
+
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+//                             Body Comparison
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Compares the bodies of two functions, instruction by instruction.
+class BodyComparator {
+  SILFunction *LF;
+  SILFunction *RF;
+
+  /// Returns the function which the calls to a merged function now go to.
+  std::function<SILFunction *(SILFunction *)> GetMergedFunction;
+
+  llvm::DenseMap<SILBasicBlock *, SILBasicBlock *> BlockMap;
+  llvm::DenseMap<ValueBase *, ValueBase *> ValueMap;
+
+  bool mapBlocksAndValues();
+  bool areOperandsEquivalent(SILValue LV, SILValue RV);
+  bool areReferencedFunctionsEquivalent(SILFunction *LCallee,
+                                        SILFunction *RCallee);
+  bool hasEquivalentState(SILInstruction *LI, SILInstruction *RI);
+  bool areEquivalent(SILInstruction *LI, SILInstruction *RI);
+
+public:
+  BodyComparator(SILFunction *LF, SILFunction *RF,
+                 std::function<SILFunction *(SILFunction *)> GetMergedFunction)
+    : LF(LF), RF(RF), GetMergedFunction(GetMergedFunction) {}
+
+  bool compare();
+};
+
+} // end anonymous namespace
+
+/// Pairs up the blocks, block arguments and instructions of both functions by
+/// their position.
+bool BodyComparator::mapBlocksAndValues() {
+  if (LF->size() != RF->size())
+    return false;
+
+  for (auto LBI = LF->begin(), RBI = RF->begin(), E = LF->end(); LBI != E;
+       ++LBI, ++RBI) {
+    SILBasicBlock *LBB = &*LBI, *RBB = &*RBI;
+    if (LBB->getNumBBArg() != RBB->getNumBBArg())
+      return false;
+    BlockMap[LBB] = RBB;
+
+    for (unsigned Idx = 0, NumArgs = LBB->getNumBBArg(); Idx != NumArgs;
+         ++Idx) {
+      SILArgument *LArg = LBB->getBBArg(Idx), *RArg = RBB->getBBArg(Idx);
+      if (!areErasedEqual(LArg->getType(), RArg->getType()))
+        return false;
+      ValueMap[LArg] = RArg;
+    }
+
+    auto LII = LBB->begin(), RII = RBB->begin();
+    for (; LII != LBB->end() && RII != RBB->end(); ++LII, ++RII)
+      ValueMap[&*LII] = &*RII;
+    if (LII != LBB->end() || RII != RBB->end())
+      return false;
+  }
+  return true;
+}
+
+bool BodyComparator::areOperandsEquivalent(SILValue LV, SILValue RV) {
+  if (isa<SILUndef>(LV) || isa<SILUndef>(RV))
+    return isa<SILUndef>(LV) && isa<SILUndef>(RV) &&
+           areErasedEqual(LV->getType(), RV->getType());
+  return ValueMap.lookup(LV) == RV;
+}
+
+bool BodyComparator::areReferencedFunctionsEquivalent(SILFunction *LCallee,
+                                                      SILFunction *RCallee) {
+  // Recursive calls are equivalent if both functions call themselves.
+  if (LCallee == LF || RCallee == RF)
+    return LCallee == LF && RCallee == RF;
+  return GetMergedFunction(LCallee) == GetMergedFunction(RCallee);
+}
+
+/// Compares the parts of two instructions of the same kind which aren't
+/// operands or types. Returns false for the kinds of instructions whose
+/// semantics depend on the erased types.
+bool BodyComparator::hasEquivalentState(SILInstruction *LI,
+                                        SILInstruction *RI) {
+  switch (LI->getKind()) {
+  case ValueKind::FunctionRefInst:
+    return areReferencedFunctionsEquivalent(
+        cast<FunctionRefInst>(LI)->getReferencedFunction(),
+        cast<FunctionRefInst>(RI)->getReferencedFunction());
+
+  case ValueKind::ApplyInst: {
+    auto *LA = cast<ApplyInst>(LI), *RA = cast<ApplyInst>(RI);
+    return !LA->hasSubstitutions() && !RA->hasSubstitutions() &&
+           LA->isNonThrowing() == RA->isNonThrowing();
+  }
+
+  case ValueKind::BuiltinInst: {
+    auto *LB = cast<BuiltinInst>(LI), *RB = cast<BuiltinInst>(RI);
+    return LB->getName() == RB->getName() && !LB->hasSubstitutions() &&
+           !RB->hasSubstitutions();
+  }
+
+  case ValueKind::IntegerLiteralInst:
+    return cast<IntegerLiteralInst>(LI)->getValue() ==
+           cast<IntegerLiteralInst>(RI)->getValue();
+
+  case ValueKind::StructExtractInst:
+    return cast<StructExtractInst>(LI)->getField() ==
+           cast<StructExtractInst>(RI)->getField();
+  case ValueKind::StructElementAddrInst:
+    return cast<StructElementAddrInst>(LI)->getField() ==
+           cast<StructElementAddrInst>(RI)->getField();
+  case ValueKind::TupleExtractInst:
+    return cast<TupleExtractInst>(LI)->getFieldNo() ==
+           cast<TupleExtractInst>(RI)->getFieldNo();
+  case ValueKind::TupleElementAddrInst:
+    return cast<TupleElementAddrInst>(LI)->getFieldNo() ==
+           cast<TupleElementAddrInst>(RI)->getFieldNo();
+
+  case ValueKind::EnumInst:
+    return cast<EnumInst>(LI)->getElement() == cast<EnumInst>(RI)->getElement();
+  case ValueKind::UncheckedEnumDataInst:
+    return cast<UncheckedEnumDataInst>(LI)->getElement() ==
+           cast<UncheckedEnumDataInst>(RI)->getElement();
+  case ValueKind::InitEnumDataAddrInst:
+    return cast<InitEnumDataAddrInst>(LI)->getElement() ==
+           cast<InitEnumDataAddrInst>(RI)->getElement();
+  case ValueKind::UncheckedTakeEnumDataAddrInst:
+    return cast<UncheckedTakeEnumDataAddrInst>(LI)->getElement() ==
+           cast<UncheckedTakeEnumDataAddrInst>(RI)->getElement();
+  case ValueKind::InjectEnumAddrInst:
+    return cast<InjectEnumAddrInst>(LI)->getElement() ==
+           cast<InjectEnumAddrInst>(RI)->getElement();
+
+  case ValueKind::StrongRetainInst:
+  case ValueKind::StrongReleaseInst:
+  case ValueKind::RetainValueInst:
+  case ValueKind::ReleaseValueInst:
+    return cast<RefCountingInst>(LI)->isNonAtomic() ==
+           cast<RefCountingInst>(RI)->isNonAtomic();
+
+  case ValueKind::CopyAddrInst: {
+    auto *LC = cast<CopyAddrInst>(LI), *RC = cast<CopyAddrInst>(RI);
+    return LC->isTakeOfSrc() == RC->isTakeOfSrc() &&
+           LC->isInitializationOfDest() == RC->isInitializationOfDest();
+  }
+
+  case ValueKind::PointerToAddressInst:
+    return cast<PointerToAddressInst>(LI)->isStrict() ==
+           cast<PointerToAddressInst>(RI)->isStrict();
+
+  case ValueKind::SwitchEnumInst:
+  case ValueKind::SwitchEnumAddrInst: {
+    auto *LS = cast<SwitchEnumInstBase>(LI), *RS = cast<SwitchEnumInstBase>(RI);
+    if (LS->getNumCases() != RS->getNumCases() ||
+        LS->hasDefault() != RS->hasDefault())
+      return false;
+    for (unsigned Idx = 0, E = LS->getNumCases(); Idx != E; ++Idx) {
+      if (LS->getCase(Idx).first != RS->getCase(Idx).first)
+        return false;
+    }
+    return true;
+  }
+
+  case ValueKind::CondBranchInst:
+    return cast<CondBranchInst>(LI)->getTrueArgs().size() ==
+           cast<CondBranchInst>(RI)->getTrueArgs().size();
+
+  case ValueKind::StructInst:
+  case ValueKind::TupleInst:
+  case ValueKind::LoadInst:
+  case ValueKind::StoreInst:
+  case ValueKind::AllocStackInst:
+  case ValueKind::DeallocStackInst:
+  case ValueKind::DestroyAddrInst:
+  case ValueKind::UncheckedRefCastInst:
+  case ValueKind::UncheckedAddrCastInst:
+  case ValueKind::UncheckedBitwiseCastInst:
+  case ValueKind::UpcastInst:
+  case ValueKind::RefToRawPointerInst:
+  case ValueKind::RawPointerToRefInst:
+  case ValueKind::AddressToPointerInst:
+  case ValueKind::IndexAddrInst:
+  case ValueKind::DebugValueInst:
+  case ValueKind::DebugValueAddrInst:
+  case ValueKind::CondFailInst:
+  case ValueKind::FixLifetimeInst:
+  case ValueKind::BranchInst:
+  case ValueKind::ReturnInst:
+  case ValueKind::UnreachableInst:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+bool BodyComparator::areEquivalent(SILInstruction *LI, SILInstruction *RI) {
+  if (LI->getKind() != RI->getKind() ||
+      LI->getNumOperands() != RI->getNumOperands() ||
+      !areErasedEqual(LI->getType(), RI->getType()))
+    return false;
+
+  for (unsigned Idx = 0, E = LI->getNumOperands(); Idx != E; ++Idx) {
+    if (!areOperandsEquivalent(LI->getOperand(Idx), RI->getOperand(Idx)))
+      return false;
+  }
+
+  if (auto *LT = dyn_cast<TermInst>(LI)) {
+    auto LSuccs = LT->getSuccessors();
+    auto RSuccs = cast<TermInst>(RI)->getSuccessors();
+    if (LSuccs.size() != RSuccs.size())
+      return false;
+    for (unsigned Idx = 0, E = LSuccs.size(); Idx != E; ++Idx) {
+      if (BlockMap.lookup(LSuccs[Idx].getBB()) != RSuccs[Idx].getBB())
+        return false;
+    }
+  }
+
+  return hasEquivalentState(LI, RI);
+}
+
+bool BodyComparator::compare() {
+  if (!areErasedEqual(LF->getLoweredFunctionType(),
+                      RF->getLoweredFunctionType()))
+    return false;
+
+  if (!mapBlocksAndValues())
+    return false;
+
+  for (auto LBI = LF->begin(), RBI = RF->begin(), E = LF->end(); LBI != E;
+       ++LBI, ++RBI) {
+    for (auto LII = LBI->begin(), RII = RBI->begin(), IE = LBI->end();
+         LII != IE; ++LII, ++RII) {
+      if (!areEquivalent(&*LII, &*RII))
+        return false;
+    }
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+//                           Specialization Merger
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+class SpecializationMerger : public SILModuleTransform {
+  /// Maps each merged specialization to the function its thunk calls.
+  llvm::DenseMap<SILFunction *, SILFunction *> MergedInto;
+
+  bool isCandidate(SILFunction *F);
+  SILFunction *getMergedFunction(SILFunction *F);
+  void replaceWithThunk(SILFunction *F, SILFunction *Target);
+  bool mergeSpecializations();
+
+  void run() override;
+
+  StringRef getName() override { return "Specialization Merger"; }
+};
+
+} // end anonymous namespace
+
+/// Returns a hash of the shape of \p F's body, which is equal for functions
+/// that may be equivalent.
+static llvm::hash_code hashBody(SILFunction *F) {
+  llvm::hash_code Hash = llvm::hash_value(F->size());
+  for (auto &BB : *F) {
+    Hash = llvm::hash_combine(Hash, BB.getNumBBArg());
+    for (auto &I : BB)
+      Hash = llvm::hash_combine(Hash, unsigned(I.getKind()));
+  }
+  return Hash;
+}
+
+bool SpecializationMerger::isCandidate(SILFunction *F) {
+  if (!F->isDefinition() || !F->getName().startswith("_TTS"))
+    return false;
+  if (F->isFragile() || F->isThunk() || F->isAvailableExternally() ||
+      F->hasSemanticsAttrs())
+    return false;
+  auto FnTy = F->getLoweredFunctionType();
+  return !FnTy->isPolymorphic() && !FnTy->hasErrorResult();
+}
+
+SILFunction *SpecializationMerger::getMergedFunction(SILFunction *F) {
+  auto Iter = MergedInto.find(F);
+  while (Iter != MergedInto.end()) {
+    F = Iter->second;
+    Iter = MergedInto.find(F);
+  }
+  return F;
+}
+
+/// Converts \p V, which has a type erased-equal to \p Ty, to \p Ty.
+static SILValue castTo(SILBuilder &B, SILLocation Loc, SILValue V,
+                       SILType Ty) {
+  if (V->getType() == Ty)
+    return V;
+  if (Ty.isAddress())
+    return B.createUncheckedAddrCast(Loc, V, Ty);
+  if (Ty.isHeapObjectReferenceType())
+    return B.createUncheckedRefCast(Loc, V, Ty);
+  return B.createUncheckedBitwiseCast(Loc, V, Ty);
+}
+
+/// Replaces the body of \p F with a call to the equivalent \p Target.
+void SpecializationMerger::replaceWithThunk(SILFunction *F,
+                                            SILFunction *Target) {
+  DEBUG(llvm::dbgs() << "  Merge " << F->getName() << " into "
+                     << Target->getName() << "\n");
+
+  SmallVector<SILType, 8> ArgTypes;
+  for (SILArgument *Arg : F->begin()->getBBArgs())
+    ArgTypes.push_back(Arg->getType());
+  F->convertToDeclaration();
+
+  SILBasicBlock *Entry = F->createBasicBlock();
+  SILBuilder B(Entry);
+  auto Loc = RegularLocation::getAutoGeneratedLocation();
+  auto *TargetEntry = &*Target->begin();
+
+  SmallVector<SILValue, 8> Args;
+  for (unsigned Idx = 0, E = ArgTypes.size(); Idx != E; ++Idx) {
+    SILValue Arg = Entry->createBBArg(ArgTypes[Idx]);
+    Args.push_back(
+        castTo(B, Loc, Arg, TargetEntry->getBBArg(Idx)->getType()));
+  }
+
+  auto *FRI = B.createFunctionRef(Loc, Target);
+  SILValue Result = B.createApply(Loc, FRI, Args, /*isNonThrowing*/ false);
+  if (Target->isNoReturnFunction()) {
+    B.createUnreachable(Loc);
+  } else {
+    auto ResultTy = F->getLoweredFunctionType()->getSILResult();
+    B.createReturn(Loc, castTo(B, Loc, Result, ResultTy));
+  }
+
+  F->setThunk(IsThunk);
+  MergedInto[F] = Target;
+  ++NumSpecializationsMerged;
+  invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
+}
+
+/// Merges each candidate into the first equivalent candidate before it.
+/// Returns true if anything was merged.
+bool SpecializationMerger::mergeSpecializations() {
+  llvm::MapVector<size_t, SmallVector<SILFunction *, 4>> Buckets;
+  for (auto &F : *getModule()) {
+    if (isCandidate(&F))
+      Buckets[size_t(hashBody(&F))].push_back(&F);
+  }
+
+  bool Changed = false;
+  auto GetMergedFunction = [this](SILFunction *F) {
+    return getMergedFunction(F);
+  };
+  for (auto &Bucket : Buckets) {
+    SmallVector<SILFunction *, 4> Distinct;
+    for (SILFunction *F : Bucket.second) {
+      SILFunction *Target = nullptr;
+      for (SILFunction *Other : Distinct) {
+        if (BodyComparator(Other, F, GetMergedFunction).compare()) {
+          Target = Other;
+          break;
+        }
+      }
+      if (!Target) {
+        Distinct.push_back(F);
+        continue;
+      }
+      replaceWithThunk(F, Target);
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
+void SpecializationMerger::run() {
+  DEBUG(llvm::dbgs() << "** Specialization Merger **\n");
+
+  // Merging two callees can make their callers equivalent.
+  while (mergeSpecializations()) {}
+
+  MergedInto.clear();
+}
+
+SILTransform *swift::createSpecializationMerger() {
+  return new SpecializationMerger();
+}
@@ -0,0 +1,347 @@
+//===--- ValueOperationOutliner.cpp - Outline copies and destroys ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Reduces code size by moving copies and destroys of large values into shared
+// functions.
+//
+// IRGen expands a copy_addr, destroy_addr, retain_value or release_value of a
+// loadable aggregate into one reference counting operation per non-trivial
+// field. For a struct with many references, each such instruction becomes a
+// long sequence of loads, retains and releases, which is repeated wherever
+// a value of the type is copied or destroyed. If an operation on a type occurs
+// often enough, this pass replaces all of its occurrences with calls to a
+// single [noinline] function, which performs the operation:
+//
+//   copy_addr %src to [initialization] %dst : $*S
+// ->
+//   %f = function_ref @_swift_outlined_copy_init_V4main1S
+//   apply %f(%dst, %src) : $@convention(thin) (@in_guaranteed S) -> @out S
+//
+// The outlined functions have shared linkage, so the same function emitted by
+// different files or modules is merged by the linker.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "value-operation-outliner"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/AST/Mangle.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumOutlinedOperations, "Number of outlined value operations");
+STATISTIC(NumOutlinedFunctions,
+          "Number of functions created for outlined value operations");
+
+/// Operations on types with fewer non-trivial fields are cheap enough to stay
+/// inline.
+static llvm::cl::opt<unsigned> OutlineMinFields(
+    "outline-value-ops-min-fields", llvm::cl::init(4),
+    llvm::cl::desc("The number of non-trivial fields a type needs for its "
+                   "copies and destroys to be outlined"));
+
+/// An outlined function only pays off if it replaces several operations.
+static llvm::cl::opt<unsigned> OutlineMinUses(
+    "outline-value-ops-min-uses", llvm::cl::init(2),
+    llvm::cl::desc("The number of times an operation on a type must occur "
+                   "in the module to be outlined"));
+
+namespace {
+
+/// The kinds of operations which are outlined.
+enum class OutlinedKind {
+  /// copy_addr %src to [initialization] %dst
+  CopyInit,
+  /// copy_addr %src to %dst
+  CopyAssign,
+  /// copy_addr [take] %src to %dst
+  TakeAssign,
+  /// destroy_addr %addr
+  Destroy,
+  /// retain_value %value
+  Retain,
+  /// release_value %value
+  Release
+};
+
+class ValueOperationOutliner : public SILModuleTransform {
+  /// The operations to outline, grouped by kind and type.
+  using OperationKey = std::pair<unsigned, SILType>;
+  llvm::MapVector<OperationKey, SmallVector<SILInstruction *, 8>> Operations;
+
+  /// Cache for the number of non-trivial fields of a type.
+  llvm::DenseMap<SILType, unsigned> NumFields;
+
+  unsigned getNumNonTrivialFields(SILType Ty);
+  bool isWorthOutlining(SILType Ty);
+  void collectOperation(SILInstruction *I);
+  SILFunction *getOutlinedFunction(OutlinedKind Kind, SILType Ty);
+  void replaceWithCall(SILInstruction *I, SILFunction *Outlined);
+
+  void run() override;
+
+  StringRef getName() override { return "Value Operation Outliner"; }
+};
+
+} // end anonymous namespace
+
+/// Returns the number of reference counting operations IRGen emits to copy or
+/// destroy a value of type \p Ty.
+unsigned ValueOperationOutliner::getNumNonTrivialFields(SILType Ty) {
+  auto Iter = NumFields.find(Ty);
+  if (Iter != NumFields.end())
+    return Iter->second;
+
+  SILModule &M = *getModule();
+  unsigned Count = 0;
+  if (Ty.isTrivial(M)) {
+    Count = 0;
+  } else if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    for (VarDecl *Field : SD->getStoredProperties())
+      Count += getNumNonTrivialFields(Ty.getFieldType(Field, M));
+  } else if (auto TT = Ty.getAs<TupleType>()) {
+    for (unsigned Idx = 0, E = TT->getNumElements(); Idx != E; ++Idx)
+      Count += getNumNonTrivialFields(Ty.getTupleElementType(Idx));
+  } else {
+    // A reference, an enum with a payload, etc.
+    Count = 1;
+  }
+  NumFields[Ty] = Count;
+  return Count;
+}
+
+bool ValueOperationOutliner::isWorthOutlining(SILType Ty) {
+  // Copies of generic and address-only values are already calls to value
+  // witnesses.
+  if (Ty.hasArchetype() || !Ty.isLoadable(*getModule()))
+    return false;
+  return getNumNonTrivialFields(Ty) >= OutlineMinFields;
+}
+
+void ValueOperationOutliner::collectOperation(SILInstruction *I) {
+  OutlinedKind Kind;
+  SILType Ty;
+  if (auto *CA = dyn_cast<CopyAddrInst>(I)) {
+    if (CA->isInitializationOfDest()) {
+      // A take-initialization is just a memcpy.
+      if (CA->isTakeOfSrc())
+        return;
+      Kind = OutlinedKind::CopyInit;
+    } else {
+      Kind = CA->isTakeOfSrc() ? OutlinedKind::TakeAssign :
+                                 OutlinedKind::CopyAssign;
+    }
+    Ty = CA->getSrc()->getType().getObjectType();
+  } else if (auto *DA = dyn_cast<DestroyAddrInst>(I)) {
+    Kind = OutlinedKind::Destroy;
+    Ty = DA->getOperand()->getType().getObjectType();
+  } else if (auto *RV = dyn_cast<RetainValueInst>(I)) {
+    if (RV->isNonAtomic())
+      return;
+    Kind = OutlinedKind::Retain;
+    Ty = RV->getOperand()->getType();
+  } else if (auto *RV = dyn_cast<ReleaseValueInst>(I)) {
+    if (RV->isNonAtomic())
+      return;
+    Kind = OutlinedKind::Release;
+    Ty = RV->getOperand()->getType();
+  } else {
+    return;
+  }
+
+  if (!isWorthOutlining(Ty))
+    return;
+
+  Operations[{unsigned(Kind), Ty}].push_back(I);
+}
+
+/// Returns the function which performs the operation \p Kind on a value of
+/// type \p Ty, creating it if it doesn't exist yet.
+SILFunction *ValueOperationOutliner::getOutlinedFunction(OutlinedKind Kind,
+                                                         SILType Ty) {
+  SILModule &M = *getModule();
+  CanType SwiftTy = Ty.getSwiftRValueType();
+
+  SmallVector<SILParameterInfo, 2> Params;
+  SmallVector<SILResultInfo, 1> Results;
+  StringRef Prefix;
+  switch (Kind) {
+  case OutlinedKind::CopyInit:
+    Prefix = "_swift_outlined_copy_init_";
+    Results.push_back(SILResultInfo(SwiftTy, ResultConvention::Indirect));
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                 ParameterConvention::Indirect_In_Guaranteed));
+    break;
+  case OutlinedKind::CopyAssign:
+    Prefix = "_swift_outlined_copy_assign_";
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                 ParameterConvention::Indirect_In_Guaranteed));
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                      ParameterConvention::Indirect_Inout));
+    break;
+  case OutlinedKind::TakeAssign:
+    Prefix = "_swift_outlined_take_assign_";
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                      ParameterConvention::Indirect_In));
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                      ParameterConvention::Indirect_Inout));
+    break;
+  case OutlinedKind::Destroy:
+    Prefix = "_swift_outlined_destroy_";
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                      ParameterConvention::Indirect_In));
+    break;
+  case OutlinedKind::Retain:
+    // The retained value is returned to the caller in its operand.
+    Prefix = "_swift_outlined_retain_";
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                      ParameterConvention::Direct_Guaranteed));
+    break;
+  case OutlinedKind::Release:
+    Prefix = "_swift_outlined_release_";
+    Params.push_back(SILParameterInfo(SwiftTy,
+                                      ParameterConvention::Direct_Owned));
+    break;
+  }
+
+  std::string Name;
+  {
+    Mangle::Mangler Mangler;
+    Mangler.append(Prefix);
+    Mangler.mangleType(SwiftTy, 0);
+    Name = Mangler.finalize();
+  }
+
+  auto FnTy = SILFunctionType::get(
+      nullptr,
+      SILFunctionType::ExtInfo()
+        .withRepresentation(SILFunctionType::Representation::Thin),
+      ParameterConvention::Direct_Unowned, Params, Results,
+      /*error result*/ None, M.getASTContext());
+
+  auto Loc = RegularLocation::getAutoGeneratedLocation();
+  SILFunction *Fn = M.getOrCreateSharedFunction(Loc, Name, FnTy, IsBare,
+                                                IsNotTransparent, IsNotFragile,
+                                                IsNotThunk);
+  // Re-use an existing function.
+  if (!Fn->empty())
+    return Fn;
+
+  // Inlining the function would undo the outlining.
+  Fn->setInlineStrategy(NoInline);
+  ++NumOutlinedFunctions;
+
+  SILBasicBlock *EntryBB = new (M) SILBasicBlock(Fn);
+  SILBuilder B(EntryBB);
+  SILType AddrTy = Ty.getAddressType();
+  switch (Kind) {
+  case OutlinedKind::CopyInit: {
+    auto *Dest = new (M) SILArgument(EntryBB, AddrTy);
+    auto *Src = new (M) SILArgument(EntryBB, AddrTy);
+    B.createCopyAddr(Loc, Src, Dest, IsNotTake, IsInitialization);
+    break;
+  }
+  case OutlinedKind::CopyAssign:
+  case OutlinedKind::TakeAssign: {
+    auto *Src = new (M) SILArgument(EntryBB, AddrTy);
+    auto *Dest = new (M) SILArgument(EntryBB, AddrTy);
+    B.createCopyAddr(Loc, Src, Dest,
+                     IsTake_t(Kind == OutlinedKind::TakeAssign),
+                     IsNotInitialization);
+    break;
+  }
+  case OutlinedKind::Destroy:
+    B.createDestroyAddr(Loc, new (M) SILArgument(EntryBB, AddrTy));
+    break;
+  case OutlinedKind::Retain:
+    B.createRetainValue(Loc, new (M) SILArgument(EntryBB, Ty),
+                        RefCountingInst::Atomicity::Atomic);
+    break;
+  case OutlinedKind::Release:
+    B.createReleaseValue(Loc, new (M) SILArgument(EntryBB, Ty),
+                         RefCountingInst::Atomicity::Atomic);
+    break;
+  }
+  B.createReturn(Loc, B.createTuple(Loc, {}));
+
+  DEBUG(llvm::dbgs() << "  created " << Name << '\n');
+  return Fn;
+}
+
+/// Replaces the operation \p I with a call to \p Outlined.
+void ValueOperationOutliner::replaceWithCall(SILInstruction *I,
+                                             SILFunction *Outlined) {
+  SmallVector<SILValue, 2> Args;
+  if (auto *CA = dyn_cast<CopyAddrInst>(I)) {
+    if (CA->isInitializationOfDest()) {
+      Args.push_back(CA->getDest());
+      Args.push_back(CA->getSrc());
+    } else {
+      Args.push_back(CA->getSrc());
+      Args.push_back(CA->getDest());
+    }
+  } else {
+    Args.push_back(I->getOperand(0));
+  }
+
+  SILBuilderWithScope B(I);
+  auto *FRI = B.createFunctionRef(I->getLoc(), Outlined);
+  B.createApply(I->getLoc(), FRI, Args, /*isNonThrowing*/ false);
+  I->eraseFromParent();
+  ++NumOutlinedOperations;
+}
+
+void ValueOperationOutliner::run() {
+  SILModule *M = getModule();
+  DEBUG(llvm::dbgs() << "** Value Operation Outliner **\n");
+
+  for (SILFunction &F : *M) {
+    // A fragile function's body is serialized and may only reference fragile
+    // functions.
+    if (!F.isDefinition() || F.isFragile())
+      continue;
+    for (SILBasicBlock &BB : F)
+      for (SILInstruction &I : BB)
+        collectOperation(&I);
+  }
+
+  llvm::SmallPtrSet<SILFunction *, 16> ChangedFunctions;
+  for (auto &Entry : Operations) {
+    auto Kind = OutlinedKind(Entry.first.first);
+    SILType Ty = Entry.first.second;
+    auto &Insts = Entry.second;
+    if (Insts.size() < OutlineMinUses)
+      continue;
+
+    SILFunction *Outlined = getOutlinedFunction(Kind, Ty);
+    for (SILInstruction *I : Insts) {
+      ChangedFunctions.insert(I->getFunction());
+      replaceWithCall(I, Outlined);
+    }
+  }
+  for (SILFunction *F : ChangedFunctions)
+    invalidateAnalysis(F, SILAnalysis::InvalidationKind::CallsAndInstructions);
+
+  Operations.clear();
+  NumFields.clear();
+}
+
+SILTransform *swift::createValueOperationOutliner() {
+  return new ValueOperationOutliner();
+}
@@ -707,21 +707,24 @@ static SILValue getSub(SILLocation Loc, SILValue Val, unsigned SubVal,
   return B.createTupleExtract(Loc, AI, 0);
 }
 
-/// A canonical induction variable incremented by one from Start to End-1.
+/// A canonical induction variable incremented by a positive constant Stride
+/// from Start to End-Stride.
 struct InductionInfo {
   SILArgument *HeaderVal;
   BuiltinInst *Inc;
   SILValue Start;
   SILValue End;
+  unsigned Stride;
   BuiltinValueKind Cmp;
   bool IsOverflowCheckInserted;
 
   InductionInfo()
-      : Cmp(BuiltinValueKind::None), IsOverflowCheckInserted(false) {}
+      : Stride(1), Cmp(BuiltinValueKind::None),
+        IsOverflowCheckInserted(false) {}
 
   InductionInfo(SILArgument *HV, BuiltinInst *I, SILValue S, SILValue E,
-                BuiltinValueKind C, bool IsOverflowChecked = false)
-      : HeaderVal(HV), Inc(I), Start(S), End(E), Cmp(C),
+                unsigned St, BuiltinValueKind C, bool IsOverflowChecked = false)
+      : HeaderVal(HV), Inc(I), Start(S), End(E), Stride(St), Cmp(C),
         IsOverflowCheckInserted(IsOverflowChecked) {}
 
   bool isValid() { return Start && End; }
@@ -734,13 +737,15 @@ struct InductionInfo {
   }
 
   SILValue getLastValue(SILLocation &Loc, SILBuilder &B) {
-    return getSub(Loc, End, 1, B);
+    return getSub(Loc, End, Stride, B);
   }
 
   /// If necessary insert an overflow for this induction variable.
   /// If we compare for equality we need to make sure that the range does wrap.
   /// We would have trapped either when overflowing or when accessing an array
   /// out of bounds in the original loop.
+  /// For a strided induction variable we also need to make sure that the
+  /// stride divides "End - Start", otherwise the variable would step over End.
   /// Returns true if an overflow check was inserted.
   bool checkOverflow(SILBuilder &Builder) {
     if (IsOverflowCheckInserted || Cmp != BuiltinValueKind::ICMP_EQ)
@@ -751,6 +756,20 @@ struct InductionInfo {
     auto *CmpSGE = Builder.createBuiltinBinaryFunction(
         Loc, "cmp_sge", Start->getType(), ResultTy, {Start, End});
     Builder.createCondFail(Loc, CmpSGE);
+
+    if (Stride != 1) {
+      // Start < End, so the unsigned difference can't wrap.
+      auto Ty = Start->getType();
+      auto *Diff = Builder.createBuiltinBinaryFunction(Loc, "sub", Ty, Ty,
+                                                       {End, Start});
+      auto *StrideVal = Builder.createIntegerLiteral(Loc, Ty, Stride);
+      auto *Rem = Builder.createBuiltinBinaryFunction(Loc, "urem", Ty, Ty,
+                                                      {Diff, StrideVal});
+      auto *Zero = Builder.createIntegerLiteral(Loc, Ty, 0);
+      auto *CmpNE = Builder.createBuiltinBinaryFunction(
+          Loc, "cmp_ne", Ty, ResultTy, {Rem, Zero});
+      Builder.createCondFail(Loc, CmpNE);
+    }
     IsOverflowCheckInserted = true;
 
     // We can now remove the cond fail on the increment the above comparison
@@ -765,7 +784,7 @@ struct InductionInfo {
 /// Analyse canonical induction variables in a loop to find their start and end
 /// values.
 /// At the moment we only handle very simple induction variables that increment
-/// by one and use equality comparison.
+/// by a positive constant and use equality comparison.
 class InductionAnalysis {
   using InductionInfoMap = llvm::DenseMap<SILArgument *, InductionInfo *>;
 
@@ -823,8 +842,12 @@ private:
   /// Analyse one potential induction variable starting at Arg.
   InductionInfo *analyseIndVar(SILArgument *HeaderVal, BuiltinInst *Inc,
                                IntegerLiteralInst *IncVal) {
-    if (IncVal->getValue() != 1)
+    // We only handle positive strides which fit into an unsigned.
+    APInt IncAmount = IncVal->getValue();
+    if (IncAmount.isNegative() || IncAmount == 0 ||
+        IncAmount.getActiveBits() > 31)
       return nullptr;
+    unsigned Stride = IncAmount.getZExtValue();
 
     // Find the start value.
     auto *PreheaderTerm = dyn_cast<BranchInst>(Preheader->getTerminator());
@@ -867,14 +890,19 @@ private:
 
     // Check whether the addition is overflow checked by a cond_fail or whether
     // code in the preheader's predecessor ensures that we won't overflow.
+    // A range check does not tell us whether a strided induction variable
+    // hits End, so for strides we need the overflow check to hoist it.
     bool IsRangeChecked = false;
     if (!isOverflowChecked(Inc)) {
+      if (Stride != 1)
+        return nullptr;
       IsRangeChecked = isRangeChecked(Start, End, Preheader, DT);
       if (!IsRangeChecked)
         return nullptr;
     }
-    return new (Allocator.Allocate()) InductionInfo(
-        HeaderVal, Inc, Start, End, BuiltinValueKind::ICMP_EQ, IsRangeChecked);
+    return new (Allocator.Allocate())
+        InductionInfo(HeaderVal, Inc, Start, End, Stride,
+                      BuiltinValueKind::ICMP_EQ, IsRangeChecked);
   }
 };
 
@@ -922,7 +950,7 @@ public:
 
   /// Returns true if the loop iterates from 0 until count of \p Array.
   bool isZeroToCount(SILValue Array) {
-    return getZeroToCountArray(Ind->Start, Ind->End) == Array;
+    return Ind->Stride == 1 && getZeroToCountArray(Ind->Start, Ind->End) == Array;
   }
 
   /// Hoists the necessary check for beginning and end of the induction
@@ -967,11 +995,16 @@ static bool hasArrayType(SILValue Value, SILModule &M) {
 /// Hoist bounds check in the loop to the loop preheader.
 static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
                               ABCAnalysis &ABC, InductionAnalysis &IndVars,
-                              SILBasicBlock *Preheader, SILBasicBlock *Header,
+                              SILLoop *Loop, SILBasicBlock *Preheader,
+                              SILBasicBlock *Header,
                               SILBasicBlock *SingleExitingBlk) {
 
-  bool Changed = false;
   auto *CurBB = DTNode->getBlock();
+  // We only checked for safety inside the loop (with ABCAnalysis).
+  if (!Loop->contains(CurBB))
+    return false;
+
+  bool Changed = false;
   bool blockAlwaysExecutes = isGuaranteedToBeExecuted(DT, CurBB,
                                                       SingleExitingBlk);
 
@@ -1065,7 +1098,7 @@ static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
   DEBUG(Preheader->getParent()->dump());
   // Traverse the children in the dominator tree.
   for (auto Child: *DTNode)
-    Changed |= hoistChecksInLoop(DT, Child, ABC, IndVars, Preheader,
+    Changed |= hoistChecksInLoop(DT, Child, ABC, IndVars, Loop, Preheader,
                                  Header, SingleExitingBlk);
 
   return Changed;
@@ -1111,10 +1144,9 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
     return false;
   }
 
-  // Only handle innermost loops for now.
-  if (!Loop->getSubLoops().empty())
-    return false;
-
+  // Sub-loops are processed before their parent loop, so invariant checks in
+  // an inner loop are already hoisted into its preheader. From there they can
+  // be hoisted further, e.g. the check of the outer array in "a[i][j]".
   DEBUG(llvm::dbgs() << "Attempting to remove redundant checks in " << *Loop);
   DEBUG(Header->getParent()->dump());
 
@@ -1228,7 +1260,7 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
   DEBUG(Preheader->getParent()->dump());
 
   // Hoist bounds checks.
-  Changed |= hoistChecksInLoop(DT, DT->getNode(Header), ABC, IndVars,
+  Changed |= hoistChecksInLoop(DT, DT->getNode(Header), ABC, IndVars, Loop,
                                Preheader, Header, SingleExitingBlk);
   if (Changed) {
     Preheader->getParent()->verify();
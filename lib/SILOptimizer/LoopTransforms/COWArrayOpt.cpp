@@ -27,6 +27,7 @@
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
@@ -338,6 +339,7 @@ class COWArrayOpt {
   typedef StructUseCollector::UserOperList UserOperList;
 
   RCIdentityFunctionInfo *RCIA;
+  SideEffectAnalysis *SEA;
   SILFunction *Function;
   SILLoop *Loop;
   SILBasicBlock *Preheader;
@@ -385,9 +387,9 @@ class COWArrayOpt {
   // analysing.
   SILValue CurrentArrayAddr;
 public:
-  COWArrayOpt(RCIdentityFunctionInfo *RCIA, SILLoop *L,
-              DominanceAnalysis *DA)
-      : RCIA(RCIA), Function(L->getHeader()->getParent()), Loop(L),
+  COWArrayOpt(RCIdentityFunctionInfo *RCIA, SideEffectAnalysis *SEA,
+              SILLoop *L, DominanceAnalysis *DA)
+      : RCIA(RCIA), SEA(SEA), Function(L->getHeader()->getParent()), Loop(L),
         Preheader(L->getLoopPreheader()), DomTree(DA->get(Function)),
         ColdBlocks(DA), CachedSafeLoop(false, false) {}
 
@@ -396,6 +398,7 @@ public:
 protected:
   bool checkUniqueArrayContainer(SILValue ArrayContainer);
   SmallPtrSetImpl<SILBasicBlock*> &getReachingBlocks();
+  bool isReadOnlyCall(SILInstruction *Inst);
   bool isRetainReleasedBeforeMutate(SILInstruction *RetainInst,
                                     bool IsUniquelyIdentifiedArray = true);
   bool checkSafeArrayAddressUses(UserList &AddressUsers);
@@ -493,6 +496,21 @@ static bool isNonMutatingArraySemanticCall(SILInstruction *Inst) {
   }
 }
 
+/// \return true if the instruction is a call which, according to the side
+/// effect analysis, neither retains, releases nor writes anything. Such a call
+/// can neither create another reference to an array buffer nor run a
+/// destructor.
+bool COWArrayOpt::isReadOnlyCall(SILInstruction *Inst) {
+  auto *AI = dyn_cast<ApplyInst>(Inst);
+  if (!AI)
+    return false;
+
+  SideEffectAnalysis::FunctionEffects E;
+  SEA->getEffects(E, AI);
+  return E.getMemBehavior(RetainObserveKind::ObserveRetains) <=
+         SILInstruction::MemoryBehavior::MayRead;
+}
+
 /// \return true if the given retain instruction is followed by a release on the
 /// same object prior to any potential mutating operation.
 bool COWArrayOpt::isRetainReleasedBeforeMutate(SILInstruction *RetainInst,
@@ -526,6 +544,10 @@ bool COWArrayOpt::isRetainReleasedBeforeMutate(SILInstruction *RetainInst,
     if (isNonMutatingArraySemanticCall(&*II))
       continue;
 
+    // So are calls which don't write, retain or release anything.
+    if (isReadOnlyCall(&*II))
+      continue;
+
     if (IsUniquelyIdentifiedArray) {
       // It is okay for an identified loop to have releases in between a retain
       // and a release. We can end up here if we have two retains in a row and
@@ -901,6 +923,10 @@ bool COWArrayOpt::isArrayValueReleasedBeforeMutate(
     if (isNonMutatingArraySemanticCall(&*II))
       continue;
 
+    // So are calls which don't write, retain or release anything.
+    if (isReadOnlyCall(&*II))
+      continue;
+
     return false;
   }
   return true;
@@ -1171,9 +1197,6 @@ private:
 /// Prove that there are not array value mutating or capturing operations in the
 /// loop and hoist make_mutable.
 bool COWArrayOpt::hoistInLoopWithOnlyNonArrayValueMutatingOperations() {
-  // Only handle innermost loops.
-  assert(Loop->getSubLoops().empty() && "Only works in innermost loops");
-
   DEBUG(llvm::dbgs() << "    Checking whether loop only has only non array "
                         "value mutating operations ...\n");
 
@@ -1242,6 +1265,11 @@ bool COWArrayOpt::hoistInLoopWithOnlyNonArrayValueMutatingOperations() {
       if (isa<AllocationInst>(Inst) || isa<DeallocStackInst>(Inst))
         continue;
 
+      // A call which doesn't write, retain or release anything can't capture
+      // an array value.
+      if (isReadOnlyCall(Inst))
+        continue;
+
       // A retain must be released before make_unique.
       if (isa<RetainValueInst>(Inst) ||
           isa<StrongRetainInst>(Inst)) {
@@ -1305,17 +1333,21 @@ bool COWArrayOpt::hoistInLoopWithOnlyNonArrayValueMutatingOperations() {
     return ReturnWithCleanup(false);
   }
 
-  // Collect all recursively hoistable calls.
+  // Collect all recursively hoistable calls. No operation in the loop can
+  // make an array value non-unique, so each call can be hoisted on its own,
+  // e.g. the outer array's make_mutable in a loop over a[i][j] where i varies.
   SmallVector<std::unique_ptr<HoistableMakeMutable>, 16> CallsToHoist;
   for (auto M : MakeMutableCalls) {
     auto Call = llvm::make_unique<HoistableMakeMutable>(M, Loop);
     if (!Call->isHoistable()) {
-      DEBUG(llvm::dbgs() << "    (NO) make_mutable not hoistable"
+      DEBUG(llvm::dbgs() << "    make_mutable not hoistable"
                          << *Call->MakeMutable);
-      return ReturnWithCleanup(false);
+      continue;
     }
     CallsToHoist.push_back(std::move(Call));
   }
+  if (CallsToHoist.empty())
+    return ReturnWithCleanup(false);
 
   for (auto &Call: CallsToHoist)
     Call->hoist();
@@ -1515,11 +1547,9 @@ bool COWArrayOpt::run() {
   }
 
   // Hoist make_mutable in two dimensional arrays if there are no array value
-  // mutating operations in the loop.
-  if (Loop->getSubLoops().empty() &&
-      hoistInLoopWithOnlyNonArrayValueMutatingOperations()) {
-    return true;
-  }
+  // mutating operations in the loop. The remaining make_mutable calls are
+  // handled below.
+  HasChanged = hoistInLoopWithOnlyNonArrayValueMutatingOperations();
 
   for (auto *BB : Loop->getBlocks()) {
     if (ColdBlocks.isCold(BB))
@@ -1567,6 +1597,7 @@ class COWArrayOptPass : public SILFunctionTransform {
     auto *LA = PM->getAnalysis<SILLoopAnalysis>();
     auto *RCIA =
       PM->getAnalysis<RCIdentityAnalysis>()->get(getFunction());
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
     SILLoopInfo *LI = LA->get(getFunction());
     if (LI->empty()) {
       DEBUG(llvm::dbgs() << "  Skipping Function: No loops.\n");
@@ -1592,7 +1623,7 @@ class COWArrayOptPass : public SILFunctionTransform {
 
     bool HasChanged = false;
     for (auto *L : Loops)
-      HasChanged |= COWArrayOpt(RCIA, L, DA).run();
+      HasChanged |= COWArrayOpt(RCIA, SEA, L, DA).run();
 
       if (HasChanged) {
         invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-licm"
 
 #include "swift/SIL/Dominance.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
@@ -221,6 +222,41 @@ static bool hasNoSideEffect(SILInstruction *Inst, ReadSet &SafeReads) {
   return false;
 }
 
+/// Returns true if \p Inst may be executed even if it is not executed on every
+/// path through the loop, i.e. if it can be hoisted out of a conditionally
+/// executed block.
+///
+/// This is the case for the address projection of a stored class property and
+/// for the load from it, if the class instance is a guaranteed function
+/// argument: the instance is alive for the whole function and loading one of
+/// its stored properties can't trap.
+static bool canSpeculate(SILInstruction *Inst) {
+  if (auto *LI = dyn_cast<LoadInst>(Inst)) {
+    auto *REA = dyn_cast<RefElementAddrInst>(LI->getOperand());
+    return REA && canSpeculate(REA);
+  }
+  if (auto *REA = dyn_cast<RefElementAddrInst>(Inst)) {
+    auto *Arg = dyn_cast<SILArgument>(REA->getOperand());
+    return Arg && Arg->isFunctionArg() &&
+           Arg->hasConvention(SILArgumentConvention::Direct_Guaranteed);
+  }
+  return false;
+}
+
+/// Emits a remark for a load with loop invariant operands which could not be
+/// hoisted.
+static void emitLoadNotHoisted(SILInstruction *Inst, SILLoop *Loop,
+                               StringRef Reason) {
+  auto *LI = dyn_cast<LoadInst>(Inst);
+  if (!LI)
+    return;
+  SILModule &M = LI->getModule();
+  if (!OptRemark::isEnabled(M) || !hasLoopInvariantOperands(LI, Loop))
+    return;
+  OptRemark::emit(M, OptRemark::RemarkMissed(DEBUG_TYPE, "LoadNotHoisted", *LI)
+                         << OptRemark::Argument("Reason", Reason));
+}
+
 static bool canHoistInstruction(SILInstruction *Inst, SILLoop *Loop,
                                 ReadSet &SafeReads) {
   // Can't hoist terminators.
@@ -265,16 +301,37 @@ static bool hoistInstructions(SILLoop *Loop, DominanceInfo *DT,
        It != E;) {
     auto *CurBB = It->getBlock();
 
-    // Don't decent into control-dependent code. Only traverse into basic blocks
-    // that dominate all exits.
+    // The dominator tree below the header also contains the loop exits.
+    if (!Loop->contains(CurBB)) {
+      It.skipChildren();
+      continue;
+    }
+
+    // In control-dependent code, i.e. in blocks which don't dominate all exits,
+    // only hoist instructions which can be executed speculatively.
     if (!std::all_of(ExitingBBs.begin(), ExitingBBs.end(),
                      [=](SILBasicBlock *ExitBB) {
           if (DT->dominates(CurBB, ExitBB))
             return true;
           return false;
         })) {
-      DEBUG(llvm::dbgs() << "  skipping conditional block " << *CurBB << "\n");
-      It.skipChildren();
+      DEBUG(llvm::dbgs() << "  conditional block " << *CurBB << "\n");
+      for (auto InstIt = CurBB->begin(), E = CurBB->end(); InstIt != E; ) {
+        SILInstruction *Inst = &*InstIt;
+        ++InstIt;
+        if (!canSpeculate(Inst)) {
+          emitLoadNotHoisted(Inst, Loop, "conditionally executed");
+          continue;
+        }
+        if (canHoistInstruction(Inst, Loop, SafeReads)) {
+          DEBUG(llvm::dbgs() << "   speculatively hoisting " << *Inst);
+          Changed = true;
+          Inst->moveBefore(Preheader->getTerminator());
+        } else {
+          emitLoadNotHoisted(Inst, Loop, "may be written in loop");
+        }
+      }
+      ++It;
       continue;
     }
 
@@ -287,7 +344,10 @@ static bool hoistInstructions(SILLoop *Loop, DominanceInfo *DT,
         DEBUG(llvm::dbgs() << "   hoisting to preheader.\n");
         Changed = true;
         Inst->moveBefore(Preheader->getTerminator());
-      } else if (RunsOnHighLevelSil) {
+        continue;
+      }
+      emitLoadNotHoisted(Inst, Loop, "may be written in loop");
+      if (RunsOnHighLevelSil) {
         ArraySemanticsCall semCall(Inst);
         switch (semCall.getKind()) {
         case ArrayCallKind::kGetCount:
@@ -500,8 +560,13 @@ void LoopTreeOptimization::analyzeCurrentLoop(
         SEA->getEffects(E, AI);
 
         auto MB = E.getMemBehavior(RetainObserveKind::ObserveRetains);
-        if (MB <= SILInstruction::MemoryBehavior::MayRead)
+        if (MB <= SILInstruction::MemoryBehavior::MayRead) {
+          // A read-only call neither clobbers loads nor prevents other
+          // read-only calls from being hoisted, e.g. a side-effect free
+          // getter which guards the load of a class property.
           ReadOnlyApplies.push_back(AI);
+          continue;
+        }
       }
       if (Inst.mayHaveSideEffects()) {
         MayWrites.push_back(&Inst);
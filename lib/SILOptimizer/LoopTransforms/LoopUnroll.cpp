@@ -14,6 +14,7 @@
 
 #include "llvm/ADT/DepthFirstIterator.h"
 
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/PatternMatch.h"
 #include "swift/SIL/SILCloner.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
@@ -21,6 +22,7 @@
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/SILInliner.h"
 #include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace swift;
 using namespace swift::PatternMatch;
@@ -30,6 +32,12 @@ using llvm::MapVector;
 
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The largest factor by which a loop is partially unrolled.
+static llvm::cl::opt<unsigned> MaxPartialUnrollFactor(
+    "sil-loop-partial-unroll-max-factor", llvm::cl::init(8),
+    llvm::cl::desc("The maximum factor of partial loop unrolling (0 disables "
+                   "partial unrolling)"));
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -162,27 +170,53 @@ static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
   return Dist.getZExtValue();
 }
 
-/// Check whether we can duplicate the instructions in the loop and use a
-/// heuristic that looks at the trip count and the cost of the instructions in
-/// the loop to determine whether we should unroll this loop.
-static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
-  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
-  if (TripCount > 32)
-    return false;
-
-  // We can unroll a loop if we can duplicate the instructions it holds.
+/// Returns the number of non-free instructions in the loop or None if the loop
+/// contains instructions which can't be duplicated.
+static Optional<uint64_t> getLoopCost(SILLoop *Loop) {
   uint64_t Cost = 0;
   for (auto *BB : Loop->getBlocks()) {
     for (auto &Inst : *BB) {
       if (!Loop->canDuplicate(&Inst))
-        return false;
+        return None;
       if (instructionInlineCost(Inst) != InlineCost::Free)
         ++Cost;
-      if (Cost * TripCount > SILLoopUnrollThreshold)
-        return false;
+    }
   }
+  return Cost;
+}
+
+/// Use a heuristic that looks at the trip count and the cost of the
+/// instructions in the loop to determine whether we should fully unroll this
+/// loop.
+static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount,
+                                   uint64_t Cost) {
+  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
+  if (TripCount > 32)
+    return false;
+  return Cost * TripCount <= SILLoopUnrollThreshold;
+}
+
+/// Computes the factor by which a loop, which is too large to be fully
+/// unrolled, should be partially unrolled. Returns 0 if partial unrolling is
+/// not profitable.
+///
+/// The first TripCount % Factor iterations are peeled off in front of the
+/// loop, so the exit condition only needs to be checked once per Factor
+/// iterations. The code growth of both the unrolled body and the peeled
+/// remainder must stay below the unroll threshold.
+static unsigned getPartialUnrollFactor(SILLoop *Loop, uint64_t TripCount,
+                                       uint64_t Cost) {
+  if (Cost == 0)
+    return 0;
+
+  for (unsigned Factor = MaxPartialUnrollFactor; Factor >= 2; Factor /= 2) {
+    if (Factor * 2 > TripCount)
+      continue;
+    uint64_t Remainder = TripCount % Factor;
+    if (Cost * (Factor + Remainder) <= SILLoopUnrollThreshold)
+      return Factor;
   }
-  return true;
+  return 0;
 }
 
 /// Redirect the terminator of the current loop iteration's latch to the next
@@ -324,29 +358,8 @@ updateSSA(SILLoop *Loop,
   }
 }
 
-/// Try to fully unroll the loop if we can determine the trip count and the trip
-/// count lis below a threshold.
-static bool tryToUnrollLoop(SILLoop *Loop) {
-  assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
-
-  auto *Preheader = Loop->getLoopPreheader();
-  if (!Preheader)
-    return false;
-
-  auto *Latch = Loop->getLoopLatch();
-  if (!Latch)
-    return false;
-
-  auto *Header = Loop->getHeader();
-
-  Optional<uint64_t> MaxTripCount =
-      getMaxLoopTripCount(Loop, Preheader, Header, Latch);
-  if (!MaxTripCount)
-    return false;
-
-  if (!canAndShouldUnrollLoop(Loop, MaxTripCount.getValue()))
-    return false;
-
+/// Returns true if all exiting blocks of \p Loop end in a conditional branch.
+static bool hasOnlyCondBranchExits(SILLoop *Loop) {
   // TODO: We need to split edges from non-condbr exits for the SSA updater. For
   // now just don't handle loops containing such exits.
   SmallVector<SILBasicBlock *, 16> ExitingBlocks;
@@ -354,20 +367,19 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   for (auto &Exit : ExitingBlocks)
     if (!isa<CondBranchInst>(Exit->getTerminator()))
       return false;
+  return true;
+}
 
-  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
-                     << " " << *Loop << "\n");
-
-  SmallVector<SILBasicBlock *, 16> Headers;
-  Headers.push_back(Header);
-
-  SmallVector<SILBasicBlock *, 16> Latches;
-  Latches.push_back(Latch);
-
-  DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
-
-  // Copy the body MaxTripCount-1 times.
-  for (uint64_t Cnt = 1; Cnt < *MaxTripCount; ++Cnt) {
+/// Clone the blocks of \p Loop \p NumCopies times and append the headers and
+/// latches of the copies to \p Headers and \p Latches. \p LoopLiveOutValues
+/// maps the values which are used outside the loop to their copies.
+static void cloneLoopBody(
+    SILLoop *Loop, uint64_t NumCopies, SmallVectorImpl<SILBasicBlock *> &Headers,
+    SmallVectorImpl<SILBasicBlock *> &Latches,
+    DenseMap<SILValue, SmallVector<SILValue, 8>> &LoopLiveOutValues) {
+  auto *Header = Loop->getHeader();
+  auto *Latch = Loop->getLoopLatch();
+  for (uint64_t Cnt = 1; Cnt <= NumCopies; ++Cnt) {
     // Clone the blocks in the loop.
     LoopCloner Cloner(Loop);
     Cloner.cloneLoop();
@@ -396,6 +408,202 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
       }
     }
   }
+}
+
+/// Redirect the backedge of a loop copy, which ends in \p Latch and starts at
+/// \p Header, to \p NextHeader. If \p RemoveExit is true the conditional exit
+/// at the latch is known not to be taken and is replaced by an unconditional
+/// branch.
+static void redirectBackedge(SILBasicBlock *Latch, SILBasicBlock *Header,
+                             SILBasicBlock *NextHeader, bool RemoveExit) {
+  auto *CurrentTerminator = Latch->getTerminator();
+
+  // Handle the split backedge case.
+  if (auto *Br = dyn_cast<BranchInst>(CurrentTerminator)) {
+    if (RemoveExit) {
+      auto *CondBr =
+          cast<CondBranchInst>(Latch->getSinglePredecessor()->getTerminator());
+      if (CondBr->getTrueBB() == Latch)
+        SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                        CondBr->getTrueArgs());
+      else
+        SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                        CondBr->getFalseArgs());
+      CondBr->eraseFromParent();
+    }
+    SILBuilder(Br).createBranch(Br->getLoc(), NextHeader, Br->getArgs());
+    Br->eraseFromParent();
+    return;
+  }
+
+  // Otherwise, we have a conditional branch to the header.
+  auto *CondBr = cast<CondBranchInst>(CurrentTerminator);
+  bool TrueIsBackedge = CondBr->getTrueBB() == Header;
+  SILBuilder B(CondBr);
+  if (RemoveExit)
+    B.createBranch(CondBr->getLoc(), NextHeader,
+                   TrueIsBackedge ? CondBr->getTrueArgs()
+                                  : CondBr->getFalseArgs());
+  else if (TrueIsBackedge)
+    B.createCondBranch(CondBr->getLoc(), CondBr->getCondition(), NextHeader,
+                       CondBr->getTrueArgs(), CondBr->getFalseBB(),
+                       CondBr->getFalseArgs());
+  else
+    B.createCondBranch(CondBr->getLoc(), CondBr->getCondition(),
+                       CondBr->getTrueBB(), CondBr->getTrueArgs(), NextHeader,
+                       CondBr->getFalseArgs());
+  CondBr->eraseFromParent();
+}
+
+/// Partially unroll a loop with a known trip count by the factor computed by
+/// the cost model.
+///
+/// The loop body is copied Factor-1 times and the copies are chained, so that
+/// only the last copy checks the exit condition and branches back to the
+/// header. The remaining TripCount % Factor iterations are peeled off in front
+/// of the unrolled loop.
+static bool tryToPartiallyUnrollLoop(SILLoop *Loop, uint64_t TripCount,
+                                     uint64_t Cost) {
+  auto *Header = Loop->getHeader();
+  auto *Latch = Loop->getLoopLatch();
+  auto *Preheader = Loop->getLoopPreheader();
+  SILModule &M = Header->getModule();
+
+  auto emitNotUnrolled = [&](StringRef Reason) {
+    if (!OptRemark::isEnabled(M))
+      return;
+    OptRemark::emit(M, OptRemark::RemarkMissed(DEBUG_TYPE, "NotUnrolled",
+                                               *Latch->getTerminator())
+                           << OptRemark::Argument("TripCount",
+                                                  unsigned(TripCount))
+                           << OptRemark::Argument("Cost", unsigned(Cost))
+                           << OptRemark::Argument("Reason", Reason));
+  };
+
+  // Don't blow up code which is never executed according to the profile.
+  if (auto Count = Header->getExecutionCount()) {
+    if (*Count == 0) {
+      emitNotUnrolled("cold");
+      return false;
+    }
+  }
+
+  unsigned Factor = getPartialUnrollFactor(Loop, TripCount, Cost);
+  if (!Factor) {
+    emitNotUnrolled("too costly");
+    return false;
+  }
+
+  if (!hasOnlyCondBranchExits(Loop))
+    return false;
+
+  // The unrolled copies rely on the exit condition becoming true exactly after
+  // TripCount iterations, and on the true successor being the exit.
+  auto *ExitingBB = Loop->isLoopExiting(Latch) ? Latch
+                                               : Latch->getSinglePredecessor();
+  auto *ExitBr = cast<CondBranchInst>(ExitingBB->getTerminator());
+  if (Loop->contains(ExitBr->getTrueBB()))
+    return false;
+
+  // The preheader must branch unconditionally to the header so that we can
+  // redirect it to the peeled iterations.
+  auto *PreheaderBr = dyn_cast<BranchInst>(Preheader->getTerminator());
+  if (!PreheaderBr)
+    return false;
+
+  unsigned Remainder = TripCount % Factor;
+
+  DEBUG(llvm::dbgs() << "Partially unrolling loop in "
+                     << Header->getParent()->getName() << " by " << Factor
+                     << " with " << Remainder << " peeled iterations "
+                     << *Loop << "\n");
+
+  // Headers[0, Factor) and Latches[0, Factor) are the copies forming the
+  // unrolled loop, the rest are the peeled iterations.
+  SmallVector<SILBasicBlock *, 16> Headers;
+  Headers.push_back(Header);
+
+  SmallVector<SILBasicBlock *, 16> Latches;
+  Latches.push_back(Latch);
+
+  DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
+  cloneLoopBody(Loop, Factor - 1 + Remainder, Headers, Latches,
+                LoopLiveOutValues);
+
+  // Chain the copies of the unrolled loop. The exit condition is true exactly
+  // after TripCount iterations. As the peeled iterations leave a multiple of
+  // Factor iterations to the unrolled loop, only the last copy can exit.
+  for (unsigned Iteration = 0; Iteration != Factor; ++Iteration) {
+    bool IsLast = Iteration == Factor - 1;
+    redirectBackedge(Latches[Iteration], Headers[Iteration],
+                     IsLast ? Header : Headers[Iteration + 1],
+                     /*RemoveExit*/ !IsLast);
+  }
+
+  // Enter the loop through the peeled iterations, whose exit conditions can't
+  // be true either.
+  if (Remainder) {
+    SILBuilder(PreheaderBr)
+        .createBranch(PreheaderBr->getLoc(), Headers[Factor],
+                      PreheaderBr->getArgs());
+    PreheaderBr->eraseFromParent();
+    for (unsigned Iteration = Factor, End = Headers.size(); Iteration != End;
+         ++Iteration) {
+      bool IsLast = Iteration == End - 1;
+      redirectBackedge(Latches[Iteration], Headers[Iteration],
+                       IsLast ? Header : Headers[Iteration + 1],
+                       /*RemoveExit*/ true);
+    }
+  }
+
+  // Fixup SSA form for loop values used outside the loop.
+  updateSSA(Loop, LoopLiveOutValues);
+  return true;
+}
+
+/// Try to fully unroll the loop if we can determine the trip count and the trip
+/// count lis below a threshold. Otherwise try to partially unroll the loop.
+static bool tryToUnrollLoop(SILLoop *Loop) {
+  assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
+
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  auto *Latch = Loop->getLoopLatch();
+  if (!Latch)
+    return false;
+
+  auto *Header = Loop->getHeader();
+
+  Optional<uint64_t> MaxTripCount =
+      getMaxLoopTripCount(Loop, Preheader, Header, Latch);
+  if (!MaxTripCount)
+    return false;
+
+  Optional<uint64_t> Cost = getLoopCost(Loop);
+  if (!Cost)
+    return false;
+
+  if (!canAndShouldUnrollLoop(Loop, *MaxTripCount, *Cost))
+    return tryToPartiallyUnrollLoop(Loop, *MaxTripCount, *Cost);
+
+  if (!hasOnlyCondBranchExits(Loop))
+    return false;
+
+  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
+                     << " " << *Loop << "\n");
+
+  SmallVector<SILBasicBlock *, 16> Headers;
+  Headers.push_back(Header);
+
+  SmallVector<SILBasicBlock *, 16> Latches;
+  Latches.push_back(Latch);
+
+  DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
+
+  // Copy the body MaxTripCount-1 times.
+  cloneLoopBody(Loop, *MaxTripCount - 1, Headers, Latches, LoopLiveOutValues);
 
   // Thread the loop clones by redirecting the loop latches to the successor
   // iteration's header.
@@ -14,6 +14,8 @@
 
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Range.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
@@ -25,13 +27,17 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/TimeValue.h"
+#include <algorithm>
 
 using namespace swift;
 
 STATISTIC(NumOptzIterations, "Number of optimization iterations");
+STATISTIC(NumBranchInvalidationsAvoided,
+          "Number of branch invalidations that left the CFG unchanged");
 
 llvm::cl::opt<bool> SILPrintAll(
     "sil-print-all", llvm::cl::init(false),
@@ -45,10 +51,35 @@ llvm::cl::opt<bool> SILPrintPassTime(
     "sil-print-pass-time", llvm::cl::init(false),
     llvm::cl::desc("Print the execution time of each SIL pass"));
 
+llvm::cl::opt<bool> SILPassProfile(
+    "sil-pass-profile", llvm::cl::init(false),
+    llvm::cl::desc("Print the time, analysis invalidations and change in "
+                   "instruction count of each SIL pass on each function"));
+
+llvm::cl::opt<unsigned> SILPassProfileEntries(
+    "sil-pass-profile-entries", llvm::cl::init(50),
+    llvm::cl::desc("The number of (pass, function) pairs to print with "
+                   "-sil-pass-profile"));
+
+llvm::cl::opt<bool> SILPrintFunctionPassParallelism(
+    "sil-print-function-pass-parallelism", llvm::cl::init(false),
+    llvm::cl::desc("Print how much of each run of function passes could run "
+                   "on independent functions in parallel"));
+
 llvm::cl::opt<unsigned> SILNumOptPassesToRun(
     "sil-opt-pass-count", llvm::cl::init(UINT_MAX),
     llvm::cl::desc("Stop optimizing after <N> optimization passes"));
 
+llvm::cl::list<unsigned> SILSkipPassNumber(
+    "sil-skip-pass-number", llvm::cl::CommaSeparated,
+    llvm::cl::desc("Skip the optimization passes with these numbers, as "
+                   "printed by -sil-print-pass-name"));
+
+llvm::cl::opt<bool> SILPrintCumulativePassTime(
+    "sil-print-cumulative-pass-time", llvm::cl::init(false),
+    llvm::cl::desc("Print the number and execution time of each SIL pass, "
+                   "and the total time of all passes so far"));
+
 llvm::cl::opt<std::string> SILBreakOnFun(
     "sil-break-on-function", llvm::cl::init(""),
     llvm::cl::desc(
@@ -91,6 +122,11 @@ llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<bool> SILDisableCFGChangeTracking(
+    "sil-disable-cfg-change-tracking", llvm::cl::init(false),
+    llvm::cl::desc("Invalidate branch-dependent analyses whenever a pass "
+                   "says it changed branches, even if the CFG is unchanged"));
+
 llvm::cl::opt<bool> SILDisableSkippingPasses(
     "sil-disable-skipping-passes", llvm::cl::init(false),
     llvm::cl::desc("Do not skip passes even if nothing was changed"));
@@ -182,6 +218,45 @@ static bool isDisabled(SILTransform *T) {
   return false;
 }
 
+/// Returns true if the optimization pass numbered \p PassNumber should be
+/// skipped.
+static bool isSkippedPassNumber(SILModule *Mod, unsigned PassNumber) {
+  // Mandatory passes always run, like with -sil-opt-pass-count.
+  if (Mod->getStage() == SILStage::Raw)
+    return false;
+  return std::find(SILSkipPassNumber.begin(), SILSkipPassNumber.end(),
+                   PassNumber) != SILSkipPassNumber.end();
+}
+
+/// The total time of all passes so far, in nanoseconds, for
+/// -sil-print-cumulative-pass-time.
+static uint64_t CumulativePassTime = 0;
+
+/// Whether to add up the time of each pass in PassTimeTotals.
+static bool RecordPassTimeTotals = false;
+
+/// The time of each pass, in nanoseconds, over all pass managers.
+static std::map<std::string, uint64_t> PassTimeTotals;
+
+void SILPassManager::setRecordPassTimeTotals(bool Record) {
+  RecordPassTimeTotals = Record;
+}
+
+std::map<std::string, uint64_t> SILPassManager::takePassTimeTotals() {
+  std::map<std::string, uint64_t> Result;
+  Result.swap(PassTimeTotals);
+  return Result;
+}
+
+static void printCumulativePassTime(unsigned PassNumber, SILTransform *T,
+                                    SILFunction *F, uint64_t Nanoseconds) {
+  CumulativePassTime += Nanoseconds;
+  llvm::dbgs() << llvm::format("#%-6u %10.3f %12.3f  ", PassNumber,
+                               Nanoseconds / 1e6, CumulativePassTime / 1e6)
+               << T->getName() << " (" << (F ? F->getName() : "Module")
+               << ")\n";
+}
+
 static void printModule(SILModule *Mod, bool EmitVerboseSIL) {
   if (SILPrintOnlyFun.empty() && SILPrintOnlyFuns.empty()) {
     Mod->dump();
@@ -197,6 +272,103 @@ static void printModule(SILModule *Mod, bool EmitVerboseSIL) {
   }
 }
 
+static int64_t countInstructions(SILFunction *F) {
+  int64_t Count = 0;
+  for (auto &BB : *F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+static int64_t countInstructions(SILModule *M) {
+  int64_t Count = 0;
+  for (auto &F : *M)
+    Count += countInstructions(&F);
+  return Count;
+}
+
+/// Returns the time since \p Start in nanoseconds.
+static uint64_t getElapsedNanoseconds(llvm::sys::TimeValue Start) {
+  llvm::sys::TimeValue Elapsed = llvm::sys::TimeValue::now() - Start;
+  return uint64_t(Elapsed.seconds()) *
+           llvm::sys::TimeValue::NANOSECONDS_PER_SECOND +
+         Elapsed.nanoseconds();
+}
+
+/// Records the CFG of \p F in \p Snapshot, as each block followed by its
+/// successors and a null. Returns false if a block has no terminator.
+static bool snapshotCFG(SILFunction *F,
+                        std::vector<SILBasicBlock *> &Snapshot) {
+  Snapshot.clear();
+  for (auto &BB : *F) {
+    if (BB.empty() || !isa<TermInst>(*BB.rbegin()))
+      return false;
+    Snapshot.push_back(&BB);
+    for (auto &Succ : BB.getSuccessors())
+      Snapshot.push_back(Succ.getBB());
+    Snapshot.push_back(nullptr);
+  }
+  return true;
+}
+
+/// Prints how the functions in \p Order could be spread across threads,
+/// given that a function's callees have to be optimized before it is.
+/// Each function is weighted by its instruction count.
+static void printFunctionPassParallelism(BottomUpFunctionOrder &Order,
+                                         StringRef StageName,
+                                         unsigned NumThreads) {
+  auto SCCs = Order.getSCCs();
+  auto Levels = Order.getSCCLevels();
+
+  struct LevelInfo {
+    unsigned NumSCCs = 0;
+    int64_t Total = 0;
+    int64_t Largest = 0;
+  };
+  std::vector<LevelInfo> Infos;
+  unsigned NumFunctions = 0;
+  int64_t Total = 0;
+  for (unsigned Idx : indices(SCCs)) {
+    int64_t Weight = 0;
+    for (auto *F : SCCs[Idx]) {
+      if (!F->isDefinition() || !F->shouldOptimize())
+        continue;
+      ++NumFunctions;
+      Weight += countInstructions(F);
+    }
+    if (Levels[Idx] >= Infos.size())
+      Infos.resize(Levels[Idx] + 1);
+    LevelInfo &Info = Infos[Levels[Idx]];
+    ++Info.NumSCCs;
+    Info.Total += Weight;
+    Info.Largest = std::max(Info.Largest, Weight);
+    Total += Weight;
+  }
+
+  // An SCC has to be optimized on one thread, so each level takes at least
+  // as long as its largest SCC.
+  unsigned Widest = 0;
+  int64_t CriticalPath = 0, WithThreads = 0;
+  for (auto &Info : Infos) {
+    Widest = std::max(Widest, Info.NumSCCs);
+    CriticalPath += Info.Largest;
+    WithThreads += std::max(Info.Largest,
+                            (Info.Total + NumThreads - 1) / NumThreads);
+  }
+
+  auto speedup = [&](int64_t Time) {
+    return Time ? double(Total) / Time : 1.0;
+  };
+  llvm::dbgs() << "Function pass parallelism at stage: " << StageName << "\n"
+               << "  functions: " << NumFunctions
+               << ", levels: " << Infos.size()
+               << ", widest level: " << Widest << " SCCs\n"
+               << "  instructions: " << Total
+               << ", on the critical path: " << CriticalPath << "\n"
+               << llvm::format("  best speedup: %.2f, with %u threads: %.2f\n",
+                               speedup(CriticalPath), NumThreads,
+                               speedup(WithThreads));
+}
+
 class DebugPrintEnabler {
 #ifndef NDEBUG
   bool OldDebugFlag;
@@ -241,6 +413,41 @@ SILPassManager::SILPassManager(SILModule *M, llvm::StringRef Stage) :
   }
 }
 
+void SILPassManager::recordCFGSnapshot(SILFunction *F) {
+  if (SILDisableCFGChangeTracking || CFGSnapshots.count(F))
+    return;
+  std::vector<SILBasicBlock *> Snapshot;
+  if (snapshotCFG(F, Snapshot))
+    CFGSnapshots[F] = std::move(Snapshot);
+}
+
+SILAnalysis::InvalidationKind
+SILPassManager::removeUnchangedBranches(SILFunction *F,
+                                        SILAnalysis::InvalidationKind K) {
+  if (!(K & SILAnalysis::InvalidationKind::Branches) ||
+      SILDisableCFGChangeTracking)
+    return K;
+
+  std::vector<SILBasicBlock *> Snapshot;
+  if (!snapshotCFG(F, Snapshot)) {
+    CFGSnapshots.erase(F);
+    return K;
+  }
+
+  // The analyses were built for the same blocks and edges, so they are still
+  // correct. Passes invalidate after changing a function, so the CFG can't
+  // change again before they are next used.
+  auto It = CFGSnapshots.find(F);
+  if (It != CFGSnapshots.end() && It->second == Snapshot) {
+    ++NumBranchInvalidationsAvoided;
+    return SILAnalysis::InvalidationKind(
+        K & ~SILAnalysis::InvalidationKind::Branches);
+  }
+
+  CFGSnapshots[F] = std::move(Snapshot);
+  return K;
+}
+
 bool SILPassManager::continueTransforming() {
   return Mod->getStage() == SILStage::Raw ||
          NumPassesRun < SILNumOptPassesToRun;
@@ -301,7 +508,18 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
     return;
   }
 
+  if (isSkippedPassNumber(Mod, NumPassesRun)) {
+    if (SILPrintPassName)
+      llvm::dbgs() << "  (Skip #" << NumPassesRun << ") Stage: " << StageName
+                   << " Pass: " << SFT->getName()
+                   << ", Function: " << F->getName() << "\n";
+    // Keep the numbers of the following passes the same as without skipping.
+    ++NumPassesRun;
+    return;
+  }
+
   CurrentPassHasInvalidated = false;
+  recordCFGSnapshot(F);
 
   if (SILPrintPassName)
     llvm::dbgs() << "  #" << NumPassesRun << " Stage: " << StageName
@@ -315,11 +533,18 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
     F->dump(getOptions().EmitVerboseSIL);
   }
 
+  unsigned StartInvalidations = NumInvalidations;
+  int64_t StartInstructions = SILPassProfile ? countInstructions(F) : 0;
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   Mod->registerDeleteNotificationHandler(SFT);
   if (breakBeforeRunning(F->getName(), SFT->getName()))
     LLVM_BUILTIN_DEBUGTRAP;
-  SFT->run();
+  {
+    // Most function pass runs are very short; leave those out of the trace.
+    trace::Span span("sil-pass", SFT->getName(), F->getName(),
+                     /*MinDuration=*/100);
+    SFT->run();
+  }
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->removeDeleteNotificationHandler(SFT);
 
@@ -330,6 +555,19 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
                  << ")\n";
   }
 
+  if (SILPrintCumulativePassTime)
+    printCumulativePassTime(NumPassesRun, SFT, F,
+                            getElapsedNanoseconds(StartTime));
+
+  if (RecordPassTimeTotals)
+    PassTimeTotals[SFT->getName().str()] += getElapsedNanoseconds(StartTime);
+
+  if (SILPassProfile) {
+    recordPassProfile(SFT, F, getElapsedNanoseconds(StartTime),
+                      NumInvalidations - StartInvalidations,
+                      countInstructions(F) - StartInstructions);
+  }
+
   // If this pass invalidated anything, print and verify.
   if (doPrintAfter(SFT, F, CurrentPassHasInvalidated && SILPrintAll)) {
     llvm::dbgs() << "*** SIL function after " << StageName << " "
@@ -360,6 +598,10 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
   BottomUpFunctionOrder BottomUpOrder(*Mod, BCA);
   auto BottomUpFunctions = BottomUpOrder.getFunctions();
 
+  if (SILPrintFunctionPassParallelism)
+    printFunctionPassParallelism(BottomUpOrder, StageName,
+                                 std::max(getOptions().NumThreads, 1));
+
   assert(FunctionWorklist.empty() && "Expected empty function worklist!");
 
   FunctionWorklist.reserve(BottomUpFunctions.size());
@@ -418,6 +660,13 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   if (isDisabled(SMT))
     return;
 
+  if (isSkippedPassNumber(Mod, NumPassesRun)) {
+    if (SILPrintPassName)
+      llvm::dbgs() << "(Skip #" << NumPassesRun << ") Stage: " << StageName
+                   << " Pass: " << SMT->getName() << " (module pass)\n";
+    return;
+  }
+
   const SILOptions &Options = getOptions();
 
   PrettyStackTraceSILModuleTransform X(SMT, NumPassesRun);
@@ -439,10 +688,15 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
+  unsigned StartInvalidations = NumInvalidations;
+  int64_t StartInstructions = SILPassProfile ? countInstructions(Mod) : 0;
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
-  SMT->run();
+  {
+    trace::Span span("sil-pass", SMT->getName());
+    SMT->run();
+  }
   Mod->removeDeleteNotificationHandler(SMT);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
 
@@ -452,6 +706,19 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
   }
 
+  if (SILPrintCumulativePassTime)
+    printCumulativePassTime(NumPassesRun, SMT, nullptr,
+                            getElapsedNanoseconds(StartTime));
+
+  if (RecordPassTimeTotals)
+    PassTimeTotals[SMT->getName().str()] += getElapsedNanoseconds(StartTime);
+
+  if (SILPassProfile) {
+    recordPassProfile(SMT, nullptr, getElapsedNanoseconds(StartTime),
+                      NumInvalidations - StartInvalidations,
+                      countInstructions(Mod) - StartInstructions);
+  }
+
   // If this pass invalidated anything, print and verify.
   if (doPrintAfter(SMT, nullptr,
                    CurrentPassHasInvalidated && SILPrintAll)) {
@@ -539,8 +806,76 @@ void SILPassManager::run() {
   runOneIteration();
 }
 
+void SILPassManager::recordPassProfile(SILTransform *T, SILFunction *F,
+                                       uint64_t Nanoseconds,
+                                       unsigned NumInvalidations,
+                                       int64_t InstructionDelta) {
+  auto Key = std::make_pair(T->getName().str(),
+                            F ? F->getName().str() : "<module>");
+  PassProfile &Profile = PassProfiles[Key];
+  ++Profile.NumRuns;
+  Profile.Nanoseconds += Nanoseconds;
+  Profile.NumInvalidations += NumInvalidations;
+  Profile.InstructionDelta += InstructionDelta;
+}
+
+void SILPassManager::printPassProfile(llvm::raw_ostream &OS) const {
+  using Entry = std::pair<std::pair<std::string, std::string>, PassProfile>;
+
+  auto printHeader = [&](StringRef Title) {
+    OS << "===" << std::string(73, '-') << "===\n"
+       << "  " << Title << "\n"
+       << "===" << std::string(73, '-') << "===\n";
+    OS << llvm::format("%10s %8s %8s %10s  %s\n",
+                       "ms", "runs", "invals", "inst delta", "pass");
+  };
+  auto printEntry = [&](const Entry &E) {
+    OS << llvm::format("%10.3f %8u %8u %10lld  ", E.second.Nanoseconds / 1e6,
+                       E.second.NumRuns, E.second.NumInvalidations,
+                       (long long)E.second.InstructionDelta)
+       << E.first.first;
+    if (!E.first.second.empty())
+      OS << "  " << E.first.second;
+    OS << "\n";
+  };
+  auto byTime = [](const Entry &LHS, const Entry &RHS) {
+    return LHS.second.Nanoseconds > RHS.second.Nanoseconds;
+  };
+
+  // Add up each pass over all the functions it ran on.
+  std::map<std::string, PassProfile> PassTotals;
+  for (auto &P : PassProfiles) {
+    PassProfile &Total = PassTotals[P.first.first];
+    Total.NumRuns += P.second.NumRuns;
+    Total.Nanoseconds += P.second.Nanoseconds;
+    Total.NumInvalidations += P.second.NumInvalidations;
+    Total.InstructionDelta += P.second.InstructionDelta;
+  }
+  std::vector<Entry> Passes;
+  for (auto &P : PassTotals)
+    Passes.push_back({ { P.first, std::string() }, P.second });
+  std::stable_sort(Passes.begin(), Passes.end(), byTime);
+
+  printHeader("SIL pass profile");
+  for (auto &E : Passes)
+    printEntry(E);
+
+  std::vector<Entry> Pairs(PassProfiles.begin(), PassProfiles.end());
+  std::stable_sort(Pairs.begin(), Pairs.end(), byTime);
+  if (Pairs.size() > SILPassProfileEntries)
+    Pairs.resize(SILPassProfileEntries);
+
+  OS << "\n";
+  printHeader("SIL pass profile by function");
+  for (auto &E : Pairs)
+    printEntry(E);
+}
+
 /// D'tor.
 SILPassManager::~SILPassManager() {
+  if (SILPassProfile && !PassProfiles.empty())
+    printPassProfile(llvm::dbgs());
+
   // Free all transformations.
   for (auto *T : Transformations)
     delete T;
@@ -194,7 +194,10 @@ void AddSSAPasses(SILPassManager &PM, OptimizationLevelKind OpLevel) {
 
   // Run the devirtualizer, specializer, and inliner. If any of these
   // makes a change we'll end up restarting the function passes on the
-  // current function (after optimizing any new callees).
+  // current function (after optimizing any new callees). Existential
+  // arguments of known type are turned into generic arguments first, so that
+  // the specializer can specialize the callee for the concrete type.
+  PM.addExistentialSpecializer();
   PM.addDevirtualizer();
   PM.addGenericSpecializer();
 
@@ -286,6 +289,7 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.setStageName("HighLevel+EarlyLoopOpt");
   // FIXME: update this to be a function pass.
   PM.addEagerSpecializer();
+  PM.addRequestedSpecializer();
   AddSSAPasses(PM, OptimizationLevelKind::HighLevel);
   AddHighLevelLoopOptPasses(PM);
   PM.runOneIteration();
@@ -395,7 +399,19 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
-  
+
+  // Share the bodies of specializations for different classes.
+  if (Module.getOptions().MergeSpecializations)
+    PM.addSpecializationMerger();
+
+  // Trade some speed for code size by sharing copies and destroys of large
+  // values. This must run after the last ARC optimization.
+  if (Module.getOptions().OutlineValueOperations)
+    PM.addValueOperationOutliner();
+
+  // Summarize the side-effects of public functions for clients of the module.
+  PM.addEffectsSummaryRecorder();
+
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
 
@@ -432,6 +448,12 @@ void swift::runSILPassesForOnone(SILModule &Module) {
   // eventually remove unused declarations.
   PM.addExternalDefsToDecls();
 
+  // Remove the copies SILGen makes when it passes an aggregate through a
+  // chain of temporaries. This keeps the storage of all variables, so it
+  // doesn't affect debugging.
+  if (Module.getOptions().OnoneCopyForwarding)
+    PM.addTemporaryCopyForwarding();
+
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
 
@@ -49,7 +49,10 @@
 // TODO: Currently we only handle the address-only case, not the retain/release
 // case.
 //
-// TODO: We should run this at -Onone even though it's not diagnostic.
+// At -Onone, the TemporaryCopyForwarding variant of this pass only removes
+// copies between the temporaries SILGen creates for intermediate values. It
+// never touches the storage of a variable, so the debugger still sees every
+// variable where it expects it.
 //
 // TODO: Currently we only handle cases in which one side of the copy is block
 // local. Either:
@@ -113,6 +116,19 @@ static bool isIdentifiedSourceValue(SILValue Def) {
   return false;
 }
 
+/// \return true if \p Def is a stack location which SILGen created for an
+/// intermediate value, rather than the storage of a variable or argument.
+static bool isUnnamedTemporary(SILValue Def) {
+  auto *ASI = dyn_cast<AllocStackInst>(Def);
+  if (!ASI || ASI->getDecl() || !ASI->getVarInfo().Name.empty())
+    return false;
+  for (auto *Use : ASI->getUses()) {
+    if (isa<DebugValueAddrInst>(Use->getUser()))
+      return false;
+  }
+  return true;
+}
+
 /// \return true if the given copy dest value can only be accessed via the given
 /// def (this def uniquely identifies the object).
 ///
@@ -369,6 +385,8 @@ class CopyForwarding {
   // Per-function state.
   PostOrderAnalysis *PostOrder;
   DominanceAnalysis *DomAnalysis;
+  // Only forward copies into unnamed temporaries, and don't split edges.
+  bool OnlyTemporaries;
   bool DoGlobalHoisting;
   bool HasChanged;
   bool HasChangedCFG;
@@ -388,8 +406,10 @@ class CopyForwarding {
   SmallVector<DestroyAddrInst*, 4> DestroyPoints;
   SmallPtrSet<SILBasicBlock*, 32> DeadInBlocks;
 public:
-  CopyForwarding(PostOrderAnalysis *PO, DominanceAnalysis *DA)
-      : PostOrder(PO), DomAnalysis(DA), DoGlobalHoisting(false),
+  CopyForwarding(PostOrderAnalysis *PO, DominanceAnalysis *DA,
+                 bool OnlyTemporaries)
+      : PostOrder(PO), DomAnalysis(DA), OnlyTemporaries(OnlyTemporaries),
+        DoGlobalHoisting(false),
         HasChanged(false), HasChangedCFG(false), IsLoadedFrom(false),
         HasForwardedToCopy(false) {}
 
@@ -400,7 +420,7 @@ public:
     // some alloc_stack cases after global destroy hoisting. CopyForwarding will
     // be reapplied after the transparent function is inlined at which point
     // global hoisting will be done.
-    DoGlobalHoisting = !F->isTransparent();
+    DoGlobalHoisting = !F->isTransparent() && !OnlyTemporaries;
     if (HasChangedCFG) {
       // We are only invalidating the analysis that we use internally.
       // We'll invalidate the analysis that are used by other passes at the end.
@@ -537,7 +557,11 @@ bool CopyForwarding::propagateCopy(CopyAddrInst *CopyInst) {
   }
   // Note that DestUserInsts is likely empty when the dest is an 'out' argument,
   // allowing us to go straight to backward propagation.
-  if (forwardPropagateCopy(CopyInst, DestUserInsts)) {
+  //
+  // Forward propagation replaces the dest, so it must not be a variable if we
+  // preserve debug info.
+  if ((!OnlyTemporaries || isUnnamedTemporary(CopyDest)) &&
+      forwardPropagateCopy(CopyInst, DestUserInsts)) {
     DEBUG(llvm::dbgs() << "  Forwarding Copy:" << *CopyInst);
     if (!CopyInst->isInitializationOfDest()) {
       // Replace the original copy with a destroy. We may be able to hoist it
@@ -844,7 +868,10 @@ bool CopyForwarding::backwardPropagateCopy(
     // is initialized, so we really need the copy.
     if (UserInst == CopyDestRoot || DestUserInsts.count(UserInst)
         || RootUserInsts.count(UserInst)) {
-      if (auto *DVAI = dyn_cast<DebugValueAddrInst>(UserInst)) {
+      // Unless we preserve debug info, a debug_value_addr of the dest doesn't
+      // need the copy.
+      auto *DVAI = dyn_cast<DebugValueAddrInst>(UserInst);
+      if (DVAI && !OnlyTemporaries) {
         DebugValueInstsToDelete.push_back(DVAI);
         continue;
       }
@@ -1147,6 +1174,10 @@ static llvm::cl::opt<int> ForwardStop("copy-forward-stop",
 
 class CopyForwardingPass : public SILFunctionTransform
 {
+  /// True if only copies of unnamed temporaries are removed, which keeps the
+  /// debug info of unoptimized code intact.
+  bool OnlyTemporaries;
+
   void run() override {
     if (!EnableCopyForwarding && !EnableDestroyHoisting)
       return;
@@ -1162,11 +1193,13 @@ class CopyForwardingPass : public SILFunctionTransform
     for (auto &BB : *getFunction())
       for (auto II = BB.begin(), IE = BB.end(); II != IE; ++II) {
         if (auto *CopyInst = dyn_cast<CopyAddrInst>(&*II)) {
+          SILValue Def = CopyInst->getSrc();
+          if (OnlyTemporaries && !isUnnamedTemporary(Def))
+            continue;
           if (EnableDestroyHoisting && canNRVO(CopyInst)) {
             NRVOCopies.push_back(CopyInst);
             continue;
           }
-          SILValue Def = CopyInst->getSrc();
           if (isIdentifiedSourceValue(Def))
             CopiedDefs.insert(Def);
           else {
@@ -1188,7 +1221,7 @@ class CopyForwardingPass : public SILFunctionTransform
 
     auto *PO = getAnalysis<PostOrderAnalysis>();
     auto *DA = getAnalysis<DominanceAnalysis>();
-    auto Forwarding = CopyForwarding(PO, DA);
+    auto Forwarding = CopyForwarding(PO, DA, OnlyTemporaries);
 
     for (SILValue Def : CopiedDefs) {
 #ifndef NDEBUG
@@ -1210,10 +1243,20 @@ class CopyForwardingPass : public SILFunctionTransform
       }
   }
 
-  StringRef getName() override { return "Copy Forwarding"; }
+  StringRef getName() override {
+    return OnlyTemporaries ? "Temporary Copy Forwarding" : "Copy Forwarding";
+  }
+
+public:
+  CopyForwardingPass(bool OnlyTemporaries)
+    : OnlyTemporaries(OnlyTemporaries) {}
 };
 } // anonymous
 
 SILTransform *swift::createCopyForwarding() {
-  return new CopyForwardingPass();
+  return new CopyForwardingPass(false);
+}
+
+SILTransform *swift::createTemporaryCopyForwarding() {
+  return new CopyForwardingPass(true);
 }
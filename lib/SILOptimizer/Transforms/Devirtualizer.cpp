@@ -17,6 +17,7 @@
 
 #define DEBUG_TYPE "sil-devirtualizer"
 
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
@@ -49,6 +50,30 @@ class Devirtualizer : public SILFunctionTransform {
 
 } // end anonymous namespace
 
+/// Records a remark that the dynamically dispatched call \p Apply could not
+/// be devirtualized.
+static void remarkNotDevirtualized(FullApplySite Apply) {
+  SILValue Callee = Apply.getCallee();
+  StringRef Kind;
+  SILDeclRef Member;
+  if (auto *CMI = dyn_cast<ClassMethodInst>(Callee)) {
+    Kind = "class_method";
+    Member = CMI->getMember();
+  } else if (auto *WMI = dyn_cast<WitnessMethodInst>(Callee)) {
+    Kind = "witness_method";
+    Member = WMI->getMember();
+  } else {
+    return;
+  }
+
+  SILInstruction *AI = Apply.getInstruction();
+  OptRemark::emit(AI->getModule(),
+                  OptRemark::RemarkMissed(DEBUG_TYPE, "NotDevirtualized", *AI)
+                    << OptRemark::Argument("Kind", Kind)
+                    << OptRemark::Argument("Method",
+                                           Member.getDecl()->getNameStr()));
+}
+
 bool Devirtualizer::devirtualizeAppliesInFunction(SILFunction &F,
                                                   ClassHierarchyAnalysis *CHA) {
   bool Changed = false;
@@ -66,8 +91,11 @@ bool Devirtualizer::devirtualizeAppliesInFunction(SILFunction &F,
         continue;
 
       auto NewInstPair = tryDevirtualizeApply(Apply, CHA);
-      if (!NewInstPair.second)
+      if (!NewInstPair.second) {
+        if (OptRemark::isEnabled(F.getModule()))
+          remarkNotDevirtualized(Apply);
         continue;
+      }
 
       Changed = true;
 
@@ -104,7 +132,10 @@ bool Devirtualizer::devirtualizeAppliesInFunction(SILFunction &F,
     // everything we reference from the stdlib. After we do that we
     // can move the notification code below back into the main loop
     // above.
-    if (!CalleeFn->isDefinition())
+    //
+    // With on-demand linking, the inliner and generic specializer link the
+    // callee if they need its body.
+    if (!CalleeFn->isDefinition() && !F.getModule().getOptions().LinkOnDemand)
       F.getModule().linkFunction(CalleeFn, SILModule::LinkingMode::LinkAll);
 
     // We may not have optimized these functions yet, and it could
@@ -54,6 +54,7 @@ STATISTIC(NumDeadArgsEliminated, "Total dead args eliminated");
 STATISTIC(NumOwnedConvertedToGuaranteed, "Total owned args -> guaranteed args");
 STATISTIC(NumOwnedConvertedToNotOwnedResult, "Total owned result -> not owned result");
 STATISTIC(NumSROAArguments, "Total SROA arguments optimized");
+STATISTIC(NumIndirectConvertedToDirect, "Total indirect args -> direct args");
 
 using SILParameterInfoList = llvm::SmallVector<SILParameterInfo, 8>;
 using ArgumentIndexMap = llvm::SmallDenseMap<int, int>;
@@ -184,6 +185,15 @@ private:
   /// Add the release for converted arguments and result.
   void OwnedToGuaranteedFinalizeThunkFunction(SILBuilder &B, SILFunction *F);
 
+  /// ----------------------------------------------------------///
+  /// Indirect to direct transformation.                        ///
+  /// ----------------------------------------------------------///
+  /// Find small loadable arguments which are passed indirectly.
+  bool IndirectToDirectAnalyzeParameters();
+  /// Store the direct arguments to stack locations, which replace the uses of
+  /// the original address arguments.
+  void IndirectToDirectFinalizeOptimizedFunction();
+
   /// ----------------------------------------------------------///
   /// Argument explosion transformation.                        ///
   /// ----------------------------------------------------------///
@@ -204,6 +214,13 @@ private:
       return;
     }
 
+    // Load the value from the address argument.
+    if (AD.IndirectToDirect) {
+      NewArgs.push_back(Builder.createLoad(BB->getParent()->getLocation(),
+                                           BB->getBBArg(AD.Index)));
+      return;
+    }
+
     // Explode the argument.
     if (AD.Explode) {
       llvm::SmallVector<SILValue, 4> LeafValues;
@@ -265,6 +282,14 @@ public:
       DeadArgumentTransformFunction();
     }
 
+    // Run IndirectToDirect transformation. Like for dead arguments, we only
+    // specialize if this function has a caller inside the current module or
+    // we have already created a thunk.
+    if ((hasCaller || Changed) && IndirectToDirectAnalyzeParameters()) {
+      Changed = true;
+      DEBUG(llvm::dbgs() << "  pass indirect arguments directly\n");
+    }
+
     // Run ArgumentExplosion transformation. We only specialize
     // if this function has a caller inside the current module or we have
     // already created a thunk.
@@ -347,6 +372,10 @@ std::string FunctionSignatureTransform::createOptimizedSILFunctionName() {
     if (Arg.Explode) {
       FM.setArgumentSROA(i);
     }   
+
+    if (Arg.IndirectToDirect) {
+      FM.setArgumentIndirectToDirect(i);
+    }
   }
 
   // Handle return value's change.
@@ -364,6 +393,17 @@ std::string FunctionSignatureTransform::createOptimizedSILFunctionName() {
 void
 FunctionSignatureTransform::
 computeOptimizedArgInterface(ArgumentDescriptor &AD, SILParameterInfoList &Out) {
+  // An @in argument becomes @owned, an @in_guaranteed argument @guaranteed.
+  if (AD.IndirectToDirect) {
+    ++NumIndirectConvertedToDirect;
+    auto Convention =
+        AD.hasConvention(SILArgumentConvention::Indirect_In_Guaranteed)
+            ? ParameterConvention::Direct_Guaranteed
+            : ParameterConvention::Direct_Owned;
+    Out.push_back(SILParameterInfo(AD.PInfo.getType(), Convention));
+    return;
+  }
+
   // If this argument is live, but we cannot optimize it.
   if (!AD.canOptimizeLiveArg()) {
     Out.push_back(AD.PInfo);
@@ -487,6 +527,9 @@ void FunctionSignatureTransform::createFunctionSignatureOptimizedFunction() {
   }
 
   // Do the last bit of work to the newly created optimized function.
+  // IndirectToDirect goes first, as it relies on the original argument
+  // indices.
+  IndirectToDirectFinalizeOptimizedFunction();
   ArgumentExplosionFinalizeOptimizedFunction();
   DeadArgumentFinalizeOptimizedFunction();
 
@@ -773,6 +816,72 @@ OwnedToGuaranteedAddResultRelease(ResultDescriptor &RD, SILBuilder &Builder,
   }
 }
 
+/// ----------------------------------------------------------///
+/// Indirect to direct transformation.                        ///
+/// ----------------------------------------------------------///
+bool FunctionSignatureTransform::IndirectToDirectAnalyzeParameters() {
+  // Reabstraction thunks take concrete values indirectly because of the
+  // abstraction level they are called at. Other functions usually have an
+  // indirect argument because the callee itself needs it in memory.
+  if (F->isThunk() != IsReabstractionThunk)
+    return false;
+
+  // Did we decide we should optimize any parameter?
+  bool SignatureOptimize = false;
+  ArrayRef<SILArgument *> Args = F->begin()->getBBArgs();
+
+  for (unsigned i = 0, e = Args.size(); i != e; ++i) {
+    ArgumentDescriptor &A = ArgumentDescList[i];
+    A.IndirectToDirect = A.shouldConvertIndirectToDirect();
+
+    // Modified self argument.
+    if (A.IndirectToDirect && Args[i]->isSelf()) {
+      shouldModifySelfArgument = true;
+    }
+
+    SignatureOptimize |= A.IndirectToDirect;
+  }
+  return SignatureOptimize;
+}
+
+void FunctionSignatureTransform::IndirectToDirectFinalizeOptimizedFunction() {
+  SILBasicBlock *BB = &*NewF->begin();
+  SILBuilder Builder(BB->begin());
+  Builder.setCurrentDebugScope(BB->getParent()->getDebugScope());
+  SILLocation Loc = BB->getParent()->getLocation();
+  llvm::SmallVector<AllocStackInst *, 4> Stacks;
+
+  for (ArgumentDescriptor &AD : ArgumentDescList) {
+    if (!AD.IndirectToDirect)
+      continue;
+
+    // Take the value as a new argument and store it to a stack location,
+    // which is what the body uses in place of the address. The stack location
+    // takes over the ownership of the original argument, i.e. an @in value is
+    // destroyed by the body and an @in_guaranteed value is not.
+    SILArgument *OrigArg = BB->getBBArg(AD.Index);
+    SILType ValueTy = OrigArg->getType().getObjectType();
+    SILArgument *NewArg =
+        BB->insertBBArg(AD.Index, ValueTy, OrigArg->getDecl());
+    auto *Stack = Builder.createAllocStack(Loc, ValueTy);
+    Builder.createStore(Loc, NewArg, Stack);
+    OrigArg->replaceAllUsesWith(Stack);
+    BB->eraseBBArg(AD.Index + 1);
+    Stacks.push_back(Stack);
+  }
+
+  // Deallocate the stack locations in reverse order at the function exits.
+  for (SILBasicBlock &ExitBB : *NewF) {
+    TermInst *Term = ExitBB.getTerminator();
+    if (!Term->isFunctionExiting())
+      continue;
+    SILBuilder ExitBuilder(Term);
+    ExitBuilder.setCurrentDebugScope(Term->getDebugScope());
+    for (AllocStackInst *Stack : reverse(Stacks))
+      ExitBuilder.createDeallocStack(Loc, Stack);
+  }
+}
+
 /// ----------------------------------------------------------///
 /// Argument Explosion transformation.                        ///
 /// ----------------------------------------------------------///
@@ -17,6 +17,7 @@
 
 #define DEBUG_TYPE "sil-generic-specializer"
 
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
@@ -53,6 +54,9 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
 
   bool Changed = false;
   for (auto &BB : F) {
+    // Applies of functions from other modules whose bodies are not available.
+    llvm::SmallVector<ApplySite, 4> ExternalApplies;
+
     // Collect the applies for this block in reverse order so that we
     // can pop them off the end of our vector and process them in
     // forward order.
@@ -68,8 +72,19 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
         continue;
 
       auto *Callee = Apply.getReferencedFunction();
-      if (!Callee || !Callee->isDefinition())
+      if (!Callee)
+        continue;
+
+      // With on-demand linking, generic callees are deserialized once there
+      // is a call to specialize.
+      if (Callee->isExternalDeclaration() &&
+          F.getModule().getOptions().LinkOnDemand)
+        F.getModule().linkFunctionOnDemand(Callee);
+
+      if (!Callee->isDefinition()) {
+        ExternalApplies.push_back(Apply);
         continue;
+      }
 
       Applies.insert(Apply.getInstruction());
     }
@@ -111,6 +126,29 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
         notifyPassManagerOfFunction(NewF, Callee);
       }
     }
+
+    // Call the specializations exported by the module defining the callee,
+    // if there are any.
+    for (ApplySite Apply : ExternalApplies) {
+      SILFunction *Callee = Apply.getReferencedFunction();
+      ReabstractionInfo ReInfo(Callee, Apply.getSubstitutions());
+      if (SILFunction *NewF = lookupOrRequestExportedSpecialization(
+              Callee, Apply.getSubstitutions(), ReInfo)) {
+        auto NewAI = replaceWithSpecializedFunction(Apply, NewF, ReInfo);
+        Apply.getInstruction()->replaceAllUsesWith(NewAI.getInstruction());
+        recursivelyDeleteTriviallyDeadInstructions(Apply.getInstruction(),
+                                                   true);
+        Changed = true;
+        continue;
+      }
+
+      if (OptRemark::isEnabled(F.getModule()))
+        OptRemark::emit(F.getModule(),
+                        OptRemark::RemarkMissed(DEBUG_TYPE, "NotSpecialized",
+                                                *Apply.getInstruction())
+                          << OptRemark::Argument("Callee", Callee)
+                          << OptRemark::Argument("Reason", "no body"));
+    }
   }
 
   return Changed;
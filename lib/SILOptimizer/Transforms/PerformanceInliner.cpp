@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-inliner"
+#include "swift/SIL/OptimizationRemark.h"
+#include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/PerformanceInlinerUtils.h"
@@ -49,6 +51,7 @@ class SILPerformanceInliner {
 
   DominanceAnalysis *DA;
   SILLoopAnalysis *LA;
+  EscapeAnalysis *EA;
 
   // For keys of SILFunction and SILLoop.
   llvm::DenseMap<SILFunction *, ShortestPathAnalysis *> SPAs;
@@ -86,6 +89,11 @@ class SILPerformanceInliner {
     /// The benefit of a onFastPath builtin.
     FastPathBuiltinBenefit = RemovedCallBenefit + 40,
 
+    /// The benefit if an object allocated in the callee can (probably) be
+    /// promoted to the stack after inlining, because it only escapes the
+    /// callee through the return value.
+    StackPromotionBenefit = RemovedCallBenefit + 30,
+
     /// Approximately up to this cost level a function can be inlined without
     /// increasing the code size.
     TrivialFunctionThreshold = 18,
@@ -93,6 +101,12 @@ class SILPerformanceInliner {
     /// Configuration for the caller block limit.
     BlockLimitDenominator = 10000,
 
+    /// With on-demand linking, callees with more instructions than this are
+    /// not deserialized. Every instruction costs at most 1, so this is about
+    /// the largest callee whose benefit outweighs its cost outside of deeply
+    /// nested loops.
+    OnDemandLinkSizeLimit = 400,
+
     /// The assumed execution length of a function call.
     DefaultApplyLength = 10
   };
@@ -117,6 +131,10 @@ class SILPerformanceInliner {
 
   SILFunction *getEligibleFunction(FullApplySite AI);
 
+  bool isNonEscapingResult(SILInstruction *Call);
+
+  bool escapesOnlyViaReturn(AllocRefInst *ARI);
+
   bool isProfitableToInlineNonGeneric(FullApplySite AI,
                             Weight CallerWeight,
                             ConstantTracker &constTracker,
@@ -132,8 +150,8 @@ class SILPerformanceInliner {
 
 public:
   SILPerformanceInliner(InlineSelection WhatToInline, DominanceAnalysis *DA,
-                        SILLoopAnalysis *LA)
-      : WhatToInline(WhatToInline), DA(DA), LA(LA), CBI(DA) {}
+                        SILLoopAnalysis *LA, EscapeAnalysis *EA)
+      : WhatToInline(WhatToInline), DA(DA), LA(LA), EA(EA), CBI(DA) {}
 
   bool inlineCallsIntoFunction(SILFunction *F);
 };
@@ -177,6 +195,16 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
     }
   }
 
+  // With on-demand linking, the callee's body was not deserialized up front.
+  // Link it now, unless its serialized size says it is too large to inline.
+  if (Callee->isExternalDeclaration() &&
+      Callee->getInlineStrategy() != NoInline &&
+      Callee->getModule().getOptions().LinkOnDemand) {
+    unsigned SizeLimit = Callee->getInlineStrategy() == AlwaysInline ?
+      UINT_MAX : OnDemandLinkSizeLimit;
+    Callee->getModule().linkFunctionOnDemand(Callee, SizeLimit);
+  }
+
   // We can't inline external declarations.
   if (Callee->empty() || Callee->isExternalDeclaration()) {
     return nullptr;
@@ -239,6 +267,28 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
   return Callee;
 }
 
+/// Returns true if the result of the apply \p Call is an object which does not
+/// escape the caller.
+bool SILPerformanceInliner::isNonEscapingResult(SILInstruction *Call) {
+  // The result of a try_apply is a block argument. Don't bother with it.
+  if (!isa<ApplyInst>(Call))
+    return false;
+  auto *ConGraph = EA->getConnectionGraph(Call->getFunction());
+  auto *Node = ConGraph->getNodeOrNull(Call, EA);
+  return Node && !Node->escapes();
+}
+
+/// Returns true if \p ARI is a stack promotable allocation except that it
+/// escapes its function through the return value.
+bool SILPerformanceInliner::escapesOnlyViaReturn(AllocRefInst *ARI) {
+  if (ARI->isObjC() || ARI->canAllocOnStack())
+    return false;
+  auto *ConGraph = EA->getConnectionGraph(ARI->getFunction());
+  auto *Node = ConGraph->getNodeOrNull(ARI, EA);
+  return Node &&
+         Node->getEscapeState() == EscapeAnalysis::EscapeState::Return;
+}
+
 /// Return true if inlining this call site is profitable.
 bool SILPerformanceInliner::isProfitableToInlineNonGeneric(FullApplySite AI,
                                               Weight CallerWeight,
@@ -276,6 +326,10 @@ bool SILPerformanceInliner::isProfitableToInlineNonGeneric(FullApplySite AI,
 
   CallerWeight.updateBenefit(Benefit, BaseBenefit);
 
+  // Only computed if the callee allocates an object.
+  SILInstruction *Call = AI.getInstruction();
+  Optional<bool> ResultDoesNotEscape;
+
   // Go through all blocks of the function, accumulate the cost and find
   // benefits.
   while (SILBasicBlock *block = domOrder.getNext()) {
@@ -315,6 +369,15 @@ bool SILPerformanceInliner::isProfitableToInlineNonGeneric(FullApplySite AI,
       } else if (auto *BI = dyn_cast<BuiltinInst>(&I)) {
         if (BI->getBuiltinInfo().ID == BuiltinValueKind::OnFastPath)
           BlockW.updateBenefit(Benefit, FastPathBuiltinBenefit);
+      } else if (auto *ARI = dyn_cast<AllocRefInst>(&I)) {
+        // Check if the callee returns a new object which does not escape the
+        // caller. After inlining, the object can be allocated on the stack.
+        if (escapesOnlyViaReturn(ARI)) {
+          if (!ResultDoesNotEscape.hasValue())
+            ResultDoesNotEscape = isNonEscapingResult(Call);
+          if (ResultDoesNotEscape.getValue())
+            BlockW.updateBenefit(Benefit, StackPromotionBenefit);
+        }
       }
     }
     // Don't count costs in blocks which are dead after inlining.
@@ -354,6 +417,13 @@ bool SILPerformanceInliner::isProfitableToInlineNonGeneric(FullApplySite AI,
 
   // This is the final inlining decision.
   if (CalleeCost > Benefit) {
+    if (OptRemark::isEnabled(Callee->getModule()))
+      OptRemark::emit(Callee->getModule(),
+                      OptRemark::RemarkMissed(DEBUG_TYPE, "TooCostly",
+                                              *AI.getInstruction())
+                        << OptRemark::Argument("Callee", Callee)
+                        << OptRemark::Argument("Cost", CalleeCost)
+                        << OptRemark::Argument("Benefit", Benefit));
     return false;
   }
 
@@ -620,12 +690,13 @@ public:
   void run() override {
     DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
     SILLoopAnalysis *LA = PM->getAnalysis<SILLoopAnalysis>();
+    EscapeAnalysis *EA = PM->getAnalysis<EscapeAnalysis>();
 
     if (getOptions().InlineThreshold == 0) {
       return;
     }
 
-    SILPerformanceInliner Inliner(WhatToInline, DA, LA);
+    SILPerformanceInliner Inliner(WhatToInline, DA, LA, EA);
 
     assert(getFunction()->isDefinition() &&
            "Expected only functions with bodies!");
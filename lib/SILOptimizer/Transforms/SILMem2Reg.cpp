@@ -56,6 +56,7 @@ typedef llvm::DenseMap<DomTreeNode *, unsigned> DomTreeLevelMap;
 class StackAllocationPromoter {
   typedef llvm::DenseSet<SILBasicBlock *> BlockSet;
   typedef llvm::DenseMap<SILBasicBlock *, SILInstruction *> BlockToInstMap;
+  typedef llvm::DenseMap<SILBasicBlock *, SILValue> BlockToValueMap;
 
   // Use a priority queue keyed on dominator tree level so that inserted nodes
   // are handled from the bottom of the dom tree upwards.
@@ -82,6 +83,10 @@ class StackAllocationPromoter {
   /// Records the last store instruction in each block for a specific
   /// AllocStackInst.
   BlockToInstMap LastStoreInBlock;
+
+  /// The value flowing out of each block that getLiveOutValue has walked
+  /// through, so that each idom chain is only walked once.
+  BlockToValueMap LiveOutValues;
 public:
   /// C'tor.
   StackAllocationPromoter(AllocStackInst *Asi, DominanceInfo *Di,
@@ -521,16 +526,31 @@ SILValue
 StackAllocationPromoter::getLiveOutValue(BlockSet &PhiBlocks,
                                          SILBasicBlock *StartBB) {
   DEBUG(llvm::dbgs() << "*** Searching for a value definition.\n");
+
+  // The blocks walked through before finding the definition. The same value
+  // flows out of all of them.
+  SmallVector<SILBasicBlock *, 16> Walked;
+  auto found = [&](SILValue Def) -> SILValue {
+    for (SILBasicBlock *BB : Walked)
+      LiveOutValues[BB] = Def;
+    return Def;
+  };
+
   // Walk the Dom tree in search of a defining value:
   for (DomTreeNode *Node = DT->getNode(StartBB); Node; Node = Node->getIDom()) {
     SILBasicBlock *BB = Node->getBlock();
 
+    // If we already walked up from this block, reuse its definition.
+    BlockToValueMap::iterator cached = LiveOutValues.find(BB);
+    if (cached != LiveOutValues.end())
+      return found(cached->second);
+
     // If there is a store (that must come after the phi), use its value.
     BlockToInstMap::iterator it = LastStoreInBlock.find(BB);
     if (it != LastStoreInBlock.end())
       if (StoreInst *St = dyn_cast_or_null<StoreInst>(it->second)) {
         DEBUG(llvm::dbgs() << "*** Found Store def " << *St->getSrc());
-        return St->getSrc();
+        return found(St->getSrc());
       }
 
     // If there is a Phi definition in this block:
@@ -539,14 +559,15 @@ StackAllocationPromoter::getLiveOutValue(BlockSet &PhiBlocks,
       // add to the basic block.
       SILValue Phi = BB->getBBArg(BB->getNumBBArg()-1);
       DEBUG(llvm::dbgs() << "*** Found a dummy Phi def " << *Phi);
-      return Phi;
+      return found(Phi);
     }
 
     // Move to the next dominating block.
     DEBUG(llvm::dbgs() << "*** Walking up the iDOM.\n");
+    Walked.push_back(BB);
   }
   DEBUG(llvm::dbgs() << "*** Could not find a Def. Using Undef.\n");
-  return SILUndef::get(ASI->getElementType(), ASI->getModule());
+  return found(SILUndef::get(ASI->getElementType(), ASI->getModule()));
 }
 
 SILValue
@@ -664,6 +685,7 @@ void StackAllocationPromoter::pruneAllocStackUsage() {
 
   // Clear AllocStack state.
   LastStoreInBlock.clear();
+  LiveOutValues.clear();
 
   for (auto Block : Blocks) {
     StoreInst *SI = promoteAllocationInBlock(Block);
@@ -676,7 +698,6 @@ void StackAllocationPromoter::pruneAllocStackUsage() {
 /// Compute the dominator tree levels for DT.
 static void computeDomTreeLevels(DominanceInfo *DT,
                                  DomTreeLevelMap &DomTreeLevels) {
-  // TODO: This should happen once per function.
   SmallVector<DomTreeNode *, 32> Worklist;
   DomTreeNode *Root = DT->getRootNode();
   DomTreeLevels[Root] = 0;
@@ -703,13 +724,16 @@ void StackAllocationPromoter::promoteAllocationToPhi() {
 
   // Collect all of the stores into the AllocStack. We know that at this point
   // we have at most one store per block.
+  BlockSet DefBlocks;
   for (auto UI = ASI->use_begin(), E = ASI->use_end(); UI != E; ++UI) {
     SILInstruction *II = UI->getUser();
     // We need to place Phis for this block.
     if (isa<StoreInst>(II)) {
       // If the block is in the dom tree (dominated by the entry block).
-      if (DomTreeNode *Node = DT->getNode(II->getParent()))
+      if (DomTreeNode *Node = DT->getNode(II->getParent())) {
+        DefBlocks.insert(Node->getBlock());
         PQ.push(std::make_pair(Node, DomTreeLevels[Node]));
+      }
     }
   }
 
@@ -718,6 +742,12 @@ void StackAllocationPromoter::promoteAllocationToPhi() {
   // A list of nodes for which we already calculated the dominator frontier.
   llvm::SmallPtrSet<DomTreeNode *, 32> Visited;
 
+  // The nodes whose successors have already been inspected. Roots are taken
+  // from the bottom of the dom tree upwards, so a subtree that was inspected
+  // for a deeper root can't add anything for a shallower one, and every node
+  // is walked at most once.
+  llvm::SmallPtrSet<DomTreeNode *, 32> VisitedWorklist;
+
   SmallVector<DomTreeNode *, 32> Worklist;
 
   // Scan all of the definitions in the function bottom-up using the priority
@@ -733,6 +763,7 @@ void StackAllocationPromoter::promoteAllocationToPhi() {
     // dominance frontier.
     Worklist.clear();
     Worklist.push_back(Root);
+    VisitedWorklist.insert(Root);
 
     while (!Worklist.empty()) {
       DomTreeNode *Node = Worklist.pop_back_val();
@@ -767,14 +798,15 @@ void StackAllocationPromoter::promoteAllocationToPhi() {
           continue;
 
         // The successor node is a new PHINode. If this is a new PHI node
-        // then it may require additional definitions, so add it to the PQ.
-        if (PhiBlocks.insert(Succ).second)
+        // then it may require additional definitions, so add it to the PQ,
+        // unless it is already there as a block with a store.
+        if (PhiBlocks.insert(Succ).second && !DefBlocks.count(Succ))
           PQ.push(std::make_pair(SuccNode, SuccLevel));
       }
 
       // Add the children in the dom-tree to the worklist.
       for (auto CI = Node->begin(), CE = Node->end(); CI != CE; ++CI)
-        if (!Visited.count(*CI))
+        if (VisitedWorklist.insert(*CI).second)
           Worklist.push_back(*CI);
     }
   }
@@ -892,6 +892,11 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   if (isa<ReturnInst>(DestBB->getTerminator()))
     return false;
 
+  // Duplicating code into a block which the profile says is never executed
+  // only grows the code.
+  if (SrcBB->getExecutionCount() && *SrcBB->getExecutionCount() == 0)
+    return false;
+
   // We need to update SSA if a value duplicated is used outside of the
   // duplicated block.
   bool NeedToUpdateSSA = false;
@@ -18,6 +18,7 @@
 #define DEBUG_TYPE "sil-speculative-devirtualizer"
 #include "swift/Basic/DemangleWrappers.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILFunction.h"
@@ -45,6 +46,13 @@ using namespace swift;
 static const int MaxNumSpeculativeTargets = 6;
 
 STATISTIC(NumTargetsPredicted, "Number of monomorphic functions predicted");
+STATISTIC(NumSealedDevirtualized,
+          "Number of calls fully devirtualized in sealed class hierarchies");
+
+static llvm::cl::opt<bool> EnableSealedHierarchyDevirt(
+    "sil-devirt-sealed-hierarchies", llvm::cl::init(true),
+    llvm::cl::desc("Only check for the subclasses which override a method "
+                   "when the class hierarchy can't be extended"));
 
 // A utility function for cloning the apply instruction.
 static FullApplySite CloneApply(FullApplySite AI, SILBuilder &Builder) {
@@ -207,26 +215,11 @@ static FullApplySite speculateMonomorphicTarget(FullApplySite AI,
   return VirtAI;
 }
 
-/// \brief Returns true, if a method implementation to be called by the
-/// default case handler of a speculative devirtualization is statically
-/// known. This happens if it can be proven that generated
-/// checked_cast_br instructions cover all other possible cases.
-///
-/// \p CHA class hierarchy analysis to be used
-/// \p AI  invocation instruction
-/// \p CD  static class of the instance whose method is being invoked
-/// \p Subs set of direct subclasses of this class
-static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
-                               FullApplySite AI,
-                               ClassDecl *CD,
-                               ClassHierarchyAnalysis::ClassList &Subs) {
-  ClassMethodInst *CMI = cast<ClassMethodInst>(AI.getCallee());
-  auto *Method = CMI->getMember().getFuncDecl();
+/// \brief Returns true if all subclasses of \p CD are known, i.e. it can't be
+/// subclassed outside of the module, or outside of the file if it is private.
+static bool isHierarchySealed(FullApplySite AI, ClassDecl *CD) {
   const DeclContext *DC = AI.getModule().getAssociatedContext();
 
-  if (CD->isFinal())
-    return true;
-
   // If the class has an @objc ancestry it can be dynamically subclassed and we
   // can't therefore statically know the default case.
   auto Ancestry = CD->checkObjCAncestry();
@@ -258,6 +251,30 @@ static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
   case Accessibility::Private:
     break;
   }
+  return true;
+}
+
+/// \brief Returns true, if a method implementation to be called by the
+/// default case handler of a speculative devirtualization is statically
+/// known. This happens if it can be proven that generated
+/// checked_cast_br instructions cover all other possible cases.
+///
+/// \p CHA class hierarchy analysis to be used
+/// \p AI  invocation instruction
+/// \p CD  static class of the instance whose method is being invoked
+/// \p Subs set of direct subclasses of this class
+static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
+                               FullApplySite AI,
+                               ClassDecl *CD,
+                               ClassHierarchyAnalysis::ClassList &Subs) {
+  ClassMethodInst *CMI = cast<ClassMethodInst>(AI.getCallee());
+  auto *Method = CMI->getMember().getFuncDecl();
+
+  if (CD->isFinal())
+    return true;
+
+  if (!isHierarchySealed(AI, CD))
+    return false;
 
   // This is a private or a module internal class.
   //
@@ -311,6 +328,20 @@ static bool isDefaultCaseKnown(ClassHierarchyAnalysis *CHA,
   return true;
 }
 
+/// Records that the class_method call \p AI could not be devirtualized.
+static void remarkNotDevirtualized(FullApplySite AI, StringRef Reason) {
+  SILModule &M = AI.getModule();
+  if (!OptRemark::isEnabled(M))
+    return;
+
+  auto *CMI = cast<ClassMethodInst>(AI.getCallee());
+  OptRemark::emit(M, OptRemark::RemarkMissed(DEBUG_TYPE, "NotDevirtualized",
+                                             *AI.getInstruction())
+                       << OptRemark::Argument(
+                              "Method", CMI->getMember().getDecl()->getNameStr())
+                       << OptRemark::Argument("Reason", Reason));
+}
+
 /// \brief Try to speculate the call target for the call \p AI. This function
 /// returns true if a change was made.
 static bool tryToSpeculateTarget(FullApplySite AI,
@@ -331,8 +362,10 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   // Bail if any generic types parameters of the class instance type are
   // unbound.
   // We cannot devirtualize unbound generic calls yet.
-  if (SubType.getSwiftRValueType()->hasArchetype())
+  if (SubType.getSwiftRValueType()->hasArchetype()) {
+    remarkNotDevirtualized(AI, "unbound generic class");
     return false;
+  }
 
   auto &M = CMI->getModule();
   auto ClassType = SubType;
@@ -357,7 +390,10 @@ static bool tryToSpeculateTarget(FullApplySite AI,
 
     DEBUG(llvm::dbgs() << "Inserting monomorphic speculative call for class " <<
           CD->getName() << "\n");
-    return !!speculateMonomorphicTarget(AI, SubType, LastCCBI);
+    auto NewAI = speculateMonomorphicTarget(AI, SubType, LastCCBI);
+    if (NewAI)
+      remarkNotDevirtualized(NewAI, "open class hierarchy");
+    return !!NewAI;
   }
 
   // True if any instructions were changed or generated.
@@ -396,6 +432,30 @@ static bool tryToSpeculateTarget(FullApplySite AI,
     Subs.erase(RemovedIt, Subs.end());
   }
 
+  // If the class hierarchy is sealed but checking for every subclass would
+  // not cover all of it, let the default case directly call the
+  // implementation used by the static class. Then only the subclasses which
+  // use a different implementation need a check.
+  bool IsSealed = false;
+  if (EnableSealedHierarchyDevirt && isHierarchySealed(AI, CD) &&
+      (Subs.size() > MaxNumSpeculativeTargets ||
+       !isDefaultCaseKnown(CHA, AI, CD, Subs))) {
+    auto *Method = CMI->getMember().getFuncDecl();
+    auto *ImplFD = CD->findImplementingMethod(Method);
+    SmallVector<ClassDecl *, 8> OverridingSubs;
+    for (auto *Sub : Subs)
+      if (Sub->findImplementingMethod(Method) != ImplFD)
+        OverridingSubs.push_back(Sub);
+
+    if (OverridingSubs.size() <= MaxNumSpeculativeTargets) {
+      DEBUG(llvm::dbgs() << "Class " << CD->getName() << " has a sealed "
+                         "hierarchy with " << OverridingSubs.size()
+                         << " overriding subclasses.\n");
+      Subs = std::move(OverridingSubs);
+      IsSealed = true;
+    }
+  }
+
   // Number of subclasses which cannot be handled by checked_cast_br checks.
   int NotHandledSubsNum = 0;
   if (Subs.size() > MaxNumSpeculativeTargets) {
@@ -422,10 +482,13 @@ static bool tryToSpeculateTarget(FullApplySite AI,
       return false;
   }
 
-  auto FirstAI = speculateMonomorphicTarget(AI, SubType, LastCCBI);
-  if (FirstAI) {
-    Changed = true;
-    AI = FirstAI;
+  // The static class is handled by the default case of a sealed hierarchy.
+  if (!IsSealed) {
+    auto FirstAI = speculateMonomorphicTarget(AI, SubType, LastCCBI);
+    if (FirstAI) {
+      Changed = true;
+      AI = FirstAI;
+    }
   }
 
   // Perform a speculative devirtualization of a method invocation.
@@ -496,9 +559,26 @@ static bool tryToSpeculateTarget(FullApplySite AI,
     Changed = true;
   }
 
+  if (IsSealed) {
+    // All subclasses which don't use the implementation of the static class
+    // have been checked for, unless there were too many of them.
+    if (NotHandledSubsNum) {
+      remarkNotDevirtualized(AI, "unhandled overriding subclasses");
+      return Changed;
+    }
+    auto NewInstPair = tryDevirtualizeClassMethod(AI, SubTypeValue);
+    if (!NewInstPair.first)
+      return Changed;
+    replaceDeadApply(AI, NewInstPair.first);
+    ++NumSealedDevirtualized;
+    return true;
+  }
+
   // Check if there is only a single statically known implementation
   // of the method which can be called by the default case handler.
   if (NotHandledSubsNum || !isDefaultCaseKnown(CHA, AI, CD, Subs)) {
+    remarkNotDevirtualized(AI, NotHandledSubsNum ? "unhandled subclasses"
+                                                 : "open class hierarchy");
     // Devirtualization of remaining cases is not possible,
     // because more than one implementation of the method
     // needs to be handled here. Thus, an indirect call through
@@ -26,10 +26,16 @@
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+static llvm::cl::opt<bool>
+DumpCacheStats("aa-dump-cache-stats", llvm::cl::init(false),
+               llvm::cl::desc("Print how often alias queries were answered "
+                              "from the cache"));
+
 //===----------------------------------------------------------------------===//
 //                               Value Gatherer
 //===----------------------------------------------------------------------===//
@@ -95,6 +101,10 @@ class SILAADumper : public SILModuleTransform {
       }
           llvm::outs() << "\n";
     }
+
+    if (DumpCacheStats)
+      PM->getAnalysis<AliasAnalysis>()->getAliasCacheStats().print(
+          llvm::outs(), "Alias");
   }
 
   StringRef getName() override { return "AA Dumper"; }
@@ -42,8 +42,14 @@ class SILLinker : public SILModuleTransform {
 
   void run() override {
     SILModule &M = *getModule();
+
+    // With on-demand linking, only pull in what must be available before
+    // optimizing, i.e. transparent and shared functions. Everything else is
+    // linked by the optimizations that want to look at its body.
+    auto LinkMode = M.getOptions().LinkOnDemand ?
+      SILModule::LinkingMode::LinkNormal : SILModule::LinkingMode::LinkAll;
     for (auto &Fn : M)
-      if (M.linkFunction(&Fn, SILModule::LinkingMode::LinkAll))
+      if (M.linkFunction(&Fn, LinkMode))
           invalidateAnalysis(&Fn, SILAnalysis::InvalidationKind::Everything);
   }
 
@@ -19,10 +19,16 @@
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+static llvm::cl::opt<bool>
+DumpCacheStats("mem-behavior-dump-cache-stats", llvm::cl::init(false),
+               llvm::cl::desc("Print how often memory behavior queries were "
+                              "answered from the cache"));
+
 //===----------------------------------------------------------------------===//
 //                               Value Gatherer
 //===----------------------------------------------------------------------===//
@@ -90,6 +96,10 @@ class MemBehaviorDumper : public SILModuleTransform {
       }
       llvm::outs() << "\n";
     }
+
+    if (DumpCacheStats)
+      PM->getAnalysis<AliasAnalysis>()->getMemoryBehaviorCacheStats().print(
+          llvm::outs(), "Memory behavior");
   }
 
   StringRef getName() override { return "Memory Behavior Dumper"; }
@@ -25,10 +25,16 @@
 #include "swift/SIL/SILValue.h"
 #include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+static llvm::cl::opt<bool>
+DumpCacheStats("rc-id-dump-cache-stats", llvm::cl::init(false),
+               llvm::cl::desc("Print how often RC identity queries were "
+                              "answered from the cache"));
+
 namespace {
 
 /// Dumps the alias relations between all instructions of a function.
@@ -70,6 +76,9 @@ class RCIdentityDumper : public SILFunctionTransform {
                    << ValueToValueIDMap[P.second] << "\n";
     }
 
+    if (DumpCacheStats)
+      RCId->getCacheStats().print(llvm::outs(), "RC identity");
+
     llvm::outs() << "\n";
   }
 
@@ -49,6 +49,45 @@ bool swift::hasNonTrivialNonDebugUse(SILArgument *Arg) {
   return false;
 }
 
+/// Returns the number of scalar values \p Ty consists of, counting enums and
+/// other non-aggregates as one. Stops counting once \p Limit is exceeded.
+static unsigned getNumScalarLeaves(SILModule &M, SILType Ty, unsigned Limit) {
+  if (auto TT = Ty.getAs<TupleType>()) {
+    unsigned Count = 0;
+    for (unsigned i = 0, e = TT->getNumElements(); i != e && Count <= Limit;
+         ++i)
+      Count += getNumScalarLeaves(M, Ty.getTupleElementType(i), Limit - Count);
+    return Count;
+  }
+  if (auto *SD = Ty.getStructOrBoundGenericStruct()) {
+    unsigned Count = 0;
+    for (VarDecl *VD : SD->getStoredProperties()) {
+      if (Count > Limit)
+        break;
+      Count += getNumScalarLeaves(M, Ty.getFieldType(VD, M), Limit - Count);
+    }
+    return Count;
+  }
+  return 1;
+}
+
+bool ArgumentDescriptor::shouldConvertIndirectToDirect() const {
+  if (IsEntirelyDead || IsIndirectResult)
+    return false;
+
+  if (!hasConvention(SILArgumentConvention::Indirect_In) &&
+      !hasConvention(SILArgumentConvention::Indirect_In_Guaranteed))
+    return false;
+
+  SILModule &M = Arg->getModule();
+  SILType Ty = Arg->getType().getObjectType();
+  if (!Ty.isLoadable(M))
+    return false;
+
+  // Use the same limit as for argument explosion.
+  return getNumScalarLeaves(M, Ty, 3) <= 3;
+}
+
 static bool isSpecializableRepresentation(SILFunctionTypeRepresentation Rep) {
   switch (Rep) {
   case SILFunctionTypeRepresentation::Method:
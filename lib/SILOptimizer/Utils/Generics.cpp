@@ -16,10 +16,16 @@
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/Utils/GenericCloner.h"
 #include "swift/SIL/DebugUtils.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/AST/GenericEnvironment.h"
 
 using namespace swift;
 
+static llvm::cl::opt<bool> EnablePartialSpecialization(
+    "sil-partial-specialization", llvm::cl::init(false),
+    llvm::cl::desc("Specialize generic functions on the concrete subset of "
+                   "their substitutions"));
+
 // Max depth of a bound generic which can be processed by the generic
 // specializer.
 // E.g. the depth of Array<Array<Array<T>>> is 3.
@@ -49,7 +55,8 @@ static unsigned getBoundGenericDepth(Type t) {
 
 // Initialize SpecializedType iff the specialization is allowed.
 ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
-                                     ArrayRef<Substitution> ParamSubs) {
+                                     ArrayRef<Substitution> ParamSubs,
+                                     bool AllowPartial) {
   if (!OrigF->shouldOptimize()) {
     DEBUG(llvm::dbgs() << "    Cannot specialize function " << OrigF->getName()
                        << " marked to be excluded from optimizations.\n");
@@ -61,14 +68,21 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
     InterfaceSubs = OrigF->getLoweredFunctionType()->getGenericSignature()
       ->getSubstitutionMap(ParamSubs);
 
-  // We do not support partial specialization.
+  // The substitutions which are applied to the function type. For a partial
+  // specialization they map the generic parameters which stay generic to the
+  // generic parameters of the specialized function.
+  SubstitutionMap TypeSubs = InterfaceSubs;
+
   if (hasUnboundGenericTypes(InterfaceSubs.getMap())) {
-    DEBUG(llvm::dbgs() <<
-          "    Cannot specialize with unbound interface substitutions.\n");
-    DEBUG(for (auto Sub : ParamSubs) {
-            Sub.dump();
-          });
-    return;
+    if (!AllowPartial || !EnablePartialSpecialization ||
+        !initPartialSpecialization(OrigF, ParamSubs, TypeSubs)) {
+      DEBUG(llvm::dbgs() <<
+            "    Cannot specialize with unbound interface substitutions.\n");
+      DEBUG(for (auto Sub : ParamSubs) {
+              Sub.dump();
+            });
+      return;
+    }
   }
   if (hasDynamicSelfTypes(InterfaceSubs.getMap())) {
     DEBUG(llvm::dbgs() << "    Cannot specialize with dynamic self.\n");
@@ -90,9 +104,16 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
   SILModule &M = OrigF->getModule();
   Module *SM = M.getSwiftModule();
 
-  SubstitutedType = SILType::substFuncType(M, SM, InterfaceSubs.getMap(),
+  SubstitutedType = SILType::substFuncType(M, SM, TypeSubs.getMap(),
                                            OrigF->getLoweredFunctionType(),
                                            /*dropGenerics = */ true);
+  if (SpecializedGenericSig) {
+    SubstitutedType = SILFunctionType::get(
+        SpecializedGenericSig, SubstitutedType->getExtInfo(),
+        SubstitutedType->getCalleeConvention(),
+        SubstitutedType->getParameters(), SubstitutedType->getAllResults(),
+        SubstitutedType->getOptionalErrorResult(), M.getASTContext());
+  }
 
   NumResults = SubstitutedType->getNumIndirectResults();
   Conversions.resize(NumResults + SubstitutedType->getParameters().size());
@@ -104,7 +125,9 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
     unsigned IdxForResult = 0;
     for (SILResultInfo RI : SubstitutedType->getIndirectResults()) {
       assert(RI.isIndirect());
-      if (RI.getSILType().isLoadable(M) && !RI.getType()->isVoid()) {
+      // Types which are still generic stay indirect.
+      if (!RI.getType()->hasTypeParameter() && RI.getSILType().isLoadable(M) &&
+          !RI.getType()->isVoid()) {
         Conversions.set(IdxForResult);
         break;
       }
@@ -114,7 +137,7 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
   // Try to convert indirect incoming parameters to direct parameters.
   unsigned IdxForParam = NumResults;
   for (SILParameterInfo PI : SubstitutedType->getParameters()) {
-    if (PI.getSILType().isLoadable(M) &&
+    if (!PI.getType()->hasTypeParameter() && PI.getSILType().isLoadable(M) &&
         PI.getConvention() == ParameterConvention::Indirect_In) {
       Conversions.set(IdxForParam);
     }
@@ -123,6 +146,109 @@ ReabstractionInfo::ReabstractionInfo(SILFunction *OrigF,
   SpecializedType = createSpecializedType(SubstitutedType, M);
 }
 
+bool ReabstractionInfo::initPartialSpecialization(
+    SILFunction *OrigF, ArrayRef<Substitution> ParamSubs,
+    SubstitutionMap &TypeSubs) {
+  CanSILFunctionType OrigFTy = OrigF->getLoweredFunctionType();
+  // The Self parameter of a witness method can't be dropped.
+  if (OrigFTy->getRepresentation() ==
+      SILFunctionTypeRepresentation::WitnessMethod)
+    return false;
+
+  CanGenericSignature OrigSig = OrigFTy->getGenericSignature();
+  SILModule &M = OrigF->getModule();
+  Module *SM = M.getSwiftModule();
+  ASTContext &Ctx = M.getASTContext();
+
+  // Keep the generic parameters whose replacement is not concrete and renumber
+  // them.
+  TypeSubstitutionMap ParamMap;
+  SmallVector<GenericTypeParamType *, 4> NewParams;
+  for (auto *GP : OrigSig->getGenericParams()) {
+    auto *CanGP = cast<GenericTypeParamType>(GP->getCanonicalType());
+    Type Replacement = TypeSubs.getMap().lookup(CanGP);
+    if (Replacement && !Replacement->hasArchetype())
+      continue;
+    auto *NewGP = GenericTypeParamType::get(0, NewParams.size(), Ctx);
+    ParamMap[CanGP] = NewGP;
+    NewParams.push_back(NewGP);
+  }
+  // Are there any concrete substitutions at all?
+  if (NewParams.size() == OrigSig->getGenericParams().size())
+    return false;
+
+  enum : unsigned { UsesConcrete = 1, UsesGeneric = 2 };
+  auto getParamUses = [&](Type Ty) -> unsigned {
+    unsigned Uses = 0;
+    if (!Ty)
+      return Uses;
+    Ty.visit([&](Type T) {
+      if (auto *GP = T->getAs<GenericTypeParamType>()) {
+        auto *CanGP = cast<GenericTypeParamType>(GP->getCanonicalType());
+        Uses |= ParamMap.count(CanGP) ? UsesGeneric : UsesConcrete;
+      }
+    });
+    return Uses;
+  };
+  auto remap = [&](Type Ty) -> Type {
+    return Ty.subst(SM, ParamMap, None)->getCanonicalType();
+  };
+
+  // Requirements on the concrete parameters are satisfied by the concrete
+  // types. The others are kept, unless they relate both kinds of parameters.
+  SmallVector<Requirement, 8> NewRequirements;
+  for (const Requirement &Req : OrigSig->getRequirements()) {
+    unsigned Uses =
+        getParamUses(Req.getFirstType()) | getParamUses(Req.getSecondType());
+    if (Uses == UsesConcrete)
+      continue;
+    if (Uses != UsesGeneric) {
+      DEBUG(llvm::dbgs() << "    Cannot partially specialize with a "
+                            "requirement on concrete and generic types.\n");
+      return false;
+    }
+    Type Second = Req.getSecondType();
+    NewRequirements.push_back(Requirement(Req.getKind(),
+                                          remap(Req.getFirstType()),
+                                          Second ? remap(Second) : Second));
+  }
+
+  SpecializedGenericSig =
+      GenericSignature::getCanonical(NewParams, NewRequirements);
+  SpecializedGenericEnv =
+      SpecializedGenericSig->getCanonicalGenericEnvironment(*SM);
+
+  // Partition the substitutions. The dependent types which stay generic are
+  // listed in the same order in the new signature.
+  SubstitutionMap PartialSubs;
+  auto SubIter = ParamSubs.begin();
+  for (Type DepTy : OrigSig->getAllDependentTypes()) {
+    Substitution Sub = *SubIter++;
+    CanType CanDepTy = DepTy->getCanonicalType();
+    if (getParamUses(DepTy) == UsesConcrete) {
+      PartialSubs.addSubstitution(CanDepTy, Sub.getReplacement());
+      PartialSubs.addConformances(CanDepTy, Sub.getConformances());
+      ClonerParamSubs.push_back(Sub);
+      continue;
+    }
+
+    Type NewDepTy = remap(DepTy);
+    SmallVector<ProtocolConformanceRef, 4> Conformances;
+    for (ProtocolConformanceRef C : Sub.getConformances())
+      Conformances.push_back(ProtocolConformanceRef(C.getRequirement()));
+    auto AbstractConformances = Ctx.AllocateCopy(Conformances);
+
+    PartialSubs.addSubstitution(CanDepTy, NewDepTy);
+    PartialSubs.addConformances(CanDepTy, AbstractConformances);
+    ClonerParamSubs.push_back(Substitution(
+        SpecializedGenericEnv->mapTypeIntoContext(SM, NewDepTy),
+        AbstractConformances));
+    CallerParamSubs.push_back(Sub);
+  }
+  TypeSubs = PartialSubs;
+  return true;
+}
+
 // Convert the substituted function type into a specialized function type based
 // on the ReabstractionInfo.
 CanSILFunctionType ReabstractionInfo::
@@ -188,9 +314,14 @@ GenericFuncSpecializer::GenericFuncSpecializer(SILFunction *GenericFunc,
 
   assert(GenericFunc->isDefinition() && "Expected definition to specialize!");
 
+  // A partial specialization is cloned (and mangled) with the archetypes of
+  // its own generic environment instead of those of the caller.
+  if (ReInfo.isPartialSpecialization())
+    this->ParamSubs = ReInfo.getClonerParamSubstitutions();
+
   Mangle::Mangler Mangler;
   GenericSpecializationMangler GenericMangler(Mangler, GenericFunc,
-                                              ParamSubs, Fragile);
+                                              this->ParamSubs, Fragile);
   GenericMangler.mangle();
   ClonedName = Mangler.finalize();
 
@@ -280,11 +411,17 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     ++Idx;
   }
 
+  // A partial specialization is still generic.
+  ArrayRef<Substitution> Subs = ReInfo.getCallerParamSubstitutions();
+  SILType CalleeSubstTy = Callee->getType();
+  if (!Subs.empty())
+    CalleeSubstTy = CalleeSubstTy.substGenericArgs(Builder.getModule(), Subs);
+
   if (auto *TAI = dyn_cast<TryApplyInst>(AI)) {
     SILBasicBlock *ResultBB = TAI->getNormalBB();
     assert(ResultBB->getSinglePredecessor() == TAI->getParent());
     auto *NewTAI =
-      Builder.createTryApply(Loc, Callee, Callee->getType(), {},
+      Builder.createTryApply(Loc, Callee, CalleeSubstTy, Subs,
                              Arguments, ResultBB, TAI->getErrorBB());
     if (StoreResultTo) {
       // The original normal result of the try_apply is an empty tuple.
@@ -301,7 +438,10 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     return NewTAI;
   }
   if (auto *A = dyn_cast<ApplyInst>(AI)) {
-    auto *NewAI = Builder.createApply(Loc, Callee, Arguments, A->isNonThrowing());
+    auto *NewAI = Builder.createApply(
+        Loc, Callee, CalleeSubstTy,
+        CalleeSubstTy.castTo<SILFunctionType>()->getSILResult(), Subs,
+        Arguments, A->isNonThrowing());
     if (StoreResultTo) {
       // Store the direct result to the original result address.
       fixUsedVoidType(A, Loc, Builder);
@@ -311,6 +451,7 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     return NewAI;
   }
   if (auto *PAI = dyn_cast<PartialApplyInst>(AI)) {
+    assert(Subs.empty() && "partial specialization of a partial_apply");
     CanSILFunctionType NewPAType =
       ReInfo.createSpecializedType(PAI->getFunctionType(), Builder.getModule());
     SILType PTy = SILType::getPrimitiveObjectType(ReInfo.getSpecializedType());
@@ -432,6 +573,19 @@ static SILFunction *createReabstractionThunk(const ReabstractionInfo &ReInfo,
   return Thunk;
 }
 
+/// Records a remark that \p Apply, which calls \p Callee, could not be
+/// specialized.
+static void remarkNotSpecialized(ApplySite Apply, SILFunction *Callee,
+                                 StringRef Reason) {
+  SILInstruction *I = Apply.getInstruction();
+  if (!OptRemark::isEnabled(I->getModule()))
+    return;
+  OptRemark::emit(I->getModule(),
+                  OptRemark::RemarkMissed(DEBUG_TYPE, "NotSpecialized", *I)
+                    << OptRemark::Argument("Callee", Callee)
+                    << OptRemark::Argument("Reason", Reason));
+}
+
 void swift::trySpecializeApplyOfGeneric(
     ApplySite Apply, DeadInstructionSet &DeadApplies,
     llvm::SmallVectorImpl<SILFunction *> &NewFunctions) {
@@ -448,8 +602,10 @@ void swift::trySpecializeApplyOfGeneric(
   // not have an external entry point, Since the callee is not
   // fragile we cannot serialize the body of the specialized
   // callee either.
-  if (F->isFragile() && !RefF->hasValidLinkageForFragileInline())
-      return;
+  if (F->isFragile() && !RefF->hasValidLinkageForFragileInline()) {
+    remarkNotSpecialized(Apply, RefF, "fragile caller");
+    return;
+  }
 
   // If the caller and callee are both fragile, preserve the fragility when
   // cloning the callee. Otherwise, strip it off so that we can optimize
@@ -458,15 +614,24 @@ void swift::trySpecializeApplyOfGeneric(
   if (F->isFragile() && RefF->isFragile())
     Fragile = IsFragile;
 
-  ReabstractionInfo ReInfo(RefF, Apply.getSubstitutions());
-  if (!ReInfo.getSpecializedType())
+  ReabstractionInfo ReInfo(RefF, Apply.getSubstitutions(),
+                           /*AllowPartial=*/ true);
+  if (!ReInfo.getSpecializedType()) {
+    remarkNotSpecialized(Apply, RefF, "unsupported substitutions");
+    return;
+  }
+
+  // We don't create re-abstraction thunks for partial specializations.
+  auto *PAI = dyn_cast<PartialApplyInst>(Apply);
+  if (PAI && ReInfo.isPartialSpecialization()) {
+    remarkNotSpecialized(Apply, RefF, "partial specialization of closure");
     return;
+  }
 
   SILModule &M = F->getModule();
 
   bool needAdaptUsers = false;
   bool replacePartialApplyWithoutReabstraction = false;
-  auto *PAI = dyn_cast<PartialApplyInst>(Apply);
   if (PAI && ReInfo.hasConversions()) {
     // If we have a partial_apply and we converted some results/parameters from
     // indirect to direct there are 3 cases:
@@ -509,8 +674,10 @@ void swift::trySpecializeApplyOfGeneric(
     linkSpecialization(M, SpecializedF);
   } else {
     SpecializedF = FuncSpecializer.tryCreateSpecialization();
-    if (!SpecializedF)
+    if (!SpecializedF) {
+      remarkNotSpecialized(Apply, RefF, "specialization failed");
       return;
+    }
 
     NewFunctions.push_back(SpecializedF);
   }
@@ -762,3 +929,75 @@ SILFunction *swift::lookupPrespecializedSymbol(SILModule &M,
   return Specialization;
 }
 
+
+// =============================================================================
+// Specializations requested from other modules.
+// =============================================================================
+
+/// Returns the name of \p Ty to use in a specialization request, or an empty
+/// string if the defining module of a generic function couldn't look it up.
+static std::string getRequestedTypeName(SILModule &M, Type Ty) {
+  auto *NTD = Ty->getAnyNominal();
+  if (!NTD || NTD->isGenericContext() ||
+      !NTD->getDeclContext()->isModuleScopeContext() ||
+      !Ty->isEqual(NTD->getDeclaredType()))
+    return std::string();
+
+  // A type of this module is not visible to the module of the function.
+  auto *TypeModule = NTD->getModuleContext();
+  if (TypeModule == M.getSwiftModule())
+    return std::string();
+
+  return (TypeModule->getName().str() + "." + NTD->getName().str()).str();
+}
+
+SILFunction *
+swift::lookupOrRequestExportedSpecialization(SILFunction *Callee,
+                                             ArrayRef<Substitution> Subs,
+                                             const ReabstractionInfo &ReInfo) {
+  assert(Callee->isExternalDeclaration() && "Expected a declaration");
+  SILModule &M = Callee->getModule();
+
+  auto SpecType = ReInfo.getSpecializedType();
+  if (!SpecType || SpecType->hasArchetype() || hasUnboundGenericTypes(Subs))
+    return nullptr;
+
+  std::string SpecializedName;
+  {
+    Mangle::Mangler Mangler;
+    GenericSpecializationMangler GenericMangler(Mangler, Callee, Subs,
+                                                Callee->isFragile());
+    GenericMangler.mangle();
+    SpecializedName = Mangler.finalize();
+  }
+
+  if (auto *Specialization =
+          M.hasFunction(SpecializedName, SILLinkage::PublicExternal)) {
+    DEBUG(llvm::dbgs() << "Found an exported specialization: "
+                       << SpecializedName << '\n');
+    return Specialization;
+  }
+
+  if (M.getOptions().SpecializationRequestsFile.empty())
+    return nullptr;
+
+  // Only the replacements of the generic parameters are recorded. The ones
+  // of their associated types follow from them.
+  auto *Sig = Callee->getLoweredFunctionType()->getGenericSignature();
+  unsigned NumParams = Sig->getGenericParams().size();
+  assert(Subs.size() >= NumParams && "Missing substitutions");
+
+  SpecializationRequest Request;
+  Request.Function = Callee->getName();
+  for (const Substitution &Sub : Subs.slice(0, NumParams)) {
+    std::string TypeName = getRequestedTypeName(M, Sub.getReplacement());
+    if (TypeName.empty())
+      return nullptr;
+    Request.Substitutions.push_back(std::move(TypeName));
+  }
+
+  DEBUG(llvm::dbgs() << "Requesting specialization: " << SpecializedName
+                     << '\n');
+  M.addSpecializationRequest(SpecializedName, std::move(Request));
+  return nullptr;
+}
@@ -58,6 +58,7 @@ void SILSSAUpdater::Initialize(SILType Ty) {
     AV = new AvailableValsTy();
   else
     getAvailVals(AV).clear();
+  AvailableValuesAreIdentical = None;
 }
 
 bool SILSSAUpdater::HasValueForBlock(SILBasicBlock *BB) const {
@@ -68,6 +69,7 @@ bool SILSSAUpdater::HasValueForBlock(SILBasicBlock *BB) const {
 /// specified value.
 void SILSSAUpdater::AddAvailableValue(SILBasicBlock *BB, SILValue V) {
   getAvailVals(AV)[BB] = V;
+  AvailableValuesAreIdentical = None;
 }
 
 /// Construct SSA form, materializing a value that is live at the end of the
@@ -91,20 +93,28 @@ bool areIdentical(AvailableValsTy &Avails) {
   return true;
 }
 
+/// Like areIdentical on the available values, but only computed once for
+/// all the uses that are rewritten.
+bool SILSSAUpdater::areAvailableValuesIdentical() {
+  if (!AvailableValuesAreIdentical)
+    AvailableValuesAreIdentical = areIdentical(getAvailVals(AV));
+  return *AvailableValuesAreIdentical;
+}
+
 /// This should be called in top-down order of each def that needs its uses
 /// rewrited. The order that we visit uses for a given def is irrelevant.
 void SILSSAUpdater::RewriteUse(Operand &Op) {
   // Replicate function_refs to their uses. SILGen can't build phi nodes for
   // them and it would not make much sense anyways.
   if (auto *FR = dyn_cast<FunctionRefInst>(Op.get())) {
-    assert(areIdentical(getAvailVals(AV)) &&
+    assert(areAvailableValuesIdentical() &&
            "The function_refs need to have the same value");
     SILInstruction *User = Op.getUser();
     auto *NewFR = FR->clone(User);
     Op.set(NewFR);
     return;
   } else if (auto *IL = dyn_cast<IntegerLiteralInst>(Op.get()))
-    if (areIdentical(getAvailVals(AV))) {
+    if (areAvailableValuesIdentical()) {
       // Some llvm intrinsics don't like phi nodes as their constant inputs (e.g
       // ctlz).
       SILInstruction *User = Op.getUser();
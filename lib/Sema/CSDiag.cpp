@@ -952,9 +952,24 @@ namespace {
     ConstraintSystem *const CS;
 
     /// This is the name of the callee as extracted from the call expression.
-    /// This can be empty in cases like calls to closure exprs.
+    /// This can be empty in cases like calls to closure exprs.  Diagnostics
+    /// should use getDeclName(), which includes declNameBase.
     std::string declName;
 
+    /// If the callee is named after a type, as in 'Foo.init', this is that
+    /// type.  Most candidate sets built while diagnosing a failure are never
+    /// reported, so the type is only printed when the name is asked for.
+    Type declNameBase;
+
+    std::string getDeclName() const {
+      if (!declNameBase)
+        return declName;
+      std::string name = declNameBase->getString();
+      if (!declName.empty())
+        name += "." + declName;
+      return name;
+    }
+
     /// True if the call site for this callee syntactically has a trailing
     /// closure specified.
     bool hasTrailingClosure;
@@ -1049,7 +1064,7 @@ namespace {
 }
 
 void CalleeCandidateInfo::dump() const {
-  llvm::errs() << "CalleeCandidateInfo for '" << declName << "': closeness="
+  llvm::errs() << "CalleeCandidateInfo for '" << getDeclName() << "': closeness="
                << unsigned(closeness) << "\n";
   llvm::errs() << candidates.size() << " candidates:\n";
   for (auto c : candidates) {
@@ -1474,9 +1489,8 @@ void CalleeCandidateInfo::collectCalleeCandidates(Expr *fn,
     candidates.push_back({ decl, getCalleeLevel(decl) });
     
     if (auto fTy = decl->getType()->getAs<AnyFunctionType>())
-      declName = fTy->getInput()->getRValueInstanceType()->getString()+".init";
-    else
-      declName = "init";
+      declNameBase = fTy->getInput()->getRValueInstanceType();
+    declName = "init";
     return;
   }
 
@@ -1503,7 +1517,7 @@ void CalleeCandidateInfo::collectCalleeCandidates(Expr *fn,
           candidates.push_back({ ctor, 1 });
     }
 
-    declName = instanceType->getString();
+    declNameBase = instanceType;
     return;
   }
 
@@ -1584,7 +1598,7 @@ void CalleeCandidateInfo::collectCalleeCandidates(Expr *fn,
     if (UDE->getName().getBaseName() == CS->TC.Context.Id_init) {
       auto selfTy = UDE->getBase()->getType()->getLValueOrInOutObjectType();
       if (!selfTy->hasTypeVariable())
-        declName = selfTy.getString() + "." + declName;
+        declNameBase = selfTy;
     }
 
     // Otherwise, look for a disjunction constraint explaining what the set is.
@@ -1794,8 +1808,8 @@ suggestPotentialOverloads(SourceLoc loc, bool isResult) {
     CS->TC.diagnose(loc, diag::suggest_expected_match, isResult,
                     suggestionText);
   } else {
-    CS->TC.diagnose(loc, diag::suggest_partial_overloads, isResult, declName,
-                    suggestionText);
+    CS->TC.diagnose(loc, diag::suggest_partial_overloads, isResult,
+                    getDeclName(), suggestionText);
   }
 }
 
@@ -3514,7 +3528,7 @@ bool FailureDiagnosis::diagnoseCalleeResultContextualConversionError() {
       return false;
       
     diagnose(expr->getLoc(), diag::candidates_no_match_result_type,
-             calleeInfo.declName, calleeInfo[0].getResultType(),
+             calleeInfo.getDeclName(), calleeInfo[0].getResultType(),
              contextualResultType);
     return true;
   default:
@@ -3529,7 +3543,7 @@ bool FailureDiagnosis::diagnoseCalleeResultContextualConversionError() {
           }
       if (resultTy) {
         diagnose(expr->getLoc(), diag::candidates_no_match_result_type,
-                 calleeInfo.declName, calleeInfo[0].getResultType(),
+                 calleeInfo.getDeclName(), calleeInfo[0].getResultType(),
                  contextualResultType);
         return true;
       }
@@ -3537,7 +3551,7 @@ bool FailureDiagnosis::diagnoseCalleeResultContextualConversionError() {
 
     // Otherwise, produce a candidate set.
     diagnose(expr->getLoc(), diag::no_candidates_match_result_type,
-             calleeInfo.declName, contextualResultType);
+             calleeInfo.getDeclName(), contextualResultType);
     calleeInfo.suggestPotentialOverloads(expr->getLoc(), /*isResult*/true);
     return true;
   }
@@ -5080,7 +5094,7 @@ bool FailureDiagnosis::diagnoseNilLiteralComparison(
     Expr *lhsExpr, Expr *rhsExpr, CalleeCandidateInfo &calleeInfo,
     SourceLoc applyLoc) {
 
-  auto overloadName = calleeInfo.declName;
+  auto overloadName = calleeInfo.getDeclName();
 
   // Only diagnose for comparison operators.
   if (!isNameOfStandardComparisonOperator(overloadName))
@@ -5337,7 +5351,7 @@ bool FailureDiagnosis::visitApplyExpr(ApplyExpr *callExpr) {
     return true;
   }
 
-  auto overloadName = calleeInfo.declName;
+  auto overloadName = calleeInfo.getDeclName();
   
   // Otherwise, we have a generic failure.  Diagnose it with a generic error
   // message now.
@@ -15,9 +15,12 @@
 //===----------------------------------------------------------------------===//
 #include "ConstraintSystem.h"
 #include "ConstraintGraph.h"
+#include "swift/Basic/JSONSerialization.h"
+#include "swift/Basic/Statistics.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 #include <memory>
 #include <tuple>
 using namespace swift;
@@ -426,10 +429,22 @@ ConstraintSystem::SolverState::~SolverState() {
   LangOptions &langOpts = CS.getTypeChecker().Context.LangOpts;
   langOpts.DebugConstraintSolver = OldDebugConstraintSolver;
 
-  // Write our local statistics back to the overall statistics.
-  #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
+  // Write our local statistics back to the overall statistics, and to the
+  // constraint system's.
+  #define CS_STATISTIC(Name, Description) \
+    JOIN2(Overall,Name) += Name; \
+    CS.TotalSolverStats.Name += Name;
   #include "ConstraintSolverStats.def"
 
+  // LLVM only counts its statistics in builds with assertions, so add ours
+  // to the frontend's statistics as well.
+  if (stats::isEnabled()) {
+    #define CS_STATISTIC(Name, Description) \
+      stats::addCounter("Sema", #Name, Name);
+    #include "ConstraintSolverStats.def"
+    stats::addCounter("Sema", "NumSolutionAttempts", 1);
+  }
+
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
   // FIXME: This is not at all thread-safe.
@@ -447,6 +462,11 @@ ConstraintSystem::SolverScope::SolverScope(ConstraintSystem &cs)
   : cs(cs), CGScope(cs.CG)
 {
   ++cs.solverState->depth;
+  if (auto *profile = cs.Profile.get()) {
+    ++profile->NumScopesPushed;
+    profile->MaxScopeDepth = std::max(profile->MaxScopeDepth,
+                                      cs.solverState->depth);
+  }
 
   resolvedOverloadSets = cs.resolvedOverloadSets;
   numTypeVariables = cs.TypeVariables.size();
@@ -466,6 +486,8 @@ ConstraintSystem::SolverScope::SolverScope(ConstraintSystem &cs)
 
 ConstraintSystem::SolverScope::~SolverScope() {
   --cs.solverState->depth;
+  if (cs.Profile)
+    ++cs.Profile->NumScopesPopped;
 
   // Erase the end of various lists.
   cs.resolvedOverloadSets = resolvedOverloadSets;
@@ -1225,6 +1247,8 @@ static bool tryTypeVariableBindings(
 
       // Try to solve the system with typeVar := type
       ConstraintSystem::SolverScope scope(cs);
+      if (cs.Profile)
+        ++cs.Profile->BindingAttempts[typeVar];
       if (binding.DefaultedProtocol) {
         // If we were able to solve this without considering
         // default literals, don't bother looking at default literals.
@@ -1936,11 +1960,27 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     }
   };
 
+  // Solve the components with the fewest disjunctions first. If any
+  // component fails, so does the whole system, so a failure in a cheap
+  // component keeps the expensive ones from being explored at all.
+  SmallVector<unsigned, 4> componentOrder;
+  SmallVector<unsigned, 4> numDisjunctions(numComponents, 0);
+  for (unsigned component = 0; component != numComponents; ++component) {
+    componentOrder.push_back(component);
+    for (auto &constraint : constraintBuckets[component])
+      if (constraint.getKind() == ConstraintKind::Disjunction)
+        ++numDisjunctions[component];
+  }
+  std::stable_sort(componentOrder.begin(), componentOrder.end(),
+                   [&](unsigned lhs, unsigned rhs) {
+    return numDisjunctions[lhs] < numDisjunctions[rhs];
+  });
+
   // Compute the partial solutions produced for each connected component.
   std::unique_ptr<SmallVector<Solution, 4>[]> 
     partialSolutions(new SmallVector<Solution, 4>[numComponents]);
   Optional<Score> PreviousBestScore = solverState->BestScore;
-  for (unsigned component = 0; component != numComponents; ++component) {
+  for (unsigned component : componentOrder) {
     assert(InactiveConstraints.empty() && 
            "Some constraints were not transferred?");
     ++solverState->NumComponentsSplit;
@@ -2146,6 +2186,78 @@ static bool shortCircuitDisjunctionAt(Constraint *constraint,
   return false;
 }
 
+/// If \p disjunction chooses an overload of an operator whose argument
+/// types are already known, returns the type of the argument tuple.
+static Type getResolvedOperatorArgumentType(ConstraintSystem &cs,
+                                            Constraint *disjunction) {
+  auto choices = disjunction->getNestedConstraints();
+  if (choices.empty() ||
+      choices.front()->getKind() != ConstraintKind::BindOverload ||
+      choices.front()->getOverloadChoice().getKind() != OverloadChoiceKind::Decl
+      || !choices.front()->getOverloadChoice().getDecl()->isOperator())
+    return Type();
+
+  auto fnTypeVar = choices.front()->getFirstType()->getAs<TypeVariableType>();
+  if (!fnTypeVar)
+    return Type();
+  fnTypeVar = cs.getRepresentative(fnTypeVar);
+
+  // Find the application of the operator.
+  SmallVector<Constraint *, 8> constraints;
+  cs.getConstraintGraph().gatherConstraints(fnTypeVar, constraints);
+  for (auto constraint : constraints) {
+    if (constraint->getKind() != ConstraintKind::ApplicableFunction)
+      continue;
+    auto calleeTypeVar = constraint->getSecondType()->getAs<TypeVariableType>();
+    if (!calleeTypeVar || cs.getRepresentative(calleeTypeVar) != fnTypeVar)
+      continue;
+
+    auto argType = cs.simplifyType(
+        constraint->getFirstType()->castTo<FunctionType>()->getInput());
+    if (argType->hasTypeVariable() || argType->hasUnresolvedType() ||
+        argType->hasError() || argType->hasLValueType() ||
+        argType->hasArchetype() || argType->hasOpenedExistential())
+      return Type();
+    return argType;
+  }
+
+  return Type();
+}
+
+/// Returns false if the overload \p decl certainly can't be applied to
+/// arguments of type \p argType.
+///
+/// Only non-generic global operators are checked; for anything else, the
+/// answer depends on more than the argument types.
+static bool isOperatorOverloadViable(TypeChecker &tc, DeclContext *dc,
+                                     ValueDecl *decl, Type argType) {
+  auto fn = dyn_cast<FuncDecl>(decl);
+  if (!fn || !fn->getDeclContext()->isModuleScopeContext() ||
+      !fn->hasType() || !fn->getInterfaceType()->is<FunctionType>())
+    return true;
+
+  auto key = std::make_pair(decl, argType->getCanonicalType().getPointer());
+  auto known = tc.operatorOverloadViabilityCache.find(key);
+  if (known != tc.operatorOverloadViabilityCache.end())
+    return known->second;
+
+  // Autoclosure and inout parameters are matched specially when the operator
+  // is applied, so leave them to the solver.
+  Type paramType = fn->getInterfaceType()->castTo<FunctionType>()->getInput();
+  bool viable = true;
+  if (!paramType->hasError() &&
+      !paramType.findIf([](Type type) {
+        return type->is<AnyFunctionType>() || type->is<InOutType>();
+      })) {
+    viable = tc.typesSatisfyConstraint(argType, paramType,
+                                       ConstraintKind::ArgumentTupleConversion,
+                                       dc);
+  }
+
+  tc.operatorOverloadViabilityCache[key] = viable;
+  return viable;
+}
+
 bool ConstraintSystem::solveSimplified(
        SmallVectorImpl<Solution> &solutions,
        FreeTypeVariableBinding allowFreeTypeVariables) {
@@ -2253,13 +2365,36 @@ bool ConstraintSystem::solveSimplified(
   auto afterDisjunction = InactiveConstraints.erase(disjunction);
   CG.removeConstraint(disjunction);
 
+  // If this picks an operator overload for arguments whose types are known,
+  // overloads that can't accept those types don't need to be tried. When
+  // recording fixes, they are still tried so that they can be diagnosed.
+  Type operatorArgType;
+  if (!solverState->recordFixes)
+    operatorArgType = getResolvedOperatorArgumentType(*this, disjunction);
+
   // Try each of the constraints within the disjunction.
   Constraint *firstSolvedConstraint = nullptr;
   ++solverState->NumDisjunctions;
+  Optional<unsigned> profileIndex;
+  if (Profile) {
+    profileIndex = Profile->Disjunctions.size();
+    Profile->Disjunctions.push_back({disjunction->getLocator(),
+                                     solverState->depth, 0});
+  }
   auto constraints = disjunction->getNestedConstraints();
   for (auto index : indices(constraints)) {
     auto constraint = constraints[index];
 
+    if (operatorArgType &&
+        constraint->getKind() == ConstraintKind::BindOverload &&
+        constraint->getOverloadChoice().getKind() == OverloadChoiceKind::Decl &&
+        !isOperatorOverloadViable(TC, DC,
+                                  constraint->getOverloadChoice().getDecl(),
+                                  operatorArgType)) {
+      ++solverState->NumDisjunctionTermsSkipped;
+      continue;
+    }
+
     // We already have a solution; check whether we should
     // short-circuit the disjunction.
     if (firstSolvedConstraint &&
@@ -2273,6 +2408,8 @@ bool ConstraintSystem::solveSimplified(
     // Try to solve the system with this option in the disjunction.
     SolverScope scope(*this);
     ++solverState->NumDisjunctionTerms;
+    if (profileIndex)
+      ++Profile->Disjunctions[*profileIndex].NumTermsAttempted;
     if (TC.getLangOpts().DebugConstraintSolver) {
       auto &log = getASTContext().TypeCheckerDebug->getStream();
       log.indent(solverState->depth)
@@ -2351,3 +2488,133 @@ bool ConstraintSystem::solveSimplified(
 
   return !firstSolvedConstraint;
 }
+
+namespace {
+  /// The JSON form of a ConstraintSystem::SolverProfile.
+  struct ProfileOutput {
+    struct TypeVariable {
+      std::string Name;
+      std::string Locator;
+      unsigned BindingAttempts;
+    };
+
+    struct Disjunction {
+      std::string Locator;
+      unsigned Depth;
+      unsigned TermsAttempted;
+    };
+
+    std::string Location;
+    ConstraintSystem::SolverStatistics Statistics;
+    std::vector<TypeVariable> TypeVariables;
+    std::vector<Disjunction> Disjunctions;
+    unsigned ScopesPushed;
+    unsigned ScopesPopped;
+    unsigned MaxScopeDepth;
+  };
+}
+
+namespace swift {
+namespace json {
+  template<>
+  struct ObjectTraits<ConstraintSystem::SolverStatistics> {
+    static void mapping(Output &out,
+                        ConstraintSystem::SolverStatistics &value) {
+      #define CS_STATISTIC(Name, Description) \
+        out.mapRequired(#Name, value.Name);
+      #include "ConstraintSolverStats.def"
+    }
+  };
+
+  template<>
+  struct ObjectTraits<ProfileOutput::TypeVariable> {
+    static void mapping(Output &out, ProfileOutput::TypeVariable &value) {
+      out.mapRequired("name", value.Name);
+      out.mapRequired("locator", value.Locator);
+      out.mapRequired("binding-attempts", value.BindingAttempts);
+    }
+  };
+
+  template<>
+  struct ObjectTraits<ProfileOutput::Disjunction> {
+    static void mapping(Output &out, ProfileOutput::Disjunction &value) {
+      out.mapRequired("locator", value.Locator);
+      out.mapRequired("depth", value.Depth);
+      out.mapRequired("terms-attempted", value.TermsAttempted);
+    }
+  };
+
+  template<typename T>
+  struct ArrayTraits<std::vector<T>> {
+    static size_t size(Output &out, std::vector<T> &seq) {
+      return seq.size();
+    }
+
+    static T &element(Output &out, std::vector<T> &seq, size_t index) {
+      if (index >= seq.size())
+        seq.resize(index+1);
+      return seq[index];
+    }
+  };
+
+  template<>
+  struct ObjectTraits<ProfileOutput> {
+    static void mapping(Output &out, ProfileOutput &value) {
+      out.mapRequired("location", value.Location);
+      out.mapRequired("statistics", value.Statistics);
+      out.mapRequired("scopes-pushed", value.ScopesPushed);
+      out.mapRequired("scopes-popped", value.ScopesPopped);
+      out.mapRequired("max-scope-depth", value.MaxScopeDepth);
+      out.mapRequired("type-variables", value.TypeVariables);
+      out.mapRequired("disjunctions", value.Disjunctions);
+    }
+  };
+}
+}
+
+/// Describes \p locator without its address, so that profiles of the same
+/// expression can be compared.
+static std::string describeLocator(ConstraintLocator *locator,
+                                   SourceManager &SM) {
+  if (!locator)
+    return std::string();
+
+  std::string result;
+  llvm::raw_string_ostream out(result);
+  locator->dump(&SM, out);
+  out.flush();
+  return result.substr(result.find('['));
+}
+
+void ConstraintSystem::printProfile(raw_ostream &out, SourceRange range) {
+  assert(Profile && "no profile was collected");
+  auto &SM = getASTContext().SourceMgr;
+
+  ProfileOutput output;
+  {
+    llvm::raw_string_ostream locOut(output.Location);
+    range.Start.print(locOut, SM);
+  }
+  output.Statistics = TotalSolverStats;
+  for (const auto &entry : Profile->BindingAttempts) {
+    output.TypeVariables.push_back({
+      entry.first->getString(),
+      describeLocator(entry.first->getImpl().getLocator(), SM),
+      entry.second
+    });
+  }
+  for (const auto &disjunction : Profile->Disjunctions) {
+    output.Disjunctions.push_back({
+      describeLocator(disjunction.Locator, SM),
+      disjunction.Depth,
+      disjunction.NumTermsAttempted
+    });
+  }
+  output.ScopesPushed = Profile->NumScopesPushed;
+  output.ScopesPopped = Profile->NumScopesPopped;
+  output.MaxScopeDepth = Profile->MaxScopeDepth;
+
+  json::Output jsonOut(out);
+  jsonOut << output;
+  out << "\n";
+}
@@ -32,12 +32,15 @@
 #include "swift/AST/Types.h"
 #include "swift/AST/TypeCheckerDebugConsumer.h"
 #include "llvm/ADT/ilist.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace swift {
 
@@ -1088,6 +1091,46 @@ private:
   };
 
 public:
+  /// The statistics of every solver state this system has had, added up.
+  struct SolverStatistics {
+    #define CS_STATISTIC(Name, Description) unsigned Name = 0;
+    #include "ConstraintSolverStats.def"
+  };
+  SolverStatistics TotalSolverStats;
+
+  /// Where the solver spent its effort on this system, for
+  /// -debug-constraints-profile-line.
+  struct SolverProfile {
+    /// A disjunction the solver explored.
+    struct Disjunction {
+      ConstraintLocator *Locator;
+
+      /// The number of solver scopes that were open when it was explored.
+      unsigned Depth;
+
+      /// The number of its terms that were tried.
+      unsigned NumTermsAttempted;
+    };
+
+    /// The number of bindings tried for each type variable, in the order the
+    /// type variables were first tried.
+    llvm::MapVector<TypeVariableType *, unsigned> BindingAttempts;
+
+    /// Every disjunction explored, in the order it was explored.
+    std::vector<Disjunction> Disjunctions;
+
+    unsigned NumScopesPushed = 0;
+    unsigned NumScopesPopped = 0;
+    unsigned MaxScopeDepth = 0;
+  };
+
+  /// If non-null, the solver records what it does in this profile.
+  std::unique_ptr<SolverProfile> Profile;
+
+  /// Prints \c Profile and \c TotalSolverStats as JSON, for the expression
+  /// at \p range.
+  void printProfile(raw_ostream &out, SourceRange range);
+
   /// \brief The current solver state.
   ///
   /// This will be non-null when we're actively solving the constraint
@@ -35,8 +35,10 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1470,6 +1472,101 @@ namespace {
   };
 }
 
+namespace {
+  /// Times the type-checking of an expression, and measures the memory the
+  /// solver used for it, for -debug-time-expression-type-checking,
+  /// -debug-expression-solver-memory and -warn-long-expression-type-checking.
+  class ExpressionTimer {
+    SourceRange Range;
+    ConstraintSystem &CS;
+    llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+    unsigned WarnLimit;
+    bool ShouldDump;
+    bool ShouldDumpMemory;
+
+  public:
+    ExpressionTimer(Expr *E, ConstraintSystem &CS, bool shouldDump,
+                    bool shouldDumpMemory, unsigned warnLimit)
+        : Range(E->getSourceRange()), CS(CS), WarnLimit(warnLimit),
+          ShouldDump(shouldDump), ShouldDumpMemory(shouldDumpMemory) {}
+
+    ~ExpressionTimer() {
+      llvm::TimeRecord endTime = llvm::TimeRecord::getCurrentTime(false);
+
+      auto elapsed = endTime.getProcessTime() - StartTime.getProcessTime();
+      unsigned elapsedMS = static_cast<unsigned>(elapsed * 1000);
+
+      ASTContext &ctx = CS.getASTContext();
+
+      if (ShouldDump) {
+        // Round up to the nearest 100th of a millisecond.
+        llvm::errs() << llvm::format("%0.2f", ceil(elapsed * 100000) / 100)
+                     << "ms\t";
+        Range.Start.print(llvm::errs(), ctx.SourceMgr);
+        llvm::errs() << "\n";
+      }
+
+      if (ShouldDumpMemory) {
+        // The constraints, locators and type variables live in the system's
+        // allocator; the solver arena only counts its uniquing tables. This
+        // system's arena is still the current one.
+        size_t bytes = CS.getAllocator().getTotalMemory() +
+                       ctx.getSolverMemory();
+        llvm::errs() << bytes << " bytes\t";
+        Range.Start.print(llvm::errs(), ctx.SourceMgr);
+        llvm::errs() << "\n";
+      }
+
+      if (WarnLimit == 0 || elapsedMS < WarnLimit)
+        return;
+
+      ctx.Diags.diagnose(Range.Start, diag::debug_long_expression,
+                         elapsedMS, WarnLimit)
+        .highlight(Range);
+
+      // List what the solver did, leaving out what it didn't do at all.
+      SmallString<128> stats;
+      llvm::raw_svector_ostream out(stats);
+      auto addStatistic = [&](unsigned value, StringRef description) {
+        if (value == 0)
+          return;
+        if (!stats.empty())
+          out << ", ";
+        if (description.startswith("# of "))
+          description = description.drop_front(5);
+        out << value << " " << description;
+      };
+      #define CS_STATISTIC(Name, Description) \
+        addStatistic(CS.TotalSolverStats.Name, Description);
+      #include "ConstraintSolverStats.def"
+
+      if (!stats.empty())
+        ctx.Diags.diagnose(Range.Start,
+                           diag::debug_long_expression_solver_stats,
+                           stats.str());
+    }
+  };
+}
+
+namespace {
+  /// Dumps the profile the solver collected for an expression, for
+  /// -debug-constraints-profile-line.
+  class SolverProfileDumper {
+    SourceRange Range;
+    ConstraintSystem &CS;
+
+  public:
+    SolverProfileDumper(Expr *E, ConstraintSystem &CS)
+        : Range(E->getSourceRange()), CS(CS) {
+      CS.Profile.reset(new ConstraintSystem::SolverProfile());
+    }
+
+    ~SolverProfileDumper() {
+      CS.printProfile(llvm::errs(), Range);
+    }
+  };
+}
+
 #pragma mark High-level entry points
 bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       TypeLoc convertType,
@@ -1485,6 +1582,24 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
     csOptions |= ConstraintSystemFlags::PreferForceUnwrapToOptional;
   ConstraintSystem cs(*this, dc, csOptions);
   cs.baseCS = baseCS;
+
+  // Expressions checked again while diagnosing failures are already counted
+  // as part of the expression being diagnosed.
+  Optional<ExpressionTimer> timer;
+  if ((DebugTimeExpressions || DebugSolverMemory || WarnLongExpressions) &&
+      !options.contains(TypeCheckExprFlags::SuppressDiagnostics))
+    timer.emplace(expr, cs, DebugTimeExpressions, DebugSolverMemory,
+                  WarnLongExpressions);
+
+  Optional<SolverProfileDumper> profileDumper;
+  if (unsigned line = getLangOpts().DebugConstraintSolverProfileLine) {
+    SourceLoc startLoc = expr->getStartLoc();
+    if (startLoc.isValid() &&
+        Context.SourceMgr.getLineAndColumn(startLoc).first == line &&
+        !options.contains(TypeCheckExprFlags::SuppressDiagnostics))
+      profileDumper.emplace(expr, cs);
+  }
+
   CleanupIllFormedExpressionRAII cleanup(Context, expr);
   ExprCleanser cleanup2(expr);
 
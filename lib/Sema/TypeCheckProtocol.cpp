@@ -1092,6 +1092,30 @@ static bool isBetterMatch(TypeChecker &tc, DeclContext *dc,
   return false;
 }
 
+/// Look up the members named \p name of \p adoptee, as seen from \p dc,
+/// that might witness a requirement.
+static SmallVector<ValueDecl *, 4>
+lookupWitnessCandidates(TypeChecker &tc, DeclContext *dc, Type adoptee,
+                        DeclName name) {
+  auto key = std::make_pair(
+      std::make_pair(dc, adoptee->getCanonicalType().getPointer()), name);
+  auto known = tc.valueWitnessCandidateCache.find(key);
+  if (known != tc.valueWitnessCandidateCache.end())
+    return known->second;
+
+  auto lookupOptions = defaultMemberTypeLookupOptions;
+  lookupOptions -= NameLookupFlags::PerformConformanceCheck;
+
+  SmallVector<ValueDecl *, 4> candidates;
+  for (auto candidate : tc.lookupMember(dc, adoptee, name, lookupOptions))
+    candidates.push_back(candidate);
+
+  // Don't remember failed lookups; the member may be derived later.
+  if (!candidates.empty())
+    tc.valueWitnessCandidateCache[key] = candidates;
+  return candidates;
+}
+
 SmallVector<ValueDecl *, 4> 
 WitnessChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
   assert(!isa<AssociatedTypeDecl>(req) && "Not for lookup for type witnesses*");
@@ -1111,23 +1135,14 @@ WitnessChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
     }
   } else {
     // Variable/function/subscript requirements.
-    auto lookupOptions = defaultMemberTypeLookupOptions;
-    lookupOptions -= NameLookupFlags::PerformConformanceCheck;
-
-    auto candidates = TC.lookupMember(DC, Adoptee, req->getFullName(),
-                                      lookupOptions);
+    witnesses = lookupWitnessCandidates(TC, DC, Adoptee, req->getFullName());
 
     // If we didn't find anything with the appropriate name, look
     // again using only the base name.
-    if (candidates.empty() && ignoringNames) {
-      candidates = TC.lookupMember(DC, Adoptee, req->getName(),
-                                   lookupOptions);
+    if (witnesses.empty() && ignoringNames) {
+      witnesses = lookupWitnessCandidates(TC, DC, Adoptee, req->getName());
       *ignoringNames = true;
     }
-
-    for (auto candidate : candidates) {
-      witnesses.push_back(candidate);
-    }
   }
 
   return witnesses;
@@ -394,6 +394,36 @@ void TypeChecker::bindExtension(ExtensionDecl *ext) {
   ::bindExtensionDecl(ext, *this);
 }
 
+/// Determine whether binding an extension can wait until the extensions of
+/// the type it names are first needed, and if so, the name to key it on.
+static Identifier getLazyExtensionBindingKey(ExtensionDecl *ED,
+                                             TypeChecker &TC) {
+  // Conformances are also needed after type checking is over, when there is
+  // no longer a type checker to bind the extension.
+  if (!ED->getInherited().empty())
+    return Identifier();
+
+  auto ident = dyn_cast_or_null<SimpleIdentTypeRepr>(
+                 ED->getExtendedTypeLoc().getTypeRepr());
+  if (!ident)
+    return Identifier();
+
+  // The extension will only be found again through a nominal type with the
+  // same name, so a typealias or anything else has to be bound now.
+  Identifier name = ident->getIdentifier();
+  UnqualifiedLookup lookup(name, ED->getModuleScopeContext(), &TC,
+                           /*IsKnownPrivate=*/true, SourceLoc(),
+                           /*IsTypeLookup=*/true);
+  if (!lookup.isSuccess())
+    return Identifier();
+  for (const auto &result : lookup.Results) {
+    auto nominal = dyn_cast<NominalTypeDecl>(result.getValueDecl());
+    if (!nominal || nominal->getName() != name)
+      return Identifier();
+  }
+  return name;
+}
+
 static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
   unsigned currentFunctionIdx = 0;
   unsigned currentExternalDef = TC.Context.LastCheckedExternalDefinition;
@@ -541,7 +571,8 @@ void swift::typeCheckExternalDefinitions(SourceFile &SF) {
 void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                                 OptionSet<TypeCheckingFlags> Options,
                                 unsigned StartElem,
-                                unsigned WarnLongFunctionBodies) {
+                                unsigned WarnLongFunctionBodies,
+                                unsigned WarnLongExpressions) {
   if (SF.ASTStage == SourceFile::TypeChecked)
     return;
 
@@ -563,6 +594,12 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
       TC.enableDebugTimeFunctionBodies();
 
+    TC.setWarnLongExpressions(WarnLongExpressions);
+    if (Options.contains(TypeCheckingFlags::DebugTimeExpressions))
+      TC.enableDebugTimeExpressions();
+    if (Options.contains(TypeCheckingFlags::DebugSolverMemory))
+      TC.enableDebugSolverMemory();
+
     if (Options.contains(TypeCheckingFlags::ForImmediateMode))
       TC.setInImmediateMode(true);
     
@@ -583,16 +620,33 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     // extensions, so we'll need to be smarter here.
     // FIXME: The current source file needs to be handled specially, because of
     // private extensions.
+    // With lazy extension binding, extensions in other files are only
+    // bound once the extensions of their nominal type are asked for.
+    bool lazyBinding = Ctx.LangOpts.EnableLazyExtensionBinding;
     SF.forAllVisibleModules([&](Module::ImportedModule import) {
       // FIXME: Respect the access path?
       for (auto file : import.second->getFiles()) {
-        auto SF = dyn_cast<SourceFile>(file);
-        if (!SF)
+        auto otherSF = dyn_cast<SourceFile>(file);
+        if (!otherSF)
           continue;
 
-        for (auto D : SF->Decls) {
-          if (auto ED = dyn_cast<ExtensionDecl>(D))
-            bindExtensionDecl(ED, TC);
+        for (auto D : otherSF->Decls) {
+          auto ED = dyn_cast<ExtensionDecl>(D);
+          if (!ED)
+            continue;
+
+          if (lazyBinding && otherSF != &SF && !ED->getExtendedType()) {
+            Identifier key = getLazyExtensionBindingKey(ED, TC);
+            if (!key.empty()) {
+              auto &unbound = Ctx.UnboundExtensions[key];
+              if (std::find(unbound.begin(), unbound.end(), ED) ==
+                    unbound.end())
+                unbound.push_back(ED);
+              continue;
+            }
+          }
+
+          bindExtensionDecl(ED, TC);
         }
       }
     });
@@ -660,6 +714,21 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
   }
 }
 
+void swift::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
+  auto &Ctx = AFD->getASTContext();
+  TypeChecker TC(Ctx);
+  SharedTimer timer("Type checking / Semantic analysis");
+
+  {
+    PrettyStackTraceDecl StackEntry("type-checking", AFD);
+    TC.typeCheckAbstractFunctionBody(AFD);
+  }
+  AFD->setBodyTypeCheckedIfPresent();
+
+  // Check any local functions the body defined.
+  typeCheckFunctionsAndExternalDecls(TC);
+}
+
 void swift::finishTypeChecking(SourceFile &SF) {
   auto &Ctx = SF.getASTContext();
   TypeChecker TC(Ctx);
@@ -506,6 +506,18 @@ public:
   // Caches whether a given declaration is "as specialized" as another.
   llvm::DenseMap<std::pair<ValueDecl*, ValueDecl*>, bool> 
     specializedOverloadComparisonCache;
+
+  // Caches whether a non-generic operator can be applied to arguments of a
+  // given type, so that the solver can skip overloads that can't.
+  llvm::DenseMap<std::pair<ValueDecl*, TypeBase*>, bool>
+    operatorOverloadViabilityCache;
+
+  // Caches the members found by looking up a requirement's name in a
+  // conforming type from a given context, since conformances of the same type
+  // to related protocols look for witnesses with many of the same names.
+  llvm::DenseMap<std::pair<std::pair<DeclContext*, TypeBase*>, DeclName>,
+                 SmallVector<ValueDecl *, 4>>
+    valueWitnessCandidateCache;
   
   // We delay validation of C and Objective-C type-bridging functions in the
   // standard library until we encounter a declaration that requires one. This
@@ -645,6 +657,20 @@ private:
   /// to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If non-zero, warn when an expression takes longer than this many
+  /// milliseconds to type-check.
+  ///
+  /// Intended for debugging purposes only.
+  unsigned WarnLongExpressions = 0;
+
+  /// If true, the time it takes to type-check each expression will be dumped
+  /// to llvm::errs().
+  bool DebugTimeExpressions = false;
+
+  /// If true, the memory the constraint solver used for each expression will
+  /// be dumped to llvm::errs().
+  bool DebugSolverMemory = false;
+
   /// Indicate that the type checker is checking code that will be
   /// immediately executed. This will suppress certain warnings
   /// when executing scripts.
@@ -675,6 +701,26 @@ public:
     WarnLongFunctionBodies = timeInMS;
   }
 
+  /// Dump the time it takes to type-check each expression to llvm::errs().
+  void enableDebugTimeExpressions() {
+    DebugTimeExpressions = true;
+  }
+
+  /// Dump the memory the constraint solver used for each expression to
+  /// llvm::errs().
+  void enableDebugSolverMemory() {
+    DebugSolverMemory = true;
+  }
+
+  /// If \p timeInMS is non-zero, warn when an expression takes longer than
+  /// this many milliseconds to type-check, and list what the constraint solver
+  /// did for it.
+  ///
+  /// Intended for debugging purposes only.
+  void setWarnLongExpressions(unsigned timeInMS) {
+    WarnLongExpressions = timeInMS;
+  }
+
   bool getInImmediateMode() {
     return InImmediateMode;
   }
@@ -17,6 +17,7 @@
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/GenericEnvironment.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/Defer.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Serialization/BCReadingExtras.h"
@@ -568,6 +569,12 @@ NormalProtocolConformance *ModuleFile::readNormalConformance(
     return conformanceEntry.get();
   }
 
+  DeserializationTimer timer(Stats ? &Stats->ConformanceTime : nullptr);
+  ASTAllocationSourceRAII allocationSource(getContext(),
+                                           ASTAllocationSource::Deserialized);
+  if (Stats)
+    ++Stats->NumConformances;
+
   using namespace decls_block;
 
   // Find the conformance record.
@@ -1877,6 +1884,17 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
   if (declOrOffset.isComplete())
     return declOrOffset;
 
+  DeserializationTimer timer(Stats ? &Stats->DeclTime : nullptr);
+  ASTAllocationSourceRAII allocationSource(getContext(),
+                                           ASTAllocationSource::Deserialized);
+  SWIFT_DEFER {
+    if (Stats) {
+      ++Stats->NumDecls;
+      if (declOrOffset.isComplete())
+        Stats->recordDecl(declOrOffset.get(), timer.getElapsed());
+    }
+  };
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(declOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -3409,6 +3427,12 @@ Type ModuleFile::getType(TypeID TID) {
   if (typeOrOffset.isComplete())
     return typeOrOffset;
 
+  DeserializationTimer timer(Stats ? &Stats->TypeTime : nullptr);
+  ASTAllocationSourceRAII allocationSource(getContext(),
+                                           ASTAllocationSource::Deserialized);
+  if (Stats)
+    ++Stats->NumTypes;
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(typeOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -4148,6 +4172,29 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   }
 }
 
+Optional<TinyPtrVector<ValueDecl *>>
+ModuleFile::loadNamedMembers(const IterableDeclContext *IDC, Identifier N,
+                             uint64_t contextData) {
+  if (!DeclMemberNames)
+    return None;
+
+  // Protocols also read their default witness table when loading members.
+  if (isa<ProtocolDecl>(IDC))
+    return None;
+
+  TinyPtrVector<ValueDecl *> results;
+  auto known = DeclMemberNames->find({N, contextData});
+  if (known == DeclMemberNames->end())
+    return results;
+
+  for (DeclID ID : *known) {
+    Decl *member = getDecl(ID);
+    if (auto *VD = dyn_cast_or_null<ValueDecl>(member))
+      results.push_back(VD);
+  }
+  return results;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                           SmallVectorImpl<ProtocolConformance*> &conformances) {
@@ -0,0 +1,175 @@
+//===--- DeserializationStats.cpp - What each module file loaded ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Serialization/DeserializationStats.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/Module.h"
+#include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/Statistics.h"
+#include "swift/Serialization/ModuleFile.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace swift;
+using namespace swift::serialization;
+
+static bool StatsEnabled = false;
+static unsigned NumExpensiveDeclsToKeep = 0;
+
+/// The innermost timer that is running on this thread.
+static LLVM_THREAD_LOCAL DeserializationTimer *CurrentTimer = nullptr;
+
+DeserializationStats::DeserializationStats()
+  : ExpensiveDecls(std::max(NumExpensiveDeclsToKeep, 1u)) {}
+
+void DeserializationStats::enable(unsigned NumExpensiveDecls) {
+  StatsEnabled = true;
+  NumExpensiveDeclsToKeep = NumExpensiveDecls;
+}
+
+bool DeserializationStats::isEnabled() {
+  return StatsEnabled;
+}
+
+void DeserializationStats::recordDecl(const Decl *D, uint64_t Elapsed) {
+  if (!D || NumExpensiveDeclsToKeep == 0)
+    return;
+  ExpensiveDecls.insert(-static_cast<int64_t>(Elapsed), std::move(D));
+}
+
+DeserializationTimer::DeserializationTimer(uint64_t *Total) : Total(Total) {
+  if (!Total)
+    return;
+  Parent = CurrentTimer;
+  CurrentTimer = this;
+  Start = Clock::now();
+}
+
+uint64_t DeserializationTimer::getElapsed() const {
+  if (!Total)
+    return 0;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           Clock::now() - Start).count();
+}
+
+DeserializationTimer::~DeserializationTimer() {
+  if (!Total)
+    return;
+  uint64_t Elapsed = getElapsed();
+  *Total += Elapsed - std::min(Elapsed, NestedTime);
+  if (Parent)
+    Parent->NestedTime += Elapsed;
+  CurrentTimer = Parent;
+}
+
+static void printMillis(raw_ostream &OS, uint64_t Nanos, unsigned Width) {
+  OS << llvm::format("%*.3f", static_cast<int>(Width), Nanos / 1e6);
+}
+
+void swift::serialization::printDeserializationStats(ASTContext &Ctx,
+                                                     raw_ostream &OS) {
+  struct ModuleStats {
+    StringRef Name;
+    const DeserializationStats *Stats;
+  };
+  SmallVector<ModuleStats, 16> Modules;
+  for (auto &Loaded : Ctx.LoadedModules) {
+    for (auto *File : Loaded.second->getFiles()) {
+      auto *ASTFile = dyn_cast<SerializedASTFile>(File);
+      if (!ASTFile)
+        continue;
+      if (auto *Stats = ASTFile->getFile().getStats())
+        Modules.push_back({ Loaded.second->getName().str(), Stats });
+    }
+  }
+
+  std::stable_sort(Modules.begin(), Modules.end(),
+                   [](const ModuleStats &LHS, const ModuleStats &RHS) {
+    return LHS.Stats->getTotalTime() > RHS.Stats->getTotalTime();
+  });
+
+  OS << "===" << std::string(73, '-') << "===\n"
+     << std::string(27, ' ') << "Deserialization statistics\n"
+     << "===" << std::string(73, '-') << "===\n";
+  OS << llvm::format("%8s %8s %8s %8s %10s %10s %10s %10s  %s\n",
+                     "decls", "types", "confs", "sil-fns",
+                     "decl ms", "type ms", "conf ms", "sil ms", "module");
+
+  DeserializationStats Total;
+  for (auto &Module : Modules) {
+    auto &Stats = *Module.Stats;
+    OS << llvm::format("%8u %8u %8u %8u ", Stats.NumDecls, Stats.NumTypes,
+                       Stats.NumConformances, Stats.NumSILFunctions);
+    printMillis(OS, Stats.DeclTime, 10);
+    OS << ' ';
+    printMillis(OS, Stats.TypeTime, 10);
+    OS << ' ';
+    printMillis(OS, Stats.ConformanceTime, 10);
+    OS << ' ';
+    printMillis(OS, Stats.SILFunctionTime, 10);
+    OS << "  " << Module.Name << "\n";
+
+    for (auto &Entry : Stats.ExpensiveDecls) {
+      const Decl *D = Entry.Value;
+      Total.ExpensiveDecls.insert(Entry.Score, std::move(D));
+    }
+  }
+
+  if (Total.ExpensiveDecls.empty())
+    return;
+
+  OS << "\nMost expensive decls (ms, including everything they loaded):\n";
+  for (auto &Entry : Total.ExpensiveDecls) {
+    printMillis(OS, -Entry.Score, 10);
+    OS << "  " << Decl::getKindName(Entry.Value->getKind()) << ' ';
+    printDeclDescription(OS, Entry.Value, Ctx);
+  }
+}
+
+void swift::serialization::addDeserializationStatistics(ASTContext &Ctx) {
+  DeserializationStats Total;
+  unsigned NumModuleFiles = 0;
+  for (auto &Loaded : Ctx.LoadedModules) {
+    for (auto *File : Loaded.second->getFiles()) {
+      auto *ASTFile = dyn_cast<SerializedASTFile>(File);
+      if (!ASTFile)
+        continue;
+      ++NumModuleFiles;
+      auto *Stats = ASTFile->getFile().getStats();
+      if (!Stats)
+        continue;
+      Total.NumDecls += Stats->NumDecls;
+      Total.NumTypes += Stats->NumTypes;
+      Total.NumConformances += Stats->NumConformances;
+      Total.NumSILFunctions += Stats->NumSILFunctions;
+      Total.DeclTime += Stats->DeclTime;
+      Total.TypeTime += Stats->TypeTime;
+      Total.ConformanceTime += Stats->ConformanceTime;
+      Total.SILFunctionTime += Stats->SILFunctionTime;
+    }
+  }
+
+  stats::addCounter("Serialization", "NumModuleFilesLoaded", NumModuleFiles);
+  stats::addCounter("Serialization", "NumDeserializedDecls", Total.NumDecls);
+  stats::addCounter("Serialization", "NumDeserializedTypes", Total.NumTypes);
+  stats::addCounter("Serialization", "NumDeserializedConformances",
+                    Total.NumConformances);
+  stats::addCounter("Serialization", "NumDeserializedSILFunctions",
+                    Total.NumSILFunctions);
+  stats::addTime("Serialization", "Decls", Total.DeclTime);
+  stats::addTime("Serialization", "Types", Total.TypeTime);
+  stats::addTime("Serialization", "Conformances", Total.ConformanceTime);
+  stats::addTime("Serialization", "SILFunctions", Total.SILFunctionTime);
+}
@@ -24,6 +24,7 @@
 
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/OnDiskHashTable.h"
 
@@ -98,6 +99,43 @@ public:
   }
 };
 
+/// Used to deserialize entries in the on-disk side-effect summary table.
+class SILDeserializer::EffectsTableInfo {
+public:
+  using internal_key_type = StringRef;
+  using external_key_type = StringRef;
+  using data_type = StringRef;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) { return ID; }
+
+  external_key_type GetExternalKey(internal_key_type ID) { return ID; }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+};
+
 SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
                                  SerializedSILLoader::Callback *callback)
     : MF(MF), SILMod(M), Callback(callback) {
@@ -109,15 +147,26 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
     return;
 
   // Load any abbrev records at the start of the block.
-  SILCursor.advance();
+  auto first = SILCursor.advance();
+
+  // A module with compressed function bodies starts with the header needed
+  // to read them.
+  if (first.Kind == llvm::BitstreamEntry::Record) {
+    BCOffsetRAII restoreOffset(SILCursor);
+    SmallVector<uint64_t, 1> scratch;
+    StringRef blobData;
+    if (SILCursor.readRecord(first.ID, scratch, &blobData) ==
+          SIL_COMPRESSED_BODY_HEADER)
+      CompressedBodyHeader = blobData;
+  }
 
   llvm::BitstreamCursor cursor = SILIndexCursor;
   // We expect SIL_FUNC_NAMES first, then SIL_VTABLE_NAMES, then
-  // SIL_GLOBALVAR_NAMES, then SIL_WITNESS_TABLE_NAMES, and finally
-  // SIL_DEFAULT_WITNESS_TABLE_NAMES. But each one can be
-  // omitted if no entries exist in the module file.
+  // SIL_GLOBALVAR_NAMES, then SIL_WITNESS_TABLE_NAMES, then
+  // SIL_DEFAULT_WITNESS_TABLE_NAMES, and finally SIL_FUNC_EFFECTS. But each
+  // one can be omitted if no entries exist in the module file.
   unsigned kind = 0;
-  while (kind != sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES) {
+  while (kind != sil_index_block::SIL_FUNC_EFFECTS) {
     auto next = cursor.advance();
     if (next.Kind == llvm::BitstreamEntry::EndBlock)
       return;
@@ -132,11 +181,23 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
              kind == sil_index_block::SIL_VTABLE_NAMES ||
              kind == sil_index_block::SIL_GLOBALVAR_NAMES ||
              kind == sil_index_block::SIL_WITNESS_TABLE_NAMES ||
-             kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES)) &&
+             kind == sil_index_block::SIL_DEFAULT_WITNESS_TABLE_NAMES ||
+             kind == sil_index_block::SIL_FUNC_EFFECTS)) &&
          "Expect SIL_FUNC_NAMES, SIL_VTABLE_NAMES, SIL_GLOBALVAR_NAMES, \
-          SIL_WITNESS_TABLE_NAMES, or SIL_DEFAULT_WITNESS_TABLE_NAMES.");
+          SIL_WITNESS_TABLE_NAMES, SIL_DEFAULT_WITNESS_TABLE_NAMES, or \
+          SIL_FUNC_EFFECTS.");
     (void)prevKind;
 
+    // The side-effect summaries don't have an offsets record.
+    if (kind == sil_index_block::SIL_FUNC_EFFECTS) {
+      uint32_t tableOffset;
+      sil_index_block::ListLayout::readRecord(scratch, tableOffset);
+      auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+      EffectsTable.reset(SerializedEffectsTable::Create(
+          base + tableOffset, base + sizeof(uint32_t), base));
+      continue;
+    }
+
     if (kind == sil_index_block::SIL_FUNC_NAMES)
       FuncTable = readFuncTable(scratch, blobData);
     else if (kind == sil_index_block::SIL_VTABLE_NAMES)
@@ -343,6 +404,132 @@ SILGlobalVariable *SILDeserializer::getGlobalForReference(StringRef name) {
   return readGlobalVar(name);
 }
 
+/// Reads a function body from a decompressed copy that starts with the
+/// module's CompressedBodyHeader, using it in place of the deserializer's
+/// SILCursor while this exists.
+class SILDeserializer::CompressedBodyRAII {
+  SILDeserializer &Deserializer;
+  SmallVector<char, 0> Bytes;
+  llvm::BitstreamReader Reader;
+  Optional<llvm::BitstreamCursor> PrevSILBlockCursor;
+  bool Started = false;
+
+public:
+  CompressedBodyRAII(SILDeserializer &deserializer, SmallVector<char, 0> &&bytes)
+    : Deserializer(deserializer), Bytes(std::move(bytes)),
+      Reader(reinterpret_cast<const uint8_t *>(Bytes.begin()),
+             reinterpret_cast<const uint8_t *>(Bytes.end())) {}
+
+  CompressedBodyRAII(const CompressedBodyRAII &) = delete;
+  CompressedBodyRAII &operator=(const CompressedBodyRAII &) = delete;
+
+  /// Enters the SIL block in the header, which defines its abbreviations,
+  /// and switches to reading the body that follows.
+  ///
+  /// Returns false if the header is malformed.
+  bool start() {
+    llvm::BitstreamCursor cursor(Reader);
+    auto entry = cursor.advance();
+    if (entry.Kind != llvm::BitstreamEntry::SubBlock ||
+        entry.ID != SIL_BLOCK_ID || cursor.EnterSubBlock(SIL_BLOCK_ID))
+      return false;
+
+    entry = cursor.advance(AF_DontPopBlockAtEnd);
+    if (entry.Kind != llvm::BitstreamEntry::Record)
+      return false;
+    SmallVector<uint64_t, 1> scratch;
+    StringRef blobData;
+    if (cursor.readRecord(entry.ID, scratch, &blobData) != SIL_BODY_BOUNDARY)
+      return false;
+
+    PrevSILBlockCursor = std::move(Deserializer.SILBlockCursor);
+    Deserializer.SILBlockCursor = Deserializer.SILCursor;
+    Deserializer.SILCursor = cursor;
+    Started = true;
+    return true;
+  }
+
+  ~CompressedBodyRAII() {
+    if (!Started)
+      return;
+    Deserializer.SILCursor = *Deserializer.SILBlockCursor;
+    Deserializer.SILBlockCursor = std::move(PrevSILBlockCursor);
+  }
+};
+
+/// Makes the deserializer's SILCursor read the SIL block while this exists,
+/// if it is reading a compressed function body, so that other entities can be
+/// read while deserializing one.
+class SILDeserializer::SILBlockCursorRAII {
+  SILDeserializer &Deserializer;
+  Optional<llvm::BitstreamCursor> BodyCursor;
+  Optional<llvm::BitstreamCursor> BlockCursor;
+
+public:
+  explicit SILBlockCursorRAII(SILDeserializer &deserializer)
+    : Deserializer(deserializer) {
+    if (!Deserializer.SILBlockCursor)
+      return;
+    BodyCursor = Deserializer.SILCursor;
+    BlockCursor = std::move(Deserializer.SILBlockCursor);
+    Deserializer.SILBlockCursor = None;
+    Deserializer.SILCursor = *BlockCursor;
+  }
+
+  SILBlockCursorRAII(const SILBlockCursorRAII &) = delete;
+  SILBlockCursorRAII &operator=(const SILBlockCursorRAII &) = delete;
+
+  ~SILBlockCursorRAII() {
+    if (!BodyCursor)
+      return;
+    Deserializer.SILCursor = *BodyCursor;
+    Deserializer.SILBlockCursor = std::move(BlockCursor);
+  }
+};
+
+bool SILDeserializer::readCompressedBody(
+    std::unique_ptr<CompressedBodyRAII> &Body) {
+  if (CompressedBodyHeader.empty())
+    return true;
+
+  // A compressed body is preceded by a SIL_BODY_BOUNDARY record.
+  BCOffsetRAII restoreOffset(SILCursor);
+  auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
+  if (entry.Kind != llvm::BitstreamEntry::Record)
+    return true;
+  SmallVector<uint64_t, 4> scratch;
+  StringRef blobData;
+  if (SILCursor.readRecord(entry.ID, scratch, &blobData) != SIL_BODY_BOUNDARY)
+    return true;
+
+  entry = SILCursor.advance(AF_DontPopBlockAtEnd);
+  if (entry.Kind != llvm::BitstreamEntry::Record)
+    return false;
+  scratch.clear();
+  if (SILCursor.readRecord(entry.ID, scratch, &blobData) !=
+        SIL_COMPRESSED_BODY)
+    return false;
+
+  unsigned uncompressedSize;
+  SILCompressedBodyLayout::readRecord(scratch, uncompressedSize);
+
+  SmallVector<char, 0> bytes(CompressedBodyHeader.begin(),
+                             CompressedBodyHeader.end());
+  if (uncompressedSize == 0) {
+    bytes.append(blobData.begin(), blobData.end());
+  } else {
+    SmallVector<char, 0> body;
+    if (!llvm::zlib::isAvailable() ||
+        llvm::zlib::uncompress(blobData, body, uncompressedSize) !=
+          llvm::zlib::StatusOK)
+      return false;
+    bytes.append(body.begin(), body.end());
+  }
+
+  Body = llvm::make_unique<CompressedBodyRAII>(*this, std::move(bytes));
+  return Body->start();
+}
+
 /// Deserialize a SILFunction if it is not already deserialized. The input
 /// SILFunction can either be an empty declaration or null. If it is an empty
 /// declaration, we fill in the contents. If the input SILFunction is
@@ -361,6 +548,9 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
       (cacheEntry.isDeserialized() && declarationOnly))
     return cacheEntry.get();
 
+  DeserializationTimer timer(MF->Stats ? &MF->Stats->SILFunctionTime : nullptr);
+
+  SILBlockCursorRAII useSILBlock(*this);
   BCOffsetRAII restoreOffset(SILCursor);
   SILCursor.JumpToBit(cacheEntry.getOffset());
 
@@ -380,13 +570,13 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   DeclID clangNodeOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, numSpecAttrs, bodySize;
   ArrayRef<uint64_t> SemanticsIDs;
   // TODO: read fragile
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangNodeOwnerID,
-                                SemanticsIDs);
+                                numSpecAttrs, bodySize, funcTyID,
+                                clangNodeOwnerID, SemanticsIDs);
 
   if (funcTyID == 0) {
     DEBUG(llvm::dbgs() << "SILFunction typeID is 0.\n");
@@ -468,6 +658,17 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
     fn->setDebugScope(DS);
   }
 
+  // If the rest of the function is compressed, it has to be decompressed to
+  // read anything more than the fact that it has a body.
+  std::unique_ptr<CompressedBodyRAII> compressedBody;
+  if (!declarationOnly || numSpecAttrs != 0) {
+    if (!readCompressedBody(compressedBody)) {
+      DEBUG(llvm::dbgs() << "Invalid compressed body for SILFunction.\n");
+      MF->error();
+      return nullptr;
+    }
+  }
+
   // Read and instantiate the specialize attributes.
   while (numSpecAttrs--) {
     auto next = SILCursor.advance(AF_DontPopBlockAtEnd);
@@ -519,6 +720,8 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   }
 
   NumDeserializedFunc++;
+  if (MF->Stats)
+    ++MF->Stats->NumSILFunctions;
 
   assert(!(fn->getGenericEnvironment() && !fn->empty())
          && "function already has context generic params?!");
@@ -556,9 +759,10 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
 
   // Another SIL_FUNCTION record means the end of this SILFunction.
   // SIL_VTABLE or SIL_GLOBALVAR or SIL_WITNESS_TABLE record also means the end
-  // of this SILFunction.
+  // of this SILFunction, as does the SIL_BODY_BOUNDARY at the end of a
+  // compressed body.
   while (kind != SIL_FUNCTION && kind != SIL_VTABLE && kind != SIL_GLOBALVAR &&
-         kind != SIL_WITNESS_TABLE) {
+         kind != SIL_WITNESS_TABLE && kind != SIL_BODY_BOUNDARY) {
     if (kind == SIL_BASIC_BLOCK)
       // Handle a SILBasicBlock record.
       CurrentBB = readSILBasicBlock(fn, CurrentBB, scratch);
@@ -1913,6 +2117,7 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
     return cacheEntry.get()->getLinkage() == Linkage ||
            Linkage == SILLinkage::Private;
 
+  SILBlockCursorRAII useSILBlock(*this);
   BCOffsetRAII restoreOffset(SILCursor);
   SILCursor.JumpToBit(cacheEntry.getOffset());
 
@@ -1935,11 +2140,11 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
   DeclID clangOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, numSpecAttrs, bodySize;
   ArrayRef<uint64_t> SemanticsIDs;
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangOwnerID,
+                                numSpecAttrs, bodySize, funcTyID, clangOwnerID,
                                 SemanticsIDs);
   auto linkage = fromStableSILLinkage(rawLinkage);
   if (!linkage) {
@@ -1956,6 +2161,52 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
   return true;
 }
 
+/// Read the number of instructions in the serialized body of a function with
+/// a given name, without deserializing the function itself.
+/// This function is modeled after hasSILFunction.
+Optional<unsigned> SILDeserializer::getSILFunctionBodySize(StringRef Name) {
+  if (!FuncTable)
+    return None;
+  auto iter = FuncTable->find(Name);
+  if (iter == FuncTable->end())
+    return None;
+
+  auto FID = *iter;
+  auto &cacheEntry = Funcs[FID-1];
+
+  SILBlockCursorRAII useSILBlock(*this);
+  BCOffsetRAII restoreOffset(SILCursor);
+  SILCursor.JumpToBit(cacheEntry.getOffset());
+
+  auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
+  if (entry.Kind == llvm::BitstreamEntry::Error) {
+    DEBUG(llvm::dbgs() << "Cursor advance error in getSILFunctionBodySize.\n");
+    MF->error();
+    return None;
+  }
+
+  SmallVector<uint64_t, 64> scratch;
+  StringRef blobData;
+  unsigned kind = SILCursor.readRecord(entry.ID, scratch, &blobData);
+  assert(kind == SIL_FUNCTION && "expect a sil function");
+  (void)kind;
+
+  DeclID clangOwnerID;
+  TypeID funcTyID;
+  unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
+    inlineStrategy, effect, numSpecAttrs, bodySize;
+  ArrayRef<uint64_t> SemanticsIDs;
+  SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
+                                isThunk, isGlobal, inlineStrategy, effect,
+                                numSpecAttrs, bodySize, funcTyID, clangOwnerID,
+                                SemanticsIDs);
+
+  // A function without a body was serialized as a declaration.
+  if (bodySize == 0)
+    return None;
+  return bodySize;
+}
+
 
 SILFunction *SILDeserializer::lookupSILFunction(StringRef name,
                                                 bool declarationOnly) {
@@ -1989,6 +2240,7 @@ SILGlobalVariable *SILDeserializer::readGlobalVar(StringRef Name) {
   if (globalVarOrOffset.isComplete())
     return globalVarOrOffset;
 
+  SILBlockCursorRAII useSILBlock(*this);
   BCOffsetRAII restoreOffset(SILCursor);
   SILCursor.JumpToBit(globalVarOrOffset);
   auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
@@ -2068,6 +2320,7 @@ SILVTable *SILDeserializer::readVTable(DeclID VId) {
   if (vTableOrOffset.isComplete())
     return vTableOrOffset;
 
+  SILBlockCursorRAII useSILBlock(*this);
   BCOffsetRAII restoreOffset(SILCursor);
   SILCursor.JumpToBit(vTableOrOffset);
   auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
@@ -2160,6 +2413,7 @@ SILWitnessTable *SILDeserializer::readWitnessTable(DeclID WId,
   if (wTableOrOffset.isFullyDeserialized())
     return wTableOrOffset.get();
 
+  SILBlockCursorRAII useSILBlock(*this);
   BCOffsetRAII restoreOffset(SILCursor);
   SILCursor.JumpToBit(wTableOrOffset.getOffset());
   auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
@@ -2339,6 +2593,7 @@ readDefaultWitnessTable(DeclID WId, SILDefaultWitnessTable *existingWt) {
   if (wTableOrOffset.isFullyDeserialized())
     return wTableOrOffset.get();
 
+  SILBlockCursorRAII useSILBlock(*this);
   BCOffsetRAII restoreOffset(SILCursor);
   SILCursor.JumpToBit(wTableOrOffset.getOffset());
   auto entry = SILCursor.advance(AF_DontPopBlockAtEnd);
@@ -2450,6 +2705,23 @@ void SILDeserializer::getAllDefaultWitnessTables() {
     readDefaultWitnessTable(I + 1, nullptr);
 }
 
+Optional<StringRef> SILDeserializer::lookupEffectsSummary(StringRef Name) {
+  if (!EffectsTable)
+    return None;
+  auto iter = EffectsTable->find(Name);
+  if (iter == EffectsTable->end())
+    return None;
+  return *iter;
+}
+
+void SILDeserializer::getAllEffectsSummaries() {
+  if (!EffectsTable)
+    return;
+  for (auto KI = EffectsTable->key_begin(), KE = EffectsTable->key_end();
+       KI != KE; ++KI)
+    SILMod.setEffectsSummary(*KI, *EffectsTable->find(*KI));
+}
+
 SILDefaultWitnessTable *
 SILDeserializer::lookupDefaultWitnessTable(SILDefaultWitnessTable *existingWt) {
   assert(existingWt && "Cannot deserialize a null default witness table declaration.");
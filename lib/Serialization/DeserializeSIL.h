@@ -32,6 +32,18 @@ namespace swift {
     llvm::BitstreamCursor SILCursor;
     llvm::BitstreamCursor SILIndexCursor;
 
+    /// The start of a bitstream that defines the SIL block's abbreviations,
+    /// which compressed function bodies are appended to before reading them.
+    /// Empty if the module has no compressed bodies.
+    StringRef CompressedBodyHeader;
+
+    /// While a compressed function body is being read, SILCursor reads the
+    /// decompressed body, and this is the cursor for the SIL block.
+    Optional<llvm::BitstreamCursor> SILBlockCursor;
+
+    class CompressedBodyRAII;
+    class SILBlockCursorRAII;
+
     class FuncTableInfo;
     using SerializedFuncTable =
       llvm::OnDiskIterableChainedHashTable<FuncTableInfo>;
@@ -53,6 +65,13 @@ namespace swift {
     std::vector<ModuleFile::PartiallySerialized<SILDefaultWitnessTable *>>
     DefaultWitnessTables;
 
+    class EffectsTableInfo;
+    using SerializedEffectsTable =
+      llvm::OnDiskIterableChainedHashTable<EffectsTableInfo>;
+
+    /// Maps function names to their encoded side-effect summaries.
+    std::unique_ptr<SerializedEffectsTable> EffectsTable;
+
     /// A declaration will only
     llvm::DenseMap<NormalProtocolConformance *, SILWitnessTable *>
     ConformanceToWitnessTableMap;
@@ -76,6 +95,12 @@ namespace swift {
     SILFunction *readSILFunction(serialization::DeclID, SILFunction *InFunc,
                                  StringRef Name, bool declarationOnly,
                                  bool errorIfEmptyBody = true);
+    /// If the records after the SIL_FUNCTION record that SILCursor just read
+    /// are a compressed body, decompresses it and makes SILCursor read it
+    /// until \p Body is destroyed.
+    ///
+    /// Returns false if the compressed body can't be read.
+    bool readCompressedBody(std::unique_ptr<CompressedBodyRAII> &Body);
     /// Read a SIL basic block within a given SIL function.
     SILBasicBlock *readSILBasicBlock(SILFunction *Fn,
                                      SILBasicBlock *Prev,
@@ -119,6 +144,12 @@ public:
     SILFunction *lookupSILFunction(StringRef Name,
                                    bool declarationOnly = false);
     bool hasSILFunction(StringRef Name, SILLinkage Linkage);
+    /// Returns the number of instructions in the serialized body of the
+    /// function named \p Name, or None if it has no serialized body.
+    Optional<unsigned> getSILFunctionBodySize(StringRef Name);
+    /// Returns the encoded side-effect summary of the function named \p Name,
+    /// or None if the module didn't record one.
+    Optional<StringRef> lookupEffectsSummary(StringRef Name);
     SILVTable *lookupVTable(Identifier Name);
     SILWitnessTable *lookupWitnessTable(SILWitnessTable *wt);
     SILDefaultWitnessTable *
@@ -144,6 +175,7 @@ public:
       getAllVTables();
       getAllWitnessTables();
       getAllDefaultWitnessTables();
+      getAllEffectsSummaries();
     }
 
     /// Deserialize all SILFunctions inside the module and add them to SILMod.
@@ -159,6 +191,10 @@ public:
     /// to SILMod.
     void getAllDefaultWitnessTables();
 
+    /// Add all side-effect summaries inside the module to SILMod, so that
+    /// they are serialized again with it.
+    void getAllEffectsSummaries();
+
     SILDeserializer(ModuleFile *MF, SILModule &M,
                     SerializedSILLoader::Callback *callback);
 
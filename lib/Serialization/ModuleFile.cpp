@@ -14,6 +14,7 @@
 #include "swift/Serialization/ModuleFormat.h"
 #include "swift/Subsystems.h"
 #include "swift/AST/AST.h"
+#include "swift/AST/Mangle.h"
 #include "swift/AST/ModuleLoader.h"
 #include "swift/AST/NameLookup.h"
 #include "swift/AST/USRGeneration.h"
@@ -114,6 +115,9 @@ static bool readOptionsBlock(llvm::BitstreamCursor &cursor,
       options_block::ResilienceStrategyLayout::readRecord(scratch, Strategy);
       extendedInfo.setResilienceStrategy(ResilienceStrategy(Strategy));
       break;
+    case options_block::MERGED_INPUTS_HASH:
+      extendedInfo.setMergedInputsHash(blobData);
+      break;
     default:
       // Unknown options record, possibly for use by a future version of the
       // module format.
@@ -377,6 +381,65 @@ public:
   }
 };
 
+/// Used to deserialize entries in the on-disk extension hash table.
+class ModuleFile::ExtensionTableInfo {
+public:
+  using internal_key_type = StringRef;
+  using external_key_type = Identifier;
+  using data_type = SmallVector<std::tuple<uint8_t, StringRef, DeclID>, 4>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return ID.str();
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint32_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    const uint8_t *limit = data + length;
+    while (data < limit) {
+      uint8_t kind = *data++;
+      DeclID extensionID = endian::readNext<uint32_t, little, unaligned>(data);
+      unsigned nameLength = endian::readNext<uint16_t, little, unaligned>(data);
+      StringRef mangledName(reinterpret_cast<const char *>(data), nameLength);
+      data += nameLength;
+      result.push_back(std::make_tuple(kind, mangledName, extensionID));
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedExtensionTable>
+ModuleFile::readExtensionTable(ArrayRef<uint64_t> fields, StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclListLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedExtensionTable>;
+  return OwnedTable(SerializedExtensionTable::Create(base + tableOffset,
+    base + sizeof(uint32_t), base));
+}
+
 std::unique_ptr<ModuleFile::SerializedDeclTable>
 ModuleFile::readDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
   uint32_t tableOffset;
@@ -460,6 +523,67 @@ ModuleFile::readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                              base + sizeof(uint32_t), base));
 }
 
+/// Used to deserialize entries in the on-disk table of members by name.
+class ModuleFile::DeclMemberNamesTableInfo {
+public:
+  using internal_key_type = std::pair<StringRef, uint32_t>;
+  using external_key_type = std::pair<Identifier, uint32_t>;
+  using data_type = SmallVector<DeclID, 2>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return { ID.first.str(), ID.second };
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key.first, key.second);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    uint32_t membersOffset = endian::readNext<uint32_t, little, unaligned>(data);
+    return { StringRef(reinterpret_cast<const char *>(data),
+                       length - sizeof(uint32_t)),
+             membersOffset };
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    assert(length % sizeof(uint32_t) == 0 && "invalid length");
+    data_type result;
+    while (length > 0) {
+      result.push_back(endian::readNext<uint32_t, little, unaligned>(data));
+      length -= sizeof(uint32_t);
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedDeclMemberNamesTable>
+ModuleFile::readDeclMemberNamesTable(ArrayRef<uint64_t> fields,
+                                     StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclMemberNamesLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclMemberNamesTable>;
+  return OwnedTable(
+           SerializedDeclMemberNamesTable::Create(base + tableOffset,
+                                                  base + sizeof(uint32_t),
+                                                  base));
+}
+
 bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
   cursor.EnterSubBlock(INDEX_BLOCK_ID);
 
@@ -513,7 +637,7 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         PrecedenceGroupDecls = readDeclTable(scratch, blobData);
         break;
       case index_block::EXTENSIONS:
-        ExtensionDecls = readDeclTable(scratch, blobData);
+        ExtensionDecls = readExtensionTable(scratch, blobData);
         break;
       case index_block::CLASS_MEMBERS:
         ClassMembersByName = readDeclTable(scratch, blobData);
@@ -524,6 +648,9 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
       case index_block::OBJC_METHODS:
         ObjCMethods = readObjCMethodTable(scratch, blobData);
         break;
+      case index_block::DECL_MEMBER_NAMES:
+        DeclMemberNames = readDeclMemberNamesTable(scratch, blobData);
+        break;
       case index_block::ENTRY_POINT:
         assert(blobData.empty());
         setEntryPointClassID(scratch.front());
@@ -772,6 +899,9 @@ ModuleFile::ModuleFile(
   assert(getStatus() == Status::Valid);
   Bits.IsFramework = isFramework;
 
+  if (DeserializationStats::isEnabled())
+    Stats.reset(new DeserializationStats());
+
   PrettyModuleFileDeserialization stackEntry(*this);
 
   llvm::BitstreamCursor cursor{ModuleInputReader};
@@ -1351,12 +1481,36 @@ void ModuleFile::loadExtensions(NominalTypeDecl *nominal) {
   if (iter == ExtensionDecls->end())
     return;
 
+  // Only deserialize the extensions of this nominal, rather than of every
+  // nominal with the same name. The mangled name is only computed if there
+  // are extensions to tell apart.
+  Optional<std::string> mangledName;
   for (auto item : *iter) {
-    if (item.first == getKindForTable(nominal))
-      (void)getDecl(item.second);
+    if (std::get<0>(item) != getKindForTable(nominal))
+      continue;
+
+    StringRef extendedName = std::get<1>(item);
+    if (!extendedName.empty()) {
+      if (!mangledName)
+        mangledName = getExtendedNominalMangledName(nominal);
+      if (!mangledName->empty() && extendedName != *mangledName)
+        continue;
+    }
+
+    (void)getDecl(std::get<2>(item));
   }
 }
 
+std::string
+serialization::getExtendedNominalMangledName(const NominalTypeDecl *nominal) {
+  if (nominal->hasClangNode())
+    return std::string();
+
+  Mangle::Mangler mangler;
+  mangler.mangleNominalType(nominal);
+  return mangler.finalize();
+}
+
 void ModuleFile::loadObjCMethods(
        ClassDecl *classDecl,
        ObjCSelector selector,
@@ -1524,7 +1678,7 @@ void ModuleFile::getTopLevelDecls(SmallVectorImpl<Decl *> &results) {
   if (ExtensionDecls) {
     for (auto entry : ExtensionDecls->data()) {
       for (auto item : entry)
-        results.push_back(getDecl(item.second));
+        results.push_back(getDecl(std::get<2>(item)));
     }
   }
 }
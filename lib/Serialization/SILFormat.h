@@ -94,7 +94,8 @@ namespace sil_index_block {
     SIL_WITNESS_TABLE_NAMES,
     SIL_WITNESS_TABLE_OFFSETS,
     SIL_DEFAULT_WITNESS_TABLE_NAMES,
-    SIL_DEFAULT_WITNESS_TABLE_OFFSETS
+    SIL_DEFAULT_WITNESS_TABLE_OFFSETS,
+    SIL_FUNC_EFFECTS
   };
 
   using ListLayout = BCGenericRecordLayout<
@@ -103,6 +104,9 @@ namespace sil_index_block {
     BCBlob      // map from identifier strings to IDs.
   >;
 
+  /// SIL_FUNC_EFFECTS uses ListLayout too, but its blob maps function names
+  /// to their encoded side-effect summaries, and it has no offsets record.
+
   using OffsetLayout = BCGenericRecordLayout<
     BCFixed<4>,  // record ID
     BCArray<BitOffsetField>
@@ -143,6 +147,9 @@ namespace sil_block {
     SIL_DEFAULT_WITNESS_TABLE_NO_ENTRY,
     SIL_INST_WITNESS_METHOD,
     SIL_SPECIALIZE_ATTR,
+    SIL_BODY_BOUNDARY,
+    SIL_COMPRESSED_BODY,
+    SIL_COMPRESSED_BODY_HEADER,
 
     // We also share these layouts from the decls block. Their enumerators must
     // not overlap with ours.
@@ -245,6 +252,7 @@ namespace sil_block {
                      BCFixed<2>, // inlineStrategy
                      BCFixed<2>, // side effect info.
                      BCFixed<2>, // number of specialize attributes
+                     BCVBR<8>,   // number of instructions in the body
                      TypeIDField,// SILFunctionType
                      DeclIDField,// ClangNode owner
                      BCArray<IdentifierIDField> // Semantics Attribute
@@ -258,6 +266,31 @@ namespace sil_block {
                      // followed by bound generic substitutions
                      >;
 
+  // Written before and after a function body that is to be compressed, so
+  // that it starts and ends on a word boundary. The blob is always empty.
+  using SILBodyBoundaryLayout = BCRecordLayout<
+    SIL_BODY_BOUNDARY,
+    BCBlob
+  >;
+
+  // Replaces everything after a SIL_FUNCTION record, starting with its first
+  // SIL_BODY_BOUNDARY and ending with its second, when the module was built
+  // with -compress-serialized-sil.
+  using SILCompressedBodyLayout = BCRecordLayout<
+    SIL_COMPRESSED_BODY,
+    BCVBR<16>, // uncompressed size, or 0 if it is stored uncompressed
+    BCBlob     // the zlib-compressed records
+  >;
+
+  // The first record in a SIL block with compressed function bodies. The blob
+  // is the start of a bitstream that enters a SIL block, defines its
+  // abbreviations and ends with a SIL_BODY_BOUNDARY record, so that an
+  // uncompressed body can be read by appending it.
+  using SILCompressedBodyHeaderLayout = BCRecordLayout<
+    SIL_COMPRESSED_BODY_HEADER,
+    BCBlob
+  >;
+
   // Has an optional argument list where each argument is a typed valueref.
   using SILBasicBlockLayout = BCRecordLayout<
     SIL_BASIC_BLOCK,
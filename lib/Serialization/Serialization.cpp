@@ -45,6 +45,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
@@ -109,6 +110,54 @@ namespace {
     }
   };
 
+  /// Used to serialize the on-disk extension hash table.
+  class ExtensionTableInfo {
+  public:
+    using key_type = Identifier;
+    using key_type_ref = key_type;
+    using data_type = Serializer::ExtensionTableData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.empty());
+      return llvm::HashString(key.str());
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = key.str().size();
+      uint32_t dataLength = 0;
+      for (auto &entry : data) {
+        dataLength += 1 + sizeof(uint32_t) + sizeof(uint16_t);
+        dataLength += std::get<1>(entry).size();
+      }
+      // Popular types can have many extensions, so use a wider data length.
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint32_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto &entry : data) {
+        writer.write<uint8_t>(std::get<0>(entry));
+        writer.write<uint32_t>(std::get<2>(entry));
+        writer.write<uint16_t>(std::get<1>(entry).size());
+        out << std::get<1>(entry);
+      }
+    }
+  };
+
   class LocalDeclTableInfo {
   public:
     using key_type = std::string;
@@ -443,6 +492,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(options_block, IS_SIB);
   BLOCK_RECORD(options_block, IS_TESTABLE);
   BLOCK_RECORD(options_block, RESILIENCE_STRATEGY);
+  BLOCK_RECORD(options_block, MERGED_INPUTS_HASH);
 
   BLOCK(INPUT_BLOCK);
   BLOCK_RECORD(input_block, IMPORTED_MODULE);
@@ -475,6 +525,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
   BLOCK_RECORD(index_block, PRECEDENCE_GROUPS);
+  BLOCK_RECORD(index_block, DECL_MEMBER_NAMES);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -503,6 +554,9 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(sil_block, SIL_DEFAULT_WITNESS_TABLE_NO_ENTRY);
   BLOCK_RECORD(sil_block, SIL_INST_WITNESS_METHOD);
   BLOCK_RECORD(sil_block, SIL_SPECIALIZE_ATTR);
+  BLOCK_RECORD(sil_block, SIL_BODY_BOUNDARY);
+  BLOCK_RECORD(sil_block, SIL_COMPRESSED_BODY);
+  BLOCK_RECORD(sil_block, SIL_COMPRESSED_BODY_HEADER);
 
   // These layouts can exist in both decl blocks and sil blocks.
 #define BLOCK_RECORD_WITH_NAMESPACE(K, X) emitRecordID(Out, X, #X, nameBuffer)
@@ -542,6 +596,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(sil_index_block, SIL_WITNESS_TABLE_OFFSETS);
   BLOCK_RECORD(sil_index_block, SIL_DEFAULT_WITNESS_TABLE_NAMES);
   BLOCK_RECORD(sil_index_block, SIL_DEFAULT_WITNESS_TABLE_OFFSETS);
+  BLOCK_RECORD(sil_index_block, SIL_FUNC_EFFECTS);
 
 #undef BLOCK
 #undef BLOCK_RECORD
@@ -591,7 +646,7 @@ void Serializer::writeHeader(const SerializationOptions &options) {
     Target.emit(ScratchRecord, M->getASTContext().LangOpts.Target.str());
 
     {
-      llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 3);
+      llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 4);
 
       options_block::IsSIBLayout IsSIB(Out);
       IsSIB.emit(ScratchRecord, options.IsSIB);
@@ -606,6 +661,11 @@ void Serializer::writeHeader(const SerializationOptions &options) {
         Strategy.emit(ScratchRecord, unsigned(M->getResilienceStrategy()));
       }
 
+      if (!options.MergedInputsHash.empty()) {
+        options_block::MergedInputsHashLayout MergedInputsHash(Out);
+        MergedInputsHash.emit(ScratchRecord, options.MergedInputsHash);
+      }
+
       if (options.SerializeOptionsForDebugging) {
         options_block::SDKPathLayout SDKPath(Out);
         options_block::XCCLayout XCC(Out);
@@ -1236,6 +1296,8 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
   using namespace decls_block;
 
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
+  // The reader identifies this member list by where the record starts.
+  uint32_t membersOffset = Out.GetCurrentBitNo();
   SmallVector<DeclID, 16> memberIDs;
   for (auto member : members) {
     if (!shouldSerializeMember(member))
@@ -1244,6 +1306,11 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (auto VD = dyn_cast<ValueDecl>(member)) {
+      if (VD->hasName())
+        DeclMemberNames[{VD->getName(), membersOffset}].push_back(memberID);
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -3383,6 +3450,28 @@ static void writeDeclTable(const index_block::DeclListLayout &DeclList,
   DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
 }
 
+static void writeExtensionTable(const index_block::DeclListLayout &DeclList,
+                                const Serializer::ExtensionTable &table) {
+  if (table.empty())
+    return;
+
+  SmallVector<uint64_t, 8> scratch;
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::OnDiskChainedHashTableGenerator<ExtensionTableInfo> generator;
+    for (auto &entry : table)
+      generator.insert(entry.first, entry.second);
+
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+
+  DeclList.emit(scratch, index_block::EXTENSIONS, tableOffset, hashTableBlob);
+}
+
 static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
                                 index_block::RecordKind kind,
                                 LocalTypeHashTableGenerator &generator) {
@@ -3832,6 +3921,73 @@ namespace {
   };
 } // end anonymous namespace
 
+namespace {
+  /// Used to serialize the on-disk table of members by name.
+  class DeclMemberNamesTableInfo {
+  public:
+    using key_type = std::pair<Identifier, uint32_t>;
+    using key_type_ref = key_type;
+    using data_type = SmallVector<DeclID, 2>;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.first.empty());
+      // Seed the name's hash with the member list offset.
+      return llvm::HashString(key.first.str(), key.second);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(uint32_t) + key.first.str().size();
+      assert(keyLength <= std::numeric_limits<uint16_t>::max() &&
+             "member name too long");
+      uint32_t dataLength = sizeof(uint32_t) * data.size();
+      assert(dataLength <= std::numeric_limits<uint16_t>::max() &&
+             "too many members");
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little>(out).write<uint32_t>(key.second);
+      out << key.first.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto entry : data)
+        writer.write<uint32_t>(entry);
+    }
+  };
+} // end anonymous namespace
+
+static void
+writeDeclMemberNamesTable(const index_block::DeclMemberNamesLayout &out,
+                          const Serializer::DeclMemberNamesTable &table) {
+  llvm::OnDiskChainedHashTableGenerator<DeclMemberNamesTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+
+  SmallVector<uint64_t, 8> scratch;
+  out.emit(scratch, tableOffset, hashTableBlob);
+}
+
 static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
                                  Serializer::ObjCMethodTable &objcMethods) {
   // Collect all of the Objective-C selectors in the method table.
@@ -3917,9 +4073,125 @@ static void addOperatorsAndTopLevel(Serializer &S, Range members,
   }
 }
 
+static std::string hashForSummary(StringRef text) {
+  llvm::MD5 hash;
+  hash.update(text);
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  SmallString<32> resultStr;
+  llvm::MD5::stringifyResult(result, resultStr);
+  return resultStr.str();
+}
+
+static PrintOptions getSummaryPrintOptions() {
+  // Function bodies and comments aren't printed by default.
+  PrintOptions options;
+  options.PrintAccessibility = true;
+  options.PrintIfConfig = false;
+  return options;
+}
+
+static void printMembersForSummary(const IterableDeclContext *IDC,
+                                   const PrintOptions &options,
+                                   raw_ostream &out) {
+  // Members are printed in order, since the order of stored properties
+  // determines a type's layout. Private members are included for the same
+  // reason.
+  for (auto member : IDC->getMembers()) {
+    member->print(out, options);
+    out << '\n';
+    if (auto nestedIDC = dyn_cast<IterableDeclContext>(member)) {
+      out << "{\n";
+      printMembersForSummary(nestedIDC, options, out);
+      out << "}\n";
+    }
+  }
+}
+
+/// Adds the hashes of the interface of the top-level decl \p D to \p summary,
+/// if it is visible outside its module.
+static void addToSummary(ModuleSummary &summary, const Decl *D) {
+  const ModuleDecl *M = D->getModuleContext();
+  Accessibility minAccess =
+    M->isTestingEnabled() ? Accessibility::Internal : Accessibility::Public;
+
+  ModuleSummary::Entry entry;
+  if (auto VD = dyn_cast<ValueDecl>(D)) {
+    if (!VD->hasName() || !VD->hasAccessibility() ||
+        VD->getFormalAccess() < minAccess)
+      return;
+    entry.Name = VD->getName().str();
+  } else if (auto ED = dyn_cast<ExtensionDecl>(D)) {
+    Type extendedTy = ED->getExtendedType();
+    auto nominal = extendedTy ? extendedTy->getAnyNominal() : nullptr;
+    if (!nominal)
+      return;
+    entry.Name = nominal->getName().str();
+  } else if (auto OD = dyn_cast<OperatorDecl>(D)) {
+    entry.Name = OD->getName().str();
+  } else if (auto PGD = dyn_cast<PrecedenceGroupDecl>(D)) {
+    entry.Name = PGD->getName().str();
+  } else {
+    return;
+  }
+  entry.Kind = Decl::getKindName(D->getKind());
+
+  PrintOptions options = getSummaryPrintOptions();
+  std::string text;
+  {
+    llvm::raw_string_ostream out(text);
+    D->print(out, options);
+  }
+  entry.Hash = hashForSummary(text);
+
+  if (auto IDC = dyn_cast<IterableDeclContext>(D)) {
+    std::string membersText;
+    {
+      llvm::raw_string_ostream out(membersText);
+      printMembersForSummary(IDC, options, out);
+    }
+    entry.MembersHash = hashForSummary(membersText);
+  }
+
+  summary.Decls.push_back(std::move(entry));
+}
+
+/// Writes \p summary as YAML.
+///
+/// The decls are sorted, so that moving a decl within or between files
+/// doesn't change the summary.
+static void writeModuleSummary(raw_ostream &out, ModuleSummary &summary) {
+  std::sort(summary.Decls.begin(), summary.Decls.end(),
+            [](const ModuleSummary::Entry &LHS,
+               const ModuleSummary::Entry &RHS) {
+    return std::tie(LHS.Name, LHS.Kind, LHS.Hash, LHS.MembersHash) <
+           std::tie(RHS.Name, RHS.Kind, RHS.Hash, RHS.MembersHash);
+  });
+
+  std::string allText = summary.SILHash;
+  for (auto &entry : summary.Decls)
+    allText += entry.Hash + entry.MembersHash;
+
+  out << "version: \""
+      << llvm::yaml::escape(version::getSwiftFullVersion(
+                              version::Version::getCurrentLanguageVersion()))
+      << "\"\n";
+  out << "interface-hash: \"" << hashForSummary(allText) << "\"\n";
+  out << "sil-hash: \"" << summary.SILHash << "\"\n";
+  out << "decls:\n";
+  for (auto &entry : summary.Decls) {
+    out << "  - name: \"" << llvm::yaml::escape(entry.Name) << "\"\n";
+    out << "    kind: \"" << entry.Kind << "\"\n";
+    out << "    hash: \"" << entry.Hash << "\"\n";
+    if (!entry.MembersHash.empty())
+      out << "    members-hash: \"" << entry.MembersHash << "\"\n";
+  }
+}
+
 void Serializer::writeAST(ModuleOrSourceFile DC) {
-  DeclTable topLevelDecls, extensionDecls, operatorDecls, operatorMethodDecls;
+  DeclTable topLevelDecls, operatorDecls, operatorMethodDecls;
   DeclTable precedenceGroupDecls;
+  ExtensionTable extensionDecls;
   ObjCMethodTable objcMethods;
   LocalTypeHashTableGenerator localTypeGenerator;
   bool hasLocalTypes = false;
@@ -3946,6 +4218,9 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
       if (isa<ImportDecl>(D))
         continue;
 
+      if (Summary)
+        addToSummary(*Summary, D);
+
       if (auto VD = dyn_cast<ValueDecl>(D)) {
         if (!VD->hasName())
           continue;
@@ -3955,7 +4230,10 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
         Type extendedTy = ED->getExtendedType();
         const NominalTypeDecl *extendedNominal = extendedTy->getAnyNominal();
         extensionDecls[extendedNominal->getName()]
-          .push_back({ getKindForTable(extendedNominal), addDeclRef(D) });
+          .push_back(std::make_tuple(
+            getKindForTable(extendedNominal),
+            getExtendedNominalMangledName(extendedNominal),
+            addDeclRef(D)));
       } else if (auto OD = dyn_cast<OperatorDecl>(D)) {
         operatorDecls[OD->getName()]
           .push_back({ getStableFixity(OD->getKind()), addDeclRef(D) });
@@ -4023,7 +4301,7 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelDecls);
     writeDeclTable(DeclList, index_block::OPERATORS, operatorDecls);
     writeDeclTable(DeclList, index_block::PRECEDENCE_GROUPS, precedenceGroupDecls);
-    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
+    writeExtensionTable(DeclList, extensionDecls);
     writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
     writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
     if (hasLocalTypes)
@@ -4033,6 +4311,9 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
     writeObjCMethodTable(ObjCMethodTable, objcMethods);
 
+    index_block::DeclMemberNamesLayout DeclMemberNamesList(Out);
+    writeDeclMemberNamesTable(DeclMemberNamesList, DeclMemberNames);
+
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
       EntryPoint.emit(ScratchRecord, entryPointClassID.getValue());
@@ -4058,8 +4339,10 @@ Serializer::Serializer(const unsigned char (&signature)[N],
 
 void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
                                const SILModule *SILMod,
-                               const SerializationOptions &options) {
+                               const SerializationOptions &options,
+                               ModuleSummary *summary) {
   Serializer S{MODULE_SIGNATURE, DC};
+  S.Summary = summary;
 
   // FIXME: This is only really needed for debugging. We don't actually use it.
   S.writeBlockInfoBlock();
@@ -4068,7 +4351,17 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
     BCBlockRAII moduleBlock(S.Out, MODULE_BLOCK_ID, 2);
     S.writeHeader(options);
     S.writeInputBlock(options);
-    S.writeSIL(SILMod, options.SerializeAllSIL);
+
+    // Blocks end on a word boundary, so the SIL block is whole bytes.
+    uint64_t silStartBit = S.Out.GetCurrentBitNo();
+    S.writeSIL(SILMod, options.SerializeAllSIL, options.CompressSIL);
+    if (summary) {
+      uint64_t silEndBit = S.Out.GetCurrentBitNo();
+      summary->SILHash = hashForSummary(
+          StringRef(S.Buffer.data() + silStartBit / 8,
+                    (silEndBit - silStartBit) / 8));
+    }
+
     S.writeAST(DC);
   }
 
@@ -4151,17 +4444,33 @@ void swift::serialize(ModuleOrSourceFile DC,
     // Special-case writing to stdout.
     Serializer::writeToStream(llvm::outs(), DC, M, options);
     assert(!options.DocOutputPath || options.DocOutputPath[0] == '\0');
+    assert(!options.SummaryOutputPath ||
+           options.SummaryOutputPath[0] == '\0');
     return;
   }
 
+  bool wantSummary =
+    options.SummaryOutputPath && options.SummaryOutputPath[0] != '\0';
+  ModuleSummary summary;
+
   bool hadError = withOutputFile(getContext(DC), options.OutputPath,
                                  [&](raw_ostream &out) {
     SharedTimer timer("Serialization (swiftmodule)");
-    Serializer::writeToStream(out, DC, M, options);
+    Serializer::writeToStream(out, DC, M, options,
+                              wantSummary ? &summary : nullptr);
   });
   if (hadError)
     return;
 
+  // The summary is only replaced if it changed, so its modification time
+  // says when the module's interface last changed.
+  if (wantSummary) {
+    (void)withOutputFile(getContext(DC), options.SummaryOutputPath,
+                         [&](raw_ostream &out) {
+      writeModuleSummary(out, summary);
+    });
+  }
+
   if (options.DocOutputPath && options.DocOutputPath[0] != '\0') {
     (void)withOutputFile(getContext(DC), options.DocOutputPath,
                          [&](raw_ostream &out) {
@@ -34,6 +34,28 @@ namespace serialization {
 
 typedef ArrayRef<std::string> FilenamesTy;
 
+/// Hashes of the parts of a module's interface that its clients depend on,
+/// written with -emit-module-summary-path.
+///
+/// The hashes don't cover function bodies, unless they are serialized as SIL,
+/// so they stay the same when only the implementation of a module changes.
+struct ModuleSummary {
+  struct Entry {
+    std::string Name;
+    StringRef Kind;
+    /// The hash of the decl itself, not including its members.
+    std::string Hash;
+    /// The hash of the decl's members, including nested types' members, or
+    /// empty if it can't have members.
+    std::string MembersHash;
+  };
+
+  std::vector<Entry> Decls;
+
+  /// The hash of the serialized SIL.
+  std::string SILHash;
+};
+
 class Serializer {
   SmallVector<char, 0> Buffer;
   llvm::BitstreamWriter Out{Buffer};
@@ -50,6 +72,9 @@ class Serializer {
   /// serialized. Any other decls will be cross-referenced instead.
   const SourceFile *SF = nullptr;
 
+  /// If non-null, the summary of the module's interface to fill in.
+  ModuleSummary *Summary = nullptr;
+
 public:
   /// Stores a declaration or a type to be written to the AST file.
   ///
@@ -113,6 +138,13 @@ public:
   /// table.
   using DeclTable = llvm::MapVector<Identifier, DeclTableData>;
 
+  /// The kind of the extended nominal, its mangled name (see
+  /// getExtendedNominalMangledName) and the extension's ID, for each
+  /// extension of a nominal type with a given name.
+  using ExtensionTableData =
+    SmallVector<std::tuple<uint8_t, std::string, DeclID>, 4>;
+  using ExtensionTable = llvm::MapVector<Identifier, ExtensionTableData>;
+
   /// Returns the declaration the given generic parameter list is associated
   /// with.
   const Decl *getGenericContext(const GenericParamList *paramList);
@@ -123,12 +155,23 @@ public:
   // hash table of all defined Objective-C methods.
   using ObjCMethodTable = llvm::DenseMap<ObjCSelector, ObjCMethodTableData>;
 
+  /// The in-memory representation of the on-disk table of members by name,
+  /// keyed by member name and the bit offset of the owning MEMBERS record.
+  using DeclMemberNamesTable =
+    llvm::MapVector<std::pair<Identifier, uint32_t>, SmallVector<DeclID, 2>>;
+
 private:
   /// A map from identifiers to methods and properties with the given name.
   ///
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// A map from member names and member lists to the members with the given
+  /// name.
+  ///
+  /// This is used to deserialize only the members a lookup asks for.
+  DeclMemberNamesTable DeclMemberNames;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -331,7 +374,7 @@ private:
                     const std::vector<BitOffset> &values);
 
   /// Serializes all transparent SIL functions in the SILModule.
-  void writeSIL(const SILModule *M, bool serializeAllSIL);
+  void writeSIL(const SILModule *M, bool serializeAllSIL, bool compressSIL);
 
   /// Top-level entry point for serializing a module.
   void writeAST(ModuleOrSourceFile DC);
@@ -343,9 +386,13 @@ private:
 
 public:
   /// Serialize a module to the given stream.
+  ///
+  /// If \p summary is non-null, it is filled in with a summary of the
+  /// module's interface.
   static void writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
                             const SILModule *M,
-                            const SerializationOptions &options);
+                            const SerializationOptions &options,
+                            ModuleSummary *summary = nullptr);
 
   /// Serialize module documentation to the given stream.
   static void writeDocToStream(raw_ostream &os, ModuleOrSourceFile DC,
@@ -27,6 +27,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/OnDiskHashTable.h"
@@ -109,12 +110,51 @@ namespace {
     }
   };
 
+  /// Used to serialize the on-disk side-effect summary table.
+  class EffectsTableInfo {
+  public:
+    using key_type = StringRef;
+    using key_type_ref = key_type;
+    using data_type = StringRef;
+    using data_type_ref = data_type;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.empty());
+      return llvm::HashString(key);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = key.size();
+      uint32_t dataLength = data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key;
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      out << data;
+    }
+  };
+
   class SILSerializer {
     Serializer &S;
     ASTContext &Ctx;
 
     llvm::BitstreamWriter &Out;
 
+    /// The buffer \c Out writes to.
+    SmallVectorImpl<char> &Buffer;
+
     /// A reusable buffer for emitting records.
     SmallVector<uint64_t, 64> ScratchRecord;
 
@@ -170,16 +210,21 @@ namespace {
 
     std::array<unsigned, 256> SILAbbrCodes;
     template <typename Layout>
-    void registerSILAbbr() {
+    void registerSILAbbr(llvm::BitstreamWriter &W) {
       using AbbrArrayTy = decltype(SILAbbrCodes);
       static_assert(Layout::Code <= std::tuple_size<AbbrArrayTy>::value,
                     "layout has invalid record code");
-      SILAbbrCodes[Layout::Code] = Layout::emitAbbrev(Out);
+      SILAbbrCodes[Layout::Code] = Layout::emitAbbrev(W);
       DEBUG(llvm::dbgs() << "SIL abbre code " << SILAbbrCodes[Layout::Code]
                          << " for layout " << Layout::Code << "\n");
     }
 
+    /// Defines the abbreviations used in the SIL block in \p W, which must
+    /// have just entered one.
+    void registerSILAbbrs(llvm::BitstreamWriter &W);
+
     bool ShouldSerializeAll;
+    bool ShouldCompressBodies;
 
     void addMandatorySILFunction(const SILFunction *F,
                                  bool emitDeclarationsForOnoneSupport);
@@ -193,6 +238,9 @@ namespace {
                           SmallVectorImpl<ValueID> &ListOfValues);
 
     void writeSILFunction(const SILFunction &F, bool DeclOnly = false);
+    void writeCompressedBodyHeader();
+    void writeBodyBoundary(llvm::BitstreamWriter &W);
+    void compressFunctionBody(size_t BodyStart);
     void writeSILBasicBlock(const SILBasicBlock &BB);
     void writeSILInstruction(const SILInstruction &SI);
     void writeSILVTable(const SILVTable &vt);
@@ -201,7 +249,7 @@ namespace {
     void writeSILDefaultWitnessTable(const SILDefaultWitnessTable &wt);
 
     void writeSILBlock(const SILModule *SILMod);
-    void writeIndexTables();
+    void writeIndexTables(const SILModule *SILMod);
 
     void writeConversionLikeInstruction(const SILInstruction *I);
     void writeOneTypeLayout(ValueKind valueKind, SILType type);
@@ -223,8 +271,11 @@ namespace {
 
   public:
     SILSerializer(Serializer &S, ASTContext &Ctx,
-                  llvm::BitstreamWriter &Out, bool serializeAll)
-      : S(S), Ctx(Ctx), Out(Out), ShouldSerializeAll(serializeAll) {}
+                  llvm::BitstreamWriter &Out, SmallVectorImpl<char> &Buffer,
+                  bool serializeAll, bool compressBodies)
+      : S(S), Ctx(Ctx), Out(Out), Buffer(Buffer),
+        ShouldSerializeAll(serializeAll),
+        ShouldCompressBodies(compressBodies) {}
 
     void writeSILModule(const SILModule *SILMod);
   };
@@ -353,16 +404,32 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
     clangNodeOwnerID = S.addDeclRef(F.getClangNodeOwner());
 
   unsigned numSpecAttrs = NoBody ? 0 : F.getSpecializeAttrs().size();
+
+  // Record the size of the body, so that optimizations can decide whether
+  // it is worth deserializing without reading it.
+  unsigned bodySize = 0;
+  if (!NoBody)
+    for (auto &BB : F)
+      bodySize += std::distance(BB.begin(), BB.end());
+
   SILFunctionLayout::emitRecord(
       Out, ScratchRecord, abbrCode, toStableSILLinkage(Linkage),
       (unsigned)F.isTransparent(), (unsigned)F.isFragile(),
       (unsigned)F.isThunk(), (unsigned)F.isGlobalInit(),
       (unsigned)F.getInlineStrategy(), (unsigned)F.getEffectsKind(),
-      (unsigned)numSpecAttrs, FnID, clangNodeOwnerID, SemanticsIDs);
+      (unsigned)numSpecAttrs, bodySize, FnID, clangNodeOwnerID, SemanticsIDs);
 
   if (NoBody)
     return;
 
+  // A compressed body is written as usual and then replaced by a compressed
+  // copy, which only works if it starts on a word boundary.
+  size_t bodyStart = 0;
+  if (ShouldCompressBodies) {
+    writeBodyBoundary(Out);
+    bodyStart = Out.GetCurrentBitNo() / 8;
+  }
+
   for (auto *SA : F.getSpecializeAttrs()) {
     unsigned specAttrAbbrCode = SILAbbrCodes[SILSpecializeAttrLayout::Code];
 
@@ -409,6 +476,57 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
     SerializedBBNum++;
   }
   assert(BasicID == SerializedBBNum && "Wrong number of BBs was serialized");
+
+  if (ShouldCompressBodies)
+    compressFunctionBody(bodyStart);
+}
+
+void SILSerializer::writeBodyBoundary(llvm::BitstreamWriter &W) {
+  unsigned abbrCode = SILAbbrCodes[SILBodyBoundaryLayout::Code];
+  SILBodyBoundaryLayout::emitRecord(W, ScratchRecord, abbrCode, StringRef());
+}
+
+void SILSerializer::compressFunctionBody(size_t BodyStart) {
+  // End the body on a word boundary too, so that it is a whole number of
+  // bytes and nothing is left buffered in the writer.
+  writeBodyBoundary(Out);
+  assert(Out.GetCurrentBitNo() == Buffer.size() * 8);
+
+  StringRef body(Buffer.data() + BodyStart, Buffer.size() - BodyStart);
+  SmallVector<char, 0> contents;
+  unsigned uncompressedSize = body.size();
+  if (!llvm::zlib::isAvailable() ||
+      llvm::zlib::compress(body, contents) != llvm::zlib::StatusOK ||
+      contents.size() >= body.size()) {
+    contents.assign(body.begin(), body.end());
+    uncompressedSize = 0;
+  }
+
+  // Drop the body from the stream and write it again, compressed.
+  Buffer.resize(BodyStart);
+  unsigned abbrCode = SILAbbrCodes[SILCompressedBodyLayout::Code];
+  SILCompressedBodyLayout::emitRecord(
+      Out, ScratchRecord, abbrCode, uncompressedSize,
+      StringRef(contents.data(), contents.size()));
+}
+
+void SILSerializer::writeCompressedBodyHeader() {
+  // A separate stream that enters a SIL block and defines the same
+  // abbreviations, which the deserializer puts in front of each body it
+  // decompresses.
+  SmallVector<char, 512> header;
+  size_t headerSize;
+  {
+    llvm::BitstreamWriter headerOut(header);
+    BCBlockRAII subBlock(headerOut, SIL_BLOCK_ID, 6);
+    registerSILAbbrs(headerOut);
+    writeBodyBoundary(headerOut);
+    headerSize = headerOut.GetCurrentBitNo() / 8;
+  }
+
+  unsigned abbrCode = SILAbbrCodes[SILCompressedBodyHeaderLayout::Code];
+  SILCompressedBodyHeaderLayout::emitRecord(
+      Out, ScratchRecord, abbrCode, StringRef(header.data(), headerSize));
 }
 
 void SILSerializer::writeSILBasicBlock(const SILBasicBlock &BB) {
@@ -1646,7 +1764,27 @@ static void writeIndexTable(const sil_index_block::ListLayout &List,
   List.emit(scratch, kind, tableOffset, hashTableBlob);
 }
 
-void SILSerializer::writeIndexTables() {
+/// Writes the table of side-effect summaries recorded in \p SILMod.
+static void writeEffectsTable(const sil_index_block::ListLayout &List,
+                              const SILModule *SILMod) {
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::OnDiskChainedHashTableGenerator<EffectsTableInfo> generator;
+    for (auto &entry : SILMod->getEffectsSummaries())
+      generator.insert(entry.getKey(), entry.getValue());
+
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0.
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+  SmallVector<uint64_t, 8> scratch;
+  List.emit(scratch, sil_index_block::SIL_FUNC_EFFECTS, tableOffset,
+            hashTableBlob);
+}
+
+void SILSerializer::writeIndexTables(const SILModule *SILMod) {
   BCBlockRAII restoreBlock(Out, SIL_INDEX_BLOCK_ID, 4);
 
   sil_index_block::ListLayout List(Out);
@@ -1682,6 +1820,9 @@ void SILSerializer::writeIndexTables() {
                 sil_index_block::SIL_DEFAULT_WITNESS_TABLE_OFFSETS,
                 DefaultWitnessTableOffset);
   }
+
+  if (!SILMod->getEffectsSummaries().empty())
+    writeEffectsTable(List, SILMod);
 }
 
 void SILSerializer::writeSILGlobalVar(const SILGlobalVariable &g) {
@@ -1833,52 +1974,62 @@ bool SILSerializer::shouldEmitFunctionBody(const SILFunction *F) {
   return false;
 }
 
-void SILSerializer::writeSILBlock(const SILModule *SILMod) {
-  BCBlockRAII subBlock(Out, SIL_BLOCK_ID, 6);
-
-  registerSILAbbr<SILFunctionLayout>();
-  registerSILAbbr<SILBasicBlockLayout>();
-  registerSILAbbr<SILOneValueOneOperandLayout>();
-  registerSILAbbr<SILOneTypeLayout>();
-  registerSILAbbr<SILOneOperandLayout>();
-  registerSILAbbr<SILOneTypeOneOperandLayout>();
-  registerSILAbbr<SILInitExistentialLayout>();
-  registerSILAbbr<SILOneTypeValuesLayout>();
-  registerSILAbbr<SILTwoOperandsLayout>();
-  registerSILAbbr<SILTailAddrLayout>();
-  registerSILAbbr<SILInstApplyLayout>();
-  registerSILAbbr<SILInstNoOperandLayout>();
-
-  registerSILAbbr<VTableLayout>();
-  registerSILAbbr<VTableEntryLayout>();
-  registerSILAbbr<SILGlobalVarLayout>();
-  registerSILAbbr<WitnessTableLayout>();
-  registerSILAbbr<WitnessMethodEntryLayout>();
-  registerSILAbbr<WitnessBaseEntryLayout>();
-  registerSILAbbr<WitnessAssocProtocolLayout>();
-  registerSILAbbr<WitnessAssocEntryLayout>();
-  registerSILAbbr<DefaultWitnessTableLayout>();
-  registerSILAbbr<DefaultWitnessTableEntryLayout>();
-  registerSILAbbr<DefaultWitnessTableNoEntryLayout>();
-
-  registerSILAbbr<SILInstCastLayout>();
-  registerSILAbbr<SILInstWitnessMethodLayout>();
-  registerSILAbbr<SILSpecializeAttrLayout>();
+void SILSerializer::registerSILAbbrs(llvm::BitstreamWriter &W) {
+  registerSILAbbr<SILFunctionLayout>(W);
+  registerSILAbbr<SILBasicBlockLayout>(W);
+  registerSILAbbr<SILOneValueOneOperandLayout>(W);
+  registerSILAbbr<SILOneTypeLayout>(W);
+  registerSILAbbr<SILOneOperandLayout>(W);
+  registerSILAbbr<SILOneTypeOneOperandLayout>(W);
+  registerSILAbbr<SILInitExistentialLayout>(W);
+  registerSILAbbr<SILOneTypeValuesLayout>(W);
+  registerSILAbbr<SILTwoOperandsLayout>(W);
+  registerSILAbbr<SILTailAddrLayout>(W);
+  registerSILAbbr<SILInstApplyLayout>(W);
+  registerSILAbbr<SILInstNoOperandLayout>(W);
+
+  registerSILAbbr<VTableLayout>(W);
+  registerSILAbbr<VTableEntryLayout>(W);
+  registerSILAbbr<SILGlobalVarLayout>(W);
+  registerSILAbbr<WitnessTableLayout>(W);
+  registerSILAbbr<WitnessMethodEntryLayout>(W);
+  registerSILAbbr<WitnessBaseEntryLayout>(W);
+  registerSILAbbr<WitnessAssocProtocolLayout>(W);
+  registerSILAbbr<WitnessAssocEntryLayout>(W);
+  registerSILAbbr<DefaultWitnessTableLayout>(W);
+  registerSILAbbr<DefaultWitnessTableEntryLayout>(W);
+  registerSILAbbr<DefaultWitnessTableNoEntryLayout>(W);
+
+  registerSILAbbr<SILInstCastLayout>(W);
+  registerSILAbbr<SILInstWitnessMethodLayout>(W);
+  registerSILAbbr<SILSpecializeAttrLayout>(W);
+  registerSILAbbr<SILBodyBoundaryLayout>(W);
+  registerSILAbbr<SILCompressedBodyLayout>(W);
+  registerSILAbbr<SILCompressedBodyHeaderLayout>(W);
 
   // Register the abbreviation codes so these layouts can exist in both
   // decl blocks and sil blocks.
   // We have to make sure BOUND_GENERIC_SUBSTITUTION does not overlap with
   // SIL-specific records.
-  registerSILAbbr<decls_block::BoundGenericSubstitutionLayout>();
-  registerSILAbbr<decls_block::AbstractProtocolConformanceLayout>();
-  registerSILAbbr<decls_block::NormalProtocolConformanceLayout>();
-  registerSILAbbr<decls_block::SpecializedProtocolConformanceLayout>();
-  registerSILAbbr<decls_block::InheritedProtocolConformanceLayout>();
-  registerSILAbbr<decls_block::NormalProtocolConformanceIdLayout>();
-  registerSILAbbr<decls_block::ProtocolConformanceXrefLayout>();
-  registerSILAbbr<decls_block::GenericRequirementLayout>();
-  registerSILAbbr<decls_block::GenericEnvironmentLayout>();
-  registerSILAbbr<decls_block::SILGenericEnvironmentLayout>();
+  registerSILAbbr<decls_block::BoundGenericSubstitutionLayout>(W);
+  registerSILAbbr<decls_block::AbstractProtocolConformanceLayout>(W);
+  registerSILAbbr<decls_block::NormalProtocolConformanceLayout>(W);
+  registerSILAbbr<decls_block::SpecializedProtocolConformanceLayout>(W);
+  registerSILAbbr<decls_block::InheritedProtocolConformanceLayout>(W);
+  registerSILAbbr<decls_block::NormalProtocolConformanceIdLayout>(W);
+  registerSILAbbr<decls_block::ProtocolConformanceXrefLayout>(W);
+  registerSILAbbr<decls_block::GenericRequirementLayout>(W);
+  registerSILAbbr<decls_block::GenericEnvironmentLayout>(W);
+  registerSILAbbr<decls_block::SILGenericEnvironmentLayout>(W);
+}
+
+void SILSerializer::writeSILBlock(const SILModule *SILMod) {
+  BCBlockRAII subBlock(Out, SIL_BLOCK_ID, 6);
+
+  registerSILAbbrs(Out);
+
+  if (ShouldCompressBodies)
+    writeCompressedBodyHeader();
 
   for (const SILGlobalVariable &g : SILMod->getSILGlobals())
     writeSILGlobalVar(g);
@@ -1931,6 +2082,11 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
     }
 
     addMandatorySILFunction(&F, emitDeclarationsForOnoneSupport);
+
+    // Specializations made for clients need a declaration, so that clients
+    // can find them.
+    if (F.isKeepAsPublic() && hasPublicVisibility(F.getLinkage()))
+      addReferencedSILFunction(&F, /*DeclOnly*/ true);
     processSILFunctionWorklist();
   }
 
@@ -1951,13 +2107,15 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
 
 void SILSerializer::writeSILModule(const SILModule *SILMod) {
   writeSILBlock(SILMod);
-  writeIndexTables();
+  writeIndexTables(SILMod);
 }
 
-void Serializer::writeSIL(const SILModule *SILMod, bool serializeAllSIL) {
+void Serializer::writeSIL(const SILModule *SILMod, bool serializeAllSIL,
+                          bool compressSIL) {
   if (!SILMod)
     return;
 
-  SILSerializer SILSer(*this, M->getASTContext(), Out, serializeAllSIL);
+  SILSerializer SILSer(*this, M->getASTContext(), Out, Buffer,
+                       serializeAllSIL, compressSIL);
   SILSer.writeSILModule(SILMod);
 }
@@ -18,11 +18,14 @@
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Version.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
+#include <atomic>
 #include <system_error>
+#include <thread>
 
 using namespace swift;
 
@@ -44,10 +47,17 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
                 llvm::SmallVectorImpl<char> &Scratch) {
   // Try to open the module file first.  If we fail, don't even look for the
   // module documentation file.
+  //
+  // Module files aren't parsed as text, so don't ask for a null terminator.
+  // Requiring one keeps MemoryBuffer from mapping files whose size is a
+  // multiple of the page size, and a mapped file's pages are shared by every
+  // process that imports the module instead of being copied into each one.
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -56,7 +66,9 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -143,6 +155,21 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
                           moduleBuffer, moduleDocBuffer, scratch);
 }
 
+/// Returns the number of places findModule looks for modules.
+static size_t getSearchPathCount(const ASTContext &ctx) {
+  return ctx.SearchPathOpts.ImportSearchPaths.size() +
+         ctx.SearchPathOpts.FrameworkSearchPaths.size();
+}
+
+struct SerializedModuleLoader::ValidatedModuleFile {
+  /// The loaded module file, or null if the buffer was obviously malformed.
+  std::unique_ptr<ModuleFile> File;
+  serialization::ValidationInfo Info;
+  serialization::ExtendedValidationInfo ExtendedInfo;
+  std::string ModuleBufferID;
+  std::string ModuleDocBufferID;
+};
+
 FileUnit *SerializedModuleLoader::loadAST(
     Module &M, Optional<SourceLoc> diagLoc,
     std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer,
@@ -150,25 +177,23 @@ FileUnit *SerializedModuleLoader::loadAST(
     bool isFramework) {
   assert(moduleInputBuffer);
 
-  const char *moduleBufferID = moduleInputBuffer->getBufferIdentifier();
-  const char *moduleDocBufferID = nullptr;
-  if (moduleDocInputBuffer)
-    moduleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
+  ValidatedModuleFile loaded;
+  validateModuleFile(std::move(moduleInputBuffer),
+                     std::move(moduleDocInputBuffer), isFramework, loaded);
+  return loadAST(M, diagLoc, loaded);
+}
 
-  if (moduleInputBuffer->getBufferSize() % 4 != 0) {
-    if (diagLoc)
-      Ctx.Diags.diagnose(*diagLoc, diag::serialization_malformed_module,
-                         moduleBufferID);
-    return nullptr;
-  }
+FileUnit *SerializedModuleLoader::loadAST(Module &M,
+                                          Optional<SourceLoc> diagLoc,
+                                          ValidatedModuleFile &loaded) {
+  const char *moduleBufferID = loaded.ModuleBufferID.c_str();
+  const char *moduleDocBufferID = nullptr;
+  if (!loaded.ModuleDocBufferID.empty())
+    moduleDocBufferID = loaded.ModuleDocBufferID.c_str();
 
-  serialization::ExtendedValidationInfo extendedInfo;
-  std::unique_ptr<ModuleFile> loadedModuleFile;
-  serialization::ValidationInfo loadInfo =
-      ModuleFile::load(std::move(moduleInputBuffer),
-                       std::move(moduleDocInputBuffer),
-                       isFramework, loadedModuleFile,
-                       &extendedInfo);
+  serialization::ExtendedValidationInfo &extendedInfo = loaded.ExtendedInfo;
+  std::unique_ptr<ModuleFile> &loadedModuleFile = loaded.File;
+  serialization::ValidationInfo &loadInfo = loaded.Info;
   if (loadInfo.status == serialization::Status::Valid) {
     Ctx.bumpGeneration();
 
@@ -353,6 +378,93 @@ FileUnit *SerializedModuleLoader::loadAST(
   return nullptr;
 }
 
+void SerializedModuleLoader::validateModuleFile(
+    std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer,
+    std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer,
+    bool isFramework, ValidatedModuleFile &result) {
+  result.ModuleBufferID = moduleInputBuffer->getBufferIdentifier();
+  if (moduleDocInputBuffer)
+    result.ModuleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
+
+  // A bitstream is always a whole number of words.
+  if (moduleInputBuffer->getBufferSize() % 4 != 0) {
+    result.Info.status = serialization::Status::Malformed;
+    return;
+  }
+
+  result.Info = ModuleFile::load(std::move(moduleInputBuffer),
+                                 std::move(moduleDocInputBuffer),
+                                 isFramework, result.File,
+                                 &result.ExtendedInfo);
+}
+
+void SerializedModuleLoader::prefetchModules(ArrayRef<Identifier> names,
+                                             unsigned numThreads) {
+  PrefetchSearchPathCount = getSearchPathCount(Ctx);
+
+  llvm::SmallPtrSet<const char *, 32> seen;
+  std::vector<Identifier> pending;
+  auto addPending = [&](Identifier name) {
+    if (name.empty() || !seen.insert(name.get()).second)
+      return;
+    if (Ctx.LoadedModules.count(name) || MemoryBuffers.count(name.str()) ||
+        PrefetchedModules.count(name.str()))
+      return;
+    pending.push_back(name);
+  };
+  for (auto name : names)
+    addPending(name);
+
+  // Each round reads the modules found so far on all threads, and then finds
+  // the modules they depend on for the next round.
+  while (!pending.empty()) {
+    std::vector<std::unique_ptr<ValidatedModuleFile>> results(pending.size());
+    std::atomic<size_t> nextIndex(0);
+    auto worker = [&] {
+      for (size_t i = nextIndex++; i < pending.size(); i = nextIndex++) {
+        std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer;
+        std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer;
+        bool isFramework = false;
+        if (!findModule(Ctx, { pending[i], SourceLoc() }, moduleInputBuffer,
+                        moduleDocInputBuffer, isFramework))
+          continue;
+
+        results[i].reset(new ValidatedModuleFile());
+        validateModuleFile(std::move(moduleInputBuffer),
+                           std::move(moduleDocInputBuffer), isFramework,
+                           *results[i]);
+      }
+    };
+
+    size_t numWorkers = std::min<size_t>(std::max(numThreads, 1U),
+                                         pending.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numWorkers; ++i)
+      threads.push_back(std::thread(worker));
+    worker();
+    for (std::thread &thread : threads)
+      thread.join();
+
+    std::vector<Identifier> round;
+    std::swap(round, pending);
+    for (size_t i = 0, e = round.size(); i != e; ++i) {
+      if (!results[i])
+        continue;
+
+      if (results[i]->Info.status == serialization::Status::Valid) {
+        for (auto &dependency : results[i]->File->getDependencies()) {
+          if (dependency.isHeader())
+            continue;
+          StringRef topLevelName = dependency.RawPath.split('\0').first;
+          addPending(Ctx.getIdentifier(topLevelName));
+        }
+      }
+
+      PrefetchedModules[round[i].str()] = std::move(results[i]);
+    }
+  }
+}
+
 Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
                                            Module::AccessPathTy path) {
   // FIXME: Swift submodules?
@@ -376,6 +488,31 @@ Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
     }
   }
 
+  // Then see if it was found ahead of time, as long as the search paths the
+  // search used are still the same.
+  if (!moduleInputBuffer && !PrefetchedModules.empty()) {
+    auto prefetchIter = PrefetchedModules.find(moduleID.first.str());
+    if (prefetchIter != PrefetchedModules.end()) {
+      std::unique_ptr<ValidatedModuleFile> prefetched =
+        std::move(prefetchIter->second);
+      PrefetchedModules.erase(prefetchIter);
+
+      if (PrefetchSearchPathCount == getSearchPathCount(Ctx)) {
+        addDependency(prefetched->ModuleBufferID);
+
+        auto M = Module::create(moduleID.first, Ctx);
+        Ctx.LoadedModules[moduleID.first] = M;
+
+        if (!loadAST(*M, moduleID.second, *prefetched))
+          M->setFailedToLoad();
+
+        return M;
+      }
+
+      PrefetchedModules.clear();
+    }
+  }
+
   // Otherwise look on disk.
   if (!moduleInputBuffer) {
     if (!findModule(Ctx, moduleID, moduleInputBuffer, moduleDocInputBuffer,
@@ -115,6 +115,23 @@ bool SerializedSILLoader::hasSILFunction(StringRef Name, SILLinkage Linkage) {
   return retVal;
 }
 
+Optional<unsigned> SerializedSILLoader::getSILFunctionBodySize(StringRef Name) {
+  // Use the first module that has a definition, as lookupSILFunction does.
+  for (auto &Des : LoadedSILSections) {
+    if (auto Size = Des->getSILFunctionBodySize(Name))
+      return Size;
+  }
+  return None;
+}
+
+Optional<StringRef> SerializedSILLoader::lookupEffectsSummary(StringRef Name) {
+  for (auto &Des : LoadedSILSections) {
+    if (auto Summary = Des->lookupEffectsSummary(Name))
+      return Summary;
+  }
+  return None;
+}
+
 
 SILVTable *SerializedSILLoader::lookupVTable(Identifier Name) {
   for (auto &Des : LoadedSILSections) {
@@ -28,6 +28,41 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+void TypeRefBuilder::indexReflectionInfos() {
+  for (; NumIndexedReflectionInfos != ReflectionInfos.size();
+       ++NumIndexedReflectionInfos) {
+    const auto &Info = ReflectionInfos[NumIndexedReflectionInfos];
+
+    // When a name appears more than once, the first record found wins, as
+    // it did when the sections were searched in order.
+    for (auto &FD : Info.fieldmd) {
+      if (FD.hasMangledTypeName())
+        FieldDescriptors.insert({FD.getMangledTypeName(), &FD});
+    }
+
+    for (auto &BuiltinTypeDescriptor : Info.builtin) {
+      assert(BuiltinTypeDescriptor.Size > 0);
+      assert(BuiltinTypeDescriptor.Alignment > 0);
+      assert(BuiltinTypeDescriptor.Stride > 0);
+      if (BuiltinTypeDescriptor.hasMangledTypeName())
+        BuiltinTypeDescriptors.insert(
+          {BuiltinTypeDescriptor.getMangledTypeName(), &BuiltinTypeDescriptor});
+    }
+
+    for (auto &AssocTyDescriptor : Info.assocty) {
+      AssociatedTypeDescriptors[AssocTyDescriptor.getMangledConformingTypeName()]
+        .push_back(&AssocTyDescriptor);
+    }
+
+    for (auto &CD : Info.capture) {
+      auto RemoteAddr = ((uintptr_t) &CD -
+                         Info.LocalStartAddress +
+                         Info.RemoteStartAddress);
+      CaptureDescriptors.insert({RemoteAddr, &CD});
+    }
+  }
+}
+
 const TypeRef * TypeRefBuilder::
 lookupTypeWitness(const std::string &MangledTypeName,
                   const std::string &Member,
@@ -40,32 +75,31 @@ lookupTypeWitness(const std::string &MangledTypeName,
   if (found != AssociatedTypeCache.end())
     return found->second;
 
-  // Cache missed - we need to look through all of the assocty sections
-  // for all images that we've been notified about.
-  for (auto &Info : ReflectionInfos) {
-    for (const auto &AssocTyDescriptor : Info.assocty) {
-      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
-      if (ConformingTypeName.compare(MangledTypeName) != 0)
-        continue;
+  // Cache missed - we need to look through the assocty records for the
+  // conforming type in all images that we've been notified about.
+  indexReflectionInfos();
+  auto Descriptors = AssociatedTypeDescriptors.find(MangledTypeName);
+  if (Descriptors == AssociatedTypeDescriptors.end())
+    return nullptr;
 
-      std::string ProtocolMangledName(AssocTyDescriptor.ProtocolTypeName);
-      auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
-      auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
+  for (const auto *AssocTyDescriptor : Descriptors->second) {
+    std::string ProtocolMangledName(AssocTyDescriptor->ProtocolTypeName);
+    auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
+    auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
 
-      if (Protocol != TR)
-        continue;
+    if (Protocol != TR)
+      continue;
 
-      for (auto &AssocTy : AssocTyDescriptor) {
-        if (Member.compare(AssocTy.getName()) != 0)
-          continue;
+    for (auto &AssocTy : *AssocTyDescriptor) {
+      if (Member.compare(AssocTy.getName()) != 0)
+        continue;
 
-        auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-        auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
-        auto *TypeWitness = swift::remote::decodeMangledType(*this, Demangled);
+      auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
+      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
+      auto *TypeWitness = swift::remote::decodeMangledType(*this, Demangled);
 
-        AssociatedTypeCache.insert(std::make_pair(key, TypeWitness));
-        return TypeWitness;
-      }
+      AssociatedTypeCache.insert(std::make_pair(key, TypeWitness));
+      return TypeWitness;
     }
   }
   return nullptr;
@@ -108,19 +142,11 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = FieldDescriptors.find(MangledName);
+  if (Found == FieldDescriptors.end())
+    return nullptr;
+  return Found->second;
 }
 
 std::vector<FieldTypeInfo>
@@ -168,36 +194,20 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = BuiltinTypeDescriptors.find(MangledName);
+  if (Found == BuiltinTypeDescriptors.end())
+    return nullptr;
+  return Found->second;
 }
 
 const CaptureDescriptor *
 TypeRefBuilder::getCaptureDescriptor(uintptr_t RemoteAddress) {
-  for (auto Info : ReflectionInfos) {
-    for (auto &CD : Info.capture) {
-      auto OtherAddr = ((uintptr_t) &CD -
-                        Info.LocalStartAddress +
-                        Info.RemoteStartAddress);
-      if (OtherAddr == RemoteAddress)
-        return &CD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = CaptureDescriptors.find(RemoteAddress);
+  if (Found == CaptureDescriptors.end())
+    return nullptr;
+  return Found->second;
 }
 
 /// Get the unsubstituted capture types for a closure context.
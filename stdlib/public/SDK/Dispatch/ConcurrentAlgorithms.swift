@@ -0,0 +1,303 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Collection algorithms that spread their work over the cores of the
+// machine with `DispatchQueue.concurrentPerform`.
+
+import Darwin
+
+/// Collections shorter than this are processed on the calling thread; the
+/// cost of waking worker threads outweighs the parallelism.
+internal let _concurrentMinimumCount = 4096
+
+/// The smallest chunk of elements handed to one `concurrentPerform`
+/// iteration.
+internal let _concurrentMinimumChunkSize = 1024
+
+internal let _concurrentProcessorCount: Int = {
+	let count = sysconf(_SC_NPROCESSORS_ONLN)
+	return count > 0 ? count : 1
+}()
+
+/// Returns the number of chunks to split `count` elements into.
+///
+/// Several chunks are made per processor, so that `concurrentPerform` can
+/// hand chunks to whichever worker thread is free and balance the load when
+/// some elements take longer than others.
+internal func _concurrentChunkCount(_ count: Int) -> Int {
+	let maximumChunks = _concurrentProcessorCount * 4
+	let chunks = count / _concurrentMinimumChunkSize
+	return chunks < maximumChunks ? chunks : maximumChunks
+}
+
+/// Returns the offsets of chunk `chunk` of `chunkCount` equal chunks of
+/// `count` elements.
+internal func _concurrentChunk(
+	_ chunk: Int, of chunkCount: Int, count: Int
+) -> Range<Int> {
+	return (count * chunk / chunkCount)..<(count * (chunk + 1) / chunkCount)
+}
+
+extension RandomAccessCollection {
+	/// Calls `body` on each element of the collection, using all available
+	/// processors.
+	///
+	/// The calls happen in no particular order and possibly at the same time,
+	/// so `body` must be safe to call from several threads. Collections with
+	/// fewer than a few thousand elements are processed on the calling thread.
+	///
+	/// - Parameter body: A closure that takes an element of the collection.
+	public func concurrentForEach(_ body: (Iterator.Element) -> Void) {
+		let n: Int = numericCast(count)
+		if n < _concurrentMinimumCount {
+			forEach(body)
+			return
+		}
+
+		let chunkCount = _concurrentChunkCount(n)
+		DispatchQueue.concurrentPerform(iterations: chunkCount) { chunk in
+			let offsets = _concurrentChunk(chunk, of: chunkCount, count: n)
+			var i = index(startIndex, offsetBy: numericCast(offsets.lowerBound))
+			for _ in offsets {
+				body(self[i])
+				formIndex(after: &i)
+			}
+		}
+	}
+
+	/// Returns an array containing the results of mapping `transform` over the
+	/// collection's elements, using all available processors.
+	///
+	/// The results are in the same order as the elements, but `transform` is
+	/// called in no particular order and possibly on several threads at once,
+	/// so it must be safe to call from several threads. Collections with fewer
+	/// than a few thousand elements are processed on the calling thread.
+	///
+	/// - Parameter transform: A mapping closure. `transform` accepts an
+	///   element of this collection as its parameter and returns a
+	///   transformed value.
+	/// - Returns: An array containing the transformed elements.
+	public func concurrentMap<T>(_ transform: (Iterator.Element) -> T) -> [T] {
+		let n: Int = numericCast(count)
+		if n < _concurrentMinimumCount {
+			return map(transform)
+		}
+
+		let results = UnsafeMutablePointer<T>.allocate(capacity: n)
+		defer {
+			results.deinitialize(count: n)
+			results.deallocate(capacity: n)
+		}
+
+		let chunkCount = _concurrentChunkCount(n)
+		DispatchQueue.concurrentPerform(iterations: chunkCount) { chunk in
+			let offsets = _concurrentChunk(chunk, of: chunkCount, count: n)
+			var i = index(startIndex, offsetBy: numericCast(offsets.lowerBound))
+			for offset in offsets {
+				(results + offset).initialize(to: transform(self[i]))
+				formIndex(after: &i)
+			}
+		}
+		return Array(UnsafeBufferPointer(start: results, count: n))
+	}
+
+	/// Returns the result of combining the elements of the collection with
+	/// `combine`, using all available processors.
+	///
+	/// Each chunk of the collection is reduced on its own thread, starting
+	/// from `identity`, and the results of the chunks are then combined in
+	/// order. The result is the same as that of
+	/// `reduce(identity, combine)` only if `combine` is associative and
+	/// `identity` is an identity element for it, as with `+` and `0`. Either
+	/// way, `combine` must be safe to call from several threads.
+	///
+	/// - Parameters:
+	///   - identity: The value that combining with any element leaves
+	///     unchanged.
+	///   - combine: An associative closure that combines two elements, or
+	///     the results of combining elements.
+	/// - Returns: The combined value. Returns `identity` if the collection is
+	///   empty.
+	public func concurrentReduce(
+		_ identity: Iterator.Element,
+		_ combine: (Iterator.Element, Iterator.Element) -> Iterator.Element
+	) -> Iterator.Element {
+		let n: Int = numericCast(count)
+		if n < _concurrentMinimumCount {
+			return reduce(identity, combine)
+		}
+
+		let chunkCount = _concurrentChunkCount(n)
+		let partialResults =
+			UnsafeMutablePointer<Iterator.Element>.allocate(capacity: chunkCount)
+		defer {
+			partialResults.deinitialize(count: chunkCount)
+			partialResults.deallocate(capacity: chunkCount)
+		}
+
+		DispatchQueue.concurrentPerform(iterations: chunkCount) { chunk in
+			let offsets = _concurrentChunk(chunk, of: chunkCount, count: n)
+			var i = index(startIndex, offsetBy: numericCast(offsets.lowerBound))
+			var partialResult = identity
+			for _ in offsets {
+				partialResult = combine(partialResult, self[i])
+				formIndex(after: &i)
+			}
+			(partialResults + chunk).initialize(to: partialResult)
+		}
+		return UnsafeBufferPointer(start: partialResults, count: chunkCount)
+			.reduce(identity, combine)
+	}
+}
+
+extension MutableCollection
+	where Self : RandomAccessCollection, Self.Iterator.Element : Comparable {
+	/// Sorts the collection in place, using all available processors.
+	///
+	/// The sort is stable and gives the same result as `sort()`. Collections
+	/// with fewer than a few thousand elements are sorted on the calling
+	/// thread.
+	public mutating func concurrentSort() {
+		concurrentSort(by: <)
+	}
+}
+
+extension MutableCollection where Self : RandomAccessCollection {
+	/// Sorts the collection in place, using the given predicate as the
+	/// comparison between elements and all available processors.
+	///
+	/// The sort is stable and gives the same result as `sort(by:)`.
+	/// `areInIncreasingOrder` must be a strict weak ordering over the
+	/// elements, as for `sort(by:)`, and must be safe to call from several
+	/// threads. Collections with fewer than a few thousand elements are
+	/// sorted on the calling thread.
+	///
+	/// - Parameter areInIncreasingOrder: A predicate that returns `true` if
+	///   its first argument should be ordered before its second argument;
+	///   otherwise, `false`.
+	public mutating func concurrentSort(
+		by areInIncreasingOrder: (Iterator.Element, Iterator.Element) -> Bool
+	) {
+		let n: Int = numericCast(count)
+		if n < _concurrentMinimumCount {
+			sort(by: areInIncreasingOrder)
+			return
+		}
+
+		let didSortUnsafeBuffer: Void? =
+			_withUnsafeMutableBufferPointerIfSupported { (baseAddress, count) in
+			_concurrentSort(baseAddress, count: count, by: areInIncreasingOrder)
+		}
+		if didSortUnsafeBuffer != nil {
+			return
+		}
+
+		var sorted = ContiguousArray(self)
+		sorted.withUnsafeMutableBufferPointer { bufferPointer in
+			_concurrentSort(
+				bufferPointer.baseAddress!, count: n, by: areInIncreasingOrder)
+		}
+		var i = startIndex
+		for element in sorted {
+			self[i] = element
+			formIndex(after: &i)
+		}
+	}
+}
+
+/// Sorts `count` elements starting at `base` by sorting chunks of them
+/// concurrently and then merging neighbouring chunks, also concurrently,
+/// until one run is left.
+///
+/// Each merge moves its runs between `base` and a scratch buffer of the same
+/// size, so that no merge needs to copy its inputs first.
+internal func _concurrentSort<Element>(
+	_ base: UnsafeMutablePointer<Element>,
+	count: Int,
+	by areInIncreasingOrder: (Element, Element) -> Bool
+) {
+	let chunkCount = _concurrentChunkCount(count)
+	DispatchQueue.concurrentPerform(iterations: chunkCount) { chunk in
+		let offsets = _concurrentChunk(chunk, of: chunkCount, count: count)
+		var run = UnsafeMutableBufferPointer(
+			start: base + offsets.lowerBound, count: offsets.count)
+		run.sort(by: areInIncreasingOrder)
+	}
+
+	let scratch = UnsafeMutablePointer<Element>.allocate(capacity: count)
+	defer {
+		scratch.deallocate(capacity: count)
+	}
+
+	var runs = (0..<chunkCount).map {
+		_concurrentChunk($0, of: chunkCount, count: count)
+	}
+	var source = base
+	var destination = scratch
+	while runs.count > 1 {
+		let pairCount = (runs.count + 1) / 2
+		DispatchQueue.concurrentPerform(iterations: pairCount) { pair in
+			let left = runs[2 * pair]
+			if 2 * pair + 1 == runs.count {
+				(destination + left.lowerBound).moveInitialize(
+					from: source + left.lowerBound, count: left.count)
+				return
+			}
+			_concurrentMerge(
+				left, runs[2 * pair + 1], from: source, into: destination,
+				by: areInIncreasingOrder)
+		}
+
+		runs = (0..<pairCount).map { (pair) -> Range<Int> in
+			let left = runs[2 * pair]
+			if 2 * pair + 1 == runs.count {
+				return left
+			}
+			return left.lowerBound..<runs[2 * pair + 1].upperBound
+		}
+		swap(&source, &destination)
+	}
+
+	if source != base {
+		base.moveInitialize(from: source, count: count)
+	}
+}
+
+/// Moves the sorted, adjacent runs `left` and `right` of `source` into the
+/// same positions of `destination`, merging them stably.
+internal func _concurrentMerge<Element>(
+	_ left: Range<Int>,
+	_ right: Range<Int>,
+	from source: UnsafeMutablePointer<Element>,
+	into destination: UnsafeMutablePointer<Element>,
+	by areInIncreasingOrder: (Element, Element) -> Bool
+) {
+	var i = left.lowerBound
+	var j = right.lowerBound
+	var k = left.lowerBound
+	while i != left.upperBound && j != right.upperBound {
+		// Take from the left run on ties, which keeps the merge stable.
+		if areInIncreasingOrder(source[j], source[i]) {
+			(destination + k).initialize(to: (source + j).move())
+			j += 1
+		} else {
+			(destination + k).initialize(to: (source + i).move())
+			i += 1
+		}
+		k += 1
+	}
+	(destination + k).moveInitialize(
+		from: source + i, count: left.upperBound - i)
+	k += left.upperBound - i
+	(destination + k).moveInitialize(
+		from: source + j, count: right.upperBound - j)
+}
@@ -15,6 +15,8 @@
 #include "swift/Remote/CMemoryReader.h"
 #include "swift/SwiftRemoteMirror/SwiftRemoteMirror.h"
 
+#include <algorithm>
+
 using namespace swift;
 using namespace swift::reflection;
 using namespace swift::remote;
@@ -54,6 +56,21 @@ void swift_reflection_destroyReflectionContext(SwiftReflectionContextRef Context
   delete Context;
 }
 
+void
+swift_reflection_setMemoryCachingEnabled(SwiftReflectionContextRef ContextRef,
+                                         int Enabled) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  auto &Reader = static_cast<CMemoryReader &>(Context->getReader());
+  Reader.setCachingEnabled(Enabled != 0);
+}
+
+void
+swift_reflection_clearMemoryCache(SwiftReflectionContextRef ContextRef) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  auto &Reader = static_cast<CMemoryReader &>(Context->getReader());
+  Reader.clearCache();
+}
+
 void
 swift_reflection_addReflectionInfo(SwiftReflectionContextRef ContextRef,
                                    swift_reflection_info_t Info) {
@@ -266,6 +283,47 @@ swift_reflection_childOfInstance(SwiftReflectionContextRef ContextRef,
   return convertChild(TI, Index);
 }
 
+size_t
+swift_reflection_snapshotObjects(SwiftReflectionContextRef ContextRef,
+                                 const uintptr_t *Objects,
+                                 size_t NumObjects,
+                                 swift_object_snapshot_t *OutSnapshots,
+                                 uintptr_t *OutReferences,
+                                 size_t MaxReferences) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  auto &Reader = static_cast<CMemoryReader &>(Context->getReader());
+
+  // The remote process is assumed to be stopped while we walk its heap, so
+  // read it a page at a time unless the client already does so.
+  bool WasCaching = Reader.isCachingEnabled();
+  if (!WasCaching)
+    Reader.setCachingEnabled(true);
+
+  std::vector<NativeReflectionContext::StoredPointer> References;
+  for (size_t i = 0; i < NumObjects; ++i) {
+    auto &Snapshot = OutSnapshots[i];
+    Snapshot = {0, 0, 0, (unsigned)References.size(), 0};
+
+    auto Metadata = Context->readMetadataFromInstance(Objects[i]);
+    if (!Metadata.first)
+      continue;
+    Snapshot.Metadata = Metadata.second;
+    Snapshot.TypeRef = reinterpret_cast<swift_typeref_t>(
+        Context->readTypeFromMetadata(Metadata.second));
+
+    if (auto *TI = Context->readInstanceReferences(Objects[i], References))
+      Snapshot.InstanceSize = TI->getSize();
+    Snapshot.NumReferences = References.size() - Snapshot.FirstReference;
+  }
+
+  if (!WasCaching)
+    Reader.setCachingEnabled(false);
+
+  std::copy_n(References.begin(), std::min(References.size(), MaxReferences),
+              OutReferences);
+  return References.size();
+}
+
 int swift_reflection_projectExistential(SwiftReflectionContextRef ContextRef,
                                         swift_addr_t ExistentialAddress,
                                         swift_typeref_t ExistentialTypeRef,
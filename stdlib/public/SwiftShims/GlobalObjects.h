@@ -39,6 +39,16 @@ struct _SwiftEmptyArrayStorage {
 extern SWIFT_RUNTIME_STDLIB_INTERFACE
 struct _SwiftEmptyArrayStorage _swiftEmptyArrayStorage;
 
+/// Every ASCII code unit in order, as backing storage for one-character
+/// ASCII strings.  ASCII string indexing reads two bytes at a time, so the
+/// code units are followed by a zero byte.
+struct _SwiftASCIICharacterStorage {
+  __swift_uint8_t codeUnits[129];
+};
+
+extern SWIFT_RUNTIME_STDLIB_INTERFACE
+struct _SwiftASCIICharacterStorage _swiftASCIICharacterStorage;
+
 struct _SwiftHashingSecretKey {
   __swift_uint64_t key0;
   __swift_uint64_t key1;
@@ -58,6 +58,10 @@ int _swift_stdlib_putchar_unlocked(int c);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_fwrite_stdout(const void *ptr, __swift_size_t size,
                                            __swift_size_t nitems);
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_size_t _swift_stdlib_fwrite_stdout_unlocked(const void *ptr,
+                                                    __swift_size_t size,
+                                                    __swift_size_t nitems);
 
 // String handling <string.h>
 __attribute__((__pure__)) SWIFT_RUNTIME_STDLIB_INTERFACE __swift_size_t
@@ -67,6 +71,10 @@ __attribute__((__pure__))
 SWIFT_RUNTIME_STDLIB_INTERFACE
 int _swift_stdlib_memcmp(const void *s1, const void *s2, __swift_size_t n);
 
+__attribute__((__pure__))
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void *_swift_stdlib_memchr(const void *s, int c, __swift_size_t n);
+
 // <unistd.h>
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_ssize_t _swift_stdlib_read(int fd, void *buf, __swift_size_t nbyte);
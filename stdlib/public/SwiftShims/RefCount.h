@@ -37,6 +37,15 @@ typedef struct {
 
 #include "swift/Basic/type_traits.h"
 
+// Reference count overflow.
+//
+// Both counts trap rather than wrap around when they would overflow.
+// A wrapped strong count would free a live object.  The check only
+// inspects the value the atomic operation already returns, so it adds
+// a compare and a predictable branch and no extra memory traffic.
+#define SWIFT_REFCOUNT_CHECK_OVERFLOW(overflowed) \
+  do { if (__builtin_expect((overflowed), 0)) __builtin_trap(); } while (0)
+
 // Strong reference count.
 
 // Barriers
@@ -92,25 +101,31 @@ class StrongRefCount {
 
   // Increment the reference count.
   void increment() {
-    __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
+    uint32_t oldval = __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(oldval + RC_ONE < oldval);
   }
 
   void incrementNonAtomic() {
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
-    val += RC_ONE;
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(__builtin_add_overflow(val, RC_ONE, &val));
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
   }
 
   // Increment the reference count by n.
   void increment(uint32_t n) {
-    __atomic_fetch_add(&refCount, n << RC_FLAGS_COUNT, __ATOMIC_RELAXED);
+    uint32_t delta = n << RC_FLAGS_COUNT;
+    uint32_t oldval = __atomic_fetch_add(&refCount, delta, __ATOMIC_RELAXED);
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(oldval + delta < oldval ||
+                                  (delta >> RC_FLAGS_COUNT) != n);
   }
 
   void incrementNonAtomic(uint32_t n) {
+    uint32_t delta = n << RC_FLAGS_COUNT;
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
-    val += n << RC_FLAGS_COUNT;
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(__builtin_add_overflow(val, delta, &val) ||
+                                  (delta >> RC_FLAGS_COUNT) != n);
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
- }
+  }
 
   // Try to simultaneously set the pinned flag and increment the
   // reference count.  If the flag is already set, don't increment the
@@ -130,7 +145,9 @@ class StrongRefCount {
       }
 
       // Try to simultaneously set the flag and increment the reference count.
-      uint32_t newval = oldval + (RC_PINNED_FLAG + RC_ONE);
+      uint32_t newval;
+      SWIFT_REFCOUNT_CHECK_OVERFLOW(
+        __builtin_add_overflow(oldval, RC_PINNED_FLAG + RC_ONE, &newval));
       if (__atomic_compare_exchange(&refCount, &oldval, &newval, 0,
                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
         return true;
@@ -148,7 +165,9 @@ class StrongRefCount {
     }
 
     // Try to simultaneously set the flag and increment the reference count.
-    uint32_t newval = oldval + (RC_PINNED_FLAG + RC_ONE);
+    uint32_t newval;
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(
+      __builtin_add_overflow(oldval, RC_PINNED_FLAG + RC_ONE, &newval));
     __atomic_store_n(&refCount, newval, __ATOMIC_RELAXED);
     return true;
   }
@@ -157,6 +176,7 @@ class StrongRefCount {
   bool tryIncrement() {
     // FIXME: this could be better on LL/SC architectures like arm64
     uint32_t oldval = __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(oldval + RC_ONE < oldval);
     if (oldval & RC_DEALLOCATING_FLAG) {
       __atomic_fetch_sub(&refCount, RC_ONE, __ATOMIC_RELAXED);
       return false;
@@ -397,9 +417,11 @@ private:
 class WeakRefCount {
   uint32_t refCount;
 
+  // The low bit records that the runtime has created a weak reference
+  // side table for the object.
+  // The remaining bits are the reference count.
   enum : uint32_t {
-    // There isn't really a flag here.
-    RC_UNUSED_FLAG = 1,
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -437,17 +459,16 @@ class WeakRefCount {
 
   // Increment the weak reference count.
   void increment() {
-    uint32_t newval = __atomic_add_fetch(&refCount, RC_ONE, __ATOMIC_RELAXED);
-    assert(newval >= RC_ONE  &&  "weak refcount overflow");
-    (void)newval;
+    uint32_t oldval = __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(oldval + RC_ONE < oldval);
   }
 
   /// Increment the weak reference count by n.
   void increment(uint32_t n) {
     uint32_t addval = (n << RC_FLAGS_COUNT);
-    uint32_t newval = __atomic_add_fetch(&refCount, addval, __ATOMIC_RELAXED);
-    assert(newval >= addval  &&  "weak refcount overflow");
-    (void)newval;
+    uint32_t oldval = __atomic_fetch_add(&refCount, addval, __ATOMIC_RELAXED);
+    SWIFT_REFCOUNT_CHECK_OVERFLOW(oldval + addval < oldval ||
+                                  (addval >> RC_FLAGS_COUNT) != n);
   }
 
   // Decrement the weak reference count.
@@ -476,6 +497,17 @@ class WeakRefCount {
   uint32_t getCount() const {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
   }
+
+  // Record that a weak reference side table exists for the object.
+  // The flag is never cleared; the table is detached during deallocation.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
+
+  // Return whether a weak reference side table exists for the object.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
 };
 
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
@@ -487,6 +519,8 @@ static_assert(std::is_trivially_destructible<StrongRefCount>::value,
 static_assert(std::is_trivially_destructible<WeakRefCount>::value,
               "WeakRefCount must be trivially destructible");
 
+#undef SWIFT_REFCOUNT_CHECK_OVERFLOW
+
 // __cplusplus
 #endif
 
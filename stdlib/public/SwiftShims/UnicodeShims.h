@@ -99,6 +99,16 @@ void _swift_stdlib_unicodeCollationIterator_delete(
 SWIFT_RUNTIME_STDLIB_INTERFACE
 const __swift_int32_t *_swift_stdlib_unicode_getASCIICollationTable();
 
+/// The number of code units covered by the simple collation table.
+#define SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE 0x800
+
+/// Returns the collation element of each code unit below
+/// SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE that collates the same wherever
+/// it appears, or -1 (UCOL_NULLORDER) for code units that need the
+/// collation iterator.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+const __swift_int32_t *_swift_stdlib_unicode_getSimpleCollationTable();
+
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_int32_t _swift_stdlib_unicode_strToUpper(
   __swift_uint16_t *Destination, __swift_int32_t DestinationCapacity,
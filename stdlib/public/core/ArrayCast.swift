@@ -75,9 +75,31 @@ public func _arrayDownCastConditionalIndirect<SourceValue, TargetValue>(
 /// `source` to a `TargetElement` and return the resulting array, or
 /// return `nil` if any element fails to convert.
 ///
+/// - Note: When SourceElement and TargetElement are both bridged verbatim,
+///   the elements are checked but not copied; the result shares the storage
+///   of `source`, including an NSArray it was bridged from.
+///
 /// - Complexity: O(n), because each element must be checked.
 public func _arrayConditionalCast<SourceElement, TargetElement>(
   _ source: [SourceElement]
 ) -> [TargetElement]? {
+#if _runtime(_ObjC)
+  if _isClassOrObjCExistential(SourceElement.self)
+  && _isClassOrObjCExistential(TargetElement.self) {
+    let src = source._buffer
+    if let native = src.requestNativeBuffer() {
+      if native.storesOnlyElementsOfType(TargetElement.self) {
+        return Array(_buffer: src.cast(toBufferOf: TargetElement.self))
+      }
+      return nil
+    }
+    for element in source {
+      if !(element is TargetElement) {
+        return nil
+      }
+    }
+    return Array(_immutableCocoaArray: src._asCocoaArray())
+  }
+#endif
   return try? source.map { try ($0 as? TargetElement).unwrappedOrError() }
 }
@@ -186,6 +186,19 @@ func _decodeCString<Encoding : UnicodeCodec>(
   repairingInvalidCodeUnits isRepairing: Bool = true)
 -> (result: String, repairsMade: Bool)? {
 
+  if Encoding.self == UTF8.self {
+    // Contiguous UTF-8 copies its leading ASCII run without decoding it.
+    let utf8 = UnsafeBufferPointer(
+      start: UnsafeRawPointer(cString).assumingMemoryBound(
+        to: UTF8.CodeUnit.self),
+      count: length)
+    let (stringBuffer, hadError) = _StringBuffer.fromUTF8(
+      utf8, repairIllFormedSequences: isRepairing)
+    return stringBuffer.map {
+      (result: String(_storage: $0), repairsMade: hadError)
+    }
+  }
+
   let buffer = UnsafeBufferPointer<Encoding.CodeUnit>(
     start: cString, count: length)
 
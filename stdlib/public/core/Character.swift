@@ -376,6 +376,11 @@ extension String {
     switch c._representation {
     case let .small(_63bits):
       let value = Character._smallValue(_63bits)
+      // A one-byte character has every byte but the lowest set to 0xFF.
+      if _fastPath(value >> 8 == UInt64.max >> 8 && value & 0x80 == 0) {
+        self = String(_StringCore(_singleASCII: UTF8.CodeUnit(value & 0x7F)))
+        return
+      }
       let smallUTF8 = Character._SmallUTF8(value)
       self = String._fromWellFormedCodeUnitSequence(
         UTF8.self, input: smallUTF8)
@@ -0,0 +1,476 @@
+//===--- Deque.swift - A double-ended queue -------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// The header of a `Deque` buffer.
+internal struct _DequeHeader {
+  /// The number of elements the buffer has room for.
+  internal var capacity: Int
+
+  /// The number of elements in the buffer.
+  internal var count: Int
+
+  /// The slot holding the first element.
+  internal var head: Int
+
+  /// The slot holding the element `offset` positions after the first one.
+  ///
+  /// - Precondition: `0 <= offset && offset <= capacity`.
+  internal func slot(_ offset: Int) -> Int {
+    let slot = head + offset
+    return slot >= capacity ? slot - capacity : slot
+  }
+}
+
+/// The storage of a `Deque`: a ring buffer whose `count` elements occupy
+/// consecutive slots starting at `head`, wrapping around to the first slot
+/// after the last one.
+internal final class _DequeBuffer<Element>
+  : ManagedBuffer<_DequeHeader, Element> {
+
+  internal class func _create(
+    minimumCapacity: Int
+  ) -> _DequeBuffer<Element> {
+    let buffer = create(minimumCapacity: minimumCapacity) {
+      _DequeHeader(capacity: $0.capacity, count: 0, head: 0)
+    }
+    return unsafeDowncast(buffer, to: _DequeBuffer<Element>.self)
+  }
+
+  deinit {
+    destroyElements(from: 0, count: header.count)
+  }
+
+  /// Moves or copies `count` elements, starting `offset` positions after the
+  /// first one, to consecutive memory at `target`.
+  ///
+  /// Moving leaves the source slots uninitialized; the caller is responsible
+  /// for updating the header.
+  internal func transferElements(
+    from offset: Int, count: Int,
+    to target: UnsafeMutablePointer<Element>, moving: Bool
+  ) {
+    let start = header.slot(offset)
+    let firstCount = Swift.min(count, header.capacity - start)
+    let elements = firstElementAddress
+    if moving {
+      target.moveInitialize(from: elements + start, count: firstCount)
+      (target + firstCount).moveInitialize(
+        from: elements, count: count - firstCount)
+    } else {
+      target.initialize(from: elements + start, count: firstCount)
+      (target + firstCount).initialize(
+        from: elements, count: count - firstCount)
+    }
+  }
+
+  /// Destroys `count` elements, starting `offset` positions after the first
+  /// one.  The caller is responsible for updating the header.
+  internal func destroyElements(from offset: Int, count: Int) {
+    let start = header.slot(offset)
+    let firstCount = Swift.min(count, header.capacity - start)
+    (firstElementAddress + start).deinitialize(count: firstCount)
+    firstElementAddress.deinitialize(count: count - firstCount)
+  }
+}
+
+/// An ordered, random-access collection that adds and removes elements at
+/// both ends in constant time.
+///
+/// A `Deque` (pronounced "deck") stores its elements in a ring buffer, so
+/// unlike `Array`, removing its first element doesn't move the others.  Use
+/// it for work queues and sliding windows:
+///
+///     var pending: Deque = ["parse", "check"]
+///     pending.append("emit")
+///     while let job = pending.popFirst() {
+///         print(job)
+///     }
+///     // Prints "parse"
+///     // Prints "check"
+///     // Prints "emit"
+///
+/// Like the standard library's other collections, `Deque` has value
+/// semantics: copies share a buffer until one of them is mutated.
+/// Inserting or removing elements anywhere other than the two ends takes
+/// O(*n*) time.
+public struct Deque<Element>
+  : RandomAccessCollection,
+    MutableCollection,
+    RangeReplaceableCollection,
+    ExpressibleByArrayLiteral {
+
+  public typealias Index = Int
+  public typealias Indices = CountableRange<Int>
+  public typealias SubSequence =
+    MutableRangeReplaceableRandomAccessSlice<Deque<Element>>
+
+  /// The elements, or `nil` for an empty deque that has never allocated.
+  internal var _buffer: _DequeBuffer<Element>?
+
+  /// Creates an empty deque.
+  public init() {
+    _buffer = nil
+  }
+
+  /// Creates a deque containing the elements of a sequence.
+  public init<S : Sequence>(_ elements: S)
+    where S.Iterator.Element == Element {
+    self.init()
+    append(contentsOf: elements)
+  }
+
+  /// Creates a deque from the given array literal.
+  public init(arrayLiteral elements: Element...) {
+    self.init(elements)
+  }
+
+  public var startIndex: Int {
+    return 0
+  }
+
+  public var endIndex: Int {
+    return count
+  }
+
+  public func index(after i: Int) -> Int {
+    return i + 1
+  }
+
+  public func index(before i: Int) -> Int {
+    return i - 1
+  }
+
+  /// The number of elements in the deque.
+  public var count: Int {
+    return _buffer?.header.count ?? 0
+  }
+
+  /// The number of elements the deque can hold without allocating new
+  /// storage.
+  public var capacity: Int {
+    return _buffer?.header.capacity ?? 0
+  }
+
+  /// Accesses the element at the specified position.
+  ///
+  /// - Precondition: `position` is a valid index of the deque.
+  public subscript(position: Int) -> Element {
+    get {
+      _precondition(position >= 0 && position < count, "Index out of range")
+      let buffer = _buffer._unsafelyUnwrappedUnchecked
+      defer { _fixLifetime(buffer) }
+      return buffer.firstElementAddress[buffer.header.slot(position)]
+    }
+    set {
+      _precondition(position >= 0 && position < count, "Index out of range")
+      _makeUnique(minimumCapacity: 0)
+      let buffer = _buffer._unsafelyUnwrappedUnchecked
+      defer { _fixLifetime(buffer) }
+      buffer.firstElementAddress[buffer.header.slot(position)] = newValue
+    }
+  }
+
+  public subscript(bounds: Range<Int>) -> SubSequence {
+    get {
+      _failEarlyRangeCheck(bounds, bounds: startIndex..<endIndex)
+      return SubSequence(base: self, bounds: bounds)
+    }
+    set {
+      _failEarlyRangeCheck(bounds, bounds: startIndex..<endIndex)
+      _writeBackMutableSlice(&self, bounds: bounds, slice: newValue)
+    }
+  }
+
+  /// Adds a new element at the end of the deque.
+  ///
+  /// - Complexity: Amortized O(1).
+  public mutating func append(_ newElement: Element) {
+    _makeUnique(minimumCapacity: count + 1)
+    let buffer = _buffer._unsafelyUnwrappedUnchecked
+    let count = buffer.header.count
+    (buffer.firstElementAddress + buffer.header.slot(count))
+      .initialize(to: newElement)
+    buffer.header.count = count + 1
+    _fixLifetime(buffer)
+  }
+
+  /// Adds the elements of a sequence to the end of the deque.
+  ///
+  /// - Complexity: O(*m*) on average, where *m* is the length of
+  ///   `newElements`.
+  public mutating func append<S : Sequence>(contentsOf newElements: S)
+    where S.Iterator.Element == Element {
+    _makeUnique(minimumCapacity: count + newElements.underestimatedCount)
+    for element in newElements {
+      append(element)
+    }
+  }
+
+  /// Adds a new element at the start of the deque.
+  ///
+  /// - Complexity: Amortized O(1).
+  public mutating func prepend(_ newElement: Element) {
+    _makeUnique(minimumCapacity: count + 1)
+    let buffer = _buffer._unsafelyUnwrappedUnchecked
+    let head = buffer.header.head
+    let newHead = (head == 0 ? buffer.header.capacity : head) - 1
+    (buffer.firstElementAddress + newHead).initialize(to: newElement)
+    buffer.header.head = newHead
+    buffer.header.count += 1
+    _fixLifetime(buffer)
+  }
+
+  /// Inserts a new element at the specified position.
+  ///
+  /// - Complexity: O(1) at either end of the deque; otherwise, O(*n*), where
+  ///   *n* is the length of the deque.
+  public mutating func insert(_ newElement: Element, at i: Int) {
+    if i == startIndex {
+      prepend(newElement)
+    } else if i == endIndex {
+      append(newElement)
+    } else {
+      replaceSubrange(i..<i, with: CollectionOfOne(newElement))
+    }
+  }
+
+  /// Removes and returns the element at the specified position.
+  ///
+  /// - Complexity: O(1) at either end of the deque; otherwise, O(*n*), where
+  ///   *n* is the length of the deque.
+  @discardableResult
+  public mutating func remove(at i: Int) -> Element {
+    _precondition(i >= 0 && i < count, "Index out of range")
+    if i == startIndex {
+      return removeFirst()
+    }
+    if i == endIndex - 1 {
+      return _customRemoveLast()._unsafelyUnwrappedUnchecked
+    }
+    let result = self[i]
+    replaceSubrange(i..<(i + 1), with: EmptyCollection())
+    return result
+  }
+
+  /// Removes and returns the first element of the deque.
+  ///
+  /// - Precondition: The deque isn't empty.
+  ///
+  /// - Complexity: O(1) if the deque's storage isn't shared.
+  @discardableResult
+  public mutating func removeFirst() -> Element {
+    _precondition(!isEmpty,
+      "can't remove first element from an empty collection")
+    _makeUnique(minimumCapacity: 0)
+    let buffer = _buffer._unsafelyUnwrappedUnchecked
+    let result = (buffer.firstElementAddress + buffer.header.head).move()
+    buffer.header.head = buffer.header.slot(1)
+    buffer.header.count -= 1
+    _fixLifetime(buffer)
+    return result
+  }
+
+  /// Removes the specified number of elements from the start of the deque.
+  ///
+  /// - Complexity: O(`n`) if the deque's storage isn't shared.
+  public mutating func removeFirst(_ n: Int) {
+    if n == 0 { return }
+    _precondition(n >= 0, "number of elements to remove should be non-negative")
+    _precondition(count >= n,
+      "can't remove more items from a collection than it contains")
+    _makeUnique(minimumCapacity: 0)
+    let buffer = _buffer._unsafelyUnwrappedUnchecked
+    buffer.destroyElements(from: 0, count: n)
+    buffer.header.head = buffer.header.slot(n)
+    buffer.header.count -= n
+  }
+
+  public mutating func _customRemoveLast() -> Element? {
+    _precondition(!isEmpty, "can't remove last element from an empty collection")
+    _makeUnique(minimumCapacity: 0)
+    let buffer = _buffer._unsafelyUnwrappedUnchecked
+    let count = buffer.header.count - 1
+    buffer.header.count = count
+    defer { _fixLifetime(buffer) }
+    return (buffer.firstElementAddress + buffer.header.slot(count)).move()
+  }
+
+  public mutating func _customRemoveLast(_ n: Int) -> Bool {
+    _makeUnique(minimumCapacity: 0)
+    let buffer = _buffer._unsafelyUnwrappedUnchecked
+    let count = buffer.header.count - n
+    buffer.destroyElements(from: count, count: n)
+    buffer.header.count = count
+    return true
+  }
+
+  /// Removes and returns the first element of the deque, or returns `nil` if
+  /// the deque is empty.
+  ///
+  /// - Complexity: O(1) if the deque's storage isn't shared.
+  public mutating func popFirst() -> Element? {
+    return isEmpty ? nil : removeFirst()
+  }
+
+  /// Removes and returns the last element of the deque, or returns `nil` if
+  /// the deque is empty.
+  ///
+  /// - Complexity: O(1) if the deque's storage isn't shared.
+  public mutating func popLast() -> Element? {
+    return isEmpty ? nil : _customRemoveLast()
+  }
+
+  /// Removes all elements from the deque.
+  ///
+  /// - Parameter keepCapacity: Pass `true` to keep the existing capacity of
+  ///   the deque after removing its elements. The default value is `false`.
+  public mutating func removeAll(keepingCapacity keepCapacity: Bool = false) {
+    if keepCapacity && isKnownUniquelyReferenced(&_buffer) {
+      let buffer = _buffer._unsafelyUnwrappedUnchecked
+      buffer.destroyElements(from: 0, count: buffer.header.count)
+      buffer.header.count = 0
+      buffer.header.head = 0
+      return
+    }
+    let capacity = keepCapacity ? self.capacity : 0
+    _buffer = nil
+    if capacity > 0 {
+      reserveCapacity(capacity)
+    }
+  }
+
+  /// Reserves enough space to store the specified number of elements.
+  public mutating func reserveCapacity(_ minimumCapacity: Int) {
+    if isKnownUniquelyReferenced(&_buffer) && capacity >= minimumCapacity {
+      return
+    }
+    _reallocate(minimumCapacity: Swift.max(minimumCapacity, count))
+  }
+
+  /// Replaces a range of elements with the elements in the specified
+  /// collection.
+  ///
+  /// - Complexity: O(`count` + `newElements.count`).
+  public mutating func replaceSubrange<C>(
+    _ subrange: Range<Int>,
+    with newElements: C
+  ) where C : Collection, C.Iterator.Element == Element {
+    _precondition(subrange.lowerBound >= 0,
+      "Deque replace: subrange start is negative")
+    _precondition(subrange.upperBound <= count,
+      "Deque replace: subrange extends past the end")
+
+    let oldCount = count
+    let insertCount: Int = numericCast(newElements.count)
+    let newCount = oldCount - subrange.count + insertCount
+
+    // Lay the result out from the first slot of a new buffer, moving the
+    // surviving elements out of the old one if nothing else shares it.
+    let isUnique = isKnownUniquelyReferenced(&_buffer)
+    let newBuffer = _DequeBuffer<Element>._create(
+      minimumCapacity: Swift.max(newCount, capacity))
+    var target = newBuffer.firstElementAddress
+    if let oldBuffer = _buffer {
+      oldBuffer.transferElements(
+        from: 0, count: subrange.lowerBound, to: target, moving: isUnique)
+    }
+    target += subrange.lowerBound
+
+    var i = newElements.startIndex
+    for _ in 0..<insertCount {
+      target.initialize(to: newElements[i])
+      newElements.formIndex(after: &i)
+      target += 1
+    }
+    _expectEnd(i, newElements)
+
+    if let oldBuffer = _buffer {
+      oldBuffer.transferElements(
+        from: subrange.upperBound, count: oldCount - subrange.upperBound,
+        to: target, moving: isUnique)
+      if isUnique {
+        oldBuffer.destroyElements(
+          from: subrange.lowerBound, count: subrange.count)
+        oldBuffer.header.count = 0
+      }
+    }
+    newBuffer.header.count = newCount
+    _buffer = newBuffer
+  }
+
+  /// Ensures that the buffer is uniquely referenced and has room for at least
+  /// `minimumCapacity` elements, growing it geometrically if it doesn't.
+  @inline(__always)
+  internal mutating func _makeUnique(minimumCapacity: Int) {
+    if _fastPath(
+      isKnownUniquelyReferenced(&_buffer) && capacity >= minimumCapacity) {
+      return
+    }
+    let capacity = self.capacity
+    _reallocate(minimumCapacity: minimumCapacity > capacity
+      ? Swift.max(minimumCapacity, 2 * capacity) : capacity)
+  }
+
+  /// Replaces the buffer with a new one of at least `minimumCapacity`
+  /// elements, whose first element is in its first slot.
+  @inline(never)
+  internal mutating func _reallocate(minimumCapacity: Int) {
+    let isUnique = isKnownUniquelyReferenced(&_buffer)
+    let newBuffer = _DequeBuffer<Element>._create(
+      minimumCapacity: minimumCapacity)
+    if let oldBuffer = _buffer {
+      let count = oldBuffer.header.count
+      oldBuffer.transferElements(
+        from: 0, count: count,
+        to: newBuffer.firstElementAddress, moving: isUnique)
+      if isUnique {
+        oldBuffer.header.count = 0
+      }
+      newBuffer.header.count = count
+    }
+    _buffer = newBuffer
+  }
+}
+
+extension Deque : CustomStringConvertible, CustomDebugStringConvertible {
+  /// A textual representation of the deque and its elements.
+  public var description: String {
+    return Array(self).description
+  }
+
+  /// A textual representation of the deque and its elements, suitable for
+  /// debugging.
+  public var debugDescription: String {
+    return "Deque(\(Array(self).debugDescription))"
+  }
+}
+
+extension Deque : CustomReflectable {
+  /// A mirror that reflects the deque.
+  public var customMirror: Mirror {
+    return Mirror(self, unlabeledChildren: self, displayStyle: .collection)
+  }
+}
+
+/// Returns `true` if these deques contain the same elements.
+public func == <Element : Equatable>(
+  lhs: Deque<Element>, rhs: Deque<Element>
+) -> Bool {
+  return lhs.elementsEqual(rhs)
+}
+
+/// Returns `true` if the deques do not contain the same elements.
+public func != <Element : Equatable>(
+  lhs: Deque<Element>, rhs: Deque<Element>
+) -> Bool {
+  return !lhs.elementsEqual(rhs)
+}
@@ -83,6 +83,77 @@ struct _HashingDetail {
   }
 }
 
+/// A streaming hasher for combining the hash values of several components
+/// into one, e.g. in the `hashValue` of a struct with multiple stored
+/// properties.
+///
+/// Each appended word is mixed into the state with a 64x64->128-bit
+/// multiply whose halves are folded together, which is a single `mul`
+/// (or `mul`/`umulh` pair) on 64-bit targets.  The state is seeded from
+/// the per-process secret key, so the resulting hash values are not
+/// predictable from the input alone.
+public // @testable
+struct _Hasher {
+  @_versioned
+  internal var _state: UInt64
+
+  @_versioned
+  internal var _key: UInt64
+
+  @_versioned
+  internal var _count: UInt64 = 0
+
+  public init() {
+    self.init(seed: _Hashing.secretKey)
+  }
+
+  public init(seed: (UInt64, UInt64)) {
+    _state = seed.0 ^ 0xa076_1d64_78bd_642f
+    _key = seed.1 ^ 0xe703_7ed1_a0b4_28db
+  }
+
+  @_versioned
+  @inline(__always)
+  internal static func _foldedMultiply(_ a: UInt64, _ b: UInt64) -> UInt64 {
+    let product = Builtin.mul_Int128(
+      Builtin.zext_Int64_Int128(a._value),
+      Builtin.zext_Int64_Int128(b._value))
+    let low = UInt64(Builtin.trunc_Int128_Int64(product))
+    let high = UInt64(Builtin.trunc_Int128_Int64(
+      Builtin.lshr_Int128(product, Builtin.zext_Int64_Int128(
+        UInt64(64)._value))))
+    return low ^ high
+  }
+
+  @inline(__always)
+  public mutating func append(_ value: UInt64) {
+    _state = _Hasher._foldedMultiply(_state ^ value, _key ^ _count)
+    _count = _count &+ 0x8ebc_6af0_9c88_c6e3
+  }
+
+  @inline(__always)
+  public mutating func append(_ value: Int) {
+    append(UInt64(UInt(bitPattern: value)))
+  }
+
+  @inline(__always)
+  public mutating func append<T : Hashable>(_ value: T) {
+    append(value.hashValue)
+  }
+
+  /// Returns the hash value of the components appended so far.
+  @inline(__always)
+  public func finalize() -> Int {
+    let hash = _Hasher._foldedMultiply(
+      _state ^ _count, _key ^ 0x5899_65cc_7537_4cc3)
+#if arch(i386) || arch(arm)
+    return Int(truncatingBitPattern: hash)
+#elseif arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+    return Int(Int64(bitPattern: hash))
+#endif
+  }
+}
+
 //
 // API functions.
 //
@@ -502,21 +502,40 @@ internal struct _Stdout : TextOutputStream {
     _swift_stdlib_funlockfile_stdout()
   }
 
+  /// Writes the given bytes to standard output.  The caller must hold the
+  /// stdout lock.
+  func _write(_ bytes: UnsafeRawBufferPointer) {
+    if bytes.isEmpty { return }
+    _swift_stdlib_fwrite_stdout_unlocked(bytes.baseAddress!, bytes.count, 1)
+  }
+
   mutating func write(_ string: String) {
     if string.isEmpty { return }
 
     if let asciiBuffer = string._core.asciiBuffer {
       defer { _fixLifetime(string) }
 
-      _swift_stdlib_fwrite_stdout(
-        UnsafePointer(asciiBuffer.baseAddress!),
-        asciiBuffer.count,
-        1)
+      _write(UnsafeRawBufferPointer(asciiBuffer))
       return
     }
 
-    for c in string.utf8 {
-      _swift_stdlib_putchar_unlocked(Int32(c))
+    // Transcode into a local buffer so that the text reaches stdio in
+    // chunks instead of one byte at a time.
+    var chunk: (
+      UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64,
+      UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64, UInt64
+    ) = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+    withUnsafeMutableBytes(of: &chunk) { buffer in
+      var count = 0
+      for c in string.utf8 {
+        buffer[count] = c
+        count += 1
+        if count == buffer.count {
+          _write(UnsafeRawBufferPointer(buffer))
+          count = 0
+        }
+      }
+      _write(UnsafeRawBufferPointer(start: buffer.baseAddress, count: count))
     }
   }
 }
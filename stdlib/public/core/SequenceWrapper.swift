@@ -92,6 +92,14 @@ extension Sequence
   ) rethrows -> [Base.Iterator.Element] {
     return try _base.filter(isIncluded)
   }
+
+  /// Calls the given closure on each element in the sequence, using the
+  /// base sequence's own `forEach` so that its loop is the only one.
+  public func forEach(
+    _ body: (Base.Iterator.Element) throws -> Void
+  ) rethrows {
+    try _base.forEach(body)
+  }
   
   public func _customContainsEquatableElement(
     _ element: Base.Iterator.Element
@@ -141,14 +141,16 @@ internal struct _SliceBuffer<Element>
   ) -> NativeBuffer? {
     _invariantCheck()
     if _fastPath(_hasNativeBuffer && isUniquelyReferenced()) {
-      if capacity >= minimumCapacity {
+      var native = nativeBuffer
+      let offset = self.firstElementAddress - native.firstElementAddress
+      // The space held by inaccessible trailing elements is available too,
+      // since they are dropped below.
+      if native.capacity - offset >= minimumCapacity {
         // Since we have the last reference, drop any inaccessible
         // trailing elements in the underlying storage.  That will
         // tend to reduce shuffling of later elements.  Since this
         // function isn't called for subscripting, this won't slow
         // down that case.
-        var native = nativeBuffer
-        let offset = self.firstElementAddress - native.firstElementAddress
         let backingCount = native.count
         let myCount = count
 
@@ -0,0 +1,408 @@
+//===--- SmallArray.swift - An array with inline storage ------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// The elements of a `SmallArray`: up to four of them inline, or any number
+/// in a heap buffer.
+internal enum _SmallArrayStorage<Element> {
+  case inline0
+  case inline1(Element)
+  case inline2(Element, Element)
+  case inline3(Element, Element, Element)
+  case inline4(Element, Element, Element, Element)
+  case heap(ContiguousArray<Element>)
+}
+
+/// An ordered, random-access collection that stores up to four elements
+/// inline and moves them to a heap buffer when it grows beyond that.
+///
+/// A `SmallArray` with four or fewer elements doesn't allocate memory, and
+/// copying one copies its elements instead of retaining a shared buffer.
+/// Use it instead of `Array` for short-lived arrays that usually hold only
+/// a few elements, such as argument lists or path components:
+///
+///     var components: SmallArray = ["usr", "local"]
+///     components.append("bin")
+///     // No memory has been allocated for `components`.
+///
+/// Once a `SmallArray` has moved its elements to the heap it keeps them
+/// there, shares the buffer between copies, and behaves like a
+/// `ContiguousArray`.
+public struct SmallArray<Element>
+  : RandomAccessCollection,
+    MutableCollection,
+    RangeReplaceableCollection,
+    ExpressibleByArrayLiteral {
+
+  public typealias Index = Int
+  public typealias Indices = CountableRange<Int>
+  public typealias SubSequence =
+    MutableRangeReplaceableRandomAccessSlice<SmallArray<Element>>
+
+  /// The number of elements a `SmallArray` holds without allocating memory.
+  public static var inlineCapacity: Int {
+    return 4
+  }
+
+  internal var _storage: _SmallArrayStorage<Element>
+
+  /// Creates an empty small array.
+  public init() {
+    _storage = .inline0
+  }
+
+  /// Creates a small array containing the elements of a sequence.
+  public init<S : Sequence>(_ elements: S)
+    where S.Iterator.Element == Element {
+    self.init()
+    append(contentsOf: elements)
+  }
+
+  /// Creates a small array from the given array literal.
+  public init(arrayLiteral elements: Element...) {
+    self.init(elements)
+  }
+
+  public var startIndex: Int {
+    return 0
+  }
+
+  public var endIndex: Int {
+    return count
+  }
+
+  public func index(after i: Int) -> Int {
+    return i + 1
+  }
+
+  public func index(before i: Int) -> Int {
+    return i - 1
+  }
+
+  /// The number of elements in the small array.
+  public var count: Int {
+    switch _storage {
+    case .inline0: return 0
+    case .inline1: return 1
+    case .inline2: return 2
+    case .inline3: return 3
+    case .inline4: return 4
+    case .heap(let elements): return elements.count
+    }
+  }
+
+  /// Accesses the element at the specified position.
+  ///
+  /// - Precondition: `position` is a valid index of the small array.
+  public subscript(position: Int) -> Element {
+    get {
+      switch (_storage, position) {
+      case (.inline1(let e), 0), (.inline2(let e, _), 0),
+           (.inline3(let e, _, _), 0), (.inline4(let e, _, _, _), 0):
+        return e
+      case (.inline2(_, let e), 1), (.inline3(_, let e, _), 1),
+           (.inline4(_, let e, _, _), 1):
+        return e
+      case (.inline3(_, _, let e), 2), (.inline4(_, _, let e, _), 2):
+        return e
+      case (.inline4(_, _, _, let e), 3):
+        return e
+      case (.heap(let elements), _):
+        return elements[position]
+      default:
+        _preconditionFailure("Index out of range")
+      }
+    }
+    set {
+      switch _storage {
+      case .heap(var elements):
+        // Drop the storage's reference so that `elements` is unique.
+        _storage = .inline0
+        elements[position] = newValue
+        _storage = .heap(elements)
+      default:
+        _precondition(position >= 0 && position < count, "Index out of range")
+        var elements = _inlineElements
+        switch position {
+        case 0: elements.0 = newValue
+        case 1: elements.1 = newValue
+        case 2: elements.2 = newValue
+        default: elements.3 = newValue
+        }
+        _storage = SmallArray._inlineStorage(elements, count: count)
+      }
+    }
+  }
+
+  public subscript(bounds: Range<Int>) -> SubSequence {
+    get {
+      _failEarlyRangeCheck(bounds, bounds: startIndex..<endIndex)
+      return SubSequence(base: self, bounds: bounds)
+    }
+    set {
+      _failEarlyRangeCheck(bounds, bounds: startIndex..<endIndex)
+      _writeBackMutableSlice(&self, bounds: bounds, slice: newValue)
+    }
+  }
+
+  /// Adds a new element at the end of the small array.
+  ///
+  /// Appending the fifth element moves all of the elements to the heap.
+  ///
+  /// - Complexity: Amortized O(1).
+  public mutating func append(_ newElement: Element) {
+    switch _storage {
+    case .inline0:
+      _storage = .inline1(newElement)
+    case let .inline1(e0):
+      _storage = .inline2(e0, newElement)
+    case let .inline2(e0, e1):
+      _storage = .inline3(e0, e1, newElement)
+    case let .inline3(e0, e1, e2):
+      _storage = .inline4(e0, e1, e2, newElement)
+    case let .inline4(e0, e1, e2, e3):
+      var elements = ContiguousArray<Element>()
+      elements.reserveCapacity(2 * SmallArray.inlineCapacity)
+      elements.append(e0)
+      elements.append(e1)
+      elements.append(e2)
+      elements.append(e3)
+      elements.append(newElement)
+      _storage = .heap(elements)
+    case .heap(var elements):
+      _storage = .inline0
+      elements.append(newElement)
+      _storage = .heap(elements)
+    }
+  }
+
+  /// Reserves enough space to store the specified number of elements.
+  ///
+  /// Reserving more than `inlineCapacity` elements moves the elements to
+  /// the heap.
+  public mutating func reserveCapacity(_ minimumCapacity: Int) {
+    switch _storage {
+    case .heap(var elements):
+      _storage = .inline0
+      elements.reserveCapacity(minimumCapacity)
+      _storage = .heap(elements)
+    default:
+      if minimumCapacity > SmallArray.inlineCapacity {
+        _storage = .heap(_copyToHeap(minimumCapacity: minimumCapacity))
+      }
+    }
+  }
+
+  /// Replaces a range of elements with the elements in the specified
+  /// collection.
+  ///
+  /// - Complexity: O(`count` + `newElements.count`).
+  public mutating func replaceSubrange<C>(
+    _ subrange: Range<Int>,
+    with newElements: C
+  ) where C : Collection, C.Iterator.Element == Element {
+    _precondition(subrange.lowerBound >= 0,
+      "SmallArray replace: subrange start is negative")
+    _precondition(subrange.upperBound <= count,
+      "SmallArray replace: subrange extends past the end")
+
+    if case .heap(var elements) = _storage {
+      _storage = .inline0
+      elements.replaceSubrange(subrange, with: newElements)
+      _storage = .heap(elements)
+      return
+    }
+
+    let newCount: Int =
+      count - subrange.count + numericCast(newElements.count)
+    var result: SmallArray
+    if newCount > SmallArray.inlineCapacity {
+      result = SmallArray(_storage: .heap([]))
+      result.reserveCapacity(newCount)
+    } else {
+      result = SmallArray()
+    }
+    for i in 0..<subrange.lowerBound {
+      result.append(self[i])
+    }
+    for element in newElements {
+      result.append(element)
+    }
+    for i in subrange.upperBound..<count {
+      result.append(self[i])
+    }
+    self = result
+  }
+
+  /// Calls a closure with a pointer to the small array's contiguous storage.
+  ///
+  /// For a small array stored inline, the pointer addresses a temporary copy
+  /// of its elements on the stack.
+  public func withUnsafeBufferPointer<R>(
+    _ body: (UnsafeBufferPointer<Element>) throws -> R
+  ) rethrows -> R {
+    if case .heap(let elements) = _storage {
+      return try elements.withUnsafeBufferPointer(body)
+    }
+
+    let count = self.count
+    if count == 0 {
+      return try body(UnsafeBufferPointer(start: nil, count: 0))
+    }
+    var elements = _inlineElements
+    return try withUnsafeMutablePointer(to: &elements) {
+      try body(UnsafeBufferPointer(
+        start: UnsafeRawPointer($0).assumingMemoryBound(to: Element.self),
+        count: count))
+    }
+  }
+
+  /// Calls the given closure with a pointer to the small array's mutable
+  /// contiguous storage.
+  ///
+  /// - Warning: Do not rely on anything about `self` (the small array that
+  ///   is the target of this method) during the execution of `body`: it may
+  ///   not appear to have its correct value. Instead, use only the
+  ///   `UnsafeMutableBufferPointer` argument to `body`.
+  public mutating func withUnsafeMutableBufferPointer<R>(
+    _ body: (inout UnsafeMutableBufferPointer<Element>) throws -> R
+  ) rethrows -> R {
+    if case .heap(var elements) = _storage {
+      _storage = .inline0
+      defer { _storage = .heap(elements) }
+      return try elements.withUnsafeMutableBufferPointer(body)
+    }
+
+    let count = self.count
+    if count == 0 {
+      var bufferPointer = UnsafeMutableBufferPointer<Element>(
+        start: nil, count: 0)
+      return try body(&bufferPointer)
+    }
+
+    // Work on the elements in a homogeneous tuple, whose memory is bound to
+    // the element type, and store them back afterwards.
+    var elements = _inlineElements
+    _storage = .inline0
+    defer { _storage = SmallArray._inlineStorage(elements, count: count) }
+    return try withUnsafeMutablePointer(to: &elements) {
+      let start =
+        UnsafeMutableRawPointer($0).assumingMemoryBound(to: Element.self)
+      var bufferPointer = UnsafeMutableBufferPointer(start: start, count: count)
+      let result = try body(&bufferPointer)
+      _precondition(
+        bufferPointer.baseAddress == start && bufferPointer.count == count,
+        "SmallArray withUnsafeMutableBufferPointer: replacing the buffer is not allowed")
+      return result
+    }
+  }
+
+  public mutating func _withUnsafeMutableBufferPointerIfSupported<R>(
+    _ body: (UnsafeMutablePointer<Element>, Int) throws -> R
+  ) rethrows -> R? {
+    if isEmpty {
+      return nil
+    }
+    return try withUnsafeMutableBufferPointer {
+      (bufferPointer) -> R in
+      return try body(bufferPointer.baseAddress!, bufferPointer.count)
+    }
+  }
+
+  public func _copyToContiguousArray() -> ContiguousArray<Element> {
+    if case .heap(let elements) = _storage {
+      return elements
+    }
+    return _copyToHeap(minimumCapacity: count)
+  }
+
+  internal init(_storage: _SmallArrayStorage<Element>) {
+    self._storage = _storage
+  }
+
+  /// The inline elements, with the unused trailing positions filled in
+  /// with copies of the first element.
+  ///
+  /// - Precondition: The elements are stored inline and there is at least
+  ///   one.
+  internal var _inlineElements: (Element, Element, Element, Element) {
+    switch _storage {
+    case let .inline1(e0):
+      return (e0, e0, e0, e0)
+    case let .inline2(e0, e1):
+      return (e0, e1, e0, e0)
+    case let .inline3(e0, e1, e2):
+      return (e0, e1, e2, e0)
+    case let .inline4(e0, e1, e2, e3):
+      return (e0, e1, e2, e3)
+    case .inline0, .heap:
+      _sanityCheckFailure("no inline elements")
+    }
+  }
+
+  internal static func _inlineStorage(
+    _ elements: (Element, Element, Element, Element),
+    count: Int
+  ) -> _SmallArrayStorage<Element> {
+    switch count {
+    case 1: return .inline1(elements.0)
+    case 2: return .inline2(elements.0, elements.1)
+    case 3: return .inline3(elements.0, elements.1, elements.2)
+    case 4: return .inline4(elements.0, elements.1, elements.2, elements.3)
+    default: _sanityCheckFailure("too many elements to store inline")
+    }
+  }
+
+  internal func _copyToHeap(
+    minimumCapacity: Int
+  ) -> ContiguousArray<Element> {
+    var elements = ContiguousArray<Element>()
+    elements.reserveCapacity(minimumCapacity)
+    for i in 0..<count {
+      elements.append(self[i])
+    }
+    return elements
+  }
+}
+
+extension SmallArray : CustomStringConvertible, CustomDebugStringConvertible {
+  /// A textual representation of the small array and its elements.
+  public var description: String {
+    return Array(self).description
+  }
+
+  /// A textual representation of the small array and its elements, suitable
+  /// for debugging.
+  public var debugDescription: String {
+    return "SmallArray(\(Array(self).debugDescription))"
+  }
+}
+
+extension SmallArray : CustomReflectable {
+  /// A mirror that reflects the small array.
+  public var customMirror: Mirror {
+    return Mirror(self, unlabeledChildren: self, displayStyle: .collection)
+  }
+}
+
+/// Returns `true` if these small arrays contain the same elements.
+public func == <Element : Equatable>(
+  lhs: SmallArray<Element>, rhs: SmallArray<Element>
+) -> Bool {
+  return lhs.elementsEqual(rhs)
+}
+
+/// Returns `true` if the small arrays do not contain the same elements.
+public func != <Element : Equatable>(
+  lhs: SmallArray<Element>, rhs: SmallArray<Element>
+) -> Bool {
+  return !(lhs == rhs)
+}
@@ -344,8 +344,13 @@ extension String : _ExpressibleByBuiltinUnicodeScalarLiteral {
   @effects(readonly)
   public // @testable
   init(_builtinUnicodeScalarLiteral value: Builtin.Int32) {
+    let scalar = UInt32(value)
+    if _fastPath(scalar < 0x80) {
+      self = String(_StringCore(_singleASCII: UTF8.CodeUnit(scalar)))
+      return
+    }
     self = String._fromWellFormedCodeUnitSequence(
-      UTF32.self, input: CollectionOfOne(UInt32(value)))
+      UTF32.self, input: CollectionOfOne(scalar))
   }
 }
 
@@ -143,6 +143,61 @@ public struct _StringBuffer {
     }
   }
 
+  /// Creates a buffer from contiguous UTF-8 code units.
+  ///
+  /// The leading ASCII run is found a word at a time and copied without
+  /// decoding; only the code units after it are transcoded.  Entirely ASCII
+  /// input is copied in bulk into an ASCII buffer.
+  static func fromUTF8(
+    _ input: UnsafeBufferPointer<UTF8.CodeUnit>,
+    repairIllFormedSequences: Bool,
+    minimumCapacity: Int = 0
+  ) -> (_StringBuffer?, hadError: Bool) {
+    let asciiCount = UTF8._asciiPrefixCount(input)
+    if asciiCount == input.count {
+      let result = _StringBuffer(
+          capacity: max(asciiCount, minimumCapacity),
+          initialSize: asciiCount,
+          elementWidth: 1)
+      if let source = input.baseAddress {
+        result.start.copyBytes(from: source, count: asciiCount)
+      }
+      return (result, false)
+    }
+
+    let rest = UnsafeBufferPointer(
+      start: input.baseAddress! + asciiCount,
+      count: input.count - asciiCount)
+    guard let (restUTF16Count, _) = UTF16.transcodedLength(
+        of: rest.makeIterator(),
+        decodedAs: UTF8.self,
+        repairingIllFormedSequences: repairIllFormedSequences) else {
+      return (nil, true)
+    }
+
+    let utf16Count = asciiCount + restUTF16Count
+    let result = _StringBuffer(
+        capacity: max(utf16Count, minimumCapacity),
+        initialSize: utf16Count,
+        elementWidth: 2)
+
+    var p = result._storage.baseAddress
+    for c in UnsafeBufferPointer(start: input.baseAddress, count: asciiCount) {
+      p.pointee = UTF16.CodeUnit(c)
+      p += 1
+    }
+    let sink: (UTF16.CodeUnit) -> Void = {
+      p.pointee = $0
+      p += 1
+    }
+    let hadError = transcode(
+      rest.makeIterator(),
+      from: UTF8.self, to: UTF16.self,
+      stoppingOnError: !repairIllFormedSequences,
+      into: sink)
+    return (result, hadError)
+  }
+
   /// A pointer to the start of this buffer's data area.
   public // @testable
   var start: UnsafeMutableRawPointer {
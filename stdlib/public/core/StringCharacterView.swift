@@ -258,6 +258,21 @@ extension String.CharacterView : BidirectionalCollection {
     if start == end {
       return 0
     }
+
+    // Fast path: no code point below U+0300 has a grapheme cluster break
+    // property that can join it to its neighbor, except for CR LF.  This
+    // covers ASCII and Latin-1 text without consulting the property trie.
+    let coreStart = start._position - _coreOffset
+    let u0 = _core[coreStart]
+    if _fastPath(u0 < 0x300) {
+      if coreStart + 1 == _core.count {
+        return 1
+      }
+      let u1 = _core[coreStart + 1]
+      if _fastPath(u1 < 0x300) {
+        return u0 == 0x0D && u1 == 0x0A ? 2 : 1
+      }
+    }
     
     let startIndexUTF16 = start._position
     let graphemeClusterBreakProperty =
@@ -300,6 +315,19 @@ extension String.CharacterView : BidirectionalCollection {
     if start == end {
       return 0
     }
+
+    // Fast path: see _measureExtendedGraphemeClusterForward.
+    let coreEnd = end._position - _coreOffset
+    let u1 = _core[coreEnd - 1]
+    if _fastPath(u1 < 0x300) {
+      if coreEnd - 1 == 0 {
+        return 1
+      }
+      let u0 = _core[coreEnd - 2]
+      if _fastPath(u0 < 0x300) {
+        return u0 == 0x0D && u1 == 0x0A ? 2 : 1
+      }
+    }
     
     let endIndexUTF16 = end._position
     let graphemeClusterBreakProperty =
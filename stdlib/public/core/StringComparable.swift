@@ -134,6 +134,18 @@ extension String : Equatable {
         rhs._core.count) == 0
     }
 #endif
+    // Strings with the same code units are equal however they collate, which
+    // settles a successful hash table lookup without ICU.
+    if lhs._core.hasContiguousStorage && rhs._core.hasContiguousStorage &&
+       lhs._core.elementWidth == rhs._core.elementWidth &&
+       lhs._core.count == rhs._core.count {
+      if lhs._core.count == 0 ||
+         _swift_stdlib_memcmp(
+           lhs._core._baseAddress!, rhs._core._baseAddress!,
+           lhs._core.count << lhs._core.elementShift) == 0 {
+        return true
+      }
+    }
     return lhs._compareString(rhs) == 0
   }
 }
@@ -574,6 +574,39 @@ public struct _StringCore {
         count: count)
     return !unsafeBuffer.contains { $0 > 0x7f }
   }
+
+  /// Returns the position of the first code unit in `bounds` that is equal
+  /// to `u`, or `nil` if there is none.
+  ///
+  /// ASCII storage is searched with `memchr`.
+  ///
+  /// - Precondition: The string has contiguous storage.
+  internal func _index(
+    of u: UTF16.CodeUnit, in bounds: Range<Int>
+  ) -> Int? {
+    _sanityCheck(hasContiguousStorage)
+    _sanityCheck(bounds.lowerBound >= 0 && bounds.upperBound <= count)
+    if _fastPath(elementWidth == 1) {
+      if u > 0x7f {
+        return nil
+      }
+      let start = _baseAddress! + bounds.lowerBound
+      guard let match = _swift_stdlib_memchr(
+        start, Int32(u), bounds.upperBound - bounds.lowerBound) else {
+        return nil
+      }
+      return bounds.lowerBound + (match - start)
+    }
+    let utf16 = _baseAddress!.assumingMemoryBound(to: UTF16.CodeUnit.self)
+    var i = bounds.lowerBound
+    while i != bounds.upperBound {
+      if utf16[i] == u {
+        return i
+      }
+      i += 1
+    }
+    return nil
+  }
 }
 
 extension _StringCore : RandomAccessCollection {
@@ -589,6 +622,21 @@ extension _StringCore : RandomAccessCollection {
   var endIndex: Int {
     return count
   }
+
+  public func _customIndexOfEquatableElement(
+    _ element: UTF16.CodeUnit
+  ) -> Int?? {
+    if _slowPath(!hasContiguousStorage) {
+      return nil
+    }
+    return Optional(_index(of: element, in: 0..<count))
+  }
+
+  public func _customContainsEquatableElement(
+    _ element: UTF16.CodeUnit
+  ) -> Bool? {
+    return _customIndexOfEquatableElement(element).map { $0 != nil }
+  }
 }
 
 extension _StringCore : RangeReplaceableCollection {
@@ -738,3 +786,19 @@ var _emptyStringStorage: UInt32 = 0
 var _emptyStringBase: UnsafeMutableRawPointer {
   return UnsafeMutableRawPointer(Builtin.addressof(&_emptyStringStorage))
 }
+
+extension _StringCore {
+  /// Create the implementation of a one-character ASCII string.  It points
+  /// into statically-allocated storage, so it needs no buffer and no owner.
+  init(_singleASCII codeUnit: UTF8.CodeUnit) {
+    _sanityCheck(codeUnit < 0x80)
+    let base = UnsafeMutableRawPointer(
+      Builtin.addressof(&_swiftASCIICharacterStorage))
+    self.init(
+      baseAddress: base + Int(codeUnit),
+      count: 1,
+      elementShift: 0,
+      hasCocoaBuffer: false,
+      owner: nil)
+  }
+}
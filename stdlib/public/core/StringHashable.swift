@@ -38,9 +38,39 @@ extension _Unicode {
     return hasher._finalizeAndReturnIntHash()
   }
 
+  /// Hashes `string` with the cached collation elements of its code units,
+  /// or returns nil if a code unit's collation depends on its neighbours.
+  internal static func hashSimpleUTF16(
+    _ string: UnsafeBufferPointer<UInt16>
+  ) -> Int? {
+    let collationTable = _swift_stdlib_unicode_getSimpleCollationTable()
+    let tableSize = UInt16(SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE)
+    var hasher = _SipHash13Context(key: _Hashing.secretKey)
+    for c in string {
+      if c >= tableSize {
+        return nil
+      }
+      let element = collationTable[Int(c)]
+      // UCOL_NULLORDER marks code units that need the collation iterator.
+      if element == -1 {
+        return nil
+      }
+      // Ignore zero valued collation elements. They don't participate in the
+      // ordering relation.
+      if element != 0 {
+        hasher.append(element)
+      }
+    }
+    return hasher._finalizeAndReturnIntHash()
+  }
+
   internal static func hashUTF16(
     _ string: UnsafeBufferPointer<UInt16>
   ) -> Int {
+    if let hash = hashSimpleUTF16(string) {
+      return hash
+    }
+
     let collationIterator = _swift_stdlib_unicodeCollationIterator_create(
       string.baseAddress!,
       UInt32(string.count))
@@ -352,6 +352,25 @@ extension String {
   public typealias UTF16Index = UTF16View.Index
 }
 
+extension String.UTF16View {
+  public func _customIndexOfEquatableElement(
+    _ element: UTF16.CodeUnit
+  ) -> Index?? {
+    if _slowPath(!_core.hasContiguousStorage) {
+      return nil
+    }
+    let start = _internalIndex(at: _offset)
+    let match = _core._index(of: element, in: start..<(start + _length))
+    return Optional(match.map { Index(_offset: $0 - _core.startIndex) })
+  }
+
+  public func _customContainsEquatableElement(
+    _ element: UTF16.CodeUnit
+  ) -> Bool? {
+    return _customIndexOfEquatableElement(element).map { $0 != nil }
+  }
+}
+
 extension String.UTF16View.Index : Comparable {
   // FIXME: swift-3-indexing-model: add complete set of forwards for Comparable 
   //        assuming String.UTF8View.Index continues to exist
@@ -334,6 +334,18 @@ extension String {
       }
     }
 
+    /// The number of UTF-8 code units in the view.
+    ///
+    /// - Complexity: O(1) if the underlying string is stored as ASCII;
+    ///   otherwise, O(*n*), where *n* is the length of the view.
+    public var count: Int {
+      if _fastPath(_core.isASCII) {
+        // Every code unit of an ASCII string is a single UTF-8 code unit.
+        return _endIndex._coreIndex &- _startIndex._coreIndex
+      }
+      return distance(from: _startIndex, to: _endIndex)
+    }
+
     /// Accesses the code unit at the given position.
     ///
     /// The following example uses the subscript to print the value of a
@@ -395,6 +407,20 @@ extension String {
   ///     }
   ///     // Prints "6"
   public var utf8CString: ContiguousArray<CChar> {
+    if let asciiBuffer = self._core.asciiBuffer {
+      // ASCII code units are already UTF-8; copy them in bulk.
+      let count = asciiBuffer.count
+      var result = ContiguousArray<CChar>(repeating: 0, count: count + 1)
+      if count != 0 {
+        result.withUnsafeMutableBufferPointer {
+          _memcpy(
+            dest: UnsafeMutableRawPointer($0.baseAddress!),
+            src: asciiBuffer.baseAddress!,
+            size: numericCast(count))
+        }
+      }
+      return result
+    }
     var result = ContiguousArray<CChar>()
     result.reserveCapacity(utf8.count + 1)
     for c in utf8 {
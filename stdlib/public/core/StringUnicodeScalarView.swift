@@ -622,6 +622,96 @@ extension String.UnicodeScalarView {
   }
 }
 
+extension String.UnicodeScalarView {
+  /// Returns the code unit to search for to find `element`, or `nil` if
+  /// the scalar can't be found by searching code units.
+  ///
+  /// A scalar in the BMP that is not a surrogate is encoded as a single
+  /// code unit that can't be part of any other scalar, so the first such
+  /// code unit is the first occurrence of the scalar.  U+FFFD is excluded
+  /// because it is also what unpaired surrogates decode to.
+  internal func _searchableCodeUnit(
+    for element: UnicodeScalar
+  ) -> UTF16.CodeUnit? {
+    let value = element.value
+    if _slowPath(
+      !_core.hasContiguousStorage || value >= 0x10000 || value == 0xfffd
+        || (value >= 0xd800 && value < 0xe000)
+    ) {
+      return nil
+    }
+    return UTF16.CodeUnit(value)
+  }
+
+  public func _customIndexOfEquatableElement(
+    _ element: UnicodeScalar
+  ) -> Index?? {
+    guard let u = _searchableCodeUnit(for: element) else {
+      return nil
+    }
+    let match = _core._index(of: u, in: 0..<_core.count)
+    return Optional(match.map { _fromCoreIndex($0) })
+  }
+
+  public func _customContainsEquatableElement(
+    _ element: UnicodeScalar
+  ) -> Bool? {
+    return _customIndexOfEquatableElement(element).map { $0 != nil }
+  }
+
+  /// Returns the longest possible subsequences of the view, in order, around
+  /// scalars equal to the given scalar.
+  ///
+  /// This is equivalent to the `split(separator:maxSplits:
+  /// omittingEmptySubsequences:)` method on `Collection`, but finds the
+  /// separators by scanning the string's code units directly when possible.
+  public func split(
+    separator: UnicodeScalar,
+    maxSplits: Int = Int.max,
+    omittingEmptySubsequences: Bool = true
+  ) -> [String.UnicodeScalarView] {
+    guard let u = _searchableCodeUnit(for: separator) else {
+      return split(
+        maxSplits: maxSplits,
+        omittingEmptySubsequences: omittingEmptySubsequences,
+        whereSeparator: { $0 == separator })
+    }
+    _precondition(maxSplits >= 0, "Must take zero or more splits")
+
+    let end = _core.count
+    var result: [String.UnicodeScalarView] = []
+    var subSequenceStart = 0
+
+    func appendSubsequence(end: Int) -> Bool {
+      if subSequenceStart == end && omittingEmptySubsequences {
+        return false
+      }
+      result.append(
+        self[_fromCoreIndex(subSequenceStart)..<_fromCoreIndex(end)])
+      return true
+    }
+
+    if maxSplits == 0 || end == 0 {
+      _ = appendSubsequence(end: end)
+      return result
+    }
+
+    while let match = _core._index(of: u, in: subSequenceStart..<end) {
+      let didAppend = appendSubsequence(end: match)
+      subSequenceStart = match + 1
+      if didAppend && result.count == maxSplits {
+        break
+      }
+    }
+
+    if subSequenceStart != end || !omittingEmptySubsequences {
+      result.append(self[_fromCoreIndex(subSequenceStart)..<endIndex])
+    }
+
+    return result
+  }
+}
+
 // Reflection
 extension String.UnicodeScalarView : CustomReflectable {
   /// Returns a mirror that reflects the Unicode scalars view of a string.
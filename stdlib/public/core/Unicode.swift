@@ -436,6 +436,44 @@ public struct UTF8 : UnicodeCodec {
   public static func _nullCodeUnitOffset(in input: UnsafePointer<CChar>) -> Int {
     return Int(_swift_stdlib_strlen(input))
   }
+
+  /// Returns the number of code units at the start of `input` that are
+  /// ASCII.  Aligned words are checked a whole word of bytes at a time.
+  internal static func _asciiPrefixCount(
+    _ input: UnsafeBufferPointer<CodeUnit>
+  ) -> Int {
+    guard let base = input.baseAddress else {
+      return 0
+    }
+    let count = input.count
+    let wordSize = MemoryLayout<UInt>.size
+    var i = 0
+
+    // Check single bytes up to the first word boundary.
+    while i < count &&
+          Int(bitPattern: base + i) & (MemoryLayout<UInt>.alignment - 1) != 0 {
+      if base[i] & 0x80 != 0 {
+        return i
+      }
+      i += 1
+    }
+
+    // 0x8080...80
+    let highBits = (UInt.max / 0xff) << 7
+    while count - i >= wordSize {
+      let word = UnsafeRawPointer(base + i).load(as: UInt.self)
+      if word & highBits != 0 {
+        break
+      }
+      i += wordSize
+    }
+
+    // Find the exact end of the run in the last, partial or non-ASCII, word.
+    while i < count && base[i] & 0x80 == 0 {
+      i += 1
+    }
+    return i
+  }
 }
 
 /// A codec for translating between Unicode scalar values and UTF-16 code
@@ -0,0 +1,501 @@
+//===--- AllocationProfiler.cpp - Sampling allocation profiler ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Allocations are sampled once every SWIFT_DEBUG_ALLOCATION_PROFILE_RATE
+// bytes on average (512KB by default).  The distance between samples is
+// drawn from an exponential distribution, so every allocated byte is
+// equally likely to be sampled, and each sample is weighted by the inverse
+// of its probability when the profile is written.
+//
+// Samples with the same type and stack are merged.  The profile is written
+// as an uncompressed pprof protocol buffer with the sample types
+// alloc_objects and alloc_space; each sample carries the allocated type's
+// name in its "type" label.  Frames are symbolized with dladdr, and on
+// Linux the loaded images are recorded as mappings so that pprof can
+// symbolize the rest from the binaries.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AllocationProfiler.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Mutex.h"
+#include "Private.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if (defined(__linux__) && !defined(__ANDROID__)) || defined(__APPLE__)
+#define SWIFT_HAS_ALLOCATION_PROFILER 1
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#define SWIFT_HAS_ALLOCATION_PROFILER 0
+#endif
+
+#if SWIFT_HAS_ALLOCATION_PROFILER && defined(__linux__)
+#include <link.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#endif
+
+using namespace swift;
+
+std::atomic<int> swift::_swift_allocationProfilingState{-1};
+
+#if !SWIFT_HAS_ALLOCATION_PROFILER
+
+bool swift::_swift_computeAllocationProfilingEnabled() {
+  _swift_allocationProfilingState.store(0, std::memory_order_relaxed);
+  return false;
+}
+
+void swift::_swift_noteProfiledAllocation(const HeapMetadata *metadata,
+                                          size_t size) {}
+
+#else
+
+static constexpr unsigned MaxProfileFrames = 64;
+static constexpr size_t DefaultSampleRate = 512 * 1024;
+
+namespace {
+  /// All the sampled allocations of one type from one stack.
+  struct AllocationSample {
+    const HeapMetadata *Type;
+    unsigned NumFrames;
+    void *Frames[MaxProfileFrames];
+
+    /// The estimated number of objects and bytes these samples represent.
+    double Objects = 0;
+    double Bytes = 0;
+
+    /// The next sample with the same hash, or -1.
+    int NextWithSameHash = -1;
+
+    bool matches(const HeapMetadata *type, void * const *frames,
+                 unsigned numFrames) const {
+      return Type == type && NumFrames == numFrames &&
+             memcmp(Frames, frames, numFrames * sizeof(void *)) == 0;
+    }
+  };
+
+  struct AllocationSamples {
+    StaticMutex Lock;
+    std::vector<AllocationSample> Samples;
+
+    /// The first sample for each hash.
+    std::unordered_map<uint64_t, int> FirstSampleByHash;
+  };
+
+  /// The per-thread distance to the next sample.
+  struct ThreadSamplingState {
+    bool Initialized = false;
+    int64_t BytesUntilSample = 0;
+    uint64_t RandomState = 0;
+  };
+}
+
+static const char *ProfilePath;
+static size_t ProfileSampleRate = DefaultSampleRate;
+static Lazy<AllocationSamples> Samples;
+static thread_local ThreadSamplingState ThreadSampling;
+
+static uint64_t nextRandom(ThreadSamplingState &state) {
+  // xorshift64*
+  uint64_t x = state.RandomState;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  state.RandomState = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+/// Draw the number of bytes until the next sample.
+static int64_t nextSampleInterval(ThreadSamplingState &state) {
+  // A uniform value in (0, 1], from the top 53 bits.
+  double u = double((nextRandom(state) >> 11) + 1) / 9007199254740992.0;
+  double interval = -std::log(u) * double(ProfileSampleRate);
+  return int64_t(interval) + 1;
+}
+
+static uint64_t hashSample(const HeapMetadata *type, void * const *frames,
+                           unsigned numFrames) {
+  // FNV-1a over the type and the frame addresses.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto mix = [&](uintptr_t value) {
+    for (unsigned i = 0; i != sizeof(value); ++i) {
+      hash ^= (value >> (i * 8)) & 0xff;
+      hash *= 0x100000001b3ULL;
+    }
+  };
+  mix(uintptr_t(type));
+  for (unsigned i = 0; i != numFrames; ++i)
+    mix(uintptr_t(frames[i]));
+  return hash;
+}
+
+static void recordSample(const HeapMetadata *type, size_t size) {
+  void *frames[MaxProfileFrames + 1];
+  int numFrames = backtrace(frames, MaxProfileFrames + 1);
+  // Drop this function's own frame.
+  void **stack = frames + 1;
+  unsigned depth = numFrames > 1 ? unsigned(numFrames - 1) : 0;
+
+  // An allocation of size bytes is sampled with probability
+  // 1 - exp(-size / rate); weight it by the inverse.
+  double probability =
+    1.0 - std::exp(-double(size) / double(ProfileSampleRate));
+  double weight = probability > 0 ? 1.0 / probability : 1.0;
+
+  uint64_t hash = hashSample(type, stack, depth);
+
+  auto &samples = Samples.get();
+  StaticScopedLock guard(samples.Lock);
+  auto found = samples.FirstSampleByHash.find(hash);
+  int first = found == samples.FirstSampleByHash.end() ? -1 : found->second;
+  int index = -1;
+  for (int i = first; i >= 0; i = samples.Samples[i].NextWithSameHash) {
+    if (samples.Samples[i].matches(type, stack, depth)) {
+      index = i;
+      break;
+    }
+  }
+
+  if (index < 0) {
+    AllocationSample sample;
+    sample.Type = type;
+    sample.NumFrames = depth;
+    memcpy(sample.Frames, stack, depth * sizeof(void *));
+    sample.NextWithSameHash = first;
+    index = int(samples.Samples.size());
+    samples.Samples.push_back(sample);
+    samples.FirstSampleByHash[hash] = index;
+  }
+
+  auto &sample = samples.Samples[index];
+  sample.Objects += weight;
+  sample.Bytes += weight * double(size);
+}
+
+void swift::_swift_noteProfiledAllocation(const HeapMetadata *metadata,
+                                          size_t size) {
+  auto &state = ThreadSampling;
+  if (!state.Initialized) {
+    state.Initialized = true;
+    state.RandomState =
+      uint64_t(uintptr_t(&state)) ^ (uint64_t(time(nullptr)) << 32) ^
+      0x9E3779B97F4A7C15ULL;
+    state.BytesUntilSample = nextSampleInterval(state);
+  }
+
+  state.BytesUntilSample -= int64_t(size);
+  if (state.BytesUntilSample > 0)
+    return;
+
+  // A large allocation can cover several intervals; it is still a single
+  // sample, whose weight accounts for its size.
+  do {
+    state.BytesUntilSample += nextSampleInterval(state);
+  } while (state.BytesUntilSample <= 0);
+
+  recordSample(metadata, size);
+}
+
+/******************************************************************************/
+/****************************** Profile output ********************************/
+/******************************************************************************/
+
+namespace {
+  /// A minimal protocol buffer encoder.
+  class ProtoWriter {
+    std::string Buffer;
+
+  public:
+    const std::string &str() const { return Buffer; }
+
+    void addVarint(uint64_t value) {
+      while (value >= 0x80) {
+        Buffer.push_back(char((value & 0x7f) | 0x80));
+        value >>= 7;
+      }
+      Buffer.push_back(char(value));
+    }
+
+    void addUInt(unsigned field, uint64_t value) {
+      if (value == 0)
+        return;
+      addVarint(uint64_t(field) << 3);
+      addVarint(value);
+    }
+
+    void addBytes(unsigned field, const std::string &bytes) {
+      addVarint((uint64_t(field) << 3) | 2);
+      addVarint(bytes.size());
+      Buffer += bytes;
+    }
+
+    void addMessage(unsigned field, const ProtoWriter &message) {
+      addBytes(field, message.Buffer);
+    }
+  };
+
+  /// The string table and the location and function tables of a profile.
+  class ProfileTables {
+    std::vector<std::string> Strings;
+    std::unordered_map<std::string, uint64_t> StringIndices;
+    std::unordered_map<uintptr_t, uint64_t> LocationIDs;
+    std::unordered_map<std::string, uint64_t> FunctionIDs;
+
+  public:
+    ProtoWriter Locations;
+    ProtoWriter Functions;
+
+    ProfileTables() { getString(""); }
+
+    uint64_t getString(const std::string &string) {
+      auto inserted = StringIndices.insert({string, Strings.size()});
+      if (inserted.second)
+        Strings.push_back(string);
+      return inserted.first->second;
+    }
+
+    uint64_t getFunction(const char *name) {
+      auto inserted = FunctionIDs.insert({name, FunctionIDs.size() + 1});
+      if (inserted.second) {
+        ProtoWriter function;
+        function.addUInt(1, inserted.first->second);
+        function.addUInt(2, getString(name));
+        function.addUInt(3, getString(name));
+        Functions.addMessage(5, function);
+      }
+      return inserted.first->second;
+    }
+
+    uint64_t getLocation(void *address, uint64_t mappingID) {
+      auto inserted = LocationIDs.insert({uintptr_t(address),
+                                          LocationIDs.size() + 1});
+      if (inserted.second) {
+        ProtoWriter location;
+        location.addUInt(1, inserted.first->second);
+        location.addUInt(2, mappingID);
+        location.addUInt(3, uintptr_t(address));
+        Dl_info info;
+        if (dladdr(address, &info) && info.dli_sname) {
+          ProtoWriter line;
+          line.addUInt(1, getFunction(info.dli_sname));
+          location.addMessage(4, line);
+        }
+        Locations.addMessage(4, location);
+      }
+      return inserted.first->second;
+    }
+
+    void writeStrings(ProtoWriter &profile) {
+      for (auto &string : Strings)
+        profile.addBytes(6, string);
+    }
+  };
+
+  struct ProfileMapping {
+    uintptr_t Start, Limit, Offset;
+    std::string File;
+  };
+}
+
+#if defined(__linux__)
+static int addProfileMapping(struct dl_phdr_info *info, size_t, void *ctx) {
+  auto mappings = static_cast<std::vector<ProfileMapping> *>(ctx);
+  std::string file = info->dlpi_name ? info->dlpi_name : "";
+  if (file.empty()) {
+    // The main executable has no name here.
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length > 0)
+      file.assign(path, length);
+  }
+
+  for (unsigned i = 0; i != info->dlpi_phnum; ++i) {
+    auto &header = info->dlpi_phdr[i];
+    if (header.p_type != PT_LOAD || !(header.p_flags & PF_X))
+      continue;
+    uintptr_t start = info->dlpi_addr + header.p_vaddr;
+    mappings->push_back({start, start + header.p_memsz, header.p_offset,
+                         file});
+  }
+  return 0;
+}
+#endif
+
+static std::string describeHeapMetadata(const HeapMetadata *type) {
+  switch (type->getKind()) {
+  case MetadataKind::HeapLocalVariable:
+    return "<box>";
+  case MetadataKind::HeapGenericLocalVariable: {
+    auto box = static_cast<const GenericBoxHeapMetadata *>(type);
+    return "<box of " + nameForMetadata(box->BoxedType) + ">";
+  }
+  case MetadataKind::ErrorObject:
+    return "<error box>";
+  default:
+    return nameForMetadata(type);
+  }
+}
+
+static void writeAllocationProfile() {
+  std::vector<ProfileMapping> mappings;
+#if defined(__linux__)
+  dl_iterate_phdr(addProfileMapping, &mappings);
+#endif
+
+  ProfileTables tables;
+  ProtoWriter profile;
+
+  auto addValueType = [&](unsigned field, const char *type, const char *unit) {
+    ProtoWriter valueType;
+    valueType.addUInt(1, tables.getString(type));
+    valueType.addUInt(2, tables.getString(unit));
+    profile.addMessage(field, valueType);
+  };
+  addValueType(1, "alloc_objects", "count");
+  addValueType(1, "alloc_space", "bytes");
+
+  for (unsigned i = 0, e = mappings.size(); i != e; ++i) {
+    ProtoWriter mapping;
+    mapping.addUInt(1, i + 1);
+    mapping.addUInt(2, mappings[i].Start);
+    mapping.addUInt(3, mappings[i].Limit);
+    mapping.addUInt(4, mappings[i].Offset);
+    mapping.addUInt(5, tables.getString(mappings[i].File));
+    profile.addMessage(3, mapping);
+  }
+
+  auto findMapping = [&](void *address) -> uint64_t {
+    for (unsigned i = 0, e = mappings.size(); i != e; ++i)
+      if (uintptr_t(address) >= mappings[i].Start &&
+          uintptr_t(address) < mappings[i].Limit)
+        return i + 1;
+    return 0;
+  };
+
+  uint64_t typeLabelKey = tables.getString("type");
+  {
+    auto &samples = Samples.get();
+    StaticScopedLock guard(samples.Lock);
+    for (auto &sample : samples.Samples) {
+      ProtoWriter locationIDs;
+      for (unsigned i = 0; i != sample.NumFrames; ++i) {
+        auto address = sample.Frames[i];
+        locationIDs.addVarint(tables.getLocation(address,
+                                                 findMapping(address)));
+      }
+      ProtoWriter values;
+      values.addVarint(uint64_t(std::llround(sample.Objects)));
+      values.addVarint(uint64_t(std::llround(sample.Bytes)));
+      ProtoWriter label;
+      label.addUInt(1, typeLabelKey);
+      label.addUInt(2, tables.getString(describeHeapMetadata(sample.Type)));
+
+      ProtoWriter encoded;
+      encoded.addBytes(1, locationIDs.str());
+      encoded.addBytes(2, values.str());
+      encoded.addMessage(3, label);
+      profile.addMessage(2, encoded);
+    }
+  }
+
+  addValueType(11, "space", "bytes");
+  profile.addUInt(12, ProfileSampleRate);
+
+  // The tables go last, once every sample has interned its strings.
+  std::string output = profile.str();
+  output += tables.Locations.str();
+  output += tables.Functions.str();
+  ProtoWriter strings;
+  tables.writeStrings(strings);
+  output += strings.str();
+
+  FILE *file = fopen(ProfilePath, "wb");
+  if (!file) {
+    fprintf(stderr, "swift runtime: unable to write allocation profile "
+                    "to %s\n", ProfilePath);
+    return;
+  }
+  fwrite(output.data(), 1, output.size(), file);
+  fclose(file);
+}
+
+#if defined(__linux__)
+static sem_t ProfileDumpRequested;
+
+static void requestProfileDump(int) {
+  // sem_post is async-signal-safe; the writer thread does the real work.
+  sem_post(&ProfileDumpRequested);
+}
+
+static void *profileDumpThread(void *) {
+  while (true) {
+    if (sem_wait(&ProfileDumpRequested) == 0)
+      writeAllocationProfile();
+  }
+  return nullptr;
+}
+
+static void installProfileDumpSignalHandler() {
+  if (sem_init(&ProfileDumpRequested, 0, 0) != 0)
+    return;
+  pthread_t thread;
+  if (pthread_create(&thread, nullptr, profileDumpThread, nullptr) != 0)
+    return;
+  pthread_detach(thread);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = requestProfileDump;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGUSR2, &action, nullptr);
+}
+#endif
+
+static void initializeAllocationProfiling(void *) {
+  const char *path = getenv("SWIFT_DEBUG_ALLOCATION_PROFILE");
+  if (!path || !path[0]) {
+    _swift_allocationProfilingState.store(0, std::memory_order_relaxed);
+    return;
+  }
+
+  if (const char *rate = getenv("SWIFT_DEBUG_ALLOCATION_PROFILE_RATE")) {
+    long long value = atoll(rate);
+    if (value > 0)
+      ProfileSampleRate = size_t(value);
+  }
+  ProfilePath = strdup(path);
+  atexit(writeAllocationProfile);
+#if defined(__linux__)
+  installProfileDumpSignalHandler();
+#endif
+  _swift_allocationProfilingState.store(1, std::memory_order_relaxed);
+}
+
+bool swift::_swift_computeAllocationProfilingEnabled() {
+  static OnceToken_t token;
+  SWIFT_ONCE_F(token, initializeAllocationProfiling, nullptr);
+  return _swift_allocationProfilingState.load(std::memory_order_relaxed) != 0;
+}
+
+#endif // SWIFT_HAS_ALLOCATION_PROFILER
@@ -0,0 +1,54 @@
+//===--- AllocationProfiler.h - Sampling allocation profiler ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A sampling profiler for swift_allocObject.  It is enabled by setting
+// SWIFT_DEBUG_ALLOCATION_PROFILE to the path of a file, which receives a
+// pprof profile of the sampled allocations at exit and, on Linux, whenever
+// the process receives SIGUSR2.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_ALLOCATIONPROFILER_H
+#define SWIFT_RUNTIME_ALLOCATIONPROFILER_H
+
+#include "swift/Runtime/Metadata.h"
+#include <atomic>
+#include <cstddef>
+
+namespace swift {
+
+/// 1 if allocations are being sampled, 0 if not, and -1 if the
+/// environment has not been checked yet.
+extern std::atomic<int> _swift_allocationProfilingState;
+
+bool _swift_computeAllocationProfilingEnabled();
+
+/// Count an allocation toward the next sample, taking the sample if it is
+/// due.
+void _swift_noteProfiledAllocation(const HeapMetadata *metadata,
+                                   size_t size);
+
+/// Report an object allocation to the profiler.  When profiling is off
+/// this is a single relaxed load and a well-predicted branch.
+static inline void profileAllocation(const HeapMetadata *metadata,
+                                     size_t size) {
+  int state = _swift_allocationProfilingState.load(std::memory_order_relaxed);
+  if (__builtin_expect(state == 0, 1))
+    return;
+  if (state < 0 && !_swift_computeAllocationProfilingEnabled())
+    return;
+  _swift_noteProfiledAllocation(metadata, size);
+}
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_ALLOCATIONPROFILER_H
@@ -28,6 +28,8 @@
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
+#include "FunctionCounters.h"
+#include "MetadataCache.h"
 #include "Private.h"
 #include "SwiftHashableSupport.h"
 #include "../SwiftShims/RuntimeShims.h"
@@ -332,17 +334,17 @@ std::string swift::nameForMetadata(const Metadata *type,
   return result;
 }
 
-SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
-TwoWordPair<const char *, uintptr_t>::Return
-swift::swift_getTypeName(const Metadata *type, bool qualified) {
-  using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
+using TypeNameCacheKey = llvm::PointerIntPair<const Metadata *, 1, bool>;
 
+/// Find or make the name for the given type in the cache shared by all
+/// threads.
+static std::pair<const char *, size_t>
+getTypeNameFromSharedCache(TypeNameCacheKey key) {
   static StaticReadWriteLock TypeNameCacheLock;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
+  static Lazy<llvm::DenseMap<TypeNameCacheKey,
+                             std::pair<const char *, size_t>>>
     TypeNameCache;
-  
-  Key key(type, qualified);
+
   auto &cache = TypeNameCache.get();
 
   // Attempt read-only lookup of cache entry.
@@ -350,10 +352,8 @@ swift::swift_getTypeName(const Metadata *type, bool qualified) {
     StaticScopedReadLock guard(TypeNameCacheLock);
 
     auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
+    if (found != cache.end())
+      return found->second;
   }
 
   // Read-only lookup failed to find item, we may need to create it.
@@ -363,13 +363,11 @@ swift::swift_getTypeName(const Metadata *type, bool qualified) {
     // Do lookup again just to make sure it wasn't created by another
     // thread before we acquired the write lock.
     auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
+    if (found != cache.end())
+      return found->second;
 
     // Build the metadata name.
-    auto name = nameForMetadata(type, qualified);
+    auto name = nameForMetadata(key.getPointer(), key.getInt());
     // Copy it to memory we can reference forever.
     auto size = name.size();
     auto result = (char *)malloc(size + 1);
@@ -377,8 +375,46 @@ swift::swift_getTypeName(const Metadata *type, bool qualified) {
     result[size] = 0;
 
     cache.insert({key, {result, size}});
-    return Pair{result, size};
+    return {result, size};
+  }
+}
+
+namespace {
+/// A small direct-mapped cache of the names this thread has recently asked
+/// swift_getTypeName for.  Names live forever once made, so a hit here
+/// skips the lock on the shared cache entirely.
+struct ThreadTypeNameCache {
+  static constexpr unsigned NumEntries = 32;
+
+  struct Entry {
+    /// The opaque value of the cache key, or null if the entry is empty.
+    const void *Key;
+    const char *Name;
+    size_t Length;
+  };
+  Entry Entries[NumEntries];
+
+  Entry &entryFor(TypeNameCacheKey key) {
+    auto bits = reinterpret_cast<uintptr_t>(key.getOpaqueValue());
+    return Entries[((bits >> 4) ^ (bits >> 10)) % NumEntries];
   }
+};
+} // end anonymous namespace
+
+static thread_local ThreadTypeNameCache LocalTypeNameCache;
+
+SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
+TwoWordPair<const char *, uintptr_t>::Return
+swift::swift_getTypeName(const Metadata *type, bool qualified) {
+  using Pair = TwoWordPair<const char *, uintptr_t>;
+
+  TypeNameCacheKey key(type, qualified);
+  auto &local = LocalTypeNameCache.entryFor(key);
+  if (local.Key != key.getOpaqueValue()) {
+    auto result = getTypeNameFromSharedCache(key);
+    local = {key.getOpaqueValue(), result.first, result.second};
+  }
+  return Pair{local.Name, local.Length};
 }
 
 /// Report a dynamic cast failure.
@@ -651,6 +687,125 @@ static bool _conformsToProtocols(const OpaqueValue *value,
   return true;
 }
 
+namespace {
+  struct ExistentialConformanceKey {
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Target;
+    size_t Hash;
+
+    ExistentialConformanceKey(const Metadata *type,
+                              const ExistentialTypeMetadata *target)
+      : Type(type), Target(target), Hash(llvm::hash_combine(type, target)) {}
+  };
+
+  /// The witness tables with which a type conforms to every protocol of
+  /// a cast's target existential type, in the order the existential
+  /// stores them.  The tables are stored after the entry.
+  ///
+  /// Only successful lookups are cached.  A failed lookup can succeed
+  /// after more images are loaded, and the conformance cache already
+  /// tracks that.
+  class ExistentialConformanceCacheEntry {
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Target;
+    size_t Hash;
+    unsigned NumWitnessTables;
+
+    const WitnessTable **getWitnessTablesBuffer() {
+      return reinterpret_cast<const WitnessTable **>(this + 1);
+    }
+    const WitnessTable * const *getWitnessTablesBuffer() const {
+      return reinterpret_cast<const WitnessTable * const *>(this + 1);
+    }
+
+  public:
+    ExistentialConformanceCacheEntry(const ExistentialConformanceKey &key,
+                                     unsigned numWitnessTables,
+                                     const WitnessTable * const *tables)
+      : Type(key.Type), Target(key.Target), Hash(key.Hash),
+        NumWitnessTables(numWitnessTables) {
+      memcpy(getWitnessTablesBuffer(), tables,
+             numWitnessTables * sizeof(const WitnessTable *));
+    }
+
+    long getKeyIntValueForDump() const {
+      return reinterpret_cast<long>(Type);
+    }
+
+    int compareWithKey(const ExistentialConformanceKey &key) const {
+      if (key.Hash != Hash) {
+        return (key.Hash < Hash ? -1 : 1);
+      } else if (key.Type != Type) {
+        return (uintptr_t(key.Type) < uintptr_t(Type) ? -1 : 1);
+      } else if (key.Target != Target) {
+        return (uintptr_t(key.Target) < uintptr_t(Target) ? -1 : 1);
+      } else {
+        return 0;
+      }
+    }
+
+    static size_t getExtraAllocationSize(const ExistentialConformanceKey &key,
+                                         unsigned numWitnessTables,
+                                         const WitnessTable * const *tables) {
+      return numWitnessTables * sizeof(const WitnessTable *);
+    }
+    size_t getExtraAllocationSize() const {
+      return NumWitnessTables * sizeof(const WitnessTable *);
+    }
+
+    void copyWitnessTables(const WitnessTable **dest) const {
+      memcpy(dest, getWitnessTablesBuffer(),
+             NumWitnessTables * sizeof(const WitnessTable *));
+    }
+  };
+}
+
+static SimpleGlobalCache<ExistentialConformanceCacheEntry>
+ExistentialConformances("ExistentialConformances");
+
+/// Can the conformance of any value of a type to these protocols be
+/// decided from the type alone?  Objective-C protocol checks may look at
+/// the class of the instance.
+static bool conformsToProtocolsIgnoresValue(
+                                  const ProtocolDescriptorList &protocols) {
+  for (unsigned i = 0, n = protocols.NumProtocols; i != n; ++i) {
+    auto protocol = protocols[i];
+    if (!protocol->Flags.needsWitnessTable() &&
+        protocol->Flags.getSpecialProtocol() != SpecialProtocol::AnyObject)
+      return false;
+  }
+  return true;
+}
+
+/// Check whether a type conforms to the protocols of an existential type,
+/// filling in its witness tables.  Repeated casts of the same type to the
+/// same existential reuse the witness tables found the first time instead
+/// of looking up each protocol again.
+static bool _conformsToExistentialProtocols(
+                                   const OpaqueValue *value,
+                                   const Metadata *type,
+                                   const ExistentialTypeMetadata *targetType,
+                                   const WitnessTable **conformances) {
+  unsigned numWitnessTables = targetType->Flags.getNumWitnessTables();
+  if (numWitnessTables == 0 ||
+      !conformsToProtocolsIgnoresValue(targetType->Protocols))
+    return _conformsToProtocols(value, type, targetType->Protocols,
+                                conformances);
+
+  ExistentialConformanceKey key(type, targetType);
+  if (auto entry = ExistentialConformances.find(key)) {
+    entry->copyWitnessTables(conformances);
+    return true;
+  }
+
+  if (!_conformsToProtocols(value, type, targetType->Protocols, conformances))
+    return false;
+  ExistentialConformances.getOrInsert(key, numWitnessTables,
+                                      static_cast<const WitnessTable * const *>(
+                                        conformances));
+  return true;
+}
+
 static bool shouldDeallocateSource(bool castSucceeded, DynamicCastFlags flags) {
   return (castSucceeded && (flags & DynamicCastFlags::TakeOnSuccess)) ||
         (!castSucceeded && (flags & DynamicCastFlags::DestroyOnFailure));
@@ -1154,9 +1309,10 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // srcDynamicType equals nullptr we have a cast from an existential
     // container with a class instance to AnyObject. In this case no check is
     // necessary.
-    if (srcDynamicType && !_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (srcDynamicType &&
+        !_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables()))
       return fallbackForNonDirectConformance();
 
     auto object = *(reinterpret_cast<HeapObject**>(srcDynamicValue));
@@ -1172,9 +1328,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
       reinterpret_cast<OpaqueExistentialContainer*>(dest);
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables()))
       return fallbackForNonDirectConformance();
 
     // Fill in the type and value.
@@ -1196,9 +1352,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // one we need.
     assert(targetType->Protocols.NumProtocols == 1);
     const WitnessTable *errorWitness;
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              &errorWitness))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType, &errorWitness))
       return fallbackForNonDirectConformance();
 
 #if SWIFT_OBJC_INTEROP
@@ -2628,6 +2783,7 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *targetType,
                               DynamicCastFlags flags)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_dynamicCast, targetType);
   auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
                                                    targetType, flags);
   srcType = unwrapResult.payloadType;
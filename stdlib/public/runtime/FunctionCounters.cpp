@@ -0,0 +1,240 @@
+//===--- FunctionCounters.cpp - Runtime function call counters ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Each thread counts into its own table, so counting never contends with
+// other threads.  Tables are never freed: the counts of threads that have
+// exited are still reported at exit.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FunctionCounters.h"
+
+#if SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS
+
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Mutex.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <dlfcn.h>
+#define SWIFT_HAS_DLADDR 1
+#else
+#define SWIFT_HAS_DLADDR 0
+#endif
+
+using namespace swift;
+
+/// The number of call sites reported for each function.
+static constexpr size_t NumReportedCallSites = 10;
+
+static const char *const CountedFunctionNames[] = {
+#define COUNTED_FUNCTION(Name) #Name,
+  SWIFT_COUNTED_RUNTIME_FUNCTIONS(COUNTED_FUNCTION)
+#undef COUNTED_FUNCTION
+};
+
+static constexpr size_t NumCountedFunctions =
+  sizeof(CountedFunctionNames) / sizeof(CountedFunctionNames[0]);
+
+namespace {
+  struct CallSite {
+    CountedRuntimeFunction Function;
+    const void *Caller;
+    const Metadata *Type;
+
+    bool operator==(const CallSite &other) const {
+      return Function == other.Function && Caller == other.Caller &&
+             Type == other.Type;
+    }
+  };
+
+  struct CallSiteHash {
+    size_t operator()(const CallSite &site) const {
+      size_t hash = size_t(site.Function);
+      hash = hash * 31 + std::hash<const void *>()(site.Caller);
+      hash = hash * 31 + std::hash<const void *>()(site.Type);
+      return hash;
+    }
+  };
+
+  using CallSiteCounts = std::unordered_map<CallSite, uint64_t, CallSiteHash>;
+
+  struct ThreadCounters {
+    /// Only contended while the counts are being reported.
+    Mutex Lock;
+    CallSiteCounts Counts;
+    ThreadCounters *Next = nullptr;
+  };
+}
+
+static std::atomic<ThreadCounters *> AllThreadCounters{nullptr};
+static thread_local ThreadCounters *CurrentThreadCounters;
+
+/// Set while this thread is inside the counters, so that runtime calls made
+/// by the counters themselves are not counted.
+static thread_local bool IsCountingCall;
+
+static void reportRuntimeFunctionCounters();
+
+static void installReportAtExit(void *) {
+  atexit(reportRuntimeFunctionCounters);
+}
+
+static ThreadCounters *getCurrentThreadCounters() {
+  if (auto counters = CurrentThreadCounters)
+    return counters;
+
+  static OnceToken_t token;
+  SWIFT_ONCE_F(token, installReportAtExit, nullptr);
+
+  auto counters = new ThreadCounters();
+  counters->Next = AllThreadCounters.load(std::memory_order_relaxed);
+  while (!AllThreadCounters.compare_exchange_weak(counters->Next, counters,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+    // Next was updated to the current head; try again.
+  }
+  CurrentThreadCounters = counters;
+  return counters;
+}
+
+void swift::_swift_countRuntimeFunctionCall(CountedRuntimeFunction function,
+                                            const void *caller,
+                                            const Metadata *type) {
+  if (IsCountingCall)
+    return;
+  IsCountingCall = true;
+
+  auto counters = getCurrentThreadCounters();
+  {
+    ScopedLock guard(counters->Lock);
+    ++counters->Counts[CallSite{function, caller, type}];
+  }
+
+  IsCountingCall = false;
+}
+
+static std::string describeCaller(const void *caller) {
+  char buffer[32];
+#if SWIFT_HAS_DLADDR
+  Dl_info info;
+  if (dladdr(caller, &info) && info.dli_sname) {
+    snprintf(buffer, sizeof(buffer), "+%zu",
+             size_t((const char *)caller - (const char *)info.dli_saddr));
+    return std::string(info.dli_sname) + buffer;
+  }
+#endif
+  snprintf(buffer, sizeof(buffer), "%p", caller);
+  return buffer;
+}
+
+static std::string describeType(const Metadata *type) {
+  if (!type)
+    return "-";
+  switch (type->getKind()) {
+  case MetadataKind::HeapLocalVariable:
+  case MetadataKind::HeapGenericLocalVariable:
+    return "<box>";
+  case MetadataKind::ErrorObject:
+    return "<error box>";
+  default:
+    return nameForMetadata(type);
+  }
+}
+
+static void reportRuntimeFunctionCounters() {
+  IsCountingCall = true;
+
+  CallSiteCounts counts;
+  for (auto counters = AllThreadCounters.load(std::memory_order_acquire);
+       counters; counters = counters->Next) {
+    ScopedLock guard(counters->Lock);
+    for (auto &entry : counters->Counts)
+      counts[entry.first] += entry.second;
+  }
+
+  uint64_t totals[NumCountedFunctions] = {};
+  std::vector<std::pair<CallSite, uint64_t>> sitesByFunction[
+                                                          NumCountedFunctions];
+  for (auto &entry : counts) {
+    auto index = size_t(entry.first.Function);
+    totals[index] += entry.second;
+    sitesByFunction[index].push_back(entry);
+  }
+
+  fprintf(stderr, "%-40s %14s\n", "runtime function", "calls");
+  for (size_t i = 0; i != NumCountedFunctions; ++i)
+    fprintf(stderr, "%-40s %14llu\n", CountedFunctionNames[i],
+            (unsigned long long) totals[i]);
+
+  for (size_t i = 0; i != NumCountedFunctions; ++i) {
+    auto &sites = sitesByFunction[i];
+    if (sites.empty())
+      continue;
+
+    auto numReported = std::min(sites.size(), NumReportedCallSites);
+    std::partial_sort(sites.begin(), sites.begin() + numReported, sites.end(),
+                      [](const std::pair<CallSite, uint64_t> &a,
+                         const std::pair<CallSite, uint64_t> &b) {
+                        return a.second > b.second;
+                      });
+
+    fprintf(stderr, "\n%s call sites:\n", CountedFunctionNames[i]);
+    for (size_t j = 0; j != numReported; ++j) {
+      auto &site = sites[j].first;
+      fprintf(stderr, "%14llu  %-48s %s\n",
+              (unsigned long long) sites[j].second,
+              describeCaller(site.Caller).c_str(),
+              describeType(site.Type).c_str());
+    }
+  }
+}
+
+/// Return the number of calls to the named runtime function made by all
+/// threads so far, or 0 if it isn't counted.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+uint64_t swift_getRuntimeFunctionCallCount(const char *name) {
+  auto found = std::find_if(std::begin(CountedFunctionNames),
+                            std::end(CountedFunctionNames),
+                            [&](const char *candidate) {
+                              return strcmp(candidate, name) == 0;
+                            });
+  if (found == std::end(CountedFunctionNames))
+    return 0;
+  auto function =
+    CountedRuntimeFunction(found - std::begin(CountedFunctionNames));
+
+  bool wasCountingCall = IsCountingCall;
+  IsCountingCall = true;
+
+  uint64_t total = 0;
+  for (auto counters = AllThreadCounters.load(std::memory_order_acquire);
+       counters; counters = counters->Next) {
+    ScopedLock guard(counters->Lock);
+    for (auto &entry : counters->Counts)
+      if (entry.first.Function == function)
+        total += entry.second;
+  }
+
+  IsCountingCall = wasCountingCall;
+  return total;
+}
+
+#endif // SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS
@@ -0,0 +1,72 @@
+//===--- FunctionCounters.h - Runtime function call counters ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters for calls to hot runtime entry points, attributed to the calling
+// code and to the type involved.  They are only built into runtimes
+// configured with SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS, which print a
+// summary to stderr at exit and export
+// swift_getRuntimeFunctionCallCount for tools such as the benchmark
+// harness.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_FUNCTIONCOUNTERS_H
+#define SWIFT_RUNTIME_FUNCTIONCOUNTERS_H
+
+#if SWIFT_RUNTIME_ENABLE_FUNCTION_COUNTERS
+
+#include "swift/Runtime/Metadata.h"
+
+/// The counted entry points.
+#define SWIFT_COUNTED_RUNTIME_FUNCTIONS(MACRO)                                 \
+  MACRO(swift_allocObject)                                                     \
+  MACRO(swift_slowAlloc)                                                       \
+  MACRO(swift_retain)                                                          \
+  MACRO(swift_retain_n)                                                        \
+  MACRO(swift_release)                                                         \
+  MACRO(swift_release_n)                                                       \
+  MACRO(swift_unownedRetain)                                                   \
+  MACRO(swift_unownedRelease)                                                  \
+  MACRO(swift_dynamicCast)                                                     \
+  MACRO(swift_conformsToProtocol)                                              \
+  MACRO(swift_getGenericMetadata)
+
+namespace swift {
+
+enum class CountedRuntimeFunction : unsigned {
+#define COUNTED_FUNCTION(Name) Name,
+  SWIFT_COUNTED_RUNTIME_FUNCTIONS(COUNTED_FUNCTION)
+#undef COUNTED_FUNCTION
+};
+
+/// Count a call to a runtime function from the given return address.
+/// The type may be null.
+void _swift_countRuntimeFunctionCall(CountedRuntimeFunction function,
+                                     const void *caller,
+                                     const Metadata *type)
+    __attribute__((__noinline__));
+
+} // end namespace swift
+
+/// Count a call to the enclosing entry point. Must be used directly in the
+/// entry point's body so that the return address is its caller's.
+#define SWIFT_COUNT_RUNTIME_CALL(Name, Type)                                   \
+  swift::_swift_countRuntimeFunctionCall(                                      \
+      swift::CountedRuntimeFunction::Name, __builtin_return_address(0), Type)
+
+#else
+
+#define SWIFT_COUNT_RUNTIME_CALL(Name, Type)
+
+#endif
+
+#endif // SWIFT_RUNTIME_FUNCTIONCOUNTERS_H
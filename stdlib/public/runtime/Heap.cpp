@@ -16,23 +16,281 @@
 
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
+#include "FunctionCounters.h"
 #include "Private.h"
+#include "swift/Basic/Lazy.h"
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
+#include <atomic>
+#include <cstddef>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__LP64__)
+#define SWIFT_HAS_SMALL_OBJECT_ALLOCATOR 1
+#include <pthread.h>
+#include <sys/mman.h>
+#else
+#define SWIFT_HAS_SMALL_OBJECT_ALLOCATOR 0
+#endif
 
 using namespace swift;
 
+/// The alignment that malloc guarantees, as a mask.
+static constexpr size_t MallocAlignMask = alignof(std::max_align_t) - 1;
+
+static void *allocateWithMalloc(size_t size, size_t alignMask) {
+  void *p;
+#if defined(_WIN32)
+  // _aligned_malloc memory has to be freed with _aligned_free, and callers
+  // don't reliably pass the same mask to swift_slowDealloc.
+  p = malloc(size);
+#else
+  if (alignMask <= MallocAlignMask) {
+    p = malloc(size);
+  } else if (posix_memalign(&p, alignMask + 1, size) != 0) {
+    p = nullptr;
+  }
+#endif
+  if (!p) swift::crash("Could not allocate memory.");
+  return p;
+}
+
+#if SWIFT_HAS_SMALL_OBJECT_ALLOCATOR
+
+// The small-object allocator is selected at startup by setting
+// SWIFT_SMALL_OBJECT_ALLOCATOR=1.  It carves blocks of a few size classes out
+// of 64KB chunks, each dedicated to one size class, from a single reserved
+// region of address space.  Every thread keeps a free list per size class,
+// so most allocations and frees don't synchronize at all.
+//
+// Whether a block belongs to the allocator, and its size class, are derived
+// from its address, so frees stay correct even when the caller's size is
+// only approximate, and blocks that came from malloc are still freed there.
+
+namespace {
+  struct FreeBlock {
+    FreeBlock *Next;
+  };
+
+  constexpr size_t SmallSizeClasses[] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256
+  };
+  constexpr unsigned NumSmallSizeClasses =
+    sizeof(SmallSizeClasses) / sizeof(SmallSizeClasses[0]);
+  constexpr size_t MaxSmallSize = 256;
+  constexpr size_t SmallAlignMask = 15;
+
+  constexpr size_t ChunkSize = 64 * 1024;
+  constexpr size_t RegionSize = size_t(1) << 36;
+  constexpr size_t NumChunks = RegionSize / ChunkSize;
+
+  /// The most blocks of one size class a thread keeps before returning
+  /// some to the central free list, and how many move at a time.
+  constexpr unsigned MaxCachedBlocks = 256;
+  constexpr unsigned TransferBatch = 64;
+
+  struct ThreadCache {
+    FreeBlock *Heads[NumSmallSizeClasses];
+    unsigned Counts[NumSmallSizeClasses];
+    bool Registered;
+  };
+}
+
+/// 1 if the small-object allocator is in use, 0 if not, and -1 if that
+/// hasn't been decided yet.
+static std::atomic<int> SmallAllocatorState{-1};
+
+static char *SmallRegion;
+/// For each chunk handed out, one more than its size class.
+static uint8_t *ChunkSizeClasses;
+
+static StaticMutex SmallAllocatorLock;
+static size_t NextChunk;
+static FreeBlock *CentralFreeLists[NumSmallSizeClasses];
+
+static pthread_key_t ThreadCacheKey;
+static thread_local ThreadCache LocalCache;
+
+static unsigned getSmallSizeClass(size_t size) {
+  if (size <= 128)
+    return size <= 16 ? 0 : (size - 1) / 16;
+  return 8 + (size - 129) / 32;
+}
+
+/// Move a thread's cached blocks back to the central free lists when it
+/// exits.
+static void flushThreadCache(void *context) {
+  auto cache = static_cast<ThreadCache *>(context);
+  StaticScopedLock guard(SmallAllocatorLock);
+  for (unsigned cls = 0; cls != NumSmallSizeClasses; ++cls) {
+    while (auto block = cache->Heads[cls]) {
+      cache->Heads[cls] = block->Next;
+      block->Next = CentralFreeLists[cls];
+      CentralFreeLists[cls] = block;
+    }
+    cache->Counts[cls] = 0;
+  }
+  cache->Registered = false;
+}
+
+static bool setUpSmallObjectAllocator() {
+  const char *value = getenv("SWIFT_SMALL_OBJECT_ALLOCATOR");
+  if (!value || strcmp(value, "1") != 0)
+    return false;
+
+  // Reserve the address space; chunks are made accessible as they are used.
+  void *region = mmap(nullptr, RegionSize, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (region == MAP_FAILED)
+    return false;
+  void *classes = mmap(nullptr, NumChunks, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (classes == MAP_FAILED) {
+    munmap(region, RegionSize);
+    return false;
+  }
+  if (pthread_key_create(&ThreadCacheKey, flushThreadCache) != 0) {
+    munmap(region, RegionSize);
+    munmap(classes, NumChunks);
+    return false;
+  }
+
+  SmallRegion = static_cast<char *>(region);
+  ChunkSizeClasses = static_cast<uint8_t *>(classes);
+  return true;
+}
+
+static void initializeSmallObjectAllocator(void *) {
+  SmallAllocatorState.store(setUpSmallObjectAllocator() ? 1 : 0,
+                            std::memory_order_release);
+}
+
+static bool isSmallObjectAllocatorEnabled() {
+  int state = SmallAllocatorState.load(std::memory_order_acquire);
+  if (state < 0) {
+    static OnceToken_t token;
+    SWIFT_ONCE_F(token, initializeSmallObjectAllocator, nullptr);
+    state = SmallAllocatorState.load(std::memory_order_acquire);
+  }
+  return state != 0;
+}
+
+/// Give the central free list of the given size class a fresh chunk.
+/// The allocator lock must be held.
+static bool addChunk(unsigned cls) {
+  if (NextChunk == NumChunks)
+    return false;
+  char *chunk = SmallRegion + NextChunk * ChunkSize;
+  if (mprotect(chunk, ChunkSize, PROT_READ | PROT_WRITE) != 0)
+    return false;
+  ChunkSizeClasses[NextChunk++] = cls + 1;
+
+  // Thread the blocks together so that they are handed out in address order.
+  size_t size = SmallSizeClasses[cls];
+  FreeBlock *head = CentralFreeLists[cls];
+  for (size_t offset = (ChunkSize / size) * size; offset != 0; ) {
+    offset -= size;
+    auto block = reinterpret_cast<FreeBlock *>(chunk + offset);
+    block->Next = head;
+    head = block;
+  }
+  CentralFreeLists[cls] = head;
+  return true;
+}
+
+/// Refill this thread's free list from the central one and allocate from
+/// it.  Returns null if the region is exhausted.
+static void *refillAndAllocate(ThreadCache &cache, unsigned cls) {
+  if (!cache.Registered) {
+    cache.Registered = true;
+    pthread_setspecific(ThreadCacheKey, &cache);
+  }
+
+  StaticScopedLock guard(SmallAllocatorLock);
+  if (!CentralFreeLists[cls] && !addChunk(cls))
+    return nullptr;
+
+  FreeBlock *result = CentralFreeLists[cls];
+  CentralFreeLists[cls] = result->Next;
+  for (unsigned i = 0; i != TransferBatch && CentralFreeLists[cls]; ++i) {
+    FreeBlock *block = CentralFreeLists[cls];
+    CentralFreeLists[cls] = block->Next;
+    block->Next = cache.Heads[cls];
+    cache.Heads[cls] = block;
+    ++cache.Counts[cls];
+  }
+  return result;
+}
+
+static void *allocateSmall(size_t size) {
+  unsigned cls = getSmallSizeClass(size);
+  ThreadCache &cache = LocalCache;
+  if (FreeBlock *block = cache.Heads[cls]) {
+    cache.Heads[cls] = block->Next;
+    --cache.Counts[cls];
+    return block;
+  }
+  return refillAndAllocate(cache, cls);
+}
+
+static bool isSmallAllocation(void *ptr) {
+  return SmallRegion &&
+         size_t(static_cast<char *>(ptr) - SmallRegion) < RegionSize;
+}
+
+static void deallocateSmall(void *ptr) {
+  size_t chunkIndex = (static_cast<char *>(ptr) - SmallRegion) / ChunkSize;
+  unsigned cls = ChunkSizeClasses[chunkIndex] - 1;
+  assert(cls < NumSmallSizeClasses && "freeing into an unused chunk");
+
+  ThreadCache &cache = LocalCache;
+  auto block = static_cast<FreeBlock *>(ptr);
+  block->Next = cache.Heads[cls];
+  cache.Heads[cls] = block;
+  if (++cache.Counts[cls] <= MaxCachedBlocks)
+    return;
+
+  // Return a batch to the central free list so that memory freed on one
+  // thread can be reused by others.
+  if (!cache.Registered) {
+    cache.Registered = true;
+    pthread_setspecific(ThreadCacheKey, &cache);
+  }
+  StaticScopedLock guard(SmallAllocatorLock);
+  for (unsigned i = 0; i != TransferBatch; ++i) {
+    FreeBlock *moved = cache.Heads[cls];
+    cache.Heads[cls] = moved->Next;
+    moved->Next = CentralFreeLists[cls];
+    CentralFreeLists[cls] = moved;
+  }
+  cache.Counts[cls] -= TransferBatch;
+}
+
+#endif // SWIFT_HAS_SMALL_OBJECT_ALLOCATOR
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
-  void *p = malloc(size);
-  if (!p) swift::crash("Could not allocate memory.");
-  return p;
+  SWIFT_COUNT_RUNTIME_CALL(swift_slowAlloc, nullptr);
+#if SWIFT_HAS_SMALL_OBJECT_ALLOCATOR
+  if (size <= MaxSmallSize && alignMask <= SmallAlignMask &&
+      isSmallObjectAllocatorEnabled()) {
+    if (void *p = allocateSmall(size))
+      return p;
+  }
+#endif
+  return allocateWithMalloc(size, alignMask);
 }
 
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_HAS_SMALL_OBJECT_ALLOCATOR
+  if (isSmallAllocation(ptr)) {
+    deallocateSmall(ptr);
+    return;
+  }
+#endif
   free(ptr);
 }
@@ -20,10 +20,15 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/ABI/System.h"
 #include "llvm/Support/MathExtras.h"
+#include "AllocationProfiler.h"
+#include "FunctionCounters.h"
 #include "MetadataCache.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
+#include "llvm/ADT/DenseMap.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -48,6 +53,7 @@ swift::swift_allocObject(HeapMetadata const *metadata,
                          size_t requiredSize,
                          size_t requiredAlignmentMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_allocObject, metadata);
   return SWIFT_RT_ENTRY_REF(swift_allocObject)(metadata, requiredSize,
                                                requiredAlignmentMask);
 }
@@ -71,6 +77,8 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
   // If leak tracking is enabled, start tracking this object.
   SWIFT_LEAKS_START_TRACKING_OBJECT(object);
 
+  profileAllocation(metadata, requiredSize);
+
   return object;
 }
 
@@ -152,7 +160,7 @@ public:
 
 } // end anonymous namespace
 
-static SimpleGlobalCache<BoxCacheEntry> Boxes;
+static SimpleGlobalCache<BoxCacheEntry> Boxes("Boxes");
 
 SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
 BoxPair::Return
@@ -199,6 +207,7 @@ SWIFT_RT_ENTRY_VISIBILITY
 extern "C"
 void swift::swift_retain(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_retain, object ? object->metadata : nullptr);
   SWIFT_RT_ENTRY_REF(swift_retain)(object);
 }
 
@@ -240,6 +249,8 @@ SWIFT_RT_ENTRY_VISIBILITY
 extern "C"
 void swift::swift_retain_n(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_retain_n,
+                           object ? object->metadata : nullptr);
   SWIFT_RT_ENTRY_REF(swift_retain_n)(object, n);
 }
 
@@ -272,6 +283,7 @@ SWIFT_RT_ENTRY_VISIBILITY
 extern "C"
 void swift::swift_release(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_release, object ? object->metadata : nullptr);
   SWIFT_RT_ENTRY_REF(swift_release)(object);
 }
 
@@ -287,6 +299,8 @@ void SWIFT_RT_ENTRY_IMPL(swift_release)(HeapObject *object)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_release_n(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_release_n,
+                           object ? object->metadata : nullptr);
   return SWIFT_RT_ENTRY_REF(swift_release_n)(object, n);
 }
 
@@ -299,6 +313,42 @@ void SWIFT_RT_ENTRY_IMPL(swift_release_n)(HeapObject *object, uint32_t n)
   }
 }
 
+// The array entry points call through the retain and release hooks when a
+// tool has replaced them, so that batched operations are still observed.
+
+void swift::swift_retainArray(HeapObject * const *objects, size_t count) {
+  if (SWIFT_RT_ENTRY_REF(swift_retain) != SWIFT_RT_ENTRY_IMPL(swift_retain)) {
+    for (size_t i = 0; i != count; ++i)
+      SWIFT_RT_ENTRY_REF(swift_retain)(objects[i]);
+    return;
+  }
+
+  for (size_t i = 0; i != count; ++i) {
+    // Start fetching the next header while this one is updated.
+    if (i + 1 != count)
+      __builtin_prefetch(objects[i + 1], /*write*/ 1);
+    if (auto object = objects[i])
+      object->refCount.increment();
+  }
+}
+
+void swift::swift_releaseArray(HeapObject * const *objects, size_t count) {
+  if (SWIFT_RT_ENTRY_REF(swift_release) !=
+        SWIFT_RT_ENTRY_IMPL(swift_release)) {
+    for (size_t i = 0; i != count; ++i)
+      SWIFT_RT_ENTRY_REF(swift_release)(objects[i]);
+    return;
+  }
+
+  for (size_t i = 0; i != count; ++i) {
+    if (i + 1 != count)
+      __builtin_prefetch(objects[i + 1], /*write*/ 1);
+    auto object = objects[i];
+    if (object && object->refCount.decrementShouldDeallocate())
+      _swift_release_dealloc(object);
+  }
+}
+
 void swift::swift_setDeallocating(HeapObject *object) {
   object->refCount.decrementFromOneAndDeallocateNonAtomic();
 }
@@ -329,6 +379,8 @@ size_t swift::swift_unownedRetainCount(HeapObject *object) {
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_unownedRetain(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_unownedRetain,
+                           object ? object->metadata : nullptr);
   if (!object)
     return;
 
@@ -338,6 +390,8 @@ void swift::swift_unownedRetain(HeapObject *object)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_unownedRelease(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_unownedRelease,
+                           object ? object->metadata : nullptr);
   if (!object)
     return;
 
@@ -617,6 +671,10 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  // Clear any weak references to the object and drop the weak retain
+  // held by their side table.
+  detachWeakSideTable(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -693,142 +751,207 @@ void swift::swift_deallocObject(HeapObject *object,
 
 enum: uintptr_t {
   WR_NATIVE = 1<<(swift::heap_object_abi::ObjCReservedLowBits),
-  WR_READING = 1<<(swift::heap_object_abi::ObjCReservedLowBits+1),
 
   WR_NATIVEMASK = WR_NATIVE | swift::heap_object_abi::ObjCReservedBitsMask,
 };
 
-static_assert(WR_READING < alignof(void*),
-              "weakref lock bit mustn't interfere with real pointer bits");
+static_assert(WR_NATIVE < alignof(void*),
+              "weakref native bit mustn't interfere with real pointer bits");
 
-enum: short {
-  WR_SPINLIMIT = 64,
-};
+namespace {
+  /// The out-of-line record that native weak references point to.
+  ///
+  /// A side table is created the first time an object is weakly
+  /// referenced, and it holds one unowned retain of the object.  When the
+  /// object is deallocated the table is detached: Object is cleared and
+  /// the unowned retain is dropped, so the object's memory is freed
+  /// promptly even if weak references to it remain.  Only the small table
+  /// stays alive until the last weak reference goes away.
+  class WeakSideTable {
+    std::atomic<HeapObject *> Object;
+
+    /// The number of weak references to the table, plus one while the
+    /// table is attached to its object.
+    std::atomic<uint32_t> RefCount{1};
+
+    /// The number of threads inside tryRetainObject.  detach() waits for
+    /// it to drain before the object's memory can be freed.
+    std::atomic<uint32_t> Readers{0};
+
+  public:
+    explicit WeakSideTable(HeapObject *object) : Object(object) {}
+
+    void retain() {
+      RefCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+      if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+    /// Is the object gone?  Once this returns true it stays true.
+    bool isDetached() const {
+      return Object.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    /// Retain the object, unless it has begun deallocation.
+    HeapObject *tryRetainObject() {
+      // Avoid touching the shared counters once the object is gone.
+      if (isDetached())
+        return nullptr;
+
+      // The reader count and the object pointer form a Dekker handshake
+      // with detach(), so both sides need sequentially consistent
+      // ordering.  Either detach() sees this reader and waits for it, or
+      // this reader sees the cleared pointer.
+      Readers.fetch_add(1, std::memory_order_seq_cst);
+      auto object = Object.load(std::memory_order_seq_cst);
+      auto result = object ? SWIFT_RT_ENTRY_CALL(swift_tryRetain)(object)
+                           : nullptr;
+      Readers.fetch_sub(1, std::memory_order_release);
+      return result;
+    }
+
+    /// Disconnect the table from its deallocating object, then drop the
+    /// object's unowned retain and the table's reference to itself.
+    void detach(HeapObject *object) {
+      assert(Object.load(std::memory_order_relaxed) == object);
+      Object.store(nullptr, std::memory_order_seq_cst);
+
+      // Wait for readers that loaded the pointer before it was cleared.
+      // They are only ever between two atomic operations, so this is brief.
+      while (Readers.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+
+      // The initial weak retain is still held, so this cannot free.
+      bool dealloc = object->weakRefCount.decrementShouldDeallocate();
+      assert(!dealloc && "side table held the last weak retain");
+      (void) dealloc;
+      release();
+    }
+  };
+}
+
+/// The side tables of live objects.
+static StaticMutex WeakSideTablesLock;
+static Lazy<llvm::DenseMap<HeapObject *, WeakSideTable *>> WeakSideTables;
+
+/// Return the side table for a live object, creating it if necessary,
+/// with a new reference for the caller.
+static WeakSideTable *retainWeakSideTable(HeapObject *object) {
+  StaticScopedLock guard(WeakSideTablesLock);
+  auto &table = WeakSideTables.get()[object];
+  if (!table) {
+    table = new WeakSideTable(object);
+    object->weakRefCount.increment();
+    object->weakRefCount.setHasSideTable();
+  }
+  table->retain();
+  return table;
+}
+
+/// Detach the side table, if any, of an object being deallocated.
+static void detachWeakSideTable(HeapObject *object) {
+  if (!object->weakRefCount.hasSideTable())
+    return;
+
+  WeakSideTable *table;
+  {
+    StaticScopedLock guard(WeakSideTablesLock);
+    auto &tables = WeakSideTables.get();
+    auto found = tables.find(object);
+    assert(found != tables.end() && "object lost its weak side table");
+    table = found->second;
+    tables.erase(found);
+  }
+  table->detach(object);
+}
+
+static WeakSideTable *getWeakSideTable(WeakReference *ref) {
+  return reinterpret_cast<WeakSideTable *>(ref->Value & ~WR_NATIVE);
+}
+
+static uintptr_t makeWeakReferenceValue(HeapObject *object) {
+  if (!object)
+    return (uintptr_t)nullptr;
+  return (uintptr_t)retainWeakSideTable(object) | WR_NATIVE;
+}
 
 bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
   return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
 }
 
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = (uintptr_t)value | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
+  ref->Value = makeWeakReferenceValue(value);
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  ref->Value = (uintptr_t)newValue | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
+  auto newRefValue = makeWeakReferenceValue(newValue);
+  auto oldTable = getWeakSideTable(ref);
+  ref->Value = newRefValue;
+  if (oldTable)
+    oldTable->release();
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  if (ref->Value == (uintptr_t)nullptr) {
-    return nullptr;
-  }
-
-  // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        std::this_thread::yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
+  // Loads don't write to the reference, so concurrent loads of the same
+  // reference are lock-free and never wait for each other.
+  auto table = reinterpret_cast<WeakSideTable *>(
+      __atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & ~WR_NATIVE);
+  if (!table)
     return nullptr;
-  }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    return nullptr;
-  }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
-  return result;
+  return table->tryRetainObject();
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
-  auto object = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  if (object == nullptr) return nullptr;
-  auto result = swift_tryRetain(object);
+  auto table = getWeakSideTable(ref);
+  if (!table) return nullptr;
+  auto result = table->tryRetainObject();
   ref->Value = (uintptr_t)nullptr;
-  swift_unownedRelease(object);
+  table->release();
   return result;
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = (HeapObject*) (ref->Value & ~WR_NATIVE);
+  auto table = getWeakSideTable(ref);
   ref->Value = (uintptr_t)nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
+  if (table)
+    table->release();
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  if (src->Value == (uintptr_t)nullptr) {
+  auto table = getWeakSideTable(src);
+  if (!table || table->isDetached()) {
     dest->Value = (uintptr_t)nullptr;
     return;
   }
-
-  // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        std::this_thread::yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    dest->Value = (uintptr_t)nullptr;
-  } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  table->retain();
+  dest->Value = (uintptr_t)table | WR_NATIVE;
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = (HeapObject*) (src->Value & ~WR_NATIVE);
-  if (object == nullptr) {
+  auto table = getWeakSideTable(src);
+  src->Value = (uintptr_t)nullptr;
+  if (!table) {
     dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
+  } else if (table->isDetached()) {
     dest->Value = (uintptr_t)nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
+    table->release();
   } else {
-    dest->Value = (uintptr_t)object | WR_NATIVE;
+    dest->Value = (uintptr_t)table | WR_NATIVE;
   }
-  src->Value = (uintptr_t)nullptr;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (auto table = getWeakSideTable(dest))
+    table->release();
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (auto table = getWeakSideTable(dest))
+    table->release();
   swift_weakTakeInit(dest, src);
 }
 
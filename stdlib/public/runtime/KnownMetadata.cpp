@@ -58,6 +58,30 @@ const ValueWitnessTable swift::_TWVBi128_ =
 const ValueWitnessTable swift::_TWVBi256_ =
   ValueWitnessTableForBox<NativeBox<int256_like, 32>>::table;
 
+// Tables for POD data made of a few 4- or 8-byte words. IRGen uses these for
+// structs with the same layout instead of emitting a table for each of them.
+namespace {
+  using Word32Box = NativeBox<uint32_t, 4>;
+  using Word64Box = NativeBox<uint64_t, 8>;
+}
+
+const ValueWitnessTable swift::_TWVTBi32_Bi32__ =
+  ValueWitnessTableForBox<AggregateBox<Word32Box, Word32Box>>::table;
+const ValueWitnessTable swift::_TWVTBi32_Bi32_Bi32__ =
+  ValueWitnessTableForBox<AggregateBox<Word32Box, Word32Box,
+                                       Word32Box>>::table;
+const ValueWitnessTable swift::_TWVTBi32_Bi32_Bi32_Bi32__ =
+  ValueWitnessTableForBox<AggregateBox<Word32Box, Word32Box,
+                                       Word32Box, Word32Box>>::table;
+const ValueWitnessTable swift::_TWVTBi64_Bi64__ =
+  ValueWitnessTableForBox<AggregateBox<Word64Box, Word64Box>>::table;
+const ValueWitnessTable swift::_TWVTBi64_Bi64_Bi64__ =
+  ValueWitnessTableForBox<AggregateBox<Word64Box, Word64Box,
+                                       Word64Box>>::table;
+const ValueWitnessTable swift::_TWVTBi64_Bi64_Bi64_Bi64__ =
+  ValueWitnessTableForBox<AggregateBox<Word64Box, Word64Box,
+                                       Word64Box, Word64Box>>::table;
+
 /// The basic value-witness table for Swift object pointers.
 const ExtraInhabitantsValueWitnessTable swift::_TWVBo =
   ValueWitnessTableForBox<SwiftRetainableBox>::table;
@@ -23,7 +23,9 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
 #include "swift/Strings.h"
+#include "FunctionCounters.h"
 #include "MetadataCache.h"
+#include "Tracing.h"
 #include <algorithm>
 #include <condition_variable>
 #include <new>
@@ -224,27 +226,58 @@ swift::swift_allocateGenericValueMetadata(GenericMetadata *pattern,
   return metadata;
 }
 
-/// The primary entrypoint.
-SWIFT_RT_ENTRY_VISIBILITY
-const Metadata *
-swift::swift_getGenericMetadata(GenericMetadata *pattern,
-                                const void *arguments)
-    SWIFT_CC(RegisterPreservingCC_IMPL) {
-  auto genericArgs = (const void * const *) arguments;
-  size_t numGenericArgs = pattern->NumKeyArguments;
+static const Metadata *
+_getGenericMetadata(GenericMetadata *pattern,
+                    const void * const *genericArgs,
+                    size_t numGenericArgs) {
+  assert(numGenericArgs == pattern->NumKeyArguments);
 
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
       // Create new metadata to cache.
-      auto metadata = pattern->CreateFunction(pattern, arguments);
+      auto metadata = pattern->CreateFunction(pattern, genericArgs);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
       entry->Value = metadata;
+      traceRuntimeEvent(RuntimeTraceMetadataInstantiation, pattern, metadata);
       return entry;
     });
 
   return entry->Value;
 }
 
+/// The primary entrypoint.
+SWIFT_RT_ENTRY_VISIBILITY
+const Metadata *
+swift::swift_getGenericMetadata(GenericMetadata *pattern,
+                                const void *arguments)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  auto metadata = _getGenericMetadata(pattern,
+                                      (const void * const *) arguments,
+                                      pattern->NumKeyArguments);
+  SWIFT_COUNT_RUNTIME_CALL(swift_getGenericMetadata, metadata);
+  return metadata;
+}
+
+/// Entrypoints for patterns with one or two key arguments, which save the
+/// caller from building an argument buffer.
+const Metadata *
+swift::swift_getGenericMetadata1(GenericMetadata *pattern,
+                                 const void *arg0) {
+  const void *arguments[] = { arg0 };
+  auto metadata = _getGenericMetadata(pattern, arguments, 1);
+  SWIFT_COUNT_RUNTIME_CALL(swift_getGenericMetadata, metadata);
+  return metadata;
+}
+
+const Metadata *
+swift::swift_getGenericMetadata2(GenericMetadata *pattern,
+                                 const void *arg0, const void *arg1) {
+  const void *arguments[] = { arg0, arg1 };
+  auto metadata = _getGenericMetadata(pattern, arguments, 2);
+  SWIFT_COUNT_RUNTIME_CALL(swift_getGenericMetadata, metadata);
+  return metadata;
+}
+
 /***************************************************************************/
 /*** Objective-C class wrappers ********************************************/
 /***************************************************************************/
@@ -280,7 +313,8 @@ namespace {
 }
 
 /// The uniquing structure for ObjC class-wrapper metadata.
-static SimpleGlobalCache<ObjCClassCacheEntry> ObjCClassWrappers;
+static SimpleGlobalCache<ObjCClassCacheEntry>
+ObjCClassWrappers("ObjCClassWrappers");
 
 #endif
 
@@ -369,7 +403,7 @@ public:
 } // end anonymous namespace
 
 /// The uniquing structure for function type metadata.
-static SimpleGlobalCache<FunctionCacheEntry> FunctionTypes;
+static SimpleGlobalCache<FunctionCacheEntry> FunctionTypes("FunctionTypes");
 
 const FunctionTypeMetadata *
 swift::swift_getFunctionTypeMetadata1(FunctionTypeFlags flags,
@@ -534,7 +568,7 @@ public:
 }
 
 /// The uniquing structure for tuple type metadata.
-static SimpleGlobalCache<TupleCacheEntry> TupleTypes;
+static SimpleGlobalCache<TupleCacheEntry> TupleTypes("TupleTypes");
 
 /// Given a metatype pointer, produce the value-witness table for it.
 /// This is equivalent to metatype->ValueWitnesses but more efficient.
@@ -1814,7 +1848,7 @@ namespace {
 }
 
 /// The uniquing structure for metatype type metadata.
-static SimpleGlobalCache<MetatypeCacheEntry> MetatypeTypes;
+static SimpleGlobalCache<MetatypeCacheEntry> MetatypeTypes("MetatypeTypes");
 
 /// \brief Fetch a uniqued metadata for a metatype type.
 SWIFT_RUNTIME_EXPORT
@@ -1883,10 +1917,11 @@ public:
 
 /// The uniquing structure for existential metatype value witness tables.
 static SimpleGlobalCache<ExistentialMetatypeValueWitnessTableCacheEntry>
-ExistentialMetatypeValueWitnessTables;
+ExistentialMetatypeValueWitnessTables("ExistentialMetatypeValueWitnessTables");
 
 /// The uniquing structure for existential metatype type metadata.
-static SimpleGlobalCache<ExistentialMetatypeCacheEntry> ExistentialMetatypes;
+static SimpleGlobalCache<ExistentialMetatypeCacheEntry>
+ExistentialMetatypes("ExistentialMetatypes");
 
 static const ExtraInhabitantsValueWitnessTable
 ExistentialMetatypeValueWitnesses_1 =
@@ -2064,7 +2099,8 @@ public:
 } // end anonymous namespace
 
 /// The uniquing structure for existential type metadata.
-static SimpleGlobalCache<ExistentialCacheEntry> ExistentialTypes;
+static SimpleGlobalCache<ExistentialCacheEntry>
+ExistentialTypes("ExistentialTypes");
 
 static const ValueWitnessTable OpaqueExistentialValueWitnesses_0 =
   ValueWitnessTableForBox<OpaqueExistentialBox<0>>::table;
@@ -2073,7 +2109,7 @@ static const ValueWitnessTable OpaqueExistentialValueWitnesses_1 =
 
 /// The uniquing structure for opaque existential value witness tables.
 static SimpleGlobalCache<OpaqueExistentialValueWitnessTableCacheEntry>
-OpaqueExistentialValueWitnessTables;
+OpaqueExistentialValueWitnessTables("OpaqueExistentialValueWitnessTables");
 
 /// Instantiate a value witness table for an opaque existential container with
 /// the given number of witness table pointers.
@@ -2119,7 +2155,7 @@ static const ExtraInhabitantsValueWitnessTable ClassExistentialValueWitnesses_2
 
 /// The uniquing structure for class existential value witness tables.
 static SimpleGlobalCache<ClassExistentialValueWitnessTableCacheEntry>
-ClassExistentialValueWitnessTables;
+ClassExistentialValueWitnessTables("ClassExistentialValueWitnessTables");
 
 /// Instantiate a value witness table for a class-constrained existential
 /// container with the given number of witness table pointers.
@@ -2665,18 +2701,29 @@ namespace {
 using GenericWitnessTableCache = MetadataCache<WitnessTableCacheEntry>;
 using LazyGenericWitnessTableCache = Lazy<GenericWitnessTableCache>;
 
-/// Fetch the cache for a generic witness-table structure.
-static GenericWitnessTableCache &getCache(GenericWitnessTable *gen) {
+namespace {
+  /// The runtime's state for a generic witness table, which lives in its
+  /// zero-initialized private data.
+  struct GenericWitnessTableState {
+    LazyGenericWitnessTableCache Cache;
+
+    /// The entry most recently returned for this conformance.  Checked
+    /// before the cache, so that monomorphic uses don't pay for a lookup.
+    std::atomic<const WitnessTableCacheEntry *> LastEntry;
+  };
+}
+
+/// Fetch the runtime state for a generic witness-table structure.
+static GenericWitnessTableState &getState(GenericWitnessTable *gen) {
   // Keep this assert even if you change the representation above.
-  static_assert(sizeof(LazyGenericWitnessTableCache) <=
+  static_assert(sizeof(GenericWitnessTableState) <=
                 sizeof(GenericWitnessTable::PrivateData),
                 "metadata cache is larger than the allowed space");
 
-  auto lazyCache =
-    reinterpret_cast<LazyGenericWitnessTableCache*>(gen->PrivateData);
-  return lazyCache->get();
+  return *reinterpret_cast<GenericWitnessTableState*>(gen->PrivateData);
 }
 
+
 /// If there's no initializer, no private storage, and all requirements
 /// are present, we don't have to instantiate anything; just return the
 /// witness table template.
@@ -2749,12 +2796,17 @@ allocateWitnessTable(GenericWitnessTable *genericTable,
   memcpy(table, (void * const *) &*genericTable->Pattern,
          actualWitnessTableSize);
 
-  // If this is a resilient conformance, copy in the rest.
+  // If this is a resilient conformance, fill in the rest from the protocol's
+  // default witnesses.
   if (protocol != nullptr && protocol->Flags.isResilient()) {
-    memcpy((char *) table + actualWitnessTableSize,
-           (char *) protocol->getDefaultWitnesses() +
-              (actualWitnessTableSize - minWitnessTableSize),
-           expectedWitnessTableSize - actualWitnessTableSize);
+    auto defaults = protocol->getDefaultWitnesses();
+    auto witnesses = reinterpret_cast<void **>(table);
+    for (size_t i = actualWitnessTableSize / sizeof(void *),
+                e = expectedWitnessTableSize / sizeof(void *);
+         i != e; ++i) {
+      witnesses[i] = reinterpret_cast<void *>(
+          defaults[i - minWitnessTableSize / sizeof(void *)].get());
+    }
   }
 
   return entry;
@@ -2775,7 +2827,18 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
   constexpr const size_t numGenericArgs = 1;
   const void *args[] = { type };
 
-  auto &cache = getCache(genericTable);
+  // Try the most recently used entry first.
+  auto &state = getState(genericTable);
+  if (auto last = state.LastEntry.load(std::memory_order_acquire)) {
+    if (last->getArgumentsBuffer()[0] == type) {
+      if (runtimeStatisticsEnabled())
+        WitnessTableCacheEntry::Statistics.noteLookup(
+                            WitnessTableCacheEntry::getName(), /*hit*/ true);
+      return last->get(genericTable);
+    }
+  }
+
+  auto &cache = state.Cache.get();
   auto entry = cache.findOrAdd(args, numGenericArgs,
     [&]() -> WitnessTableCacheEntry* {
       // Allocate the witness table and fill it in.
@@ -2790,10 +2853,84 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
                                    type, instantiationArgs);
       }
 
+      traceRuntimeEvent(RuntimeTraceWitnessTableInstantiation,
+                        genericTable, type);
       return entry;
     });
 
+  state.LastEntry.store(entry, std::memory_order_release);
   return entry->get(genericTable);
 }
 
 uint64_t swift::RelativeDirectPointerNullPtr = 0;
+
+/***************************************************************************/
+/*** Allocator implementation **********************************************/
+/***************************************************************************/
+
+namespace {
+  /// The unallocated part of the current metadata page.
+  struct PoolRange {
+    static constexpr size_t PageSize = 16 * 1024;
+    static constexpr size_t MaxPoolAllocationSize = PageSize / 2;
+
+    char *Begin;
+    char *End;
+  };
+}
+
+static StaticMutex MetadataPoolLock;
+static PoolRange MetadataPool = { nullptr, nullptr };
+
+static char *allocateMetadataPage() {
+#if defined(_MSC_VER)
+  void *page = VirtualAlloc(nullptr, PoolRange::PageSize,
+                            MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+  void *page = mmap(nullptr, PoolRange::PageSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANON, VM_TAG_FOR_SWIFT_METADATA, 0);
+  if (page == MAP_FAILED)
+    page = nullptr;
+#endif
+  if (!page)
+    crash("unable to allocate memory for Swift metadata");
+  return reinterpret_cast<char*>(page);
+}
+
+void *MetadataAllocator::Allocate(size_t size, size_t alignment) {
+  assert(alignment <= PoolRange::PageSize && "unsupported alignment");
+
+  // Big allocations would waste most of a page; give them their own block.
+  if (size > PoolRange::MaxPoolAllocationSize)
+    return AlignedAlloc(size, alignment);
+
+  StaticScopedLock guard(MetadataPoolLock);
+
+  auto alignedBegin = [&] {
+    return reinterpret_cast<char*>(
+      llvm::alignAddr(MetadataPool.Begin, alignment));
+  };
+
+  char *result = alignedBegin();
+  if (!MetadataPool.Begin || size > size_t(MetadataPool.End - result)) {
+    // Start a new page.  Whatever is left of the old one is abandoned.
+    MetadataPool.Begin = allocateMetadataPage();
+    MetadataPool.End = MetadataPool.Begin + PoolRange::PageSize;
+    result = alignedBegin();
+  }
+
+  MetadataPool.Begin = result + size;
+  return result;
+}
+
+void MetadataAllocator::Deallocate(const void *ptr, size_t size) {
+  if (size > PoolRange::MaxPoolAllocationSize) {
+    AlignedFree(const_cast<void*>(ptr));
+    return;
+  }
+
+  // Give the memory back only if nothing has been allocated after it.
+  StaticScopedLock guard(MetadataPoolLock);
+  if (reinterpret_cast<const char*>(ptr) + size == MetadataPool.Begin)
+    MetadataPool.Begin = const_cast<char*>(reinterpret_cast<const char*>(ptr));
+}
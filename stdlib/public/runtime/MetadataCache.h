@@ -14,9 +14,11 @@
 
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Allocator.h"
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "Statistics.h"
 #include <condition_variable>
 #include <thread>
 
@@ -26,16 +28,61 @@
 
 namespace swift {
 
-// For now, use malloc and free as our standard allocator for
-// metadata caches.  It might make sense in the future to take
-// advantage of the fact that we know that most allocations here
-// won't ever be deallocated.
-using MetadataAllocator = llvm::MallocAllocator;
+/// The allocator for metadata and metadata cache entries.  Almost nothing
+/// allocated here is ever freed, so small allocations are carved out of
+/// large pages with a bump pointer instead of going through malloc.  This
+/// keeps metadata dense in memory and avoids malloc's per-block overhead.
+/// All instances share the same pool.
+class MetadataAllocator : public llvm::AllocatorBase<MetadataAllocator> {
+public:
+  void Reset() {}
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t size, size_t alignment);
+  using AllocatorBase<MetadataAllocator>::Allocate;
+
+  /// Memory is only reclaimed if it was the most recent allocation from the
+  /// pool, as happens when a cache insertion loses a race.
+  void Deallocate(const void *Ptr, size_t size);
+  using AllocatorBase<MetadataAllocator>::Deallocate;
+
+  void PrintStats() const {}
+};
 
-/// A typedef for simple global caches.
+/// A simple global cache.  This is a ConcurrentMap that keeps statistics
+/// about its use under the given name when SWIFT_DEBUG_RUNTIME_STATS is set.
 template <class EntryTy>
-using SimpleGlobalCache =
-  ConcurrentMap<EntryTy, /*destructor*/ false, MetadataAllocator>;
+class SimpleGlobalCache
+    : public ConcurrentMap<EntryTy, /*destructor*/ false, MetadataAllocator> {
+  using super = ConcurrentMap<EntryTy, false, MetadataAllocator>;
+
+  const char *Name;
+  RuntimeCacheStatistics Statistics;
+
+public:
+  constexpr SimpleGlobalCache(const char *name) : Name(name) {}
+
+  template <class KeyTy, class... ArgTys>
+  std::pair<EntryTy*, bool> getOrInsert(KeyTy key, ArgTys &&...args) {
+    auto result = super::getOrInsert(key, std::forward<ArgTys>(args)...);
+    if (runtimeStatisticsEnabled()) {
+      Statistics.noteLookup(Name, !result.second);
+      if (result.second)
+        Statistics.noteInsert(Name, sizeof(EntryTy) +
+                                      result.first->getExtraAllocationSize());
+    }
+    return result;
+  }
+
+  /// Look for an existing entry.  Only hits are counted as lookups, since
+  /// a miss is expected to be followed by getOrInsert.
+  template <class KeyTy>
+  EntryTy *find(const KeyTy &key) {
+    auto result = super::find(key);
+    if (result && runtimeStatisticsEnabled())
+      Statistics.noteLookup(Name, /*hit*/ true);
+    return result;
+  }
+};
 
 // A wrapper around a pointer to a metadata cache entry that provides
 // DenseMap semantics that compare values in the key vector for the metadata
@@ -127,13 +174,17 @@ protected:
   CacheEntry() = default;
 
 public:
+  /// Statistics shared by all the caches holding entries of this kind.
+  static RuntimeCacheStatistics Statistics;
+
   static Impl *allocate(MetadataAllocator &allocator,
                         const void * const *arguments,
                         size_t numArguments, size_t payloadSize) {
-    void *buffer = allocator.Allocate(sizeof(Impl)  +
-                                      numArguments * sizeof(void*) +
-                                      payloadSize,
-                                      alignof(Impl));
+    size_t size = sizeof(Impl) + numArguments * sizeof(void*) + payloadSize;
+    if (runtimeStatisticsEnabled())
+      Statistics.noteAllocation(Impl::getName(), size);
+
+    void *buffer = allocator.Allocate(size, alignof(Impl));
     void *resultPtr = (char*)buffer + numArguments * sizeof(void*);
     auto result = new (resultPtr) Impl(numArguments);
 
@@ -167,6 +218,9 @@ public:
   }
 };
 
+template <class Impl, class Header>
+RuntimeCacheStatistics CacheEntry<Impl, Header>::Statistics;
+
 /// The implementation of a metadata cache.  Note that all-zero must
 /// be a valid state for the cache.
 template <class ValueTy> class MetadataCache {
@@ -296,6 +350,14 @@ public:
     auto insertResult = Map.getOrInsert(key);
     Entry *entry = insertResult.first;
 
+    if (runtimeStatisticsEnabled()) {
+      ValueTy::Statistics.noteLookup(ValueTy::getName(), !insertResult.second);
+      if (insertResult.second)
+        ValueTy::Statistics.noteInsert(ValueTy::getName(),
+                                       sizeof(Entry) +
+                                         entry->getExtraAllocationSize());
+    }
+
     // If we didn't insert the entry, then we just need to get the
     // initialized value from the entry.
     if (!insertResult.second) {
@@ -21,10 +21,12 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/StringExtras.h"
 #include "Private.h"
+#include <unordered_map>
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -64,22 +66,38 @@ namespace {
     }
   };
 
+  struct TypeMetadataCacheKey {
+    llvm::StringRef Name;
+    size_t Hash;
+
+    // llvm::hash_value(StringRef) is defined out of line in a library the
+    // runtime does not link against.
+    explicit TypeMetadataCacheKey(llvm::StringRef name)
+      : Name(name), Hash(llvm::hash_combine_range(name.begin(), name.end())) {}
+  };
+
   struct TypeMetadataCacheEntry {
   private:
     std::string Name;
+    size_t Hash;
     const Metadata *Metadata;
 
   public:
-    TypeMetadataCacheEntry(const llvm::StringRef name,
+    TypeMetadataCacheEntry(const TypeMetadataCacheKey &key,
                            const ::Metadata *metadata)
-      : Name(name.str()), Metadata(metadata) {}
+      : Name(key.Name.str()), Hash(key.Hash), Metadata(metadata) {}
 
     const ::Metadata *getMetadata(void) {
       return Metadata;
     }
 
-    int compareWithKey(llvm::StringRef aName) const {
-      return aName.compare(Name);
+    int compareWithKey(const TypeMetadataCacheKey &key) const {
+      // Order by hash first so that lookups don't pay for a string
+      // comparison at every level of the tree, and so that names sharing
+      // a long mangled prefix don't cluster on one side of it.
+      if (key.Hash != Hash)
+        return (key.Hash < Hash ? -1 : 1);
+      return key.Name.compare(Name);
     }
 
     template <class... T>
@@ -87,6 +105,12 @@ namespace {
       return 0;
     }
   };
+
+  struct TypeNameHash {
+    size_t operator()(llvm::StringRef name) const {
+      return llvm::hash_combine_range(name.begin(), name.end());
+    }
+  };
 }
 
 #if defined(__APPLE__) && defined(__MACH__)
@@ -107,6 +131,17 @@ struct TypeMetadataState {
   std::vector<TypeMetadataSection> SectionsToScan;
   Mutex SectionsToScanLock;
 
+  /// The first record for each mangled type name in the first
+  /// NumIndexedSections of SectionsToScan. Guarded by SectionsToScanLock.
+  std::unordered_map<llvm::StringRef, const TypeMetadataRecord *,
+                     TypeNameHash> RecordsByName;
+  size_t NumIndexedSections = 0;
+
+  // This state is only created by the first name-based type lookup, so the
+  // image callbacks below, and the section lookups they perform, are not
+  // paid for at launch by programs that never need them. Registering a
+  // section only records its bounds; records are not parsed until a lookup
+  // scans them.
   TypeMetadataState() {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
@@ -226,27 +261,42 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
   return metadata;
 }
 
-// returns the type metadata for the type named by typeName
-static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
-                           const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
+// Add the records of any sections registered since the last lookup to the
+// name index, so that lookups, and lookups of names that don't exist in
+// particular, don't have to scan every record.
+static void _indexTypeMetadataRecords(TypeMetadataState &T) {
+  for (; T.NumIndexedSections < T.SectionsToScan.size();
+       ++T.NumIndexedSections) {
+    auto &section = T.SectionsToScan[T.NumIndexedSections];
     for (const auto &record : section) {
+      const NominalTypeDescriptor *ntd = nullptr;
       if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
+        ntd = metadata->getNominalTypeDescriptor();
+      else
+        ntd = record.getNominalTypeDescriptor();
 
-      if (foundMetadata != nullptr)
-        return foundMetadata;
+      // Like the search this replaced, the first record with a name wins.
+      if (ntd != nullptr)
+        T.RecordsByName.insert({ntd->Name.get(), &record});
     }
   }
+}
+
+// returns the type metadata for the type named by typeName
+static const Metadata *
+_searchTypeMetadataRecords(TypeMetadataState &T,
+                           const llvm::StringRef typeName) {
+  _indexTypeMetadataRecords(T);
+
+  auto found = T.RecordsByName.find(typeName);
+  if (found == T.RecordsByName.end())
+    return nullptr;
 
+  auto &record = *found->second;
+  if (auto metadata = record.getCanonicalTypeMetadata())
+    return _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
+  if (auto ntd = record.getNominalTypeDescriptor())
+    return _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
   return nullptr;
 }
 
@@ -257,7 +307,8 @@ _typeByMangledName(const llvm::StringRef typeName) {
 
   // Look for an existing entry.
   // Find the bucket for the metadata entry.
-  if (auto Value = T.Cache.find(typeName))
+  TypeMetadataCacheKey key(typeName);
+  if (auto Value = T.Cache.find(key))
     return Value->getMetadata();
 
   // Check type metadata records
@@ -271,7 +322,7 @@ _typeByMangledName(const llvm::StringRef typeName) {
     foundMetadata = _searchConformancesByMangledTypeName(typeName);
 
   if (foundMetadata) {
-    T.Cache.getOrInsert(typeName, foundMetadata);
+    T.Cache.getOrInsert(key, foundMetadata);
   }
 
 #if SWIFT_OBJC_INTEROP
@@ -17,8 +17,18 @@
 #include "Private.h"
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include "Tracing.h"
+#include <atomic>
+#include <climits>
+#include <thread>
 #include <type_traits>
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace swift;
 
 #ifdef __APPLE__
@@ -35,23 +45,107 @@ static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
 static_assert(sizeof(swift_once_t) <= sizeof(void*),
               "swift_once_t must be no larger than the platform word");
 
+namespace {
+  struct OnceInitializer {
+    swift_once_t *Predicate;
+    void (*Fn)(void *);
+  };
+}
+
+/// Run an initializer on behalf of swift_once, reporting it to the trace
+/// hook.  Only the slow path pays for the check.
+static void runOnceInitializer(void *context) {
+  auto initializer = static_cast<OnceInitializer *>(context);
+  traceRuntimeEvent(RuntimeTraceOnceExecution, initializer->Predicate,
+                    reinterpret_cast<const void *>(initializer->Fn));
+  initializer->Fn(nullptr);
+}
+
+#if !defined(__APPLE__)
+
+// The predicate is 0 until a thread claims the initialization, and ~0 once
+// the initializer has returned.  IRGen checks for ~0 inline with an acquire
+// load, so only the first accesses reach swift_once at all.
+static constexpr uintptr_t OnceUninitialized = 0;
+static constexpr uintptr_t OnceRunning = 1;
+static constexpr uintptr_t OnceRunningWithWaiters = 2;
+static constexpr uintptr_t OnceDone = ~uintptr_t(0);
+
+static_assert(sizeof(std::atomic<uintptr_t>) == sizeof(swift_once_t),
+              "swift_once_t must be usable as an atomic word");
+
+#if defined(__linux__)
+/// The futex word within a predicate: the low half of the word.  Every
+/// state but OnceDone fits in it, and OnceDone's low half is distinct.
+static int *getOnceFutexWord(std::atomic<uintptr_t> *state) {
+  int *word = reinterpret_cast<int *>(state);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word += (sizeof(uintptr_t) / sizeof(int)) - 1;
+#endif
+  return word;
+}
+#endif
+
+/// Block until the thread running the initializer has finished.
+static void waitForOnce(std::atomic<uintptr_t> *state) {
+#if defined(__linux__)
+  while (true) {
+    uintptr_t current = state->load(std::memory_order_acquire);
+    if (current == OnceDone)
+      return;
+    // Tell the initializing thread that it has to wake us.
+    if (current == OnceRunning &&
+        !state->compare_exchange_weak(current, OnceRunningWithWaiters,
+                                      std::memory_order_acquire,
+                                      std::memory_order_acquire))
+      continue;
+    syscall(SYS_futex, getOnceFutexWord(state), FUTEX_WAIT_PRIVATE,
+            int(OnceRunningWithWaiters), nullptr, nullptr, 0);
+  }
+#else
+  while (state->load(std::memory_order_acquire) != OnceDone)
+    std::this_thread::yield();
+#endif
+}
+
+static void runOnce(swift_once_t *predicate, OnceInitializer &initializer) {
+  auto state = reinterpret_cast<std::atomic<uintptr_t> *>(predicate);
+  if (state->load(std::memory_order_acquire) == OnceDone)
+    return;
+
+  uintptr_t expected = OnceUninitialized;
+  if (!state->compare_exchange_strong(expected, OnceRunning,
+                                      std::memory_order_acquire,
+                                      std::memory_order_acquire)) {
+    waitForOnce(state);
+    return;
+  }
+
+  runOnceInitializer(&initializer);
+
+  // Publish the initialized state; the release pairs with the acquire
+  // loads of the inline check and of waiting threads.
+  auto previous = state->exchange(OnceDone, std::memory_order_release);
+#if defined(__linux__)
+  if (previous == OnceRunningWithWaiters)
+    syscall(SYS_futex, getOnceFutexWord(state), FUTEX_WAKE_PRIVATE, INT_MAX,
+            nullptr, nullptr, 0);
+#else
+  (void) previous;
+#endif
+}
+
+#endif
+
 /// Runs the given function with the given context argument exactly once.
 /// The predicate argument must point to a global or static variable of static
 /// extent of type swift_once_t.
 void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
+  OnceInitializer initializer = { predicate, fn };
+
 #if defined(__APPLE__)
-  dispatch_once_f(predicate, nullptr, fn);
-#elif defined(__CYGWIN__)
-  _swift_once_f(predicate, nullptr, fn);
+  dispatch_once_f(predicate, &initializer, runOnceInitializer);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // The MSVC port also relies on this, because the std::call_once on MSVC
-  // follows the compatible init process.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  runOnce(predicate, initializer);
 #endif
 }
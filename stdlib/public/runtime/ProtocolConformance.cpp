@@ -19,7 +19,14 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
+#include "FunctionCounters.h"
 #include "Private.h"
+#include "Statistics.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <vector>
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -157,27 +164,71 @@ const {
 namespace {
   struct ConformanceSection {
     const ProtocolConformanceRecord *Begin, *End;
+
+    /// The records of the section sorted by protocol, built the first time
+    /// the section is searched for a conformance. Guarded by
+    /// SectionsToScanLock.
+    std::vector<const ProtocolConformanceRecord *> ByProtocol;
+
     const ProtocolConformanceRecord *begin() const {
       return Begin;
     }
     const ProtocolConformanceRecord *end() const {
       return End;
     }
+
+    /// Return the records of this section that name the given protocol.
+    llvm::ArrayRef<const ProtocolConformanceRecord *>
+    getRecordsForProtocol(const ProtocolDescriptor *protocol) {
+      if (ByProtocol.empty() && Begin != End) {
+        ByProtocol.reserve(End - Begin);
+        for (auto &record : *this)
+          ByProtocol.push_back(&record);
+        std::stable_sort(ByProtocol.begin(), ByProtocol.end(),
+                         [](const ProtocolConformanceRecord *lhs,
+                            const ProtocolConformanceRecord *rhs) {
+          return std::less<const ProtocolDescriptor *>()(lhs->getProtocol(),
+                                                         rhs->getProtocol());
+        });
+      }
+
+      auto range = std::equal_range(ByProtocol.begin(), ByProtocol.end(),
+                                    protocol, ProtocolOrder());
+      return llvm::makeArrayRef(ByProtocol.data() +
+                                  (range.first - ByProtocol.begin()),
+                                range.second - range.first);
+    }
+
+  private:
+    struct ProtocolOrder {
+      bool operator()(const ProtocolConformanceRecord *record,
+                      const ProtocolDescriptor *protocol) const {
+        return std::less<const ProtocolDescriptor *>()(record->getProtocol(),
+                                                       protocol);
+      }
+      bool operator()(const ProtocolDescriptor *protocol,
+                      const ProtocolConformanceRecord *record) const {
+        return std::less<const ProtocolDescriptor *>()(protocol,
+                                                       record->getProtocol());
+      }
+    };
   };
 
   struct ConformanceCacheKey {
     /// Either a Metadata* or a NominalTypeDescriptor*.
     const void *Type;
     const ProtocolDescriptor *Proto;
+    size_t Hash;
 
     ConformanceCacheKey(const void *type, const ProtocolDescriptor *proto)
-      : Type(type), Proto(proto) {}
+      : Type(type), Proto(proto), Hash(llvm::hash_combine(type, proto)) {}
   };
 
   struct ConformanceCacheEntry {
   private:
     const void *Type; 
     const ProtocolDescriptor *Proto;
+    size_t Hash;
     std::atomic<const WitnessTable *> Table;
     std::atomic<uintptr_t> FailureGeneration;
 
@@ -185,12 +236,16 @@ namespace {
     ConformanceCacheEntry(ConformanceCacheKey key,
                           const WitnessTable *table,
                           uintptr_t failureGeneration)
-      : Type(key.Type), Proto(key.Proto), Table(table),
+      : Type(key.Type), Proto(key.Proto), Hash(key.Hash), Table(table),
         FailureGeneration(failureGeneration) {
     }
 
     int compareWithKey(const ConformanceCacheKey &key) const {
-      if (key.Type != Type) {
+      // Order by hash first. Types and protocols are mostly registered in
+      // address order, which would otherwise degrade the tree into a list.
+      if (key.Hash != Hash) {
+        return (key.Hash < Hash ? -1 : 1);
+      } else if (key.Type != Type) {
         return (uintptr_t(key.Type) < uintptr_t(Type) ? -1 : 1);
       } else if (key.Proto != Proto) {
         return (uintptr_t(key.Proto) < uintptr_t(Proto) ? -1 : 1);
@@ -245,11 +300,30 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
                                                size_t conformancesSize);
 #endif
 
+static RuntimeCacheStatistics ConformanceCacheStatistics;
+
+static void noteConformanceCacheInsert(bool inserted) {
+  if (inserted && runtimeStatisticsEnabled())
+    ConformanceCacheStatistics.noteInsert("ConformanceCache",
+                                          sizeof(ConformanceCacheEntry));
+}
+
 struct ConformanceState {
   ConcurrentMap<ConformanceCacheEntry> Cache;
   std::vector<ConformanceSection> SectionsToScan;
   Mutex SectionsToScanLock;
+
+  /// The number of entries in SectionsToScan, published after each image is
+  /// registered. Cached failures record the value they were computed
+  /// against, so readers can validate a negative answer without taking
+  /// SectionsToScanLock, and a stale failure only needs the sections added
+  /// since then to be scanned.
+  std::atomic<size_t> NumSections{0};
   
+  // This state is only created by the first conformance lookup, so the image
+  // callbacks below, and the section lookups they perform, are not paid for
+  // at launch by programs that never need them. Registering a section only
+  // records its bounds; records are not parsed until a lookup scans them.
   ConformanceState() {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
@@ -265,6 +339,7 @@ struct ConformanceState {
                     const WitnessTable *witness) {
     auto result = Cache.getOrInsert(ConformanceCacheKey(type, proto),
                                     witness, uintptr_t(0));
+    noteConformanceCacheInsert(result.second);
 
     // If the entry was already present, we may need to update it.
     if (!result.second) {
@@ -274,9 +349,11 @@ struct ConformanceState {
 
   void cacheFailure(const void *type, const ProtocolDescriptor *proto) {
     uintptr_t failureGeneration = SectionsToScan.size();
+    assert(failureGeneration == NumSections.load(std::memory_order_relaxed));
     auto result = Cache.getOrInsert(ConformanceCacheKey(type, proto),
                                     (const WitnessTable *) nullptr,
                                     failureGeneration);
+    noteConformanceCacheInsert(result.second);
 
     // If the entry was already present, we may need to update it.
     if (!result.second) {
@@ -298,6 +375,7 @@ _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *end) {
   ScopedLock guard(C.SectionsToScanLock);
   C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.NumSections.store(C.SectionsToScan.size(), std::memory_order_release);
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
@@ -490,7 +568,8 @@ recur_inside_cache_lock:
         foundEntry = Value;
 
       // If we got a cached negative response, check the generation number.
-      if (Value->getFailureGeneration() == C.SectionsToScan.size()) {
+      if (Value->getFailureGeneration() ==
+            C.NumSections.load(std::memory_order_acquire)) {
         // We found an entry with a negative value.
         return std::make_pair(nullptr, true);
       }
@@ -564,10 +643,12 @@ bool isRelatedType(const Metadata *type, const void *candidate,
 const WitnessTable *
 swift::swift_conformsToProtocol(const Metadata *type,
                                 const ProtocolDescriptor *protocol) {
+  SWIFT_COUNT_RUNTIME_CALL(swift_conformsToProtocol, type);
   auto &C = Conformances.get();
   auto origType = type;
   unsigned numSections = 0;
   ConformanceCacheEntry *foundEntry;
+  bool scannedSections = false;
 
 recur:
   // See if we have a cached conformance. The ConcurrentMap data structure
@@ -580,8 +661,12 @@ recur:
   // it may mean that all of the superclasses do not have this conformance,
   // but the actual type may still have this conformance.
   if (FoundConformance.second) {
-    if (FoundConformance.first || foundEntry)
+    if (FoundConformance.first || foundEntry) {
+      if (runtimeStatisticsEnabled())
+        ConformanceCacheStatistics.noteLookup("ConformanceCache",
+                                              !scannedSections);
       return FoundConformance.first;
+    }
   }
 
   // If we didn't have an up-to-date cache entry, scan the conformance records.
@@ -604,11 +689,16 @@ recur:
     C.cacheFailure(type, protocol);
 
     C.SectionsToScanLock.unlock();
+    if (runtimeStatisticsEnabled())
+      ConformanceCacheStatistics.noteLookup("ConformanceCache",
+                                            /*hit*/ false);
     return nullptr;
   }
 
   // Update the last known number of sections to scan.
   numSections = C.SectionsToScan.size();
+  scannedSections = true;
+  traceRuntimeEvent(RuntimeTraceConformanceScan, origType, protocol);
 
   // Scan only sections that were not scanned yet.
   unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
@@ -616,16 +706,14 @@ recur:
 
   for (; sectionIdx < endSectionIdx; ++sectionIdx) {
     auto &section = C.SectionsToScan[sectionIdx];
-    // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
+    // Only visit the records for the protocol we're looking for; the others
+    // can't affect the answer.
+    for (auto recordPtr : section.getRecordsForProtocol(protocol)) {
+      const auto &record = *recordPtr;
       // If the record applies to a specific type, cache it.
       if (auto metadata = record.getCanonicalTypeMetadata()) {
         auto P = record.getProtocol();
 
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
         if (!isRelatedType(type, metadata, /*isMetadata=*/true))
           continue;
 
@@ -646,10 +734,6 @@ recur:
         auto R = record.getNominalTypeDescriptor();
         auto P = record.getProtocol();
 
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
         if (!isRelatedType(type, R, /*isMetadata=*/false))
           continue;
 
@@ -0,0 +1,83 @@
+//===--- Statistics.cpp - Runtime cache statistics ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Collection and reporting of runtime cache statistics.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Statistics.h"
+#include "swift/Runtime/Debug.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace swift;
+
+std::atomic<int> swift::_swift_runtimeStatisticsState{-1};
+
+/// All the statistics objects that have been updated so far.
+static std::atomic<RuntimeCacheStatistics *> AllStatistics{nullptr};
+
+static void dumpRuntimeStatisticsAtExit() {
+  RuntimeCacheStatistics::dumpAll();
+}
+
+bool swift::_swift_computeRuntimeStatisticsEnabled() {
+  const char *value = getenv("SWIFT_DEBUG_RUNTIME_STATS");
+  bool enabled = value && value[0] && strcmp(value, "0") != 0;
+
+  // Only the thread that settles the state installs the exit handler.
+  int expected = -1;
+  if (_swift_runtimeStatisticsState.compare_exchange_strong(
+          expected, enabled ? 1 : 0, std::memory_order_relaxed)) {
+    if (enabled)
+      atexit(dumpRuntimeStatisticsAtExit);
+    return enabled;
+  }
+  return expected != 0;
+}
+
+void RuntimeCacheStatistics::registerStatistics(const char *name) {
+  bool expected = false;
+  if (!Registered.compare_exchange_strong(expected, true,
+                                          std::memory_order_relaxed))
+    return;
+
+  Name = name;
+  Next = AllStatistics.load(std::memory_order_relaxed);
+  while (!AllStatistics.compare_exchange_weak(Next, this,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+    // Next was updated to the current head; try again.
+  }
+}
+
+void RuntimeCacheStatistics::dump() const {
+  size_t lookups = Lookups.load(std::memory_order_relaxed);
+  size_t hits = Hits.load(std::memory_order_relaxed);
+  double hitRate = lookups ? 100.0 * hits / lookups : 0.0;
+  fprintf(stderr, "%-40s %10zu %12zu %12zu %8.1f%%\n", Name,
+          Entries.load(std::memory_order_relaxed),
+          Bytes.load(std::memory_order_relaxed), lookups, hitRate);
+}
+
+void RuntimeCacheStatistics::dumpAll() {
+  fprintf(stderr, "%-40s %10s %12s %12s %9s\n",
+          "cache", "entries", "bytes", "lookups", "hit rate");
+  for (auto stats = AllStatistics.load(std::memory_order_acquire); stats;
+       stats = stats->Next)
+    stats->dump();
+}
+
+void swift::swift_dumpRuntimeStatistics() {
+  RuntimeCacheStatistics::dumpAll();
+}
@@ -0,0 +1,99 @@
+//===--- Statistics.h - Runtime cache statistics ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters describing how the runtime's metadata and conformance caches are
+// used.  They are only collected when the SWIFT_DEBUG_RUNTIME_STATS
+// environment variable is set, and are printed to stderr at exit or by
+// swift_dumpRuntimeStatistics().
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_STATISTICS_H
+#define SWIFT_RUNTIME_STATISTICS_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace swift {
+
+/// 1 if statistics are being collected, 0 if not, and -1 if the
+/// environment has not been checked yet.
+extern std::atomic<int> _swift_runtimeStatisticsState;
+
+bool _swift_computeRuntimeStatisticsEnabled();
+
+/// Are runtime cache statistics being collected?
+static inline bool runtimeStatisticsEnabled() {
+  int state = _swift_runtimeStatisticsState.load(std::memory_order_relaxed);
+  if (state < 0)
+    return _swift_computeRuntimeStatisticsEnabled();
+  return state != 0;
+}
+
+/// The counters for one runtime cache, or for all the caches of one kind.
+/// Must be constant-initialized; the object registers itself for reporting
+/// the first time it is updated.
+class RuntimeCacheStatistics {
+  const char *Name = nullptr;
+  RuntimeCacheStatistics *Next = nullptr;
+  std::atomic<bool> Registered{false};
+
+  std::atomic<size_t> Lookups{0};
+  std::atomic<size_t> Hits{0};
+  std::atomic<size_t> Entries{0};
+  std::atomic<size_t> Bytes{0};
+
+  void registerStatistics(const char *name);
+
+  void ensureRegistered(const char *name) {
+    if (!Registered.load(std::memory_order_relaxed))
+      registerStatistics(name);
+  }
+
+public:
+  constexpr RuntimeCacheStatistics() {}
+
+  RuntimeCacheStatistics(const RuntimeCacheStatistics &) = delete;
+  RuntimeCacheStatistics &operator=(const RuntimeCacheStatistics &) = delete;
+
+  /// Record a lookup, which either found an existing entry or had to
+  /// create one.
+  void noteLookup(const char *name, bool hit) {
+    ensureRegistered(name);
+    Lookups.fetch_add(1, std::memory_order_relaxed);
+    if (hit)
+      Hits.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Record the insertion of an entry of the given size.
+  void noteInsert(const char *name, size_t bytes) {
+    ensureRegistered(name);
+    Entries.fetch_add(1, std::memory_order_relaxed);
+    Bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /// Record memory allocated on behalf of an existing entry, such as the
+  /// metadata built for a generic cache entry.
+  void noteAllocation(const char *name, size_t bytes) {
+    ensureRegistered(name);
+    Bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /// Print a line summarizing these counters to stderr.
+  void dump() const;
+
+  static void dumpAll();
+};
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_STATISTICS_H
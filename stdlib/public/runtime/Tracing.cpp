@@ -0,0 +1,130 @@
+//===--- Tracing.cpp - Runtime event tracing ------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The built-in recorder for _swift_runtimeTraceHook.
+//
+// The trace file starts with a TraceFileHeader and is followed by
+// NumRecords TraceRecords, all in the byte order of the traced process.
+// utils/swift-runtime-trace-dump knows this layout; keep them in sync.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Tracing.h"
+#include "swift/Basic/Lazy.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+using namespace swift;
+
+void (*swift::_swift_runtimeTraceHook)(uint32_t kind, const void *subject,
+                                       const void *detail) = nullptr;
+
+namespace {
+  struct TraceFileHeader {
+    char Magic[8];
+    uint32_t Version;
+    uint32_t RecordSize;
+    uint64_t NumRecords;
+    uint64_t NumDroppedRecords;
+  };
+
+  struct TraceRecord {
+    /// Nanoseconds since tracing started.
+    uint64_t Timestamp;
+    uint32_t Kind;
+    uint32_t Thread;
+    uint64_t Subject;
+    uint64_t Detail;
+  };
+
+  static_assert(sizeof(TraceRecord) == 32, "trace record layout changed");
+}
+
+/// The number of records kept. Events past this are counted but dropped,
+/// which keeps the recorder cheap; launch traces are far smaller.
+static constexpr size_t MaxTraceRecords = 1 << 18;
+
+static const char *TraceFilePath;
+static TraceRecord *TraceRecords;
+static std::atomic<size_t> NumTraceEvents{0};
+static std::chrono::steady_clock::time_point TraceStart;
+
+static void recordRuntimeEvent(uint32_t kind, const void *subject,
+                               const void *detail) {
+  size_t index = NumTraceEvents.fetch_add(1, std::memory_order_relaxed);
+  if (index >= MaxTraceRecords)
+    return;
+
+  auto elapsed = std::chrono::steady_clock::now() - TraceStart;
+  auto &record = TraceRecords[index];
+  record.Timestamp =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  record.Kind = kind;
+  record.Thread = uint32_t(std::hash<std::thread::id>()(
+                                               std::this_thread::get_id()));
+  record.Subject = uint64_t(uintptr_t(subject));
+  record.Detail = uint64_t(uintptr_t(detail));
+}
+
+static void writeRuntimeTrace() {
+  FILE *file = fopen(TraceFilePath, "wb");
+  if (!file) {
+    fprintf(stderr, "swift runtime: unable to write trace to %s\n",
+            TraceFilePath);
+    return;
+  }
+
+  size_t numEvents = NumTraceEvents.load(std::memory_order_relaxed);
+  size_t numRecords = numEvents < MaxTraceRecords ? numEvents
+                                                  : MaxTraceRecords;
+  TraceFileHeader header;
+  memcpy(header.Magic, "SWRTTRCE", sizeof(header.Magic));
+  header.Version = 1;
+  header.RecordSize = sizeof(TraceRecord);
+  header.NumRecords = numRecords;
+  header.NumDroppedRecords = numEvents - numRecords;
+
+  fwrite(&header, sizeof(header), 1, file);
+  fwrite(TraceRecords, sizeof(TraceRecord), numRecords, file);
+  fclose(file);
+}
+
+static void initializeRuntimeTracing(void *) {
+  const char *path = getenv("SWIFT_DEBUG_RUNTIME_TRACE");
+  if (!path || !path[0])
+    return;
+
+  // Don't replace a hook that a tool installed before the first event.
+  if (_swift_runtimeTraceHook)
+    return;
+
+  TraceRecords = static_cast<TraceRecord *>(
+                              calloc(MaxTraceRecords, sizeof(TraceRecord)));
+  if (!TraceRecords)
+    return;
+
+  TraceFilePath = strdup(path);
+  TraceStart = std::chrono::steady_clock::now();
+  _swift_runtimeTraceHook = recordRuntimeEvent;
+  atexit(writeRuntimeTrace);
+}
+
+bool swift::_swift_isRuntimeTracingEnabled() {
+  static OnceToken_t token;
+  SWIFT_ONCE_F(token, initializeRuntimeTracing, nullptr);
+  return _swift_runtimeTraceHook != nullptr;
+}
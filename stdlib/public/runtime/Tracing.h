@@ -0,0 +1,42 @@
+//===--- Tracing.h - Runtime event tracing ----------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Reporting of expensive one-time runtime work, such as metadata
+// instantiation, to _swift_runtimeTraceHook.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_TRACING_H
+#define SWIFT_RUNTIME_TRACING_H
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/InstrumentsSupport.h"
+
+namespace swift {
+
+/// Is a trace hook installed?  The first call reads SWIFT_DEBUG_RUNTIME_TRACE
+/// and installs the built-in recorder if it is set.
+bool _swift_isRuntimeTracingEnabled();
+
+/// Report an event to the trace hook, if there is one.
+static inline void traceRuntimeEvent(RuntimeTraceEventKind kind,
+                                     const void *subject,
+                                     const void *detail) {
+  if (!_swift_isRuntimeTracingEnabled())
+    return;
+  if (auto hook = _swift_runtimeTraceHook)
+    hook(kind, subject, detail);
+}
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_TRACING_H
@@ -48,6 +48,17 @@ __swift_size_t swift::_swift_stdlib_fwrite_stdout(const void *ptr,
   return fwrite(ptr, size, nitems, stdout);
 }
 
+__swift_size_t swift::_swift_stdlib_fwrite_stdout_unlocked(
+    const void *ptr, __swift_size_t size, __swift_size_t nitems) {
+#if defined(_MSC_VER)
+  return _fwrite_nolock(ptr, size, nitems, stdout);
+#elif defined(__GLIBC__)
+  return fwrite_unlocked(ptr, size, nitems, stdout);
+#else
+  return fwrite(ptr, size, nitems, stdout);
+#endif
+}
+
 __swift_size_t swift::_swift_stdlib_strlen(const char *s) {
   return strlen(s);
 }
@@ -57,6 +68,10 @@ int swift::_swift_stdlib_memcmp(const void *s1, const void *s2,
   return memcmp(s1, s2, n);
 }
 
+void *swift::_swift_stdlib_memchr(const void *s, int c, __swift_size_t n) {
+  return const_cast<void *>(memchr(s, c, n));
+}
+
 __swift_ssize_t
 swift::_swift_stdlib_read(int fd, void *buf, __swift_size_t nbyte) {
 #if defined(_MSC_VER)
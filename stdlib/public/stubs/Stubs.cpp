@@ -31,6 +31,7 @@
 #include <unistd.h>
 #endif
 #include <climits>
+#include <cmath>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
@@ -71,6 +72,12 @@ static long double swift_strtold_l(const char *nptr,
 #include "../SwiftShims/RuntimeShims.h"
 #include "../SwiftShims/RuntimeStubs.h"
 
+/// The decimal digits of 00 through 99, in order.
+static const char DecimalDigitPairs[] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536"
+  "37383940414243444546474849505152535455565758596061626364656667686970717273"
+  "7475767778798081828384858687888990919293949596979899";
+
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
                                    bool Negative) {
@@ -80,10 +87,28 @@ static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
   if (Y == 0) {
     *P++ = '0';
   } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
+    // Produce the digits from the end of a scratch buffer, two per
+    // division, so that they need no reversing.
+    char Digits[20];
+    char *End = Digits + sizeof(Digits);
+    char *D = End;
+    while (Y >= 100) {
+      const char *Pair = DecimalDigitPairs + 2 * (Y % 100);
+      Y /= 100;
+      *--D = Pair[1];
+      *--D = Pair[0];
+    }
+    if (Y >= 10) {
+      const char *Pair = DecimalDigitPairs + 2 * Y;
+      *--D = Pair[1];
+      *--D = Pair[0];
+    } else {
+      *--D = '0' + char(Y);
     }
+    if (Negative)
+      *P++ = '-';
+    memcpy(P, D, End - D);
+    return size_t(P + (End - D) - Buffer);
   } else {
     unsigned Radix32 = Radix;
     while (Y) {
@@ -193,6 +218,21 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
     Precision = std::numeric_limits<T>::max_digits10;
   }
 
+  // An integral value with at most Precision digits prints as those digits
+  // under "%g", so it is formatted as an integer without calling into the
+  // C library.  The limit is kept well inside the range of uint64_t.
+  T Limit = 1;
+  for (int Digit = 0; Digit < Precision && Limit < T(1e18); ++Digit)
+    Limit *= 10;
+  if (Value > -Limit && Value < Limit && Value == T(int64_t(Value))) {
+    bool Negative = std::signbit(Value);
+    uint64_t Magnitude = uint64_t(Negative ? -Value : Value);
+    uint64_t i = uint64ToStringImpl(Buffer, Magnitude, 10, false, Negative);
+    Buffer[i++] = '.';
+    Buffer[i++] = '0';
+    return i;
+  }
+
 #if defined(__CYGWIN__) || defined(_MSC_VER)
   // Cygwin does not support uselocale(), but we can use the locale feature 
   // in stringstream object.
@@ -19,6 +19,7 @@
 #include "swift/Runtime/Debug.h"
 
 #include <algorithm>
+#include <iterator>
 #include <mutex>
 #include <assert.h>
 
@@ -26,6 +27,8 @@
 #include <unicode/ucol.h>
 #include <unicode/ucoleitr.h>
 #include <unicode/uiter.h>
+#include <unicode/unorm2.h>
+#include <unicode/uset.h>
 
 #include "../SwiftShims/UnicodeShims.h"
 
@@ -111,6 +114,105 @@ private:
   ASCIICollation(const ASCIICollation &) = delete;
 };
 
+/// This class caches the collation elements of the code units below
+/// SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE whose collation elements don't
+/// depend on the code units around them.  A string made only of such code
+/// units is unchanged by normalization, so its collation elements are
+/// those of its code units in order.  Every other entry is UCOL_NULLORDER.
+class SimpleCollation {
+public:
+  friend class swift::Lazy<SimpleCollation>;
+
+  static swift::Lazy<SimpleCollation> theTable;
+  static const SimpleCollation *getTable() {
+    return &theTable.get();
+  }
+
+  int32_t CollationTable[SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE];
+
+private:
+  /// Construct the simple collation table.
+  SimpleCollation() {
+    std::fill(std::begin(CollationTable), std::end(CollationTable),
+              (int32_t)UCOL_NULLORDER);
+
+    const UCollator *Collator = GetRootCollator();
+    UErrorCode ErrorCode = U_ZERO_ERROR;
+    const UNormalizer2 *NFD = unorm2_getNFDInstance(&ErrorCode);
+    USet *Contractions = uset_openEmpty();
+    ucol_getContractionsAndExpansions(Collator, Contractions, nullptr,
+                                      /*addPrefixes=*/true, &ErrorCode);
+    if (U_FAILURE(ErrorCode)) {
+      uset_close(Contractions);
+      return;
+    }
+
+    // Code units that appear in a contraction, or in the prefix of a
+    // context-sensitive mapping, take their collation elements from their
+    // neighbours.
+    bool IsInContraction[SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE] = {};
+    for (int32_t Item = 0, e = uset_getItemCount(Contractions); Item != e;
+         ++Item) {
+      UChar32 Start, End;
+      UChar Str[64];
+      int32_t Length = uset_getItem(Contractions, Item, &Start, &End, Str,
+                                    64, &ErrorCode);
+      if (U_FAILURE(ErrorCode)) {
+        // Leave the table empty rather than miss a contraction.
+        uset_close(Contractions);
+        return;
+      }
+      if (Length == 0) {
+        for (UChar32 c = Start;
+             c <= End && c < SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE; ++c)
+          IsInContraction[c] = true;
+        continue;
+      }
+      for (int32_t i = 0; i != Length; ++i)
+        if (Str[i] < SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE)
+          IsInContraction[Str[i]] = true;
+    }
+    uset_close(Contractions);
+
+    for (uint16_t c = 0; c < SWIFT_STDLIB_SIMPLE_COLLATION_TABLE_SIZE; ++c) {
+      // Skip code units that decompose or combine with their neighbours.
+      if (IsInContraction[c] || !unorm2_isInert(NFD, c))
+        continue;
+
+      intptr_t NumCollationElts = 0;
+      int32_t CollationElt = 0;
+#if defined(__CYGWIN__) || defined(_MSC_VER)
+      UChar Buffer[1];
+#else
+      uint16_t Buffer[1];
+#endif
+      Buffer[0] = c;
+
+      ErrorCode = U_ZERO_ERROR;
+      UCollationElements *CollationIterator =
+          ucol_openElements(Collator, Buffer, 1, &ErrorCode);
+
+      while (U_SUCCESS(ErrorCode)) {
+        intptr_t Elem = ucol_next(CollationIterator, &ErrorCode);
+        if (Elem != UCOL_NULLORDER) {
+          CollationElt = Elem;
+          ++NumCollationElts;
+        } else {
+          break;
+        }
+      }
+
+      ucol_closeElements(CollationIterator);
+      // Code units that expand to several elements use the iterator.
+      if (U_SUCCESS(ErrorCode) && NumCollationElts == 1)
+        CollationTable[c] = CollationElt;
+    }
+  }
+
+  SimpleCollation &operator=(const SimpleCollation &) = delete;
+  SimpleCollation(const SimpleCollation &) = delete;
+};
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -228,6 +330,10 @@ const __swift_int32_t *swift::_swift_stdlib_unicode_getASCIICollationTable() {
   return ASCIICollation::getTable()->CollationTable;
 }
 
+const __swift_int32_t *swift::_swift_stdlib_unicode_getSimpleCollationTable() {
+  return SimpleCollation::getTable()->CollationTable;
+}
+
 /// Convert the unicode string to uppercase. This function will return the
 /// required buffer length as a result. If this length does not match the
 /// 'DestinationCapacity' this function must be called again with a buffer of
@@ -283,3 +389,4 @@ swift::_swift_stdlib_unicode_strToLower(uint16_t *Destination,
 }
 
 swift::Lazy<ASCIICollation> ASCIICollation::theTable;
+swift::Lazy<SimpleCollation> SimpleCollation::theTable;
@@ -115,3 +115,8 @@ func testRecursion() {
   _ = RECURSION // expected-error {{use of unresolved identifier 'RECURSION'}}
   _ = REF_TO_RECURSION // expected-error {{use of unresolved identifier 'REF_TO_RECURSION'}}
 }
+
+func testLongExpansions() {
+  _ = LONG_EXPRESSION // expected-error {{use of unresolved identifier 'LONG_EXPRESSION'}}
+  _ = REF_TO_LONG_EXPRESSION // expected-error {{use of unresolved identifier 'REF_TO_LONG_EXPRESSION'}}
+}
@@ -0,0 +1,23 @@
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse %s -enable-named-lazy-member-loading
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -emit-sil %s -enable-named-lazy-member-loading | %FileCheck %s
+
+// REQUIRES: objc_interop
+
+import Foundation
+
+// CHECK-LABEL: sil hidden @{{.*}}useArray
+func useArray(_ a: NSArray, _ d: DummyClass) -> Int {
+  _ = d.nsstringProperty
+  // CHECK: class_method {{.*}} #NSArray.index
+  return a.index(of: d)
+}
+
+func useString(_ s: NSString) {
+  s.onlyOnNSString()
+  s.notBridgedMethod()
+}
+
+func useDictionary(_ d: NSDictionary) -> Int {
+  _ = d.keyEnumerator()
+  return d.count
+}
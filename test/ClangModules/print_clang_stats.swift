@@ -0,0 +1,12 @@
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -parse %s -print-clang-stats 2>&1 | %FileCheck %s
+
+// REQUIRES: objc_interop
+
+import Foundation
+
+func useString(_ s: NSString) {
+  s.onlyOnNSString()
+}
+
+// CHECK: *** Swift name import statistics:
+// CHECK-NEXT: {{[1-9][0-9]*}} name lookups, {{[0-9]+}} cache hits ({{[0-9]+}}%)
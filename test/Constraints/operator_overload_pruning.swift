@@ -0,0 +1,28 @@
+// RUN: %target-parse-verify-swift
+
+// Overloads of an operator that can't accept the (already known) argument
+// types are skipped without being tried; make sure the right overload is
+// still picked, and that mismatches are still diagnosed.
+
+struct Meters { var value: Double }
+struct Feet { var value: Double }
+
+func + (lhs: Meters, rhs: Meters) -> Meters { return Meters(value: lhs.value + rhs.value) }
+func + (lhs: Feet, rhs: Feet) -> Feet { return Feet(value: lhs.value + rhs.value) }
+
+func sum(_ a: Meters, _ b: Meters, _ c: Meters, _ d: Meters) -> Meters {
+  return a + b + c + d
+}
+
+func convert(_ f: Feet) -> Meters { return Meters(value: f.value * 0.3048) }
+
+func mixed(_ m: Meters, _ f: Feet) {
+  let _: Meters = m + convert(f)
+  let _: Feet = f + f
+
+  let d1: Double = 1, d2: Double = 2
+  let _: Double = d1 * d2 + d1 / d2 - d1
+
+  _ = m + f // expected-error {{binary operator '+' cannot be applied to operands of type 'Meters' and 'Feet'}}
+  // expected-note @-1 {{overloads for '+' exist with these partially matching parameter lists:}}
+}
@@ -0,0 +1,16 @@
+// RUN: %target-swift-frontend -parse -debug-constraints-profile-line 14 %s 2>&1 | %FileCheck %s
+
+// CHECK: "location": "{{.*}}solver_profile.swift:14:9"
+// CHECK: "statistics": {
+// CHECK: "NumDisjunctions": {{[1-9][0-9]*}}
+// CHECK: "scopes-pushed": [[SCOPES:[0-9]+]]
+// CHECK-NEXT: "scopes-popped": [[SCOPES]]
+// CHECK: "type-variables": [
+// CHECK: "binding-attempts": {{[1-9][0-9]*}}
+// CHECK: "disjunctions": [
+// CHECK: "depth": {{[0-9]+}}
+// CHECK-NOT: "location"
+
+let x = 1 + 2.0 * 3
+
+let y = 1 + 2
@@ -0,0 +1,27 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -gdwarf-types -o - | %FileCheck %s
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -gdwarf-types -debug-info-external-type-decls -o - | %FileCheck %s --check-prefix=DECLS
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -g -debug-time-compilation -o /dev/null 2>&1 | %FileCheck %s --check-prefix=TIME
+
+// -- Types from other modules get their members by default...
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Int64", {{.*}}elements: ![[INT_MEMBERS:[0-9]+]],{{.*}}identifier: "_TtVs5Int64"
+// CHECK-DAG: ![[INT_MEMBERS]] = !{![[INT_VALUE:[0-9]+]]}
+// CHECK-DAG: ![[INT_VALUE]] = !DIDerivedType(tag: DW_TAG_member, name: "_value"
+
+// -- ...but only a declaration with -debug-info-external-type-decls.
+// DECLS-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Int64", {{.*}}elements: ![[EMPTY:[0-9]+]],{{.*}}identifier: "_TtVs5Int64"
+// DECLS-DAG: ![[EMPTY]] = !{}
+
+// -- Types of the current module are always complete.
+// DECLS-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Point", {{.*}}elements: ![[POINT_MEMBERS:[0-9]+]],{{.*}}identifier: "_TtV20external_type_decls5Point"
+// DECLS-DAG: ![[POINT_MEMBERS]] = !{![[X:[0-9]+]], ![[Y:[0-9]+]]}
+// DECLS-DAG: ![[X]] = !DIDerivedType(tag: DW_TAG_member, name: "x"
+// DECLS-DAG: ![[Y]] = !DIDerivedType(tag: DW_TAG_member, name: "y"
+public struct Point {
+  var x: Int64
+  var y: Int64
+}
+
+public let origin = Point(x: 0, y: 0)
+
+// -- The time spent creating debug info is reported with the other timers.
+// TIME: IRGen debug info
@@ -9,6 +9,12 @@ RUN: sed -ne '/--->/s/^.*---> *//p' < %S/Inputs/manglings.txt > %t.check
 RUN: swift-demangle < %t.input > %t.output
 RUN: diff %t.check %t.output
 
+RUN: swift-demangle -input-file=%t.input -j 3 > %t.output.batch
+RUN: diff %t.check %t.output.batch
+RUN: cat %t.input %t.input | swift-demangle -input-file=- > %t.output.repeated
+RUN: cat %t.check %t.check > %t.check.repeated
+RUN: diff %t.check.repeated %t.output.repeated
+
 ; RUN: swift-demangle __TtSi | %FileCheck %s -check-prefix=DOUBLE
 ; DOUBLE: _TtSi ---> Swift.Int
 
@@ -0,0 +1,31 @@
+// main | other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: %S/Inputs/touch.py 443865900 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -enable-adaptive-job-scheduling 2>&1 | %FileCheck -check-prefix=CHECK-FIRST %s
+// RUN: %FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST-DAG: Handled main.swift
+// CHECK-FIRST-DAG: Handled other.swift
+
+// CHECK-RECORD: inputs:
+// CHECK-RECORD: durations:
+// CHECK-RECORD-DAG: "./main.swift": [{{[0-9]+}}, {{[0-9]+}}]
+// CHECK-RECORD-DAG: "./other.swift": [{{[0-9]+}}, {{[0-9]+}}]
+
+
+// Jobs that took longer last time are started first.
+
+// RUN: echo '{version: "'$(%swiftc_driver_plain -version | head -n1)'", inputs: {"./main.swift": !dirty [443865900, 0], "./other.swift": !dirty [443865900, 0]}, durations: {"./main.swift": [0, 1000], "./other.swift": [5, 0]}, build_time: [443865901, 0]}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -enable-adaptive-job-scheduling 2>&1 | %FileCheck -check-prefix=CHECK-LONGEST-FIRST %s
+
+// CHECK-LONGEST-FIRST: Handled other.swift
+// CHECK-LONGEST-FIRST: Handled main.swift
+
+// RUN: echo '{version: "'$(%swiftc_driver_plain -version | head -n1)'", inputs: {"./main.swift": !dirty [443865900, 0], "./other.swift": !dirty [443865900, 0]}, durations: {"./main.swift": [0, 1000], "./other.swift": [5, 0]}, build_time: [443865901, 0]}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 2>&1 | %FileCheck -check-prefix=CHECK-INPUT-ORDER %s
+
+// CHECK-INPUT-ORDER: Handled main.swift
+// CHECK-INPUT-ORDER: Handled other.swift
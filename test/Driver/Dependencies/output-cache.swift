@@ -0,0 +1,62 @@
+/// other ==> main
+/// "./main1-external" ==> main
+/// "./main2-external" ==> main
+/// "./other1-external" ==> other
+/// "./other2-external" ==> other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way-external/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache 2>&1 | %FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST-DAG: Handled main.swift
+// CHECK-FIRST-DAG: Handled other.swift
+
+
+// Rebuilding from scratch takes every output from the cache.
+
+// RUN: rm -f %t/*.o %t/*.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache 2>&1 | %FileCheck -check-prefix=CHECK-RESTORED %s
+// RUN: ls %t/main.o %t/other.o
+// RUN: %FileCheck -check-prefix=CHECK-MAIN-DEPS %s < %t/main.swiftdeps
+// RUN: %FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-RESTORED-NOT: Handled
+// CHECK-MAIN-DEPS: depends-external: ["./main1-external", "./main2-external"]
+// CHECK-RECORD-DAG: "./main.swift": [
+// CHECK-RECORD-DAG: "./other.swift": [
+
+
+// Parseable output reports restored jobs as skipped.
+
+// RUN: rm -f %t/*.o %t/*.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache -parseable-output 2>&1 | %FileCheck -check-prefix=CHECK-PARSEABLE %s
+
+// CHECK-PARSEABLE-NOT: "kind": "began"
+// CHECK-PARSEABLE: "kind": "skipped"
+// CHECK-PARSEABLE: "kind": "skipped"
+// CHECK-PARSEABLE-NOT: "kind": "began"
+
+
+// Changing an external dependency only misses the cache for the jobs that
+// depend on it.
+
+// RUN: echo "changed" >> %t/other1-external
+// RUN: rm -f %t/*.o %t/*.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache 2>&1 | %FileCheck -check-prefix=CHECK-EXTERNAL %s
+
+// CHECK-EXTERNAL-NOT: Handled main.swift
+// CHECK-EXTERNAL: Handled other.swift
+// CHECK-EXTERNAL-NOT: Handled main.swift
+
+
+// Changing a source file misses the cache for every job, since each one
+// reads every file in the module.
+
+// RUN: echo "# changed" >> %t/other.swift
+// RUN: rm -f %t/*.o %t/*.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache 2>&1 | %FileCheck -check-prefix=CHECK-SOURCE %s
+
+// CHECK-SOURCE-DAG: Handled main.swift
+// CHECK-SOURCE-DAG: Handled other.swift
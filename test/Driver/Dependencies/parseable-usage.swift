@@ -0,0 +1,43 @@
+// REQUIRES: OS=macosx || OS=linux-gnu
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -parseable-output 2>&1 | %FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST: {{^{$}}
+// CHECK-FIRST: "kind": "finished"
+// CHECK-FIRST: "name": "compile"
+// CHECK-FIRST: "exit-status": 0,
+// CHECK-FIRST-NEXT: "usage": {
+// CHECK-FIRST-NEXT: "wall-time-us": {{[0-9]+}},
+// CHECK-FIRST-NEXT: "user-time-us": {{[0-9]+}},
+// CHECK-FIRST-NEXT: "system-time-us": {{[0-9]+}},
+// CHECK-FIRST-NEXT: "max-rss-bytes": {{[1-9][0-9]*}}
+// CHECK-FIRST: {{^}$}}
+
+// CHECK-FIRST: {{^{$}}
+// CHECK-FIRST: "kind": "finished"
+// CHECK-FIRST: "usage": {
+// CHECK-FIRST: {{^}$}}
+
+// CHECK-FIRST: {{^{$}}
+// CHECK-FIRST-NEXT: "kind": "summary",
+// CHECK-FIRST-NEXT: "name": "compilation",
+// CHECK-FIRST-NEXT: "job-count": 2,
+// CHECK-FIRST-NEXT: "usage": {
+// CHECK-FIRST-NEXT: "wall-time-us": {{[1-9][0-9]*}},
+// CHECK-FIRST-NEXT: "user-time-us": {{[0-9]+}},
+// CHECK-FIRST-NEXT: "system-time-us": {{[0-9]+}},
+// CHECK-FIRST-NEXT: "max-rss-bytes": {{[1-9][0-9]*}}
+// CHECK-FIRST-NEXT: }
+// CHECK-FIRST-NEXT: {{^}$}}
+
+
+// Nothing runs, so there's no summary.
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j2 -parseable-output 2>&1 | %FileCheck -check-prefix=CHECK-SECOND %s
+
+// CHECK-SECOND: "kind": "skipped"
+// CHECK-SECOND-NOT: "usage"
+// CHECK-SECOND-NOT: "kind": "summary"
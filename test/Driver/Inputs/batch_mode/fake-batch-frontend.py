@@ -0,0 +1,42 @@
+#!/usr/bin/env python
+# fake-batch-frontend.py - Fake build to test driver-produced batches.
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See http://swift.org/LICENSE.txt for license information
+# See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+#
+# ----------------------------------------------------------------------------
+#
+# Prints the primary files handled by each frontend process, reading the
+# per-job arguments from -batch-invocation files when present.
+#
+# ----------------------------------------------------------------------------
+
+from __future__ import print_function
+
+import os
+import sys
+
+assert sys.argv[1] == '-frontend'
+
+
+def primary_file(args):
+    return os.path.basename(args[args.index('-primary-file') + 1])
+
+
+if '-batch-invocation' in sys.argv:
+    primaries = []
+    for i, arg in enumerate(sys.argv):
+        if arg != '-batch-invocation':
+            continue
+        with open(sys.argv[i + 1], 'r') as f:
+            args = f.read().splitlines()
+        assert args[0] != '-frontend'
+        primaries.append(primary_file(args))
+    print("Batch:", " ".join(primaries))
+else:
+    print("Single:", primary_file(sys.argv))
@@ -0,0 +1,26 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: touch %t/a.swift %t/b.swift %t/c.swift %t/d.swift
+
+// RUN: (cd %t && %swiftc_driver_plain -driver-use-frontend-path %S/Inputs/batch_mode/fake-batch-frontend.py -c ./a.swift ./b.swift ./c.swift ./d.swift -module-name main -enable-batch-mode -j1 2>&1 | %FileCheck -check-prefix=CHECK-ONE %s)
+// CHECK-ONE-NOT: Single:
+// CHECK-ONE: Batch: a.swift b.swift c.swift d.swift
+// CHECK-ONE-NOT: Batch:
+
+// RUN: (cd %t && %swiftc_driver_plain -driver-use-frontend-path %S/Inputs/batch_mode/fake-batch-frontend.py -c ./a.swift ./b.swift ./c.swift ./d.swift -module-name main -enable-batch-mode -j2 2>&1 | %FileCheck -check-prefix=CHECK-TWO %s)
+// CHECK-TWO-NOT: Single:
+// CHECK-TWO-DAG: Batch: a.swift b.swift
+// CHECK-TWO-DAG: Batch: c.swift d.swift
+
+// RUN: (cd %t && %swiftc_driver_plain -driver-use-frontend-path %S/Inputs/batch_mode/fake-batch-frontend.py -c ./a.swift ./b.swift ./c.swift ./d.swift -module-name main -enable-batch-mode -j8 2>&1 | %FileCheck -check-prefix=CHECK-MANY %s)
+// CHECK-MANY-NOT: Batch:
+// CHECK-MANY-DAG: Single: a.swift
+// CHECK-MANY-DAG: Single: b.swift
+// CHECK-MANY-DAG: Single: c.swift
+// CHECK-MANY-DAG: Single: d.swift
+
+// RUN: (cd %t && %swiftc_driver_plain -driver-use-frontend-path %S/Inputs/batch_mode/fake-batch-frontend.py -c ./a.swift ./b.swift ./c.swift ./d.swift -module-name main -enable-batch-mode -disable-batch-mode -j1 2>&1 | %FileCheck -check-prefix=CHECK-DISABLED %s)
+// CHECK-DISABLED-NOT: Batch:
+// CHECK-DISABLED: Single: a.swift
+// CHECK-DISABLED: Single: b.swift
+// CHECK-DISABLED: Single: c.swift
+// CHECK-DISABLED: Single: d.swift
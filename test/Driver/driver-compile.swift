@@ -56,6 +56,14 @@
 // RUN: %FileCheck %s < %t.embed-inc.txt
 // RUN: %FileCheck -check-prefix NO-REFERENCE-DEPENDENCIES %s < %t.embed-inc.txt
 
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -incremental -enable-binary-swiftdeps %s 2>&1 > %t.binary-inc.txt
+// RUN: %FileCheck %s < %t.binary-inc.txt
+// RUN: %FileCheck -check-prefix BINARY-REFERENCE-DEPENDENCIES %s < %t.binary-inc.txt
+
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -incremental -enable-fine-grained-dependencies %s 2>&1 > %t.fine-inc.txt
+// RUN: %FileCheck %s < %t.fine-inc.txt
+// RUN: %FileCheck -check-prefix FINE-GRAINED-DEPENDENCIES %s < %t.fine-inc.txt
+
 // REQUIRES: X86
 
 
@@ -127,3 +135,9 @@
 
 // NO-REFERENCE-DEPENDENCIES: bin/swift
 // NO-REFERENCE-DEPENDENCIES-NOT: -emit-reference-dependencies
+
+// BINARY-REFERENCE-DEPENDENCIES: bin/swift
+// BINARY-REFERENCE-DEPENDENCIES: -emit-reference-dependencies-path {{(.*/)?driver-compile[^ /]+}}.swiftdeps -emit-binary-reference-dependencies
+
+// FINE-GRAINED-DEPENDENCIES: bin/swift
+// FINE-GRAINED-DEPENDENCIES: -emit-reference-dependencies-path {{(.*/)?driver-compile[^ /]+}}.swiftdeps -emit-reference-dependency-fingerprints
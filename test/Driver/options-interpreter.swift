@@ -13,6 +13,10 @@
 // RUN: %swift_driver -### -parse-stdlib | %FileCheck -check-prefix PARSE_STDLIB %s
 // PARSE_STDLIB: -parse-stdlib
 
+// RUN: %swift_driver -### -jit-cache-path /CACHE %s | %FileCheck -check-prefix JIT_CACHE %s
+// JIT_CACHE: -interpret
+// JIT_CACHE-SAME: -jit-cache-path /CACHE
+
 
 // RUN: %swift_driver -### -target x86_64-apple-macosx10.9 -resource-dir /RSRC/ %s | %FileCheck -check-prefix=CHECK-RESOURCE-DIR-ONLY %s
 // CHECK-RESOURCE-DIR-ONLY: # DYLD_LIBRARY_PATH=/RSRC/macosx{{$}}
@@ -0,0 +1,14 @@
+// REQUIRES: OS=macosx || OS=linux-gnu
+
+// RUN: %swiftc_driver -driver-print-jobs -c -emit-module %s %S/../Inputs/empty.swift -module-name main -enable-pipelined-merge-modules 2>&1 | %FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -c -emit-module %s %S/../Inputs/empty.swift -module-name main 2>&1 | %FileCheck -check-prefix=DISABLED %s
+
+// CHECK: bin/swift{{c?}} -frontend
+// CHECK-SAME: -report-emitted-module
+// CHECK-NEXT: bin/swift{{c?}} -frontend
+// CHECK-SAME: -report-emitted-module
+// CHECK-NEXT: bin/swift{{c?}} -frontend
+// CHECK-SAME: -emit-module
+// CHECK-NOT: -report-emitted-module
+
+// DISABLED-NOT: -report-emitted-module
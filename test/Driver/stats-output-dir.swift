@@ -0,0 +1,32 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: %swiftc_driver -driver-print-jobs -c %s %S/../Inputs/empty.swift -module-name main -stats-output-dir %t/stats 2>&1 | %FileCheck -check-prefix=CHECK-JOBS %s
+
+// CHECK-JOBS: bin/swift{{c?}} -frontend
+// CHECK-JOBS-SAME: -stats-output-dir {{[^ ]+}}/stats
+// CHECK-JOBS-NEXT: bin/swift{{c?}} -frontend
+// CHECK-JOBS-SAME: -stats-output-dir {{[^ ]+}}/stats
+
+
+// RUN: %swiftc_driver -parse %s %S/../Inputs/empty.swift -module-name main -stats-output-dir %t/stats
+// RUN: ls %t/stats | %FileCheck -check-prefix=CHECK-FILES %s
+// RUN: %FileCheck -check-prefix=CHECK-JSON %s < %t/stats/frontend-main-stats-output-dir-*.json
+// RUN: %{python} %utils/process-stats-dir.py aggregate %t/stats | %FileCheck %s
+
+// CHECK-FILES-DAG: frontend-main-empty-{{.*}}.json
+// CHECK-FILES-DAG: frontend-main-stats-output-dir-{{.*}}.json
+
+// CHECK-JSON: {
+// CHECK-JSON: "Process.PeakMemoryBytes": {{[1-9][0-9]*}},
+// CHECK-JSON: "Sema.NumStatesExplored": {{[0-9]+}},
+// CHECK-JSON: "time.Frontend.Parsing": {{[0-9]+\.[0-9]+}},
+// CHECK-JSON: }
+
+// CHECK: Build.NumFrontendJobs 2
+// CHECK: Serialization.NumDeserializedDecls {{[1-9][0-9]*}}
+// CHECK: time.Frontend.Type checking / Semantic analysis {{[0-9]+\.[0-9]+}}
+
+// RUN: %{python} %utils/process-stats-dir.py compare %t/stats %t/stats --skip-timers | %FileCheck -check-prefix=CHECK-COMPARE %s
+// CHECK-COMPARE: No differences above 0.0%
+
+let x = [1, 2, 3].map { $0 * 2 }
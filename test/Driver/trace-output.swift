@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: %swiftc_driver -driver-print-jobs -c %s %S/../Inputs/empty.swift -module-name main -trace-output %t/trace.json 2>&1 | %FileCheck -check-prefix=CHECK-JOBS %s
+
+// CHECK-JOBS: bin/swift{{c?}} -frontend
+// CHECK-JOBS-SAME: -trace-output {{[^ ]+}}.json
+// CHECK-JOBS-NEXT: bin/swift{{c?}} -frontend
+// CHECK-JOBS-SAME: -trace-output {{[^ ]+}}.json
+
+
+// RUN: %swiftc_driver -parse %s %S/../Inputs/empty.swift -module-name main -trace-output %t/trace.json
+// RUN: %FileCheck %s < %t/trace.json
+
+// CHECK: [
+// CHECK-DAG: {"name": "compile", "cat": "driver", "ph": "X", "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "pid": [[PID:[0-9]+]], "tid": 0, "args": {"detail": "{{.*}}trace-output.swift"}}
+// CHECK-DAG: {"name": "Parsing", "cat": "frontend", "ph": "X", "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "pid": [[PID]], "tid": 1}
+// CHECK-DAG: {"name": "compile", "cat": "driver", {{.*}}"args": {"detail": "{{.*}}empty.swift"}}
+// CHECK-DAG: {"name": "compilation", "cat": "driver", "ph": "X", "ts": {{[0-9]+}}, "dur": {{[0-9]+}}, "pid": {{[0-9]+}}, "tid": 1}
+// CHECK: ]
+
+
+// The frontend writes its own trace when run directly.
+
+// RUN: %target-swift-frontend -emit-sil -O %s -trace-output %t/frontend.json -o /dev/null
+// RUN: %FileCheck -check-prefix=CHECK-FRONTEND %s < %t/frontend.json
+
+// CHECK-FRONTEND: [
+// CHECK-FRONTEND-DAG: {"name": "Parsing", "cat": "frontend"
+// CHECK-FRONTEND-DAG: {"name": "Type checking / Semantic analysis", "cat": "frontend"
+// CHECK-FRONTEND-DAG: {"name": "SILGen", "cat": "frontend"
+// CHECK-FRONTEND-DAG: {"name": "SIL optimization", "cat": "frontend"
+// CHECK-FRONTEND-DAG: "cat": "sil-pass"
+// CHECK-FRONTEND: ]
+
+public func f() -> Int {
+  return 42
+}
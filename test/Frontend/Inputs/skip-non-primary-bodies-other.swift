@@ -0,0 +1,9 @@
+func otherFunction() -> Int {
+  let x = = 1
+  return x
+}
+
+@_transparent
+func otherTransparent() -> Int {
+  return 2
+}
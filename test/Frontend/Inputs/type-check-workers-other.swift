@@ -0,0 +1,5 @@
+func otherInt() -> Int { return 0 }
+
+func other() {
+  let _: Int = "not an int"
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '-parse' > %t/first.txt
+// RUN: echo '-primary-file' >> %t/first.txt
+// RUN: echo '%s' >> %t/first.txt
+// RUN: echo '%S/Inputs/batch-invocation-other.swift' >> %t/first.txt
+// RUN: echo '-parse' > %t/second.txt
+// RUN: echo '%s' >> %t/second.txt
+// RUN: echo '-primary-file' >> %t/second.txt
+// RUN: echo '%S/Inputs/batch-invocation-other.swift' >> %t/second.txt
+// RUN: not %target-swift-frontend -batch-invocation %t/first.txt -batch-invocation %t/second.txt 2>&1 | %FileCheck %s
+
+// RUN: not %target-swift-frontend -batch-invocation %t/nonexistent.txt 2>&1 | %FileCheck -check-prefix=CHECK-BADFILE %s
+// CHECK-BADFILE: error: cannot open file
+
+// Each invocation only diagnoses its own primary file.
+// CHECK: batch-invocation.swift:[[@LINE+3]]:{{[0-9]+}}: error: cannot convert value of type 'Int' to specified type 'String'
+// CHECK: batch-invocation-other.swift:{{[0-9]+}}:{{[0-9]+}}: error: cannot convert value of type 'String' to specified type 'Int'
+func primary() {
+  let _: String = otherInt()
+}
@@ -0,0 +1,16 @@
+// RUN: not %swift_driver_plain -frontend -run-compile-server 2>&1 | %FileCheck -check-prefix=CHECK-MISSING %s
+// CHECK-MISSING: error: missing argument value for '-run-compile-server', expected 1 argument(s)
+
+// The server takes its jobs' arguments from the driver, not the command line.
+// RUN: not %swift_driver_plain -frontend -run-compile-server %t.sock -parse %s 2>&1 | %FileCheck -check-prefix=CHECK-EXTRA %s
+// CHECK-EXTRA: error: argument '-parse' is not allowed with '-run-compile-server'
+
+// RUN: not %swift_driver_plain -frontend -run-compile-server %t/%s/%s/%s/%s/%s.sock 2>&1 | %FileCheck -check-prefix=CHECK-LONG %s
+// CHECK-LONG: error: cannot run compile server on '{{.*}}' (socket path is too long)
+
+// Jobs fall back to running in their own processes if the server isn't there.
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swiftc_driver -c %s -o %t/main.o -compile-server %t/nonexistent.sock
+// RUN: test -f %t/main.o
+
+func f() {}
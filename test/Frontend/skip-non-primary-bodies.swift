@@ -0,0 +1,10 @@
+// RUN: %target-swift-frontend -emit-sil -primary-file %s %S/Inputs/skip-non-primary-bodies-other.swift | %FileCheck %s
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-bodies-other.swift -parse-non-primary-function-bodies 2>&1 | %FileCheck -check-prefix=CHECK-PARSED %s
+
+// The bodies of functions in other files are skipped unless asked for.
+// CHECK-PARSED: skip-non-primary-bodies-other.swift:2:{{[0-9]+}}: error:
+
+// CHECK-LABEL: sil hidden @{{.*}}3useFT_Si
+func use() -> Int {
+  return otherFunction() + otherTransparent()
+}
@@ -0,0 +1,16 @@
+// RUN: %target-swift-frontend -parse -print-startup-profile %s 2>&1 | %FileCheck %s
+// RUN: %target-swift-frontend -parse -lazy-clang-importer -print-startup-profile %s 2>&1 | %FileCheck %s
+
+// The Clang importer is only needed once something is imported from Clang.
+// RUN: %target-swift-frontend -parse -parse-stdlib -lazy-clang-importer %s
+
+// CHECK: Startup profile
+// CHECK: ms {{.*}}  ASTContext
+// CHECK-NEXT: ms {{.*}}  Swift module loaders
+// CHECK-NEXT: ms {{.*}}  Clang importer
+// CHECK-NEXT: ms {{.*}}  Input files
+// CHECK-NEXT: ms {{.*}}  Standard library
+// CHECK-NEXT: ms {{.*}}  Implicit imports
+// CHECK-NEXT: ms {{.*}}  Total
+
+let x = 1
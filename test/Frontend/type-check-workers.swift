@@ -0,0 +1,17 @@
+// REQUIRES: OS=macosx || OS=linux-gnu
+
+// RUN: not %target-swift-frontend -parse -type-check-workers 2 %s %S/Inputs/type-check-workers-other.swift 2>&1 | %FileCheck %s
+// RUN: not %target-swift-frontend -parse -type-check-workers 2 %S/Inputs/type-check-workers-other.swift %s 2>&1 | %FileCheck -check-prefix=CHECK-REVERSED %s
+
+// A single worker type-checks in-process, as usual.
+// RUN: not %target-swift-frontend -parse -type-check-workers 1 %s %S/Inputs/type-check-workers-other.swift 2>&1 | %FileCheck %s
+
+// Diagnostics are printed in input order, whichever worker finishes first.
+// CHECK: type-check-workers.swift:[[@LINE+6]]:{{[0-9]+}}: error: cannot convert value of type 'Int' to specified type 'String'
+// CHECK: type-check-workers-other.swift:{{[0-9]+}}:{{[0-9]+}}: error: cannot convert value of type 'String' to specified type 'Int'
+
+// CHECK-REVERSED: type-check-workers-other.swift:{{[0-9]+}}:{{[0-9]+}}: error: cannot convert value of type 'String' to specified type 'Int'
+// CHECK-REVERSED: type-check-workers.swift:[[@LINE+2]]:{{[0-9]+}}: error: cannot convert value of type 'Int' to specified type 'String'
+func primary() {
+  let _: String = otherInt()
+}
@@ -0,0 +1,23 @@
+// REQUIRES: asserts
+// RUN: %target-swift-frontend -emit-sil %s -print-stats 2>&1 | %FileCheck %s
+
+// Functions with the same canonical generic signature share a single stored
+// archetype builder when lowering their types.
+// CHECK-DAG: ArchetypeBuilder {{.*}}# of requests for a stored archetype builder that already existed
+// CHECK-DAG: ArchetypeBuilder {{.*}}# of archetype builders created
+// CHECK-DAG: ArchetypeBuilder {{.*}}# of generic environments created from archetype builders
+
+func first<C : Collection>(_ c: C) -> C.Iterator.Element? {
+  var iterator = c.makeIterator()
+  return iterator.next()
+}
+
+func count<S : Collection>(_ s: S) -> Int {
+  var n = 0
+  for _ in s { n += 1 }
+  return n
+}
+
+func isEmpty<T : Collection>(_ t: T) -> Bool {
+  return count(t) == 0 && first(t) == nil
+}
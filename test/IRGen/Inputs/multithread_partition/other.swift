@@ -0,0 +1,3 @@
+public func incrementThrice(_ x: Int) -> Int {
+  return apply({ $0 + 1 }, apply({ $0 + 1 }, apply({ $0 + 1 }, x)))
+}
@@ -0,0 +1,43 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -emit-ir %s > %t/opt.ll
+// RUN: %FileCheck %s --check-prefix=CHECK --check-prefix=CHECK-%target-ptrsize < %t/opt.ll
+// RUN: %FileCheck %s --check-prefix=NEGATIVE < %t/opt.ll
+// RUN: %target-swift-frontend -emit-ir %s | %FileCheck %s --check-prefix=ONONE
+
+// In optimized builds POD structs without extra inhabitants share the
+// runtime's value witness table of the same layout.
+
+// NEGATIVE-NOT: @_TWVV26known_value_witness_tables4Word =
+// NEGATIVE-NOT: @_TWVV26known_value_witness_tables4Pair =
+// NEGATIVE-NOT: @_TWVV26known_value_witness_tables5Empty =
+
+// ONONE-DAG: @_TWVV26known_value_witness_tables4Word =
+// ONONE-DAG: @_TWVV26known_value_witness_tables4Pair =
+
+public struct Word {
+  var x: Int
+}
+// CHECK-64-DAG: @_TMfV26known_value_witness_tables4Word = internal constant {{.*}} @_TWVBi64_
+// CHECK-32-DAG: @_TMfV26known_value_witness_tables4Word = internal constant {{.*}} @_TWVBi32_
+
+public struct Pair {
+  var x: Int64
+  var y: Int64
+}
+// CHECK-DAG: @_TMfV26known_value_witness_tables4Pair = internal constant {{.*}} @_TWVTBi64_Bi64__
+
+public struct Empty {}
+// CHECK-DAG: @_TMfV26known_value_witness_tables5Empty = internal constant {{.*}} @_TWVT_
+
+// Bool has extra inhabitants, which the runtime's tables don't provide.
+public struct Flag {
+  var b: Bool
+}
+// CHECK-DAG: @_TWVV26known_value_witness_tables4Flag =
+
+// Structs with references are not POD.
+public class C {}
+public struct Ref {
+  var c: C
+}
+// CHECK-DAG: @_TWVV26known_value_witness_tables3Ref =
@@ -0,0 +1,31 @@
+// RUN: %target-swift-frontend -emit-ir %s -module-name report -print-metadata-size-report -o /dev/null 2>&1 | %FileCheck %s
+
+// CHECK-LABEL: ===-- Metadata size report --===
+// CHECK-NEXT:  total   metadata        vwt     fields    wtables  type
+
+public protocol P {
+  func f()
+}
+
+// -- Only Big has a protocol witness table.
+// CHECK-DAG: {{^ *[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]*}}  Big{{$}}
+public struct Big : P {
+  var a: Int
+  var b: Int
+  var c: Int
+  public func f() {}
+}
+
+// CHECK-DAG: {{^ *[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]* +0}}  Small{{$}}
+public struct Small {
+  var x: Int
+}
+
+// -- Classes share the runtime's value witness table.
+// CHECK-DAG: {{^ *[1-9][0-9]* +[1-9][0-9]* +0 +[1-9][0-9]* +0}}  C{{$}}
+public class C {
+  var x: Int = 0
+}
+
+// CHECK:      total   metadata        vwt     fields    wtables  module
+// CHECK-NEXT: {{^ *[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]* +[1-9][0-9]*}}  report{{$}}
@@ -0,0 +1,40 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: %target-swift-frontend -emit-ir %s %S/Inputs/multithread_partition/other.swift -o %t/main.ll -o %t/other.ll -num-threads 2 -module-name test
+// RUN: %FileCheck --check-prefix=CHECK-MAINLL %s <%t/main.ll
+// RUN: %FileCheck --check-prefix=CHECK-OTHERLL %s <%t/other.ll
+
+// Test that in multi-threaded compilation, a function without a source file
+// is emitted into the file that references it most, rather than the one
+// that happens to reference it first.
+
+func apply<T>(_ f: (T) -> T, _ x: T) -> T {
+  return f(x)
+}
+
+public func incrementOnce(_ x: Int) -> Int {
+  return apply({ $0 + 1 }, x)
+}
+
+// Make this file larger than the other one, so that moving the thunk there
+// doesn't unbalance the files.
+public func describe(_ x: Int) -> String {
+  switch x {
+  case 0: return "zero"
+  case 1: return "one"
+  case 2: return "two"
+  case 3: return "three"
+  case 4: return "four"
+  case 5: return "five"
+  case 6: return "six"
+  case 7: return "seven"
+  default: return "many"
+  }
+}
+
+// The reabstraction thunk for the closures passed to apply().
+
+// CHECK-MAINLL: declare {{.*}} @_TTRXFo_dSi_dSi_XFo_iSi_iSi_
+// CHECK-MAINLL-NOT: define {{.*}} @_TTRXFo_dSi_dSi_XFo_iSi_iSi_
+
+// CHECK-OTHERLL: define {{.*}} @_TTRXFo_dSi_dSi_XFo_iSi_iSi_
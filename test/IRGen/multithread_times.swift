@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir %s %S/../Inputs/empty.swift -o %t/main.ll -o %t/empty.ll -num-threads 2 -module-name test -debug-time-parallel-irgen 2>&1 | %FileCheck %s
+
+// Which thread compiles which module depends on scheduling, so only check
+// that each module is reported once.
+
+// CHECK: ===-- Parallel IRGen times --===
+// CHECK-NEXT: IRGen: {{[0-9]+}}.{{[0-9]+}}s
+// CHECK-NEXT: types converted in more than one module: {{[0-9]+}}, {{[0-9]+}} redundant conversions
+// CHECK-DAG: thread 0: {{[0-9]+}}.{{[0-9]+}}s LLVM, {{[0-2]}} modules
+// CHECK-DAG: thread 1: {{[0-9]+}}.{{[0-9]+}}s LLVM, {{[0-2]}} modules
+// CHECK-DAG: {{.*}}main.ll: {{[0-9]+}}.{{[0-9]+}}s, {{[1-9][0-9]*}} instructions
+// CHECK-DAG: {{.*}}empty.ll: {{[0-9]+}}.{{[0-9]+}}s, {{[0-9]+}} instructions
+// CHECK: longest thread: {{[01]}}, {{[0-9]+}}.{{[0-9]+}}s
+
+public func compute(_ x: Int) -> Int {
+  return x &* 3 &+ 1
+}
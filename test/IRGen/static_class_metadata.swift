@@ -0,0 +1,44 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -disable-objc-interop -emit-static-class-metadata -emit-ir %s > %t/static.ll
+// RUN: %FileCheck %s < %t/static.ll
+// RUN: %FileCheck %s --check-prefix=ACCESSOR < %t/static.ll
+// RUN: %target-swift-frontend -disable-objc-interop -emit-ir %s | %FileCheck %s --check-prefix=DEFAULT
+
+// -- Metadata of classes with known layout is a filled-in constant.
+
+// CHECK: @_TMfC21static_class_metadata4Base = internal constant
+// DEFAULT: @_TMfC21static_class_metadata4Base = internal global
+public class Base {
+  var x: Int = 0
+}
+
+// CHECK: @_TMfC21static_class_metadata7Derived = internal constant {{.*}}static_class_metadata4Base
+public class Derived : Base {
+  var y: Int = 0
+}
+
+// -- Metadata of generic classes is still instantiated at runtime.
+
+// CHECK: @_TMPC21static_class_metadata7Generic = {{.*}}global
+public class Generic<T> {
+  var t: T
+  init(t: T) { self.t = t }
+}
+
+// -- The metadata is referenced directly, without calling the accessor.
+
+// CHECK-LABEL: define{{( protected)?}} {{.*}} @_TF21static_class_metadata8makeBaseFT_CS_4Base()
+// CHECK-NOT:     call %swift.type* @_TMaC21static_class_metadata4Base()
+// CHECK:         ret
+// DEFAULT-LABEL: define{{( protected)?}} {{.*}} @_TF21static_class_metadata8makeBaseFT_CS_4Base()
+// DEFAULT:         call %swift.type* @_TMaC21static_class_metadata4Base()
+public func makeBase() -> Base {
+  return Base()
+}
+
+// -- The accessor doesn't need a cache or swift_once.
+
+// ACCESSOR-LABEL: define{{( protected)?}} %swift.type* @_TMaC21static_class_metadata4Base()
+// ACCESSOR-NOT:     @_TMLC21static_class_metadata4Base
+// ACCESSOR-NOT:     swift_once
+// ACCESSOR:         ret %swift.type*
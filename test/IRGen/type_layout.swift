@@ -32,9 +32,10 @@ struct TypeLayoutTest<T> {
   // -- Single-element struct, shares layout of its field (Builtin.Int64)
   // CHECK:       store i8** getelementptr inbounds (i8*, i8** @_TWVBi64_, i32 17)
   var c: SSing
-  // -- Multi-element structs use open-coded layouts
-  // CHECK:    store i8** getelementptr inbounds ([3 x i8*], [3 x i8*]* @type_layout_16_8_0_pod, i32 0, i32 0)
+  // -- Multi-element POD structs of a few words share a runtime layout
+  // CHECK:       store i8** getelementptr inbounds (i8*, i8** @_TWVTBi64_Bi64__, i32 17)
   var d: SMult
+  // -- Other multi-element structs use open-coded layouts
   // CHECK-64:    store i8** getelementptr inbounds ([4 x i8*], [4 x i8*]* @type_layout_16_8_[[REF_XI:[0-9a-f]+]]_bt, i32 0, i32 0)
   // CHECK-32:    store i8** getelementptr inbounds ([4 x i8*], [4 x i8*]* @type_layout_8_4_[[REF_XI:[0-9a-f]+]]_bt, i32 0, i32 0)
   var e: SMult2
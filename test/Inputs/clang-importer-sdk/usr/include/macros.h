@@ -61,3 +61,6 @@
 
 #define RECURSION RECURSION
 #define REF_TO_RECURSION RECURSION
+
+#define LONG_EXPRESSION ((1 << 0) | (1 << 1) | (1 << 2) | (1 << 3))
+#define REF_TO_LONG_EXPRESSION LONG_EXPRESSION
@@ -19,3 +19,10 @@ var someval = 0xFFeeFF0033
 print("value = \(someval)")
 
 
+// CHECK: café 1 x
+var cafe = "caf\u{e9}"
+print("\(cafe) \(1) x")
+
+// CHECK: [] 42
+var empty = ""
+print("[\(empty)]\(empty) \(42)")
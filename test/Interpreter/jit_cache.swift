@@ -0,0 +1,40 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-jit-run -jit-cache-path %t/cache %s | %FileCheck %s
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+// RUN: %target-jit-run -jit-cache-path %t/cache %s | %FileCheck %s
+// REQUIRES: swift_interpreter
+
+// The second run loads the object code of the first run from the cache.
+// CACHE: {{^[0-9a-f]+\.o$}}
+
+protocol Greeter {
+  func greet() -> String
+}
+
+struct English : Greeter {
+  func greet() -> String { return "hello" }
+}
+
+// The cast needs the conformances that the static constructors register.
+func greet(_ x: Any) -> String {
+  if let greeter = x as? Greeter {
+    return greeter.greet()
+  }
+  return "no greeter"
+}
+
+class Counter {
+  var count = 0
+}
+
+// CHECK: hello
+print(greet(English()))
+// CHECK: no greeter
+print(greet(42))
+
+let counter = Counter()
+for _ in 0..<3 {
+  counter.count += 1
+}
+// CHECK: 3
+print(counter.count)
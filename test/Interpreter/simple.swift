@@ -15,3 +15,7 @@ if (true) {
   print("Hello \u{2603}\n", terminator: "")  // Hi Snowman!
   print("Hello ☃\n", terminator: "")
 }
+
+// Non-ASCII text longer than the chunk stdout transcodes through.
+// CHECK: {{^}}x{{(☃){100}}}y{{$}}
+print("x" + String(repeating: "☃", count: 100) + "y")
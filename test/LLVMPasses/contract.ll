@@ -572,6 +572,146 @@ bb3:
   ret %swift.bridge* %A
 }
 
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainNAcrossBlocks(%swift.refcounted* %A, %swift.refcounted* %B) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: tail call void @rt_swift_retain_n(%swift.refcounted* %B, i32 2)
+; CHECK-NEXT: br i1 undef
+; CHECK: bb1:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb3
+; CHECK: bb2:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %B)
+; CHECK-NEXT: br label %bb3
+; CHECK: bb3:
+; CHECK-NEXT: call void @user(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainNAcrossBlocks(%swift.refcounted* %A, %swift.refcounted* %B) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  tail call void @rt_swift_retain(%swift.refcounted* %B)
+  br i1 undef, label %bb1, label %bb2
+
+bb1:
+  call void @noread_user(%swift.refcounted* %A)
+  br label %bb3
+
+bb2:
+  call void @noread_user(%swift.refcounted* %B)
+  br label %bb3
+
+bb3:
+  tail call void @rt_swift_retain(%swift.refcounted* %B)
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  call void @user(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractReleaseNAcrossBlocks(%swift.refcounted* %A, %swift.refcounted* %B) {
+; CHECK: entry:
+; CHECK-NEXT: call void @user(%swift.refcounted* %A)
+; CHECK-NEXT: br i1 undef
+; CHECK: bb1:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: br label %bb3
+; CHECK: bb2:
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %B)
+; CHECK-NEXT: br label %bb3
+; CHECK: bb3:
+; CHECK-NEXT: tail call void @rt_swift_release_n(%swift.refcounted* %B, i32 2)
+; CHECK-NEXT: tail call void @rt_swift_release_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: ret void
+define void @swift_contractReleaseNAcrossBlocks(%swift.refcounted* %A, %swift.refcounted* %B) {
+entry:
+  call void @user(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %B)
+  br i1 undef, label %bb1, label %bb2
+
+bb1:
+  call void @noread_user(%swift.refcounted* %A)
+  br label %bb3
+
+bb2:
+  call void @noread_user(%swift.refcounted* %B)
+  br label %bb3
+
+bb3:
+  tail call void @rt_swift_release(%swift.refcounted* %B)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainReleaseNAlongChain(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain_n(%swift.refcounted* %A, i32 3)
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: br label %bb2
+; CHECK: bb2:
+; CHECK-NEXT: tail call void @rt_swift_release_n(%swift.refcounted* %A, i32 3)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainReleaseNAlongChain(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  br label %bb1
+
+bb1:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  br label %bb2
+
+bb2:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainNAcrossBlocksWithUnknown(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: br i1 undef
+; CHECK: bb3:
+; CHECK-NEXT: tail call void @rt_swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainNAcrossBlocksWithUnknown(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  br i1 undef, label %bb1, label %bb2
+
+bb1:
+  call void @user(%swift.refcounted* %A)
+  br label %bb3
+
+bb2:
+  br label %bb3
+
+bb3:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainNIntoLoop(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: br label %loop
+; CHECK: loop:
+; CHECK-NEXT: tail call void @rt_swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: br i1 undef
+define void @swift_contractRetainNIntoLoop(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  br label %loop
+
+loop:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  br i1 undef, label %loop, label %exit
+
+exit:
+  ret void
+}
+
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
 
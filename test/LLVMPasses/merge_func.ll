@@ -323,3 +323,66 @@ done:
 ; CHECK: ret i1
   ret i1 %result
 }
+
+; Merge specializations which differ in references to type metadata and
+; witness tables in instructions other than loads, stores and calls.
+
+@_TMfC4main1A = external global i8
+@_TMfC4main1B = external global i8
+@_TWPV4main1SS_1PS_ = external global i8*
+@_TWPV4main1TS_1PS_ = external global i8*
+
+; CHECK-LABEL: define i1 @check_A(i8** %object, i8*** %out, i32 %x)
+; CHECK: %1 = tail call i1 @check_A_merged(i8** %object, i8*** %out, i32 %x, i8* getelementptr inbounds (i8, i8* @_TMfC4main1A, i64 8), i8** @_TWPV4main1SS_1PS_)
+; CHECK: ret i1 %1
+define i1 @check_A(i8** %object, i8*** %out, i32 %x) {
+  %isa = load i8*, i8** %object, align 8
+  %is = icmp eq i8* %isa, getelementptr inbounds (i8, i8* @_TMfC4main1A, i64 8)
+  %sum = add i32 %x, %x
+  %sum2 = add i32 %sum, %x
+  %wt = select i1 %is, i8** @_TWPV4main1SS_1PS_, i8** null
+  store i8** %wt, i8*** %out, align 8
+  ret i1 %is
+}
+
+; CHECK-LABEL: define i1 @check_B(i8** %object, i8*** %out, i32 %x)
+; CHECK: %1 = tail call i1 @check_A_merged(i8** %object, i8*** %out, i32 %x, i8* getelementptr inbounds (i8, i8* @_TMfC4main1B, i64 8), i8** @_TWPV4main1TS_1PS_)
+; CHECK: ret i1 %1
+define i1 @check_B(i8** %object, i8*** %out, i32 %x) {
+  %isa = load i8*, i8** %object, align 8
+  %is = icmp eq i8* %isa, getelementptr inbounds (i8, i8* @_TMfC4main1B, i64 8)
+  %sum = add i32 %x, %x
+  %sum2 = add i32 %sum, %x
+  %wt = select i1 %is, i8** @_TWPV4main1TS_1PS_, i8** null
+  store i8** %wt, i8*** %out, align 8
+  ret i1 %is
+}
+
+; CHECK-LABEL: define internal i1 @check_A_merged(i8**, i8***, i32, i8*, i8**)
+; CHECK: %is = icmp eq i8* %isa, %3
+; CHECK: %wt = select i1 %is, i8** %4, i8** null
+; CHECK: ret
+
+; Other constants are only parameterized in loads, stores and calls.
+
+; CHECK-LABEL: define i1 @compare_g1(i32* %p, i32 %x)
+; CHECK-NOT: call
+; CHECK: icmp eq i32* %p, @g1
+define i1 @compare_g1(i32* %p, i32 %x) {
+  %sum = add i32 %x, %x
+  %sum2 = add i32 %sum, %x
+  %sum3 = add i32 %sum2, %x
+  %is = icmp eq i32* %p, @g1
+  ret i1 %is
+}
+
+; CHECK-LABEL: define i1 @compare_g2(i32* %p, i32 %x)
+; CHECK-NOT: call
+; CHECK: icmp eq i32* %p, @g2
+define i1 @compare_g2(i32* %p, i32 %x) {
+  %sum = add i32 %x, %x
+  %sum2 = add i32 %sum, %x
+  %sum3 = add i32 %sum2, %x
+  %is = icmp eq i32* %p, @g2
+  ret i1 %is
+}
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/../Serialization/Inputs/def_named_members.swift
+// RUN: %target-swift-frontend -parse -I %t %s -print-ast-memory-stats 2>&1 | %FileCheck %s
+// RUN: %target-swift-frontend -parse -I %t %s 2>&1 | %FileCheck -check-prefix=CHECK-DISABLED %s
+
+import def_named_members
+
+func usePoint(_ p: Point) -> Int {
+  let scaled = p.scaled(by: 2)
+  return [1, 2, 3].reduce(scaled.x, +)
+}
+
+// CHECK: AST memory statistics
+// CHECK: kind parsed deserialized imported total bytes count
+// CHECK: {{^Decl +[1-9][0-9]* +[1-9][0-9]* +[0-9]+ +[1-9][0-9]* +[1-9][0-9]*$}}
+// CHECK: {{^Expr +[1-9][0-9]* }}
+// CHECK: {{^Type +[0-9]+ +[1-9][0-9]* }}
+// CHECK: {{^total }}
+// CHECK: Permanent arena: {{[1-9][0-9]*}} bytes allocated
+// CHECK: Constraint solver arenas: {{[0-9]+}} bytes of AST nodes, peak arena {{[1-9][0-9]*}} bytes
+
+// CHECK-DISABLED-NOT: AST memory statistics
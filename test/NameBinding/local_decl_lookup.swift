@@ -0,0 +1,33 @@
+// RUN: %target-parse-verify-swift
+
+// Unqualified lookup from inside a local type has to search the enclosing
+// function and closure bodies for local declarations, which the parser
+// cannot resolve for it.
+
+let global = 0
+
+func outer(param: Int) -> Int {
+  let local = 1
+
+  if let bound = Optional(2) {
+    struct InIf {
+      func f() -> Int { return bound + local + param + global }
+    }
+    _ = InIf()
+  }
+
+  struct Local {
+    func f() -> Int { return local + param + global }
+    func g() -> Int { return notDeclaredAnywhere } // expected-error {{use of unresolved identifier 'notDeclaredAnywhere'}}
+  }
+
+  let closure = { (closureParam: Int) -> Int in
+    let inClosure = 3
+    struct InClosure {
+      func f() -> Int { return inClosure + closureParam + local + global }
+    }
+    return InClosure().f()
+  }
+
+  return Local().f() + closure(4)
+}
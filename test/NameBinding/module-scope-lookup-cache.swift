@@ -0,0 +1,16 @@
+// REQUIRES: asserts
+// RUN: %target-swift-frontend -parse %s -print-stats 2>&1 | %FileCheck %s
+
+// Repeated references to the same global names are looked up once.
+// CHECK: Name lookup {{.*}}# of unqualified lookups at module scope answered from the cache
+// CHECK: Name lookup {{.*}}# of unqualified lookups at module scope not in the cache
+
+let limit = 10
+
+func f(_ x: Int) -> Int {
+  return min(x, limit) + min(limit, x) + max(x, limit)
+}
+
+func g(_ x: Int) -> Int {
+  return min(f(x), limit) + f(limit)
+}
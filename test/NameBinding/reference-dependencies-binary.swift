@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift %S/Inputs/reference-dependencies-helper.swift -emit-reference-dependencies-path %t/main.swiftdeps -emit-binary-reference-dependencies
+// RUN: head -c 4 %t/main.swiftdeps | %FileCheck %s
+// RUN: grep -q useWrapper %t/main.swiftdeps
+
+// CHECK: SWDB
+
+struct BinaryWrapper {
+  var value: Int
+}
+
+func useWrapper(_ w: BinaryWrapper) -> BinaryWrapper {
+  return BinaryWrapper(value: w.value + 1)
+}
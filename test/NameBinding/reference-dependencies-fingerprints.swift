@@ -0,0 +1,51 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -emit-reference-dependencies-path %t/before.swiftdeps -emit-reference-dependency-fingerprints
+// RUN: %FileCheck %s < %t/before.swiftdeps
+
+// Changing a function body doesn't change any fingerprints.
+// RUN: sed -e 's/return 1/return 2/' %s > %t/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -emit-reference-dependencies-path %t/body.swiftdeps -emit-reference-dependency-fingerprints
+// RUN: grep -v interface-hash %t/before.swiftdeps > %t/before.filtered
+// RUN: grep -v interface-hash %t/body.swiftdeps > %t/body.filtered
+// RUN: diff %t/before.filtered %t/body.filtered
+
+// Changing a signature only changes the fingerprints that cover it.
+// RUN: sed -e 's/func changed() -> Int/func changed() -> Int?/' %s > %t/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -emit-reference-dependencies-path %t/signature.swiftdeps -emit-reference-dependency-fingerprints
+// RUN: grep '"unchanged"' %t/before.swiftdeps > %t/before.unchanged
+// RUN: grep '"unchanged"' %t/signature.swiftdeps > %t/signature.unchanged
+// RUN: diff %t/before.unchanged %t/signature.unchanged
+// RUN: grep '"changed"' %t/before.swiftdeps > %t/before.changed
+// RUN: grep '"changed"' %t/signature.swiftdeps > %t/signature.changed
+// RUN: not diff %t/before.changed %t/signature.changed
+
+// Without the option, nothing gets a fingerprint.
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -emit-reference-dependencies-path - | %FileCheck -check-prefix=NO-FINGERPRINTS %s
+
+// CHECK-LABEL: {{^provides-top-level:$}}
+// CHECK-DAG: - ["Fingerprinted", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["topLevel", "{{[0-9a-f]+}}"]
+// CHECK-LABEL: {{^provides-nominal:$}}
+// CHECK-DAG: - ["{{.+}}13Fingerprinted", "{{[0-9a-f]+}}"]
+// CHECK-LABEL: {{^provides-member:$}}
+// CHECK-DAG: - ["{{.+}}13Fingerprinted", "", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["{{.+}}13Fingerprinted", "changed", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["{{.+}}13Fingerprinted", "unchanged", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["{{.+}}13Fingerprinted", "fromExtension", "{{[0-9a-f]+}}"]
+// CHECK-LABEL: {{^depends-top-level:$}}
+
+// NO-FINGERPRINTS-LABEL: {{^provides-top-level:$}}
+// NO-FINGERPRINTS-NOT: "{{[0-9a-f]+}}"]
+// NO-FINGERPRINTS: {{^interface-hash:}}
+
+struct Fingerprinted {
+  func changed() -> Int { return 1 }
+  func unchanged() -> Int { return 1 }
+}
+
+extension Fingerprinted {
+  func fromExtension() {}
+}
+
+func topLevel() -> Int { return 1 }
@@ -24,9 +24,9 @@
 // CHECK-NOT: AppKit;
 // CHECK-NOT: Properties;
 // CHECK-NOT: Swift;
-// CHECK-LABEL: @import Foundation;
+// CHECK-LABEL: @import CoreFoundation;
 // CHECK-NEXT: @import CoreGraphics;
-// CHECK-NEXT: @import CoreFoundation;
+// CHECK-NEXT: @import Foundation;
 // CHECK-NEXT: @import objc_generics;
 // CHECK-NOT: AppKit;
 // CHECK-NOT: Swift;
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_DEBUG_ALLOCATION_PROFILE=%t/alloc.pb SWIFT_DEBUG_ALLOCATION_PROFILE_RATE=1 %t/a.out | %FileCheck %s
+// RUN: %{python} -c 'import sys; data = open(sys.argv[1], "rb").read(); print(b"alloc_space" in data, b"ProfiledObject" in data)' %t/alloc.pb | %FileCheck %s --check-prefix=PROFILE
+
+// REQUIRES: executable_test
+// REQUIRES: OS=linux-gnu
+
+final class ProfiledObject {
+  var value: Int
+  init(_ value: Int) { self.value = value }
+}
+
+var objects: [ProfiledObject] = []
+for i in 0..<100 {
+  objects.append(ProfiledObject(i))
+}
+print(objects.count)
+
+// CHECK: 100
+// PROFILE: True True
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: %target-run %t/a.out 2>&1 | %FileCheck %s
+
+// REQUIRES: executable_test
+// REQUIRES: runtime-function-counters
+
+final class Counted {}
+
+protocol P {}
+struct S : P {}
+
+func isP(_ x: Any) -> Bool { return x is P }
+
+var objects: [Counted] = []
+for _ in 0..<10 {
+  objects.append(Counted())
+}
+_ = isP(S())
+
+// CHECK: runtime function {{ *}}calls
+// CHECK-DAG: {{^}}swift_allocObject {{ *}}[1-9]
+// CHECK-DAG: {{^}}swift_retain {{ *}}[1-9]
+// CHECK-DAG: {{^}}swift_release {{ *}}[1-9]
+// CHECK-DAG: {{^}}swift_dynamicCast {{ *}}[1-9]
+// CHECK: swift_allocObject call sites:
+// CHECK: {{^ *}}10 {{.*}} {{.*}}Counted
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_DEBUG_RUNTIME_STATS=1 %t/a.out 2>&1 | %FileCheck %s
+// RUN: %t/a.out 2>&1 | %FileCheck %s --check-prefix=DISABLED
+
+// REQUIRES: executable_test
+// UNSUPPORTED: OS=watchos
+// UNSUPPORTED: OS=ios
+// UNSUPPORTED: OS=tvos
+
+protocol P {}
+struct S : P {}
+struct Box<T> { var value: T }
+
+func isP(_ x: Any) -> Bool { return x is P }
+
+print(isP(S()))
+print(isP(1))
+print(Box(value: (1, "two")))
+
+// CHECK: cache {{ *}}entries {{ *}}bytes {{ *}}lookups {{ *}}hit rate
+// CHECK-DAG: {{^}}GenericCache {{ *}}[1-9]
+// CHECK-DAG: {{^}}TupleTypes {{ *}}[1-9]
+// CHECK-DAG: {{^}}ConformanceCache {{ *}}[1-9]
+// CHECK-DAG: {{^}}ExistentialConformances {{ *}}[1-9]
+
+// DISABLED-NOT: hit rate
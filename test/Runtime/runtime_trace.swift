@@ -0,0 +1,26 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_DEBUG_RUNTIME_TRACE=%t/trace.bin %t/a.out
+// RUN: %utils/swift-runtime-trace-dump %t/trace.bin | %FileCheck %s
+
+// REQUIRES: executable_test
+// UNSUPPORTED: OS=watchos
+// UNSUPPORTED: OS=ios
+// UNSUPPORTED: OS=tvos
+
+protocol P {}
+struct S : P {}
+struct Box<T> { var value: T }
+
+let global = Box(value: 1)
+
+func isP(_ x: Any) -> Bool { return x is P }
+
+print(isP(S()))
+print(Box(value: S()))
+print(global)
+
+// CHECK-DAG: metadata-instantiation
+// CHECK-DAG: conformance-scan
+// CHECK-DAG: once
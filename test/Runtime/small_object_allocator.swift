@@ -0,0 +1,47 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_SMALL_OBJECT_ALLOCATOR=1 %t/a.out | %FileCheck %s
+// RUN: %t/a.out | %FileCheck %s
+
+// REQUIRES: executable_test
+// REQUIRES: OS=linux-gnu
+
+final class Node {
+  var value: Int
+  var next: Node?
+  init(value: Int, next: Node?) {
+    self.value = value
+    self.next = next
+  }
+}
+
+final class Wide {
+  var a = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+  var b = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+  var c = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+}
+
+// Build and drop lists repeatedly so that blocks are freed, cached and
+// reused across chunks.
+var total = 0
+for round in 0..<20 {
+  var head: Node? = nil
+  for i in 0..<10_000 {
+    head = Node(value: i + round, next: head)
+  }
+  while let node = head {
+    total = total &+ node.value
+    head = node.next
+  }
+}
+// CHECK: 1001800000
+print(total)
+
+// Objects too large for the size classes still come from malloc.
+var wides = [Wide]()
+for _ in 0..<100 {
+  wides.append(Wide())
+}
+// CHECK: 100
+print(wides.count)
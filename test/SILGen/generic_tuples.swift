@@ -20,6 +20,18 @@ func foo<T>(_ x: T) {}
 // CHECK-LABEL: sil hidden @_TF14generic_tuples3bar
 func bar(_ x: (Blub, Blub)) { foo(x) }
 
+// An owned tuple argument is built in the buffer that is passed to the callee,
+// rather than in a temporary which is then copied.
+// CHECK-LABEL: sil hidden @_TF14generic_tuples16passTupleLiteral
+// CHECK:      [[TUPLE:%.*]] = alloc_stack $(T, U)
+// CHECK:      [[ELT0:%.*]] = tuple_element_addr [[TUPLE]] : $*(T, U), 0
+// CHECK:      copy_addr {{%.*}} to [initialization] [[ELT0]]
+// CHECK:      [[ELT1:%.*]] = tuple_element_addr [[TUPLE]] : $*(T, U), 1
+// CHECK:      copy_addr {{%.*}} to [initialization] [[ELT1]]
+// CHECK-NOT:  copy_addr
+// CHECK:      apply {{%.*}}<(T, U)>([[TUPLE]])
+func passTupleLiteral<T, U>(_ t: T, _ u: U) { foo((t, u)) }
+
 
 // rdar://26279628
 //   A type parameter constrained to be a concrete type must be handled
@@ -0,0 +1,13 @@
+// RUN: %target-swift-frontend -emit-silgen %s -debug-time-compilation -o /dev/null 2>&1 | %FileCheck %s
+
+// CHECK: Swift compilation
+// CHECK-DAG: SILGen
+// CHECK-DAG: Mangling
+
+func callee<T>(_ x: T) -> T { return x }
+
+func caller() {
+  _ = callee(1)
+  _ = callee("two")
+  _ = callee(3.0)
+}
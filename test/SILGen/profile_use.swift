@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -profile-generate -Xfrontend -disable-incremental-llvm-codegen -o %t/main
+// RUN: env LLVM_PROFILE_FILE=%t/default.profraw %target-run %t/main
+// RUN: %llvm-profdata merge %t/default.profraw -o %t/default.profdata
+// RUN: %target-swift-frontend -emit-silgen -profile-use=%t/default.profdata %s | %FileCheck %s
+// RUN: not %target-swift-frontend -emit-silgen -profile-use=%t/missing.profdata %s 2>&1 | %FileCheck %s --check-prefix=CHECK-MISSING
+// RUN: rm -rf %t
+
+// REQUIRES: profile_runtime
+// REQUIRES: OS=macosx
+
+// CHECK-MISSING: error: failed to load profile data '{{.*}}missing.profdata'
+
+// CHECK-LABEL: sil hidden @_TF11profile_use7isLarge
+// CHECK: bb0({{.*}}):{{ *}}// count: 10
+// CHECK-NOT: int_instrprof_increment
+// CHECK: // count: 4
+func isLarge(_ n: Int) -> Bool {
+  if n > 5 {
+    return true
+  }
+  return false
+}
+
+var large = 0
+for i in 0..<10 {
+  if isLarge(i) {
+    large += 1
+  }
+}
+print(large)
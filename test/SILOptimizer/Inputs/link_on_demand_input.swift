@@ -0,0 +1,8 @@
+@inline(never)
+public func notInlined() -> Int {
+  return 27
+}
+
+public func small() -> Int {
+  return notInlined()
+}
@@ -0,0 +1,9 @@
+public func countEqual<T : Equatable>(_ xs: [T], _ x: T) -> Int {
+  var n = 0
+  for y in xs {
+    if y == x {
+      n += 1
+    }
+  }
+  return n
+}
@@ -0,0 +1,67 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend %s -parse-as-library -O -emit-sil -save-optimization-record-path %t/remarks.yaml | %FileCheck %s
+// RUN: %FileCheck -check-prefix=REMARK %s < %t/remarks.yaml
+// RUN: %target-swift-frontend %s -parse-as-library -O -emit-sil -Xllvm -sil-devirt-sealed-hierarchies=false | %FileCheck -check-prefix=DISABLED %s
+
+// Shape's hierarchy can't be extended outside the module. It has more
+// subclasses than the speculative devirtualizer checks for, but only two of
+// them override area(), so only those two need a check.
+
+class Shape {
+  @inline(never) func area() -> Int { return 0 }
+}
+class Square : Shape {
+  @inline(never) override func area() -> Int { return 1 }
+}
+class Circle : Shape {
+  @inline(never) override func area() -> Int { return 2 }
+}
+class Point1 : Shape {}
+class Point2 : Shape {}
+class Point3 : Shape {}
+class Point4 : Shape {}
+class Point5 : Shape {}
+class Point6 : Shape {}
+
+// CHECK-LABEL: sil{{( hidden)?}} [noinline] @{{.*}}9shapeArea{{.*}} : $@convention(thin)
+// CHECK-DAG: checked_cast_br [exact] %0 : $Shape to $Square
+// CHECK-DAG: checked_cast_br [exact] %0 : $Shape to $Circle
+// CHECK-NOT: class_method
+// CHECK: }
+// DISABLED-LABEL: sil{{( hidden)?}} [noinline] @{{.*}}9shapeArea{{.*}} : $@convention(thin)
+// DISABLED: class_method
+// DISABLED: }
+@inline(never)
+func shapeArea(_ s: Shape) -> Int {
+  return s.area()
+}
+
+public func testShapeArea() -> Int {
+  return shapeArea(Point3())
+}
+
+// Node can be subclassed by other modules, so its call of visit() can't be
+// fully devirtualized.
+
+open class Node {
+  func visit() -> Int { return 0 }
+}
+class Leaf : Node {
+  override func visit() -> Int { return 1 }
+}
+
+// REMARK: Pass: {{ *}}sil-speculative-devirtualizer
+// REMARK-NEXT: Name: {{ *}}NotDevirtualized
+// REMARK-NEXT: DebugLoc:
+// REMARK-NEXT: Function: {{.*}}9visitNode
+// REMARK-NEXT: Args:
+// REMARK-NEXT: - Method: {{ *}}visit
+// REMARK-NEXT: - Reason: {{ *}}open class hierarchy
+@inline(never)
+func visitNode(_ n: Node) -> Int {
+  return n.visit()
+}
+
+public func testVisitNode() -> Int {
+  return visitNode(Leaf())
+}
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module %S/Inputs/link_on_demand_input.swift -o %t -parse-as-library -sil-serialize-all
+// RUN: %target-swift-frontend %s -O -I %t -emit-sil | %FileCheck %s -check-prefix=CHECK -check-prefix=LINK-ALL
+// RUN: %target-swift-frontend %s -O -I %t -emit-sil -sil-link-on-demand | %FileCheck %s -check-prefix=CHECK -check-prefix=ON-DEMAND
+
+import link_on_demand_input
+
+// Both modes inline small(), but only linking everything up front pulls in
+// the body of notInlined(), which is never inlined.
+
+// CHECK-LABEL: sil @{{.*}}4test{{.*}} : $@convention(thin) () -> Int {
+// CHECK: [[F:%.*]] = function_ref @{{.*}}10notInlined{{.*}}
+// CHECK: apply [[F]]()
+// CHECK-NOT: function_ref @{{.*}}5small
+// CHECK: {{^}}}
+public func test() -> Int {
+  return small()
+}
+
+// LINK-ALL: sil public_external [fragile] [noinline] @{{.*}}10notInlined{{.*}} : $@convention(thin) () -> Int {
+// ON-DEMAND: sil [fragile] [noinline] @{{.*}}10notInlined{{.*}} : $@convention(thin) () -> Int{{$}}
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module %S/Inputs/specialization_requests_input.swift -o %t -parse-as-library -O
+// RUN: %target-swift-frontend %s -O -I %t -emit-sil -emit-specialization-requests-path %t/requests.yaml | %FileCheck %s -check-prefix=BEFORE
+// RUN: %FileCheck %s -check-prefix=REQUESTS < %t/requests.yaml
+// RUN: %target-swift-frontend -emit-module %S/Inputs/specialization_requests_input.swift -o %t -parse-as-library -O -prespecialize-requests %t/requests.yaml
+// RUN: %target-swift-frontend %s -O -I %t -emit-sil | %FileCheck %s -check-prefix=AFTER
+
+import specialization_requests_input
+
+// The body of countEqual() isn't serialized, so the call can't be
+// specialized until the module exports a specialization for Int.
+
+// REQUESTS: - Function: {{ *}}_TF29specialization_requests_input10countEqual
+// REQUESTS-NEXT: Substitutions: {{ *}}[ Swift.Int ]
+
+// BEFORE-LABEL: sil @{{.*}}10countOnes{{.*}} : $@convention(thin)
+// BEFORE: function_ref @_TF29specialization_requests_input10countEqual
+// AFTER-LABEL: sil @{{.*}}10countOnes{{.*}} : $@convention(thin)
+// AFTER: function_ref @_TTSg{{.*}}_TF29specialization_requests_input10countEqual
+public func countOnes(_ xs: [Int]) -> Int {
+  return countEqual(xs, 1)
+}
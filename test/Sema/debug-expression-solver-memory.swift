@@ -0,0 +1,10 @@
+// RUN: %target-swift-frontend -parse -debug-expression-solver-memory %s 2>&1 | %FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}} bytes{{.*}}debug-expression-solver-memory.swift:6:9
+// CHECK: {{[1-9][0-9]*}} bytes{{.*}}debug-expression-solver-memory.swift:9:10
+
+let x = 1 + 2 * 3
+
+func f() -> Int {
+  return x + 1
+}
@@ -0,0 +1,10 @@
+// RUN: %target-swift-frontend -parse -debug-time-expression-type-checking %s 2>&1 | %FileCheck %s
+
+// CHECK: {{[0-9]+}}.{{[0-9]+}}ms{{.*}}debug-time-expression-type-checking.swift:6:9
+// CHECK: {{[0-9]+}}.{{[0-9]+}}ms{{.*}}debug-time-expression-type-checking.swift:9:10
+
+let x = 1 + 2 * 3
+
+func f() -> Int {
+  return x + 1
+}
@@ -0,0 +1,56 @@
+public struct Point {
+  public var x: Int
+  public var y: Int
+
+  public init(x: Int, y: Int) {
+    self.x = x
+    self.y = y
+  }
+
+  public func scaled(by factor: Int) -> Point {
+    return Point(x: x * factor, y: y * factor)
+  }
+
+  public func scaled(by point: Point) -> Point {
+    return Point(x: x * point.x, y: y * point.y)
+  }
+}
+
+extension Point {
+  public static var origin: Point { return Point(x: 0, y: 0) }
+
+  public func offset(by delta: Int) -> Point {
+    return Point(x: x + delta, y: y + delta)
+  }
+}
+
+public class Shape {
+  public init() {}
+  public var name: String { return "shape" }
+  public func area() -> Int { return 0 }
+}
+
+public class Square : Shape {
+  public var side: Int = 1
+  public override var name: String { return "square" }
+  public override func area() -> Int { return side * side }
+}
+
+public enum Direction {
+  case north, south
+
+  public var opposite: Direction {
+    switch self {
+    case .north: return .south
+    case .south: return .north
+    }
+  }
+}
+
+public protocol Sized {
+  var size: Int { get }
+}
+
+extension Direction : Sized {
+  public var size: Int { return 1 }
+}
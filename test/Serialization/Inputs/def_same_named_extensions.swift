@@ -0,0 +1,31 @@
+public struct First {
+  public struct Inner {
+    public init() {}
+  }
+}
+
+public struct Second {
+  public struct Inner {
+    public init() {}
+  }
+}
+
+extension First.Inner {
+  public var fromFirst: Int { return 1 }
+}
+
+extension Second.Inner {
+  public var fromSecond: Int { return 2 }
+}
+
+public protocol Describable {
+  var describe: String { get }
+}
+
+extension First.Inner : Describable {
+  public var describe: String { return "first" }
+}
+
+extension Second.Inner : Describable {
+  public var describe: String { return "second" }
+}
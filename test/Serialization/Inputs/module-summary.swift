@@ -0,0 +1,21 @@
+public struct Point {
+  public var x: Int
+  public var y: Int
+
+  public init(x: Int, y: Int) {
+    self.x = x
+    self.y = y
+  }
+
+  public func sum() -> Int {
+    return x + y // BODY
+  }
+}
+
+public func scale(_ p: Point, by factor: Int) -> Point { // SIGNATURE
+  return Point(x: p.x * factor, y: p.y * factor)
+}
+
+internal func helper() {}
+
+infix operator *** : MultiplicationPrecedence
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-build-swift -emit-module -Xfrontend -disable-diagnostic-passes -Xfrontend -sil-serialize-all -Xfrontend -compress-serialized-sil -force-single-frontend-invocation -o %t/def_basic.swiftmodule %S/Inputs/def_basic.sil
+// RUN: llvm-bcanalyzer %t/def_basic.swiftmodule | %FileCheck %s
+// RUN: %target-build-swift -emit-silgen -Xfrontend -sil-link-all -I %t %s | %FileCheck %S/Inputs/def_basic.sil
+
+// This test currently is written such that no optimizations are assumed.
+// REQUIRES: swift_test_mode_optimize_none
+
+// Function bodies are read from compressed records, which end with a
+// boundary record instead of running into the next function.
+
+// CHECK-NOT: UnknownCode
+// CHECK: SIL_COMPRESSED_BODY_HEADER
+// CHECK: SIL_FUNCTION
+// CHECK: SIL_BODY_BOUNDARY
+// CHECK: SIL_COMPRESSED_BODY
+// CHECK-NOT: SIL_BASIC_BLOCK
+
+import def_basic
+
+func test_all() {
+  serialize_all()
+}
@@ -0,0 +1,26 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_same_named_extensions.swift
+// RUN: %target-swift-frontend -parse -verify -I %t %s
+
+// Extensions of nominal types that share a name are each found on the type
+// they extend, and only on that type.
+
+import def_same_named_extensions
+
+func useFirst(_ inner: First.Inner) -> Int {
+  _ = inner.fromSecond // expected-error {{value of type 'First.Inner' has no member 'fromSecond'}}
+  return inner.fromFirst
+}
+
+func useSecond(_ inner: Second.Inner) -> Int {
+  _ = inner.fromFirst // expected-error {{value of type 'Second.Inner' has no member 'fromFirst'}}
+  return inner.fromSecond
+}
+
+func describe<T : Describable>(_ value: T) -> String {
+  return value.describe
+}
+
+_ = describe(First.Inner())
+_ = describe(Second.Inner())
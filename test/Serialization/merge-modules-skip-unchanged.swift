@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged -primary-file %s -o %t/partial.swiftmodule
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged %t/partial.swiftmodule -skip-unchanged-module-merge -o %t/merged.swiftmodule
+// RUN: llvm-bcanalyzer -dump %t/merged.swiftmodule | %FileCheck -check-prefix=HASH %s
+
+// HASH: <OPTIONS_BLOCK
+// HASH: MERGED_INPUTS_HASH
+// HASH: </OPTIONS_BLOCK>
+
+// Merging the same partial module again leaves the output alone.
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged %t/partial.swiftmodule -skip-unchanged-module-merge -o %t/merged.swiftmodule -debug-time-compilation 2>&1 | %FileCheck -check-prefix=SKIPPED %s
+
+// Different options, or a missing output, mean merging again.
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged %t/partial.swiftmodule -skip-unchanged-module-merge -o %t/merged.swiftmodule -enable-testing -debug-time-compilation 2>&1 | %FileCheck -check-prefix=MERGED %s
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged %t/partial.swiftmodule -skip-unchanged-module-merge -o %t/merged.swiftmodule -enable-testing -emit-module-doc-path %t/merged.swiftdoc -debug-time-compilation 2>&1 | %FileCheck -check-prefix=MERGED %s
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged %t/partial.swiftmodule -skip-unchanged-module-merge -o %t/merged.swiftmodule -enable-testing -emit-module-doc-path %t/merged.swiftdoc -debug-time-compilation 2>&1 | %FileCheck -check-prefix=SKIPPED %s
+
+// A changed partial module means merging again.
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged -primary-file %s -o %t/partial.swiftmodule -D EXTRA
+// RUN: %target-swift-frontend -emit-module -parse-as-library -module-name merged %t/partial.swiftmodule -skip-unchanged-module-merge -o %t/merged.swiftmodule -enable-testing -emit-module-doc-path %t/merged.swiftdoc -debug-time-compilation 2>&1 | %FileCheck -check-prefix=MERGED %s
+
+// SKIPPED-NOT: Serialization (swiftmodule)
+// MERGED: Serialization (swiftmodule)
+
+public func foo() {}
+
+#if EXTRA
+public func bar() {}
+#endif
@@ -0,0 +1,45 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b %t/c
+// RUN: cp %S/Inputs/module-summary.swift %t/a/summarized.swift
+// RUN: sed -e 's/x + y/y + x/' %t/a/summarized.swift > %t/b/summarized.swift
+// RUN: sed -e 's/by factor: Int/by factor: Double/' -e 's/\* factor/* Int(factor)/g' %t/a/summarized.swift > %t/c/summarized.swift
+
+// RUN: %target-swift-frontend -emit-module -o %t/a/summarized.swiftmodule -emit-module-summary-path %t/a/summarized.swiftsummary %t/a/summarized.swift
+// RUN: %target-swift-frontend -emit-module -o %t/b/summarized.swiftmodule -emit-module-summary-path %t/b/summarized.swiftsummary %t/b/summarized.swift
+// RUN: %target-swift-frontend -emit-module -o %t/c/summarized.swiftmodule -emit-module-summary-path %t/c/summarized.swiftsummary %t/c/summarized.swift
+// RUN: %FileCheck %s < %t/a/summarized.swiftsummary
+
+// Changing a function body doesn't change the summary; changing a signature
+// does.
+// RUN: diff %t/a/summarized.swiftsummary %t/b/summarized.swiftsummary
+// RUN: not diff %t/a/summarized.swiftsummary %t/c/summarized.swiftsummary > %t/c/diff.txt
+// RUN: %FileCheck -check-prefix=CHANGED %s < %t/c/diff.txt
+
+// An unchanged summary isn't rewritten, so build systems can use its
+// modification time.
+// RUN: touch -t 201401240005 %t/a/summarized.swiftsummary
+// RUN: cp %t/b/summarized.swift %t/a/summarized.swift
+// RUN: %target-swift-frontend -emit-module -o %t/a/summarized.swiftmodule -emit-module-summary-path %t/a/summarized.swiftsummary %t/a/summarized.swift
+// RUN: ls -l %t/a/summarized.swiftsummary | %FileCheck -check-prefix=UNCHANGED %s
+
+// CHECK: version: "
+// CHECK-NEXT: interface-hash: "{{[0-9a-f]{32}}}"
+// CHECK-NEXT: sil-hash: "{{[0-9a-f]{32}}}"
+// CHECK-NEXT: decls:
+// CHECK-NEXT:   - name: "***"
+// CHECK-NEXT:     kind: "InfixOperator"
+// CHECK-NEXT:     hash: "{{[0-9a-f]{32}}}"
+// CHECK-NEXT:   - name: "Point"
+// CHECK-NEXT:     kind: "Struct"
+// CHECK-NEXT:     hash: "{{[0-9a-f]{32}}}"
+// CHECK-NEXT:     members-hash: "{{[0-9a-f]{32}}}"
+// CHECK-NEXT:   - name: "scale"
+// CHECK-NEXT:     kind: "Func"
+// CHECK-NEXT:     hash: "{{[0-9a-f]{32}}}"
+// CHECK-NOT: helper
+
+// CHANGED: interface-hash
+// CHANGED-NOT: members-hash
+// CHANGED: hash: "
+
+// UNCHANGED: 2014
@@ -0,0 +1,31 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_named_members.swift
+// RUN: %target-swift-frontend -parse -I %t %s
+// RUN: %target-swift-frontend -parse -I %t %s -enable-named-lazy-member-loading
+// RUN: %target-swift-frontend -emit-sil -I %t %s -enable-named-lazy-member-loading | %FileCheck %s
+
+import def_named_members
+
+extension Point {
+  func sum() -> Int { return x + y }
+}
+
+// CHECK-LABEL: sil hidden @{{.*}}usePoint
+func usePoint(_ p: Point) -> Int {
+  // CHECK: function_ref @{{.*}}scaled
+  let q = p.scaled(by: 2).scaled(by: Point.origin).offset(by: 1)
+  return q.sum()
+}
+
+// CHECK-LABEL: sil hidden @{{.*}}useShape
+func useShape(_ s: Square) -> Int {
+  // CHECK: class_method {{.*}} #Square.area
+  _ = s.name
+  return s.area() + s.side
+}
+
+func useDirection(_ d: Direction) -> Int {
+  let sized: Sized = d.opposite
+  return sized.size
+}
@@ -0,0 +1,27 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_func.swift
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_struct.swift
+// RUN: %target-swift-frontend -emit-module -o %t %S/../Inputs/empty.swift -module-name new_module
+// RUN: %target-swift-frontend -emit-module -o %t %S/../Inputs/empty.swift -module-name another_new_module
+// RUN: %target-swift-frontend -emit-module -o %t %S/../Inputs/empty.swift -module-name late_module
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/depends_on_new_module.swift -I %t
+// RUN: %target-swift-frontend %s -parse -I %t -enable-parallel-imports
+
+// A module that fails to load is still diagnosed where it is imported.
+// RUN: rm %t/new_module.swiftmodule
+// RUN: not %target-swift-frontend %s -parse -I %t -enable-parallel-imports 2>&1 | %FileCheck %s
+
+import def_func
+import struct def_struct.TwoInts
+// CHECK: parallel-imports.swift:[[@LINE+1]]:8: error: missing required module 'new_module'
+import depends_on_new_module
+
+func useImports() {
+  _ = getZero()
+  _ = TwoInts(x: 1, y: 2)
+  depends_on_new_module.foo()
+}
+
+// Imports after a body aren't read ahead of time, but are still loaded.
+import late_module
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_named_members.swift
+// RUN: %target-swift-frontend -parse -I %t %s -stats-deserialization 2>&1 | %FileCheck %s
+// RUN: %target-swift-frontend -parse -I %t %s -stats-deserialization -stats-deserialization-top-decls 1 2>&1 | %FileCheck -check-prefix=CHECK-ONE %s
+// RUN: %target-swift-frontend -parse -I %t %s -stats-deserialization -stats-deserialization-top-decls 0 2>&1 | %FileCheck -check-prefix=CHECK-NONE %s
+// RUN: %target-swift-frontend -parse -I %t %s 2>&1 | %FileCheck -check-prefix=CHECK-DISABLED %s
+
+import def_named_members
+
+func usePoint(_ p: Point) -> Int {
+  return p.scaled(by: 2).x
+}
+
+// CHECK: Deserialization statistics
+// CHECK: decls types confs sil-fns
+// CHECK: {{^ +[1-9][0-9]* +[0-9]+ +[0-9]+ +[0-9]+ .* def_named_members$}}
+// CHECK: Most expensive decls
+// CHECK: {{^ +[0-9]+\.[0-9]{3} +[A-Za-z]+ }}
+
+// CHECK-ONE: Most expensive decls
+// CHECK-ONE-NEXT: {{^ +[0-9]+\.[0-9]{3} }}
+// CHECK-ONE-NOT: {{^ +[0-9]+\.[0-9]{3} }}
+
+// CHECK-NONE: def_named_members
+// CHECK-NONE-NOT: Most expensive decls
+
+// CHECK-DISABLED-NOT: Deserialization statistics
@@ -62,6 +62,19 @@ func foo() {
 // CHECKD-NEXT: key.nextrequeststart: 0
 // CHECKD-NEXT: }
 
+// Updates that extend the filter text narrow down the previous matches, and
+// updates that don't start over from all completions.
+// RUN: %sourcekitd-test -req=complete.open -pos=11:5 \
+// RUN:   -req-opts=filtertext=aa %s -- %s > %t.aa
+// RUN: %sourcekitd-test -req=complete.open -pos=11:5 %s -- %s \
+// RUN:   == -req=complete.update -pos=11:5 -req-opts=filtertext=a %s -- %s \
+// RUN:   == -req=complete.update -pos=11:5 -req-opts=filtertext=aa %s -- %s \
+// RUN:   == -req=complete.update -pos=11:5 -req-opts=filtertext=b %s -- %s \
+// RUN:   == -req=complete.update -pos=11:5 -req-opts=filtertext=a %s -- %s \
+// RUN:   > %t.narrow
+// RUN: cat %t.all %t.a %t.aa %t.b %t.a > %t.narrow.check
+// RUN: diff -u %t.narrow %t.narrow.check
+
 
 // RUN: %complete-test -tok=FOO %s | %FileCheck %s
 // CHECK-LABEL: Results for filterText: [
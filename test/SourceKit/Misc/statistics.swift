@@ -0,0 +1,10 @@
+func foo() {}
+foo()
+
+// RUN: %sourcekitd-test -req=cursor -pos=2:1 %s -- %s == -req=statistics | %FileCheck %s
+
+// CHECK: key.kind: source.statistic.num-ast-builds
+// CHECK-NEXT: key.value: 1
+// CHECK: key.kind: source.statistic.num-ast-consumers
+// CHECK-NEXT: key.value: 1
+// CHECK: key.kind: source.statistic.total-type-check-us
@@ -0,0 +1,24 @@
+// RUN: env SOURCEKIT_REPARSE_FUNCTION_BODIES=1 %sourcekitd-test -req=open %s -- %s == \
+// RUN:    -req=edit -pos=9:15 -replace="\"one\"" -length=1 %s == \
+// RUN:    -req=edit -pos=13:16 -replace="\"bar\"" -length=1 %s == \
+// RUN:    -req=print-diags %s | %FileCheck %s
+
+func takesString(s: String) {}
+
+func foo() {
+  takesString(1)
+}
+
+func bar() {
+  let _: Int = 0
+}
+
+let _: Int = "top"
+
+// CHECK-NOT:  key.line: 9,
+// CHECK:      key.line: 13,
+// CHECK-NEXT: key.column: 16,
+// CHECK:      key.description: "cannot convert value of type 'String' to specified type 'Int'"
+// CHECK:      key.line: 16,
+// CHECK-NEXT: key.column: 14,
+// CHECK:      key.description: "cannot convert value of type 'String' to specified type 'Int'"
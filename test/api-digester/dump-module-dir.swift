@@ -0,0 +1,18 @@
+// RUN: rm -rf %t.mod && mkdir -p %t.mod
+// RUN: rm -rf %t.sdk && mkdir -p %t.sdk
+// RUN: rm -rf %t.module-cache && mkdir -p %t.module-cache
+// RUN: rm -rf %t.dumps && mkdir -p %t.dumps
+// RUN: %swift -emit-module -o %t.mod/cake.swiftmodule %S/Inputs/cake.swift -parse-as-library
+// RUN: %swift -emit-module -o %t.mod/cake1.swiftmodule %S/Inputs/cake1.swift -parse-as-library
+// RUN: %api-digester -dump-sdk -module cake -module cake1 -output-dir %t.dumps -j 2 -module-cache-path %t.module-cache -sdk %t.sdk -swift-version 3.0 -I %t.mod
+// RUN: diff -u %t.dumps/cake.json %S/Outputs/cake.json
+
+// Modules whose dumps are unchanged are skipped without changing the result.
+// RUN: rm -rf %t.old && mkdir -p %t.old
+// RUN: rm -rf %t.new && mkdir -p %t.new
+// RUN: cp %t.dumps/cake.json %t.old/Cake.json
+// RUN: cp %t.dumps/cake1.json %t.new/Cake.json
+// RUN: cp %t.dumps/cake.json %t.old/Unchanged.json
+// RUN: cp %t.dumps/cake.json %t.new/Unchanged.json
+// RUN: %api-digester -diagnose-sdk --input-paths %t.old -input-paths %t.new > %t.result
+// RUN: diff -u %S/Outputs/Cake.txt %t.result
@@ -0,0 +1,24 @@
+struct Point {
+  var x = 0, y = 0
+}
+
+extension Point {
+  func sum() -> Int { return x + y }
+}
+
+protocol Shape {}
+extension Point : Shape {}
+
+extension Shape {
+  var isShape: Bool { return true }
+}
+
+typealias Coordinates = Point
+extension Coordinates {
+  func difference() -> Int { return x - y }
+}
+
+extension Unused {
+  func neverLookedUp() {}
+}
+struct Unused {}
@@ -0,0 +1,13 @@
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/lazy-extension-binding-other.swift -enable-lazy-extension-binding -verify
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/lazy-extension-binding-other.swift -verify
+
+// Extensions in other files are bound when members of the extended type
+// are looked up, including extensions written through a typealias and
+// extensions that declare conformances.
+
+func test(p: Point) -> Int {
+  let shape: Shape = p
+  _ = shape.isShape
+  _ = p.noSuchMember // expected-error {{value of type 'Point' has no member 'noSuchMember'}}
+  return p.sum() + p.difference()
+}
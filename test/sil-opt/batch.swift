@@ -0,0 +1,9 @@
+// RUN: %target-sil-opt -batch -dce %S/Inputs/batch | %FileCheck %s
+
+// CHECK: parse ms  passes ms  file
+// CHECK-NEXT: {{[0-9]+\.[0-9]+}} {{ *[0-9]+\.[0-9]+}}  a.sil
+// CHECK-NEXT: {{[0-9]+\.[0-9]+}} {{ *[0-9]+\.[0-9]+}}  b.sil
+// CHECK-NEXT: {{[0-9]+\.[0-9]+}} {{ *[0-9]+\.[0-9]+}}  total
+
+// CHECK: ms  pass
+// CHECK-NEXT: {{[0-9]+\.[0-9]+}}  Dead Code Elimination
@@ -237,6 +237,21 @@ CharacterTests.test(
     { x in { String(Character(x)) < String(Character($0)) } } as PredicateFn)
 }
 
+CharacterTests.test("String(Character)/ASCII/mutation") {
+  // One-character ASCII strings share static storage; mutating one must not
+  // affect any other.
+  for c in ["a", "z", "\u{0}", "\u{7f}"] as [Character] {
+    var s = String(c)
+    expectTrue(s._core.isASCII)
+    expectEqual(1, s.utf16.count)
+    s.append("b")
+    s.append(c)
+    expectEqual(String(c) + "b" + String(c), s)
+    expectEqual(1, String(c).utf16.count)
+    expectEqual(String(c), String(Character(String(c))))
+  }
+}
+
 CharacterTests.test("String.append(_: Character)") {
   for test in testCharacters {
     let character = Character(test)
@@ -0,0 +1,130 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+let DequeTests = TestSuite("Deque")
+
+/// Returns a deque whose elements wrap around the end of its buffer.
+func makeWrappedDeque(_ elements: CountableRange<Int>) -> Deque<Int> {
+  var d = Deque<Int>()
+  d.reserveCapacity(elements.count)
+  for e in elements.reversed() {
+    d.prepend(e)
+  }
+  return d
+}
+
+DequeTests.test("appendAndPrepend") {
+  var d = Deque<Int>()
+  var expected: [Int] = []
+  for i in 0..<100 {
+    if i % 3 == 0 {
+      d.prepend(i)
+      expected.insert(i, at: 0)
+    } else {
+      d.append(i)
+      expected.append(i)
+    }
+    expectEqual(expected, Array(d))
+    expectEqual(expected.first, d.first)
+    expectEqual(expected.last, d.last)
+  }
+}
+
+DequeTests.test("popFirst/popLast") {
+  var d = makeWrappedDeque(0..<10)
+  var expected = Array(0..<10)
+  while !expected.isEmpty {
+    if expected.count % 2 == 0 {
+      expectEqual(expected.removeFirst(), d.popFirst())
+    } else {
+      expectEqual(expected.removeLast(), d.popLast())
+    }
+    expectEqual(expected, Array(d))
+  }
+  expectNil(d.popFirst())
+  expectNil(d.popLast())
+}
+
+DequeTests.test("queue/keepsCapacity") {
+  var d = Deque<Int>()
+  d.reserveCapacity(16)
+  let capacity = d.capacity
+  for i in 0..<1000 {
+    d.append(i)
+    if d.count > 8 {
+      expectEqual(i - 8, d.removeFirst())
+    }
+  }
+  expectEqual(Array(991..<1000), Array(d))
+  expectEqual(capacity, d.capacity)
+}
+
+DequeTests.test("removeFirst(_:)/removeLast(_:)") {
+  var d = makeWrappedDeque(0..<10)
+  d.removeFirst(3)
+  d.removeLast(2)
+  expectEqual(Array(3..<8), Array(d))
+}
+
+DequeTests.test("replaceSubrange") {
+  for count in 0...6 {
+    for lower in 0...count {
+      for upper in lower...count {
+        for newCount in 0...3 {
+          let newElements = (0..<newCount).map { -1 - $0 }
+          var d = makeWrappedDeque(0..<count)
+          var expected = Array(0..<count)
+          d.replaceSubrange(lower..<upper, with: newElements)
+          expected.replaceSubrange(lower..<upper, with: newElements)
+          expectEqual(expected, Array(d))
+        }
+      }
+    }
+  }
+}
+
+DequeTests.test("valueSemantics") {
+  var d = makeWrappedDeque(0..<8)
+  let copy = d
+  d[0] = 42
+  d.removeLast()
+  d.prepend(7)
+  expectEqual(Array(0..<8), Array(copy))
+  expectEqual([7, 42, 1, 2, 3, 4, 5, 6], Array(d))
+}
+
+DequeTests.test("lifetime") {
+  do {
+    var d = Deque<LifetimeTracked>()
+    for i in 0..<20 {
+      d.prepend(LifetimeTracked(i))
+      d.append(LifetimeTracked(i))
+    }
+    d.removeFirst(5)
+    d.removeLast(5)
+    d.replaceSubrange(3..<10, with: [LifetimeTracked(100)])
+    let copy = d
+    d.removeAll(keepingCapacity: true)
+    expectTrue(d.isEmpty)
+    expectEqual(24, copy.count)
+  }
+  expectEqual(0, LifetimeTracked.instances)
+}
+
+DequeTests.test("sort") {
+  var d = makeWrappedDeque(0..<20)
+  d.sort(by: >)
+  expectEqual(Array((0..<20).reversed()), Array(d))
+}
+
+DequeTests.test("description") {
+  let d: Deque = [1, 2, 3]
+  expectEqual("[1, 2, 3]", d.description)
+  expectEqual("Deque([1, 2, 3])", d.debugDescription)
+  expectTrue(d == [1, 2, 3])
+  expectTrue(d != [1, 2])
+}
+
+runAllTests()
@@ -45,6 +45,16 @@ DictionaryTraps.test("DuplicateKeys3")
   _blackHole(d)
 }
 
+DictionaryTraps.test("DuplicateKeys4")
+  .skip(.custom(
+    { _isFastAssertConfiguration() },
+    reason: "this trap is not guaranteed to happen in -Ounchecked"))
+  .code {
+  expectCrashLater()
+  let d = Dictionary(uniqueKeysWithValues: [(10, 1010), (20, 1020), (10, 0)])
+  _blackHole(d)
+}
+
 DictionaryTraps.test("RemoveInvalidIndex1")
   .skip(.custom(
     { _isFastAssertConfiguration() },
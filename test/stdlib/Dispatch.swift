@@ -101,3 +101,49 @@ DispatchAPI.test("DispatchTime comparisons") {
         })
     }
 }
+
+DispatchAPI.test("RandomAccessCollection.concurrentMap") {
+  for count in [0, 10, 100_000] {
+    let input = Array(0..<count)
+    expectEqual(input.map { $0 * 3 }, input.concurrentMap { $0 * 3 })
+  }
+}
+
+DispatchAPI.test("RandomAccessCollection.concurrentForEach") {
+  let count = 100_000
+  let visits = UnsafeMutablePointer<Int>.allocate(capacity: count)
+  visits.initialize(to: 0, count: count)
+  defer { visits.deallocate(capacity: count) }
+
+  // Each element is visited by exactly one thread.
+  (0..<count).concurrentForEach { visits[$0] += 1 }
+  expectEqual(
+    Array(repeating: 1, count: count),
+    Array(UnsafeBufferPointer(start: visits, count: count)))
+}
+
+DispatchAPI.test("RandomAccessCollection.concurrentReduce") {
+  for count in [0, 10, 100_000] {
+    expectEqual(count * (count - 1) / 2, (0..<count).concurrentReduce(0, +))
+  }
+  // Chunk results are combined in order.
+  let strings = (0..<10_000).map { String($0) }
+  expectEqual(strings.joined(), strings.concurrentReduce("", +))
+}
+
+DispatchAPI.test("MutableCollection.concurrentSort") {
+  for count in [0, 10, 100_000] {
+    var input = (0..<count).map { _ in Int(arc4random_uniform(1000)) }
+    let expected = input.sorted()
+    input.concurrentSort()
+    expectEqual(expected, input)
+  }
+
+  // The sort is stable.
+  let keys = (0..<100_000).map { (key: Int(arc4random_uniform(100)), position: $0) }
+  var sortedKeys = keys
+  sortedKeys.concurrentSort { $0.key < $1.key }
+  expectEqual(
+    keys.sorted { $0.key < $1.key }.map { $0.position },
+    sortedKeys.map { $0.position })
+}
@@ -60,4 +60,45 @@ FilterTests.test("filtering sequences") {
   expectEqualSequence([7, 14, 21, 28], f1)
 }
 
+/// A sequence that can only be traversed with `forEach`.
+struct ForEachOnlySequence : Sequence {
+  let elements: [Int]
+
+  func makeIterator() -> IndexingIterator<[Int]> {
+    fatalError("a lazy pipeline should not have built an iterator")
+  }
+
+  func forEach(_ body: (Int) throws -> Void) rethrows {
+    for element in elements {
+      try body(element)
+    }
+  }
+}
+
+FilterTests.test("forEach/pushesThroughPipeline") {
+  let base = ForEachOnlySequence(elements: Array(0..<30))
+  var result: [Int] = []
+  base.lazy
+    .filter { $0 % 7 == 0 }
+    .map { $0 * 2 }
+    .flatMap { [$0, -$0] }
+    .forEach { result.append($0) }
+  expectEqual([0, 0, 14, -14, 28, -28, 42, -42, 56, -56], result)
+}
+
+FilterTests.test("forEach/rethrows") {
+  struct Stop : Error {}
+  var seen: [Int] = []
+  do {
+    try (0..<30).lazy.filter { $0 % 2 == 1 }.map { $0 * 10 }.forEach {
+      if $0 > 50 { throw Stop() }
+      seen.append($0)
+    }
+    expectUnreachable()
+  } catch {
+    expectTrue(error is Stop)
+  }
+  expectEqual([10, 30, 50], seen)
+}
+
 runAllTests()
@@ -164,6 +164,16 @@ PrintTests.test("Printable") {
   expectPrinted("1.25e-16", asFloat64(0.000000000000000125))
   expectPrinted("1.25e-17", asFloat64(0.0000000000000000125))
 
+  expectPrinted("0.0", asFloat32(0.0))
+  expectPrinted("-0.0", asFloat32(-0.0))
+  expectPrinted("-999999.0", asFloat32(-999999.0))
+  expectPrinted("1e+06", asFloat32(1000000.0))
+  expectPrinted("0.0", asFloat64(0.0))
+  expectPrinted("-0.0", asFloat64(-0.0))
+  expectPrinted("999999999999999.0", asFloat64(999999999999999.0))
+  expectPrinted("-999999999999999.0", asFloat64(-999999999999999.0))
+  expectPrinted("1e+15", asFloat64(1000000000000000.0))
+
 #if arch(i386) || arch(x86_64)
   expectPrinted("1.00000000000000001", asFloat80(1.00000000000000001))
   expectPrinted("1.25e+19", asFloat80(12500000000000000000.0))
@@ -232,6 +242,9 @@ PrintTests.test("Printable") {
   expectDebugPrinted("1.25e+17", asFloat64(125000000000000000.0))
   expectDebugPrinted("1.25", asFloat64(1.25))
   expectDebugPrinted("1.2500000000000001e-05", asFloat64(0.0000125))
+  expectDebugPrinted("16777216.0", asFloat32(16777216.0))
+  expectDebugPrinted("12345678901234568.0", asFloat64(12345678901234567.0))
+  expectDebugPrinted("-0.0", asFloat64(-0.0))
   expectDebugPrinted("inf", Double.infinity)
   expectDebugPrinted("-inf", -Double.infinity)
   expectDebugPrinted("nan", Double.nan)
@@ -65,6 +65,11 @@ PrintTests.test("Printable") {
   expectPrinted("0", Int(0))
   expectPrinted("42", Int(42))
   expectPrinted("-42", Int(-42))
+  expectPrinted("9", Int(9))
+  expectPrinted("10", Int(10))
+  expectPrinted("99", Int(99))
+  expectPrinted("100", Int(100))
+  expectPrinted("-1000000007", Int(-1000000007))
   
   if (UInt64(UInt.max) > 0x1_0000_0000 as UInt64) {
     expectPrinted("18446744073709551615", UInt.max)
@@ -0,0 +1,110 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+let SmallArrayTests = TestSuite("SmallArray")
+
+SmallArrayTests.test("append/acrossInlineCapacity") {
+  var a = SmallArray<Int>()
+  var expected: [Int] = []
+  for i in 0..<10 {
+    expectEqual(expected, Array(a))
+    a.append(i)
+    expected.append(i)
+    expectEqual(i + 1, a.count)
+    expectEqual(i, a[i])
+    expectEqual(i, a.last!)
+  }
+  expectEqual(expected, Array(a))
+}
+
+SmallArrayTests.test("subscript/set") {
+  for count in 1...6 {
+    var a = SmallArray(0..<count)
+    for i in 0..<count {
+      a[i] = 100 + i
+    }
+    expectEqual((0..<count).map { 100 + $0 }, Array(a))
+  }
+}
+
+SmallArrayTests.test("replaceSubrange") {
+  for count in 0...6 {
+    for lower in 0...count {
+      for upper in lower...count {
+        for newCount in 0...3 {
+          let newElements = (0..<newCount).map { -1 - $0 }
+          var a = SmallArray(0..<count)
+          var expected = Array(0..<count)
+          a.replaceSubrange(lower..<upper, with: newElements)
+          expected.replaceSubrange(lower..<upper, with: newElements)
+          expectEqual(expected, Array(a))
+        }
+      }
+    }
+  }
+}
+
+SmallArrayTests.test("valueSemantics") {
+  for count in [2, 8] {
+    var a = SmallArray(0..<count)
+    let b = a
+    a[0] = 42
+    a.append(7)
+    expectEqual(Array(0..<count), Array(b))
+    expectEqual(42, a[0])
+    expectEqual(count + 1, a.count)
+  }
+}
+
+SmallArrayTests.test("withUnsafeMutableBufferPointer") {
+  for count in 0...6 {
+    var a = SmallArray((0..<count).reversed())
+    a.withUnsafeMutableBufferPointer { buffer in
+      expectEqual(count, buffer.count)
+      for i in buffer.indices {
+        buffer[i] += 10
+      }
+    }
+    expectEqual((0..<count).reversed().map { $0 + 10 }, Array(a))
+
+    let sum = a.withUnsafeBufferPointer { $0.reduce(0, +) }
+    expectEqual(a.reduce(0, +), sum)
+  }
+}
+
+SmallArrayTests.test("sort") {
+  for count in 0...8 {
+    var a = SmallArray((0..<count).reversed())
+    a.sort()
+    expectEqual(Array(0..<count), Array(a))
+  }
+}
+
+SmallArrayTests.test("lifetimes") {
+  do {
+    var a: SmallArray<LifetimeTracked> = [LifetimeTracked(1), LifetimeTracked(2)]
+    a[1] = LifetimeTracked(3)
+    a.withUnsafeMutableBufferPointer { buffer in
+      buffer.sort { $0.value > $1.value }
+    }
+    for i in 4..<8 {
+      a.append(LifetimeTracked(i))
+    }
+    a.removeSubrange(1..<3)
+    expectEqual([3, 5, 6, 7], a.map { $0.value })
+    a.removeAll()
+  }
+  expectEqual(0, LifetimeTracked.instances)
+}
+
+SmallArrayTests.test("description") {
+  let a: SmallArray = [1, 2, 3]
+  expectEqual("[1, 2, 3]", a.description)
+  expectEqual("SmallArray([1, 2, 3])", a.debugDescription)
+  expectTrue(a == [1, 2, 3])
+  expectTrue(a != [1, 2])
+}
+
+runAllTests()
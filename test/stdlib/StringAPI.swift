@@ -98,6 +98,21 @@ let tests = [
   // U+2126 OHM SIGN
   // U+03A9 GREEK CAPITAL LETTER OMEGA
   ComparisonTest(.eq, "\u{2126}", "\u{03a9}"),
+  ComparisonTest(.eq, "\u{2126}\u{03bc}", "\u{03a9}\u{03bc}"),
+  ComparisonTest(.lt, "\u{03a9}", "\u{03a9}\u{03bc}"),
+
+  // U+037E GREEK QUESTION MARK
+  // U+003B SEMICOLON
+  ComparisonTest(.eq, "\u{37e}", ";"),
+  ComparisonTest(.eq, "\u{3b1}\u{37e}", "\u{3b1};"),
+
+  // U+0439 CYRILLIC SMALL LETTER SHORT I
+  // U+0438 CYRILLIC SMALL LETTER I
+  // U+0306 COMBINING BREVE
+  ComparisonTest(.eq,
+    "\u{43c}\u{43e}\u{439}", "\u{43c}\u{43e}\u{438}\u{306}"),
+  ComparisonTest(.lt, "\u{43c}\u{43e}\u{438}", "\u{43c}\u{43e}\u{439}"),
+  ComparisonTest(.eq, "\u{43c}\u{43e}\u{438}", "\u{43c}\u{43e}\u{438}"),
 
   // U+0323 COMBINING DOT BELOW
   // U+0307 COMBINING DOT ABOVE
@@ -28,6 +28,8 @@ namespace llvm {
 }
 namespace SourceKit {
 
+struct Statistic;
+
 struct EntityInfo {
   UIdent Kind;
   StringRef Name;
@@ -194,6 +196,13 @@ public:
 
   virtual bool needsSemanticInfo() { return true; }
 
+  /// If this returns true, only the semantic annotations that overlap the
+  /// byte range [Offset, Offset + Length) are reported, e.g. the part of the
+  /// document that the editor is showing.
+  virtual bool getSemanticAnnotationRange(unsigned &Offset, unsigned &Length) {
+    return false;
+  }
+
   virtual void handleRequestError(const char *Description) = 0;
 
   virtual bool handleSyntaxMap(unsigned Offset, unsigned Length,
@@ -360,6 +369,8 @@ public:
   virtual bool handleDiagnostic(const DiagnosticEntryInfo &Info) = 0;
 };
 
+typedef std::function<void(ArrayRef<Statistic *> Stats)> StatisticsReceiver;
+
 class LangSupport {
   virtual void anchor();
 
@@ -477,6 +488,9 @@ public:
                           StringRef ModuleName,
                           ArrayRef<const char *> Args,
                           DocInfoConsumer &Consumer) = 0;
+
+  /// Reports the service's counters and accumulated latencies.
+  virtual void getStatistics(StatisticsReceiver Receiver) = 0;
 };
 
 } // namespace SourceKit
@@ -0,0 +1,57 @@
+//===--- Statistic.h - Service statistics -----------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKIT_SUPPORT_STATISTIC_H
+#define LLVM_SOURCEKIT_SUPPORT_STATISTIC_H
+
+#include "SourceKit/Support/UIdent.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace SourceKit {
+
+/// A counter, or a total duration in microseconds, that is kept for the
+/// lifetime of the service and reported by the statistics request.
+struct Statistic {
+  const UIdent Name;
+  const std::string Description;
+  std::atomic<int64_t> Value{0};
+
+  Statistic(UIdent Name, std::string Description)
+    : Name(Name), Description(std::move(Description)) {}
+
+  int64_t operator++() { return ++Value; }
+  void add(int64_t Amount) { Value += Amount; }
+};
+
+/// Adds the time between its construction and destruction to a statistic.
+class StatisticTimer {
+  Statistic &Stat;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  explicit StatisticTimer(Statistic &Stat)
+    : Stat(Stat), Start(std::chrono::steady_clock::now()) {}
+
+  ~StatisticTimer() {
+    Stat.add(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - Start).count());
+  }
+
+  StatisticTimer(const StatisticTimer &) = delete;
+  StatisticTimer &operator=(const StatisticTimer &) = delete;
+};
+
+} // namespace SourceKit
+
+#endif
@@ -191,6 +191,12 @@ double FuzzyStringMatcher::scoreCandidate(StringRef candidate) const {
   // FIXME: path separators would be handled here, jumping straight to the last
   // component if the pattern doesn't contain a separator.
 
+  // A candidate that doesn't contain the pattern as a subsequence always
+  // scores zero.  Checking that is a single pass without allocation, which is
+  // much cheaper than building the tables below.
+  if (!matchesCandidate(candidate))
+    return finalScore;
+
   unsigned firstPatternPos = 0;
   CandidateSpecificMatcher CSM(pattern, lowercasePattern, candidate,
                                charactersInPattern, firstPatternPos);
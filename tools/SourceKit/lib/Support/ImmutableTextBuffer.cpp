@@ -125,6 +125,8 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   CurrUpd = Root;
 }
 
+EditableTextBuffer::~EditableTextBuffer() = default;
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -198,33 +200,53 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
-  // Check if a buffer was created in the middle of the snapshot updates.
-  ImmutableTextBufferRef StartBuf = Snap.BufferStart;
-  ImmutableTextUpdateRef Upd = StartBuf;  
-  while (Upd != Snap.DiffEnd) {
+  llvm::sys::ScopedLock RL(RopeMtx);
+
+  // Another thread may have created the buffer while we were waiting.
+  Next = Snap.DiffEnd->Next;
+  if (Next)
+    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
+      return Buf;
+
+  // If the snapshot comes after the text that the rope holds, only the
+  // updates in between need to be applied.
+  ImmutableTextUpdateRef Upd = RopeUpd;
+  while (Upd && Upd != Snap.DiffEnd)
     Upd = Upd->Next;
-    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
-      StartBuf = Buf;
+
+  if (Upd) {
+    Upd = RopeUpd;
+  } else {
+    // Check if a buffer was created in the middle of the snapshot updates.
+    ImmutableTextBufferRef StartBuf = Snap.BufferStart;
+    Upd = StartBuf;
+    while (Upd != Snap.DiffEnd) {
+      Upd = Upd->Next;
+      if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
+        StartBuf = Buf;
+    }
+    StringRef StartText = StartBuf->getText();
+
+    Rope.reset(new RewriteRope);
+    Rope->assign(StartText.begin(), StartText.end());
+    Upd = StartBuf;
   }
-  StringRef StartText = StartBuf->getText();
 
-  RewriteRope Rope;
   auto applyUpdate = [&](const ImmutableTextUpdateRef &Upd) {
     if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
-      Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+      Rope->erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
       StringRef Text = ReplaceUpd->getText();
-      Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+      Rope->insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
     }
   };
 
-  Rope.assign(StartText.begin(), StartText.end());
-  Upd = StartBuf;
   while (Upd != Snap.DiffEnd) {
     Upd = Upd->Next;
     applyUpdate(Upd);
   }
+  RopeUpd = Snap.DiffEnd;
 
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
+  auto MemBuf = getMemBufferFromRope(getFilename(), *Rope);
   ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
                                                           Snap.getStamp());
 
@@ -216,7 +216,8 @@ public:
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, Options options,
                                 const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *nameMatches);
 
   void sort(Options options);
 
@@ -291,9 +292,10 @@ void CodeCompletionOrganizer::preSortCompletions(
 
 void CodeCompletionOrganizer::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *nameMatches) {
   impl.addCompletionsWithFilter(completions, filterText, options, rules,
-                                exactMatch);
+                                exactMatch, nameMatches);
 }
 
 void CodeCompletionOrganizer::groupAndSort(const Options &options) {
@@ -508,7 +510,8 @@ bool FilterRules::hideCompletion(SwiftResult *completion, StringRef name, void *
 
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *nameMatches) {
   assert(rootGroup);
 
   auto &contents = rootGroup->contents;
@@ -596,6 +599,9 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
       match = completion->getName().startswith_lower(filterText);
     }
 
+    if (match && nameMatches)
+      nameMatches->push_back(completion);
+
     bool isExactMatch = match && completion->getName().equals_lower(filterText);
 
     if (isExactMatch) {
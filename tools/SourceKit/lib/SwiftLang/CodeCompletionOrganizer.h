@@ -83,10 +83,16 @@ public:
   /// Add \p completions to the organizer, removing any results that don't match
   /// \p filterText and returning \p exactMatch if there is an exact match.
   ///
+  /// If \p nameMatches is non-null and \p filterText is non-empty, it receives
+  /// the completions whose names matched \p filterText, in their original
+  /// order, including an exact match that is not added to the results.
+  ///
   /// Precondition: \p completions should be sorted with preSortCompletions().
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *nameMatches =
+                                    nullptr);
 
   void groupAndSort(const Options &options);
 
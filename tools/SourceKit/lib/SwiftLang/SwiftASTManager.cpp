@@ -20,9 +20,12 @@
 #include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/Tracing.h"
 
+#include "swift/AST/ASTWalker.h"
+#include "swift/AST/Stmt.h"
 #include "swift/Basic/Cache.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
+#include "swift/Parse/Token.h"
 #include "swift/Strings.h"
 #include "swift/Subsystems.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -34,6 +37,9 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
+#include <algorithm>
+#include <chrono>
+
 using namespace SourceKit;
 using namespace swift;
 using namespace swift::sys;
@@ -155,13 +161,23 @@ void InvocationOptions::profile(llvm::FoldingSetNodeID &ID) const {
 
 namespace SourceKit {
   struct ASTUnit::Implementation {
-    const uint64_t Generation;
+    uint64_t Generation;
     SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
     EditorDiagConsumer CollectDiagConsumer;
     CompilerInstance CompInst;
     OwnedResolver TypeResolver{ nullptr, nullptr };
     WorkQueue Queue{ WorkQueue::Dequeuing::Serial, "sourcekit.swift.ConsumeAST" };
 
+    /// The buffer holding the text of the primary file that the AST reflects.
+    unsigned PrimaryBufferID = 0;
+    /// The diagnostics emitted in the primary file by parsing and
+    /// type-checking. Unlike the SIL diagnostics, these are kept for the
+    /// function bodies that weren't reparsed.
+    std::vector<DiagnosticEntryInfo> SemaDiags;
+    /// The number of function bodies that were reparsed since the AST was
+    /// built.
+    unsigned NumReparsedBodies = 0;
+
     Implementation(uint64_t Generation) : Generation(Generation) {}
 
     void consumeAsync(SwiftASTConsumerRef ASTConsumer, ASTUnitRef ASTRef);
@@ -174,7 +190,14 @@ namespace SourceKit {
 
       CompilerInstance &CI = ASTRef->getCompilerInstance();
 
-      if (CI.getPrimarySourceFile()) {
+      if (ASTConsumer.isStale()) {
+        // Superseded while waiting behind other consumers of this AST.
+        ConsumerRef->cancelled();
+      } else if (ASTRef->hasReparsedFunctionBodies() &&
+          !ASTConsumer.canUseASTWithReparsedFunctionBodies()) {
+        // A function body was reparsed after the AST was handed out.
+        ConsumerRef->failed("AST changed before it could be used");
+      } else if (CI.getPrimarySourceFile()) {
         ASTConsumer.handlePrimaryAST(ASTRef);
       } else {
         LOG_WARN_FUNC("did not find primary SourceFile");
@@ -210,6 +233,24 @@ namespace SourceKit {
     return Impl.CollectDiagConsumer;
   }
 
+  bool ASTUnit::hasReparsedFunctionBodies() const {
+    return Impl.NumReparsedBodies != 0;
+  }
+
+  unsigned ASTUnit::getPrimaryBufferID() const {
+    return Impl.PrimaryBufferID;
+  }
+
+  Optional<unsigned> ASTUnit::getPrimaryFileOffset(SourceLoc Loc) const {
+    if (Loc.isInvalid())
+      return None;
+    SourceManager &SM = Impl.CompInst.getSourceMgr();
+    Loc = Impl.CollectDiagConsumer.getLatestLoc(SM, Loc);
+    if (!SM.getRangeForBuffer(Impl.PrimaryBufferID).contains(Loc))
+      return None;
+    return SM.getLocOffsetInBuffer(Loc, Impl.PrimaryBufferID);
+  }
+
   void ASTUnit::performAsync(std::function<void()> Fn) {
     Impl.Queue.dispatch(std::move(Fn));
   }
@@ -258,6 +299,7 @@ public:
 
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
+  bool canQueuedConsumersUseReparsedBodies();
 
   size_t getMemoryCost() const {
     // FIXME: Report the memory cost of the overall CompilerInstance.
@@ -274,6 +316,17 @@ private:
   ASTUnitRef createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                            std::string &Error);
+
+  /// Tries to bring the existing AST up to date by reparsing the single
+  /// function body that changed in the primary file.
+  ///
+  /// \returns false if the AST needs to be rebuilt instead.
+  bool reparseFunctionBody(SwiftASTManager::Implementation &MgrImpl,
+                           ArrayRef<ImmutableTextSnapshotRef> Snapshots);
+
+  void getInputStamps(SwiftASTManager::Implementation &MgrImpl,
+                      ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                      SmallVectorImpl<BufferStamp> &InputStamps);
 };
 
 typedef IntrusiveRefCntPtr<ASTProducer> ASTProducerRef;
@@ -306,10 +359,21 @@ struct CacheKeyHashInfo<ASTKey> {
 struct SwiftASTManager::Implementation {
   explicit Implementation(SwiftLangSupport &LangSupport)
     : EditorDocs(LangSupport.getEditorDocuments()),
-      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) { }
+      Stats(LangSupport.getStats()),
+      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()),
+      ReparseFunctionBodies(::getenv("SOURCEKIT_REPARSE_FUNCTION_BODIES")) {
+    // Cap the memory used by cached ASTs; the least recently used ones are
+    // evicted first.
+    if (const char *LimitMB = ::getenv("SOURCEKIT_AST_CACHE_LIMIT_MB"))
+      ASTCache.setCostLimit(size_t(std::strtoull(LimitMB, nullptr, 10)) << 20);
+  }
 
   SwiftEditorDocumentFileMap &EditorDocs;
+  SwiftStatistics &Stats;
   std::string RuntimeResourcePath;
+  /// Whether an edit inside a single function body of the primary file is
+  /// handled by reparsing that body instead of rebuilding the AST.
+  const bool ReparseFunctionBodies;
   SourceManager SourceMgr;
   Cache<ASTKey, ASTProducerRef> ASTCache{ "sourcekit.swift.ASTCache" };
   llvm::sys::Mutex CacheMtx;
@@ -469,32 +533,102 @@ SwiftASTManager::getInvocation(ArrayRef<const char *> OrigArgs,
       *new SwiftInvocation::Implementation(std::move(Opts)));
 }
 
+namespace {
+/// Forwards to another consumer, recording how long it waited for its AST
+/// and how long it took to handle it.
+class TimedASTConsumer : public SwiftASTConsumer {
+  SwiftASTConsumerRef Consumer;
+  SwiftStatistics &Stats;
+  std::chrono::steady_clock::time_point QueuedAt;
+
+public:
+  TimedASTConsumer(SwiftASTConsumerRef Consumer, SwiftStatistics &Stats)
+    : Consumer(std::move(Consumer)), Stats(Stats),
+      QueuedAt(std::chrono::steady_clock::now()) {}
+
+  void cancelled() override {
+    ++Stats.numASTConsumersCancelled;
+    Consumer->cancelled();
+  }
+  Priority getPriority() override {
+    return Consumer->getPriority();
+  }
+  bool isStale() override {
+    return Consumer->isStale();
+  }
+  bool canUseASTWithSnapshots(
+      ArrayRef<ImmutableTextSnapshotRef> Snapshots) override {
+    return Consumer->canUseASTWithSnapshots(Snapshots);
+  }
+  bool canUseASTWithReparsedFunctionBodies() override {
+    return Consumer->canUseASTWithReparsedFunctionBodies();
+  }
+  void failed(StringRef Error) override {
+    Consumer->failed(Error);
+  }
+  void handlePrimaryAST(ASTUnitRef AstUnit) override {
+    Stats.totalASTQueueWaitUS.add(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - QueuedAt).count());
+    ++Stats.numASTConsumers;
+    StatisticTimer Timer(Stats.totalASTConsumerUS);
+    Consumer->handlePrimaryAST(std::move(AstUnit));
+  }
+};
+} // end anonymous namespace
+
+static void consumeQueuedAsync(SwiftASTManager::Implementation &MgrImpl,
+                               ASTProducerRef Producer,
+                               ArrayRef<ImmutableTextSnapshotRef> Snaps) {
+  SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+  Snapshots.append(Snaps.begin(), Snaps.end());
+
+  Producer->getASTUnitAsync(MgrImpl, Snapshots,
+    [&MgrImpl, Producer, Snapshots](ASTUnitRef Unit, StringRef Error) {
+      auto Consumers = Producer->popQueuedConsumers();
+
+      bool NeedsFullAST = false;
+      for (auto &Consumer : Consumers) {
+        if (Consumer->isStale()) {
+          Consumer->cancelled();
+        } else if (!Unit) {
+          Consumer->failed(Error);
+        } else if (Unit->hasReparsedFunctionBodies() &&
+                   !Consumer->canUseASTWithReparsedFunctionBodies()) {
+          // The consumer was queued after the AST was updated; get it an AST
+          // that was built from scratch.
+          Producer->enqueueConsumer(std::move(Consumer), nullptr);
+          NeedsFullAST = true;
+        } else {
+          Unit->Impl.consumeAsync(std::move(Consumer), Unit);
+        }
+      }
+
+      if (NeedsFullAST)
+        consumeQueuedAsync(MgrImpl, Producer, Snapshots);
+    });
+}
+
 void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
                                       SwiftASTConsumerRef ASTConsumer,
                                       const void *OncePerASTToken,
                                  ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
   ASTProducerRef Producer = Impl.getASTProducer(InvokRef);
+  ASTConsumer = std::make_shared<TimedASTConsumer>(std::move(ASTConsumer),
+                                                   Impl.Stats);
 
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
-    if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
+    if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots()) &&
+        (!Unit->hasReparsedFunctionBodies() ||
+         ASTConsumer->canUseASTWithReparsedFunctionBodies())) {
+      ++Impl.Stats.numASTCacheHits;
       Unit->Impl.consumeAsync(std::move(ASTConsumer), Unit);
       return;
     }
   }
 
   Producer->enqueueConsumer(std::move(ASTConsumer), OncePerASTToken);
-
-  Producer->getASTUnitAsync(Impl, Snapshots,
-    [Producer](ASTUnitRef Unit, StringRef Error) {
-      auto Consumers = Producer->popQueuedConsumers();
-
-      for (auto &Consumer : Consumers) {
-        if (Unit)
-          Unit->Impl.consumeAsync(std::move(Consumer), Unit);
-        else
-          Consumer->failed(Error);
-      }
-    });
+  consumeQueuedAsync(Impl, Producer, Snapshots);
 }
 
 void SwiftASTManager::removeCachedAST(SwiftInvocationRef Invok) {
@@ -578,25 +712,43 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
 ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                                    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                    std::string &Error) {
-  if (!AST || shouldRebuild(MgrImpl, Snapshots)) {
+  // Consumers that don't handle reparsed function bodies need an AST that was
+  // built from scratch.
+  bool CanUseReparsedBodies = canQueuedConsumersUseReparsedBodies();
+  bool NeedsFullAST = AST && AST->hasReparsedFunctionBodies() &&
+                      !CanUseReparsedBodies;
+
+  if (!AST || NeedsFullAST || shouldRebuild(MgrImpl, Snapshots)) {
+    ++MgrImpl.Stats.numASTCacheMisses;
+    StatisticTimer Timer(MgrImpl.Stats.totalASTBuildUS);
     bool IsRebuild = AST != nullptr;
     const InvocationOptions &Opts = InvokRef->Impl.Opts;
 
+    bool Reparsed = IsRebuild && !NeedsFullAST && CanUseReparsedBodies &&
+                    MgrImpl.ReparseFunctionBodies &&
+                    reparseFunctionBody(MgrImpl, Snapshots);
+
     LOG_FUNC_SECTION(InfoHighPrio) {
       Log->getOS() << "AST build (";
-      if (IsRebuild)
+      if (Reparsed)
+        Log->getOS() << "function body";
+      else if (IsRebuild)
         Log->getOS() << "rebuild";
       else
         Log->getOS() << "first";
       Log->getOS() << "): ";
       Log->getOS() << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile;
+      Log->getOS() << " (cached ASTs evicted so far: "
+                   << MgrImpl.ASTCache.getEvictionCount() << ")";
     }
 
-    auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
-    {
-      // FIXME: ThreadSafeRefCntPtr is racy.
-      llvm::sys::ScopedLock L(Mtx);
-      AST = NewAST;
+    if (!Reparsed) {
+      auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+      {
+        // FIXME: ThreadSafeRefCntPtr is racy.
+        llvm::sys::ScopedLock L(Mtx);
+        AST = NewAST;
+      }
     }
 
     {
@@ -605,6 +757,8 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       ASTProducerRef ThisProducer = this;
       MgrImpl.ASTCache.set(InvokRef->Impl.Key, ThisProducer);
     }
+  } else {
+    ++MgrImpl.Stats.numASTCacheHits;
   }
 
   return AST;
@@ -633,15 +787,30 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   for (auto &C : QueuedConsumers)
     Consumers.push_back(std::move(C.first));
   QueuedConsumers.clear();
+  // Consumers are dispatched serially on the AST's queue in this order, so
+  // make sure interactive requests are not stuck behind background ones.
+  std::stable_sort(Consumers.begin(), Consumers.end(),
+                   [](const SwiftASTConsumerRef &LHS,
+                      const SwiftASTConsumerRef &RHS) {
+    return LHS->getPriority() < RHS->getPriority();
+  });
   return Consumers;
 }
 
-bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
-                                ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+bool ASTProducer::canQueuedConsumersUseReparsedBodies() {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto &C : QueuedConsumers) {
+    if (!C.first->canUseASTWithReparsedFunctionBodies())
+      return false;
+  }
+  return true;
+}
+
+void ASTProducer::getInputStamps(SwiftASTManager::Implementation &MgrImpl,
+                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                                 SmallVectorImpl<BufferStamp> &InputStamps) {
   const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
 
-  // Check if the inputs changed.
-  SmallVector<BufferStamp, 8> InputStamps;
   InputStamps.reserve(Invok.Opts.Invok.getInputFilenames().size());
   for (auto &File : Invok.Opts.Invok.getInputFilenames()) {
     bool FoundSnapshot = false;
@@ -656,6 +825,13 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
       InputStamps.push_back(MgrImpl.getBufferStamp(File));
   }
   assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
+}
+
+bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
+                                ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+  // Check if the inputs changed.
+  SmallVector<BufferStamp, 8> InputStamps;
+  getInputStamps(MgrImpl, Snapshots, InputStamps);
   if (Stamps != InputStamps)
     return true;
 
@@ -721,6 +897,7 @@ static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                       std::string &Error) {
+  ++MgrImpl.Stats.numASTBuilds;
   Stamps.clear();
   DependencyStamps.clear();
 
@@ -797,7 +974,17 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
-  CompIns.performSema();
+  {
+    StatisticTimer Timer(MgrImpl.Stats.totalTypeCheckUS);
+    CompIns.performSema();
+  }
+
+  if (auto SF = CompIns.getPrimarySourceFile()) {
+    ASTRef->Impl.PrimaryBufferID = SF->getBufferID().getValue();
+    ArrayRef<DiagnosticEntryInfo> Diags =
+        Consumer.getDiagnosticsForBuffer(ASTRef->Impl.PrimaryBufferID);
+    ASTRef->Impl.SemaDiags.assign(Diags.begin(), Diags.end());
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -842,3 +1029,346 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
 
   return ASTRef;
 }
+
+//===----------------------------------------------------------------------===//
+// Function body reparsing
+//===----------------------------------------------------------------------===//
+
+/// The number of function bodies that are reparsed before the AST is rebuilt,
+/// since the text of the replaced bodies stays in the SourceManager.
+static const unsigned MaxReparsedFunctionBodies = 32;
+
+namespace {
+/// Finds the function whose body encloses the given range of the primary
+/// file, not counting its braces.
+class FunctionBodyFinder : public ASTWalker {
+  EditorDiagConsumer &Consumer;
+  SourceManager &SM;
+  unsigned BufferID;
+  unsigned EditStart;
+  unsigned EditEnd;
+
+public:
+  FuncDecl *Found = nullptr;
+  unsigned BodyStart = 0;
+  unsigned BodyEnd = 0;
+
+  FunctionBodyFinder(EditorDiagConsumer &Consumer, SourceManager &SM,
+                     unsigned BufferID, unsigned EditStart, unsigned EditEnd)
+    : Consumer(Consumer), SM(SM), BufferID(BufferID), EditStart(EditStart),
+      EditEnd(EditEnd) {}
+
+  bool walkToDeclPre(Decl *D) override {
+    if (Found)
+      return false;
+    if (auto *FD = dyn_cast<FuncDecl>(D)) {
+      checkFunction(FD);
+      return false;
+    }
+    // Look inside types, but not in the bodies of functions, variables or
+    // top-level code, or in '#if' blocks.
+    return isa<NominalTypeDecl>(D) || isa<ExtensionDecl>(D);
+  }
+
+private:
+  void checkFunction(FuncDecl *FD) {
+    if (FD->isAccessor())
+      return;
+    BraceStmt *Body = FD->getBody(/*canSynthesize=*/false);
+    if (!Body || Body->getLBraceLoc().isInvalid() ||
+        Body->getRBraceLoc().isInvalid())
+      return;
+
+    CharSourceRange Buffer = SM.getRangeForBuffer(BufferID);
+    SourceLoc LBrace = Consumer.getLatestLoc(SM, Body->getLBraceLoc());
+    SourceLoc RBrace = Consumer.getLatestLoc(SM, Body->getRBraceLoc());
+    if (!Buffer.contains(LBrace) || !Buffer.contains(RBrace))
+      return;
+
+    unsigned Start = SM.getLocOffsetInBuffer(LBrace, BufferID);
+    unsigned End = SM.getLocOffsetInBuffer(RBrace, BufferID) + 1;
+    if (Start < EditStart && EditEnd < End) {
+      Found = FD;
+      BodyStart = Start;
+      BodyEnd = End;
+    }
+  }
+};
+} // anonymous namespace.
+
+/// Returns true if the body of \p FD can be reparsed and type-checked on its
+/// own, without affecting the rest of the AST.
+static bool canReparseFunctionBody(FuncDecl *FD, SourceFile &SF) {
+  if (!FD->isBodyTypeChecked())
+    return false;
+
+  // Default arguments are checked along with the body.
+  for (auto *Params : FD->getParameterLists()) {
+    for (auto *Param : *Params) {
+      if (Param->getDefaultValue())
+        return false;
+    }
+  }
+
+  // The type refinement contexts of the file would have to be rebuilt.
+  for (DeclContext *DC = FD; !DC->isModuleScopeContext();
+       DC = DC->getParent()) {
+    if (auto *D = DC->getInnermostDeclarationDeclContext())
+      if (D->getAttrs().hasAttribute<AvailableAttr>())
+        return false;
+  }
+
+  // Local types are recorded in the SourceFile.
+  for (auto *TD : SF.LocalTypeDecls) {
+    for (DeclContext *DC = TD->getDeclContext(); DC; DC = DC->getParent()) {
+      if (DC == FD)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/// Returns true if \p Tokens form a single brace statement, ending at
+/// \p EndOffset.
+static bool isSingleBraceStmt(ArrayRef<Token> Tokens, SourceManager &SM,
+                              unsigned BufferID, unsigned EndOffset) {
+  unsigned Depth = 0;
+  for (unsigned i = 0, e = Tokens.size(); i != e; ++i) {
+    const Token &Tok = Tokens[i];
+    if (Tok.is(tok::l_brace)) {
+      ++Depth;
+    } else if (Tok.is(tok::r_brace)) {
+      if (Depth == 0)
+        return false;
+      if (--Depth == 0)
+        return i + 1 == e &&
+               SM.getLocOffsetInBuffer(Tok.getLoc(), BufferID) + 1 == EndOffset;
+    } else if (Depth == 0) {
+      return false;
+    }
+  }
+  return false;
+}
+
+/// Moves \p Offset from the old buffer of \p Range to the new one.
+///
+/// \returns false if the text from \p Offset to \p Offset + \p Length overlaps
+/// the replaced range.
+static bool adjustOffset(unsigned &Offset, unsigned Length,
+                         const ReplacedBufferRange &Range) {
+  if (Offset < Range.Offset && Offset + Length <= Range.Offset)
+    return true;
+  if (Offset >= Range.Offset + Range.OldLength) {
+    Offset = Offset - Range.OldLength + Range.NewLength;
+    return true;
+  }
+  return false;
+}
+
+static bool adjustDiagnostic(DiagnosticEntryInfoBase &Diag,
+                             const ReplacedBufferRange &Range,
+                             SourceManager &SM) {
+  if (!adjustOffset(Diag.Offset, 0, Range))
+    return false;
+  for (auto &R : Diag.Ranges) {
+    if (!adjustOffset(R.first, R.second, Range))
+      return false;
+  }
+  for (auto &F : Diag.Fixits) {
+    if (!adjustOffset(F.Offset, F.Length, Range))
+      return false;
+  }
+  std::tie(Diag.Line, Diag.Column) = SM.getLineAndColumn(
+      SM.getLocForOffset(Range.NewBufferID, Diag.Offset), Range.NewBufferID);
+  return true;
+}
+
+/// Returns the diagnostics of \p Diags that still apply after \p Range was
+/// replaced, with their locations moved to the new buffer.
+static std::vector<DiagnosticEntryInfo>
+adjustDiagnostics(ArrayRef<DiagnosticEntryInfo> Diags,
+                  const ReplacedBufferRange &Range, SourceManager &SM) {
+  StringRef Filename = SM.getIdentifierForBuffer(Range.OldBufferID);
+  std::vector<DiagnosticEntryInfo> Result;
+  for (auto Diag : Diags) {
+    if (!adjustDiagnostic(Diag, Range, SM))
+      continue;
+    bool Keep = true;
+    for (auto &Note : Diag.Notes) {
+      if (Note.Filename == Filename && !adjustDiagnostic(Note, Range, SM)) {
+        Keep = false;
+        break;
+      }
+    }
+    if (Keep)
+      Result.push_back(std::move(Diag));
+  }
+  return Result;
+}
+
+/// Replaces the snapshot in \p Impl that is for the same file as \p Snap.
+static void updateSnapshot(ASTUnit::Implementation &Impl,
+                           ImmutableTextSnapshotRef Snap) {
+  if (!Snap)
+    return;
+  for (auto &Existing : Impl.Snapshots) {
+    if (Existing->getFilename() == Snap->getFilename()) {
+      Existing = std::move(Snap);
+      return;
+    }
+  }
+  Impl.Snapshots.push_back(std::move(Snap));
+}
+
+/// Replaces the body of the function that encloses the only change between
+/// the primary file of \p Impl and \p Content, and type-checks it again.
+///
+/// \returns false if the AST needs to be rebuilt instead. The AST is left
+/// unchanged unless the function was found and its new body is a single
+/// brace statement.
+static bool reparseFunctionBodyInAST(ASTUnit::Implementation &Impl,
+                                     FileContent &Content) {
+  CompilerInstance &CompIns = Impl.CompInst;
+  SourceFile *SF = CompIns.getPrimarySourceFile();
+  if (!SF || Impl.NumReparsedBodies >= MaxReparsedFunctionBodies)
+    return false;
+
+  ASTContext &Ctx = CompIns.getASTContext();
+  SourceManager &SM = CompIns.getSourceMgr();
+  EditorDiagConsumer &Consumer = Impl.CollectDiagConsumer;
+  unsigned OldBufferID = Impl.PrimaryBufferID;
+
+  StringRef OldText = SM.extractText(SM.getRangeForBuffer(OldBufferID));
+  StringRef NewText = Content.Buffer->getBuffer();
+  if (OldText == NewText) {
+    // Edits that cancelled each other out.
+    updateSnapshot(Impl, Content.Snapshot);
+    Impl.Generation = ++ASTUnitGeneration;
+    return true;
+  }
+
+  // Find the range of text that changed.
+  unsigned MaxCommon = std::min(OldText.size(), NewText.size());
+  unsigned Prefix = 0;
+  while (Prefix < MaxCommon && OldText[Prefix] == NewText[Prefix])
+    ++Prefix;
+  unsigned Suffix = 0;
+  while (Suffix < MaxCommon - Prefix &&
+         OldText[OldText.size() - Suffix - 1] ==
+           NewText[NewText.size() - Suffix - 1])
+    ++Suffix;
+
+  FunctionBodyFinder Finder(Consumer, SM, OldBufferID, Prefix,
+                            OldText.size() - Suffix);
+  SF->walk(Finder);
+  FuncDecl *FD = Finder.Found;
+  if (!FD || !canReparseFunctionBody(FD, *SF))
+    return false;
+
+  unsigned BodyStart = Finder.BodyStart;
+  unsigned OldBodyEnd = Finder.BodyEnd;
+  unsigned NewBodyEnd = OldBodyEnd - OldText.size() + NewText.size();
+  // The type refinement contexts of the file would have to be rebuilt.
+  if (OldText.slice(BodyStart, OldBodyEnd).find("#available") !=
+        StringRef::npos ||
+      NewText.slice(BodyStart, NewBodyEnd).find("#available") !=
+        StringRef::npos)
+    return false;
+
+  unsigned NewBufferID = SM.addNewSourceBuffer(std::move(Content.Buffer));
+  auto Tokens = tokenize(Ctx.LangOpts, SM, NewBufferID,
+                         BodyStart, NewBodyEnd, /*KeepComments=*/false,
+                         /*TokenizeInterpolatedString=*/false);
+  if (!isSingleBraceStmt(Tokens, SM, NewBufferID, NewBodyEnd))
+    return false;
+
+  ReplacedBufferRange Range{ OldBufferID, NewBufferID, BodyStart,
+                             OldBodyEnd - BodyStart, NewBodyEnd - BodyStart };
+  auto Diags = adjustDiagnostics(Impl.SemaDiags, Range, SM);
+  Consumer.addReplacedBufferRange(Range);
+  Consumer.setDiagnosticsForBuffer(OldBufferID, {});
+  Consumer.setDiagnosticsForBuffer(NewBufferID, std::move(Diags));
+  Impl.PrimaryBufferID = NewBufferID;
+
+  // The TypeChecker sets up its own lazy resolver.
+  Impl.TypeResolver.reset();
+  bool NeedsRebuild;
+  {
+    CloseClangModuleFiles scopedCloseFiles(*Ctx.getClangModuleLoader());
+    NeedsRebuild = reparseAbstractFunctionBody(FD, NewBufferID, BodyStart,
+                                               NewBodyEnd);
+    if (!NeedsRebuild)
+      typeCheckAbstractFunctionBody(FD);
+  }
+
+  ArrayRef<DiagnosticEntryInfo> NewDiags =
+      Consumer.getDiagnosticsForBuffer(NewBufferID);
+  Impl.SemaDiags.assign(NewDiags.begin(), NewDiags.end());
+
+  if (!NeedsRebuild && !Consumer.hadAnyError()) {
+    // If the AST had errors before, the decls that SILGen needs may not have
+    // been fully validated, so start over.
+    if (Ctx.hadError()) {
+      NeedsRebuild = true;
+    } else {
+      SILOptions SILOpts;
+      std::unique_ptr<SILModule> SILMod = performSILGeneration(*SF, SILOpts);
+      runSILDiagnosticPasses(*SILMod);
+    }
+  }
+
+  Impl.TypeResolver = createLazyResolver(Ctx);
+
+  updateSnapshot(Impl, Content.Snapshot);
+  Impl.Generation = ++ASTUnitGeneration;
+  ++Impl.NumReparsedBodies;
+  return !NeedsRebuild;
+}
+
+bool ASTProducer::reparseFunctionBody(
+    SwiftASTManager::Implementation &MgrImpl,
+    ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+  const InvocationOptions &Opts = InvokRef->Impl.Opts;
+  unsigned PrimaryIndex = Opts.Invok.getFrontendOptions().PrimaryInput->Index;
+
+  // Only the primary file may have changed.
+  for (auto &Dependency : DependencyStamps) {
+    if (Dependency.second != MgrImpl.getBufferStamp(Dependency.first))
+      return false;
+  }
+  SmallVector<BufferStamp, 8> InputStamps;
+  getInputStamps(MgrImpl, Snapshots, InputStamps);
+  for (unsigned i = 0, e = InputStamps.size(); i != e; ++i) {
+    if (i != PrimaryIndex && InputStamps[i] != Stamps[i])
+      return false;
+  }
+
+  const std::string &File = Opts.Invok.getInputFilenames()[PrimaryIndex];
+  FileContent Content(nullptr, nullptr, 0);
+  bool FoundSnapshot = false;
+  for (auto &Snap : Snapshots) {
+    if (Snap->getFilename() == File) {
+      FoundSnapshot = true;
+      Content = getFileContentFromSnap(Snap, File);
+      break;
+    }
+  }
+  if (!FoundSnapshot) {
+    std::string Error;
+    Content = MgrImpl.getFileContent(File, Error);
+    if (!Content.Buffer)
+      return false;
+  }
+
+  bool Reparsed = false;
+  ASTUnitRef Unit = AST;
+  Unit->Impl.Queue.dispatchSync([&] {
+    Reparsed = reparseFunctionBodyInAST(Unit->Impl, Content);
+  }, /*isStackDeep=*/true);
+  if (!Reparsed)
+    return false;
+
+  Stamps[PrimaryIndex] = Content.Stamp;
+  return true;
+}
@@ -29,6 +29,7 @@ namespace swift {
   class CompilerInvocation;
   class DiagnosticEngine;
   class SourceFile;
+  class SourceLoc;
   class SourceManager;
 }
 
@@ -57,6 +58,22 @@ public:
   EditorDiagConsumer &getEditorDiagConsumer() const;
   swift::SourceFile &getPrimarySourceFile() const;
 
+  /// Returns true if function bodies in the primary file were parsed again
+  /// from newer text of the file, so that parts of the AST refer to different
+  /// buffers.
+  bool hasReparsedFunctionBodies() const;
+
+  /// Returns the buffer that holds the text of the primary file that the AST
+  /// reflects.
+  ///
+  /// This is the primary SourceFile's buffer, unless function bodies were
+  /// reparsed.
+  unsigned getPrimaryBufferID() const;
+
+  /// Returns the offset of \p Loc in the buffer returned by
+  /// getPrimaryBufferID(), or None if \p Loc isn't in the primary file.
+  Optional<unsigned> getPrimaryFileOffset(swift::SourceLoc Loc) const;
+
   /// Perform \p Fn asynchronously while preventing concurrent access to the
   /// AST.
   void performAsync(std::function<void()> Fn);
@@ -66,8 +83,28 @@ typedef IntrusiveRefCntPtr<ASTUnit> ASTUnitRef;
 
 class SwiftASTConsumer {
 public:
+  /// The order in which consumers waiting on the same AST are handed it.
+  /// Lower values go first.
+  enum class Priority {
+    /// Requests that the user is actively waiting on, like cursor info.
+    Interactive,
+    Default,
+    /// Requests whose results are only needed eventually, like semantic
+    /// annotations and diagnostics.
+    Background,
+  };
+
   virtual ~SwiftASTConsumer() { }
   virtual void cancelled() {}
+  virtual Priority getPriority() {
+    return Priority::Default;
+  }
+  /// Returns true if the result of this consumer is no longer needed, e.g.
+  /// because a newer request for the same document superseded it. Stale
+  /// consumers are cancelled instead of being handed the AST.
+  virtual bool isStale() {
+    return false;
+  }
   /// If there is an existing AST, this is called before trying to update it.
   /// Consumers may choose to still accept it even though it may have stale parts.
   ///
@@ -77,6 +114,14 @@ public:
       ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
     return false;
   }
+  /// Returns true if the consumer can handle an AST whose function bodies
+  /// were reparsed after an edit, see ASTUnit::hasReparsedFunctionBodies().
+  ///
+  /// Such consumers must map locations in the primary file with
+  /// ASTUnit::getPrimaryFileOffset().
+  virtual bool canUseASTWithReparsedFunctionBodies() {
+    return false;
+  }
   virtual void failed(StringRef Error);
   virtual void handlePrimaryAST(ASTUnitRef AstUnit) = 0;
 };
@@ -110,6 +110,9 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                                   ArrayRef<const char *> Args,
                                   std::string &Error) {
 
+  ++Lang.getStats().numCodeCompletions;
+  StatisticTimer Timer(Lang.getStats().totalCodeCompletionUS);
+
   trace::TracedOperation TracedOp;
   if (trace::enabled()) {
     trace::SwiftInvocation SwiftArgs;
@@ -734,6 +737,27 @@ CodeCompletion::SessionCache::getFilterRules() {
   llvm::sys::ScopedLock L(mtx);
   return filterRules;
 }
+std::vector<Completion *>
+CodeCompletion::SessionCache::getCandidatesForFilter(StringRef filterText,
+                                                     bool fuzzy) {
+  llvm::sys::ScopedLock L(mtx);
+  // Both prefix and fuzzy matching are case-insensitive, and any name that
+  // matches a filter text also matched every prefix of it.  A prefix match is
+  // stricter than a fuzzy match, so fuzzy matching can't narrow down the
+  // results of prefix matching.
+  if (!lastFilterText.empty() &&
+      StringRef(filterText).startswith_lower(lastFilterText) &&
+      (lastFilterWasFuzzy || !fuzzy))
+    return lastFilterMatches;
+  return sortedCompletions;
+}
+void CodeCompletion::SessionCache::setFilterMatches(
+    StringRef filterText, bool fuzzy, std::vector<Completion *> &&matches) {
+  llvm::sys::ScopedLock L(mtx);
+  lastFilterText = filterText;
+  lastFilterWasFuzzy = fuzzy;
+  lastFilterMatches = std::move(matches);
+}
 
 //===----------------------------------------------------------------------===//
 // CodeCompletion::SessionCacheMap
@@ -1025,8 +1049,20 @@ static void transformAndForwardResults(
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
   if (!hasEarlyInnerResults) {
-    organizer.addCompletionsWithFilter(session->getSortedCompletions(),
-                                       filterText, rules, exactMatch);
+    if (filterText.empty()) {
+      organizer.addCompletionsWithFilter(session->getSortedCompletions(),
+                                         filterText, rules, exactMatch);
+    } else {
+      // Each update in a session usually extends the filter text by a
+      // character, so only re-check the previous update's matches.
+      bool fuzzy = options.fuzzyMatching &&
+                   filterText.size() >= options.minFuzzyLength;
+      std::vector<Completion *> nameMatches;
+      organizer.addCompletionsWithFilter(
+          session->getCandidatesForFilter(filterText, fuzzy), filterText,
+          rules, exactMatch, &nameMatches);
+      session->setFilterMatches(filterText, fuzzy, std::move(nameMatches));
+    }
   }
 
   if (hasEarlyInnerResults &&
@@ -38,15 +38,50 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 
+#include <atomic>
+
 using namespace SourceKit;
 using namespace swift;
 using namespace ide;
 
+SourceLoc EditorDiagConsumer::getLatestLoc(SourceManager &SM,
+                                           SourceLoc Loc) const {
+  for (auto &Range : ReplacedRanges) {
+    CharSourceRange OldBuffer = SM.getRangeForBuffer(Range.OldBufferID);
+    if (!OldBuffer.contains(Loc) && OldBuffer.getEnd() != Loc)
+      continue;
+
+    unsigned Offset = SM.getLocOffsetInBuffer(Loc, Range.OldBufferID);
+    if (Offset >= Range.Offset + Range.OldLength)
+      Offset = Offset - Range.OldLength + Range.NewLength;
+    else if (Offset >= Range.Offset)
+      return Loc;
+    Loc = SM.getLocForOffset(Range.NewBufferID, Offset);
+  }
+  return Loc;
+}
+
+void EditorDiagConsumer::setDiagnosticsForBuffer(unsigned BufferID,
+                                                 DiagnosticsTy Diags) {
+  clearLastDiag();
+  ErrorBufferIDs.erase(BufferID);
+  for (auto &Diag : Diags) {
+    if (Diag.Severity == DiagnosticSeverityKind::Error) {
+      ErrorBufferIDs.insert(BufferID);
+      break;
+    }
+  }
+  BufferDiagnostics[BufferID] = std::move(Diags);
+}
+
 void EditorDiagConsumer::handleDiagnostic(SourceManager &SM, SourceLoc Loc,
                                           DiagnosticKind Kind, StringRef Text,
                                           const DiagnosticInfo &Info) {
+  if (Loc.isValid())
+    Loc = getLatestLoc(SM, Loc);
+
   if (Kind == DiagnosticKind::Error) {
-    HadAnyError = true;
+    ErrorBufferIDs.insert(Loc.isValid() ? SM.findBufferContainingLoc(Loc) : 0);
   }
 
   // Filter out lexer errors for placeholders.
@@ -108,7 +143,10 @@ void EditorDiagConsumer::handleDiagnostic(SourceManager &SM, SourceLoc Loc,
   SKInfo.Filename = SM.getIdentifierForBuffer(BufferID);
 
   for (auto R : Info.Ranges) {
-    if (R.isInvalid() || SM.findBufferContainingLoc(R.getStart()) != BufferID)
+    if (R.isInvalid())
+      continue;
+    R = CharSourceRange(getLatestLoc(SM, R.getStart()), R.getByteLength());
+    if (SM.findBufferContainingLoc(R.getStart()) != BufferID)
       continue;
     unsigned Offset = SM.getLocOffsetInBuffer(R.getStart(), BufferID);
     unsigned Length = R.getByteLength();
@@ -116,11 +154,12 @@ void EditorDiagConsumer::handleDiagnostic(SourceManager &SM, SourceLoc Loc,
   }
 
   for (auto F : Info.FixIts) {
-    if (F.getRange().isInvalid() ||
-        SM.findBufferContainingLoc(F.getRange().getStart()) != BufferID)
+    if (F.getRange().isInvalid())
+      continue;
+    SourceLoc Start = getLatestLoc(SM, F.getRange().getStart());
+    if (SM.findBufferContainingLoc(Start) != BufferID)
       continue;
-    unsigned Offset = SM.getLocOffsetInBuffer(F.getRange().getStart(),
-                                              BufferID);
+    unsigned Offset = SM.getLocOffsetInBuffer(Start, BufferID);
     unsigned Length = F.getRange().getByteLength();
     SKInfo.Fixits.push_back({ Offset, Length, F.getText() });
   }
@@ -396,6 +435,9 @@ class SwiftDocumentSemanticInfo :
   std::string CompilerArgsError;
 
   uint64_t ASTGeneration = 0;
+  /// Incremented for each semantic info request, so that a request can tell
+  /// whether a newer one for this document superseded it.
+  std::atomic<uint64_t> LatestRequest{0};
   ImmutableTextSnapshotRef TokSnapshot;
   std::vector<SwiftSemanticToken> SemaToks;
 
@@ -416,6 +458,10 @@ public:
 
   uint64_t getASTGeneration() const;
 
+  uint64_t getLatestRequest() const {
+    return LatestRequest;
+  }
+
   void setCompilerArgs(ArrayRef<const char *> Args) {
     InvokRef = ASTMgr.getInvocation(Args, Filename, CompilerArgsError);
   }
@@ -761,14 +807,12 @@ void SwiftDocumentSemanticInfo::updateSemanticInfo(
 namespace {
 
 class SemanticAnnotator : public SourceEntityWalker {
-  SourceManager &SM;
-  unsigned BufferID;
+  const ASTUnit &AstUnit;
 public:
 
   std::vector<SwiftSemanticToken> SemaToks;
 
-  SemanticAnnotator(SourceManager &SM, unsigned BufferID)
-    : SM(SM), BufferID(BufferID) {}
+  SemanticAnnotator(const ASTUnit &AstUnit) : AstUnit(AstUnit) {}
 
   bool visitDeclReference(ValueDecl *D, CharSourceRange Range,
                           TypeDecl *CtorTyRef, Type T) override {
@@ -792,11 +836,15 @@ public:
   }
 
   void annotate(const Decl *D, bool IsRef, CharSourceRange Range) {
-    unsigned ByteOffset = SM.getLocOffsetInBuffer(Range.getStart(), BufferID);
+    // Function bodies of the primary file may have been reparsed from a newer
+    // buffer.
+    auto ByteOffset = AstUnit.getPrimaryFileOffset(Range.getStart());
+    if (!ByteOffset)
+      return;
     unsigned Length = Range.getByteLength();
     auto Kind = CodeCompletionResult::getCodeCompletionDeclKind(D);
     bool IsSystem = D->getModuleContext()->isSystemModule();
-    SemaToks.emplace_back(Kind, ByteOffset, Length, IsRef, IsSystem);
+    SemaToks.emplace_back(Kind, *ByteOffset, Length, IsRef, IsSystem);
   }
 };
 
@@ -807,14 +855,28 @@ namespace {
 class AnnotAndDiagASTConsumer : public SwiftASTConsumer {
   EditableTextBufferRef EditableBuffer;
   RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef;
+  uint64_t Request;
 
 public:
   std::vector<SwiftSemanticToken> SemaToks;
 
   AnnotAndDiagASTConsumer(EditableTextBufferRef EditableBuffer,
-                          RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef)
+                          RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef,
+                          uint64_t Request)
     : EditableBuffer(std::move(EditableBuffer)),
-      SemaInfoRef(std::move(SemaInfoRef)) { }
+      SemaInfoRef(std::move(SemaInfoRef)), Request(Request) { }
+
+  bool canUseASTWithReparsedFunctionBodies() override {
+    return true;
+  }
+
+  Priority getPriority() override {
+    return Priority::Background;
+  }
+
+  bool isStale() override {
+    return Request != SemaInfoRef->getLatestRequest();
+  }
 
   void failed(StringRef Error) override {
     LOG_WARN_FUNC("sema annotations failed: " << Error);
@@ -859,7 +921,7 @@ public:
       LOG_WARN_FUNC("Primary SourceFile is expected to have a BufferID");
       return;
     }
-    unsigned BufferID = AstUnit->getPrimarySourceFile().getBufferID().getValue();
+    unsigned BufferID = AstUnit->getPrimaryBufferID();
 
     trace::TracedOperation TracedOp;
     if (trace::enabled()) {
@@ -870,7 +932,7 @@ public:
       TracedOp.start(trace::OperationKind::AnnotAndDiag, SwiftArgs);
     }
 
-    SemanticAnnotator Annotator(CompIns.getSourceMgr(), BufferID);
+    SemanticAnnotator Annotator(*AstUnit);
     Annotator.walk(AstUnit->getPrimarySourceFile());
     SemaToks = std::move(Annotator.SemaToks);
 
@@ -900,7 +962,8 @@ void SwiftDocumentSemanticInfo::processLatestSnapshotAsync(
 
   RefPtr<SwiftDocumentSemanticInfo> SemaInfoRef = this;
   auto Consumer = std::make_shared<AnnotAndDiagASTConsumer>(EditableBuffer,
-                                                            SemaInfoRef);
+                                                            SemaInfoRef,
+                                                            ++LatestRequest);
 
   // Semantic annotation queries for a particular document should cancel
   // previously queued queries for the same document. Each document has a
@@ -1774,9 +1837,17 @@ void SwiftEditorDocument::readSemanticInfo(ImmutableTextSnapshotRef Snapshot,
   Impl.SemanticInfo->readSemanticInfo(Snapshot, SemaToks, SemaDiags,
                                       Impl.ParserDiagnostics);
 
+  unsigned RangeOffset = 0;
+  unsigned RangeLength = 0;
+  bool HasRange = Consumer.getSemanticAnnotationRange(RangeOffset,
+                                                      RangeLength);
+
   for (auto SemaTok : SemaToks) {
     unsigned Offset = SemaTok.ByteOffset;
     unsigned Length = SemaTok.Length;
+    if (HasRange && (Offset + Length <= RangeOffset ||
+                     Offset >= RangeOffset + RangeLength))
+      continue;
     UIdent Kind = SemaTok.getUIdentForKind();
     bool IsSystem = SemaTok.IsSystem;
     if (Kind.isValid())
@@ -16,9 +16,23 @@
 #include "SourceKit/Core/LangSupport.h"
 #include "swift/Basic/DiagnosticConsumer.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallSet.h"
 
 namespace SourceKit {
 
+/// A range of an input buffer that the AST no longer refers to, because the
+/// part of the AST it held was parsed again from a newer buffer for the same
+/// file.
+///
+/// The newer buffer holds the same text as the old one outside of the range.
+struct ReplacedBufferRange {
+  unsigned OldBufferID;
+  unsigned NewBufferID;
+  unsigned Offset;
+  unsigned OldLength;
+  unsigned NewLength;
+};
+
 class EditorDiagConsumer : public swift::DiagnosticConsumer {
   typedef std::vector<DiagnosticEntryInfo> DiagnosticsTy;
   /// Maps from a BufferID to the diagnostics that were emitted inside that
@@ -26,6 +40,7 @@ class EditorDiagConsumer : public swift::DiagnosticConsumer {
   llvm::DenseMap<unsigned, DiagnosticsTy> BufferDiagnostics;
 
   SmallVector<unsigned, 8> InputBufIDs;
+  SmallVector<ReplacedBufferRange, 4> ReplacedRanges;
   int LastDiagBufferID = -1;
   unsigned LastDiagIndex = 0;
 
@@ -41,7 +56,10 @@ class EditorDiagConsumer : public swift::DiagnosticConsumer {
   }
 
   bool HadInvalidLocError = false;
-  bool HadAnyError = false;
+
+  /// The buffers that errors were emitted in, using 0 for errors without a
+  /// location.
+  llvm::SmallSet<unsigned, 4> ErrorBufferIDs;
 
 public:
   void setInputBufferIDs(ArrayRef<unsigned> BufferIDs) {
@@ -49,6 +67,25 @@ public:
     std::sort(InputBufIDs.begin(), InputBufIDs.end());
   }
 
+  /// Records that the AST no longer refers to \p Range, so that diagnostics
+  /// emitted from now on in the old buffer are reported at the same text in
+  /// the new one, which becomes an input buffer.
+  ///
+  /// The diagnostics already emitted are not changed; see
+  /// setDiagnosticsForBuffer().
+  void addReplacedBufferRange(const ReplacedBufferRange &Range) {
+    ReplacedRanges.push_back(Range);
+    setInputBufferIDs(Range.NewBufferID);
+  }
+
+  /// Maps \p Loc through the replaced buffer ranges, to the location of the
+  /// same text in the newest buffer for its file.
+  ///
+  /// Locations inside a replaced range, or in buffers that weren't replaced,
+  /// are returned unchanged.
+  swift::SourceLoc getLatestLoc(swift::SourceManager &SM,
+                                swift::SourceLoc Loc) const;
+
   bool isInputBufferID(unsigned BufferID) const {
     return std::binary_search(InputBufIDs.begin(), InputBufIDs.end(), BufferID);
   }
@@ -62,9 +99,12 @@ public:
     return Diags;
   }
 
+  /// Replaces the diagnostics for \p BufferID, which must be in source order.
+  void setDiagnosticsForBuffer(unsigned BufferID, DiagnosticsTy Diags);
+
   bool hadErrorWithInvalidLoc() const { return HadInvalidLocError; }
 
-  bool hadAnyError() const { return HadAnyError; }
+  bool hadAnyError() const { return !ErrorBufferIDs.empty(); }
 
   void handleDiagnostic(swift::SourceManager &SM, swift::SourceLoc Loc,
                         swift::DiagnosticKind Kind, StringRef Text,
@@ -72,6 +72,9 @@ public:
   std::string DocumentName;
   bool IsModule = false;
   std::string ModuleOrHeaderName;
+  /// The group that was printed, if only one group of the module was.
+  Optional<std::string> Group;
+  bool SynthesizedExtensions = false;
   CompilerInvocation Invocation;
   PrintingDiagnosticConsumer DiagConsumer;
   CompilerInstance Instance;
@@ -324,6 +327,9 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
   if (!Group && InterestedUSR) {
     Group = findGroupNameForUSR(Mod, InterestedUSR.getValue());
   }
+  if (Group)
+    Impl.Group = Group->str();
+  Impl.SynthesizedExtensions = SynthesizedExtensions;
   printSubmoduleInterface(Mod, SplitModuleName,
     Group.hasValue() ? llvm::makeArrayRef(Group.getValue()) : ArrayRef<StringRef>(),
                           TraversalOptions,
@@ -541,6 +547,23 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+bool SwiftInterfaceGenContext::canReuseForOpen(
+    StringRef DocumentName, StringRef ModuleName, Optional<StringRef> Group,
+    const swift::CompilerInvocation &Invok, bool SynthesizedExtensions,
+    Optional<StringRef> InterestedUSR) {
+  if (DocumentName != Impl.DocumentName || !matches(ModuleName, Invok))
+    return false;
+  if (SynthesizedExtensions != Impl.SynthesizedExtensions)
+    return false;
+  if (Group)
+    return Impl.Group && *Impl.Group == *Group;
+  // The group would be picked from the USR, and a decl belongs to a single
+  // group, so any printed group that contains it is the right one.
+  if (InterestedUSR)
+    return Impl.Group && Impl.Info.USRMap.count(*InterestedUSR);
+  return !Impl.Group;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -627,7 +650,32 @@ void SwiftInterfaceGenMap::set(StringRef Name,
 
 bool SwiftInterfaceGenMap::remove(StringRef Name) {
   llvm::sys::ScopedLock L(Mtx);
-  return IFaceGens.erase(Name);
+  auto It = IFaceGens.find(Name);
+  if (It == IFaceGens.end())
+    return false;
+  if (It->getValue()->isModule()) {
+    if (RecentlyClosed.size() == MaxRecentlyClosed)
+      RecentlyClosed.erase(RecentlyClosed.begin());
+    RecentlyClosed.push_back(It->getValue());
+  }
+  IFaceGens.erase(It);
+  return true;
+}
+
+SwiftInterfaceGenContextRef SwiftInterfaceGenMap::takeRecentlyClosed(
+    StringRef Name, StringRef ModuleName, Optional<StringRef> Group,
+    const CompilerInvocation &Invok, bool SynthesizedExtensions,
+    Optional<StringRef> InterestedUSR) {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto I = RecentlyClosed.begin(), E = RecentlyClosed.end(); I != E; ++I) {
+    if ((*I)->canReuseForOpen(Name, ModuleName, Group, Invok,
+                              SynthesizedExtensions, InterestedUSR)) {
+      SwiftInterfaceGenContextRef IFaceGen = *I;
+      RecentlyClosed.erase(I);
+      return IFaceGen;
+    }
+  }
+  return nullptr;
 }
 
 SwiftInterfaceGenContextRef
@@ -712,6 +760,21 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
+  if (auto IFaceGenRef = IFaceGenContexts.takeRecentlyClosed(
+          Name, ModuleName, Group, Invocation, SynthesizedExtensions,
+          InterestedUSR)) {
+    // Requests queued before the interface was closed may still be using its
+    // AST, so wait for exclusive access.
+    Semaphore Sema(0);
+    IFaceGenRef->accessASTAsync([&] {
+      IFaceGenRef->reportEditorInfo(Consumer);
+      Sema.signal();
+    });
+    Sema.wait();
+    IFaceGenContexts.set(Name, IFaceGenRef);
+    return;
+  }
+
   std::string ErrMsg;
   auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
                                                       /*IsModule=*/true,
@@ -60,6 +60,15 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Returns true if opening \p DocumentName for \p ModuleName with the given
+  /// options would generate this same interface, so that it can be reused
+  /// instead of printing the module again.
+  bool canReuseForOpen(StringRef DocumentName, StringRef ModuleName,
+                       Optional<StringRef> Group,
+                       const swift::CompilerInvocation &Invok,
+                       bool SynthesizedExtensions,
+                       Optional<StringRef> InterestedUSR);
+
   /// Note: requires exclusive access to the underlying AST.
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
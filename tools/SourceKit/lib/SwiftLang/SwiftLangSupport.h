@@ -17,6 +17,7 @@
 #include "SwiftInterfaceGenContext.h"
 #include "SourceKit/Core/LangSupport.h"
 #include "SourceKit/Support/Concurrency.h"
+#include "SourceKit/Support/Statistic.h"
 #include "SourceKit/Support/ThreadSafeRefCntPtr.h"
 #include "SourceKit/Support/Tracing.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
@@ -136,6 +137,11 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionKind completionKind;
   bool completionHasExpectedTypes;
   FilterRules filterRules;
+  /// The filter text of the most recent filtered request in this session,
+  /// and the completions whose names matched it.
+  std::string lastFilterText;
+  bool lastFilterWasFuzzy = false;
+  std::vector<Completion *> lastFilterMatches;
   llvm::sys::Mutex mtx;
 
 public:
@@ -152,6 +158,12 @@ public:
   llvm::MemoryBuffer *getBuffer();
   ArrayRef<std::string> getCompilerArgs();
   const FilterRules &getFilterRules();
+  /// Returns the completions that can match \p filterText: the matches of the
+  /// previous filter text if \p filterText extends it, or all completions.
+  std::vector<Completion *> getCandidatesForFilter(StringRef filterText,
+                                                   bool fuzzy);
+  void setFilterMatches(StringRef filterText, bool fuzzy,
+                        std::vector<Completion *> &&matches);
   CompletionKind getCompletionKind();
   bool getCompletionHasExpectedTypes();
 };
@@ -177,14 +189,27 @@ public:
 
 class SwiftInterfaceGenMap {
   llvm::StringMap<SwiftInterfaceGenContextRef> IFaceGens;
+  /// Module interfaces that were closed most recently, oldest first. Editors
+  /// tend to reopen the same module interface on every "jump to definition".
+  std::vector<SwiftInterfaceGenContextRef> RecentlyClosed;
   mutable llvm::sys::Mutex Mtx;
 
+  static const unsigned MaxRecentlyClosed = 2;
+
 public:
   SwiftInterfaceGenContextRef get(StringRef Name) const;
   void set(StringRef Name, SwiftInterfaceGenContextRef IFaceGen);
   bool remove(StringRef Name);
   SwiftInterfaceGenContextRef find(StringRef ModuleName,
                                    const swift::CompilerInvocation &Invok);
+  /// Takes a recently closed module interface that can serve a request to
+  /// open \p Name, see SwiftInterfaceGenContext::canReuseForOpen().
+  SwiftInterfaceGenContextRef
+  takeRecentlyClosed(StringRef Name, StringRef ModuleName,
+                     Optional<StringRef> Group,
+                     const swift::CompilerInvocation &Invok,
+                     bool SynthesizedExtensions,
+                     Optional<StringRef> InterestedUSR);
 };
 
 struct SwiftCompletionCache
@@ -205,9 +230,16 @@ struct SwiftCustomCompletions
   std::vector<CustomCompletionInfo> customCompletions;
 };
 
+struct SwiftStatistics {
+#define SWIFT_STATISTIC(VAR, UID, DESC)                                        \
+  Statistic VAR{UIdent("source.statistic." #UID), DESC};
+#include "SwiftStatistics.def"
+};
+
 class SwiftLangSupport : public LangSupport {
   SourceKit::Context &SKCtx;
   std::string RuntimeResourcePath;
+  SwiftStatistics Stats;
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
@@ -226,6 +258,8 @@ public:
 
   SwiftASTManager &getASTManager() { return *ASTMgr; }
 
+  SwiftStatistics &getStats() { return Stats; }
+
   SwiftEditorDocumentFileMap &getEditorDocuments() { return EditorDocuments; }
   SwiftInterfaceGenMap &getIFaceGenContexts() { return IFaceGenContexts; }
   IntrusiveRefCntPtr<SwiftCompletionCache> getCodeCompletionCache() {
@@ -398,6 +432,8 @@ public:
 
   void findModuleGroups(StringRef ModuleName, ArrayRef<const char *> Args,
                std::function<void(ArrayRef<StringRef>, StringRef Error)> Receiver) override;
+
+  void getStatistics(StatisticsReceiver Receiver) override;
 };
 
 namespace trace {
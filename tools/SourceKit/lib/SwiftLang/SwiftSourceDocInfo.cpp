@@ -868,6 +868,10 @@ static void resolveCursor(SwiftLangSupport &Lang,
         TryExistingAST(TryExistingAST),
         Receiver(std::move(Receiver)) { }
 
+    Priority getPriority() override {
+      return Priority::Interactive;
+    }
+
     bool canUseASTWithSnapshots(
         ArrayRef<ImmutableTextSnapshotRef> Snapshots) override {
       if (!TryExistingAST) {
@@ -1075,6 +1079,10 @@ resolveCursorFromUSR(SwiftLangSupport &Lang, StringRef InputFile, StringRef USR,
           ASTInvok(std::move(ASTInvok)), TryExistingAST(TryExistingAST),
           Receiver(std::move(Receiver)) {}
 
+    Priority getPriority() override {
+      return Priority::Interactive;
+    }
+
     bool canUseASTWithSnapshots(
         ArrayRef<ImmutableTextSnapshotRef> Snapshots) override {
       if (!TryExistingAST) {
@@ -1281,6 +1289,10 @@ void SwiftLangSupport::findRelatedIdentifiersInFile(
                       SwiftInvocationRef Invok)
       : Offset(Offset), Receiver(std::move(Receiver)), Invok(Invok) { }
 
+    Priority getPriority() override {
+      return Priority::Interactive;
+    }
+
     void handlePrimaryAST(ASTUnitRef AstUnit) override {
       auto &CompInst = AstUnit->getCompilerInstance();
       auto &SrcFile = AstUnit->getPrimarySourceFile();
@@ -38,6 +38,8 @@ extern SourceKit::UIdent KeyUIDs;
 extern SourceKit::UIdent KeyEnableSyntaxMap;
 extern SourceKit::UIdent KeyEnableDiagnostics;
 extern SourceKit::UIdent KeySyntacticOnly;
+extern SourceKit::UIdent KeyVisibleOffset;
+extern SourceKit::UIdent KeyVisibleLength;
 extern SourceKit::UIdent KeyLength;
 extern SourceKit::UIdent KeyKind;
 extern SourceKit::UIdent KeyAccessibility;
@@ -52,6 +54,7 @@ extern SourceKit::UIdent KeyReceiverUSR;
 extern SourceKit::UIdent KeyIsDynamic;
 extern SourceKit::UIdent KeyIsTestCandidate;
 extern SourceKit::UIdent KeyDescription;
+extern SourceKit::UIdent KeyValue;
 extern SourceKit::UIdent KeyTypeName;
 extern SourceKit::UIdent KeyRuntimeName;
 extern SourceKit::UIdent KeySelectorName;
@@ -20,6 +20,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Statistic.h"
 #include "SourceKit/Support/UIdent.h"
 #include "SourceKit/SwiftLang/Factory.h"
 
@@ -63,6 +64,8 @@ static LazySKDUID RequestProtocolVersion("source.request.protocol_version");
 
 static LazySKDUID RequestCrashWithExit("source.request.crash_exit");
 
+static LazySKDUID RequestStatistics("source.request.statistics");
+
 static LazySKDUID RequestDemangle("source.request.demangle");
 static LazySKDUID RequestMangleSimpleClass("source.request.mangle_simple_class");
 
@@ -190,6 +193,7 @@ static sourcekitd_response_t codeCompleteClose(StringRef name, int64_t Offset);
 static sourcekitd_response_t
 editorOpen(StringRef Name, llvm::MemoryBuffer *Buf, bool EnableSyntaxMap,
            bool EnableStructure, bool EnableDiagnostics, bool SyntacticOnly,
+           int64_t VisibleOffset, int64_t VisibleLength,
            ArrayRef<const char *> Args);
 
 static sourcekitd_response_t
@@ -220,7 +224,8 @@ editorClose(StringRef Name, bool RemoveCache);
 static sourcekitd_response_t
 editorReplaceText(StringRef Name, llvm::MemoryBuffer *Buf, unsigned Offset,
                   unsigned Length, bool EnableSyntaxMap, bool EnableStructure,
-                  bool EnableDiagnostics, bool SyntacticOnly);
+                  bool EnableDiagnostics, bool SyntacticOnly,
+                  int64_t VisibleOffset, int64_t VisibleLength);
 
 static void
 editorApplyFormatOptions(StringRef Name, RequestDict &FmtOptions);
@@ -321,6 +326,22 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(RB.createResponse());
   }
 
+  if (ReqUID == RequestStatistics) {
+    LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+    Lang.getStatistics([Rec](ArrayRef<Statistic *> Stats) {
+      ResponseBuilder RB;
+      auto Results = RB.getDictionary().setArray(KeyResults);
+      for (Statistic *Stat : Stats) {
+        auto Entry = Results.appendDictionary();
+        Entry.set(KeyKind, Stat->Name);
+        Entry.set(KeyDescription, Stat->Description);
+        Entry.set(KeyValue, Stat->Value.load());
+      }
+      Rec(RB.createResponse());
+    });
+    return;
+  }
+
   if (ReqUID == RequestCrashWithExit) {
     // 'exit' has the same effect as crashing but without the crash log.
     ::exit(1);
@@ -411,8 +432,13 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     Req.getInt64(KeyEnableDiagnostics, EnableDiagnostics, /*isOptional=*/true);
     int64_t SyntacticOnly = false;
     Req.getInt64(KeySyntacticOnly, SyntacticOnly, /*isOptional=*/true);
+    int64_t VisibleOffset = -1;
+    Req.getInt64(KeyVisibleOffset, VisibleOffset, /*isOptional=*/true);
+    int64_t VisibleLength = 0;
+    Req.getInt64(KeyVisibleLength, VisibleLength, /*isOptional=*/true);
     return Rec(editorOpen(*Name, InputBuf.get(), EnableSyntaxMap, EnableStructure,
-                          EnableDiagnostics, SyntacticOnly, Args));
+                          EnableDiagnostics, SyntacticOnly,
+                          VisibleOffset, VisibleLength, Args));
   }
   if (ReqUID == RequestEditorClose) {
     Optional<StringRef> Name = Req.getString(KeyName);
@@ -444,9 +470,14 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     Req.getInt64(KeyEnableDiagnostics, EnableDiagnostics, /*isOptional=*/true);
     int64_t SyntacticOnly = false;
     Req.getInt64(KeySyntacticOnly, SyntacticOnly, /*isOptional=*/true);
+    int64_t VisibleOffset = -1;
+    Req.getInt64(KeyVisibleOffset, VisibleOffset, /*isOptional=*/true);
+    int64_t VisibleLength = 0;
+    Req.getInt64(KeyVisibleLength, VisibleLength, /*isOptional=*/true);
     return Rec(editorReplaceText(*Name, InputBuf.get(), Offset, Length,
                                  EnableSyntaxMap, EnableStructure,
-                                 EnableDiagnostics, SyntacticOnly));
+                                 EnableDiagnostics, SyntacticOnly,
+                                 VisibleOffset, VisibleLength));
   }
   if (ReqUID == RequestEditorFormatText) {
     Optional<StringRef> Name = Req.getString(KeyName);
@@ -1721,6 +1752,10 @@ class SKEditorConsumer : public EditorConsumer {
   bool EnableDiagnostics;
   bool SyntacticOnly;
 
+  bool HasVisibleRange = false;
+  unsigned VisibleOffset = 0;
+  unsigned VisibleLength = 0;
+
 public:
   SKEditorConsumer(bool EnableSyntaxMap,
                    bool EnableStructure, bool EnableDiagnostics,
@@ -1748,6 +1783,23 @@ public:
     return !SyntacticOnly && !isSemanticEditorDisabled();
   }
 
+  /// Limits the reported semantic annotations to the given range, if the
+  /// request provided one.
+  void setVisibleRange(int64_t Offset, int64_t Length) {
+    if (Offset < 0 || Length < 0)
+      return;
+    HasVisibleRange = true;
+    VisibleOffset = Offset;
+    VisibleLength = Length;
+  }
+
+  bool getSemanticAnnotationRange(unsigned &Offset,
+                                  unsigned &Length) override {
+    Offset = VisibleOffset;
+    Length = VisibleLength;
+    return HasVisibleRange;
+  }
+
   void handleRequestError(const char *Description) override;
 
   bool handleSyntaxMap(unsigned Offset, unsigned Length, UIdent Kind) override;
@@ -1798,9 +1850,11 @@ public:
 static sourcekitd_response_t
 editorOpen(StringRef Name, llvm::MemoryBuffer *Buf, bool EnableSyntaxMap,
            bool EnableStructure, bool EnableDiagnostics, bool SyntacticOnly,
+           int64_t VisibleOffset, int64_t VisibleLength,
            ArrayRef<const char *> Args) {
   SKEditorConsumer EditC(EnableSyntaxMap, EnableStructure,
                          EnableDiagnostics, SyntacticOnly);
+  EditC.setVisibleRange(VisibleOffset, VisibleLength);
   LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
   Lang.editorOpen(Name, Buf, EnableSyntaxMap, EditC, Args);
   return EditC.createResponse();
@@ -1884,9 +1938,11 @@ editorClose(StringRef Name, bool RemoveCache) {
 static sourcekitd_response_t
 editorReplaceText(StringRef Name, llvm::MemoryBuffer *Buf, unsigned Offset,
                   unsigned Length, bool EnableSyntaxMap, bool EnableStructure,
-                  bool EnableDiagnostics, bool SyntacticOnly) {
+                  bool EnableDiagnostics, bool SyntacticOnly,
+                  int64_t VisibleOffset, int64_t VisibleLength) {
   SKEditorConsumer EditC(EnableSyntaxMap, EnableStructure,
                          EnableDiagnostics, SyntacticOnly);
+  EditC.setVisibleRange(VisibleOffset, VisibleLength);
   LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
   Lang.editorReplaceText(Name, Buf, Offset, Length, EditC);
   return EditC.createResponse();
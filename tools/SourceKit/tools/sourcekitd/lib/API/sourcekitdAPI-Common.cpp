@@ -52,6 +52,8 @@ UIdent sourcekitd::KeyUIDs("key.uids");
 UIdent sourcekitd::KeyEnableSyntaxMap("key.enablesyntaxmap");
 UIdent sourcekitd::KeyEnableDiagnostics("key.enablediagnostics");
 UIdent sourcekitd::KeySyntacticOnly("key.syntactic_only");
+UIdent sourcekitd::KeyVisibleOffset("key.visible_offset");
+UIdent sourcekitd::KeyVisibleLength("key.visible_length");
 UIdent sourcekitd::KeyLength("key.length");
 UIdent sourcekitd::KeyKind("key.kind");
 UIdent sourcekitd::KeyAccessibility("key.accessibility");
@@ -66,6 +68,7 @@ UIdent sourcekitd::KeyReceiverUSR("key.receiver_usr");
 UIdent sourcekitd::KeyIsDynamic("key.is_dynamic");
 UIdent sourcekitd::KeyIsTestCandidate("key.is_test_candidate");
 UIdent sourcekitd::KeyDescription("key.description");
+UIdent sourcekitd::KeyValue("key.value");
 UIdent sourcekitd::KeyTypeName("key.typename");
 UIdent sourcekitd::KeyRuntimeName("key.runtime_name");
 UIdent sourcekitd::KeySelectorName("key.selector_name");
@@ -19,6 +19,7 @@
 #include "swift/Subsystems.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/SILOptions.h"
+#include "swift/Parse/PersistentParserState.h"
 #include "swift/Basic/LLVMInitialize.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
@@ -32,11 +33,14 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/TimeValue.h"
+#include <algorithm>
 #include <cstdio>
 using namespace swift;
 
@@ -160,6 +164,22 @@ ASTVerifierProcessId("ast-verifier-process-id", llvm::cl::Hidden,
 static llvm::cl::opt<bool>
 PerformWMO("wmo", llvm::cl::desc("Enable whole-module optimizations"));
 
+static llvm::cl::opt<bool>
+PrintMemoryStats("sil-memory-stats",
+                 llvm::cl::desc("Print the memory used by SIL after running "
+                                "the passes"));
+
+static llvm::cl::opt<std::string>
+OptRecordFile("save-optimization-record-path",
+              llvm::cl::desc("Write remarks about missed optimizations to "
+                             "the given file as YAML"));
+
+static llvm::cl::opt<bool>
+BatchMode("batch",
+          llvm::cl::desc("Treat the input as a directory of SIL files, run "
+                         "the passes on each of them in one ASTContext, and "
+                         "print how long each file and each pass took"));
+
 static void runCommandLineSelectedPasses(SILModule *Module) {
   SILPassManager PM(Module);
 
@@ -169,6 +189,147 @@ static void runCommandLineSelectedPasses(SILModule *Module) {
   PM.run();
 }
 
+static void runSelectedPasses(SILModule &Module) {
+  if (OptimizationGroup == OptGroup::Diagnostics) {
+    runSILDiagnosticPasses(Module);
+  } else if (OptimizationGroup == OptGroup::Performance) {
+    runSILOptimizationPasses(Module);
+  } else {
+    runCommandLineSelectedPasses(&Module);
+  }
+}
+
+/// Returns the time since \p Start in milliseconds.
+static double getElapsedMilliseconds(llvm::sys::TimeValue Start) {
+  llvm::sys::TimeValue Elapsed = llvm::sys::TimeValue::now() - Start;
+  return Elapsed.seconds() * 1e3 + Elapsed.nanoseconds() / 1e6;
+}
+
+/// Parses the SIL file in \p BufferID into a module of its own in the
+/// context of \p CI. Returns null if parsing or type checking failed.
+static std::unique_ptr<SILModule> parseBatchFile(CompilerInstance &CI,
+                                                 unsigned BufferID) {
+  ASTContext &Ctx = CI.getASTContext();
+
+  // The declarations of each file go into a fresh module with the usual
+  // name, so that they can't clash with those of the files before it.
+  Identifier Name = Ctx.getIdentifier(ModuleName.size() ? StringRef(ModuleName)
+                                                        : "main");
+  Module *M = Module::create(Name, Ctx);
+  Ctx.LoadedModules[Name] = M;
+  auto *SF = new (Ctx) SourceFile(*M, SourceFileKind::SIL, BufferID,
+                                  SourceFile::ImplicitModuleImportKind::None);
+  M->addFile(*SF);
+
+  std::unique_ptr<SILModule> SILMod =
+      SILModule::createEmptyModule(M, CI.getSILOptions(),
+                                   /*WholeModule=*/true);
+  {
+    SILParserState SILContext(SILMod.get());
+    PersistentParserState PersistentState;
+    unsigned CurTUElem = 0;
+    bool Done;
+    do {
+      parseIntoSourceFile(*SF, BufferID, &Done, &SILContext,
+                          &PersistentState);
+      performTypeChecking(*SF, PersistentState.getTopLevelContext(),
+                          TypeCheckingFlags::DelayWholeModuleChecking,
+                          CurTUElem);
+      CurTUElem = SF->Decls.size();
+    } while (!Done);
+  }
+  performWholeModuleTypeChecking(*SF);
+  finishTypeChecking(*SF);
+
+  if (Ctx.hadError())
+    return nullptr;
+  return SILMod;
+}
+
+/// Runs the selected passes on every .sil file in the directory
+/// \p InputDir. The files share one ASTContext, so that the standard library
+/// and the other modules they import are only loaded once, which leaves the
+/// time of parsing and optimizing each file to be measured.
+static int runBatch(CompilerInvocation &Invocation, StringRef InputDir) {
+  std::vector<std::string> Files;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator I(InputDir, EC), E;
+       I != E && !EC; I.increment(EC)) {
+    if (llvm::sys::path::extension(I->path()) == ".sil")
+      Files.push_back(I->path());
+  }
+  if (EC) {
+    llvm::errs() << "while reading '" << InputDir << "': " << EC.message()
+                 << '\n';
+    return 1;
+  }
+  std::sort(Files.begin(), Files.end());
+
+  Invocation.setModuleName(ModuleName.size() ? StringRef(ModuleName)
+                                             : "main");
+  Invocation.setInputKind(InputFileKind::IFK_SIL);
+
+  CompilerInstance CI;
+  PrintingDiagnosticConsumer PrintDiags;
+  CI.addDiagnosticConsumer(&PrintDiags);
+  if (CI.setup(Invocation))
+    return 1;
+
+  SILPassManager::setRecordPassTimeTotals(true);
+
+  bool HadError = false;
+  double TotalParseTime = 0, TotalPassTime = 0;
+  llvm::outs() << llvm::format("%10s %10s  %s\n", "parse ms", "passes ms",
+                               "file");
+  for (auto &File : Files) {
+    auto FileBufOrErr = llvm::MemoryBuffer::getFile(File);
+    if (!FileBufOrErr) {
+      llvm::errs() << "while opening '" << File << "': "
+                   << FileBufOrErr.getError().message() << '\n';
+      HadError = true;
+      continue;
+    }
+
+    llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+    unsigned BufferID =
+        CI.getSourceMgr().addNewSourceBuffer(std::move(FileBufOrErr.get()));
+    std::unique_ptr<SILModule> SILMod = parseBatchFile(CI, BufferID);
+    if (!SILMod) {
+      // Keep going with the next file.
+      CI.getDiags().resetHadAnyError();
+      HadError = true;
+      continue;
+    }
+    double ParseTime = getElapsedMilliseconds(StartTime);
+
+    StartTime = llvm::sys::TimeValue::now();
+    runSelectedPasses(*SILMod);
+    double PassTime = getElapsedMilliseconds(StartTime);
+
+    TotalParseTime += ParseTime;
+    TotalPassTime += PassTime;
+    llvm::outs() << llvm::format("%10.3f %10.3f  ", ParseTime, PassTime)
+                 << llvm::sys::path::filename(File) << '\n';
+  }
+  llvm::outs() << llvm::format("%10.3f %10.3f  ", TotalParseTime,
+                               TotalPassTime)
+               << "total\n";
+
+  using PassTime = std::pair<std::string, uint64_t>;
+  auto PassTimes = SILPassManager::takePassTimeTotals();
+  std::vector<PassTime> SortedPassTimes(PassTimes.begin(), PassTimes.end());
+  std::stable_sort(SortedPassTimes.begin(), SortedPassTimes.end(),
+                   [](const PassTime &LHS, const PassTime &RHS) {
+                     return LHS.second > RHS.second;
+                   });
+  llvm::outs() << llvm::format("\n%10s  %s\n", "ms", "pass");
+  for (auto &P : SortedPassTimes)
+    llvm::outs() << llvm::format("%10.3f  ", P.second / 1e6) << P.first
+                 << '\n';
+
+  return HadError;
+}
+
 // This function isn't referenced outside its translation unit, but it
 // can't use the "static" keyword because its address is used for
 // getMainExecutable (since some platforms don't support taking the
@@ -225,9 +386,18 @@ int main(int argc, char **argv) {
   SILOpts.VerifyAll = EnableSILVerifyAll;
   SILOpts.RemoveRuntimeAsserts = RemoveRuntimeAsserts;
   SILOpts.AssertConfig = AssertConfId;
+  SILOpts.PrintMemoryStats = PrintMemoryStats;
   if (OptimizationGroup != OptGroup::Diagnostics)
     SILOpts.Optimization = SILOptions::SILOptMode::Optimize;
 
+  if (BatchMode) {
+    if (VerifyMode || EmitSIB || !OutputFilename.empty()) {
+      llvm::errs() << "-batch can't be combined with -verify, -emit-sib or "
+                      "-o\n";
+      return 1;
+    }
+    return runBatch(Invocation, InputFilename);
+  }
 
   // Load the input file.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
@@ -303,14 +473,23 @@ int main(int argc, char **argv) {
   if (VerifyMode)
     enableDiagnosticVerifier(CI.getSourceMgr());
 
-  if (OptimizationGroup == OptGroup::Diagnostics) {
-    runSILDiagnosticPasses(*CI.getSILModule());
-  } else if (OptimizationGroup == OptGroup::Performance) {
-    runSILOptimizationPasses(*CI.getSILModule());
-  } else {
-    runCommandLineSelectedPasses(CI.getSILModule());
+  if (!OptRecordFile.empty()) {
+    std::error_code EC;
+    std::unique_ptr<llvm::raw_fd_ostream> OS(
+        new llvm::raw_fd_ostream(OptRecordFile, EC, llvm::sys::fs::F_None));
+    if (EC) {
+      llvm::errs() << "while opening '" << OptRecordFile << "': "
+                   << EC.message() << '\n';
+      return 1;
+    }
+    CI.getSILModule()->setOptRecordStream(std::move(OS));
   }
 
+  runSelectedPasses(*CI.getSILModule());
+
+  if (PrintMemoryStats)
+    CI.getSILModule()->printMemoryStats(llvm::errs());
+
   if (EmitSIB) {
     llvm::SmallString<128> OutputFile;
     if (OutputFilename.size()) {
@@ -36,6 +36,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -53,7 +54,10 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/Utils.h"
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <thread>
 
 using namespace swift;
 using namespace ide;
@@ -83,6 +87,15 @@ ModuleList("module-list-file",
 static llvm::cl::opt<std::string>
 OutputFile("o", llvm::cl::desc("Output file"));
 
+static llvm::cl::opt<std::string>
+OutputDir("output-dir",
+          llvm::cl::desc("Dump each module into its own file in the given "
+                         "directory"));
+
+static llvm::cl::opt<unsigned>
+Jobs("j", llvm::cl::init(1),
+     llvm::cl::desc("Number of modules to dump in parallel with -output-dir"));
+
 static llvm::cl::opt<std::string>
 SDK("sdk", llvm::cl::desc("path to the SDK to build against"));
 
@@ -312,6 +325,7 @@ public:
   StringRef getAnnotateComment(NodeAnnotation Anno) const;
   bool isAnnotatedAs(NodeAnnotation Anno) const;
   void addChild(NodeUniquePtr Child);
+  void adoptChildrenOf(SDKNode &Other);
   ArrayRef<NodeUniquePtr> getChildren() const;
   void collectChildren(NodeVector &Bucket) const;
   unsigned getChildIndex(NodePtr Child) const;
@@ -417,6 +431,12 @@ void SDKNode::addChild(NodeUniquePtr Child) {
   Children.push_back(std::move(Child));
 }
 
+void SDKNode::adoptChildrenOf(SDKNode &Other) {
+  for (auto &C : Other.Children)
+    addChild(std::move(C));
+  Other.Children.clear();
+}
+
 ArrayRef<NodeUniquePtr> SDKNode::getChildren() const {
   return llvm::makeArrayRef(Children.data(), Children.size());
 }
@@ -1160,10 +1180,28 @@ static void emitSDKNodeRoot(raw_ostream&, NodeUniquePtr&);
 static std::pair<std::unique_ptr<llvm::MemoryBuffer>, NodeUniquePtr>
 parseJsonEmit(StringRef);
 
+static NodeUniquePtr parseJsonBuffer(StringRef);
+
+// Writes the root of an SDK dump one top-level node at a time, so that the
+// tree of a node can be freed as soon as it has been written. The output is
+// the same as that of emitSDKNodeRoot.
+class SDKNodeRootStreamer {
+  json::Output Out;
+  bool HasChildren = false;
+
+public:
+  explicit SDKNodeRootStreamer(raw_ostream &OS);
+  void emit(NodeUniquePtr Node);
+  void finish();
+};
+
 class SwiftDeclCollector : public VisibleDeclConsumer {
 
   std::vector<std::unique_ptr<llvm::MemoryBuffer>> OwnedBuffers;
   NodeUniquePtr RootNode;
+  // If set, top-level nodes are written out as they are constructed instead
+  // of being kept under RootNode.
+  SDKNodeRootStreamer *Streamer = nullptr;
   llvm::DenseSet<ValueDecl*> KnownDecls;
   // Collected and sorted after we get all of them.
   std::vector<ValueDecl *> ClangMacros;
@@ -1173,6 +1211,8 @@ public:
     SDKNode::preorderVisit(RootNode.get(), Visitor);
   }
   SwiftDeclCollector() : RootNode(SDKNodeRoot::getInstance()) {}
+  explicit SwiftDeclCollector(SDKNodeRootStreamer *Streamer)
+    : RootNode(SDKNodeRoot::getInstance()), Streamer(Streamer) {}
 
   // Construct all roots vector from a given file where a forest was
   // previously dumped.
@@ -1182,6 +1222,13 @@ public:
     RootNode = std::move(Pair.second);
   }
 
+  // Add the top-level nodes of a dump to the ones collected so far.
+  void deSerializeAndMerge(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+    NodeUniquePtr Root = parseJsonBuffer(Buffer->getBuffer());
+    OwnedBuffers.push_back(std::move(Buffer));
+    RootNode->adoptChildrenOf(*Root);
+  }
+
   // Serialize the content of all roots to a given file using json format.
   void serialize(StringRef Filename) {
     std::error_code EC;
@@ -1224,20 +1271,27 @@ public:
       processDecl(VD);
   }
 
+  void addTopLevelNode(NodeUniquePtr Node) {
+    if (Streamer)
+      Streamer->emit(std::move(Node));
+    else
+      RootNode->addChild(std::move(Node));
+  }
+
   void processDecl(ValueDecl *VD) {
     if (shouldIgnore(VD))
       return;
 
     if (auto FD = dyn_cast<FuncDecl>(VD)) {
-      RootNode->addChild(constructFunctionNode(FD, SDKNodeKind::Function, false));
+      addTopLevelNode(constructFunctionNode(FD, SDKNodeKind::Function, false));
     } else if (auto NTD = dyn_cast<NominalTypeDecl>(VD)) {
-      RootNode->addChild(constructTypeDeclNode(NTD));
+      addTopLevelNode(constructTypeDeclNode(NTD));
     }
     if (auto VAD = dyn_cast<VarDecl>(VD)) {
-      RootNode->addChild(constructVarNode(VAD));
+      addTopLevelNode(constructVarNode(VAD));
     }
     if (auto TAD = dyn_cast<TypeAliasDecl>(VD)) {
-      RootNode->addChild(constructTypeAliasNode(TAD));
+      addTopLevelNode(constructTypeAliasNode(TAD));
     }
   }
 
@@ -1386,18 +1440,55 @@ static void emitSDKNodeRoot(llvm::raw_ostream &os, NodeUniquePtr &Root) {
   yout << Root;
 }
 
+SDKNodeRootStreamer::SDKNodeRootStreamer(raw_ostream &OS) : Out(OS) {
+  NodeUniquePtr Root = SDKNodeRoot::getInstance();
+  auto Kind = Root->getKind();
+  auto Name = Root->getName();
+  auto PrintedName = Root->getPrintedName();
+  Out.beginObject();
+  Out.mapRequired(Key_kind, Kind);
+  Out.mapRequired(Key_name, Name);
+  Out.mapRequired(Key_printedName, PrintedName);
+}
+
+void SDKNodeRootStreamer::emit(NodeUniquePtr Node) {
+  void *SaveInfo;
+  if (!HasChildren) {
+    bool UseDefault;
+    Out.preflightKey(Key_children, /*Required=*/true, /*SameAsDefault=*/false,
+                     UseDefault, SaveInfo);
+    Out.beginArray();
+    HasChildren = true;
+  }
+  Out.preflightElement(0, SaveInfo);
+  json::jsonize(Out, Node, true);
+  Out.postflightElement(SaveInfo);
+}
+
+void SDKNodeRootStreamer::finish() {
+  if (HasChildren) {
+    Out.endArray();
+    Out.postflightKey(nullptr);
+  }
+  Out.endObject();
+}
+
 // Deserialize an SDKNode tree.
 std::pair<std::unique_ptr<llvm::MemoryBuffer>, NodeUniquePtr>
 parseJsonEmit(StringRef FileName) {
-  namespace yaml = llvm::yaml;
-
   // Load the input file.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
   llvm::MemoryBuffer::getFileOrSTDIN(FileName);
   if (!FileBufOrErr) {
     llvm_unreachable("Failed to read json file");
   }
-  StringRef Buffer = FileBufOrErr->get()->getBuffer();
+  NodeUniquePtr Result = parseJsonBuffer(FileBufOrErr->get()->getBuffer());
+  return {std::move(FileBufOrErr.get()), std::move(Result)};
+}
+
+// Deserialize an SDKNode tree from a buffer that outlives the tree.
+static NodeUniquePtr parseJsonBuffer(StringRef Buffer) {
+  namespace yaml = llvm::yaml;
   llvm::SourceMgr SM;
   yaml::Stream Stream(Buffer, SM);
   NodeUniquePtr Result;
@@ -1407,7 +1498,7 @@ parseJsonEmit(StringRef FileName) {
     assert(N && "Failed to find a root");
     Result = SDKNode::constructSDKNode(cast<yaml::MappingNode>(N));
   }
-  return {std::move(FileBufOrErr.get()), std::move(Result)};
+  return Result;
 }
 
 // Given two NodeVector, this matches SDKNode by the order of their appearance
@@ -3123,7 +3214,33 @@ static void findTypeMemberDiffs(NodePtr leftSDKRoot, NodePtr rightSDKRoot,
   }
 }
 
-static int diagnoseModuleChange(StringRef LeftPath, StringRef RightPath) {
+// Returns the names of the per-module dumps in \p Dir.
+static void collectDumpNames(StringRef Dir, std::set<std::string> &Names) {
+  std::error_code EC;
+  for (fs::directory_iterator I(Dir, EC), E; I != E && !EC; I.increment(EC)) {
+    StringRef Path = I->path();
+    if (path::extension(Path) == ".json")
+      Names.insert(path::filename(Path));
+  }
+}
+
+static std::unique_ptr<llvm::MemoryBuffer> readDump(StringRef Dir,
+                                                    StringRef Name) {
+  SmallString<128> Path(Dir);
+  path::append(Path, Name);
+  auto BufOrErr = llvm::MemoryBuffer::getFile(Path);
+  if (!BufOrErr)
+    return nullptr;
+  return std::move(BufOrErr.get());
+}
+
+// Load the two SDKs under comparison. Either both paths are json files, or
+// both are directories of per-module dumps written by -dump-sdk -output-dir.
+// In the latter case, the modules whose dumps are the same on both sides
+// aren't even parsed: every node in them would be pruned as unchanged.
+static int loadSDKDumps(StringRef LeftPath, StringRef RightPath,
+                        SwiftDeclCollector &LeftCollector,
+                        SwiftDeclCollector &RightCollector) {
   if (!fs::exists(LeftPath)) {
     llvm::errs() << LeftPath << " does not exist\n";
     return 1;
@@ -3132,10 +3249,46 @@ static int diagnoseModuleChange(StringRef LeftPath, StringRef RightPath) {
     llvm::errs() << RightPath << " does not exist\n";
     return 1;
   }
+  bool LeftIsDir = fs::is_directory(LeftPath);
+  if (LeftIsDir != fs::is_directory(RightPath)) {
+    llvm::errs() << "Cannot compare a directory of module dumps with a "
+                    "single dump\n";
+    return 1;
+  }
+  if (!LeftIsDir) {
+    LeftCollector.deSerialize(LeftPath);
+    RightCollector.deSerialize(RightPath);
+    return 0;
+  }
+
+  std::set<std::string> Names;
+  collectDumpNames(LeftPath, Names);
+  collectDumpNames(RightPath, Names);
+  unsigned Unchanged = 0;
+  for (auto &Name : Names) {
+    auto LeftBuf = readDump(LeftPath, Name);
+    auto RightBuf = readDump(RightPath, Name);
+    if (LeftBuf && RightBuf &&
+        LeftBuf->getBuffer() == RightBuf->getBuffer()) {
+      ++Unchanged;
+      continue;
+    }
+    if (LeftBuf)
+      LeftCollector.deSerializeAndMerge(std::move(LeftBuf));
+    if (RightBuf)
+      RightCollector.deSerializeAndMerge(std::move(RightBuf));
+  }
+  if (options::Verbose)
+    llvm::errs() << "Skipped " << Unchanged << " of " << Names.size()
+                 << " modules as unchanged\n";
+  return 0;
+}
+
+static int diagnoseModuleChange(StringRef LeftPath, StringRef RightPath) {
   SwiftDeclCollector LeftCollector;
-  LeftCollector.deSerialize(LeftPath);
   SwiftDeclCollector RightCollector;
-  RightCollector.deSerialize(RightPath);
+  if (loadSDKDumps(LeftPath, RightPath, LeftCollector, RightCollector))
+    return 1;
   auto LeftModule = LeftCollector.getSDKRoot();
   auto RightModule = RightCollector.getSDKRoot();
   PrunePass Prune;
@@ -3150,19 +3303,11 @@ static int diagnoseModuleChange(StringRef LeftPath, StringRef RightPath) {
 static int compareSDKs(StringRef LeftPath, StringRef RightPath,
                        StringRef DiffPath,
                        llvm::StringSet<> &IgnoredRemoveUsrs) {
-  if (!fs::exists(LeftPath)) {
-    llvm::errs() << LeftPath << " does not exist\n";
-    return 1;
-  }
-  if (!fs::exists(RightPath)) {
-    llvm::errs() << RightPath << " does not exist\n";
-    return 1;
-  }
   llvm::errs() << "Diffing: " << LeftPath << " and " << RightPath << "\n";
   SwiftDeclCollector LeftCollector;
-  LeftCollector.deSerialize(LeftPath);
   SwiftDeclCollector RightCollector;
-  RightCollector.deSerialize(RightPath);
+  if (loadSDKDumps(LeftPath, RightPath, LeftCollector, RightCollector))
+    return 1;
   llvm::errs() << "Finished deserializing" << "\n";
   auto LeftModule = LeftCollector.getSDKRoot();
   auto RightModule = RightCollector.getSDKRoot();
@@ -3304,18 +3449,114 @@ static int dumpSDKContent(const CompilerInvocation &InitInvok,
       Modules.push_back(M);
     }
   }
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputFile, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "Cannot open " << OutputFile << ": " << EC.message()
+                 << '\n';
+    return 1;
+  }
   if (options::Verbose)
-    llvm::errs() << "Scanning symbols...\n";
-  SwiftDeclCollector Collector;
+    llvm::errs() << "Scanning and dumping symbols...\n";
+  SDKNodeRootStreamer Streamer(OS);
+  SwiftDeclCollector Collector(&Streamer);
   Collector.lookupVisibleDecls(Modules);
-  if (options::Verbose)
-    llvm::errs() << "Dumping SDK...\n";
-  Collector.serialize(OutputFile);
+  Streamer.finish();
   if (options::Verbose)
     llvm::errs() << "Dumped to "<< OutputFile << "\n";
   return 0;
 }
 
+// The options that a -dump-sdk of a single module has to be invoked with to
+// see the same SDK as this invocation.
+static std::vector<std::string> getForwardedDumpOptions() {
+  std::vector<std::string> Args;
+  auto addIfSet = [&](StringRef Flag, StringRef Value) {
+    if (!Value.empty()) {
+      Args.push_back(Flag.str());
+      Args.push_back(Value.str());
+    }
+  };
+  addIfSet("-sdk", options::SDK);
+  addIfSet("-target", options::Triple);
+  addIfSet("-module-cache-path", options::ModuleCachePath);
+  addIfSet("-resource-dir", options::ResourceDir);
+  addIfSet("-swift-version", options::SwiftVersion);
+  for (auto &Path : options::FrameworkPaths)
+    addIfSet("-F", Path);
+  for (auto &Path : options::ModuleInputPaths)
+    addIfSet("-I", Path);
+  if (options::AbortOnModuleLoadFailure)
+    Args.push_back("-abort-on-module-fail");
+  if (options::Verbose)
+    Args.push_back("-v");
+  return Args;
+}
+
+// Dump each module into <OutputDir>/<module>.json. Every module is dumped by
+// a separate invocation of this tool, \p Jobs of them at a time, so that the
+// modules are loaded in parallel and only one module is in memory per
+// process.
+static int dumpSDKModules(const std::string &MainExecutable,
+                          const llvm::StringSet<> &ModuleNames,
+                          StringRef OutputDir, unsigned Jobs) {
+  if (!fs::exists(OutputDir)) {
+    llvm::errs() << "Output directory '" << OutputDir << "' does not exist.\n";
+    return 1;
+  }
+
+  std::vector<std::string> Names;
+  for (auto &Entry : ModuleNames)
+    Names.push_back(Entry.getKey());
+  std::sort(Names.begin(), Names.end());
+  std::vector<std::string> Forwarded = getForwardedDumpOptions();
+
+  std::atomic<unsigned> NextModule(0);
+  std::atomic<bool> HadError(false);
+  std::mutex ErrsLock;
+  auto dumpModules = [&]() {
+    for (unsigned I = NextModule++; I < Names.size(); I = NextModule++) {
+      SmallString<128> OutputPath(OutputDir);
+      path::append(OutputPath, Names[I] + ".json");
+
+      std::vector<const char *> Args;
+      Args.push_back(MainExecutable.c_str());
+      Args.push_back("-dump-sdk");
+      Args.push_back("-module");
+      Args.push_back(Names[I].c_str());
+      Args.push_back("-o");
+      Args.push_back(OutputPath.c_str());
+      for (auto &Arg : Forwarded)
+        Args.push_back(Arg.c_str());
+      Args.push_back(nullptr);
+
+      std::string ErrMsg;
+      int Result = llvm::sys::ExecuteAndWait(MainExecutable, Args.data(),
+                                             /*env=*/nullptr,
+                                             /*redirects=*/nullptr,
+                                             /*secondsToWait=*/0,
+                                             /*memoryLimit=*/0, &ErrMsg);
+      if (Result != 0) {
+        std::lock_guard<std::mutex> Guard(ErrsLock);
+        llvm::errs() << "Failed to dump module: " << Names[I];
+        if (!ErrMsg.empty())
+          llvm::errs() << " (" << ErrMsg << ")";
+        llvm::errs() << '\n';
+        HadError = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> Workers;
+  Jobs = std::max(1u, std::min<unsigned>(Jobs, Names.size()));
+  for (unsigned I = 1; I < Jobs; ++I)
+    Workers.emplace_back(dumpModules);
+  dumpModules();
+  for (auto &Worker : Workers)
+    Worker.join();
+  return HadError ? 1 : 0;
+}
+
 static int readFileLineByLine(StringRef Path, llvm::StringSet<> &Lines) {
   auto FileBufOrErr = llvm::MemoryBuffer::getFile(Path);
   if (!FileBufOrErr) {
@@ -3428,8 +3669,14 @@ int main(int argc, char *argv[]) {
     return (prepareForDump(argv[0], InitInvok, Modules)) ? 1 :
       dumpSwiftModules(InitInvok, Modules, options::OutputFile, PrintApis);
   case ActionType::DumpSDK:
-    return (prepareForDump(argv[0], InitInvok, Modules)) ? 1 :
-      dumpSDKContent(InitInvok, Modules, options::OutputFile);
+    if (prepareForDump(argv[0], InitInvok, Modules))
+      return 1;
+    if (!options::OutputDir.empty())
+      return dumpSDKModules(fs::getMainExecutable(argv[0],
+                              reinterpret_cast<void *>(
+                                &anchorForGetMainExecutable)),
+                            Modules, options::OutputDir, options::Jobs);
+    return dumpSDKContent(InitInvok, Modules, options::OutputFile);
   case ActionType::CompareSDKs:
   case ActionType::DiagnoseSDKs:
     if (options::SDKJsonPaths.size() != 2) {
@@ -16,6 +16,7 @@
 
 #include "swift/Basic/DemangleWrappers.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -23,8 +24,11 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <string>
+#include <thread>
+#include <vector>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
 #else
@@ -55,6 +59,18 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<std::string>
+InputFile("input-file",
+          llvm::cl::desc("Demangle all the symbols in a file ('-' for stdin) "
+                         "at once, splitting the work across threads"),
+          llvm::cl::value_desc("filename"));
+
+static llvm::cl::opt<unsigned>
+NumThreads("j",
+           llvm::cl::desc("Number of threads to use with -input-file "
+                          "(default: one per core)"),
+           llvm::cl::init(0));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
@@ -79,26 +95,26 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
   swift::Demangle::NodePointer pointer =
       swift::demangle_wrappers::demangleSymbolAsNode(name);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
 }
 
@@ -132,6 +148,78 @@ static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
   return EXIT_SUCCESS;
 }
 
+/// Demangles the symbols in \p input, which must consist of whole lines,
+/// into \p os.
+///
+/// Symbols tend to repeat a lot in large dumps, so the output for each one
+/// is remembered in \p cache.
+static void demangleLines(llvm::raw_ostream &os, llvm::StringRef input,
+                          const swift::Demangle::DemangleOptions &options,
+                          llvm::StringMap<std::string> &cache) {
+  // This doesn't handle Unicode symbols, but maybe that's okay.
+  llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
+
+  llvm::SmallVector<llvm::StringRef, 1> matches;
+  while (maybeSymbol.match(input, &matches)) {
+    llvm::StringRef symbol = matches.front();
+    os << substrBefore(input, symbol);
+
+    auto entry = cache.insert({symbol, std::string()});
+    if (entry.second) {
+      llvm::raw_string_ostream symbolOS(entry.first->second);
+      demangle(symbolOS, symbol, options);
+    }
+    os << entry.first->second;
+
+    input = substrAfter(input, symbol);
+  }
+  os << input;
+}
+
+static int demangleFile(llvm::StringRef filename,
+                        const swift::Demangle::DemangleOptions &options) {
+  auto bufferOrErr = llvm::MemoryBuffer::getFileOrSTDIN(filename);
+  if (!bufferOrErr) {
+    llvm::errs() << "error: cannot read '" << filename << "': "
+                 << bufferOrErr.getError().message() << '\n';
+    return EXIT_FAILURE;
+  }
+  llvm::StringRef input = (*bufferOrErr)->getBuffer();
+
+  unsigned numThreads = NumThreads;
+  if (numThreads == 0)
+    numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+
+  // Split the input into one chunk per thread, ending each chunk at a line
+  // boundary so that no symbol is split.
+  std::vector<llvm::StringRef> chunks;
+  size_t chunkSize = input.size() / numThreads + 1;
+  while (!input.empty()) {
+    size_t end = input.find('\n', std::min(chunkSize, input.size()) - 1);
+    end = (end == llvm::StringRef::npos) ? input.size() : end + 1;
+    chunks.push_back(input.substr(0, end));
+    input = input.substr(end);
+  }
+
+  std::vector<std::string> outputs(chunks.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0, e = chunks.size(); i != e; ++i) {
+    threads.emplace_back([&, i] {
+      llvm::StringMap<std::string> cache;
+      llvm::raw_string_ostream os(outputs[i]);
+      demangleLines(os, chunks[i], options, cache);
+    });
+  }
+
+  // Write the output in input order.
+  for (size_t i = 0, e = threads.size(); i != e; ++i) {
+    threads[i].join();
+    llvm::outs() << outputs[i];
+    std::string().swap(outputs[i]);
+  }
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv) {
 #if defined(__CYGWIN__)
   // Cygwin clang 3.5.2 with '-O3' generates CRASHING BINARY,
@@ -145,6 +233,11 @@ int main(int argc, char **argv) {
   if (Simplified)
     options = swift::Demangle::DemangleOptions::SimplifiedUIDemangleOptions();
 
+  if (!InputFile.empty()) {
+    CompactMode = true;
+    return demangleFile(InputFile, options);
+  }
+
   if (InputNames.empty()) {
     CompactMode = true;
     return demangleSTDIN(options);
@@ -412,8 +412,13 @@ int doDumpHeapInstance(const char *BinaryFilename) {
 
       PipeMemoryReader_receiveReflectionInfo(RC, &Pipe);
 
+      // The child waits while we inspect each instance, so its memory can be
+      // cached until we ask for the next one.
+      swift_reflection_setMemoryCachingEnabled(RC, 1);
+
       while (1) {
         InstanceKind Kind = PipeMemoryReader_receiveInstanceKind(&Pipe);
+        swift_reflection_clearMemoryCache(RC);
         switch (Kind) {
         case Object:
           printf("Reflecting an object.\n");
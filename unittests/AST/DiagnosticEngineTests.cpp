@@ -0,0 +1,73 @@
+//===--- DiagnosticEngineTests.cpp - Tests for diagnostic filtering -------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/DiagnosticEngine.h"
+#include "swift/AST/DiagnosticsCommon.h"
+#include "swift/Basic/DiagnosticConsumer.h"
+#include "swift/Basic/SourceManager.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+
+namespace {
+class RecordingConsumer : public DiagnosticConsumer {
+public:
+  std::vector<std::string> Texts;
+
+  void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
+                        DiagnosticKind Kind, StringRef Text,
+                        const DiagnosticInfo &Info) override {
+    Texts.push_back(Text);
+  }
+};
+} // end anonymous namespace
+
+TEST(DiagnosticEngine, IgnoredDiagnosticsAreDroppedWithTheirNotes) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+
+  Diags.ignoreDiagnostic(diag::not_implemented.ID);
+  EXPECT_TRUE(Diags.isIgnored(diag::not_implemented.ID));
+  EXPECT_FALSE(Diags.isIgnored(diag::error_no_group_info.ID));
+
+  Diags.diagnose(SourceLoc(), diag::not_implemented, "x")
+    .fixItInsertAfter(SourceLoc(), "y");
+  Diags.diagnose(SourceLoc(), diag::while_parsing_as_less_operator);
+  EXPECT_TRUE(Consumer.Texts.empty());
+  EXPECT_FALSE(Diags.hadAnyError());
+
+  Diags.diagnose(SourceLoc(), diag::error_no_group_info, "a.swift");
+  Diags.diagnose(SourceLoc(), diag::while_parsing_as_less_operator);
+  ASSERT_EQ(2u, Consumer.Texts.size());
+  EXPECT_EQ("no group info found for file: 'a.swift'", Consumer.Texts[0]);
+  EXPECT_TRUE(Diags.hadAnyError());
+}
+
+TEST(DiagnosticEngine, TransactionsDecideWhenTheyCommit) {
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  RecordingConsumer Consumer;
+  Diags.addConsumer(Consumer);
+  Diags.ignoreDiagnostic(diag::not_implemented.ID);
+
+  {
+    DiagnosticTransaction Transaction(Diags);
+    EXPECT_FALSE(Diags.isIgnored(diag::not_implemented.ID));
+    Diags.diagnose(SourceLoc(), diag::not_implemented, "x");
+    Diags.diagnose(SourceLoc(), diag::error_no_group_info, "a.swift");
+    EXPECT_TRUE(Consumer.Texts.empty());
+  }
+  ASSERT_EQ(1u, Consumer.Texts.size());
+  EXPECT_EQ("no group info found for file: 'a.swift'", Consumer.Texts[0]);
+}
@@ -0,0 +1,50 @@
+#include "swift/Basic/Cache.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "gtest/gtest.h"
+
+using namespace swift::sys;
+
+// The Darwin implementation is backed by libcache, which decides on its own
+// when to evict.
+#if !defined(__APPLE__)
+
+TEST(Cache, NoCostLimit) {
+  Cache<int, int> C("swift.test.cache");
+  for (int i = 0; i < 100; ++i)
+    C.set(i, i * 10);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i * 10, C.get(i).getValue());
+  EXPECT_EQ(0u, C.getEvictionCount());
+}
+
+TEST(Cache, CostLimitEvictsLeastRecentlyUsed) {
+  Cache<int, int> C("swift.test.cache");
+  C.setCostLimit(2 * sizeof(int));
+  C.set(1, 10);
+  C.set(2, 20);
+  EXPECT_EQ(10, C.get(1).getValue()); // Now 2 is the least recently used.
+  C.set(3, 30);
+  EXPECT_EQ(10, C.get(1).getValue());
+  EXPECT_FALSE(C.get(2).hasValue());
+  EXPECT_EQ(30, C.get(3).getValue());
+  EXPECT_EQ(1u, C.getEvictionCount());
+
+  // Replacing a value doesn't evict anything else.
+  C.set(3, 31);
+  EXPECT_EQ(10, C.get(1).getValue());
+  EXPECT_EQ(31, C.get(3).getValue());
+  EXPECT_EQ(1u, C.getEvictionCount());
+}
+
+TEST(Cache, CostLimitKeepsNewValue) {
+  Cache<int, int> C("swift.test.cache");
+  C.setCostLimit(1);
+  C.set(1, 10);
+  EXPECT_EQ(10, C.get(1).getValue());
+  C.set(2, 20);
+  EXPECT_FALSE(C.get(1).hasValue());
+  EXPECT_EQ(20, C.get(2).getValue());
+  EXPECT_EQ(1u, C.getEvictionCount());
+}
+
+#endif
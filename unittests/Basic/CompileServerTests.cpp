@@ -0,0 +1,185 @@
+//===--- CompileServerTests.cpp - for swift/Basic/CompileServer.h ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/CompileServer.h"
+#include "swift/Basic/LLVM.h"
+#include "swift/Basic/TaskQueue.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+
+#include <cstring>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace llvm::sys;
+using namespace swift;
+using namespace swift::sys;
+
+namespace {
+
+/// Runs a compile server in a child process for the duration of a test.
+class ScopedServer {
+  pid_t Pid = -1;
+  SmallString<128> Dir;
+
+public:
+  SmallString<128> SocketPath;
+
+  ScopedServer() {
+    if (fs::createUniqueDirectory("CompileServer-test", Dir))
+      return;
+    SocketPath = Dir;
+    path::append(SocketPath, "server.sock");
+
+    Pid = fork();
+    if (Pid == 0) {
+      // Echo the job's arguments back instead of running a compiler.
+      auto echo = [](const char *ExecPath, ArrayRef<const char *> Args) {
+        llvm::outs() << ExecPath;
+        for (const char *Arg : Args)
+          llvm::outs() << " " << Arg;
+        llvm::outs() << "\n";
+        return 3;
+      };
+      std::string ErrorMsg;
+      _exit(runCompileServer(SocketPath, 0, echo, ErrorMsg) ? 1 : 0);
+    }
+
+    // Wait for the server to start listening.
+    sockaddr_un Addr;
+    memset(&Addr, 0, sizeof(Addr));
+    Addr.sun_family = AF_UNIX;
+    strncpy(Addr.sun_path, SocketPath.c_str(), sizeof(Addr.sun_path) - 1);
+    for (unsigned Attempt = 0; Attempt != 500; ++Attempt) {
+      int Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      bool Connected =
+          connect(Fd, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) == 0;
+      close(Fd);
+      if (Connected)
+        break;
+      usleep(10 * 1000);
+    }
+  }
+
+  ~ScopedServer() {
+    if (Pid > 0) {
+      kill(Pid, SIGTERM);
+      waitpid(Pid, nullptr, 0);
+    }
+    fs::remove(SocketPath);
+    fs::remove(Dir);
+  }
+};
+
+TEST(CompileServer, RunsFrontendTasks) {
+  ScopedServer Server;
+  ASSERT_FALSE(Server.SocketPath.empty());
+
+  TaskQueue TQ(2);
+  TQ.setCompileServerPath(Server.SocketPath);
+
+  // The executable doesn't exist, so this can only succeed on the server.
+  const char *Args[] = { "-frontend", "-c", "main.swift" };
+  TQ.addTask("/nonexistent/swift", Args);
+
+  int ReturnCode = -1;
+  std::string Output;
+  TQ.execute(nullptr,
+             [&](ProcessId Pid, int Result, StringRef TaskOutput,
+                 Optional<TaskResourceUsage>, void *) {
+    ReturnCode = Result;
+    Output = TaskOutput;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+
+  EXPECT_EQ(3, ReturnCode);
+  EXPECT_EQ("/nonexistent/swift -frontend -c main.swift\n", Output);
+}
+
+TEST(CompileServer, SpawnsOtherTasks) {
+  ScopedServer Server;
+  ASSERT_FALSE(Server.SocketPath.empty());
+
+  TaskQueue TQ;
+  TQ.setCompileServerPath(Server.SocketPath);
+
+  const char *Args[] = { "-c", "echo spawned" };
+  TQ.addTask("/bin/sh", Args);
+
+  std::string Output;
+  TQ.execute(nullptr, [&](ProcessId, int, StringRef TaskOutput,
+                          Optional<TaskResourceUsage>, void *) {
+    Output = TaskOutput;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+
+  EXPECT_EQ("spawned\n", Output);
+}
+
+TEST(CompileServer, ReportsResourceUsage) {
+  ScopedServer Server;
+  ASSERT_FALSE(Server.SocketPath.empty());
+
+  TaskQueue TQ;
+  TQ.setCompileServerPath(Server.SocketPath);
+
+  const char *ServerArgs[] = { "-frontend", "-c", "main.swift" };
+  TQ.addTask("/nonexistent/swift", ServerArgs, llvm::None, (void *)1);
+  const char *LocalArgs[] = { "-c", "exit 0" };
+  TQ.addTask("/bin/sh", LocalArgs, llvm::None, (void *)2);
+
+  unsigned NumFinished = 0;
+  TQ.execute(nullptr, [&](ProcessId, int, StringRef,
+                          Optional<TaskResourceUsage> Usage, void *Context) {
+    ++NumFinished;
+    EXPECT_TRUE(Usage.hasValue()) << "task " << (uintptr_t)Context;
+    if (Usage) {
+      EXPECT_GT(Usage->WallTimeMicros, 0u);
+      EXPECT_GT(Usage->MaxResidentBytes, 0u);
+    }
+    return TaskFinishedResponse::ContinueExecution;
+  });
+
+  EXPECT_EQ(2u, NumFinished);
+}
+
+TEST(CompileServer, FallsBackWithoutServer) {
+  TaskQueue TQ;
+  TQ.setCompileServerPath("/nonexistent/server.sock");
+
+  const char *Args[] = { "-frontend", "ran locally" };
+  TQ.addTask("/bin/echo", Args);
+
+  int ReturnCode = -1;
+  std::string Output;
+  TQ.execute(nullptr,
+             [&](ProcessId, int Result, StringRef TaskOutput,
+                 Optional<TaskResourceUsage>, void *) {
+    ReturnCode = Result;
+    Output = TaskOutput;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+
+  EXPECT_EQ(0, ReturnCode);
+  EXPECT_EQ("-frontend ran locally\n", Output);
+}
+
+} // end anonymous namespace
+
+#endif
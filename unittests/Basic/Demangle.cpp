@@ -1,7 +1,9 @@
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Demangle.h"
 #include "gtest/gtest.h"
 
 using namespace swift::demangle_wrappers;
+using namespace swift::Demangle;
 
 TEST(Demangle, DemangleWrappers) {
   EXPECT_EQ("", demangleSymbolAsString(""));
@@ -11,3 +13,39 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+
+TEST(Demangle, NodeChildren) {
+  NodePointer list = NodeFactory::create(Node::Kind::TypeList);
+  EXPECT_FALSE(list->hasChildren());
+
+  // Add enough children to move them out of the node's inline storage.
+  for (unsigned i = 0; i != 5; ++i)
+    list->addChild(NodeFactory::create(Node::Kind::Number, i));
+  EXPECT_EQ(5u, list->getNumChildren());
+
+  uint64_t expected = 0;
+  for (NodePointer child : *list)
+    EXPECT_EQ(expected++, child->getIndex());
+  EXPECT_EQ(4u, list->getChild(4)->getIndex());
+}
+
+TEST(Demangle, SimpleNominalTypeNames) {
+  // These are printed without building a node tree; make sure they match
+  // what the full demangler would print.
+  EXPECT_EQ("main.Foo.Ding.Str", demangleTypeAsString("VCC4main3Foo4Ding3Str"));
+  EXPECT_EQ("Swift.CString", demangleTypeAsString("Vs7CString"));
+  EXPECT_EQ("__ObjC.NSObject", demangleTypeAsString("CSo8NSObject"));
+
+  DemangleOptions unqualified;
+  unqualified.QualifyEntities = false;
+  EXPECT_EQ("Str", demangleTypeAsString("VCC4main3Foo4Ding3Str", unqualified));
+
+  DemangleOptions noModules;
+  noModules.DisplayModuleNames = false;
+  EXPECT_EQ("Foo.Ding", demangleTypeAsString("CC4main3Foo4Ding", noModules));
+
+  // Malformed names fall back to the full demangler, which gives them back
+  // unchanged.
+  EXPECT_EQ("V4main9Foo", demangleTypeAsString("V4main9Foo"));
+  EXPECT_EQ("VV4main3Foo", demangleTypeAsString("VV4main3Foo"));
+}
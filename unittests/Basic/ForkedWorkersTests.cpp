@@ -0,0 +1,65 @@
+//===--- ForkedWorkersTests.cpp - for swift/Basic/ForkedWorkers.h ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ForkedWorkers.h"
+#include "swift/Basic/LLVM.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace swift;
+using namespace swift::sys;
+
+TEST(ForkedWorkers, CapturesOutputInOrder) {
+  ASSERT_TRUE(supportsForkedWorkers());
+
+  auto work = [](unsigned Index) {
+    // Finish out of order; the results should still be in index order.
+    usleep((3 - Index) * 10 * 1000);
+    llvm::outs() << "out " << Index << "\n";
+    llvm::outs().flush();
+    llvm::errs() << "err " << Index << "\n";
+    return static_cast<int>(Index);
+  };
+
+  SmallVector<ForkedWorkerResult, 4> Results;
+  std::string ErrorMsg;
+  ASSERT_FALSE(runForkedWorkers(3, work, Results, ErrorMsg)) << ErrorMsg;
+  ASSERT_EQ(3u, Results.size());
+  for (unsigned I = 0; I != 3; ++I) {
+    EXPECT_EQ(static_cast<int>(I), Results[I].ExitCode);
+    EXPECT_EQ("out " + std::to_string(I) + "\nerr " + std::to_string(I) +
+                "\n",
+              Results[I].Output);
+  }
+}
+
+TEST(ForkedWorkers, ReportsCrashes) {
+  auto work = [](unsigned Index) -> int {
+    if (Index == 1)
+      abort();
+    return 0;
+  };
+
+  SmallVector<ForkedWorkerResult, 2> Results;
+  std::string ErrorMsg;
+  ASSERT_FALSE(runForkedWorkers(2, work, Results, ErrorMsg)) << ErrorMsg;
+  ASSERT_EQ(2u, Results.size());
+  EXPECT_EQ(0, Results[0].ExitCode);
+  EXPECT_EQ(-1, Results[1].ExitCode);
+}
+
+#endif
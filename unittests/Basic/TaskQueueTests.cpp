@@ -0,0 +1,71 @@
+//===--- TaskQueueTests.cpp - for swift/Basic/TaskQueue.h -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TaskQueue.h"
+#include "swift/Basic/LLVM.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+
+using namespace swift;
+using namespace swift::sys;
+
+namespace {
+
+TEST(TaskQueue, ReportsProgress) {
+  TaskQueue TQ;
+  const char *Args[] = {
+    "-c", "echo before; echo '<swift-task-progress> halfway there'; echo after"
+  };
+  TQ.addTask("/bin/sh", Args);
+
+  std::vector<std::string> Events;
+  std::string Output;
+  TQ.execute(nullptr,
+             [&](ProcessId, int, StringRef TaskOutput,
+                 Optional<TaskResourceUsage>, void *) {
+    Events.push_back("finished");
+    Output = TaskOutput;
+    return TaskFinishedResponse::ContinueExecution;
+  }, nullptr,
+             [&](ProcessId, StringRef Message, void *) {
+    Events.push_back(Message);
+  });
+
+  ASSERT_EQ(2u, Events.size());
+  EXPECT_EQ("halfway there", Events[0]);
+  EXPECT_EQ("finished", Events[1]);
+  EXPECT_EQ("before\nafter\n", Output);
+}
+
+TEST(TaskQueue, KeepsProgressWithoutCallback) {
+  TaskQueue TQ;
+  const char *Args[] = { "-c", "echo '<swift-task-progress> halfway there'" };
+  TQ.addTask("/bin/sh", Args);
+
+  std::string Output;
+  TQ.execute(nullptr,
+             [&](ProcessId, int, StringRef TaskOutput,
+                 Optional<TaskResourceUsage>, void *) {
+    Output = TaskOutput;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+
+  EXPECT_EQ("<swift-task-progress> halfway there\n", Output);
+}
+
+} // end anonymous namespace
+
+#endif
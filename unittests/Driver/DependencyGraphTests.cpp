@@ -1,8 +1,18 @@
 #include "swift/Driver/DependencyGraph.h"
+#include "swift/Basic/BinarySwiftDeps.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
 using LoadResult = DependencyGraphImpl::LoadResult;
+using binary_swiftdeps::EntryKind;
+
+static std::string writeBinary(const binary_swiftdeps::Writer &writer) {
+  std::string result;
+  llvm::raw_string_ostream out(result);
+  writer.write(out);
+  return out.str();
+}
 
 TEST(DependencyGraph, BasicLoad) {
   DependencyGraph<uintptr_t> graph;
@@ -790,3 +800,189 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, BinaryChained) {
+  DependencyGraph<uintptr_t> graph;
+
+  binary_swiftdeps::Writer first;
+  first.addEntry(EntryKind::ProvidesTopLevel, "a");
+  first.addMemberEntry(EntryKind::ProvidesMember, "T", "m");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(first)),
+            LoadResult::UpToDate);
+
+  binary_swiftdeps::Writer second;
+  second.addEntry(EntryKind::DependsTopLevel, "a");
+  second.addEntry(EntryKind::ProvidesTopLevel, "b");
+  EXPECT_EQ(graph.loadFromString(1, writeBinary(second)),
+            LoadResult::UpToDate);
+
+  binary_swiftdeps::Writer third;
+  third.addEntry(EntryKind::DependsTopLevel, "b", /*isCascading=*/false);
+  third.addMemberEntry(EntryKind::DependsMember, "T", "m");
+  EXPECT_EQ(graph.loadFromString(2, writeBinary(third)),
+            LoadResult::UpToDate);
+
+  binary_swiftdeps::Writer fourth;
+  fourth.addMemberEntry(EntryKind::DependsMember, "T", "n");
+  EXPECT_EQ(graph.loadFromString(3, writeBinary(fourth)),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_TRUE(graph.isMarked(0));
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_FALSE(graph.isMarked(3));
+}
+
+TEST(DependencyGraph, BinaryInterfaceHash) {
+  DependencyGraph<uintptr_t> graph;
+
+  binary_swiftdeps::Writer before;
+  before.addEntry(EntryKind::ProvidesTopLevel, "a");
+  before.addEntry(EntryKind::InterfaceHash, "abc");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(before)),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(before)),
+            LoadResult::UpToDate);
+
+  binary_swiftdeps::Writer after;
+  after.addEntry(EntryKind::ProvidesTopLevel, "a");
+  after.addEntry(EntryKind::InterfaceHash, "def");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(after)),
+            LoadResult::AffectsDownstream);
+}
+
+TEST(DependencyGraph, BinaryMalformed) {
+  DependencyGraph<uintptr_t> graph;
+
+  binary_swiftdeps::Writer writer;
+  writer.addEntry(EntryKind::ProvidesTopLevel, "a");
+  writer.addMemberEntry(EntryKind::DependsMember, "T", "m");
+  std::string data = writeBinary(writer);
+  EXPECT_TRUE(binary_swiftdeps::hasSignature(data));
+
+  // Truncated files are rejected rather than read past the end.
+  for (size_t size = sizeof(binary_swiftdeps::Signature); size < data.size();
+       ++size) {
+    EXPECT_EQ(graph.loadFromString(size, data.substr(0, size)),
+              LoadResult::HadError);
+  }
+
+  // So are out-of-range string indices.
+  std::string badIndex = data;
+  badIndex[20 + 4] = '\x7f';
+  EXPECT_EQ(graph.loadFromString(0, badIndex), LoadResult::HadError);
+}
+
+TEST(DependencyGraph, FingerprintedMembers) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-member: [[T, '', x], [T, m, mm], "
+                                 "[T, n, nn]]\n"
+                                 "interface-hash: abc"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-member: [[T, m]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[T, n]]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-member: [[T, '', y], [T, m, mm2], "
+                                 "[T, n, nn]]\n"
+                                 "interface-hash: def"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+  EXPECT_FALSE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, FingerprintedTopLevel) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [[a, aa], [b, bb], c]\n"
+                                 "interface-hash: abc"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [c]"),
+            LoadResult::UpToDate);
+
+  // Entries without fingerprints always count as changed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [[a, aa], [b, bb], c]\n"
+                                 "interface-hash: def"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 3));
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_FALSE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, FingerprintsUnknownBeforeReload) {
+  DependencyGraph<uintptr_t> graph;
+
+  // The first load of a node has nothing to compare against.
+  EXPECT_EQ(graph.loadFromString(0, "provides-top-level: [[a, aa]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+}
+
+TEST(DependencyGraph, BinaryFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  binary_swiftdeps::Writer before;
+  before.addMemberEntry(EntryKind::ProvidesMember, "T", "m",
+                        /*isCascading=*/true, "mm");
+  before.addMemberEntry(EntryKind::ProvidesMember, "T", "n",
+                        /*isCascading=*/true, "nn");
+  before.addEntry(EntryKind::InterfaceHash, "abc");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(before)),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-member: [[T, m]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[T, n]]"),
+            LoadResult::UpToDate);
+
+  binary_swiftdeps::Writer after;
+  after.addMemberEntry(EntryKind::ProvidesMember, "T", "m",
+                       /*isCascading=*/true, "mm");
+  after.addMemberEntry(EntryKind::ProvidesMember, "T", "n",
+                       /*isCascading=*/true, "nn2");
+  after.addEntry(EntryKind::InterfaceHash, "def");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(after)),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_FALSE(graph.isMarked(1));
+
+  // Fingerprints can only follow "provides" entries.
+  binary_swiftdeps::Writer bad;
+  bad.addEntry(EntryKind::DependsTopLevel, "a");
+  bad.addEntry(EntryKind::ProvidesTopLevel, "b");
+  std::string data = writeBinary(bad);
+  data[20 + 12] = static_cast<char>(EntryKind::Fingerprint);
+  EXPECT_EQ(graph.loadFromString(3, data), LoadResult::HadError);
+}
@@ -352,3 +352,35 @@ TEST_F(LexerTest, NestedPlaceholder) {
   std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
   EXPECT_EQ("<#aa#>", Toks[2].getText());
 }
+
+TEST_F(LexerTest, LongRunsOfPlainCharacters) {
+  // Long enough to exercise the word-at-a-time paths, with non-ASCII
+  // characters falling back to the general ones.
+  const char *Snippet =
+      "        let someRatherLongIdentifierName_$0 = \"a long plain string, "
+      "with \\\"escapes\\\" and \\(interpolation)\" // a long line comment\n"
+      "\tvar caf\xC3\xA9Au\xC3\xA9Lait = \"cr\xC3\xA8me\" // \xE2\x80\x94 dash\n";
+  std::vector<tok> SnippetTokens{
+    tok::kw_let, tok::identifier, tok::equal, tok::string_literal,
+    tok::comment,
+    tok::kw_var, tok::identifier, tok::equal, tok::string_literal,
+    tok::comment,
+  };
+
+  const unsigned Repeats = 2000;
+  std::string Source;
+  std::vector<tok> ExpectedTokens;
+  for (unsigned i = 0; i != Repeats; ++i) {
+    Source += Snippet;
+    ExpectedTokens.insert(ExpectedTokens.end(), SnippetTokens.begin(),
+                          SnippetTokens.end());
+  }
+
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  ASSERT_EQ(ExpectedTokens.size(), Toks.size());
+  EXPECT_EQ("someRatherLongIdentifierName_$0", Toks[1].getText());
+  EXPECT_EQ("caf\xC3\xA9Au\xC3\xA9Lait", Toks[6].getText());
+  EXPECT_EQ("// a long line comment\n", Toks[4].getText());
+  EXPECT_EQ("\"cr\xC3\xA8me\"", Toks[8].getText());
+}
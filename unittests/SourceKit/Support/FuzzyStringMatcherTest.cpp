@@ -316,3 +316,14 @@ TEST(FuzzyStringMatcher, ShortUnconnectedMatches) {
   EXPECT_GT(m.scoreCandidate("xaxbxcdxxxxxx"), m.scoreCandidate("xaxbxcxd"));
   EXPECT_GT(m.scoreCandidate("xaxbxc_d"), m.scoreCandidate("xaxbxcxd"));
 }
+
+TEST(FuzzyStringMatcher, NonMatchesScoreZero) {
+  FuzzyStringMatcher m("abc");
+  EXPECT_EQ(0.0, m.scoreCandidate("acb"));
+  EXPECT_EQ(0.0, m.scoreCandidate("xyzxyz"));
+  EXPECT_EQ(0.0, m.scoreCandidate("ab"));
+  EXPECT_LT(0.0, m.scoreCandidate("aBc"));
+  m.normalize = true;
+  EXPECT_EQ(0.0, m.scoreCandidate("cba"));
+  EXPECT_LT(0.0, m.scoreCandidate("abc"));
+}
@@ -43,3 +43,22 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, OutOfOrderSnapshots) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", "abc");
+
+  ImmutableTextSnapshotRef Snap1 = EdBuf->insert(3, "d");
+  ImmutableTextSnapshotRef Snap2 = EdBuf->insert(4, "e");
+  ImmutableTextSnapshotRef Snap3 = EdBuf->erase(0, 1);
+
+  // Materialize a later snapshot first, then an earlier one, then one in
+  // between that comes after the earlier one.
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "bcde");
+  EXPECT_EQ(Snap1->getBuffer()->getText(), "abcd");
+  EXPECT_EQ(Snap2->getBuffer()->getText(), "abcde");
+
+  ImmutableTextSnapshotRef Snap4 = EdBuf->replace(1, 2, "x");
+  EXPECT_EQ(Snap4->getBuffer()->getText(), "bxe");
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "bcde");
+}
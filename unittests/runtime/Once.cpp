@@ -0,0 +1,71 @@
+//===--- Once.cpp - swift_once Tests --------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Once.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static std::atomic<int> NumInitializations;
+static int InitializedValue;
+
+static void slowInitializer(void *) {
+  ++NumInitializations;
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  InitializedValue = 42;
+}
+
+TEST(OnceTest, runs_once) {
+  static swift_once_t predicate;
+  NumInitializations = 0;
+  InitializedValue = 0;
+
+  swift_once(&predicate, slowInitializer);
+  swift_once(&predicate, slowInitializer);
+
+  EXPECT_EQ(1, NumInitializations.load());
+  EXPECT_EQ(42, InitializedValue);
+}
+
+TEST(OnceTest, concurrent_callers_wait) {
+  static swift_once_t predicate;
+  NumInitializations = 0;
+  InitializedValue = 0;
+
+  std::atomic<int> numSawValue(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([&] {
+      swift_once(&predicate, slowInitializer);
+      if (InitializedValue == 42)
+        ++numSawValue;
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(1, NumInitializations.load());
+  EXPECT_EQ(8, numSawValue.load());
+}
+
+#if !defined(__APPLE__)
+TEST(OnceTest, done_value_is_all_ones) {
+  // IRGen checks for this value inline.
+  static swift_once_t predicate;
+  swift_once(&predicate, slowInitializer);
+  EXPECT_EQ(~swift_once_t(0), predicate);
+}
+#endif
@@ -153,6 +153,39 @@ TEST(RefcountingTest, unowned_retain_release_n) {
   EXPECT_EQ(1u, value);
 }
 
+TEST(RefcountingTest, weak_side_table) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  EXPECT_EQ(1u, swift_unownedRetainCount(object));
+
+  // Weak references to the same object share one side table, which holds
+  // a single unowned retain.
+  WeakReference ref1, ref2, ref3;
+  swift_weakInit(&ref1, object);
+  EXPECT_EQ(2u, swift_unownedRetainCount(object));
+  swift_weakInit(&ref2, object);
+  swift_weakCopyInit(&ref3, &ref1);
+  EXPECT_EQ(2u, swift_unownedRetainCount(object));
+
+  auto loaded = swift_weakLoadStrong(&ref2);
+  EXPECT_EQ(object, loaded);
+  swift_release(loaded);
+  swift_weakDestroy(&ref2);
+
+  // Deallocation detaches the table instead of waiting for the weak
+  // references to go away.
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+
+  WeakReference ref4;
+  swift_weakCopyInit(&ref4, &ref1);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref4));
+  EXPECT_EQ(nullptr, swift_weakTakeStrong(&ref3));
+  swift_weakDestroy(&ref1);
+  swift_weakDestroy(&ref4);
+}
+
 /////////////////////////////////////////
 // Non-atomic reference counting tests //
 /////////////////////////////////////////
@@ -0,0 +1,143 @@
+#!/usr/bin/env python
+# utils/process-stats-dir.py - Aggregates compiler statistics -*- python -*-
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See http://swift.org/LICENSE.txt for license information
+# See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+
+# Adds up the statistics that the frontend jobs of a build wrote with
+# -stats-output-dir, and compares the totals of two builds.
+#
+# Counters and timers are added up over all jobs, except for the peak memory
+# use, of which the largest is kept. Timers start with "time." and are in
+# seconds.
+
+from __future__ import print_function
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+# Statistics that are combined by taking the largest value rather than the
+# sum.
+MAX_STATS = set(['Process.PeakMemoryBytes'])
+
+
+def add_stats(totals, stats):
+    for key, value in stats.items():
+        if key in MAX_STATS:
+            totals[key] = max(totals.get(key, 0), value)
+        else:
+            totals[key] = totals.get(key, 0) + value
+
+
+def load_stats_dir(path):
+    totals = {}
+    files = sorted(glob.glob(os.path.join(path, '*.json')))
+    for filename in files:
+        with open(filename) as f:
+            add_stats(totals, json.load(f))
+    totals['Build.NumFrontendJobs'] = len(files)
+    return totals
+
+
+def load_stats_dirs(paths):
+    totals = {}
+    for path in paths:
+        add_stats(totals, load_stats_dir(path))
+    return totals
+
+
+def format_value(key, value):
+    if key.startswith('time.'):
+        return '%.3f' % value
+    return '%d' % value
+
+
+def aggregate(args):
+    totals = load_stats_dirs(args.dirs)
+    if args.json:
+        json.dump(totals, sys.stdout, indent=2, sort_keys=True)
+        print()
+        return 0
+    for key in sorted(totals):
+        print('%s %s' % (key, format_value(key, totals[key])))
+    return 0
+
+
+def compare(args):
+    old = load_stats_dir(args.old)
+    new = load_stats_dir(args.new)
+    rows = []
+    for key in sorted(set(old) | set(new)):
+        if args.skip_timers and key.startswith('time.'):
+            continue
+        old_value = old.get(key, 0)
+        new_value = new.get(key, 0)
+        delta = new_value - old_value
+        if old_value != 0:
+            percent = 100.0 * delta / old_value
+        elif delta != 0:
+            percent = float('inf')
+        else:
+            percent = 0.0
+        if delta == 0 or abs(percent) < args.threshold:
+            continue
+        rows.append((key, format_value(key, old_value),
+                     format_value(key, new_value), '%+.1f%%' % percent))
+
+    if not rows:
+        print('No differences above %.1f%%' % args.threshold)
+        return 0
+
+    width = max(len(row[0]) for row in rows)
+    print('%-*s %14s %14s %9s' % (width, 'statistic', 'old', 'new', 'delta'))
+    for row in rows:
+        print('%-*s %14s %14s %9s' % ((width,) + row))
+    return 1 if args.exit_status else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Aggregate and compare the statistics written by '
+                    'swiftc -stats-output-dir.')
+    subparsers = parser.add_subparsers()
+
+    aggregate_parser = subparsers.add_parser(
+        'aggregate', help='Add up the statistics of one or more builds.')
+    aggregate_parser.add_argument('dirs', nargs='+', metavar='DIR',
+                                  help='A -stats-output-dir directory.')
+    aggregate_parser.add_argument('--json', action='store_true',
+                                  help='Print the totals as a JSON object.')
+    aggregate_parser.set_defaults(func=aggregate)
+
+    compare_parser = subparsers.add_parser(
+        'compare', help='Compare the totals of two builds.')
+    compare_parser.add_argument('old', metavar='OLD-DIR')
+    compare_parser.add_argument('new', metavar='NEW-DIR')
+    compare_parser.add_argument(
+        '--threshold', type=float, default=0.0, metavar='PERCENT',
+        help='Only show statistics that changed by at least PERCENT.')
+    compare_parser.add_argument(
+        '--skip-timers', action='store_true',
+        help='Only compare counters, which unlike timers are deterministic.')
+    compare_parser.add_argument(
+        '--exit-status', action='store_true',
+        help='Exit with status 1 if any statistic changed.')
+    compare_parser.set_defaults(func=compare)
+
+    args = parser.parse_args()
+    if not hasattr(args, 'func'):
+        parser.print_usage()
+        return 1
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
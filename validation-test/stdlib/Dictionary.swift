@@ -1117,6 +1117,39 @@ DictionaryTestSuite.test("deleteChainCollisionRandomized")
   }
 }
 
+DictionaryTestSuite.test("Iteration.SkipsEmptyBuckets") {
+  // Leave long runs of empty buckets, as well as occupied buckets on either
+  // side of word boundaries of the bitmap.
+  var d = Dictionary<Int, Int>(minimumCapacity: 1000)
+  let originalCapacity = d._variantStorage.asNative.capacity
+  for i in 0..<1000 {
+    d[i] = i * 10
+  }
+  for i in 0..<1000 where i % 97 != 0 {
+    d[i] = nil
+  }
+  expectEqual(originalCapacity, d._variantStorage.asNative.capacity)
+
+  var keys: [Int] = []
+  for (key, value) in d {
+    expectEqual(key * 10, value)
+    keys.append(key)
+  }
+  expectEqual(Array(stride(from: 0, to: 1000, by: 97)), keys.sorted())
+
+  var count = 0
+  var i = d.startIndex
+  while i != d.endIndex {
+    count += 1
+    i = d.index(after: i)
+  }
+  expectEqual(keys.count, count)
+
+  d.removeAll(keepingCapacity: true)
+  expectEqual(d.startIndex, d.endIndex)
+  expectEqual(0, Array(d).count)
+}
+
 DictionaryTestSuite.test("init(dictionaryLiteral:)") {
   do {
     var empty = Dictionary<Int, Int>()
@@ -1165,6 +1198,68 @@ DictionaryTestSuite.test("init(dictionaryLiteral:)") {
   }
 }
 
+DictionaryTestSuite.test("init(uniqueKeysWithValues:)") {
+  for count in [0, 1, 10, 1000] {
+    let d = Dictionary(uniqueKeysWithValues: (0..<count).map { ($0, $0 * 10) })
+    expectEqual(count, d.count)
+    for i in 0..<count {
+      expectOptionalEqual(i * 10, d[i])
+    }
+  }
+
+  // A sequence that underestimates its count still works.
+  let d = Dictionary(
+    uniqueKeysWithValues: (0..<100).lazy.filter { _ in true }.map { ($0, $0) })
+  expectEqual(100, d.count)
+  expectOptionalEqual(99, d[99])
+}
+
+DictionaryTestSuite.test("init(_:uniquingKeysWith:)") {
+  let pairs = [(10, 1), (20, 2), (10, 3), (20, 4), (30, 5)]
+  let first = Dictionary(pairs, uniquingKeysWith: { (first, _) in first })
+  expectEqual([10: 1, 20: 2, 30: 5], first)
+  let last = Dictionary(pairs, uniquingKeysWith: { (_, last) in last })
+  expectEqual([10: 3, 20: 4, 30: 5], last)
+  let sums = Dictionary(pairs, uniquingKeysWith: +)
+  expectEqual([10: 4, 20: 6, 30: 5], sums)
+
+  struct E : Error {}
+  expectNil(try? Dictionary(pairs, uniquingKeysWith: { _, _ in throw E() }))
+}
+
+DictionaryTestSuite.test("merge(_:uniquingKeysWith:)") {
+  var d = [10: 1, 20: 2]
+  d.merge(zip([10, 30], [3, 4])) { (current, _) in current }
+  expectEqual([10: 1, 20: 2, 30: 4], d)
+  d.merge(zip([10, 40], [5, 6])) { (_, new) in new }
+  expectEqual([10: 5, 20: 2, 30: 4, 40: 6], d)
+
+  d.merge([20: 10, 50: 7], uniquingKeysWith: +)
+  expectEqual([10: 5, 20: 12, 30: 4, 40: 6, 50: 7], d)
+
+  // Merging grows the storage as needed and leaves copies alone.
+  let copy = d
+  d.merge((100..<1100).map { ($0, $0) }, uniquingKeysWith: +)
+  expectEqual(1005, d.count)
+  expectEqual(5, copy.count)
+  expectOptionalEqual(1099, d[1099])
+
+  var empty = [Int: Int]()
+  empty.merge(copy, uniquingKeysWith: +)
+  expectEqual(copy, empty)
+}
+
+DictionaryTestSuite.test("merging(_:uniquingKeysWith:)") {
+  let d = [10: 1, 20: 2]
+  expectEqual(
+    [10: 1, 20: 2, 30: 4],
+    d.merging(zip([10, 30], [3, 4])) { (current, _) in current })
+  expectEqual(
+    [10: 3, 20: 2],
+    d.merging([10: 3]) { (_, new) in new })
+  expectEqual([10: 1, 20: 2], d)
+}
+
 #if _runtime(_ObjC)
 //===---
 // NSDictionary -> Dictionary bridging tests.
@@ -3206,6 +3301,33 @@ DictionaryTestSuite.test("DictionaryDowncastConditional") {
   }
 }
 
+DictionaryTestSuite.test("DictionaryDowncastConditional/CocoaStorageIsNotCopied") {
+  let d = getBridgedVerbatimDictionary()
+  assert(isCocoaDictionary(d))
+
+  // Successful downcast.
+  if var dCC = d as? Dictionary<TestObjCKeyTy, TestObjCValueTy> {
+    assert(isCocoaDictionary(dCC))
+    assert(dCC.count == 3)
+    assert(dCC[TestObjCKeyTy(10)]!.value == 1010)
+    assert(dCC[TestObjCKeyTy(20)]!.value == 1020)
+    assert(dCC[TestObjCKeyTy(30)]!.value == 1030)
+
+    // The first mutation moves the elements to native storage.
+    dCC[TestObjCKeyTy(40)] = TestObjCValueTy(1040)
+    assert(isNativeDictionary(dCC))
+    assert(dCC.count == 4)
+    assert(dCC[TestObjCKeyTy(10)]!.value == 1010)
+  } else {
+    assert(false)
+  }
+
+  // Unsuccessful downcast
+  if let _ = d as? Dictionary<TestObjCKeyTy, NSString> {
+    assert(false)
+  }
+}
+
 DictionaryTestSuite.test("DictionaryBridgeFromObjectiveCEntryPoint") {
   var d = Dictionary<NSObject, AnyObject>(minimumCapacity: 32)
   d[TestObjCKeyTy(10)] = TestObjCValueTy(1010)
@@ -88,6 +88,37 @@ HashingTestSuite.test("_squeezeHashValue/Int") {
   checkRange(16)
 }
 
+HashingTestSuite.test("_Hasher") {
+  func hash(_ components: [Int], seed: (UInt64, UInt64) = (1, 2)) -> Int {
+    var hasher = _Hasher(seed: seed)
+    for c in components {
+      hasher.append(c)
+    }
+    return hasher.finalize()
+  }
+  // Deterministic for a fixed seed.
+  expectEqual(hash([1, 2, 3]), hash([1, 2, 3]))
+  // Sensitive to the seed, the order and the number of components.
+  expectNotEqual(hash([1, 2, 3]), hash([1, 2, 3], seed: (2, 1)))
+  expectNotEqual(hash([1, 2]), hash([2, 1]))
+  expectNotEqual(hash([0]), hash([0, 0]))
+  expectNotEqual(hash([]), hash([0]))
+
+  var hashes = Set<Int>()
+  for i in 0..<64 {
+    for j in 0..<64 {
+      hashes.insert(hash([i, j]))
+    }
+  }
+  expectEqual(64 * 64, hashes.count)
+
+  var a = _Hasher(seed: (1, 2))
+  a.append("foo")
+  var b = _Hasher(seed: (1, 2))
+  b.append("foo".hashValue)
+  expectEqual(a.finalize(), b.finalize())
+}
+
 HashingTestSuite.test("String/hashValue/topBitsSet") {
 #if _runtime(_ObjC)
 #if arch(x86_64) || arch(arm64)
@@ -1276,6 +1276,120 @@ StringTests.test("String.decodeCString/UTF32") {
   expectEqual("foobar", actual!.result)
 }
 
+StringTests.test("String.decodeCString/UTF8/ASCIIStorage") {
+  let actual = decodeCString("foobar", as: UTF8.self)!.result
+  expectTrue(actual._core.isASCII)
+  let nonASCII = decodeCString("foo\u{e9}bar", as: UTF8.self)!.result
+  expectFalse(nonASCII._core.isASCII)
+  expectEqual("foo\u{e9}bar", nonASCII)
+}
+
+StringTests.test("String(cString:)/ASCIIPrefix") {
+  // Start the input at every alignment, and put the first non-ASCII byte at
+  // every position of a word.
+  let tails: [([UInt8], String?)] = [
+    ([], ""),
+    ([0xc3, 0xa9], "\u{e9}"),
+    ([0xc3, 0xa9, 0x61], "\u{e9}a"),
+    ([0xf0, 0x9f, 0x92, 0x90], "\u{1F490}"),
+    ([0xc3], nil),
+  ]
+  for offset in 0..<8 {
+    for asciiCount in 0..<20 {
+      for (tail, expectedTail) in tails {
+        let ascii = (0..<asciiCount).map { UInt8(0x61 + $0 % 26) }
+        let input =
+          [UInt8](repeating: 0x20, count: offset) + ascii + tail + [0]
+        let prefix = String(ascii.map { Character(UnicodeScalar($0)) })
+        input.withUnsafeBufferPointer {
+          let start = $0.baseAddress! + offset
+          expectEqual(
+            prefix + (expectedTail ?? "\u{fffd}"), String(cString: start))
+          let validated = start.withMemoryRebound(
+            to: CChar.self, capacity: input.count - offset) {
+            String(validatingUTF8: $0)
+          }
+          expectEqual(expectedTail.map { prefix + $0 }, validated)
+        }
+      }
+    }
+  }
+}
+
+StringTests.test("UTF8View.count") {
+  for s in ["", "foobar", "foo\u{e9}bar", "\u{1F1E7}\u{1F1E7}x"] {
+    let utf8 = s.utf8
+    expectEqual(Array(utf8).count, utf8.count)
+    let i = utf8.index(utf8.startIndex, offsetBy: 1, limitedBy: utf8.endIndex)
+      ?? utf8.endIndex
+    expectEqual(Array(utf8[i..<utf8.endIndex]).count,
+                utf8[i..<utf8.endIndex].count)
+    expectEqualSequence(
+      utf8.map { CChar(bitPattern: $0) } + [0], s.utf8CString)
+  }
+}
+
+StringTests.test("CharacterView/Latin1Boundaries") {
+  // (string, expected character lengths in UTF-16 code units)
+  let cases: [(String, [Int])] = [
+    ("", []),
+    ("a", [1]),
+    ("ab\r\ncd", [1, 1, 2, 1, 1]),
+    ("\r\r\n\n", [1, 2, 1]),
+    ("\n\r", [1, 1]),
+    ("caf\u{e9}", [1, 1, 1, 1]),
+    ("e\u{301}x", [2, 1]),
+    ("\u{e9}\u{301}\u{302}", [3]),
+    ("\r\u{301}", [1, 1]),
+    ("x\u{1F1E7}\u{1F1E7}y", [1, 4, 1]),
+  ]
+  for (s, lengths) in cases {
+    let characters = s.characters
+    expectEqual(lengths.count, characters.count, "\(s.debugDescription)")
+    expectEqual(
+      lengths, characters.map { String($0).utf16.count },
+      "\(s.debugDescription)")
+    expectEqual(
+      lengths.reversed(),
+      characters.reversed().map { String($0).utf16.count },
+      "\(s.debugDescription)")
+  }
+}
+
+StringTests.test("UnicodeScalarView/index(of:)/split") {
+  let strings = [
+    "", "a", "a,b,,c,", ",,", "caf\u{e9},x", "\u{1F1E7},\u{1F1E7}",
+    "\u{2603},\u{2603}\u{2603}", "long line, with, some, fields",
+  ]
+  for s in strings {
+    let scalars = s.unicodeScalars
+    for separator: UnicodeScalar in [",", "\u{e9}", "\u{2603}", "z"] {
+      let expectedIndex = Array(scalars).index(of: separator)
+      let i = scalars.index(of: separator)
+      expectEqual(expectedIndex, i.map { scalars.distance(
+        from: scalars.startIndex, to: $0) })
+      expectEqual(expectedIndex != nil, scalars.contains(separator))
+      for omitting in [true, false] {
+        for maxSplits in [0, 1, 2, Int.max] {
+          let expected = Array(scalars).split(
+            separator: separator, maxSplits: maxSplits,
+            omittingEmptySubsequences: omitting
+          ).map { String(String.UnicodeScalarView($0)) }
+          let actual = scalars.split(
+            separator: separator, maxSplits: maxSplits,
+            omittingEmptySubsequences: omitting).map { String($0) }
+          expectEqual(expected, actual, "\(s.debugDescription)")
+        }
+      }
+    }
+    let utf16 = s.utf16
+    let comma = UTF16.CodeUnit(UInt8(ascii: ","))
+    expectEqual(Array(utf16).index(of: comma),
+      utf16.index(of: comma).map { utf16.distance(
+        from: utf16.startIndex, to: $0) })
+  }
+}
+
 internal struct ReplaceSubrangeTest {
   let original: String
   let newElements: String